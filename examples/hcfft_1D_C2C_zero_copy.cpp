@@ -0,0 +1,64 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "include/hcfft.h"
+#include "include/hcfftlib.h"
+#include <hc_am.hpp>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+unsigned int global_seed = 100;
+
+// The transform runs on host coherent memory where it is, without copies
+// to and from the device. Memory of malloc works the same once registered
+// with hc::am_memory_host_lock.
+int main(int argc, char* argv[]) {
+  int N = argc > 1 ? atoi(argv[1]) : 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N, HCFFT_C2C);
+  assert(status == HCFFT_SUCCESS);
+  int hSize = N;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftComplex* data = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                    amHostCoherent);
+  assert(data != NULL);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    data[i].x = rand_r(&global_seed);
+    data[i].y = rand_r(&global_seed);
+  }
+
+  status = hcfftExecC2C(plan, data, data, HCFFT_FORWARD);
+  assert(status == HCFFT_SUCCESS);
+  // The host reads the result once the transform completes
+  status = hcfftSynchronize(plan);
+  assert(status == HCFFT_SUCCESS);
+  std::cout << "Output[0]: " << data[0].x << " " << data[0].y << std::endl;
+  status = hcfftDestroy(plan);
+  assert(status == HCFFT_SUCCESS);
+
+  hc::am_free(data);
+}
@@ -150,6 +150,19 @@ hipfftResult hipfftExecC2R(hipfftHandle plan, hipfftComplex *idata,
 hipfftResult hipfftExecZ2D(hipfftHandle plan, hipfftDoubleComplex *idata,
                            hipfftDoubleReal *odata);
 
+/* Complex transforms of split real and imaginary planes, with the element
+   layout of the interleaved transforms. cuFFT has no planar layouts, so
+   these return HIPFFT_RESULT_NOT_SUPPORTED on the NVCC path. */
+
+hipfftResult hipfftExecPlanarC2C(hipfftHandle plan, hipfftReal *idataRe,
+                                 hipfftReal *idataIm, hipfftReal *odataRe,
+                                 hipfftReal *odataIm, int direction);
+
+hipfftResult hipfftExecPlanarZ2Z(hipfftHandle plan, hipfftDoubleReal *idataRe,
+                                 hipfftDoubleReal *idataIm,
+                                 hipfftDoubleReal *odataRe,
+                                 hipfftDoubleReal *odataIm, int direction);
+
 #ifdef __cplusplus
 }
 #endif
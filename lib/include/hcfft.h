@@ -23,6 +23,8 @@ THE SOFTWARE.
 #ifndef LIB_INCLUDE_HCFFT_H_
 #define LIB_INCLUDE_HCFFT_H_
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // (__cplusplus)
@@ -30,6 +32,7 @@ extern "C" {
 namespace hc {
 class accelerator_view;
 class accelerator;
+class completion_future;
 class am_alloc;
 class am_free;
 };
@@ -49,6 +52,14 @@ typedef float_2_ hcfftComplex;
 typedef double hcfftDoubleReal;
 typedef double_2_ hcfftDoubleComplex;
 
+// IEEE 754 binary16 components, as stored by plans with half storage
+struct half_2_ {
+  unsigned short x;
+  unsigned short y;
+};
+
+typedef half_2_ hcfftHalfComplex;
+
 /* hcfft API Specification */
 
 // Typedef changes
@@ -97,6 +108,552 @@ Associate FFT Plan with an accelerator_view
 */
 hcfftResult hcfftSetStream(hcfftHandle*& plan, hc::accelerator_view& acc_view);
 
+/* Function hcfftXtGetStreamPlan()
+   Description:
+      Plan handles are valid in every thread of the process, but a plan runs
+   its transforms one at a time, on its own accelerator_view. To run one plan
+   on several streams at once, e.g. from a pool of worker threads, each
+   thread executes the copy of the plan for its stream instead of the plan.
+   The copy for a stream is created by the first request for it, with the
+   settings the plan has then, and every later request returns the same
+   handle. It is baked by its first transform from the kernels the plan has
+   compiled already, and it has work buffers of its own: the copy of a plan
+   set not to allocate them, see hcfftSetAutoAllocation(), is given a work
+   area with hcfftSetWorkArea() or per transform by hcfftXtExecStreamC2C()
+   and the like. The plan itself is returned for its own stream. Copies are
+   destroyed with the plan and must not be destroyed by the caller.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan                The hcfftHandle object of the plan.
+   #2 acc_view            The stream the transforms are to be queued on.
+   #3 streamPlan          Pointer to the hcfftHandle of the copy.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        streamPlan was set.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle, or its
+                        transforms are split across several GPUs.
+   HCFFT_INVALID_VALUE  streamPlan is NULL.
+*/
+
+hcfftResult hcfftXtGetStreamPlan(hcfftHandle plan,
+                                 hc::accelerator_view& acc_view,
+                                 hcfftHandle* streamPlan);
+
+/* Function hcfftXtSetBatch()
+   Description:
+      Changes the number of transforms of each exec function of a plan. A
+   plan of a single kernel, which is most 1D plans that fit in LDS, keeps its
+   kernel, twiddle tables and work area and only launches more or fewer
+   work-groups. Any other plan is baked again by its next transform; its FFT
+   kernels take the batch at launch and are not compiled again, but its
+   transposes are.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     The hcfftHandle object of the plan.
+   #2 batch    Number of transforms.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The batch was set.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE  batch is less than 1.
+*/
+
+hcfftResult hcfftXtSetBatch(hcfftHandle plan, int batch);
+
+/* Function hcfftXtClonePlan()
+   Description:
+      Creates a plan of the sizes, strides, scales and options of another
+   plan for batch transforms, on its accelerator_view. A clone of a baked
+   plan is baked right away from the kernels and twiddle tables of the plan,
+   without compiling, and has work buffers of its own. The clone is
+   independent of the plan and is destroyed with hcfftDestroy().
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     The hcfftHandle object of the plan.
+   #2 batch    Number of transforms of the clone.
+   #3 clone    Pointer to the hcfftHandle of the clone.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        clone was set.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle, or its
+                        transforms are split across several GPUs.
+   HCFFT_INVALID_VALUE  batch is less than 1 or clone is NULL.
+   HCFFT_SETUP_FAILED   The clone could not be baked.
+*/
+
+hcfftResult hcfftXtClonePlan(hcfftHandle plan, int batch, hcfftHandle* clone);
+
+/* Function hcfftSynchronize()
+   Description:
+      Exec functions queue the kernels of a transform on the accelerator_view
+   of the plan and return without waiting for them. Work queued later on the
+   same accelerator_view runs after the transform; this function blocks the
+   host until all transforms queued with the plan have completed, on its
+   accelerator_view and on the accelerators of hcfftXtSetGPUs.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   plan   The hcfftHandle object of the plan.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        All transforms of the plan have completed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftSynchronize(hcfftHandle plan);
+
+/* Function hcfftGetSize()
+   Description:
+      Bakes the plan, if it is not baked yet, and returns the size of the
+   work area its transforms need for their intermediate buffers. The size is
+   that of the placeness of the last transform, out of place for a new plan;
+   a transform of the other placeness may need a different size.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan       The hcfftHandle object of the plan.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 workSize   Size of the work area in bytes.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The size was returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   workSize is NULL.
+   HCFFT_SETUP_FAILED    The plan could not be baked.
+*/
+
+hcfftResult hcfftGetSize(hcfftHandle plan, size_t* workSize);
+
+/* Function hcfftSetAutoAllocation()
+   Description:
+      By default, the first transform of a plan allocates its intermediate
+   buffers. With autoAllocate 0, transforms only use the work area given by
+   hcfftSetWorkArea, and fail with HCFFT_NO_WORKSPACE if the plan needs one
+   and has none.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan           The hcfftHandle object of the plan.
+   #2 autoAllocate   0 to disable allocation, any other value to enable it.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftSetAutoAllocation(hcfftHandle plan, int autoAllocate);
+
+/* Function hcfftSetWorkArea()
+   Description:
+      Gives the plan GPU memory of at least the size returned by
+   hcfftGetSize, which its transforms carve their intermediate buffers from.
+   The memory must stay valid while transforms using it are queued; a new
+   work area, or NULL, replaces it for the transforms queued after.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan       The hcfftHandle object of the plan.
+   #2 workArea   Pointer to the work area (in GPU memory).
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The work area was set.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftSetWorkArea(hcfftHandle plan, void* workArea);
+
+/* Function hcfftXtSetBatchStreams()
+   Description:
+      Splits the batch of the plan into count chunks of about the same size,
+   queued on the accelerator_views in streams. The chunks start after the work
+   already queued on the accelerator_view of the plan, and work queued on it
+   later waits for all of them, so streams only add concurrency between the
+   kernels of a transform. The split applies to 1D plans transformed by a
+   single kernel with interleaved or real layouts and no callbacks; other
+   plans run the whole batch on their accelerator_view. A count of 0 removes
+   the streams.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      The hcfftHandle object of the plan.
+   #2 count     Number of accelerator_views in streams.
+   #3 streams   accelerator_views on the accelerator of the plan.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The streams were set.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   count is negative, streams is NULL with a positive
+                         count, or a stream is on another accelerator.
+*/
+
+hcfftResult hcfftXtSetBatchStreams(hcfftHandle plan, int count,
+                                   hc::accelerator_view* streams);
+
+/* Function hcfftXtSetGPUs()
+   Description:
+      Splits the batch of the plan across count accelerators for the
+   hcfftXtExecMulti functions. The batch is cut into contiguous chunks, one
+   per accelerator in the order of accs, of batch / count transforms, the
+   first batch % count chunks taking one more; hcfftXtGetGPUBatches returns
+   their sizes. The next multi-GPU transform creates a copy of the plan on
+   the default accelerator_view of each accelerator, with the chunk as its
+   batch and its own kernels, twiddles and work area, so set the GPUs after
+   the other settings of the plan. Plans with callbacks or half or planar
+   storage are not split. A count of 0 removes the accelerators. A 3D
+   complex-to-complex plan of a single volume is split into slabs and pencils
+   instead, see hcfftXtExecMultiVolumeC2C, and takes at most as many
+   accelerators as it has rows and planes.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan    The hcfftHandle object of the plan.
+   #2 count   Number of accelerators in accs, at most the batch of the plan
+              or those of a volume.
+   #3 accs    Distinct GPU accelerators.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The accelerators were set.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   count is negative or too large, accs is
+                         NULL with a positive count, or accs repeats an
+                         accelerator or holds one that is not a GPU.
+*/
+
+hcfftResult hcfftXtSetGPUs(hcfftHandle plan, int count, hc::accelerator* accs);
+
+/* Function hcfftXtGetGPUBatches()
+   Description:
+      Returns the number of transforms of the batch each accelerator of
+   hcfftXtSetGPUs takes, in the order of the accelerators. Chunk i starts
+   after the transforms of the chunks before it.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      The hcfftHandle object of the plan.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 batches   One count per accelerator of the plan.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The counts were returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle, or the
+                         plan has no accelerators.
+   HCFFT_INVALID_VALUE   batches is NULL.
+*/
+
+hcfftResult hcfftXtGetGPUBatches(hcfftHandle plan, int* batches);
+
+/* Function hcfftXtSetLowMemory()
+   Description:
+      With lowMemory set, transforms too large for a single kernel transpose
+   their data in place instead of through an intermediate buffer the size of
+   the data. That covers in-place 1D transforms of packed data split into
+   factors with a ratio of 2, 3 or 5 or short enough for a row to fit in
+   LDS, and 2D transforms of packed power-of-2 data; other plans keep their
+   intermediate buffers. The plan is baked again by its next transform.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        The hcfftHandle object of the plan.
+   #2 lowMemory   0 to allow intermediate buffers, any other value to avoid
+                  them.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetLowMemory(hcfftHandle plan, int lowMemory);
+
+/* Function hcfftXtSetHalfStorage()
+   Description:
+      With halfStorage set, a single-precision complex-to-complex plan reads
+   and writes its data as hcfftHalfComplex, and transforms it in single
+   precision, halving the memory traffic of the transform. The conversions
+   take the load and store callbacks of the plan, so the plan may have no
+   other callbacks, and the lengths must fit in single kernels of 1D or 2D
+   plans. Execute the plan with hcfftXtExecHalfC2C(). The plan is baked again
+   by its next transform.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan          The hcfftHandle object of a HCFFT_C2C plan.
+   #2 halfStorage   0 for single-precision data, any other value for half.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid single-precision
+                        handle.
+   HCFFT_INVALID_VALUE  The plan has callbacks.
+*/
+
+hcfftResult hcfftXtSetHalfStorage(hcfftHandle plan, int halfStorage);
+
+/* Function hcfftXtSetSingleTwiddles()
+   Description:
+      With singleTwiddles set, the Stockham kernels of a double-precision
+   plan read the twiddle factors of their passes from a single-precision
+   table, converted to double in registers; the data and the arithmetic stay
+   double. That halves the twiddle bytes read by every pass. Each twiddle
+   then carries a relative error of up to 6e-8 instead of 1e-16, so the
+   coefficients have a relative error of about 1e-7 * log2(N) of their RMS
+   instead of about 1e-15. The large twiddle tables of transforms too long
+   for a single kernel stay in double. Plans of single precision are
+   unaffected. The plan is baked again by its next transform.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan             The hcfftHandle object of the plan.
+   #2 singleTwiddles   0 for double-precision twiddles, any other value for
+                       single.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetSingleTwiddles(hcfftHandle plan, int singleTwiddles);
+
+/* Function hcfftXtSetComputedTwiddles()
+   Description:
+      With computedTwiddles set, the kernels of a plan too long for a single
+   kernel evaluate the twiddle factors between their steps with sin and cos,
+   instead of reading them from a table in device memory. That trades
+   arithmetic for the table reads of every work-group, and the plan no longer
+   holds the table. Double-precision plans are as accurate either way; in
+   single precision each factor carries an error of up to 4e-7 instead of
+   6e-8. The pass twiddles of each kernel still come from their table. Plans
+   short enough for a single kernel are unaffected. The plan is baked again
+   by its next transform.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan                The hcfftHandle object of the plan.
+   #2 computedTwiddles    0 for the twiddle table, any other value to compute
+                          the factors.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetComputedTwiddles(hcfftHandle plan, int computedTwiddles);
+
+/* Function hcfftXtSetHostThreshold()
+   Description:
+      With a threshold set, hcfftExecC2C() and hcfftExecZ2Z() of a plan whose
+   batch holds at most that many complex elements, with input and output both
+   in host memory, transform on the host instead of on the GPU. On sizes that
+   small the launch and the copies cost more than the transform, and the plan
+   is not baked for them. The host computes a DFT in double precision along
+   each axis, sharing a large enough batch across its cores. Plans with
+   callbacks, half or planar storage, and real transforms, always run on the
+   GPU. The default of 0 keeps every transform on the GPU.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan                The hcfftHandle object of the plan.
+   #2 elements            The largest batch, in complex elements, to
+                          transform on the host.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetHostThreshold(hcfftHandle plan, size_t elements);
+
+/* Function hcfftXtSetHybrid()
+   Description:
+      With hybrid set, hcfftExecC2C() and hcfftExecZ2Z() of a batched plan
+   whose input and output are both in pinned host memory, from hc::am_alloc()
+   with amHostPinned, split the batch between the GPU and the host cores,
+   which transform their part of it at the same time. The first such
+   transform gives the host an eighth of the batch and times both parts, and
+   later ones share the batch in proportion to the measured rates. That
+   first transform does not return until the GPU finishes; later ones return
+   once the host part is done, with the GPU part still running until
+   hcfftSynchronize(). The host computes a DFT per axis, so long transforms
+   leave it little or none of the batch. Plans with callbacks, half or
+   planar storage, several GPUs, and real transforms, always run on the GPU.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan                The hcfftHandle object of the plan.
+   #2 hybrid              0 for the GPU alone, any other value to share
+                          batches with the host.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetHybrid(hcfftHandle plan, int hybrid);
+
+/* Function hcfftXtSetAutotune()
+   Description:
+      With autotune set, the next bake of the plan times variants of each of
+   its Stockham kernels on the device of the plan, and keeps the fastest. The
+   variants cover the work-group size, the transforms per work-group and how
+   the real and imaginary parts go through LDS, for kernels on complex
+   interleaved data without callbacks. Variants are checked against the
+   output of the default kernel, and those that differ are dropped. This
+   builds up to a few tens of kernels per leaf, so a bake can take seconds
+   the first time. The choice is kept for the life of the process, and other
+   plans with the same kernels use it without tuning again. Setting the
+   HCFFT_AUTOTUNE environment variable to 1 tunes every plan.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan       The hcfftHandle object of the plan.
+   #2 autotune   0 for the default kernels, any other value to tune them.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetAutotune(hcfftHandle plan, int autotune);
+
+/* Function hcfftExportWisdom()
+   Description:
+      Writes the kernel choices the autotuner has made in this process to a
+   text file at path, so that later processes can import them instead of
+   tuning again. Each choice is keyed by the signature of the kernel it
+   replaces, which covers the target ISA, the kernel generator version, the
+   lengths, layouts and precision of the leaf and its element strides; a
+   choice applies to every batch and distance of the same kernel on the same
+   GPU model. The decomposition of
+   long transforms into leaves is not tuned and stays that of the heuristics.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 path   Name of the file to write; an existing file is replaced.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS          The wisdom was written.
+   HCFFT_INVALID_VALUE    path is NULL or the file cannot be created.
+   HCFFT_INTERNAL_ERROR   Writing the file failed.
+*/
+
+hcfftResult hcfftExportWisdom(const char* path);
+
+/* Function hcfftImportWisdom()
+   Description:
+      Reads a file written by hcfftExportWisdom and merges its kernel choices
+   with those of this process, replacing choices for the same kernels. Plans
+   baked afterwards use them in place of the default kernels, without
+   autotuning; choices for other GPUs or kernels never match and are unused.
+   Nothing is merged from a file that does not parse.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 path   Name of the file to read.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The wisdom was merged.
+   HCFFT_INVALID_VALUE   path is NULL or the file cannot be opened.
+   HCFFT_PARSE_ERROR     The file is not a valid wisdom file.
+*/
+
+hcfftResult hcfftImportWisdom(const char* path);
+
+/* Function hcfftSavePlan()
+   Description:
+      Bakes plan and writes it to a binary plan file at path, together with
+   the compiled kernel libraries, twiddle tables and kernel choices of its
+   tree. hcfftLoadPlan recreates the plan from the file without compiling
+   kernels or computing twiddles, even in a process with an empty kernel
+   cache. Files are read by the same library version on the same GPU model
+   only. Callbacks are saved by their source and compiled into the kernels.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan   Handle to the plan to save.
+   #2 path   Name of the file to write; an existing file is replaced.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS          The plan was written.
+   HCFFT_INVALID_PLAN     The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE    path is NULL or the file cannot be created.
+   HCFFT_INTERNAL_ERROR   The plan could not be baked or the write failed.
+*/
+
+hcfftResult hcfftSavePlan(hcfftHandle plan, const char* path);
+
+/* Function hcfftLoadPlan()
+   Description:
+      Creates and bakes a plan from a file written by hcfftSavePlan, with
+   the settings the plan had when it was saved, on the default accelerator.
+   Its kernel libraries are installed in the kernel cache and its kernel
+   choices merged with the wisdom of the process. A kernel missing from the
+   file, or built for another GPU, is compiled as by hcfftPlan1d.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 path   Name of the file to read.
+   #2 plan   Pointer to the handle of the new plan.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The plan was created.
+   HCFFT_INVALID_VALUE   path or plan is NULL, or the file cannot be opened.
+   HCFFT_PARSE_ERROR     The file is not a plan file of this library version,
+                         or the plan it holds cannot be baked.
+*/
+
+hcfftResult hcfftLoadPlan(const char* path, hcfftHandle* plan);
+
+/* Function hcfftXtSetTransposedOutput()
+   Description:
+      With transposed set, the forward transform of a 2D complex plan skips
+   its final transpose and leaves the spectrum transposed: nx rows of ny
+   elements, row x holding the coefficients (x, 0) to (x, ny - 1). The
+   backward transform of the plan then takes its input in that transposed
+   order and returns data in the natural order, so a forward and backward
+   pair saves two of its four transposes. The data must be packed. Other
+   plans, 1D, 3D and real, fail at their next transform. The plan is baked
+   again by its next transform.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan         The hcfftHandle object of the plan.
+   #2 transposed   0 for the natural order, any other value for transposed.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetTransposedOutput(hcfftHandle plan, int transposed);
+
 /*hcFFT Basic Plans*/
 
 /******************************************************************************************************************
@@ -105,6 +662,13 @@ hcfftResult hcfftSetStream(hcfftHandle*& plan, hc::accelerator_view& acc_view);
        Creates a 1D FFT plan configuration for a specified signal size and data
    type. The batch input parameter tells hcFFT how many 1D transforms to configure.
 
+   Complex sizes with a prime factor larger than 13 are transformed with
+   Bluestein's algorithm, through transforms of the smallest power of 2 size
+   of at least 2*nx-1. Those have to fit in a single kernel, so larger such
+   sizes, and such sizes in 2D and 3D plans, fail at the first exec. A prime
+   nx whose nx-1 has no prime factor larger than 13 may instead go through
+   Rader's algorithm, through transforms of size nx-1, when those cost less.
+
    Input:
    ----------------------------------------------------------------------------------------------
    #1 plan    Pointer to a hcfftHandle object
@@ -193,19 +757,610 @@ hcfftResult hcfftPlan2d(hcfftHandle* plan, int nx, int ny, hcfftType type);
 hcfftResult hcfftPlan3d(hcfftHandle* plan, int nx, int ny, int nz,
                         hcfftType type);
 
-/* Function hcfftDestroy()
+/*
+ * <iii> Function hcfftPlanNd()
    Description:
-      Frees all GPU resources associated with a hcFFT plan and destroys the
-   internal plan data structure. This function should be called once a plan
-   is no longer needed, to avoid wasting GPU memory.
+      Creates an FFT plan of rank 1 to 6, with the lengths of the dimensions
+   given from the fastest varying one, as for hcfftPlan3d(). Plans of rank 1
+   to 3 are those of hcfftPlan1d(), hcfftPlan2d() and hcfftPlan3d(). A plan of
+   higher rank runs as the 3D transform of the first three dimensions,
+   batched over the others, then transforms each further dimension in place
+   on the complex data. The lengths of the dimensions after the 3rd have to
+   fit in a single kernel, or executing the plan fails.
 
    Input:
-   -----------------------------------------------------------------------------------------------------
-   plan   The hcfftHandle object of the plan to be destroyed.
+   ----------------------------------------------------------------------------------------------
+   #1 plan    Pointer to a hcfftHandle object
+   #2 rank    Number of dimensions, 1 to 6
+   #3 n       Array of rank transform sizes, n[0] the fastest varying
+   #4 type    The transform data type (e.g., HCFFT_C2C for single precision
+              complex to complex)
+
+   Output:
+   ----------------------------------------------------------------------------------------------
+   #1 plan    Contains a hcFFT plan handle value
 
    Return Values:
-   -----------------------------------------------------------------------------------------------------
-   HCFFT_SUCCESS        hcFFT successfully destroyed the FFT plan.
+   ----------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully created the FFT plan.
+   HCFFT_ALLOC_FAILED    The allocation of GPU resources for the plan failed.
+   HCFFT_INVALID_VALUE   n is NULL, rank is not 1 to 6, or type is invalid.
+   HCFFT_SETUP_FAILED    The hcFFT library failed to initialize.
+   HCFFT_INVALID_SIZE    One or more of the sizes is not supported.
+*/
+
+hcfftResult hcfftPlanNd(hcfftHandle* plan, int rank, const int* n,
+                        hcfftType type);
+
+/*
+ * <iv> Functions hcfftPlanMany() and hcfftPlanMany64()
+   Description:
+      Creates a batched FFT plan of rank 1 to 6 on the advanced data layout.
+   Element x[0], ..., x[rank - 1] of transform b in the input is at
+      b * idist + (x[0] + inembed[0] * (x[1] + inembed[1] * (...))) * istride
+   and likewise in the output. The arrays list the fastest varying dimension
+   first, as for hcfftPlanNd(). The last entry of an embed array is not used.
+   A NULL inembed or onembed gives packed data on that side, and its stride
+   and distance are then ignored. The strides and distances are in elements
+   of the data of the side, real or complex. On the complex side of a real
+   transform n[0] / 2 + 1 elements are transformed along the fastest
+   dimension. hcfftPlanMany64() takes 64-bit sizes, strides and distances.
+
+   Input:
+   ----------------------------------------------------------------------------------------------
+   #1 plan     Pointer to a hcfftHandle object
+   #2 rank     Number of dimensions, 1 to 6
+   #3 n        Array of rank transform sizes
+   #4 inembed  Array of rank storage sizes of the input, or NULL
+   #5 istride  Distance between successive input elements of the fastest
+               dimension
+   #6 idist    Distance between the first input elements of two transforms
+   #7 onembed  Array of rank storage sizes of the output, or NULL
+   #8 ostride  Distance between successive output elements of the fastest
+               dimension
+   #9 odist    Distance between the first output elements of two transforms
+   #10 type    The transform data type
+   #11 batch   Number of transforms
+
+   Output:
+   ----------------------------------------------------------------------------------------------
+   #1 plan     Contains a hcFFT plan handle value
+
+   Return Values:
+   ----------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully created the FFT plan.
+   HCFFT_ALLOC_FAILED    The allocation of GPU resources for the plan failed.
+   HCFFT_INVALID_VALUE   A pointer is NULL, rank is not 1 to 6, batch, a
+                         stride or a distance is below 1, an embed size is
+                         below its transform size, or type is invalid.
+   HCFFT_SETUP_FAILED    The hcFFT library failed to initialize.
+   HCFFT_INVALID_SIZE    One or more of the sizes is not supported.
+*/
+
+hcfftResult hcfftPlanMany(hcfftHandle* plan, int rank, int* n, int* inembed,
+                          int istride, int idist, int* onembed, int ostride,
+                          int odist, hcfftType type, int batch);
+
+hcfftResult hcfftPlanMany64(hcfftHandle* plan, int rank, long long int* n,
+                            long long int* inembed, long long int istride,
+                            long long int idist, long long int* onembed,
+                            long long int ostride, long long int odist,
+                            hcfftType type, long long int batch);
+
+/* Functions hcfftEstimate1d(), hcfftEstimate2d() and hcfftEstimate3d()
+   Description:
+      Return the GPU memory an out-of-place plan of the given sizes and type
+   allocates besides its input and output: its intermediate buffers and its
+   twiddle tables. The plan is split into sub-plans as it is for a transform,
+   but no kernel is generated or compiled. Plans sharing twiddle tables with
+   plans that already exist allocate less.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   nx, ny, nz   The transform sizes, as for hcfftPlan1d/2d/3d.
+   type         The transform data type.
+   batch        Number of transforms (1D only).
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   workSize     Size of the GPU memory in bytes.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The size was returned.
+   HCFFT_INVALID_VALUE   workSize is NULL, batch is below 1 or type is not
+                         valid.
+   HCFFT_INVALID_SIZE    A size is not supported.
+   HCFFT_SETUP_FAILED    The plan could not be decomposed.
+*/
+
+hcfftResult hcfftEstimate1d(int nx, hcfftType type, int batch,
+                            size_t* workSize);
+
+hcfftResult hcfftEstimate2d(int nx, int ny, hcfftType type, size_t* workSize);
+
+hcfftResult hcfftEstimate3d(int nx, int ny, int nz, hcfftType type,
+                            size_t* workSize);
+
+/* Function hcfftEstimateMany()
+   Description:
+      Returns the GPU memory of a plan of hcfftPlanMany(), as hcfftEstimate1d()
+   does for a 1D plan, in workSize.
+*/
+
+hcfftResult hcfftEstimateMany(int rank, int* n, int* inembed, int istride,
+                              int idist, int* onembed, int ostride, int odist,
+                              hcfftType type, int batch, size_t* workSize);
+
+/* Function hcfftBakePlanAsync()
+   Description:
+      Generates and compiles the kernels of a plan and allocates its GPU
+   resources on a background thread, so that plans can be prepared without
+   blocking the caller. Exec functions and hcfftDestroy() called on the plan
+   while it is baking wait for the bake to finish. The plan is baked for
+   out-of-place execution; an in-place exec bakes again.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   plan   The hcfftHandle object of the plan to be baked.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The bake was started, or one is already in flight.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+   HCFFT_SETUP_FAILED   The hcFFT library failed to initialize.
+*/
+
+hcfftResult hcfftBakePlanAsync(hcfftHandle plan);
+
+/* Function hcfftBakePlanWait()
+   Description:
+      Waits for a bake started by hcfftBakePlanAsync() and returns its result.
+   Returns immediately if no bake was started.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   plan   The hcfftHandle object of the plan being baked.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The plan is ready for execution.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+   HCFFT_SETUP_FAILED   Kernel generation or compilation failed.
+*/
+
+hcfftResult hcfftBakePlanWait(hcfftHandle plan);
+
+/* Time a plan and each of its sub-plans spent getting ready for execution,
+ * see hcfftGetPlanTimings(). Times are in seconds. */
+
+typedef struct hcfftPlanTimings_t {
+  int depth;            //  0 for the plan itself, 1 for its sub-plans, ...
+  int hasKernel;        //  The plan launches a kernel of its own
+  int cacheHit;         //  That kernel was prebuilt, cached or already loaded
+  double generateTime;  //  Kernel source generation
+  double writeTime;     //  Writing the kernel source to disk
+  double compileTime;   //  Compiler and linker invocations
+  double loadTime;      //  dlopen and entry point lookup
+  double twiddleTime;   //  Twiddle table generation and upload
+  double allocTime;     //  am_alloc of the intermediate buffers
+  double tuneTime;      //  Building and timing the variants of the kernel
+} hcfftPlanTimings;
+
+/* Function hcfftGetPlanTimings()
+   Description:
+      Reports where the last bake of a plan spent its time, for the plan and
+   every sub-plan in depth-first order. Intermediate buffers are allocated by
+   the first exec after a bake and are accounted to the plan that uses them.
+   Setting the HCFFT_PLAN_TIMINGS environment variable prints the same report
+   when a plan is destroyed.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      The hcfftHandle object of the plan.
+   #2 timings   Array of *count entries to fill, or NULL.
+   #3 count     Capacity of timings.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 timings   The first *count entries of the report.
+   #2 count     The number of entries in the report.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The report was returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   count is NULL.
+*/
+
+hcfftResult hcfftGetPlanTimings(hcfftHandle plan, hcfftPlanTimings* timings,
+                                int* count);
+
+/* A plan or sub-plan as the planner decomposed it, see hcfftGetPlanInfo(). */
+
+#define HCFFT_PLAN_INFO_RANK 16
+
+typedef struct hcfftPlanInfo_t {
+  int depth;              //  0 for the plan itself, 1 for its sub-plans, ...
+  char role[16];          //  Member of the parent, such as "planTX", or
+                          //  "plan" for the plan itself
+  int baked;              //  The plan is baked, and its tree complete
+  int hasKernel;          //  The plan launches a kernel of its own
+  char kernel[24];        //  Its generator: Stockham, Transpose_GCN,
+                          //  Transpose_SQUARE, Transpose_NONSQUARE or Copy
+  int rank;               //  Entries of lengths and strides in use
+  size_t lengths[HCFFT_PLAN_INFO_RANK];
+  size_t inStrides[HCFFT_PLAN_INFO_RANK];
+  size_t outStrides[HCFFT_PLAN_INFO_RANK];
+  size_t inDistance;
+  size_t outDistance;
+  size_t batch;
+  int inplace;
+  int inLayout;           //  Layout of the buffers: 1 complex interleaved,
+  int outLayout;          //  2 complex planar, 3 Hermitian interleaved,
+                          //  4 Hermitian planar, 5 real
+  size_t large1D;         //  Length of a 1D transform split in two, or 0
+  size_t large1DXfactor;  //  Length of the first transform of that split
+  int transposeOrder;     //  Kernel order of a non-square transpose: 0 not
+                          //  one, 1 swap then transpose, 2 transpose then
+                          //  swap, 3 transpose leading then swap
+  int RCsimple;           //  Real data copied to and from complex buffers
+  int realSpecial;        //  Real 2D and 3D column pass of half the columns
+  int blockCompute;       //  Columns transformed in blocks through LDS
+  int bluestein;          //  Transform through a Bluestein convolution
+  int rader;              //  Prime length transformed by Rader's algorithm
+  size_t scratchBytes;    //  Intermediate buffers of the plan
+  char kernelLibrary[256];  //  Shared library of the kernel, if any
+} hcfftPlanInfo;
+
+/* Function hcfftGetPlanInfo()
+   Description:
+      Describes a plan and every sub-plan in depth-first order, each after
+   its parent: which generator and lengths the planner chose, the strides
+   and flags of each stage, its scratch buffers and the library its kernel
+   was loaded from. A plan is only decomposed when it is baked, by its first
+   exec or hcfftBakePlanAsync; before that it is described alone. Lengths
+   and strides beyond HCFFT_PLAN_INFO_RANK entries are not reported.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan    The hcfftHandle object of the plan.
+   #2 info    Array of *count entries to fill, or NULL.
+   #3 count   Capacity of info.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 info    The first *count entries of the description.
+   #2 count   The number of plans in the tree.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The description was returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   count is NULL.
+*/
+
+hcfftResult hcfftGetPlanInfo(hcfftHandle plan, hcfftPlanInfo* info,
+                             int* count);
+
+/* Counters of the library since the process started, see hcfftGetStats(). */
+
+typedef struct hcfftStats_t {
+  size_t plansCreated;     //  Top-level plans, counting those the library
+  size_t plansDestroyed;   //  creates for hybrid and convolution transforms
+  size_t memoryCacheHits;  //  Kernels baked from a library already loaded
+  size_t diskCacheHits;    //  Kernels baked from a prebuilt or cached library
+  size_t cacheMisses;      //  Kernels baked from a library compiled for them
+  size_t compiles;         //  Kernel libraries compiled and linked
+  double compileSeconds;   //  Wall time of the compiles, summed over threads
+  size_t dlopens;          //  Kernel libraries loaded
+  size_t scratchBytes;     //  Device memory held in scratch pools and the
+                           //  intermediate buffers of plans
+  size_t twiddleBytes;     //  Device memory held in twiddle, chirp and R2R
+                           //  tables
+  size_t execs;            //  Transforms queued or run on the host
+  size_t launches;         //  Kernels queued by the transforms
+  double launchesPerExec;  //  launches over execs
+} hcfftStats;
+
+/* Function hcfftGetStats()
+   Description:
+      Reads the counters of the library, for all plans of the process. The
+   counters only grow, except for the bytes held, which follow the buffers
+   as they are allocated and freed. Reading them takes no lock, so counters
+   changing meanwhile may be read on either side of the change.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 stats   Counters to fill.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 stats   The counters.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The counters were returned.
+   HCFFT_INVALID_VALUE   stats is NULL.
+*/
+
+hcfftResult hcfftGetStats(hcfftStats* stats);
+
+/* Function hcfftXtSetProfiling()
+   Description:
+      With profile set, each transform of a plan queues a marker on its
+   accelerator_view before its first kernel and after each kernel, and
+   keeps them for hcfftXtGetProfile. Profiled transforms are not split
+   across views. Setting the HCFFT_PROFILE environment variable to 1
+   profiles every plan, and prints the profile of its last transform when
+   it is destroyed. Clones and stream copies of the plan profile their
+   transforms too, and keep the markers for their own profile.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      The hcfftHandle object of the plan.
+   #2 profile   Nonzero to profile transforms, zero to stop.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetProfiling(hcfftHandle plan, int profile);
+
+/* A kernel of a profiled transform, see hcfftXtGetProfile(). */
+
+typedef struct hcfftXtKernelProfile_t {
+  char role[64];     //  Sub-plan of the kernel, such as "planTX/planX", or
+                     //  "plan" for the plan itself
+  char kernel[24];   //  Stockham, Transpose_GCN, Transpose_SQUARE,
+                     //  Transpose_NONSQUARE or Copy
+  size_t bytes;      //  Input read and output written by the kernel
+  double flops;      //  Nominal 5 N log2 N of its transforms, half that for
+                     //  real ones, 0 for transposes and copies
+  double startTime;  //  Seconds from the start of the transform
+  double endTime;
+  double bandwidth;  //  bytes over the kernel time, in GB/s
+  double gflops;     //  flops over the kernel time, in GFLOPS
+} hcfftXtKernelProfile;
+
+/* Function hcfftXtGetProfile()
+   Description:
+      Reports the kernels of the last profiled transform of a plan, in the
+   order they ran, waiting for them to complete. Times are device timestamps
+   of the markers between the kernels, so each includes the launch gap
+   before it. The transforms of Rader plans, and those run on the host or
+   shared with it, are not profiled.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      The hcfftHandle object of the plan.
+   #2 profile   Array of *count entries to fill, or NULL.
+   #3 count     Capacity of profile.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 profile   The first *count kernels.
+   #2 count     The number of kernels, 0 when no transform was profiled.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The profile was returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   count is NULL.
+*/
+
+hcfftResult hcfftXtGetProfile(hcfftHandle plan, hcfftXtKernelProfile* profile,
+                              int* count);
+
+/* Function hcfftXtSetValidation()
+   Description:
+      With validate set, each transform of a plan sums the energy of every
+   batch element of its input and of its output on its accelerator_view,
+   before and after its kernels, for hcfftXtGetValidation. The sums read the
+   input and the output once more, without copies to the host. Transforms
+   run on the host, shared with it or split across GPUs are not validated,
+   nor are those of plans with callbacks, a window, extents, transposed
+   output, or half precision or planar storage. Clones and stream copies of
+   the plan validate their transforms too, and keep the sums for their own
+   errors.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan       The hcfftHandle object of the plan.
+   #2 validate   Nonzero to validate transforms, zero to stop.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        The setting was changed.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftXtSetValidation(hcfftHandle plan, int validate);
+
+/* Function hcfftXtGetValidation()
+   Description:
+      Reports, for each batch element of the last validated transform of a
+   plan, the relative error of Parseval's theorem |Eout - s^2 N Ein| /
+   (s^2 N Ein), where Ein and Eout are the energies of its input and output,
+   N the number of elements of the transform and s its scale. It waits for
+   the transform to complete. Errors of correct transforms are of the order
+   of the rounding error of the precision of the plan.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      The hcfftHandle object of the plan.
+   #2 errors    Array of *count entries to fill, or NULL.
+   #3 count     Capacity of errors.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 errors    The errors of the first *count batch elements.
+   #2 count     The batch of the transform, 0 when none was validated.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The errors were returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   count is NULL.
+*/
+
+hcfftResult hcfftXtGetValidation(hcfftHandle plan, double* errors, int* count);
+
+/* Callbacks run by the kernels of a plan on each element they load from the
+ * input or store to the output. */
+
+typedef enum hcfftXtCallbackType_t {
+  HCFFT_CB_LD_COMPLEX = 0x0,         //  Load single-precision complex
+  HCFFT_CB_LD_COMPLEX_DOUBLE = 0x1,  //  Load double-precision complex
+  HCFFT_CB_ST_COMPLEX = 0x4,         //  Store single-precision complex
+  HCFFT_CB_ST_COMPLEX_DOUBLE = 0x5   //  Store double-precision complex
+} hcfftXtCallbackType;
+
+/* Function hcfftXtSetCallback()
+   Description:
+      Sets a callback the plan calls in place of its loads from the input or
+   its stores to the output. Kernels are compiled at run time, so the callback
+   is given as source: funcString defines funcName, which is inlined into the
+   generated kernels with the signature
+
+      float_2 funcName(float_2* buffer, unsigned int offset,
+                       void* callerInfo) [[hc]]
+
+   for a load, returning buffer[offset], and
+
+      void funcName(float_2* buffer, unsigned int offset, float_2 element,
+                    void* callerInfo) [[hc]]
+
+   for a store of element to buffer[offset]; double_2 replaces float_2 in
+   double precision. Callbacks apply to single-kernel 1D and to 2D
+   complex-to-complex transforms, and store callbacks also to 2D
+   real-to-complex transforms; baking any other plan with a callback fails.
+   The plan is baked again by the next exec.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan         The hcfftHandle object of the plan.
+   #2 funcName     Name of the callback function.
+   #3 funcString   Source of the callback function.
+   #4 type         Type of the callback.
+   #5 callerInfo   Device pointer passed to every call of the callback.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The callback was set.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   funcName or funcString is NULL, or type does not
+                         match the precision of the plan.
+*/
+
+hcfftResult hcfftXtSetCallback(hcfftHandle plan, const char* funcName,
+                               const char* funcString, hcfftXtCallbackType type,
+                               void* callerInfo);
+
+/* Function hcfftXtSetWindow()
+   Description:
+      Makes a 1D real-to-complex plan a short-time transform: each batch of
+   the plan is a frame of nx samples of the input, idist apart, which is
+   multiplied by the window as it is read. With idist less than nx the
+   frames overlap and are read straight from the signal, e.g. for a
+   spectrogram of hop idist from a plan of hcfftPlanMany with inembed, with
+   no framed copy of the input. Frames are transformed as complex data with
+   callbacks, so that nx has to be a single-kernel length of the radices of
+   the library, and the plan out-of-place and without callbacks of its own.
+   A NULL window makes the plan a plain transform again. The plan is baked
+   again by the next exec.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan         The hcfftHandle object of a 1D HCFFT_R2C (HCFFT_D2Z) plan.
+   #2 window       nx window values (in host memory), or NULL.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The window was set.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of a 1D
+                         real-to-complex plan.
+*/
+
+hcfftResult hcfftXtSetWindow(hcfftHandle plan, const hcfftDoubleReal* window);
+
+/* Function hcfftXtSetInputExtent()
+   Description:
+      Declares that the input of a plan is 0 outside of its first extent[i]
+   elements along dimension i, in the order of the sizes the plan was
+   created with, as a small filter zero-padded to the size of the transform.
+   The plan then reads no padding and transforms only the rows within the
+   extent, a 2D plan taking the rows past it as 0 in its column transforms.
+   Pruned plans are 1D and 2D complex-to-complex and real-to-complex plans of
+   single-kernel lengths of the radices of the library, without callbacks
+   of their own. A NULL extent makes the plan dense again. The plan is baked
+   again by the next exec.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan         The hcfftHandle object of the plan.
+   #2 rank         Dimensions of the plan.
+   #3 extent       rank extents, each from 1 to the size of the dimension,
+                   or NULL.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The extent was set.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   rank is not the rank of the plan, or an extent is
+                         out of its dimension.
+*/
+
+hcfftResult hcfftXtSetInputExtent(hcfftHandle plan, int rank,
+                                  const int* extent);
+
+/* Function hcfftXtSetOutputExtent()
+   Description:
+      Makes a plan compute and store only its first extent[i] outputs along
+   dimension i, in the order of the sizes the plan was created with, as a
+   band of low frequency bins or a cropped spectrum. The other outputs are
+   left as they were. The row transforms of a 2D plan write only the
+   columns within the extent, and only those columns are transformed, so
+   that the work drops with the extent along the first dimension. The
+   extent along the first dimension of a real-to-complex plan is at most
+   nx / 2 + 1. Output extents take the plans input extents take, see
+   hcfftXtSetInputExtent, and combine with an input extent. A NULL extent
+   computes all the outputs again. The plan is baked again by the next
+   exec.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan         The hcfftHandle object of the plan.
+   #2 rank         Dimensions of the plan.
+   #3 extent       rank extents, each from 1 to the size of the dimension,
+                   or NULL.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The extent was set.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   rank is not the rank of the plan, or an extent is
+                         out of its dimension.
+*/
+
+hcfftResult hcfftXtSetOutputExtent(hcfftHandle plan, int rank,
+                                   const int* extent);
+
+/* Function hcfftDestroy()
+   Description:
+      Frees all GPU resources associated with a hcFFT plan and destroys the
+   internal plan data structure. This function should be called once a plan
+   is no longer needed, to avoid wasting GPU memory.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   plan   The hcfftHandle object of the plan to be destroyed.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        hcFFT successfully destroyed the FFT plan.
    HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
 */
 
@@ -222,6 +1377,11 @@ hcfftResult hcfftDestroy(hcfftHandle plan);
   memory pointed to by the idata parameter as input data. This function
   stores the Fourier coefficients in the odata array. If idata and odata
   are the same, this method does an in-place transform.
+  idata and odata may also be host memory the GPU reaches: that of
+  hc::am_alloc() with amHostPinned or amHostCoherent, or memory registered
+  with hc::am_memory_host_lock(). The kernels then read and write it where
+  it is, without copies to and from the device, and the host reads the
+  output after hcfftSynchronize(). The same holds for the real transforms.
 
   Input:
   ----------------------------------------------------------------------------------------------------------
@@ -247,6 +1407,359 @@ hcfftResult hcfftDestroy(hcfftHandle plan);
 hcfftResult hcfftExecC2C(hcfftHandle plan, hcfftComplex* idata,
                          hcfftComplex* odata, int direction);
 
+/* Function hcfftXtExecHalfC2C()
+   Description:
+      Executes a complex-to-complex plan set up by hcfftXtSetHalfStorage() on
+   half-precision data, like hcfftExecC2C() on single-precision data.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftHandle of a HCFFT_C2C plan with half storage
+   #2 idata       Pointer to the half-precision input data (in GPU memory)
+   #3 odata       Pointer to the half-precision output data (in GPU memory)
+   #4 direction   The transform direction: HCFFT_FORWARD or HCFFT_INVERSE
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata       Contains the complex Fourier coefficients
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the FFT plan.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of a plan
+                         with half storage.
+   HCFFT_INVALID_VALUE   idata or odata is NULL.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transform on the GPU.
+*/
+
+hcfftResult hcfftXtExecHalfC2C(hcfftHandle plan, hcfftHalfComplex* idata,
+                               hcfftHalfComplex* odata, int direction);
+
+/* Functions hcfftXtExecPlanarC2C() and hcfftXtExecPlanarZ2Z()
+   Description:
+      Executes a single-precision (double-precision) complex-to-complex plan
+   on data split into a plane of real parts and a plane of imaginary parts,
+   with the element layout the plan gives interleaved data. The planes are
+   read and written by the load and store callbacks of the plan, so no
+   interleave pass runs, the plan may have no other callbacks, and the
+   lengths must fit in single kernels of 1D or 2D plans. The first planar
+   transform bakes the callbacks into the plan, which keeps them: a plan
+   executed on planar data is for planar data only, though its planes may
+   change between transforms. The transform is in place when both planes of
+   the input are those of the output.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftHandle of a HCFFT_C2C (HCFFT_Z2Z) plan
+   #2 idataRe     Pointer to the real parts of the input (in GPU memory)
+   #3 idataIm     Pointer to the imaginary parts of the input
+   #4 odataRe     Pointer to the real parts of the output (in GPU memory)
+   #5 odataIm     Pointer to the imaginary parts of the output
+   #6 direction   The transform direction: HCFFT_FORWARD or HCFFT_INVERSE
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odataRe, odataIm   Contain the complex Fourier coefficients
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the FFT plan.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of this
+                         precision, or the plan has callbacks.
+   HCFFT_INVALID_VALUE   A pointer is NULL, or only one plane is in place.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transform on the GPU.
+*/
+
+hcfftResult hcfftXtExecPlanarC2C(hcfftHandle plan, hcfftReal* idataRe,
+                                 hcfftReal* idataIm, hcfftReal* odataRe,
+                                 hcfftReal* odataIm, int direction);
+
+hcfftResult hcfftXtExecPlanarZ2Z(hcfftHandle plan, hcfftDoubleReal* idataRe,
+                                 hcfftDoubleReal* idataIm,
+                                 hcfftDoubleReal* odataRe,
+                                 hcfftDoubleReal* odataIm, int direction);
+
+/* Functions hcfftXtExecMultiC2C(), hcfftXtExecMultiZ2Z(),
+   hcfftXtExecMultiR2C(), hcfftXtExecMultiD2Z(), hcfftXtExecMultiC2R() and
+   hcfftXtExecMultiZ2D()
+   Description:
+      Execute a plan of the matching type with its batch split across the
+   accelerators of hcfftXtSetGPUs. idata[i] and odata[i] are in the memory
+   of accelerator i and hold its chunk of the batch, laid out like a batch
+   of that size of the plan. The chunks are queued on all accelerators
+   before the function returns; hcfftSynchronize waits for all of them. The
+   transform of a chunk is in place when idata[i] is odata[i].
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftHandle of a plan with accelerators
+   #2 idata       One pointer per accelerator to the input of its chunk
+   #3 odata       One pointer per accelerator to the output of its chunk
+   #4 direction   The transform direction of the complex-to-complex
+                  functions: HCFFT_FORWARD or HCFFT_INVERSE
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata   Contain the Fourier coefficients of the chunks
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully queued the transforms.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of this
+                         precision, or the plan has no accelerators.
+   HCFFT_INVALID_VALUE   idata, odata or one of their pointers is NULL.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute a chunk, or the plan has
+                         callbacks or half or planar storage.
+*/
+
+hcfftResult hcfftXtExecMultiC2C(hcfftHandle plan, hcfftComplex** idata,
+                                hcfftComplex** odata, int direction);
+
+hcfftResult hcfftXtExecMultiZ2Z(hcfftHandle plan, hcfftDoubleComplex** idata,
+                                hcfftDoubleComplex** odata, int direction);
+
+hcfftResult hcfftXtExecMultiR2C(hcfftHandle plan, hcfftReal** idata,
+                                hcfftComplex** odata);
+
+hcfftResult hcfftXtExecMultiD2Z(hcfftHandle plan, hcfftDoubleReal** idata,
+                                hcfftDoubleComplex** odata);
+
+hcfftResult hcfftXtExecMultiC2R(hcfftHandle plan, hcfftComplex** idata,
+                                hcfftReal** odata);
+
+hcfftResult hcfftXtExecMultiZ2D(hcfftHandle plan, hcfftDoubleComplex** idata,
+                                hcfftDoubleReal** odata);
+
+/* Functions hcfftXtExecStreamC2C(), hcfftXtExecStreamZ2Z(),
+   hcfftXtExecStreamR2C(), hcfftXtExecStreamD2Z(), hcfftXtExecStreamC2R() and
+   hcfftXtExecStreamZ2D()
+   Description:
+      Execute a plan of the matching type on stream instead of on the
+   accelerator_view of the plan, like hcfftExecC2C() and the others. The
+   transform runs on the copy of the plan for stream of
+   hcfftXtGetStreamPlan(), which shares the compiled kernels of the plan, so
+   calls on different streams run concurrently from any threads and calls on
+   one stream queue in order. A workArea other than NULL is the work area
+   of this call only, as by hcfftSetWorkArea(); it must hold the size
+   hcfftGetSize() returns for the plan, and stay allocated until the
+   transform on stream completes. Changing it between calls neither waits on
+   the host nor walks the plan again: the kernel launches recorded by the
+   first call are queued on the work area of each call. With NULL the copy
+   takes its buffers from the scratch pool of stream, or allocates them.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftHandle of the plan
+   #2 idata       Pointer to the input data (in GPU memory)
+   #3 odata       Pointer to the output data (in GPU memory)
+   #4 direction   The transform direction of the complex-to-complex
+                  functions: HCFFT_FORWARD or HCFFT_INVERSE
+   #5 stream      The accelerator_view to queue the transform on
+   #6 workArea    GPU memory for the intermediate buffers, or NULL
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata   Contains the Fourier coefficients
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   As those of hcfftExecC2C(), and
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle, or its
+                         transforms are split across several GPUs.
+*/
+
+hcfftResult hcfftXtExecStreamC2C(hcfftHandle plan, hcfftComplex* idata,
+                                 hcfftComplex* odata, int direction,
+                                 hc::accelerator_view& stream,
+                                 void* workArea);
+
+hcfftResult hcfftXtExecStreamZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
+                                 hcfftDoubleComplex* odata, int direction,
+                                 hc::accelerator_view& stream,
+                                 void* workArea);
+
+hcfftResult hcfftXtExecStreamR2C(hcfftHandle plan, hcfftReal* idata,
+                                 hcfftComplex* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea);
+
+hcfftResult hcfftXtExecStreamD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
+                                 hcfftDoubleComplex* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea);
+
+hcfftResult hcfftXtExecStreamC2R(hcfftHandle plan, hcfftComplex* idata,
+                                 hcfftReal* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea);
+
+hcfftResult hcfftXtExecStreamZ2D(hcfftHandle plan, hcfftDoubleComplex* idata,
+                                 hcfftDoubleReal* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea);
+
+/* Function hcfftXtExecGroup()
+   Description:
+      Executes a group of count transforms of any plans, of any types and
+   precisions, transform i running plans[i] from idata[i] to odata[i] as the
+   exec function of its type would. The transforms are queued in order
+   without waiting, each on the accelerator_view of its plan. Consecutive
+   transforms of one plan and direction, whose buffers each follow those of
+   the transform before them by the batch of the plan at its distances, form
+   a run; the run of a plan of a single kernel is queued as one launch of
+   the whole run. Call hcfftSynchronize() on the plans to wait for them.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 count        Number of transforms of the group
+   #2 plans        hcfftHandle of the plan of each transform
+   #3 idata        Pointer to the input data of each transform (in GPU memory)
+   #4 odata        Pointer to the output data of each transform
+   #5 directions   The direction of each complex-to-complex transform,
+                   HCFFT_FORWARD or HCFFT_INVERSE, ignored for the others. NULL
+                   for forward transforms only.
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata   Contains the Fourier coefficients of each transform
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   As those of hcfftExecC2C(), for the first transform that failed; the
+   transforms before it are queued. And
+   HCFFT_INVALID_VALUE   count is not positive, or plans, idata or odata is
+                         NULL.
+   HCFFT_INVALID_PLAN    A plan is not a valid handle.
+*/
+
+hcfftResult hcfftXtExecGroup(int count, const hcfftHandle* plans, void** idata,
+                             void** odata, const int* directions);
+
+/* Function hcfftXtExecEvents()
+   Description:
+      Executes a plan of any type, as the exec function of its type would,
+   once the waitCount completion_futures of waitList are ready, without
+   blocking the host on them. A blocking marker of each future is queued on
+   the accelerator_view of the plan ahead of the kernels of the transform,
+   and a marker queued after them is returned in done, ready once the
+   transform completes. Markers of other work and futures of
+   copy_async() chain the transform into a dataflow on several
+   accelerator_views, and done can be passed on to the next stage or to
+   hcfftXtExecEvents() of another plan. The plan is baked, if it was not,
+   before the markers are queued. A transform that runs on the host, see
+   hcfftXtSetHostThreshold(), or that the host shares, see
+   hcfftXtSetHybrid(), waits for the futures on the host. Plans with
+   accelerators, see hcfftXtSetGPUs(), are not taken, as their transforms
+   run on the views of each accelerator.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftHandle of the plan
+   #2 idata       Pointer to the input data (in GPU memory)
+   #3 odata       Pointer to the output data (in GPU memory)
+   #4 direction   The transform direction of a complex-to-complex plan,
+                  HCFFT_FORWARD or HCFFT_INVERSE, ignored for the others
+   #5 waitCount   Number of futures to wait for, 0 for none
+   #6 waitList    The futures, or NULL with a waitCount of 0
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata   Contains the Fourier coefficients
+   #2 done    The marker of the completion of the transform, unless NULL
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   As those of hcfftExecC2C(); done is set on HCFFT_SUCCESS only. And
+   HCFFT_INVALID_VALUE   idata or odata is NULL, waitCount is negative, or
+                         waitList is NULL with waitCount positive.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle, or the
+                         plan has accelerators.
+   HCFFT_SETUP_FAILED    The plan could not be baked.
+*/
+
+hcfftResult hcfftXtExecEvents(hcfftHandle plan, void* idata, void* odata,
+                              int direction, int waitCount,
+                              hc::completion_future* waitList,
+                              hc::completion_future* done);
+
+/* Function hcfftXtGetGPUVolumeSplit()
+   Description:
+      Returns how a single 3D volume is split across the accelerators of
+   hcfftXtSetGPUs by hcfftXtExecMultiVolumeC2C. The slab of accelerator i
+   holds depths[i] consecutive planes of the volume (nz), the first after the
+   planes of the slabs before it. Its pencil holds rows[i] consecutive rows
+   (ny) of every plane in the same way, packed plane after plane: nx *
+   rows[i] * nz elements with the rows of plane z at nx * rows[i] * z.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     hcfftHandle of a 3D plan with accelerators
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 depths   One number of planes per accelerator
+   #2 rows     One number of rows per accelerator
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The split was returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of a 3D
+                         plan with accelerators.
+   HCFFT_INVALID_VALUE   depths or rows is NULL.
+*/
+
+hcfftResult hcfftXtGetGPUVolumeSplit(hcfftHandle plan, int* depths, int* rows);
+
+/* Functions hcfftXtExecMultiVolumeC2C() and hcfftXtExecMultiVolumeZ2Z()
+   Description:
+      Execute a 3D single-precision (double-precision) complex-to-complex plan
+   on a single volume spread across the accelerators of hcfftXtSetGPUs, in
+   the slabs and pencils of hcfftXtGetGPUVolumeSplit. The forward transform
+   goes from slabs to pencils: each accelerator transforms its planes along
+   x and y in chunks, writing the rows of each chunk into the pencils of
+   their accelerators peer to peer while it transforms the next chunk, and
+   then each accelerator transforms its pencil along z. The backward transform goes from pencils
+   to slabs, taking the steps in reverse. The output stays in the layout the
+   transform ends with, so that a forward and a backward transform need one
+   exchange each. The input is overwritten, and the buffers of each
+   accelerator are mapped to the others. The function returns when the
+   exchange is done and the last pass is queued; hcfftSynchronize waits for
+   it.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftHandle of a HCFFT_C2C (HCFFT_Z2Z) 3D plan with a
+                  batch of 1 and accelerators
+   #2 slabs       One pointer per accelerator to its slab (in its memory)
+   #3 pencils     One pointer per accelerator to its pencil (in its memory)
+   #4 direction   HCFFT_FORWARD from slabs to pencils, or HCFFT_INVERSE
+                  from pencils to slabs
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 pencils   Contain the Fourier coefficients after a forward transform
+   #2 slabs     Contain the volume after a backward transform
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the FFT plan.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of this
+                         precision, or the plan has no accelerators.
+   HCFFT_INVALID_VALUE   slabs, pencils or one of their pointers is NULL,
+                         or a slab is its pencil.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transform, or the plan
+                         is not of a single volume, or has callbacks or half
+                         or planar storage.
+*/
+
+hcfftResult hcfftXtExecMultiVolumeC2C(hcfftHandle plan, hcfftComplex** slabs,
+                                      hcfftComplex** pencils, int direction);
+
+hcfftResult hcfftXtExecMultiVolumeZ2Z(hcfftHandle plan,
+                                      hcfftDoubleComplex** slabs,
+                                      hcfftDoubleComplex** pencils,
+                                      int direction);
+
 hcfftResult hcfftExecZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
                          hcfftDoubleComplex* odata, int direction);
 
@@ -290,6 +1803,283 @@ hcfftResult hcfftExecR2C(hcfftHandle plan, hcfftReal* idata,
 hcfftResult hcfftExecD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
                          hcfftDoubleComplex* odata);
 
+/* Functions hcfftExecConvolveR2C() and hcfftExecConvolveD2Z()
+   Description:
+      Convolves each batch of the single-precision (double-precision) real
+   input with a filter given by its spectrum, from a 2D real-to-complex plan.
+   The forward transform writes its coefficients multiplied by the filter,
+   and the inverse transform of the product is stored in odata. Both
+   transforms are out of place and use the strides and distances of the plan,
+   so idata is left unchanged.
+
+   filter holds the nonredundant coefficients, as written by hcfftExecR2C()
+   with the same plan, of one filter per batch. The inverse transform is
+   scaled by 1/(nx*ny), so a filter whose spectrum is all ones returns idata.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     hcfftHandle of a 2D HCFFT_R2C (HCFFT_D2Z) plan
+   #2 idata    Pointer to the real input data (in GPU memory)
+   #3 filter   Pointer to the spectrum of the filter (in GPU memory)
+   #4 odata    Pointer to the real output data (in GPU memory)
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata    Contains the circular convolution of idata and the filter
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the convolution.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid 2D real-to-complex
+                         plan.
+   HCFFT_INVALID_VALUE   At least one of idata, filter and odata is NULL.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transforms on the GPU.
+*/
+
+hcfftResult hcfftExecConvolveR2C(hcfftHandle plan, hcfftReal* idata,
+                                 hcfftComplex* filter, hcfftReal* odata);
+
+hcfftResult hcfftExecConvolveD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
+                                 hcfftDoubleComplex* filter,
+                                 hcfftDoubleReal* odata);
+
+typedef enum hcfftR2RKind_t {
+  HCFFT_DCT_II = 0x0,   //  DCT-II, FFTW REDFT10
+  HCFFT_DCT_III = 0x1,  //  DCT-III, FFTW REDFT01
+  HCFFT_DST_II = 0x2,   //  DST-II, FFTW RODFT10
+  HCFFT_DST_III = 0x3   //  DST-III, FFTW RODFT01
+} hcfftR2RKind;
+
+/* Functions hcfftExecR2R() and hcfftExecD2D()
+   Description:
+      Executes a single-precision (double-precision) real-to-real transform
+   of kind on each batch of idata, from a 1D real-to-complex plan. The
+   transforms follow the unnormalized definitions of FFTW, for n = 0..N-1:
+
+      DCT-II   Y[k] = 2 sum x[n] cos(pi (n + 1/2) k / N)
+      DCT-III  Y[k] = x[0] + 2 sum_{n>0} x[n] cos(pi n (k + 1/2) / N)
+      DST-II   Y[k] = 2 sum x[n] sin(pi (n + 1/2) (k + 1) / N)
+      DST-III  Y[k] = (-1)^k x[N-1] + 2 sum_{n<N-1} x[n] sin(pi (n + 1)
+                      (k + 1/2) / N)
+
+   so a DCT-III of a DCT-II returns 2N times the input. The permutation and
+   twiddles run in the loads and stores of one complex transform of length
+   N, which must fit in a single kernel. The transform is out of place and
+   odata has the layout of idata, the input strides and distance of the plan.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     hcfftHandle of a 1D HCFFT_R2C (HCFFT_D2Z) plan
+   #2 idata    Pointer to the real input data (in GPU memory)
+   #3 odata    Pointer to the real output data (in GPU memory)
+   #4 kind     The real-to-real transform to execute
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata    Contains the real-to-real transform of idata
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the transform.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid 1D real-to-complex
+                         plan.
+   HCFFT_INVALID_VALUE   idata or odata is NULL, or kind is not valid.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transform on the GPU.
+*/
+
+hcfftResult hcfftExecR2R(hcfftHandle plan, hcfftReal* idata,
+                         hcfftReal* odata, hcfftR2RKind kind);
+
+hcfftResult hcfftExecD2D(hcfftHandle plan, hcfftDoubleReal* idata,
+                         hcfftDoubleReal* odata, hcfftR2RKind kind);
+
+/* Functions hcfftXtExecHostC2C() and hcfftXtExecHostZ2Z()
+   Description:
+      Executes a single-precision (double-precision) 3D complex-to-complex
+   plan on volumes in host memory, for volumes larger than the memory of the
+   device. Slabs of whole planes are copied to the device and transformed
+   along x and y while the next slab is copied, then blocks of rows of every
+   plane are streamed back for the transform along z.
+
+   The data of the plan must be packed, and the slabs and blocks are the
+   largest dividing the volume of which two fit in deviceBytes. The plan also
+   allocates the intermediate buffers of the two transforms. The host memory
+   should be pinned, e.g. allocated with hc::am_alloc and amHostPinned, for
+   the copies to overlap with the transforms. The function returns once odata
+   holds the result; idata and odata may be the same.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan          hcfftHandle of a 3D HCFFT_C2C (HCFFT_Z2Z) plan
+   #2 idata         Pointer to the complex input data (in host memory)
+   #3 odata         Pointer to the complex output data (in host memory)
+   #4 direction     HCFFT_FORWARD or HCFFT_BACKWARD
+   #5 deviceBytes   Device memory the staged data may take, in bytes
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata         Contains the complex Fourier coefficients
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the FFT plan.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of the
+                         precision.
+   HCFFT_INVALID_VALUE   idata or odata is NULL, the plan is not a packed 3D
+                         complex plan, or deviceBytes cannot hold two planes
+                         of the volume or two rows of every plane.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transform on the GPU.
+*/
+
+hcfftResult hcfftXtExecHostC2C(hcfftHandle plan, hcfftComplex* idata,
+                               hcfftComplex* odata, int direction,
+                               size_t deviceBytes);
+
+hcfftResult hcfftXtExecHostZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
+                               hcfftDoubleComplex* odata, int direction,
+                               size_t deviceBytes);
+
+/* Function hcfftXtExecHostBatch()
+   Description:
+      Executes a batched plan of any type on data in host memory, without
+   device buffers the size of the batch. The batch is cut into the largest
+   chunks dividing it of which three fit in deviceBytes, and each chunk is
+   copied to the device, transformed and copied back, the upload of a chunk
+   running beside the transform of the one before and the download of the
+   one before that, on two accelerator_views of the plan besides its own.
+   Pinned host memory, e.g. allocated with hc::am_alloc and amHostPinned, is
+   copied directly; other host memory passes through pinned buffers of the
+   plan. The plan also allocates the intermediate buffers of the chunk
+   transforms. idata and odata hold the whole batch at the distances of the
+   plan, and may be the same. The function returns once odata holds the
+   result.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan          hcfftHandle of the plan
+   #2 idata         Pointer to the input data (in host memory)
+   #3 odata         Pointer to the output data (in host memory)
+   #4 direction     HCFFT_FORWARD or HCFFT_BACKWARD for complex-to-complex
+                    plans, ignored by the others
+   #5 deviceBytes   Device memory the staged chunks may take, in bytes
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata         Contains the result of the transform
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully executed the FFT plan.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   idata or odata is NULL or in device memory, the plan
+                         is split across GPUs or has half precision or
+                         planar storage, or deviceBytes cannot hold three
+                         transforms of the batch.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transform on the GPU.
+*/
+
+hcfftResult hcfftXtExecHostBatch(hcfftHandle plan, void* idata, void* odata,
+                                 int direction, size_t deviceBytes);
+
+/* Functions hcfftXtPlanConvolveStreamR2C() and hcfftXtPlanConvolveStreamD2Z()
+   Description:
+      Creates a single-precision (double-precision) plan convolving a stream
+   of real samples with a real filter, block by block, by overlap-save. Each
+   block of blockLength samples gives the blockLength samples of the linear
+   convolution at the same positions, the samples of the blocks before it in
+   the stream taking part in it as in one long convolution:
+
+      y[i] = sum over m of filter[m] * x[i - m]
+
+   Segments of a power of 2 length are transformed with a forward
+   transform multiplied by the spectrum of the filter and an inverse
+   transform, two real segments to a complex transform. The filter length
+   is therefore at most the largest length of a single-kernel transform.
+   The plan allocates the spectrum, its buffers of two blocks in and out
+   and the spectra of a block, and is destroyed with hcfftDestroy.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan           Pointer to a hcfftHandle object
+   #2 blockLength    Samples of a block of the stream
+   #3 filter         Pointer to the filter taps (in host memory)
+   #4 filterLength   Taps of the filter
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan           Contains a hcFFT convolution stream plan handle value
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully created the plan.
+   HCFFT_INVALID_VALUE   plan or filter is NULL.
+   HCFFT_INVALID_SIZE    blockLength or filterLength is not positive, or the
+                         filter is longer than the largest segment.
+   HCFFT_SETUP_FAILED    hcFFT failed to allocate or bake the plan.
+*/
+
+hcfftResult hcfftXtPlanConvolveStreamR2C(hcfftHandle* plan, int blockLength,
+                                         hcfftReal* filter, int filterLength);
+
+hcfftResult hcfftXtPlanConvolveStreamD2Z(hcfftHandle* plan, int blockLength,
+                                         hcfftDoubleReal* filter,
+                                         int filterLength);
+
+/* Functions hcfftXtExecConvolveStreamR2C() and hcfftXtExecConvolveStreamD2Z()
+   Description:
+      Convolves the next blocks of the stream of a single-precision
+   (double-precision) convolution stream plan with its filter. Block k + 1
+   is copied to the device while block k is convolved, and the result of
+   block k copied back, so that the host memory should be pinned, e.g.
+   allocated with hc::am_alloc and amHostPinned, for the copies to overlap
+   with the transforms. The function returns once odata holds the result.
+   The last samples of the last block are kept for the next call.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan       hcfftHandle returned by hcfftXtPlanConvolveStreamR2C (D2Z)
+   #2 idata      Pointer to blocks blocks of input samples (in host memory)
+   #3 odata      Pointer to blocks blocks of output samples (in host memory)
+   #4 blocks     Blocks to convolve
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 odata      Contains the convolution of the blocks
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully convolved the blocks.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid convolution stream
+                         plan of the precision.
+   HCFFT_INVALID_VALUE   idata or odata is NULL, or blocks is negative.
+   HCFFT_EXEC_FAILED     hcFFT failed to execute the transforms on the GPU.
+*/
+
+hcfftResult hcfftXtExecConvolveStreamR2C(hcfftHandle plan, hcfftReal* idata,
+                                         hcfftReal* odata, int blocks);
+
+hcfftResult hcfftXtExecConvolveStreamD2Z(hcfftHandle plan,
+                                         hcfftDoubleReal* idata,
+                                         hcfftDoubleReal* odata, int blocks);
+
+/* Function hcfftXtResetConvolveStream()
+   Description:
+      Starts the stream of a convolution stream plan over: the samples before
+   the next block are 0, as before the first block of a new plan.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan       hcfftHandle returned by hcfftXtPlanConvolveStreamR2C (D2Z)
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         hcFFT successfully reset the stream.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid convolution stream
+                         plan.
+*/
+
+hcfftResult hcfftXtResetConvolveStream(hcfftHandle plan);
+
 /* Functions hcfftExecC2R() and hcfftExecZ2D()
 
   Description:
@@ -0,0 +1,303 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef LIB_INCLUDE_HCFFT_HPP_
+#define LIB_INCLUDE_HCFFT_HPP_
+
+#include "include/hcfft.h"
+#include "include/hcfftlib.h"
+
+/* Typed C++ plans, on top of the FFTPlan of the library.
+
+   An hcfft::plan<Type, T, Dim> is a transform of type hcfft::c2c, r2c or
+   c2r, in float or double precision, of Dim dimensions. The type and
+   precision are template parameters, so that forward() and inverse() take
+   buffers of the right element types and go straight to the transform of
+   that precision. A plan is baked for its placeness and layouts when it is
+   created, and its execs neither switch on the type nor set them again.
+
+   The lengths of a plan are those of FFTPlan: lengths[0] is the contiguous
+   dimension. Data is packed in the order of the lengths; the complex side
+   of a real transform holds lengths[0] / 2 + 1 elements in dimension 0, and
+   the real side of an in-place one is padded to twice that. The batches
+   follow one another.
+
+   Plans own their FFTPlan and destroy it with themselves. They are moved,
+   not copied. Unlike the C API, execs always run on the GPU, never on the
+   host or shared with it. */
+
+namespace hcfft {
+
+struct c2c {};
+struct r2c {};
+struct c2r {};
+
+template <typename T>
+struct precision_traits;
+
+template <>
+struct precision_traits<float> {
+  typedef hcfftReal real;
+  typedef hcfftComplex complex;
+  static const hcfftPrecision precision = HCFFT_SINGLE;
+};
+
+template <>
+struct precision_traits<double> {
+  typedef hcfftDoubleReal real;
+  typedef hcfftDoubleComplex complex;
+  static const hcfftPrecision precision = HCFFT_DOUBLE;
+};
+
+//  Element types, layouts and directions of the transforms of a type
+template <typename Type, typename T>
+struct transform_traits;
+
+template <typename T>
+struct transform_traits<c2c, T> {
+  typedef typename precision_traits<T>::complex input;
+  typedef typename precision_traits<T>::complex output;
+  static const hcfftLibType libType = HCFFT_C2CZ2Z;
+  static const hcfftDirection direction = HCFFT_BOTH;
+  static const hcfftIpLayout iLayout = HCFFT_COMPLEX_INTERLEAVED;
+  static const hcfftOpLayout oLayout = HCFFT_COMPLEX_INTERLEAVED;
+};
+
+template <typename T>
+struct transform_traits<r2c, T> {
+  typedef typename precision_traits<T>::real input;
+  typedef typename precision_traits<T>::complex output;
+  static const hcfftLibType libType = HCFFT_R2CD2Z;
+  static const hcfftDirection direction = HCFFT_FORWARD;
+  static const hcfftIpLayout iLayout = HCFFT_REAL;
+  static const hcfftOpLayout oLayout = HCFFT_HERMITIAN_INTERLEAVED;
+};
+
+template <typename T>
+struct transform_traits<c2r, T> {
+  typedef typename precision_traits<T>::complex input;
+  typedef typename precision_traits<T>::real output;
+  static const hcfftLibType libType = HCFFT_C2RZ2D;
+  static const hcfftDirection direction = HCFFT_BACKWARD;
+  static const hcfftIpLayout iLayout = HCFFT_HERMITIAN_INTERLEAVED;
+  static const hcfftOpLayout oLayout = HCFFT_REAL;
+};
+
+//  Plans only dispatch to the plans of FFTRepo, as the planObject of the C
+//  API does
+inline FFTPlan& dispatcher() {
+  static FFTPlan planObject;
+  return planObject;
+}
+
+template <typename Type, typename T, int Dim>
+class plan {
+  static_assert(Dim >= 1 && Dim <= 3, "plans have 1 to 3 dimensions");
+
+ public:
+  typedef transform_traits<Type, T> traits;
+  typedef typename traits::input input_type;
+  typedef typename traits::output output_type;
+
+  //  A plan of batch transforms on the default accelerator_view of the
+  //  first GPU; status() tells whether it was created
+  explicit plan(const size_t (&lengths)[Dim], size_t batch = 1,
+                hcfftResLocation location = HCFFT_OUTOFPLACE)
+      : handle_(0), location_(location) {
+    status_ = create(lengths, batch, NULL);
+  }
+
+  //  A plan whose transforms are queued on acc_view
+  plan(const size_t (&lengths)[Dim], hc::accelerator_view& acc_view,
+       size_t batch = 1, hcfftResLocation location = HCFFT_OUTOFPLACE)
+      : handle_(0), location_(location) {
+    status_ = create(lengths, batch, &acc_view);
+  }
+
+  plan(plan&& other)
+      : handle_(other.handle_),
+        location_(other.location_),
+        status_(other.status_) {
+    other.handle_ = 0;
+    other.status_ = HCFFT_INVALID_PLAN;
+  }
+
+  plan& operator=(plan&& other) {
+    if (this != &other) {
+      destroy();
+      handle_ = other.handle_;
+      location_ = other.location_;
+      status_ = other.status_;
+      other.handle_ = 0;
+      other.status_ = HCFFT_INVALID_PLAN;
+    }
+
+    return *this;
+  }
+
+  plan(const plan&) = delete;
+  plan& operator=(const plan&) = delete;
+
+  ~plan() { destroy(); }
+
+  //  HCFFT_SUCCESS for a plan ready for execs, otherwise why it is not
+  hcfftResult status() const { return status_; }
+
+  //  The handle of the plan, for the hcfftXt functions of the C API. It
+  //  stays owned by the plan.
+  hcfftHandle handle() const { return handle_; }
+
+  //  Queue a forward transform of in to out; in and out are the same
+  //  buffer for in-place plans only
+  hcfftResult forward(input_type* in, output_type* out) {
+    static_assert(traits::direction != HCFFT_BACKWARD,
+                  "c2r plans only transform backward");
+    return enqueue(HCFFT_FORWARD, in, out);
+  }
+
+  //  Queue a backward transform of in to out, unnormalized
+  hcfftResult inverse(input_type* in, output_type* out) {
+    static_assert(traits::direction != HCFFT_FORWARD,
+                  "r2c plans only transform forward");
+    return enqueue(HCFFT_BACKWARD, in, out);
+  }
+
+ private:
+  //  Packed strides and distance of a side of the transform, complex sides
+  //  of real transforms storing half of dimension 0
+  void packedShape(const size_t (&lengths)[Dim], hcfftIpLayout layout,
+                   size_t* strides, size_t& distance) const {
+    bool real = (traits::libType != HCFFT_C2CZ2Z);
+    size_t row = real ? lengths[0] / 2 + 1 : lengths[0];
+
+    if (layout == HCFFT_REAL) {
+      row = (location_ == HCFFT_INPLACE) ? 2 * row : lengths[0];
+    }
+
+    strides[0] = 1;
+    distance = row;
+
+    for (int i = 1; i < Dim; i++) {
+      strides[i] = distance;
+      distance *= lengths[i];
+    }
+  }
+
+  hcfftResult create(const size_t (&lengths)[Dim], size_t batch,
+                     hc::accelerator_view* acc_view) {
+    for (int i = 0; i < Dim; i++) {
+      if (lengths[i] == 0) {
+        return HCFFT_INVALID_SIZE;
+      }
+    }
+
+    if (batch == 0 ||
+        (location_ != HCFFT_INPLACE && location_ != HCFFT_OUTOFPLACE)) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    FFTPlan& planObject = dispatcher();
+    hcfftPlanHandle handle = 0;
+
+    if (planObject.hcfftCreateDefaultPlan(
+            &handle, static_cast<hcfftDim>(Dim), lengths, traits::direction,
+            precision_traits<T>::precision, traits::libType) !=
+        HCFFT_SUCCEEDS) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    handle_ = handle;
+    size_t inStrides[Dim], outStrides[Dim];
+    size_t inDistance, outDistance;
+    packedShape(lengths, traits::iLayout, inStrides, inDistance);
+    packedShape(lengths, traits::oLayout, outStrides, outDistance);
+    hcfftDim dim = static_cast<hcfftDim>(Dim);
+    bool set =
+        (acc_view == NULL ||
+         planObject.hcfftSetAcclView(handle, *acc_view) == HCFFT_SUCCEEDS) &&
+        planObject.hcfftSetPlanPrecision(
+            handle, precision_traits<T>::precision) == HCFFT_SUCCEEDS &&
+        planObject.hcfftSetPlanTransposeResult(handle, HCFFT_NOTRANSPOSE) ==
+            HCFFT_SUCCEEDS &&
+        planObject.hcfftSetPlanInStride(handle, dim, inStrides) ==
+            HCFFT_SUCCEEDS &&
+        planObject.hcfftSetPlanOutStride(handle, dim, outStrides) ==
+            HCFFT_SUCCEEDS &&
+        planObject.hcfftSetPlanDistance(handle, inDistance, outDistance) ==
+            HCFFT_SUCCEEDS &&
+        planObject.hcfftSetPlanBatchSize(handle, batch) == HCFFT_SUCCEEDS;
+
+    // Transforms to real data are unnormalized, as in the C API
+    if (set && traits::libType == HCFFT_C2RZ2D) {
+      set = planObject.hcfftSetPlanScale(handle, HCFFT_BACKWARD, 1.0) ==
+            HCFFT_SUCCEEDS;
+    }
+
+    if (!set) {
+      return HCFFT_SETUP_FAILED;
+    }
+
+    if (planObject.hcfftPrepareExec(handle, location_, traits::iLayout,
+                                    traits::oLayout) != HCFFT_SUCCEEDS) {
+      return HCFFT_SETUP_FAILED;
+    }
+
+    return HCFFT_SUCCESS;
+  }
+
+  hcfftResult enqueue(hcfftDirection dir, void* in, void* out) {
+    if (status_ != HCFFT_SUCCESS) {
+      return HCFFT_INVALID_PLAN;
+    }
+
+    if (in == NULL || out == NULL ||
+        (in == out) != (location_ == HCFFT_INPLACE)) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    FFTPlan& planObject = dispatcher();
+
+    if (planObject.hcfftEnqueueTransform<T>(handle_, dir, static_cast<T*>(in),
+                                            static_cast<T*>(out),
+                                            NULL) != HCFFT_SUCCEEDS) {
+      return planObject.hcfftNeedsWorkArea(handle_) ? HCFFT_NO_WORKSPACE
+                                                    : HCFFT_EXEC_FAILED;
+    }
+
+    return HCFFT_SUCCESS;
+  }
+
+  void destroy() {
+    if (handle_ != 0) {
+      dispatcher().hcfftDestroyPlan(&handle_);
+      handle_ = 0;
+    }
+  }
+
+  hcfftPlanHandle handle_;
+  hcfftResLocation location_;
+  hcfftResult status_;
+};
+
+}  // namespace hcfft
+
+#endif  // LIB_INCLUDE_HCFFT_HPP_
@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef LIB_INCLUDE_HCFFT_MPI_H_
+#define LIB_INCLUDE_HCFFT_MPI_H_
+
+#include <mpi.h>
+#include "include/hcfft.h"
+
+/* Distributed 3D transforms, in the separate hcfft_mpi library.
+
+   The ranks of the communicator form a p1 x p2 grid, rank r at row r / p2
+   and column r % p2, each with its own GPU. A rank at row r1 and column r2
+   holds pencils of the nx x ny x nz volume (x varying fastest), where the
+   block of a length n for index k of p is the n / p elements starting at
+   k * (n / p) + min(k, n % p), plus one for the first n % p indices:
+
+   x pencil   all of x, block r1 of ny, block r2 of nz, laid out [z][y][x]
+   z pencil   block r1 of nx, block r2 of ny, all of z, laid out [x][y][z]
+
+   A forward transform takes x pencils to z pencils, and a backward one z
+   pencils to x pencils. The local stages are batched 1D hcFFT plans, and
+   each of the two exchanges between them is an all-to-all across a row or
+   a column of the grid, cut into chunks so that the transfer of a chunk
+   overlaps the local transform of the next one. */
+
+typedef struct hcfftMpiPlan_t* hcfftMpiHandle;
+
+/* Function hcfftMpiPlan3d()
+   Description:
+      Creates a distributed 3D complex-to-complex plan on the ranks of comm,
+   collectively. Every rank passes the same arguments. The pencils of a rank
+   are in the memory of the default GPU of the process.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     Pointer to a hcfftMpiHandle object
+   #2 comm     Communicator of p1 * p2 ranks
+   #3 p1, p2   Rows and columns of the grid of ranks
+   #4 nx, ny, nz   The transform sizes, with p1 <= min(nx, ny) and
+                   p2 <= min(ny, nz)
+   #5 type     HCFFT_C2C or HCFFT_Z2Z
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     Contains a distributed plan handle value
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The plan was created.
+   HCFFT_ALLOC_FAILED    The staging buffers could not be allocated.
+   HCFFT_INVALID_VALUE   plan is NULL, the grid is not the size of comm, or
+                         type is not a complex-to-complex type.
+   HCFFT_INVALID_SIZE    The sizes do not fit the grid.
+*/
+
+hcfftResult hcfftMpiPlan3d(hcfftMpiHandle* plan, MPI_Comm comm, int p1, int p2,
+                           int nx, int ny, int nz, hcfftType type);
+
+/* Function hcfftMpiSetChunks()
+   Description:
+      Sets the number of chunks each exchange is cut into, 2 by default. An
+   exchange takes the largest number of chunks up to chunks that divides the
+   pencils evenly; 1 disables the overlap.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan     hcfftMpiHandle returned by hcfftMpiPlan3d
+   #2 chunks   Number of chunks, at least 1
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The setting was changed.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   chunks is less than 1.
+*/
+
+hcfftResult hcfftMpiSetChunks(hcfftMpiHandle plan, int chunks);
+
+/* Function hcfftMpiGetLocalSize()
+   Description:
+      Returns the first index and the length along x, y and z of the x pencil
+   and the z pencil of the calling rank.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan      hcfftMpiHandle returned by hcfftMpiPlan3d
+
+   Output:
+   -----------------------------------------------------------------------------------------------------
+   #1 xStart, xSize   Start and lengths of the x pencil, in x, y, z order
+   #2 zStart, zSize   Start and lengths of the z pencil, in x, y, z order
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The sizes were returned.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+   HCFFT_INVALID_VALUE   An output is NULL.
+*/
+
+hcfftResult hcfftMpiGetLocalSize(hcfftMpiHandle plan, int xStart[3],
+                                 int xSize[3], int zStart[3], int zSize[3]);
+
+/* Functions hcfftMpiExecC2C() and hcfftMpiExecZ2Z()
+   Description:
+      Execute a distributed plan, collectively. In the forward direction
+   idata holds the x pencil and odata receives the z pencil of the rank;
+   in the backward direction idata holds the z pencil and odata receives
+   the x pencil. Both are in GPU memory, idata is overwritten, and the
+   transform is complete on the rank when the function returns.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   #1 plan        hcfftMpiHandle of a plan of the matching type
+   #2 idata       Pointer to the input pencil (in GPU memory)
+   #3 odata       Pointer to the output pencil (in GPU memory)
+   #4 direction   The transform direction: HCFFT_FORWARD or HCFFT_INVERSE
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The transform was executed.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle of this
+                         precision.
+   HCFFT_INVALID_VALUE   idata or odata is NULL, or they are the same.
+   HCFFT_EXEC_FAILED     A local transform failed.
+   HCFFT_INTERNAL_ERROR  An exchange failed.
+*/
+
+hcfftResult hcfftMpiExecC2C(hcfftMpiHandle plan, hcfftComplex* idata,
+                            hcfftComplex* odata, int direction);
+
+hcfftResult hcfftMpiExecZ2Z(hcfftMpiHandle plan, hcfftDoubleComplex* idata,
+                            hcfftDoubleComplex* odata, int direction);
+
+/* Function hcfftMpiDestroy()
+   Description:
+      Frees the local plans, the communicators and the buffers of a
+   distributed plan, collectively.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS         The plan was destroyed.
+   HCFFT_INVALID_PLAN    The plan parameter is not a valid handle.
+*/
+
+hcfftResult hcfftMpiDestroy(hcfftMpiHandle plan);
+
+#endif  // LIB_INCLUDE_HCFFT_MPI_H_
@@ -24,17 +24,27 @@ THE SOFTWARE.
 #define LIB_INCLUDE_HCFFTLIB_H_
 
 #include <hc_am.hpp>
+#include <atomic>
+#include <chrono>
 #include <complex>
 #include <dirent.h>
+#include <future>
 #include <hc.hpp>
 #include <hc_short_vector.hpp>
 #include <iostream>
+#include <memory>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <utility>
 #include "./lock.h"
 
+#ifdef HCFFT_ROCTX
+#include <roctx.h>
+#include <sstream>
+#endif
+
 #define HCFFT_CB_NY 0
 #define HCFFT_CB_NZ 1
 #define HCFFT_CB_NW 2
@@ -52,6 +62,10 @@ THE SOFTWARE.
 #define HCFFT_CB_SIZE 32
 #define THREADS 16
 
+// Bump whenever a generator change alters the emitted kernel source, so that
+// libraries already in the kernel cache are no longer matched.
+#define HCFFT_KERNEL_GEN_VERSION 9
+
 #define BUG_CHECK(_proposition)    \
   {                                \
     bool btmp = (_proposition);    \
@@ -73,11 +87,19 @@ enum BlockComputeType {
 };
 
 // NonSquareKernelType
+//  The last three are the steps of the in-place transpose of any m x n
+//  matrix, by a rotation of its columns when gcd(m, n) > 1, a shuffle of its
+//  rows and a shuffle of its columns (Catanzaro, Keller and Garland, "A
+//  Decomposition for In-place Matrix Transposition"). Each step permutes
+//  lines independently, in LDS.
 enum NonSquareTransposeKernelType {
   NON_SQUARE_TRANS_PARENT,
   NON_SQUARE_TRANS_TRANSPOSE_BATCHED_LEADING,
   NON_SQUARE_TRANS_TRANSPOSE_BATCHED,
-  NON_SQUARE_TRANS_SWAP
+  NON_SQUARE_TRANS_SWAP,
+  NON_SQUARE_TRANS_COLUMN_ROTATE,
+  NON_SQUARE_TRANS_ROW_SHUFFLE,
+  NON_SQUARE_TRANS_COLUMN_SHUFFLE
 };
 
 /*
@@ -119,7 +141,17 @@ typedef enum hcfftPrecision_ {
   HCFFT_DOUBLE,
 } hcfftPrecision;
 
-typedef enum hcfftDim_ { HCFFT_1D = 1, HCFFT_2D, HCFFT_3D } hcfftDim;
+//  Plans of more than 3 dimensions run as a 3D transform batched over the
+//  further dimensions followed by 1D transforms along each of them, see
+//  hcfftBakeRankN
+typedef enum hcfftDim_ {
+  HCFFT_1D = 1,
+  HCFFT_2D,
+  HCFFT_3D,
+  HCFFT_4D,
+  HCFFT_5D,
+  HCFFT_6D
+} hcfftDim;
 
 typedef enum hcfftLayout_ {
   HCFFT_COMPLEX_INTERLEAVED = 1,  // An array of complex numbers, with real and
@@ -153,6 +185,18 @@ typedef enum hcfftResTransposed_ {
   HCFFT_TRANSPOSED,
 } hcfftResTransposed;
 
+typedef enum hcfftCallbackType_ {
+  HCFFT_CALLBACK_LOAD = 1,
+  HCFFT_CALLBACK_STORE,
+} hcfftCallbackType;
+
+typedef enum hcfftRealKind_ {
+  HCFFT_REDFT10 = 0,  //  DCT-II
+  HCFFT_REDFT01,      //  DCT-III
+  HCFFT_RODFT10,      //  DST-II
+  HCFFT_RODFT01,      //  DST-III
+} hcfftRealKind;
+
 typedef enum hcfftStatus_ {
   HCFFT_SUCCEEDS = 0,
   HCFFT_INVALID = -1,
@@ -167,6 +211,13 @@ typedef enum hcfftGenerators_ {
   Copy,
 } hcfftGenerators;
 
+static inline const char* GeneratorName(hcfftGenerators gen) {
+  static const char* const names[] = {"Stockham", "Transpose_GCN",
+                                      "Transpose_SQUARE",
+                                      "Transpose_NONSQUARE", "Copy"};
+  return names[gen];
+}
+
 static inline bool IsPo2(size_t u) { return (u != 0) && (0 == (u & (u - 1))); }
 
 inline void BSF(unsigned long* index, size_t& mask) {
@@ -242,6 +293,23 @@ inline std::string SztToStr(size_t i) {
   return ss.str();
 }
 
+#define HCFFT_STRINGIFY_(x) #x
+#define HCFFT_STRINGIFY(x) HCFFT_STRINGIFY_(x)
+
+// Arguments of a generated kernel entry point: the buffers of the transform,
+// inputs then outputs, followed by the twiddle tables of the plan, and the
+// strides and distances read by kernels of runtime shape, see
+// FFTKernelGenKeyParams::fft_runtimeShape. The same declaration is emitted
+// into every kernel source by hcHeader().
+#define HCFFT_KERNEL_ARGS_DECL   \
+  struct hcfftKernelArgs {       \
+    void* buffers[8];            \
+    unsigned int inStride[16];   \
+    unsigned int outStride[16];  \
+  }
+
+HCFFT_KERNEL_ARGS_DECL;
+
 inline std::string hcHeader() {
   return "#include <hc.hpp>\n"
          "#include <hc_am.hpp>\n"
@@ -251,7 +319,8 @@ inline std::string hcHeader() {
          "#include <iostream>\n"
          "using namespace hc;\n"
          "using namespace hc::fast_math;\n"
-         "using namespace hc::short_vector;\n";
+         "using namespace hc::short_vector;\n" HCFFT_STRINGIFY(
+             HCFFT_KERNEL_ARGS_DECL) ";\n";
 }
 
 static size_t width(hcfftPrecision precision) {
@@ -274,6 +343,17 @@ inline std::string getHomeDir() {
   return pwd;
 }
 
+// Directory of the JIT kernel cache, HCFFT_CACHE_DIR or ~/kernCache
+inline std::string getKernelCacheDir() {
+  char* cachedir = getenv("HCFFT_CACHE_DIR");
+
+  if (cachedir != NULL && *cachedir != '\0') {
+    return std::string(cachedir);
+  }
+
+  return getHomeDir() + "/kernCache";
+}
+
 namespace ARBITRARY {
 // TODO(Neelakandan):  These arbitrary parameters should be tuned for the type
 // of GPU being used.  These values are probably OK for Radeon 58xx and 68xx.
@@ -290,13 +370,15 @@ enum {
 
   LDS_BANK_BITS = 5,
   LDS_BANK_SIZE = (1 << LDS_BANK_BITS),
-  LDS_PADDING = false,  // true,
+  LDS_PADDING = true,
   //  On AMD hardware, the low-order bits of the local_id enumerate
   //  the work items that access LDS in parallel.  Ideally, we will
   //  pad our LDS arrays so that these work items access different banks
   //  of the LDS. 2 ** LDS_BANK_BITS is the number of LDS banks.
-  //  If LDS_PADDING is non-zero, the kernel generator should pad the
-  //  LDS arrays to reduce or eliminate bank conflicts.
+  //  If LDS_PADDING is non-zero, the Stockham generator swizzles the LDS
+  //  exchanges of power-of-2 passes at strided accesses, which spreads
+  //  them over the banks without growing the LDS arrays.  hc does not
+  //  report the bank count; GCN LDS has 32 banks of 4 bytes.
 
   LDS_FRACTION_IDEAL = 6,  // i.e., 1/6th
   LDS_FRACTION_MAX = 4,    // i.e., 1/4
@@ -346,7 +428,7 @@ class tofstreamRAII {
 
 struct FFTEnvelope {
   long limit_LocalMemSize;
-  //  this is the minimum of CL_DEVICE_LOCAL_MEM_SIZE
+  //  this is the tile_static memory size of the accelerator
   size_t limit_Dimensions;
   //  this is the minimum of CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS
   size_t limit_Size[8];
@@ -393,11 +475,19 @@ struct FFTKernelGenKeyParams {
   //                                  more efficient kernels, but not always.
   //                                  see FFTPlan::bLdsComplex and
   //                                  ARBITRARY::LDS_COMPLEX
-  bool fft_ldsPadding;          //    default padding is false
+  bool fft_ldsPadding;          //    Swizzle the LDS of strided passes,
+  //                                  see ARBITRARY::LDS_PADDING
   bool fft_3StepTwiddle;        //    This is one pass of the "3-step"
   //                                  algorithm; so extra twiddles are applied
   //                                  on output.
   bool fft_twiddleFront;       //     do twiddle scaling at the beginning pass
+  bool fft_singleTwiddles;     //     double-precision kernel reading its
+  //                                  pass twiddles from a float_2 table
+  bool fft_computeTwiddles;    //     3-step twiddles evaluated in the kernel
+  //                                  in place of the twiddle_dee table
+  bool fft_lds2D;              //     2D kernel holding whole images in LDS,
+  //                                  fft_R images on fft_SIMD work-items,
+  //                                  real ones packed two to a complex one
   bool fft_realSpecial;        //     this is the flag to control the special
   //                                  case step (4th step) in the 5-step real
   //                                  1D large breakdown
@@ -408,6 +498,10 @@ struct FFTKernelGenKeyParams {
   BlockComputeType blockComputeType;
   size_t blockSIMD;
   size_t blockLDS;
+  //  Names of the user callbacks the kernel calls on its global reads and
+  //  writes, or NULL. The functions are defined in the plan's hcfftCallback.
+  const char* fft_loadCallback;
+  const char* fft_storeCallback;
 
   NonSquareTransposeKernelType nonSquareKernelType;
   // sometimes non square matrix are broken down into a number of
@@ -422,6 +516,12 @@ struct FFTKernelGenKeyParams {
   NON_SQUARE_KERNEL_ORDER nonSquareKernelOrder;
 
   bool fft_RCsimple;
+  bool fft_RCsplit;
+
+  //  Strides and distances above the first are read from hcfftKernelArgs at
+  //  launch instead of being compiled in. Only their parity, which decides
+  //  the grouped reads and writes, is part of the kernel.
+  bool fft_runtimeShape;
 
   ulong limit_LocalMemSize;
 
@@ -446,14 +546,21 @@ struct FFTKernelGenKeyParams {
     fft_MaxWorkGroupSize = 0;
     fft_3StepTwiddle = false;
     fft_twiddleFront = false;
+    fft_singleTwiddles = false;
+    fft_computeTwiddles = false;
+    fft_lds2D = false;
     transOutHorizontal = false;
     fft_realSpecial = false;
     fft_realSpecial_Nr = 0;
     fft_RCsimple = false;
+    fft_RCsplit = false;
+    fft_runtimeShape = false;
     blockCompute = false;
     blockComputeType = BCT_R2C;
     blockSIMD = 0;
     blockLDS = 0;
+    fft_loadCallback = NULL;
+    fft_storeCallback = NULL;
     nonSquareKernelType = NON_SQUARE_TRANS_PARENT;
     transposeMiniBatchSize = 1;
     transposeBatchSize = 1;
@@ -461,14 +568,262 @@ struct FFTKernelGenKeyParams {
   }
 };
 
+//  Time a plan spent getting ready for execution, in seconds. The twiddle
+//  generators add to hcfftTwiddleSeconds of the calling thread, which the
+//  bake reads around kernel generation.
+struct FFTPlanTimings {
+  bool hasKernel;
+  bool cacheHit;
+  double generate;
+  double write;
+  double compile;
+  double load;
+  double twiddle;
+  double alloc;
+  double tune;
+
+  FFTPlanTimings()
+      : hasKernel(false),
+        cacheHit(false),
+        generate(0),
+        write(0),
+        compile(0),
+        load(0),
+        twiddle(0),
+        alloc(0),
+        tune(0) {}
+};
+
+//  One kernel of the last profiled transform of a plan. role is the path of
+//  sub-plan members from the plan to the plan of the kernel, "plan" for the
+//  plan itself, and bytes those of the input it reads and the output it
+//  writes. flops are the nominal 5 N log2 N of its transforms, half for real
+//  ones and none for transposes and copies. start and end are in seconds
+//  from a marker queued before the first kernel, see hcfftGetPlanProfile.
+struct hcfftKernelProfile {
+  std::string role;
+  hcfftGenerators gen;
+  size_t bytes;
+  double flops;
+  double start;
+  double end;
+
+  hcfftKernelProfile()
+      : gen(Stockham), bytes(0), flops(0), start(0), end(0) {}
+};
+
+//  A plan of a tree as hcfftGetPlanInfo describes it. role is the member of
+//  its parent plan it is, "plan" for the root, and scratchBytes the sizes of
+//  its intermediate buffers.
+struct FFTPlanInfo {
+  size_t depth;
+  std::string role;
+  bool baked;
+  bool hasKernel;
+  hcfftGenerators gen;
+  std::vector<size_t> length;
+  std::vector<size_t> inStride;
+  std::vector<size_t> outStride;
+  size_t iDist;
+  size_t oDist;
+  size_t batchSize;
+  hcfftIpLayout ipLayout;
+  hcfftOpLayout opLayout;
+  hcfftResLocation location;
+  size_t large1D;
+  size_t large1D_Xfactor;
+  NON_SQUARE_KERNEL_ORDER nonSquareKernelOrder;
+  bool RCsimple;
+  bool realSpecial;
+  bool blockCompute;
+  bool bluestein;
+  bool rader;
+  size_t scratchBytes;
+  std::string kernellib;
+};
+
+//  Work-group size, transforms per work-group and LDS layout a Stockham
+//  kernel is generated with in place of those of DetermineSizes, as picked by
+//  the autotuner. description names the transform it was tuned on for the
+//  readers of a wisdom file.
+struct hcfftKernelTuning {
+  size_t workGroupSize;
+  size_t numTrans;
+  bool ldsComplex;
+  std::string description;
+
+  hcfftKernelTuning() : workGroupSize(0), numTrans(0), ldsComplex(false) {}
+};
+
+extern thread_local double hcfftTwiddleSeconds;
+
+//  Fill the twiddle table of a Stockham kernel of radices, or the rows x
+//  columns table of the large twiddles of length, on acc, in double or
+//  single precision, without staging them on the host
+void hcfftDeviceTwiddles(hc::accelerator& acc, void* table, bool dbl,
+                         const std::vector<size_t>& radices);
+void hcfftDeviceTwiddlesLarge(hc::accelerator& acc, void* table, bool dbl,
+                              size_t length, size_t rows, size_t columns);
+
+//  Counters of the library as a whole, read by hcfftGetStats. Plans are the
+//  top-level ones. Kernels of a bake hit the kernels of live plans, hit a
+//  library on disk or miss; misses are compiled by one bake of the process.
+//  The byte gauges follow the scratch pools and intermediate buffers, and
+//  the shared twiddle, chirp and R2R tables, as they are allocated and freed.
+struct hcfftRuntimeCounters {
+  std::atomic<size_t> plansCreated;
+  std::atomic<size_t> plansDestroyed;
+  std::atomic<size_t> memoryHits;
+  std::atomic<size_t> diskHits;
+  std::atomic<size_t> misses;
+  std::atomic<size_t> compiles;
+  std::atomic<unsigned long long> compileNanoseconds;
+  std::atomic<size_t> dlopens;
+  std::atomic<size_t> scratchBytes;
+  std::atomic<size_t> twiddleBytes;
+  std::atomic<size_t> execs;
+  std::atomic<size_t> launches;
+};
+
+extern hcfftRuntimeCounters hcfftCounters;
+
+//  User function inlined into the generated kernel. funcString defines
+//  funcName, which the kernel calls with userdata on each element it reads
+//  or writes.
+struct hcfftCallback {
+  std::string funcName;
+  std::string funcString;
+  void* userdata;
+
+  hcfftCallback() : userdata(NULL) {}
+
+  bool empty() const { return funcName.empty(); }
+};
+
+//  Adds the lifetime of the object to total
+class scopedTimer {
+ public:
+  explicit scopedTimer(double& total)
+      : total(total), start(std::chrono::steady_clock::now()) {}
+
+  ~scopedTimer() {
+    total += std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start).count();
+  }
+
+ private:
+  double& total;
+  std::chrono::steady_clock::time_point start;
+};
+
+//  ROCTX ranges around bakes, compiles and kernel launches, so that they line
+//  up with the kernels of the application in rocprof. Built with
+//  -DHCFFT_ROCTX only; otherwise HCFFT_TRACE_RANGE does not even format its
+//  name, which is streamed as in "hcfft plan " << plHandle << " bake". A
+//  scope holds one range at most.
+#ifdef HCFFT_ROCTX
+static const bool hcfftTracing = true;
+
+class traceRange {
+ public:
+  explicit traceRange(const std::string& name) { roctxRangePush(name.c_str()); }
+
+  ~traceRange() { roctxRangePop(); }
+};
+
+#define HCFFT_TRACE_RANGE(name)  \
+  std::ostringstream hcfftTraceName; \
+  hcfftTraceName << name;            \
+  traceRange hcfftTrace(hcfftTraceName.str())
+#else
+static const bool hcfftTracing = false;
+#define HCFFT_TRACE_RANGE(name)
+#endif
+
 class FFTRepo;
+class FFTPlan;
+
+//  One kernel call of a transform, recorded by hcfftRecordLaunches. input and
+//  output are the buffers of the recorded sub-plan, where the tags
+//  launchInput and launchOutput stand for those of the transform. batch is
+//  the one the sub-plan was baked for: Stockham launchers size their grid
+//  from it, while the grid of transpose and copy kernels is compiled in.
+struct hcfftLaunch {
+  FFTPlan* plan;
+  void (*call)(const hcfftKernelArgs* args, uint batchSize,
+               hc::accelerator_view& acc_view, hc::accelerator& acc);
+  void* input;
+  void* output;
+  uint batch;
+};
+
+//  Intermediate buffers shared by the plans transforming on one
+//  accelerator_view, whose kernels never overlap. A transform holds lock
+//  while it queues kernels using buffer, and generation counts the
+//  reallocations of buffer as it grows to the largest need of its users.
+struct hcfftScratchPool {
+  void* queue;
+  hc::accelerator_view acc_view;
+  void* buffer;
+  size_t size;
+  size_t generation;
+  size_t users;
+  lockRAII lock;
+
+  explicit hcfftScratchPool(const hc::accelerator_view& view)
+      : queue(NULL),
+        acc_view(view),
+        buffer(NULL),
+        size(0),
+        generation(1),
+        users(0) {}
+};
+
+//  Build of a kernel library by a bake of this process, which other bakes of
+//  the same cache key wait on instead of compiling it again. The bake that
+//  claimed it settles it once, with the status of the build.
+struct hcfftKernelBuild {
+  std::promise<hcfftStatus> promise;
+  std::shared_future<hcfftStatus> result;
+  bool settled;
+
+  hcfftKernelBuild() : result(promise.get_future().share()), settled(false) {}
+};
 
 class FFTPlan {
  public:
-  typedef void(FUNC_FFTFwd)(std::map<int, void*>* vectArr, uint batchSize,
+  typedef void(FUNC_FFTFwd)(const hcfftKernelArgs* args, uint batchSize,
                             hc::accelerator_view& acc_view,
                             hc::accelerator& acc);
   FUNC_FFTFwd* kernelPtr;
+  //  Backward entry point; the same as kernelPtr when the kernel does not
+  //  depend on direction
+  FUNC_FFTFwd* kernelPtrBack;
+  //  Signature of this plan's kernel, assigned at bake. It keys the kernel in
+  //  FFTRepo, where plans with the same signature share it, and names its
+  //  entry points.
+  size_t kernelIndex;
+  //  Argument block of the kernel, laid out at bake with the twiddle tables
+  //  in place. Each call only stores its buffers in the first kernelArgIn
+  //  slots, for the input, and the kernelArgOut slots after them, for the
+  //  output. No slots at all means the kernels cannot take the layouts.
+  hcfftKernelArgs kernelArgs;
+  unsigned int kernelArgIn;
+  unsigned int kernelArgOut;
+  //  Kernel calls of each direction of the baked plan and its sub-plans, in
+  //  order, recorded by the first transform without a user temporary buffer
+  //  and cleared by the next bake
+  std::vector<hcfftLaunch> launchesFwd;
+  std::vector<hcfftLaunch> launchesBack;
+  //  Set on every plan of the tree while its launches are recorded, so that
+  //  kernels are appended to the list instead of called
+  std::vector<hcfftLaunch>* launchRecord;
+  //  Result of a bake started by hcfftBakePlanAsync, guarded by bakeLock
+  //  since the plan lock is held for the whole bake
+  std::shared_future<hcfftStatus> bakeFuture;
+  lockRAII bakeLock;
+  //  Instrumentation of the last bake, see hcfftGetPlanTimings
+  FFTPlanTimings timings;
 
   std::string kernellib;
   std::string filename;
@@ -477,6 +832,9 @@ class FFTPlan {
 
   hc::accelerator acc;
   hc::accelerator_view acc_view = hc::accelerator().get_default_view();
+  //  Views of acc the batch of a single-kernel plan is split across, see
+  //  hcfftSetPlanSplitViews. Empty when the whole batch runs on acc_view.
+  std::vector<hc::accelerator_view> splitViews;
   hcfftDim dimension;
   hcfftIpLayout ipLayout;
   hcfftOpLayout opLayout;
@@ -513,6 +871,66 @@ class FFTPlan {
   hcfftPlanHandle planRCcopy;
   hcfftPlanHandle planCopy;
 
+  //  Forward transform with the filter multiply and inverse transform of
+  //  hcfftEnqueueConvolution, created at its first call, or of the segments
+  //  of a convolution stream
+  hcfftPlanHandle planConvFwd;
+  hcfftPlanHandle planConvBack;
+
+  //  Overlap-save stream of hcfftCreateConvolveStream, in blocks of
+  //  convBlock samples through a filter of convTaps taps. convStream holds
+  //  the filter spectrum, the spectra of the segments of a block, two inputs
+  //  of the convTaps - 1 samples before a block and the block, and two
+  //  outputs; convCurrent is the input of the last block.
+  size_t convBlock;
+  size_t convTaps;
+  size_t convCurrent;
+  void* convStream;
+
+  //  Complex plans of hcfftEnqueueR2R for each hcfftRealKind, created at
+  //  their first call, and the table of exp(-i pi k / 2N) they share
+  hcfftPlanHandle planR2R[4];
+  void* r2rTwiddles;
+
+  //  Slab and pencil plans of hcfftEnqueueHostTransform, for streamDepth
+  //  planes of the volume and streamRows rows of every plane, with the two
+  //  device buffers the chunks are staged in and the view copying them
+  hcfftPlanHandle planStreamXY;
+  hcfftPlanHandle planStreamZ;
+  size_t streamDepth;
+  size_t streamRows;
+  void* streamBuffers[2];
+  std::vector<hc::accelerator_view> streamCopyView;
+
+  //  Copy of the plan of hcfftEnqueueHostBatch for chunks of hostChunk
+  //  transforms of its batch, with the device buffers of the hostSlots
+  //  chunks in flight, each of hostSlotBytes, pinned host buffers staging
+  //  the chunks of pageable memory, and the views uploading and downloading
+  //  them beside the transforms on acc_view
+  static const size_t hostSlots = 3;
+  hcfftPlanHandle planHostBatch;
+  size_t hostChunk;
+  size_t hostSlotBytes;
+  void* hostBuffers[hostSlots];
+  void* hostStaging[hostSlots];
+  std::vector<hc::accelerator_view> hostCopyViews;
+
+  //  Accelerators of hcfftSetPlanGPUs and the copies of the plan on them,
+  //  each transforming a chunk of its batch, created at the first
+  //  transform of hcfftEnqueueMultiTransform
+  std::vector<hc::accelerator> gpus;
+  std::vector<hcfftPlanHandle> gpuPlans;
+  //  Slab and pencil plans of hcfftEnqueueMultiVolume on each accelerator,
+  //  for chunks of its planes and its rows of every plane of a single 3D
+  //  volume
+  std::vector<hcfftPlanHandle> gpuSlabPlans;
+  std::vector<hcfftPlanHandle> gpuPencilPlans;
+  //  Views the peer-to-peer copies of each accelerator are queued on
+  std::vector<hc::accelerator_view> gpuCopyViews;
+  //  Copies of the plan bound to other accelerator_views, keyed by their HSA
+  //  queue, so that threads can run the plan on their streams at once
+  std::map<void*, hcfftPlanHandle> queuePlans;
+
   hcfftPlanHandle plHandle;
   hcfftPlanHandle plHandleOrigin;
 
@@ -520,6 +938,10 @@ class FFTPlan {
   bool bLdsComplex;
   unsigned uLdsFraction;
   bool ldsPadding;
+  //  Work-group size and transforms per work-group of a Stockham kernel, or
+  //  0 for those of DetermineSizes
+  size_t tuneWorkGroupSize;
+  size_t tuneNumTrans;
 
   size_t large1D_Xfactor;
 
@@ -532,22 +954,90 @@ class FFTPlan {
   size_t tmpBufSizeC2R;
   void* intBufferC2R;
 
+  //  Caller memory the intermediate buffers of the plan tree are carved from,
+  //  see hcfftSetWorkArea. workAreaSize is the extent of the buffers in it,
+  //  or, in a user plan, the size reported by hcfftGetWorkSize before the
+  //  first transform.
+  void* workArea;
+  size_t workAreaSize;
+  //  Work area of the hcfftXtExecStream call being queued, which the buffers
+  //  of the recorded launches in workArea are moved into, and whether
+  //  workArea is that of an earlier call rather than one the caller set, see
+  //  hcfftSetCallWorkArea
+  void* callWorkArea;
+  bool workAreaOfCall;
+  //  Whether transforms allocate the intermediate buffers of a user plan
+  //  without a work area
+  bool autoAllocate;
+  //  Pool of the view a user plan without a work area takes its work area
+  //  from, and the generation of the pool buffer it was carved from; 0 until
+  //  the plan is sized against the pool after a bake
+  hcfftScratchPool* scratchPool;
+  size_t scratchGeneration;
+
   void* twiddles;
   void* twiddleslarge;
 
+  //  Plan of a length with a prime factor no kernel has a radix for, see
+  //  hcfftBakeBluestein. planX and planY are its padded forward and inverse
+  //  transforms in the forward direction, planTX and planTY in the backward
+  //  one, and chirps holds the chirp and filter spectrum of each direction.
+  bool bluestein;
+  void* chirps;
+
+  //  Plan of a prime length through Rader's algorithm, see hcfftBakeRader,
+  //  with the sub-plans and chirps of a Bluestein plan. chirps holds the
+  //  filter spectrum of each direction and the input and output permutations.
+  bool rader;
+
+  //  Short-time plan of 1D real frames iDist apart, possibly overlapping,
+  //  which planX multiplies by the window as it reads them, see
+  //  hcfftBakeStft. chirps holds the window in the precision of the plan.
+  std::vector<double> window;
+  bool stft;
+
+  //  Plan whose input is 0 past inputExtent along each dimension, or whose
+  //  outputs past outputExtent are not computed, see hcfftBakePruned. planX
+  //  transforms the rows within the input extent and planY the columns of a
+  //  2D plan within the output extent. An empty extent is the whole data.
+  std::vector<size_t> inputExtent;
+  std::vector<size_t> outputExtent;
+  bool pruned;
+
   bool transflag;
   bool transOutHorizontal;
 
   size_t large1D;
   bool large2D;
+  //  2D plan whose column FFT runs in place in blocks of columns, right
+  //  after the row FFT and without transposes
+  bool blockColumn;
+  //  3D plan whose Z FFT runs in place on the XY output in blocks of
+  //  adjacent columns, instead of between two transposes
+  bool blockSlab;
+  //  Small 2D plan transformed by a single kernel of its own, which holds
+  //  whole images in LDS through the row and the column passes
+  bool lds2D;
   size_t cacheSize;
 
+  //  Callbacks on the global reads of the first and the writes of the last
+  //  kernel
+  hcfftCallback loadCallback;
+  hcfftCallback storeCallback;
+
   // Real-Complex simple flag
   // if this is set we do real to-and-from full complex using simple algorithm
   // where imaginary of input is set to zero in forward and imaginary not
   // written in backward
   bool RCsimple;
 
+  // Real-Complex split flag
+  // if this is set an even length real transform is done as a complex one of
+  // half the length over the real data taken two values at a time, and the
+  // Copy kernel of planRCcopy splits the hermitian result out of it in
+  // forward, or packs the hermitian input into it in backward
+  bool RCsplit;
+
   // Real FFT special flag
   // if this is set it means we are doing the 4th step in the 5-step real FFT
   // breakdown algorithm
@@ -563,6 +1053,70 @@ class FFTPlan {
   // Allocate no extra memory
   bool allOpsInplace;
 
+  // Transpose in place, so that large transforms avoid the tmp buffer the
+  // size of the data; sub-plans take it from plHandleOrigin
+  bool lowMemory;
+
+  // Global loads and stores of the complex data are half precision, through
+  // callbacks converting to and from the single precision of the kernels
+  bool halfStorage;
+
+  // The complex data are split into planes of real and imaginary parts. The
+  // callbacks of the plan address the real plane through the buffers of the
+  // kernels and the imaginary plane through their callback data.
+  bool planarStorage;
+
+  // Double-precision kernels keep their pass twiddles in single precision,
+  // halving the bytes of the table read by every pass
+  bool singleTwiddles;
+
+  // Kernels of the 3-step algorithm compute their twiddle factors in place
+  // of reading the large twiddle table
+  bool computeTwiddles;
+
+  // Largest batch, in elements, of a complex plan that transforms data in
+  // host memory on the host instead of baking kernels; 0 disables it. The
+  // cos and sin of the DFT of each length are computed at the first host
+  // transform.
+  size_t hostThreshold;
+  std::vector<std::vector<double> > hostTwiddles;
+
+  // With hybrid set, a batch in pinned host memory is split between the GPU,
+  // through hybridPlan, and the host, which takes hybridShare of it. The
+  // share is measured by the first split transform.
+  bool hybrid;
+  bool hybridCalibrated;
+  double hybridShare;
+  hcfftPlanHandle hybridPlan;
+
+  // The bake times the variants of each Stockham kernel of the tree on the
+  // device and keeps the fastest, see hcfftTunePlan
+  bool autotune;
+
+  // Recorded transforms queue a marker on the view before their first
+  // kernel and after each one. profileMarkers are those of the last
+  // transform, and profileKernels its kernels without their times.
+  bool profile;
+  std::vector<hcfftKernelProfile> profileKernels;
+  std::vector<hc::completion_future> profileMarkers;
+
+  // With validate set, each transform sums the energy of its input and of
+  // its output per batch element on the device. validPartials holds
+  // validBlocks partial sums per batch element of validBatch, those of the
+  // input and then those of the output, and validScale the ratio of the two
+  // that Parseval's theorem predicts for the last transform.
+  bool validate;
+  double* validPartials;
+  size_t validBlocks;
+  size_t validBatch;
+  double validScale;
+
+  // Baked for hcfftEstimateWorkSize: sub-plans are decomposed, but kernels
+  // are neither generated nor built, and twiddleBytes holds the size of the
+  // twiddle tables the kernel of a leaf would upload
+  bool estimateOnly;
+  size_t twiddleBytes;
+
   // A flag to say that blocked FFTs are going to be performed
   // It can only be one of these: column to row, row to column or column to
   // column
@@ -588,7 +1142,14 @@ class FFTPlan {
   hcfftLibType hcfftlibtype;
 
   FFTPlan()
-      : dimension(HCFFT_1D),
+      : kernelPtr(NULL),
+        kernelPtrBack(NULL),
+        kernelIndex(0),
+        kernelArgIn(0),
+        kernelArgOut(0),
+        launchRecord(NULL),
+        exist(false),
+        dimension(HCFFT_1D),
         ipLayout(HCFFT_COMPLEX_INTERLEAVED),
         opLayout(HCFFT_COMPLEX_INTERLEAVED),
         direction(HCFFT_FORWARD),
@@ -602,6 +1163,7 @@ class FFTPlan {
         backwardScale(1.0),
         twiddleFront(false),
         baked(false),
+        transformed(false),
         gen(Stockham),
         planX(0),
         planY(0),
@@ -611,11 +1173,31 @@ class FFTPlan {
         planTZ(0),
         planRCcopy(0),
         planCopy(0),
+        planConvFwd(0),
+        planConvBack(0),
+        convBlock(0),
+        convTaps(0),
+        convCurrent(0),
+        convStream(NULL),
+        planR2R(),
+        r2rTwiddles(NULL),
+        planStreamXY(0),
+        planStreamZ(0),
+        streamDepth(0),
+        streamRows(0),
+        streamBuffers(),
+        planHostBatch(0),
+        hostChunk(0),
+        hostSlotBytes(0),
+        hostBuffers(),
+        hostStaging(),
         plHandle(0),
         plHandleOrigin(0),
         bLdsComplex(false),
         uLdsFraction(0),
-        ldsPadding(false),
+        ldsPadding(ARBITRARY::LDS_PADDING),
+        tuneWorkGroupSize(0),
+        tuneNumTrans(0),
         large1D_Xfactor(0),
         tmpBufSize(0),
         intBuffer(NULL),
@@ -623,26 +1205,60 @@ class FFTPlan {
         intBufferRC(NULL),
         tmpBufSizeC2R(0),
         intBufferC2R(NULL),
-        transflag(false),
-        transpose_in_2d_inplace(false),
+        workArea(NULL),
+        workAreaSize(0),
+        callWorkArea(NULL),
+        workAreaOfCall(false),
+        autoAllocate(true),
+        scratchPool(NULL),
+        scratchGeneration(0),
         twiddles(NULL),
         twiddleslarge(NULL),
+        bluestein(false),
+        chirps(NULL),
+        rader(false),
+        stft(false),
+        pruned(false),
+        transflag(false),
         transOutHorizontal(false),
         large1D(0),
         large2D(false),
+        blockColumn(false),
+        blockSlab(false),
+        lds2D(false),
         RCsimple(false),
+        RCsplit(false),
         realSpecial(false),
         realSpecial_Nr(0),
         userPlan(false),
         allOpsInplace(false),
+        lowMemory(false),
+        halfStorage(false),
+        planarStorage(false),
+        singleTwiddles(false),
+        computeTwiddles(false),
+        hostThreshold(0),
+        hybrid(false),
+        hybridCalibrated(false),
+        hybridShare(0.125),
+        hybridPlan(0),
+        autotune(false),
+        profile(false),
+        validate(false),
+        validPartials(NULL),
+        validBlocks(0),
+        validBatch(0),
+        validScale(0),
+        estimateOnly(false),
+        twiddleBytes(0),
         blockCompute(false),
         blockComputeType(BCT_C2C),
+        transpose_in_2d_inplace(false),
         nonSquareKernelType(NON_SQUARE_TRANS_PARENT),
         transposeMiniBatchSize(1),
         nonSquareKernelOrder(NOT_A_TRANSPOSE),
-        hcfftlibtype(HCFFT_R2CD2Z),
-        exist(false),
-        transformed(false) {
+        hcfftlibtype(HCFFT_R2CD2Z) {
+    memset(&kernelArgs, 0, sizeof(kernelArgs));
     originalLength.clear();
   }
 
@@ -654,10 +1270,30 @@ class FFTPlan {
 
   hcfftStatus hcfftBakePlan(hcfftPlanHandle plHandle);
 
+  hcfftStatus hcfftBakePlanAsync(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftWaitBakePlan(hcfftPlanHandle plHandle);
+
   hcfftStatus hcfftBakePlanInternal(hcfftPlanHandle plHandle);
 
+  hcfftStatus hcfftBakeBluestein(hcfftPlanHandle plHandle);
+  hcfftStatus hcfftBakeRader(hcfftPlanHandle plHandle);
+  hcfftStatus hcfftBakeStft(hcfftPlanHandle plHandle);
+  hcfftStatus hcfftBakePruned(hcfftPlanHandle plHandle);
+  hcfftStatus hcfftBakeRankN(hcfftPlanHandle plHandle);
+
   hcfftStatus hcfftDestroyPlan(hcfftPlanHandle* plHandle);
 
+  //  Descriptions of the plan and its sub-plans, depth first
+  hcfftStatus hcfftGetPlanInfo(hcfftPlanHandle plHandle, size_t depth,
+                               const std::string& role,
+                               std::vector<FFTPlanInfo>& info);
+
+  //  Timings of the plan and its sub-plans, depth first, with their depth
+  hcfftStatus hcfftGetPlanTimings(
+      hcfftPlanHandle plHandle, size_t depth,
+      std::vector<std::pair<size_t, FFTPlanTimings> >& timings);
+
   template <typename T>
   hcfftStatus hcfftEnqueueTransform(hcfftPlanHandle plHandle,
                                     hcfftDirection dir, T* inputBuffers,
@@ -668,9 +1304,247 @@ class FFTPlan {
                                             hcfftDirection dir, T* inputBuffers,
                                             T* outputBuffers, T* tmpBuffer);
 
+  template <typename T>
+  hcfftStatus hcfftEnqueueLaunches(hcfftPlanHandle plHandle, hcfftDirection dir,
+                                   T* inputBuffers, T* outputBuffers,
+                                   T* tmpBuffer);
+
+  template <typename T>
+  hcfftStatus hcfftRecordLaunches(hcfftPlanHandle plHandle, hcfftDirection dir,
+                                  std::vector<hcfftLaunch>& launches);
+
+  hcfftStatus hcfftSetLaunchRecord(hcfftPlanHandle plHandle,
+                                   std::vector<hcfftLaunch>* record);
+
+  //  Bytes the batch of one transform of a plan spans on its input and on
+  //  its output, the steps between the buffers of a run of its transforms
+  hcfftStatus hcfftGetRunSteps(hcfftPlanHandle plHandle, size_t* inBytes,
+                               size_t* outBytes);
+
+  //  Transforms of count buffers following one another by the steps of
+  //  hcfftGetRunSteps, from input and output on. A plan of a single kernel
+  //  reading the input and writing the output takes them all in one launch
+  //  of count times its batch.
+  template <typename T>
+  hcfftStatus hcfftEnqueueRun(hcfftPlanHandle plHandle, hcfftDirection dir,
+                              T* input, T* output, size_t count);
+
+  //  Circular convolution of the real input of a 2D real to hermitian plan
+  //  with a filter given by its spectrum, in the layout of the plan output
+  template <typename T>
+  hcfftStatus hcfftEnqueueConvolution(hcfftPlanHandle plHandle, T* input,
+                                      T* filter, T* output);
+
+  template <typename T>
+  hcfftStatus hcfftEnqueueHostTransform(hcfftPlanHandle plHandle,
+                                        hcfftDirection dir, T* input,
+                                        T* output, size_t deviceBytes);
+
+  //  Transform of the batch of the plan between buffers in host memory, in
+  //  chunks pipelined through at most deviceBytes of device memory
+  template <typename T>
+  hcfftStatus hcfftEnqueueHostBatch(hcfftPlanHandle plHandle,
+                                    hcfftDirection dir, T* input, T* output,
+                                    size_t deviceBytes);
+
+  hcfftStatus hcfftCreateHostBatch(hcfftPlanHandle plHandle, size_t chunk,
+                                   size_t slotBytes, bool staged);
+
+  hcfftStatus hcfftReleaseHostBatch(hcfftPlanHandle plHandle);
+
+  //  Overlap-save convolution of a stream of real samples, in blocks of
+  //  block samples in host memory, with the filter of taps
+  hcfftStatus hcfftCreateConvolveStream(hcfftPlanHandle* plHandle,
+                                        hcfftPrecision precision, size_t block,
+                                        const std::vector<double>& taps);
+
+  hcfftStatus hcfftBakeConvolveStream(hcfftPlanHandle plHandle, size_t block,
+                                      const std::vector<double>& taps);
+
+  template <typename T>
+  hcfftStatus hcfftEnqueueConvolveStream(hcfftPlanHandle plHandle,
+                                         const T* input, T* output,
+                                         size_t blocks);
+
+  //  Restart the stream of a plan of hcfftCreateConvolveStream, with no
+  //  samples before its next block
+  hcfftStatus hcfftResetConvolveStream(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftCreateStreamPlans(hcfftPlanHandle plHandle, size_t depth,
+                                     size_t rows);
+
+  hcfftStatus hcfftReleaseStreamPlans(hcfftPlanHandle plHandle);
+
+  //  Transform of the batch of the plan split across the accelerators of
+  //  hcfftSetPlanGPUs, with the input and output of chunk i on gpus[i]
+  template <typename T>
+  hcfftStatus hcfftEnqueueMultiTransform(hcfftPlanHandle plHandle,
+                                         hcfftDirection dir,
+                                         hcfftIpLayout iLayout,
+                                         hcfftOpLayout oLayout, T** inputs,
+                                         T** outputs);
+
+  //  Transform of a single 3D volume across the accelerators of
+  //  hcfftSetPlanGPUs, from slabs of planes to pencils of rows of the planes
+  //  in the forward direction and back in the backward one
+  template <typename T>
+  hcfftStatus hcfftEnqueueMultiVolume(hcfftPlanHandle plHandle,
+                                      hcfftDirection dir, T** slabs,
+                                      T** pencils);
+
+  hcfftStatus hcfftGetPlanGPUVolumeSplit(hcfftPlanHandle plHandle,
+                                         std::vector<size_t>& depths,
+                                         std::vector<size_t>& rows);
+
+  hcfftStatus hcfftCreateGPUVolumePlans(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftSetPlanGPUs(hcfftPlanHandle plHandle,
+                               const std::vector<hc::accelerator>& accs);
+
+  hcfftStatus hcfftGetPlanGPUBatches(hcfftPlanHandle plHandle,
+                                     std::vector<size_t>& batches);
+
+  hcfftStatus hcfftCreateGPUPlans(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftReleaseGPUPlans(hcfftPlanHandle plHandle);
+
+  //  Wait for the transforms queued on the accelerators of the plan
+  hcfftStatus hcfftWaitPlanGPUs(hcfftPlanHandle plHandle);
+
+  //  Copy of the plan transforming on acc_view, created at the first request
+  //  for its queue. The plan itself is returned for its own queue.
+  hcfftStatus hcfftGetQueuePlan(hcfftPlanHandle plHandle,
+                                hc::accelerator_view& acc_view,
+                                hcfftPlanHandle* queuePlan);
+
+  //  Copy of the plan for batch transforms, baked from the kernels and
+  //  twiddle tables of the plan when it is baked
+  hcfftStatus hcfftClonePlan(hcfftPlanHandle plHandle, size_t batch,
+                             hcfftPlanHandle* clone);
+
+  //  Bake the plan and write it to a plan file at path, with the kernel
+  //  libraries and twiddle tables of its tree; HCFFT_INVALID when the file
+  //  cannot be created
+  hcfftStatus hcfftSavePlan(hcfftPlanHandle plHandle, const std::string& path);
+
+  //  Create and bake a plan from a plan file. HCFFT_INVALID when the file
+  //  cannot be opened, HCFFT_ERROR when it does not parse or the plan does
+  //  not bake.
+  hcfftStatus hcfftLoadPlan(const std::string& path, hcfftPlanHandle* plHandle);
+
+  hcfftStatus hcfftCreateConvolutionPlan(hcfftPlanHandle plHandle,
+                                         hcfftDirection dir,
+                                         hcfftPlanHandle* convHandle);
+
+  //  Real-to-real transform of kind of the real input of a 1D real to
+  //  hermitian plan, the output in the layout of the input
+  template <typename T>
+  hcfftStatus hcfftEnqueueR2R(hcfftPlanHandle plHandle, hcfftRealKind kind,
+                              T* input, T* output);
+
+  hcfftStatus hcfftCreateR2RPlan(hcfftPlanHandle plHandle, hcfftRealKind kind,
+                                 hcfftPlanHandle* r2rHandle);
+
   hcfftStatus hcfftSetAcclView(hcfftPlanHandle plHandle,
                                hc::accelerator_view accl_view);
 
+  hcfftStatus hcfftGetWorkSize(hcfftPlanHandle plHandle, size_t* size);
+
+  hcfftStatus hcfftEstimateWorkSize(hcfftPlanHandle plHandle, size_t* size);
+
+  hcfftStatus hcfftAddEstimate(hcfftPlanHandle plHandle, size_t* size);
+
+  hcfftStatus hcfftSetWorkArea(hcfftPlanHandle plHandle, void* workArea);
+
+  //  Sets the work area of one hcfftXtExecStream call, or NULL after it
+  hcfftStatus hcfftSetCallWorkArea(hcfftPlanHandle plHandle, void* workArea);
+
+  //  Forgets the work area left by earlier hcfftXtExecStream calls, for the
+  //  next transform to take its buffers from the scratch pool or to
+  //  allocate them
+  hcfftStatus hcfftClearWorkArea(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftSetAutoAllocation(hcfftPlanHandle plHandle,
+                                     bool autoAllocate);
+
+  hcfftStatus hcfftSetLowMemory(hcfftPlanHandle plHandle, bool lowMemory);
+
+  hcfftStatus hcfftSetHalfStorage(hcfftPlanHandle plHandle, bool halfStorage);
+
+  bool hcfftHasHalfStorage(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftSetPlanarStorage(hcfftPlanHandle plHandle,
+                                    bool planarStorage);
+
+  hcfftStatus hcfftSetSingleTwiddles(hcfftPlanHandle plHandle,
+                                     bool singleTwiddles);
+
+  hcfftStatus hcfftSetComputeTwiddles(hcfftPlanHandle plHandle,
+                                      bool computeTwiddles);
+
+  hcfftStatus hcfftSetHostThreshold(hcfftPlanHandle plHandle,
+                                    size_t hostThreshold);
+
+  //  Whether a transform of the plan from input to output runs on the host
+  bool hcfftRunsOnHost(hcfftPlanHandle plHandle, const void* input,
+                       const void* output);
+
+  template <typename T>
+  hcfftStatus hcfftTransformOnHost(hcfftPlanHandle plHandle,
+                                   hcfftDirection dir, T* input, T* output);
+
+  hcfftStatus hcfftSetHybrid(hcfftPlanHandle plHandle, bool hybrid);
+
+  //  Whether a transform of the plan from input to output is split between
+  //  the GPU and the host
+  bool hcfftRunsHybrid(hcfftPlanHandle plHandle, const void* input,
+                       const void* output);
+
+  template <typename T>
+  hcfftStatus hcfftEnqueueHybrid(hcfftPlanHandle plHandle, hcfftDirection dir,
+                                 T* input, T* output);
+
+  hcfftStatus hcfftSetAutotune(hcfftPlanHandle plHandle, bool autotune);
+
+  hcfftStatus hcfftSetPlanProfiling(hcfftPlanHandle plHandle, bool profile);
+
+  //  Kernels of the last profiled transform of the plan, in order, once they
+  //  have run. Empty when no transform was profiled.
+  hcfftStatus hcfftGetPlanProfile(hcfftPlanHandle plHandle,
+                                  std::vector<hcfftKernelProfile>& profile);
+
+  hcfftStatus hcfftSetPlanValidation(hcfftPlanHandle plHandle, bool validate);
+
+  //  Relative Parseval error of each batch element of the last validated
+  //  transform of the plan, once it has run. Empty when none was validated.
+  hcfftStatus hcfftGetPlanValidation(hcfftPlanHandle plHandle,
+                                     std::vector<double>& errors);
+
+  //  Time the kernel variants of the Stockham leaves of a baked plan tree and
+  //  rebake each leaf with its fastest
+  hcfftStatus hcfftTunePlan(hcfftPlanHandle plHandle);
+
+  bool hcfftNeedsWorkArea(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftAttachScratch(hcfftPlanHandle plHandle,
+                                 hcfftScratchPool*& pool);
+
+  hcfftStatus hcfftSizeScratch(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftDetachScratch(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftSliceWorkArea(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftWalkWorkArea(hcfftPlanHandle plHandle, char* base,
+                                size_t extent, size_t* offset);
+
+  bool hcfftMissingBuffers(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftDropWorkArea(hcfftPlanHandle plHandle);
+
+  hcfftStatus hcfftSetPlanSplitViews(
+      hcfftPlanHandle plHandle, const std::vector<hc::accelerator_view>& views);
+
   hcfftStatus hcfftGetAcclView(hcfftPlanHandle plHandle,
                                hc::accelerator_view* accl_view);
 
@@ -732,6 +1606,37 @@ class FFTPlan {
   hcfftStatus hcfftSetResultLocation(hcfftPlanHandle plHandle,
                                      hcfftResLocation placeness);
 
+  //  Set the placeness and layouts of an exec and bake the plan, unless it is
+  //  already baked for them
+  hcfftStatus hcfftPrepareExec(hcfftPlanHandle plHandle,
+                               hcfftResLocation placeness,
+                               hcfftIpLayout iLayout, hcfftOpLayout oLayout);
+
+  hcfftStatus hcfftSetPlanCallback(hcfftPlanHandle plHandle,
+                                   const char* funcName,
+                                   const char* funcString,
+                                   hcfftCallbackType type, void* userdata);
+
+  //  Pass a new data pointer to a callback of the plan and its sub-plans,
+  //  without baking them again
+  hcfftStatus hcfftSetPlanCallbackData(hcfftPlanHandle plHandle,
+                                       hcfftCallbackType type, void* userdata);
+
+  //  Multiply the length[0] samples of each frame of a 1D real to hermitian
+  //  plan by window, or stop when window is NULL
+  hcfftStatus hcfftSetPlanWindow(hcfftPlanHandle plHandle,
+                                 const double* window);
+
+  //  Declare the input of the plan 0 past extent along each of its rank
+  //  dimensions, or dense again when extent is NULL
+  hcfftStatus hcfftSetPlanInputExtent(hcfftPlanHandle plHandle, size_t rank,
+                                      const size_t* extent);
+
+  //  Compute and store only the outputs of the plan within extent along each
+  //  of its rank dimensions, or all of them when extent is NULL
+  hcfftStatus hcfftSetPlanOutputExtent(hcfftPlanHandle plHandle, size_t rank,
+                                       const size_t* extent);
+
   hcfftStatus hcfftGetPlanTransposeResult(const hcfftPlanHandle plHandle,
                                           hcfftResTransposed* transposed);
 
@@ -769,7 +1674,26 @@ class FFTPlan {
 
   hcfftStatus ReleaseBuffers();
 
+  hcfftStatus SetKernelArgs();
+
+  bool InWorkArea(const void* buffer) const;
+
+  void* CallBuffer(void* buffer) const;
+
+  bool CanSplitBatch(const std::vector<hcfftLaunch>& launches) const;
+
+  //  Whether the launches of a plan are its single kernel, of a batch of
+  //  rows at its distances, that may be launched on any part of the batch
+  //  or on more transforms following it
+  bool CanRebatch(const std::vector<hcfftLaunch>& launches) const;
+
+  void EnqueueSplitBatch(const hcfftLaunch& launch, void* input, void* output);
+
   size_t ElementSize() const;
+
+  bool Lds2DSizes(size_t* wgs, size_t* numTrans) const;
+
+  void GetTuningCandidates(std::vector<hcfftKernelTuning>& candidates) const;
 };
 
 class FFTRepo {
@@ -785,31 +1709,86 @@ class FFTRepo {
   //  plan object so that the lock
   //  object can be held the entire time a plan is getting destroyed in
   //  hcfftDestroyPlan.
+  //  The plans are sharded by handle, each shard with a reader-writer lock
+  //  of its own on a separate cache line, so that lookups of different plans
+  //  from different threads share no lock, and lookups of the same plan only
+  //  read one.
   typedef std::pair<FFTPlan*, lockRAII*> repoPlansValue;
   typedef std::map<hcfftPlanHandle, repoPlansValue> repoPlansType;
-  repoPlansType repoPlans;
+
+  struct alignas(64) repoPlansShard {
+    rwLockRAII lock;
+    repoPlansType plans;
+  };
+
+  static const size_t planShards = 16;
+  repoPlansShard repoPlans[planShards];
+
+  repoPlansShard& planShard(hcfftPlanHandle plHandle) {
+    return repoPlans[plHandle % planShards];
+  }
 
   //  Structure containing all the data we need to remember for a specific
   //  invokation of a kernel
-  //  generator
+  //  generator. Leaf plans with the same kernel signature share one value, and
+  //  the loaded entry points stay valid while refCount plans hold them.
   struct fftRepoValue {
     std::string ProgramString;
     std::string EntryPoint_fwd;
     std::string EntryPoint_back;
 
-    fftRepoValue() {}
+    std::string kernellib;
+    void* kernelHandle;
+    FFTPlan::FUNC_FFTFwd* kernelPtr;
+    FFTPlan::FUNC_FFTFwd* kernelPtrBack;
+    size_t refCount;
+
+    fftRepoValue()
+        : kernelHandle(NULL),
+          kernelPtr(NULL),
+          kernelPtrBack(NULL),
+          refCount(0) {}
   };
 
-  typedef std::pair<hcfftGenerators, hcfftPlanHandle> fftRepoKey;
+  //  Generator and kernel signature
+  typedef std::pair<hcfftGenerators, size_t> fftRepoKey;
   typedef std::map<fftRepoKey, fftRepoValue> fftRepoType;
   typedef fftRepoType::iterator fftRepo_iterator;
 
   fftRepoType mapFFTs;
 
+  //  Kernel libraries loaded for mapFFTs, keyed by path, with the number of
+  //  kernels holding each handle. A handle is closed when the last kernel
+  //  loaded from it is released.
+  typedef std::map<std::string, std::pair<void*, size_t> > kernelLibsType;
+  kernelLibsType kernelLibs;
+
+  //  Scratch pools, keyed by the HSA queue of their accelerator_view
+  typedef std::map<void*, hcfftScratchPool*> scratchPoolsType;
+  scratchPoolsType scratchPools;
+
+  //  Device twiddle tables, keyed by the device path and the table type,
+  //  element size and shape, with the number of plans holding each table.
+  //  The tables are read only, so plans of the same length and precision
+  //  share them.
+  typedef std::pair<std::wstring, std::vector<size_t> > twiddleKey;
+  typedef std::map<twiddleKey, std::pair<void*, size_t> > twiddlesType;
+  twiddlesType twiddleTables;
+  std::map<void*, twiddleKey> twiddleKeys;
+
+  //  Kernel tunings of the autotuner, by the signature of the heuristic
+  //  kernel they replace
+  std::map<size_t, hcfftKernelTuning> tunings;
+
+  //  Kernel libraries being built by bakes of this process, by cache key
+  typedef std::map<std::string, std::shared_ptr<hcfftKernelBuild> >
+      kernelBuildsType;
+  kernelBuildsType kernelBuilds;
+
   //  Static count of how many plans we have generated; always incrementing
   //  during the life of the library
   //  This is used as a unique identifier for plans
-  static size_t planCount;
+  static std::atomic<size_t> planCount;
 
   // Private constructor to stop explicit instantiation
   FFTRepo() {}
@@ -821,13 +1800,10 @@ class FFTRepo {
   FFTRepo& operator=(const FFTRepo&);
 
  public:
-  //  Used to make the FFTRepo struct thread safe; STL is not thread safe by
-  //  default
-  //  Optimally, we could use a lock object per STL struct, as two different STL
-  //  structures
-  //  can be modified at the same time, but a single lock object is easier and
-  //  performance should
-  //  still be good
+  //  Used to make the kernel, scratch, twiddle and tuning maps of the FFTRepo
+  //  thread safe; STL is not thread safe by default. The plans are guarded by
+  //  the locks of their shards instead, so transforms of baked plans do not
+  //  take it.
   static lockRAII lockRepo;
 
   //  Everybody who wants to access the Repo calls this function to get a repo
@@ -845,25 +1821,96 @@ class FFTRepo {
   hcfftStatus deletePlan(hcfftPlanHandle* plHandle);
 
   hcfftStatus setProgramEntryPoints(const hcfftGenerators gen,
-                                    const hcfftPlanHandle& handle,
+                                    const size_t kernelId,
                                     const FFTKernelGenKeyParams& fftParam,
                                     const char* kernel_fwd,
                                     const char* kernel_back);
 
   hcfftStatus getProgramEntryPoint(const hcfftGenerators gen,
-                                   const hcfftPlanHandle& handle,
+                                   const size_t kernelId,
                                    const FFTKernelGenKeyParams& fftParam,
                                    hcfftDirection dir, std::string& kernel);
 
   hcfftStatus setProgramCode(const hcfftGenerators gen,
-                             const hcfftPlanHandle& handle,
+                             const size_t kernelId,
                              const FFTKernelGenKeyParams&,
                              const std::string& kernel);
 
   hcfftStatus getProgramCode(const hcfftGenerators gen,
-                             const hcfftPlanHandle& handle,
+                             const size_t kernelId,
                              const FFTKernelGenKeyParams&, std::string& kernel);
 
+  hcfftStatus acquireKernelLib(const std::string& kernellib, void*& handle);
+
+  hcfftStatus releaseKernelLib(void* handle);
+
+  //  Take a reference on a kernel that is already loaded
+  hcfftStatus acquireKernel(const hcfftGenerators gen, const size_t kernelId,
+                            std::string& kernellib,
+                            FFTPlan::FUNC_FFTFwd*& kernelPtr,
+                            FFTPlan::FUNC_FFTFwd*& kernelPtrBack);
+
+  //  Take a reference on a kernel, loading it from kernellib if needed
+  hcfftStatus loadKernel(const hcfftGenerators gen, const size_t kernelId,
+                         const std::string& kernellib,
+                         const std::string& fwdName,
+                         const std::string& backName,
+                         FFTPlan::FUNC_FFTFwd*& kernelPtr,
+                         FFTPlan::FUNC_FFTFwd*& kernelPtrBack);
+
+  hcfftStatus releaseKernel(const hcfftGenerators gen, const size_t kernelId);
+
+  //  Take a reference on the scratch pool of acc_view
+  hcfftStatus acquireScratch(hc::accelerator_view& acc_view,
+                             hcfftScratchPool*& pool);
+
+  //  Reallocate the buffer of pool if it is smaller than size; the caller
+  //  holds the lock of the pool
+  hcfftStatus growScratch(hcfftScratchPool* pool, size_t size);
+
+  hcfftStatus releaseScratch(hcfftScratchPool* pool);
+
+  //  Take a reference on the twiddle table of shape on acc; table is NULL
+  //  when none is cached yet. The caller holds lockRepo until it has
+  //  generated and added a missing table.
+  hcfftStatus acquireTwiddles(const hc::accelerator& acc,
+                              const std::vector<size_t>& shape, void*& table);
+
+  hcfftStatus addTwiddles(const hc::accelerator& acc,
+                          const std::vector<size_t>& shape, void* table);
+
+  hcfftStatus releaseTwiddles(void* table);
+
+  //  Shape a cached twiddle table is kept under; false for other tables
+  bool getTwiddleShape(void* table, std::vector<size_t>& shape);
+
+  //  Tuning the autotuner picked for the kernel of signature, the one a leaf
+  //  generates with the sizes of DetermineSizes; false when there is none
+  bool getTuning(size_t signature, hcfftKernelTuning& tuning);
+
+  hcfftStatus setTuning(size_t signature, const hcfftKernelTuning& tuning);
+
+  //  Write the tunings to a wisdom file at path, one line per kernel
+  //  signature; HCFFT_INVALID when the file cannot be created
+  hcfftStatus exportTunings(const std::string& path);
+
+  //  Merge the tunings of a wisdom file into those of the repo, replacing
+  //  tunings of the same signature. Nothing is merged from a file that does
+  //  not parse, which gives HCFFT_ERROR.
+  hcfftStatus importTunings(const std::string& path);
+
+  //  Claim the build of the library of key for the calling bake. true sets
+  //  build to a new claim; false sets it to the claim of the bake already
+  //  building it.
+  bool claimKernelBuild(const std::string& key,
+                        std::shared_ptr<hcfftKernelBuild>& build);
+
+  //  Settle a claim of claimKernelBuild, waking the bakes waiting on it.
+  //  Claims that are settled already are left alone.
+  void settleKernelBuild(const std::string& key,
+                         const std::shared_ptr<hcfftKernelBuild>& build,
+                         hcfftStatus status);
+
   hcfftStatus releaseResources();
 
   ~FFTRepo() { releaseResources(); }
@@ -130,4 +130,86 @@ class scopedLock {
 #define lockRAII lockRAII<false>
 #define scopedLock scopedLock<false>
 
+//  rwLockRAII wraps a pthread reader-writer lock, for structures that are
+//  read far more often than changed. Readers do not exclude each other. The
+//  lock is not recursive for writers.
+template <bool debugPrint>
+class rwLockRAII {
+  pthread_rwlock_t rwlock;
+  std::string lockName;
+
+  //  Does not make sense to create a copy of a lock object; private method
+  rwLockRAII(const rwLockRAII& rhs);
+
+ public:
+  rwLockRAII() { pthread_rwlock_init(&rwlock, NULL); }
+
+  explicit rwLockRAII(const std::string& name) : lockName(name) {
+    pthread_rwlock_init(&rwlock, NULL);
+  }
+
+  ~rwLockRAII() { pthread_rwlock_destroy(&rwlock); }
+
+  std::string& getName() { return lockName; }
+
+  void setName(const std::string& name) { lockName = name; }
+
+  void enterRead() {
+    if (debugPrint) {
+      std::cout << _T("Attempting read pthread_rwlock_t( ") << lockName
+                << _T(" )") << std::endl;
+    }
+
+    ::pthread_rwlock_rdlock(&rwlock);
+  }
+
+  void enterWrite() {
+    if (debugPrint) {
+      std::cout << _T("Attempting write pthread_rwlock_t( ") << lockName
+                << _T(" )") << std::endl;
+    }
+
+    ::pthread_rwlock_wrlock(&rwlock);
+  }
+
+  void leave() {
+    if (debugPrint) {
+      std::cout << _T("Releasing pthread_rwlock_t( ") << lockName << _T(" )")
+                << std::endl;
+    }
+
+    ::pthread_rwlock_unlock(&rwlock);
+  }
+};
+
+//  Hold a rwLockRAII for reading for the lifetime of the object
+template <bool debugPrint>
+class scopedReadLock {
+  rwLockRAII<debugPrint>* sLock;
+
+ public:
+  explicit scopedReadLock(rwLockRAII<debugPrint>& lock) : sLock(&lock) {
+    sLock->enterRead();
+  }
+
+  ~scopedReadLock() { sLock->leave(); }
+};
+
+//  Hold a rwLockRAII for writing for the lifetime of the object
+template <bool debugPrint>
+class scopedWriteLock {
+  rwLockRAII<debugPrint>* sLock;
+
+ public:
+  explicit scopedWriteLock(rwLockRAII<debugPrint>& lock) : sLock(&lock) {
+    sLock->enterWrite();
+  }
+
+  ~scopedWriteLock() { sLock->leave(); }
+};
+
+#define rwLockRAII rwLockRAII<false>
+#define scopedReadLock scopedReadLock<false>
+#define scopedWriteLock scopedWriteLock<false>
+
 #endif  // LIB_INCLUDE_LOCK_H_
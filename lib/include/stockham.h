@@ -205,51 +205,46 @@ inline std::string TwTableLargeFunc() { return "TW3step"; }
 
 // Twiddle factors table for large N
 // used in 3-step algorithm
+// A computed table holds no factors: the twiddle function evaluates them
+// with sin and cos, and the kernels only keep the table argument, bound to
+// one element shared by all such plans.
 template <typename T, Precision PR>
 class TwiddleTableLarge {
   size_t N;  // length
   size_t X, Y;
-  size_t tableSize;
-  T* wc;  // cosine, sine arrays
+  bool computed;
 
  public:
-  explicit TwiddleTableLarge(size_t length) : N(length) {
+  explicit TwiddleTableLarge(size_t length, bool computedVal = false)
+      : N(length), computed(computedVal) {
     X = size_t(1) << ARBITRARY::TWIDDLE_DEE;
     Y = DivRoundingUp<size_t>(CeilPo2(N), ARBITRARY::TWIDDLE_DEE);
-    tableSize = X * Y;
-    // Allocate memory for the tables
-    wc = new T[tableSize];
-  }
-
-  ~TwiddleTableLarge() {
-    // Free
-    delete[] wc;
   }
 
   void TwiddleLargeAV(void** twiddleslarge, hc::accelerator acc) {
-    const double TWO_PI = -6.283185307179586476925286766559;
-    // Generate the table
-    size_t nt = 0;
-    double phi = TWO_PI / static_cast<double>(N);
-
-    for (size_t iY = 0; iY < Y; ++iY) {
-      size_t i = size_t(1) << (iY * ARBITRARY::TWIDDLE_DEE);
-
-      for (size_t iX = 0; iX < X; ++iX) {
-        size_t j = i * iX;
-        double c = cos(phi * static_cast<double>(j));
-        double s = sin(phi * static_cast<double>(j));
-        // if (fabs(c) < 1.0E-12)  c = 0.0;
-        // if (fabs(s) < 1.0E-12)  s = 0.0;
-        wc[nt].x = c;
-        wc[nt++].y = s;
-      }
+    // Tables of the same length and element size are shared; the leading
+    // zero keeps them apart from the radix keyed tables of TwiddleTable
+    std::vector<size_t> shape;
+    shape.push_back(0);
+    shape.push_back(sizeof(T));
+    shape.push_back(computed ? 0 : N);
+    FFTRepo& fftRepo = FFTRepo::getInstance();
+    scopedLock sLock(FFTRepo::lockRepo, _T("TwiddleLargeAV"));
+    fftRepo.acquireTwiddles(acc, shape, *twiddleslarge);
+
+    if (*twiddleslarge != NULL) {
+      return;
     }
 
-    *twiddleslarge = hc::am_alloc(Y * X * sizeof(T), acc, 0);
-    hc::accelerator_view accl_view = acc.get_default_view();
-    accl_view.copy(wc, *twiddleslarge, Y * X * sizeof(T));
+    // The single element of a computed table is the factor of u = 0
+    size_t rows = computed ? 1 : Y;
+    size_t columns = computed ? 1 : X;
+    scopedTimer timer(hcfftTwiddleSeconds);
+    *twiddleslarge = hc::am_alloc(rows * columns * sizeof(T), acc, 0);
     assert(*twiddleslarge != NULL);
+    hcfftDeviceTwiddlesLarge(acc, *twiddleslarge,
+                             sizeof(T) == 2 * sizeof(double), N, rows, columns);
+    fftRepo.addTwiddles(acc, shape, *twiddleslarge);
   }
 
   void GenerateTwiddleTable(std::string& twStr,
@@ -265,6 +260,22 @@ class TwiddleTableLarge {
     ss << " *";
     ss << TwTableLargeName();
     ss << ")  __attribute__((hc))\n{\n";
+
+    // The angle of u in the precision of the kernel. In single precision it
+    // is off by up to about 4 * pi * 2^-24, several times the rounding of
+    // the factors of a table.
+    if (computed) {
+      std::string rType = RegBaseType<PR>(1);
+      ss << "\t" << rType << " a = (" << rType << ")u * (" << rType << ")("
+         << FloatToStr(-6.283185307179586476925286766559 /
+                       static_cast<double>(N))
+         << ");\n";
+      ss << "\treturn " << RegBaseType<PR>(2)
+         << "(hc::precise_math::cos(a), hc::precise_math::sin(a));\n}\n\n";
+      twStr += ss.str();
+      return;
+    }
+
     ss << "\t"
           "size_t j = u & "
        << unsigned(X - 1) << ";\n";
@@ -313,6 +324,66 @@ class Butterfly {
     return (N < 2) ? n : (BitReverse(n >> 1, N >> 1) |
                           ((n & 1) != 0 ? (N >> 1) : 0));
   }
+
+  // Registers in natural order, and results through the temporaries. Only
+  // the power-of-2 butterflies up to radix 8 work in place on bit reversed
+  // registers.
+  bool NaturalOrder() const { return (radix & (radix - 1)) || (radix > 8); }
+
+  // Radix 16 and 32 butterflies: a decimation in frequency network of radix
+  // 2 steps on the temporaries, which leaves the results in bit reversed
+  // order
+  void GenerateDIFStr(std::string& bflyStr) const {
+    std::string tType = cReg ? RegBaseType<PR>(1) : RegBaseType<PR>(count);
+    std::string sfx = FloatSuffix<PR>();
+    double sign = fwd ? -1.0 : 1.0;
+    bflyStr += tType + " UR, UI;\n\n\t";
+
+    for (size_t i = 0; i < radix; i++) {
+      std::string n = SztToStr(i);
+
+      if (cReg) {
+        bflyStr += "TR" + n + " = (R" + n + "[0]).x; TI" + n + " = (R" + n +
+                   "[0]).y;\n\t";
+      } else {
+        bflyStr += "TR" + n + " = (R" + n + "[0]); TI" + n + " = (I" + n +
+                   "[0]);\n\t";
+      }
+    }
+
+    for (size_t span = radix / 2; span >= 1; span /= 2) {
+      bflyStr += "\n\t";
+
+      for (size_t a = 0; a < radix; a++) {
+        if (a & span) {
+          continue;
+        }
+
+        size_t j = a % span;
+        std::string A = SztToStr(a);
+        std::string C = SztToStr(a + span);
+        bflyStr += "UR = TR" + A + " - TR" + C + "; UI = TI" + A + " - TI" +
+                   C + ";\n\t";
+        bflyStr += "TR" + A + " = TR" + A + " + TR" + C + "; TI" + A +
+                   " = TI" + A + " + TI" + C + ";\n\t";
+
+        if (j == 0) {
+          bflyStr += "TR" + C + " = UR; TI" + C + " = UI;\n\t";
+        } else if (2 * j == span) {
+          // Twiddle of -i forward, i backward
+          bflyStr += fwd ? "TR" + C + " = UI; TI" + C + " = -UR;\n\t"
+                         : "TR" + C + " = -UI; TI" + C + " = UR;\n\t";
+        } else {
+          double theta = sign * M_PI * static_cast<double>(j) /
+                         static_cast<double>(span);
+          std::string wr = tType + "(" + FloatToStr(cos(theta)) + sfx + ")";
+          std::string wi = tType + "(" + FloatToStr(sin(theta)) + sfx + ")";
+          bflyStr += "TR" + C + " = " + wr + " * UR - " + wi + " * UI; ";
+          bflyStr += "TI" + C + " = " + wr + " * UI + " + wi + " * UR;\n\t";
+        }
+      }
+    }
+  }
   void GenerateButterflyStr(std::string& bflyStr,
                             const hcfftPlanHandle plHandle) const {
     std::string regType = cReg ? RegBaseType<PR>(2) : RegBaseType<PR>(count);
@@ -328,7 +399,7 @@ class Butterfly {
         bflyStr += regType;
         bflyStr += " *R";
 
-        if (radix & (radix - 1)) {
+        if (NaturalOrder()) {
           bflyStr += SztToStr(i);
         } else {
           bflyStr += SztToStr(BitReverse(i, radix));
@@ -359,7 +430,7 @@ class Butterfly {
     // allocate temporary variables only for non power-of-2 radices
     if (!((radix == 7 && cReg) || (radix == 11 && cReg) ||
           (radix == 13 && cReg))) {
-      if ((radix & (radix - 1)) || (!cReg)) {
+      if (NaturalOrder() || (!cReg)) {
         bflyStr += "\t";
 
         if (cReg) {
@@ -3803,6 +3874,11 @@ class Butterfly {
         bflyStr += radix13str;
       } break;
 
+      case 16:
+      case 32:
+        GenerateDIFStr(bflyStr);
+        break;
+
       default:
         assert(false);
     }
@@ -3810,32 +3886,34 @@ class Butterfly {
     bflyStr += "\n\t";
 
     // Assign results
-    if ((radix & (radix - 1)) || (!cReg)) {
+    if (NaturalOrder() || (!cReg)) {
       if ((radix != 10) && (radix != 6)) {
         for (size_t i = 0; i < radix; i++) {
+          size_t t = (radix > 8) ? BitReverse(i, radix) : i;
+
           if (cReg) {
             if ((radix != 7) && (radix != 11) && (radix != 13)) {
               bflyStr += "((R";
               bflyStr += SztToStr(i);
               bflyStr += "[0]).x) = TR";
-              bflyStr += SztToStr(i);
+              bflyStr += SztToStr(t);
               bflyStr += "; ";
               bflyStr += "((R";
               bflyStr += SztToStr(i);
               bflyStr += "[0]).y) = TI";
-              bflyStr += SztToStr(i);
+              bflyStr += SztToStr(t);
               bflyStr += ";\n\t";
             }
           } else {
             bflyStr += "(R";
             bflyStr += SztToStr(i);
             bflyStr += "[0]) = TR";
-            bflyStr += SztToStr(i);
+            bflyStr += SztToStr(t);
             bflyStr += "; ";
             bflyStr += "(I";
             bflyStr += SztToStr(i);
             bflyStr += "[0]) = TI";
-            bflyStr += SztToStr(i);
+            bflyStr += SztToStr(t);
             bflyStr += ";\n\t";
           }
         }
@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Build-time driver for the prebuilt kernel libraries.
+//
+//   hcfft_aot_kernels <outdir> <max_length> [sizes file]
+//
+// Bakes R2C, C2R and C2C plans in both precisions for every power of 2, 3
+// and 5 up to max_length (1D) and for every "N1 N2" line of the sizes file
+// (2D). The plans go through the public API so that their cache keys are
+// exactly the ones user plans produce. The libraries are written to
+// <outdir>, which is installed as lib/hcfft_kernels. The exit code is 1 when
+// any size fails, so that the build step fails with it.
+
+#include "include/hcfft.h"
+#include "include/hcfftlib.h"
+#include <hc_am.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+static const hcfftType types[] = {HCFFT_R2C, HCFFT_C2R, HCFFT_C2C,
+                                  HCFFT_D2Z, HCFFT_Z2D, HCFFT_Z2Z};
+
+static hcfftResult execPlan(hcfftHandle plan, hcfftType type, void* idata,
+                            void* odata) {
+  switch (type) {
+    case HCFFT_R2C:
+      return hcfftExecR2C(plan, (hcfftReal*)idata, (hcfftComplex*)odata);
+
+    case HCFFT_C2R:
+      return hcfftExecC2R(plan, (hcfftComplex*)idata, (hcfftReal*)odata);
+
+    case HCFFT_C2C:
+      return hcfftExecC2C(plan, (hcfftComplex*)idata, (hcfftComplex*)odata,
+                          HCFFT_FORWARD);
+
+    case HCFFT_D2Z:
+      return hcfftExecD2Z(plan, (hcfftDoubleReal*)idata,
+                          (hcfftDoubleComplex*)odata);
+
+    case HCFFT_Z2D:
+      return hcfftExecZ2D(plan, (hcfftDoubleComplex*)idata,
+                          (hcfftDoubleReal*)odata);
+
+    case HCFFT_Z2Z:
+      return hcfftExecZ2Z(plan, (hcfftDoubleComplex*)idata,
+                          (hcfftDoubleComplex*)odata, HCFFT_FORWARD);
+
+    default:
+      return HCFFT_INVALID_VALUE;
+  }
+}
+
+static bool bakeKernels(hc::accelerator& acc, size_t N1, size_t N2) {
+  bool ok = true;
+  // Large enough for the complex side of every type and precision
+  size_t bytes = 2 * sizeof(double) * (N1 + 2) * N2;
+  void* idata = hc::am_alloc(bytes, acc, 0);
+  void* odata = hc::am_alloc(bytes, acc, 0);
+
+  if (idata == NULL || odata == NULL) {
+    std::cout << "Buffer allocation failed for " << N1 << "x" << N2
+              << std::endl;
+    hc::am_free(idata);
+    hc::am_free(odata);
+    return false;
+  }
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    hcfftHandle plan;
+    hcfftResult status = (N2 == 1)
+                             ? hcfftPlan1d(&plan, N1, types[i])
+                             : hcfftPlan2d(&plan, N1, N2, types[i]);
+
+    if (status == HCFFT_SUCCESS) {
+      status = execPlan(plan, types[i], idata, odata);
+      hcfftDestroy(plan);
+    }
+
+    if (status != HCFFT_SUCCESS) {
+      std::cout << "Skipping " << N1 << "x" << N2 << " type 0x" << std::hex
+                << types[i] << std::dec << std::endl;
+      ok = false;
+    }
+  }
+
+  hc::am_free(idata);
+  hc::am_free(odata);
+  return ok;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0] << " <outdir> <max_length> [sizes file]"
+              << std::endl;
+    return 1;
+  }
+
+  setenv("HCFFT_CACHE_DIR", argv[1], 1);
+  // Never evict prebuilt kernels
+  setenv("HCFFT_CACHE_SIZE", "18446744073709551615", 1);
+  size_t maxLength = atoi(argv[2]);
+  std::vector<size_t> lengths;
+  const size_t radices[] = {2, 3, 5};
+
+  for (size_t r = 0; r < 3; r++) {
+    for (size_t len = radices[r]; len <= maxLength; len *= radices[r]) {
+      lengths.push_back(len);
+    }
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+
+  if (accs.size() < 2) {
+    std::cout << "There is no accelerator!" << std::endl;
+    return 1;
+  }
+
+  size_t failed = 0;
+
+  for (size_t i = 0; i < lengths.size(); i++) {
+    failed += bakeKernels(accs[1], lengths[i], 1) ? 0 : 1;
+  }
+
+  if (argc > 3) {
+    std::ifstream sizes(argv[3]);
+    size_t N1, N2;
+
+    while (sizes >> N1 >> N2) {
+      failed += bakeKernels(accs[1], N1, N2) ? 0 : 1;
+    }
+  }
+
+  if (failed != 0) {
+    std::cout << failed << " sizes could not be prebuilt" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
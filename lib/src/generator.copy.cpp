@@ -35,6 +35,7 @@ class CopyKernel {
   const FFTKernelGenKeyParams params;
   bool h2c, c2h;
   bool general;
+  bool split;
 
   inline std::string OffsetCalc(const std::string& off, bool input = true) {
     std::string str;
@@ -68,6 +69,106 @@ class CopyKernel {
     return str;
   }
 
+  //  Split kernel of an even length N real transform done as a complex one
+  //  of length H = N/2 over z[n] = x[2n] + i x[2n+1]. In forward the
+  //  hermitian X[k] = E[k] + W^k O[k] is taken from Z[k] and Z[H-k], where
+  //  E = (Z[k] + conj(Z[H-k]))/2 and O = (Z[k] - conj(Z[H-k]))/2i are the
+  //  transforms of the even and the odd values. In backward Z[k] = E[k] +
+  //  i W^-k O[k] is packed from X[k] and X[H-k] the same way.
+  void GenerateSplit(std::string& str, bool inIlvd, bool outIlvd) {
+    std::string rType = StockhamGenerator::RegBaseType<PR>(1);
+    std::string r2Type = StockhamGenerator::RegBaseType<PR>(2);
+    std::string sfx = StockhamGenerator::FloatSuffix<PR>();
+    size_t H = N / 2;
+    size_t NtRounded64 = DivRoundingUp<size_t>(Nt, 64) * 64;
+    double angle = (c2h ? -6.283185307179586476925286766559
+                        : 6.283185307179586476925286766559) /
+                   static_cast<double>(N);
+    str += "\tuint me = tidx.global[0];\n\t";
+    str += "uint batch = me/";
+    str += SztToStr(NtRounded64);
+    str += ";\n\t";
+    str += "uint meg = me%";
+    str += SztToStr(NtRounded64);
+    str += ";\n\t";
+    str += "uint iOffset;\n\t";
+    str += "uint oOffset;\n";
+    str += OffsetCalc("iOffset", true);
+    str += OffsetCalc("oOffset", false);
+    // Forward writes all of the Nt hermitian values, backward the H complex
+    str += "\n\tif(meg < ";
+    str += SztToStr(c2h ? Nt : H);
+    str += ")\n\t{\n\t";
+    str += "uint mel = ";
+    str += c2h ? "meg%" + SztToStr(H) : "meg";
+    str += ";\n\t";
+    str += "uint mel2 = ";
+    str += c2h ? "(" + SztToStr(H) + " - meg)%" + SztToStr(H)
+               : SztToStr(H) + " - meg";
+    str += ";\n\t";
+    str += r2Type + " A, B, E, O, W, R;\n\t";
+
+    if (inIlvd) {
+      str += "A = gbIn[iOffset + mel*";
+      str += SztToStr(params.fft_inStride[0]);
+      str += "];\n\t";
+      str += "B = gbIn[iOffset + mel2*";
+      str += SztToStr(params.fft_inStride[0]);
+      str += "];\n\t";
+    } else {
+      str += "A.x = gbInRe[iOffset + mel*";
+      str += SztToStr(params.fft_inStride[0]);
+      str += "];\n\t";
+      str += "A.y = gbInIm[iOffset + mel*";
+      str += SztToStr(params.fft_inStride[0]);
+      str += "];\n\t";
+      str += "B.x = gbInRe[iOffset + mel2*";
+      str += SztToStr(params.fft_inStride[0]);
+      str += "];\n\t";
+      str += "B.y = gbInIm[iOffset + mel2*";
+      str += SztToStr(params.fft_inStride[0]);
+      str += "];\n\t";
+    }
+
+    // The angle of meg in the precision of the kernel, as in the computed
+    // large twiddles of TwiddleTableLarge
+    str += rType + " a = (" + rType + ")meg * (" + rType + ")(";
+    str += StockhamGenerator::FloatToStr(angle);
+    str += ");\n\t";
+    str += "W = " + r2Type;
+    str += "(hc::precise_math::cos(a), hc::precise_math::sin(a));\n\t";
+
+    if (c2h) {
+      str += "E = " + r2Type + "((A.x + B.x)*0.5" + sfx + ", (A.y - B.y)*0.5";
+      str += sfx + ");\n\t";
+      str += "O = " + r2Type + "((A.y + B.y)*0.5" + sfx + ", (B.x - A.x)*0.5";
+      str += sfx + ");\n\t";
+      str += "R.x = E.x + W.x*O.x - W.y*O.y;\n\t";
+      str += "R.y = E.y + W.x*O.y + W.y*O.x;\n\t";
+    } else {
+      str += "E = " + r2Type + "(A.x + B.x, A.y - B.y);\n\t";
+      str += "R = " + r2Type + "(A.x - B.x, A.y + B.y);\n\t";
+      str += "O = " + r2Type;
+      str += "(R.x*W.x - R.y*W.y, R.x*W.y + R.y*W.x);\n\t";
+      str += "R = " + r2Type + "(E.x - O.y, E.y + O.x);\n\t";
+    }
+
+    if (outIlvd) {
+      str += "gbOut[oOffset + meg*";
+      str += SztToStr(params.fft_outStride[0]);
+      str += "] = R;\n";
+    } else {
+      str += "gbOutRe[oOffset + meg*";
+      str += SztToStr(params.fft_outStride[0]);
+      str += "] = R.x;\n\t";
+      str += "gbOutIm[oOffset + meg*";
+      str += SztToStr(params.fft_outStride[0]);
+      str += "] = R.y;\n";
+    }
+
+    str += "\t}\n";
+  }
+
  public:
   explicit CopyKernel(const FFTKernelGenKeyParams& paramsVal)
       : params(paramsVal) {
@@ -82,6 +183,7 @@ class CopyKernel {
               ? true
               : false;
     general = !(h2c || c2h);
+    split = params.fft_RCsplit;
     // We only do out-of-place copies at this point
     assert(params.fft_placeness == HCFFT_OUTOFPLACE);
   }
@@ -119,7 +221,7 @@ class CopyKernel {
 
     str += SztToStr(count);
     str +=
-        "(std::map<int, void*> vectArr, uint batchSize, accelerator_view "
+        "(const hcfftKernelArgs *args, uint batchSize, accelerator_view "
         "&acc_view, accelerator &acc)";
     str += "{\n\t";
     int arg = 0;
@@ -128,7 +230,7 @@ class CopyKernel {
       str += r2Type;
       str += " *gbIn = static_cast<";
       str += r2Type;
-      str += "*> (vectArr[";
+      str += "*> (args->buffers[";
       str += SztToStr(arg);
       str += "]);\n";
       arg++;
@@ -136,14 +238,14 @@ class CopyKernel {
       str += rType;
       str += " *gbInRe = static_cast<";
       str += rType;
-      str += "*> (vectArr[";
+      str += "*> (args->buffers[";
       str += SztToStr(arg);
       str += "]);\n";
       arg++;
       str += rType;
       str += " *gbInIm = static_cast";
       str += rType;
-      str += "*> (vectArr[";
+      str += "*> (args->buffers[";
       str += SztToStr(arg);
       str += "]);\n";
       arg++;
@@ -153,7 +255,7 @@ class CopyKernel {
       str += r2Type;
       str += " *gbOut = static_cast<";
       str += r2Type;
-      str += "*> (vectArr[";
+      str += "*> (args->buffers[";
       str += SztToStr(arg);
       str += "]);\n";
       arg++;
@@ -161,14 +263,14 @@ class CopyKernel {
       str += rType;
       str += " *gbInRe = static_cast<";
       str += rType;
-      str += "*> (vectArr[";
+      str += "*> (args->buffers[";
       str += SztToStr(arg);
       str += "]);\n";
       arg++;
       str += rType;
       str += " *gbOutIm = static_cast<";
       str += rType;
-      str += "*> (vectArr[";
+      str += "*> (args->buffers[";
       str += SztToStr(arg);
       str += "]);\n";
       arg++;
@@ -184,6 +286,12 @@ class CopyKernel {
         "\thc::parallel_for_each(acc_view, t_ext, [=] (hc::tiled_index<2> "
         "tidx) [[hc]]\n\t {";
 
+    if (split) {
+      GenerateSplit(str, inIlvd, outIlvd);
+      str += " });\n}}\n\n";
+      return;
+    }
+
     // Initialize
     if (general) {
       str += "\tuint me = tidx.local[0];\n\t";
@@ -385,7 +493,7 @@ class CopyKernel {
       str += "}\n\n";
     }
 
-    str += " }).wait();\n}}\n\n";
+    str += " });\n}}\n\n";
   }
 };
 };  // namespace CopyGenerator
@@ -420,6 +528,7 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Copy>(
   params.fft_outStride[i] = this->oDist;
   params.fft_fwdScale = this->forwardScale;
   params.fft_backScale = this->backwardScale;
+  params.fft_RCsplit = this->RCsplit;
   params.limit_LocalMemSize = this->envelope.limit_LocalMemSize;
   return HCFFT_SUCCEEDS;
 }
@@ -500,13 +609,13 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Copy>(const hcfftPlanHandle plHandle,
       } break;
     }
 
-    fftRepo.setProgramCode(Copy, plHandle, params, programCode);
+    fftRepo.setProgramCode(Copy, count, params, programCode);
 
     if (general) {
-      fftRepo.setProgramEntryPoints(Copy, plHandle, params, "copy_general",
+      fftRepo.setProgramEntryPoints(Copy, count, params, "copy_general",
                                     "copy_general");
     } else {
-      fftRepo.setProgramEntryPoints(Copy, plHandle, params, "copy_c2h",
+      fftRepo.setProgramEntryPoints(Copy, count, params, "copy_c2h",
                                     "copy_h2c");
     }
   }
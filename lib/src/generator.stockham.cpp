@@ -108,8 +108,7 @@ namespace StockhamGenerator {
 // Experimental End ===========================================
 
 #define RADIX_TABLE_COMMON                                   \
-  {2048, 256, 1, 4, {8, 8, 8, 4, 0, 0, 0, 0, 0, 0, 0, 0}},   \
-      {512, 64, 1, 3, {8, 8, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0}}, \
+  {512, 64, 1, 3, {8, 8, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0}},     \
       {256, 64, 1, 4, {4, 4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0}}, \
       {64, 64, 4, 3, {4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0}},  \
       {32, 64, 16, 2, {8, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}, \
@@ -138,8 +137,9 @@ class KernelCoreSpecs {
             RADIX_TABLE_COMMON
 
             //  Length, WorkGroupSize, NumTransforms, NumPasses,  Radices
-            {4096, 256, 1, 4, {8, 8, 8, 8, 0, 0, 0, 0, 0, 0, 0, 0}},
-            {1024, 128, 1, 4, {8, 8, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0}},
+            {4096, 256, 1, 3, {16, 16, 16, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+            {2048, 128, 1, 3, {16, 16, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+            {1024, 64, 1, 3, {16, 16, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
             {128, 64, 4, 3, {8, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
             {8, 64, 32, 2, {4, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
         };
@@ -155,6 +155,7 @@ class KernelCoreSpecs {
             RADIX_TABLE_COMMON
 
             //  Length, WorkGroupSize, NumTransforms, NumPasses,  Radices
+            {2048, 256, 1, 4, {8, 8, 8, 4, 0, 0, 0, 0, 0, 0, 0, 0}},
             {1024, 128, 1, 4, {8, 8, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0}},
             // {128, 64, 1, 7, { 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0}},
             {128, 64, 4, 3, {8, 8, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
@@ -360,28 +361,86 @@ void DetermineSizes(const size_t &MAX_WGS, const size_t &length,
   assert(workGroupSize <= MAX_WGS);
 }
 
+// Radices of the passes of a kernel of length, with cnPerWI complex numbers
+// per work-item, from the table when it has the length or else the largest
+// radices that divide cnPerWI. A radix r butterfly holds r values and as many
+// temporaries in registers, so radix 32 is left to single precision.
+template <StockhamGenerator::Precision PR>
+void DetermineRadices(const size_t &MAX_WGS, const size_t &length,
+                      const size_t &cnPerWI, std::vector<size_t> &radices) {
+  const size_t *pRadices = NULL;
+  size_t nPasses;
+  StockhamGenerator::KernelCoreSpecs<PR> kcs;
+  kcs.GetRadices(length, nPasses, pRadices);
+  radices.clear();
+
+  for (size_t i = 0; (MAX_WGS >= 256) && pRadices && (i < nPasses); i++) {
+    if (cnPerWI % pRadices[i]) {
+      pRadices = NULL;
+    }
+  }
+
+  if ((MAX_WGS >= 256) && (pRadices != NULL)) {
+    radices.assign(pRadices, pRadices + nPasses);
+    return;
+  }
+
+  // Possible radices
+  size_t cRad[] = {32, 16, 13, 11, 10, 8, 7,
+                   6,  5,  4,  3,  2,  1};  // Must be in descending order
+  size_t cRadSize = (sizeof(cRad) / sizeof(cRad[0]));
+  size_t maxRad = (PR == StockhamGenerator::P_SINGLE) ? 32 : 16;
+  size_t R = length;
+
+  while (true) {
+    size_t rad;
+    assert(cRadSize >= 1);
+
+    for (size_t r = 0; r < cRadSize; r++) {
+      rad = cRad[r];
+
+      if ((rad > maxRad) || (rad > cnPerWI) || (cnPerWI % rad)) {
+        continue;
+      }
+
+      if (!(R % rad)) {
+        break;
+      }
+    }
+
+    assert((cnPerWI % rad) == 0);
+    R /= rad;
+    radices.push_back(rad);
+    assert(R >= 1);
+
+    if (R == 1) {
+      break;
+    }
+  }
+}
+
 // Twiddle factors table
 template <class T>
 class TwiddleTable {
   size_t N;  // length
-  T *wc;     // cosine, sine arrays
 
  public:
-  explicit TwiddleTable(size_t length) : N(length) {
-    // Allocate memory for the tables
-    // We compute twiddle factors in double precision for both StockhamGenerator::P_SINGLE and
-    // StockhamGenerator::P_DOUBLE
-    wc = new T[N];
-  }
-
-  ~TwiddleTable() {
-    // Free
-    delete[] wc;
-  }
+  explicit TwiddleTable(size_t length) : N(length) {}
 
   void GenerateTwiddleTable(void **twiddles, hc::accelerator acc,
                             const std::vector<size_t> &radices) {
-    const double TWO_PI = -6.283185307179586476925286766559;
+    // Tables of the same radices and element size are shared
+    std::vector<size_t> shape(1, sizeof(T));
+    shape.insert(shape.end(), radices.begin(), radices.end());
+    FFTRepo &fftRepo = FFTRepo::getInstance();
+    scopedLock sLock(FFTRepo::lockRepo, _T("GenerateTwiddleTable"));
+    fftRepo.acquireTwiddles(acc, shape, *twiddles);
+
+    if (*twiddles != NULL) {
+      return;
+    }
+
+    scopedTimer timer(hcfftTwiddleSeconds);
     // Make sure the radices vector sums up to N
     size_t sz = 1;
 
@@ -391,35 +450,11 @@ class TwiddleTable {
     }
 
     assert(sz == N);
-    // Generate the table
-    size_t L = 1;
-    size_t nt = 0;
-
-    for (std::vector<size_t>::const_iterator i = radices.begin();
-         i != radices.end(); i++) {
-      size_t radix = *i;
-      L *= radix;
-
-      // Twiddle factors
-      for (size_t k = 0; k < (L / radix); k++) {
-        double theta =
-            (TWO_PI * static_cast<double>(k)) / static_cast<double>(L);
-
-        for (size_t j = 1; j < radix; j++) {
-          double c = cos(static_cast<double>(j) * theta);
-          double s = sin(static_cast<double>(j) * theta);
-          // if (fabs(c) < 1.0E-12)  c = 0.0;
-          // if (fabs(s) < 1.0E-12)  s = 0.0;
-          wc[nt].x = c;
-          wc[nt++].y = s;
-        }
-      }
-    }
-
     *twiddles = (T *)hc::am_alloc(N * sizeof(T), acc, 0);
-    hc::accelerator_view accl_view = acc.get_default_view();
-    accl_view.copy(wc, *twiddles, N * sizeof(T));
-    assert(twiddles != NULL);
+    assert(*twiddles != NULL);
+    hcfftDeviceTwiddles(acc, *twiddles, sizeof(T) == 2 * sizeof(double),
+                        radices);
+    fftRepo.addTwiddles(acc, shape, *twiddles);
   }
 };
 
@@ -456,6 +491,48 @@ class Pass {
   bool linearRegs;
   Pass<PR> *nextPass;
 
+  // Names of the user callbacks applied to the global reads of this pass and
+  // its global writes, or NULL
+  const char *loadCallback;
+  const char *storeCallback;
+
+  // The twiddle table of a double-precision pass holds float_2 values
+  bool singleTwiddles;
+
+  // The global reads of this pass may load 2 complex floats at once
+  bool groupReads;
+
+  // Elements per row of LDS banks of the swizzled layout of the LDS this pass
+  // reads and of the one it writes, or 0 for the plain layout
+  size_t ldsSwizzleIn;
+  size_t ldsSwizzleOut;
+
+  // LDS index of element index, whose low bits are XORed with its row in a
+  // swizzled layout. The layout is a permutation within each row of banks,
+  // so strided accesses spread over the banks without padding.
+  std::string LdsIndex(size_t row, const std::string &index) const {
+    if (row == 0) {
+      return index;
+    }
+
+    size_t shift = 0;
+
+    while ((size_t(1) << shift) < row) {
+      shift++;
+    }
+
+    std::string str = "((";
+    str += index;
+    str += ") ^ (((";
+    str += index;
+    str += ") >> ";
+    str += SztToStr(shift);
+    str += ") & ";
+    str += SztToStr(row - 1);
+    str += "))";
+    return str;
+  }
+
   inline void RegBase(size_t regC, std::string &str) const {
     str += "B";
     str += SztToStr(regC);
@@ -616,6 +693,13 @@ class Pass {
     std::string rType = RegBaseType<PR>(1);
     size_t butterflyIndex = numPrev;
     std::string bufOffset;
+    size_t ldsRow = 0;
+
+    if (flag == SR_READ) {
+      ldsRow = ldsSwizzleIn;
+    } else if (flag == SR_WRITE) {
+      ldsRow = ldsSwizzleOut;
+    }
     std::string regBase;
     RegBase(regC, regBase);
 
@@ -624,7 +708,7 @@ class Pass {
     if (numB && (numB % 2 == 0) && (regC == 1) && (stride == 1) &&
         (numButterfly % 2 == 0) && (algLS % 2 == 0) && (flag == SR_WRITE) &&
         (nextPass == NULL) && interleaved && (component == SR_COMP_BOTH) &&
-        linearRegs && enableGrouping) {
+        linearRegs && enableGrouping && (storeCallback == NULL)) {
       assert((numButterfly * workGroupSize) == algLS);
       assert(bufferRe.compare(bufferIm) == 0);  // Make sure Real & Imag buffer
                                                 // strings are same for
@@ -686,6 +770,66 @@ class Pass {
       return;
     }
 
+    // special read from global memory with float4 grouping, reading 2
+    // adjacent complex numbers at once. The offsets of the work items and
+    // registers are even, so the loads are 16-byte aligned when the buffer
+    // is; other buffers take the reads of one complex number.
+    if (numB && (numB % 2 == 0) && (regC == 1) && (stride == 1) &&
+        (numButterfly % 2 == 0) && (numPrev % 2 == 0) &&
+        ((length / radix) % 2 == 0) && (flag == SR_READ) && groupReads &&
+        interleaved && (component == SR_COMP_BOTH) && linearRegs &&
+        (loadCallback == NULL) && (PR == StockhamGenerator::P_SINGLE)) {
+      assert(bufferRe.compare(bufferIm) == 0);  // Make sure Real & Imag buffer
+                                                // strings are same for
+                                                // interleaved data
+      passStr += "\n\tif((((size_t)";
+      passStr += bufferRe;
+      passStr += ") & 15) == 0)\n\t{\n\t";
+      passStr += RegBaseType<PR>(4);
+      passStr += " *buff4gIn = (";
+      passStr += RegBaseType<PR>(4);
+      passStr += "*)";
+      passStr += bufferRe;
+      passStr += ";\n\t";
+
+      for (size_t r = 0; r < radix; r++) {
+        for (size_t i = 0; i < numB; i += 2) {
+          std::string regIndexA = "(R";
+          std::string regIndexB = "(R";
+          RegBaseAndCountAndPos("", i * radix + r, regIndexA);
+          regIndexA += "[0])";
+          RegBaseAndCountAndPos("", (i + 1) * radix + r, regIndexB);
+          regIndexB += "[0])";
+          passStr += "\n\t{\n\t\t";
+          passStr += RegBaseType<PR>(4);
+          passStr += " T = buff4gIn[(";
+          passStr += offset;
+          passStr += " + ";
+          passStr += SztToStr(numPrev + i + r * length / radix);
+          passStr += " + me*";
+          passStr += SztToStr(numButterfly);
+          passStr += ")/2];\n\t\t";
+          passStr += regIndexA;
+          passStr += " = ";
+          passStr += RegBaseType<PR>(2);
+          passStr += "(T.x, T.y);\n\t\t";
+          passStr += regIndexB;
+          passStr += " = ";
+          passStr += RegBaseType<PR>(2);
+          passStr += "(T.z, T.w);\n\t}";
+        }
+      }
+
+      Pass<PR> single(*this);
+      single.SetGroupedReads(false);
+      passStr += "\n\t}\n\telse\n\t{";
+      single.SweepRegs(plHandle, flag, fwd, interleaved, stride, component,
+                       scale, frontTwiddle, bufferRe, bufferIm, offset, regC,
+                       numB, numPrev, passStr, isPrecallVector, oddt);
+      passStr += "\n\t}\n";
+      return;
+    }
+
     size_t hid = 0;
     bool swapElement = false;
     size_t tIter = numB * radix;
@@ -764,10 +908,21 @@ class Pass {
             passStr += "\n\t";
             passStr += regIndex;
             passStr += " = ";
-            passStr += buffer;
-            passStr += "[";
-            passStr += bufOffset;
-            passStr += "]";
+
+            if (loadCallback && interleaved && (component == SR_COMP_BOTH)) {
+              passStr += loadCallback;
+              passStr += "(";
+              passStr += buffer;
+              passStr += ", ";
+              passStr += bufOffset;
+              passStr += ", loadData)";
+            } else {
+              passStr += buffer;
+              passStr += "[";
+              passStr += LdsIndex(ldsRow, bufOffset);
+              passStr += "]";
+            }
+
             passStr += tail;
 
             // Since we read real & imag at once, we break the loop
@@ -879,14 +1034,26 @@ class Pass {
             }
 
             passStr += "\n\t";
-            passStr += buffer;
-            passStr += "[";
-            passStr += bufOffset;
-            passStr += "]";
-            passStr += tail;
-            passStr += " = ";
-            passStr += regIndex;
-            passStr += ";";
+
+            if (storeCallback && interleaved && (component == SR_COMP_BOTH)) {
+              passStr += storeCallback;
+              passStr += "(";
+              passStr += buffer;
+              passStr += ", ";
+              passStr += bufOffset;
+              passStr += ", ";
+              passStr += regIndex;
+              passStr += ", storeData);";
+            } else {
+              passStr += buffer;
+              passStr += "[";
+              passStr += bufOffset;
+              passStr += "]";
+              passStr += tail;
+              passStr += " = ";
+              passStr += regIndex;
+              passStr += ";";
+            }
 
             // Since we write real & imag at once, we break the loop
             if (interleaved && (component == SR_COMP_BOTH)) {
@@ -988,7 +1155,7 @@ class Pass {
               passStr += " = ";
               passStr += buffer;
               passStr += "[";
-              passStr += bufOffset;
+              passStr += LdsIndex(ldsRow, bufOffset);
               passStr += "]";
               passStr += tail;
             }
@@ -1032,8 +1199,8 @@ class Pass {
               }
 
               passStr += "\n\t{\n\t\t";
-              passStr += twType;
-              passStr += " W = ";
+              passStr += singleTwiddles ? "float_2" : twType;
+              passStr += singleTwiddles ? " Ws = " : " W = ";
               passStr += twTable;
               passStr += "[";
               passStr += SztToStr(algLS - 1);
@@ -1048,6 +1215,13 @@ class Pass {
               passStr += ") + ";
               passStr += SztToStr(r - 1);
               passStr += "];\n\t\t";
+
+              if (singleTwiddles) {
+                passStr += twType;
+                passStr += " W = ";
+                passStr += twType;
+                passStr += "(Ws.x, Ws.y);\n\t\t";
+              }
             } else {  // 3-step twiddle
               passStr += "\n\t{\n\t\t";
               passStr += twType;
@@ -1283,7 +1457,7 @@ class Pass {
               bufOffset += SztToStr(stride);
               passStr += buffer;
               passStr += "[";
-              passStr += bufOffset;
+              passStr += LdsIndex(ldsRow, bufOffset);
               passStr += "]";
               passStr += tail;
               passStr += " = ";
@@ -1814,7 +1988,13 @@ class Pass {
         halfLds(halfLdsVal),
         enableGrouping(true),
         linearRegs(linearRegsVal),
-        nextPass(NULL) {
+        nextPass(NULL),
+        loadCallback(NULL),
+        storeCallback(NULL),
+        singleTwiddles(false),
+        groupReads(false),
+        ldsSwizzleIn(0),
+        ldsSwizzleOut(0) {
     assert(radix <= length);
     assert(length % radix == 0);
     numButterfly = cnPerWI / radix;
@@ -1850,9 +2030,17 @@ class Pass {
 
   size_t GetPosition() const { return position; }
   size_t GetRadix() const { return radix; }
+  const char *GetLoadCallback() const { return loadCallback; }
+  const char *GetStoreCallback() const { return storeCallback; }
 
   void SetNextPass(Pass<PR> *np) { nextPass = np; }
   void SetGrouping(bool grp) { enableGrouping = grp; }
+  void SetGroupedReads(bool grp) { groupReads = grp; }
+  void SetLoadCallback(const char *name) { loadCallback = name; }
+  void SetStoreCallback(const char *name) { storeCallback = name; }
+  void SetSingleTwiddles(bool single) { singleTwiddles = single; }
+  void SetLdsSwizzleIn(size_t row) { ldsSwizzleIn = row; }
+  void SetLdsSwizzleOut(size_t row) { ldsSwizzleOut = row; }
   void GeneratePass(const hcfftPlanHandle plHandle, bool fwd,
                     std::string &passStr, bool fft_3StepTwiddle,
                     bool twiddleFront, bool inInterleaved, bool outInterleaved,
@@ -2114,7 +2302,7 @@ class Pass {
 
     if (length > 1) {
       passStr += ", ";
-      passStr += twType;
+      passStr += singleTwiddles ? "float_2" : twType;
       passStr += " *";
       passStr += TwTableName();
     }
@@ -2126,6 +2314,14 @@ class Pass {
       passStr += TwTableLargeName();
     }
 
+    if (loadCallback) {
+      passStr += ", void *loadData";
+    }
+
+    if (storeCallback) {
+      passStr += ", void *storeData";
+    }
+
     passStr += ", hc::tiled_index<2> &tidx) [[hc]]\n{\n";
 
     // Register Declarations
@@ -2685,6 +2881,63 @@ class Pass {
   }
 };
 
+//  Launch grid of a kernel, computed from its batchSize argument as
+//  FFTPlan::GetWorkSizesPvt<Stockham> does, so that one compiled kernel runs
+//  any batch and any chunk of one
+inline std::string GridExtent(const FFTKernelGenKeyParams &params) {
+  size_t elements = 1;
+
+  for (size_t i = 0; i + 1 < params.fft_DataDim; i++) {
+    elements *= std::max<size_t>(1, params.fft_N[i]);
+  }
+
+  std::string str = "\tunsigned long long groups = ";
+  size_t groupSize = params.fft_SIMD;
+
+  if (params.fft_lds2D) {
+    str += "((unsigned long long)batchSize + ";
+    str += SztToStr(params.fft_R - 1);
+    str += ") / ";
+    str += SztToStr(params.fft_R);
+    str += ";\n";
+  } else if (params.blockCompute) {
+    str += "(";
+    str += SztToStr(elements);
+    str += "ULL * batchSize + ";
+    str += SztToStr(params.blockLDS - 1);
+    str += ") / ";
+    str += SztToStr(params.blockLDS);
+    str += ";\n";
+    groupSize = params.blockSIMD;
+  } else {
+    //  Work-items, then work-groups; real transforms do two per work-group
+    str += "(";
+    str += SztToStr(elements);
+    str += "ULL * batchSize + ";
+    str += SztToStr(params.fft_R - 1);
+    str += ") / ";
+    str += SztToStr(params.fft_R);
+    str += ";\n\tgroups = (groups + ";
+    str += SztToStr(params.fft_SIMD - 1);
+    str += ") / ";
+    str += SztToStr(params.fft_SIMD);
+    str += ";\n";
+
+    if (!(params.fft_RCsimple) &&
+        ((params.fft_inputLayout == HCFFT_REAL) ||
+         (params.fft_outputLayout == HCFFT_REAL))) {
+      str += "\tgroups = (groups + 1) / 2;\n";
+    }
+
+    str += "\tgroups = (groups < 1) ? 1 : groups;\n";
+  }
+
+  str += "\thc::extent<2> grdExt(groups * ";
+  str += SztToStr(groupSize);
+  str += ", 1);\n";
+  return str;
+}
+
 // FFT kernel
 template <StockhamGenerator::Precision PR>
 class Kernel {
@@ -2830,10 +3083,19 @@ class Kernel {
     return str;
   }
 
+  //  Stride i of the input or the output. Kernels of runtime shape name the
+  //  strides above the first, bound to their hcfftKernelArgs at launch.
+  inline std::string StrideStr(bool input, size_t i) {
+    if (params.fft_runtimeShape && (i > 0)) {
+      return (input ? "inStride" : "outStride") + SztToStr(i);
+    }
+
+    return SztToStr(input ? params.fft_inStride[i] : params.fft_outStride[i]);
+  }
+
   inline std::string OffsetCalc(const std::string &off, bool input = true,
                                 bool rc_second_index = false) {
     std::string str;
-    const size_t *pStride = input ? params.fft_inStride : params.fft_outStride;
     std::string batch;
 
     if (r2c2r && !rcSimple) {
@@ -2882,14 +3144,14 @@ class Kernel {
       str += "/";
       str += SztToStr(currentLength);
       str += ")*";
-      str += SztToStr(pStride[i]);
+      str += StrideStr(input, i);
       str += " + ";
       nextBatch = "(" + nextBatch + "%" + SztToStr(currentLength) + ")";
     }
 
     str += nextBatch;
     str += "*";
-    str += SztToStr(pStride[1]);
+    str += StrideStr(input, 1);
     str += ";\n";
     return str;
   }
@@ -2930,7 +3192,8 @@ class Kernel {
     }
 
     rcSimple = params.fft_RCsimple;
-    halfLds = true;
+    // Complex LDS exchanges both parts between passes behind one barrier
+    halfLds = !params.fft_LdsComplex || r2c2r;
     linearRegs = true;
     realSpecial = params.fft_realSpecial;
     blockCompute = params.blockCompute;
@@ -2939,7 +3202,9 @@ class Kernel {
     // Make sure we can utilize all Lds if we are going to
     // use blocked columns to compute FFTs
     if (blockCompute) {
-      assert(length <= 256);  // 256 parameter comes from prototype experiments
+      // 256 parameter comes from prototype experiments; 512 takes narrower
+      // blocks, for the Z columns of 3D slabs
+      assert(length <= 512);
       // largest length at which block column possible given 32KB LDS limit
       // if LDS limit is different this number need to be changed appropriately
       halfLds = false;
@@ -2957,76 +3222,81 @@ class Kernel {
     size_t LS = 1;
     size_t L;
     size_t R = length;
-    size_t pid = 0;
-    // See if we can get radices from the lookup table
-    const size_t *pRadices = NULL;
-    size_t nPasses;
-    StockhamGenerator::KernelCoreSpecs<PR> kcs;
-    kcs.GetRadices(length, nPasses, pRadices);
-
-    if ((params.fft_MaxWorkGroupSize >= 256) && (pRadices != NULL)) {
-      for (size_t i = 0; i < nPasses; i++) {
-        size_t rad = pRadices[i];
-        L = LS * rad;
-        R /= rad;
-        radices.push_back(rad);
-        passes.push_back(Pass<PR>(i, length, rad, cnPerWI, L, LS, R, linearRegs,
-                                  halfLds, r2c, c2r, rcFull, rcSimple,
-                                  realSpecial));
-        LS *= rad;
-      }
+    DetermineRadices<PR>(params.fft_MaxWorkGroupSize, length, cnPerWI,
+                         radices);
+
+    for (size_t i = 0; i < radices.size(); i++) {
+      size_t rad = radices[i];
+      L = LS * rad;
+      R /= rad;
+      passes.push_back(Pass<PR>(i, length, rad, cnPerWI, L, LS, R, linearRegs,
+                                halfLds, r2c, c2r, rcFull, rcSimple,
+                                realSpecial));
+      LS *= rad;
+    }
 
-      assert(R == 1);  // this has to be true for correct radix composition of
-                       // the length
-      numPasses = nPasses;
-    } else {
-      // Possible radices
-      size_t cRad[] = {13, 11, 10, 8, 7, 6,
-                       5,  4,  3,  2, 1};  // Must be in descending order
-      size_t cRadSize = (sizeof(cRad) / sizeof(cRad[0]));
+    assert(R == 1);  // this has to be true for correct radix composition of
+                     // the length
+    numPasses = radices.size();
 
-      while (true) {
-        size_t rad;
-        assert(cRadSize >= 1);
+    assert(numPasses == passes.size());
+    assert(numPasses == radices.size());
+    // Grouping read/writes ok?
+    bool grp = IsGroupedReadWritePossible();
 
-        for (size_t r = 0; r < cRadSize; r++) {
-          rad = cRad[r];
+    for (size_t i = 0; i < numPasses; i++) {
+      passes[i].SetGrouping(grp);
+    }
 
-          if ((rad > cnPerWI) || (cnPerWI % rad)) {
-            continue;
-          }
+    // Only the first pass reads global memory, except in blocked kernels,
+    // whose LDS arrays are not aligned for float4
+    passes.front().SetGroupedReads(grp && !blockCompute);
 
-          if (!(R % rad)) {
-            break;
-          }
-        }
+    // User callbacks replace the global reads of the first pass and the
+    // global writes of the last one
+    if (!blockCompute && !r2c2r) {
+      passes.front().SetLoadCallback(params.fft_loadCallback);
+      passes.back().SetStoreCallback(params.fft_storeCallback);
+    }
 
-        assert((cnPerWI % rad) == 0);
-        L = LS * rad;
-        R /= rad;
-        radices.push_back(rad);
-        passes.push_back(Pass<PR>(pid, length, rad, cnPerWI, L, LS, R,
-                                  linearRegs, halfLds, r2c, c2r, rcFull,
-                                  rcSimple, realSpecial));
-        pid++;
-        LS *= rad;
-        assert(R >= 1);
-
-        if (R == 1) {
-          break;
-        }
+    for (size_t i = 0; i < numPasses; i++) {
+      passes[i].SetSingleTwiddles(params.fft_singleTwiddles);
+    }
+
+    // Power-of-2 passes exchange through LDS at power-of-2 strides, which
+    // map the work items of a wavefront to a few banks. The exchange between
+    // two passes is swizzled when the writes are strided, in blocks of LS
+    // shorter than a row of banks or with several butterflies per work
+    // item, or the reads are.
+    if (params.fft_ldsPadding && !blockCompute && !r2c2r && !realSpecial &&
+        (numPasses > 1) && ((length & (length - 1)) == 0)) {
+      bool inInterleaved =
+          (params.fft_inputLayout == HCFFT_COMPLEX_INTERLEAVED) ||
+          (params.fft_inputLayout == HCFFT_HERMITIAN_INTERLEAVED);
+      bool outInterleaved =
+          (params.fft_outputLayout == HCFFT_COMPLEX_INTERLEAVED) ||
+          (params.fft_outputLayout == HCFFT_HERMITIAN_INTERLEAVED);
+      size_t elementSize =
+          (PR == StockhamGenerator::P_SINGLE) ? sizeof(float) : sizeof(double);
+
+      if (!halfLds && (inInterleaved || outInterleaved)) {
+        elementSize *= 2;
       }
 
-      numPasses = pid;
-    }
+      // The swizzle permutes whole rows, which must tile the LDS arrays
+      size_t row = (ARBITRARY::LDS_BANK_SIZE * sizeof(float)) / elementSize;
+      size_t passLS = 1;
 
-    assert(numPasses == passes.size());
-    assert(numPasses == radices.size());
-    // Grouping read/writes ok?
-    bool grp = IsGroupedReadWritePossible();
+      for (size_t i = 0; (i + 1) < numPasses; i++) {
+        bool stridedWrite = (passLS < row) || ((cnPerWI / radices[i]) > 1);
+        bool stridedRead = (cnPerWI / radices[i + 1]) > 1;
+        passLS *= radices[i];
 
-    for (size_t i = 0; i < numPasses; i++) {
-      passes[i].SetGrouping(grp);
+        if (((length * numTrans) % row == 0) && (stridedWrite || stridedRead)) {
+          passes[i].SetLdsSwizzleOut(row);
+          passes[i + 1].SetLdsSwizzleIn(row);
+        }
+      }
     }
 
     // Store the next pass-object pointers
@@ -3069,6 +3339,11 @@ class Kernel {
       kcs.GetWGSAndNT(N, t_wgs, t_nt);
 
       switch (N) {
+        case 512:
+          bwd = 4 / StockhamGenerator::PrecisionWidth<PR>();
+          wgs = (bwd > t_nt) ? 64 * bwd : t_wgs;
+          break;
+
         case 256:
           bwd = 8 / StockhamGenerator::PrecisionWidth<PR>();
           wgs = (bwd > t_nt) ? 256 : t_wgs;
@@ -3389,7 +3664,7 @@ class Kernel {
     }
 
     if (PR == StockhamGenerator::P_SINGLE) {
-      StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2, PR> twLarge(large1D);
+      StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2, PR> twLarge(large1D, params.fft_computeTwiddles);
 
       // twiddle factors for 1d-large 3-step algorithm
       if (params.fft_3StepTwiddle) {
@@ -3397,7 +3672,7 @@ class Kernel {
         twLarge.TwiddleLargeAV(twiddleslarge, acc);
       }
     } else {
-      StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2, PR> twLarge(large1D);
+      StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2, PR> twLarge(large1D, params.fft_computeTwiddles);
 
       // twiddle factors for 1d-large 3-step algorithm
       if (params.fft_3StepTwiddle) {
@@ -3502,7 +3777,7 @@ class Kernel {
       }
 
       str +=
-          "( std::map<int, void*> vectArr, uint batchSize, accelerator_view "
+          "( const hcfftKernelArgs *args, uint batchSize, accelerator_view "
           "&acc_view, accelerator &acc )\n\t{\n\t";
 
       // Function attributes
@@ -3512,7 +3787,7 @@ class Kernel {
             str += r2Type;
             str += " *gb = static_cast<";
             str += r2Type;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3520,7 +3795,7 @@ class Kernel {
             str += rType;
             str += " *gb = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3534,7 +3809,7 @@ class Kernel {
             str += r2Type;
             str += " *gb = static_cast<";
             str += r2Type;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3542,14 +3817,14 @@ class Kernel {
             str += rType;
             str += " *gbRe = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
             str += rType;
             str += " *gbIm = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3561,7 +3836,7 @@ class Kernel {
             str += r2Type;
             str += " *gbIn = static_cast<";
             str += r2Type;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3569,7 +3844,7 @@ class Kernel {
             str += rType;
             str += " *gbIn = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3577,14 +3852,14 @@ class Kernel {
             str += rType;
             str += " *gbInRe = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
             str += rType;
             str += " *gbInIm = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3594,7 +3869,7 @@ class Kernel {
             str += r2Type;
             str += " *gbOut = static_cast<";
             str += r2Type;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3602,7 +3877,7 @@ class Kernel {
             str += rType;
             str += " *gbOut = static_cast<";
             str += rType;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3610,14 +3885,14 @@ class Kernel {
             str += rType;
             str += " *gbOutRe = static_cast<";
             str += rType;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
             str += rType;
             str += " *gbOutIm = static_cast<";
             str += rType;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3627,7 +3902,7 @@ class Kernel {
             str += r2Type;
             str += " *gbIn = static_cast<";
             str += r2Type;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3635,14 +3910,14 @@ class Kernel {
             str += rType;
             str += " *gbInRe = static_cast<";
             str += rType;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
             str += rType;
             str += " *gbInIm = static_cast<";
             str += rType;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3652,7 +3927,7 @@ class Kernel {
             str += r2Type;
             str += " *gbOut = static_cast<";
             str += r2Type;
-            str += "*> (vectArr[";
+            str += "*> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3660,14 +3935,14 @@ class Kernel {
             str += rType;
             str += " *gbOutRe = static_cast<";
             str += rType;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
             str += rType;
             str += " *gbOutIm = static_cast<";
             str += rType;
-            str += " *> (vectArr[";
+            str += " *> (args->buffers[";
             str += SztToStr(arg);
             str += "]);\n";
             arg++;
@@ -3677,18 +3952,20 @@ class Kernel {
 
       // Twiddle table
       if (length > 1) {
+        std::string twTableType =
+            params.fft_singleTwiddles ? "float_2" : r2Type;
         str += "\n\n";
-        str += r2Type;
+        str += twTableType;
         str += " *";
         str += TwTableName();
         str += " = static_cast< ";
-        str += r2Type;
-        str += " *> (vectArr[";
+        str += twTableType;
+        str += " *> (args->buffers[";
         str += SztToStr(arg);
         str += "]);\n";
         arg++;
 
-        if (PR == StockhamGenerator::P_SINGLE) {
+        if (PR == StockhamGenerator::P_SINGLE || params.fft_singleTwiddles) {
           if (d == 0) {
             StockhamGenerator::TwiddleTable<hc::short_vector::float_2> twTable(length);
             twTable.GenerateTwiddleTable(twiddles, acc, radices);
@@ -3711,15 +3988,40 @@ class Kernel {
         str += TwTableLargeName();
         str += " = static_cast< ";
         str += r2Type;
-        str += " *> (vectArr[";
+        str += " *> (args->buffers[";
         str += SztToStr(arg);
         str += "]);\n";
         arg++;
       }
 
-      str += "\thc::extent<2> grdExt( ";
-      str += SztToStr(gWorkSize[0]);
-      str += ", 1 ); \n";
+      // Data of the user callbacks follows the twiddle tables
+      const bool loadCallback = passes.front().GetLoadCallback() != NULL;
+      const bool storeCallback = passes.back().GetStoreCallback() != NULL;
+
+      if (loadCallback) {
+        str += "\tvoid *loadData = args->buffers[";
+        str += SztToStr(arg);
+        str += "];\n";
+        arg++;
+      }
+
+      if (storeCallback) {
+        str += "\tvoid *storeData = args->buffers[";
+        str += SztToStr(arg);
+        str += "];\n";
+        arg++;
+      }
+
+      if (params.fft_runtimeShape) {
+        for (size_t d = 1; d < params.fft_DataDim; d++) {
+          str += "\tconst unsigned int inStride" + SztToStr(d) +
+                 " = args->inStride[" + SztToStr(d) + "];\n";
+          str += "\tconst unsigned int outStride" + SztToStr(d) +
+                 " = args->outStride[" + SztToStr(d) + "];\n";
+        }
+      }
+
+      str += GridExtent(params);
       str += "\thc::tiled_extent<2> t_ext = grdExt.tile(";
       str += SztToStr(lWorkSize[0]);
       str += ",1);\n";
@@ -3895,13 +4197,19 @@ class Kernel {
 
       totalBatch += "batchSize)";
 
-      // Conditional read-write ('rw') for arbitrary batch number
+      // Conditional read-write ('rw') for arbitrary batch number. Groups
+      // past the end of the batch, as when a chunk of a split batch is
+      // launched, compare without the unsigned difference wrapping.
       if (r2c2r && !rcSimple) {
-        str += "\tunsigned int thisvar = ";
+        str += "\tunsigned int thisvar = (";
+        str += totalBatch;
+        str += " > batch*";
+        str += SztToStr(2 * numTrans);
+        str += ") ? ";
         str += totalBatch;
         str += " - batch*";
         str += SztToStr(2 * numTrans);
-        str += ";\n";
+        str += " : 0;\n";
         str += "\tunsigned int rw = (me < ((thisvar+1)/2)*";
         str += SztToStr(workGroupSizePerTrans);
         str += ") ? (thisvar - 2*(me/";
@@ -3909,12 +4217,12 @@ class Kernel {
         str += ")) : 0;\n\n";
       } else {
         if ((numTrans > 1) && !blockCompute) {
-          str += "\tunsigned int rw = (me < (";
-          str += totalBatch;
-          str += " - batch*";
+          str += "\tunsigned int rw = ((batch*";
           str += SztToStr(numTrans);
-          str += ")*";
+          str += " + me/";
           str += SztToStr(workGroupSizePerTrans);
+          str += ") < ";
+          str += totalBatch;
           str += ") ? 1 : 0;\n\n";
         } else {
           str += "\tunsigned int rw = 1;\n\n";
@@ -4222,21 +4530,22 @@ class Kernel {
       } else {
         if (params.fft_placeness == HCFFT_INPLACE) {
           if (inInterleaved) {
-            inBuf = "lwb, ";
-            outBuf = "lwb";
+            // Callbacks index the buffer from its start
+            inBuf = loadCallback ? "gb, " : "lwb, ";
+            outBuf = storeCallback ? "gb" : "lwb";
           } else {
             inBuf = "lwbRe, lwbIm,";
             outBuf = "lwbRe, lwbIm";
           }
         } else {
           if (inInterleaved) {
-            inBuf = "lwbIn, ";
+            inBuf = loadCallback ? "gbIn, " : "lwbIn, ";
           } else {
             inBuf = "lwbInRe, lwbInIm, ";
           }
 
           if (outInterleaved) {
-            outBuf = "lwbOut";
+            outBuf = storeCallback ? "gbOut" : "lwbOut";
           } else {
             outBuf = "lwbOutRe, lwbOutIm";
           }
@@ -4274,7 +4583,10 @@ class Kernel {
         str += "(";
         str += rw;
         str += me;
-        str += "0, 0, ";
+        str += loadCallback ? inOffset : "0";
+        str += ", ";
+        str += storeCallback ? outOffset : "0";
+        str += ", ";
         str += inBuf;
         str += outBuf;
         str += IterRegs("&");
@@ -4289,6 +4601,14 @@ class Kernel {
           str += TwTableLargeName();
         }
 
+        if (loadCallback) {
+          str += ",loadData";
+        }
+
+        if (storeCallback) {
+          str += ",storeData";
+        }
+
         str += ",tidx);\n";
       } else {
         for (typename std::vector<Pass<PR> >::const_iterator p = passes.begin();
@@ -4357,7 +4677,7 @@ class Kernel {
           str += me;
 
           if (p == passes.begin()) {  // beginning pass
-            str += blockCompute ? ldsOff : "0";
+            str += blockCompute ? ldsOff : (loadCallback ? inOffset : "0");
             str += ", ";
             str += ldsOff;
             str += ", ";
@@ -4375,6 +4695,10 @@ class Kernel {
               str += TwTableLargeName();
             }
 
+            if (loadCallback) {
+              str += ",loadData";
+            }
+
             str += ",tidx);\n";
 
             if (!halfLds) {
@@ -4384,7 +4708,7 @@ class Kernel {
           } else if ((p + 1) == passes.end()) {  // ending pass
             str += ldsOff;
             str += ", ";
-            str += blockCompute ? ldsOff : "0";
+            str += blockCompute ? ldsOff : (storeCallback ? outOffset : "0");
             str += ", ";
             str += ldsArgs;
             str += ", ";
@@ -4401,6 +4725,10 @@ class Kernel {
               str += TwTableLargeName();
             }
 
+            if (storeCallback) {
+              str += ",storeData";
+            }
+
             str += ",tidx);\n";
 
             if (!halfLds) {
@@ -4532,7 +4860,7 @@ class Kernel {
         str += "\t}\n\n";
       }
 
-      str += " }).wait();\n";
+      str += " });\n";
       str += "}}\n\n";
 
       if (r2c2r) {
@@ -4541,10 +4869,750 @@ class Kernel {
     }
   }
 };
+
+// Radices of the passes along one axis of an LDS 2D kernel, or false when the
+// length has a prime factor that no butterfly handles
+inline bool Lds2DRadices(size_t length, std::vector<size_t> &radices) {
+  const size_t primes[] = {3, 5, 7, 11, 13};
+  radices.clear();
+
+  while ((length > 1) && (length % 4 == 0)) {
+    radices.push_back(4);
+    length /= 4;
+  }
+
+  if (length % 2 == 0) {
+    radices.push_back(2);
+    length /= 2;
+  }
+
+  for (size_t i = 0; i < sizeof(primes) / sizeof(primes[0]); i++) {
+    while (length % primes[i] == 0) {
+      radices.push_back(primes[i]);
+      length /= primes[i];
+    }
+  }
+
+  return length == 1;
+}
+
+// Twiddle tables of the row and the column passes of an LDS 2D kernel
+template <StockhamGenerator::Precision PR>
+void Lds2DTwiddles(const FFTKernelGenKeyParams &params, void **twiddles,
+                   void **twiddleslarge, hc::accelerator acc) {
+  for (size_t axis = 0; axis < 2; axis++) {
+    void **table = axis ? twiddleslarge : twiddles;
+    std::vector<size_t> radices;
+
+    if (*table != NULL) {
+      continue;
+    }
+
+    Lds2DRadices(params.fft_N[axis], radices);
+
+    if (PR == StockhamGenerator::P_SINGLE) {
+      TwiddleTable<hc::short_vector::float_2> twTable(params.fft_N[axis]);
+      twTable.GenerateTwiddleTable(table, acc, radices);
+    } else {
+      TwiddleTable<hc::short_vector::double_2> twTable(params.fft_N[axis]);
+      twTable.GenerateTwiddleTable(table, acc, radices);
+    }
+  }
+}
+
+// 2D FFT kernel for images that fit in LDS
+//
+//   A work-group loads fft_R whole images into LDS, runs the passes of the
+//   rows and then those of the columns in place in LDS, and stores the images
+//   back scaled, so that the data is read and written once. A pass of radix R
+//   over lines of length N, after passes of total length Ls, has the
+//   butterfly j read x[j + r*N/R], twiddle it by W(Ls*R)^(r*(j%Ls)) and write
+//   its output m to (j/Ls)*Ls*R + j%Ls + m*Ls. The butterflies of a work-item
+//   are all read before a barrier and written after it.
+//
+//   Real transforms pack two real images into the real and the imaginary
+//   parts of each complex image in LDS, so that fft_R real images take the
+//   LDS, passes and launch of fft_R / 2 complex ones. The spectra of the two
+//   are split apart on the store, Xa(k) = (Z(k) + conj(Z(-k))) / 2 and
+//   Xb(k) = (Z(k) - conj(Z(-k))) / 2i, over the N0 / 2 + 1 hermitian columns.
+//   Backwards, the hermitian inputs are expanded to whole rows and combined
+//   on the load into Z = Xa + i Xb, whose real and imaginary parts are the
+//   two real outputs.
+template <StockhamGenerator::Precision PR>
+class Lds2DKernel {
+  const FFTKernelGenKeyParams params;  // key params
+  bool r2c;                            // Real to hermitian transform
+  bool c2r;                            // Hermitian to real transform
+  size_t numTrans;                     // Number of complex images in LDS
+  size_t workGroupSize;                // Work group size
+
+  // Index in a buffer of strides pStride of element (row, col) of image b
+  static std::string Offset(const size_t *pStride, const std::string &b,
+                            const std::string &row, const std::string &col) {
+    std::string str = b;
+    str += "*";
+    str += SztToStr(pStride[2]);
+    str += " + (";
+    str += row;
+    str += ")*";
+    str += SztToStr(pStride[1]);
+    str += " + (";
+    str += col;
+    str += ")*";
+    str += SztToStr(pStride[0]);
+    return str;
+  }
+
+  // Add the term t of a butterfly output, times the coefficient c
+  static void AddTerm(std::string &expr, const std::string &t, double c) {
+    if (c == 0.0) {
+      return;
+    }
+
+    std::string term = t;
+
+    if (fabs(c) != 1.0) {
+      term += "*";
+      term += FloatToStr(fabs(c));
+      term += FloatSuffix<PR>();
+    }
+
+    if (expr.empty()) {
+      expr = (c < 0.0) ? "-" + term : term;
+    } else {
+      expr += (c < 0.0) ? " - " : " + ";
+      expr += term;
+    }
+  }
+
+  void GeneratePass(std::string &str, size_t axis, size_t radix, size_t ls,
+                    bool fwd) {
+    std::string r2Type = RegBaseType<PR>(2);
+    const size_t image = params.fft_N[0] * params.fft_N[1];
+    const size_t length = params.fft_N[axis];
+    const size_t lines = params.fft_N[1 - axis];
+    const size_t stride = axis ? params.fft_N[0] : 1;
+    const size_t lineStride = axis ? 1 : params.fft_N[0];
+    const size_t span = length / radix;
+    const size_t butterflies = numTrans * lines * span;
+    const size_t perWorkItem =
+        DivRoundingUp<size_t>(butterflies, workGroupSize);
+    const bool guard = (butterflies % workGroupSize) != 0;
+    const double TWO_PI = 6.283185307179586476925286766559;
+    std::string tw = axis ? "twCol" : "twRow";
+    std::string offset;
+    offset += "(u/";
+    offset += SztToStr(span * lines);
+    offset += ")*";
+    offset += SztToStr(image);
+    offset += " + ((u/";
+    offset += SztToStr(span);
+    offset += ")%";
+    offset += SztToStr(lines);
+    offset += ")*";
+    offset += SztToStr(lineStride);
+    str += "\n\t// Radix ";
+    str += SztToStr(radix);
+    str += axis ? " pass of the columns" : " pass of the rows";
+    str += "\n\t{\n\t";
+    str += r2Type;
+    str += " v[";
+    str += SztToStr(perWorkItem * radix);
+    str += "];\n";
+
+    for (size_t k = 0; k < perWorkItem; k++) {
+      str += "\t{\n\tunsigned int u = me + ";
+      str += SztToStr(k * workGroupSize);
+      str += ";\n\t";
+
+      if (guard) {
+        str += "if (u < ";
+        str += SztToStr(butterflies);
+        str += ") ";
+      }
+
+      str += "{\n\t\tunsigned int o = ";
+      str += offset;
+      str += " + (u%";
+      str += SztToStr(span);
+      str += ")*";
+      str += SztToStr(stride);
+      str += ";\n";
+
+      for (size_t r = 0; r < radix; r++) {
+        str += "\t\tv[";
+        str += SztToStr(k * radix + r);
+        str += "] = lds[o + ";
+        str += SztToStr(r * span * stride);
+        str += "];\n";
+      }
+
+      str += "\t}\n\t}\n";
+    }
+
+    str += "\n\ttidx.barrier.wait_with_tile_static_memory_fence();\n";
+
+    for (size_t k = 0; k < perWorkItem; k++) {
+      str += "\t{\n\tunsigned int u = me + ";
+      str += SztToStr(k * workGroupSize);
+      str += ";\n\t";
+
+      if (guard) {
+        str += "if (u < ";
+        str += SztToStr(butterflies);
+        str += ") ";
+      }
+
+      str += "{\n\t\tunsigned int j = u%";
+      str += SztToStr(span);
+      str += ";\n\t\tunsigned int kk = j%";
+      str += SztToStr(ls);
+      str += ";\n\t\tunsigned int o = ";
+      str += offset;
+      str += " + ((j/";
+      str += SztToStr(ls);
+      str += ")*";
+      str += SztToStr(ls * radix);
+      str += " + kk)*";
+      str += SztToStr(stride);
+      str += ";\n";
+
+      // Twiddles of the earlier passes, conjugated backwards
+      for (size_t r = 1; (ls > 1) && (r < radix); r++) {
+        std::string reg = "v[" + SztToStr(k * radix + r) + "]";
+        str += "\t\t{\n\t\t";
+        str += r2Type;
+        str += " w = ";
+        str += tw;
+        str += "[";
+        str += SztToStr(ls - 1 + r - 1);
+        str += " + kk*";
+        str += SztToStr(radix - 1);
+        str += "];\n\t\t";
+        str += reg;
+        str += " = ";
+        str += r2Type;
+        str += "(";
+        str += reg + ".x*w.x" + (fwd ? " - " : " + ") + reg + ".y*w.y, ";
+        str += reg + ".y*w.x" + (fwd ? " + " : " - ") + reg + ".x*w.y";
+        str += ");\n\t\t}\n";
+      }
+
+      // Butterfly, with the exact roots of unity on the axes
+      for (size_t m = 0; m < radix; m++) {
+        std::string re, im;
+
+        for (size_t r = 0; r < radix; r++) {
+          std::string reg = "v[" + SztToStr(k * radix + r) + "]";
+          size_t q = (r * m) % radix;
+          double c, s;
+
+          if ((4 * q) % radix == 0) {
+            const double axisCos[] = {1.0, 0.0, -1.0, 0.0};
+            const double axisSin[] = {0.0, 1.0, 0.0, -1.0};
+            c = axisCos[4 * q / radix];
+            s = axisSin[4 * q / radix];
+          } else {
+            c = cos(TWO_PI * q / radix);
+            s = sin(TWO_PI * q / radix);
+          }
+
+          s = fwd ? -s : s;
+          AddTerm(re, reg + ".x", c);
+          AddTerm(re, reg + ".y", -s);
+          AddTerm(im, reg + ".x", s);
+          AddTerm(im, reg + ".y", c);
+        }
+
+        str += "\t\tlds[o + ";
+        str += SztToStr(m * ls * stride);
+        str += "] = ";
+        str += r2Type;
+        str += "(";
+        str += re;
+        str += ", ";
+        str += im;
+        str += ");\n";
+      }
+
+      str += "\t}\n\t}\n";
+    }
+
+    str += "\n\ttidx.barrier.wait_with_tile_static_memory_fence();\n\t}\n";
+  }
+
+  // Copy the images of the work-group between global memory and LDS
+  void GenerateCopy(std::string &str, bool load, double scale) {
+    const size_t image = params.fft_N[0] * params.fft_N[1];
+    const size_t total = numTrans * image;
+    const size_t *pStride = load ? params.fft_inStride : params.fft_outStride;
+    std::string global = load ? "gbIn[" : "gbOut[";
+    global += "b*";
+    global += SztToStr(pStride[2]);
+    global += " + ((e/";
+    global += SztToStr(params.fft_N[0]);
+    global += ")%";
+    global += SztToStr(params.fft_N[1]);
+    global += ")*";
+    global += SztToStr(pStride[1]);
+    global += " + (e%";
+    global += SztToStr(params.fft_N[0]);
+    global += ")*";
+    global += SztToStr(pStride[0]);
+    global += "]";
+    str += "\n\tfor (unsigned int i = 0; i < ";
+    str += SztToStr(DivRoundingUp<size_t>(total, workGroupSize));
+    str += "; i++) {\n\t\tunsigned int e = me + i*";
+    str += SztToStr(workGroupSize);
+    str += ";\n\t\tunsigned int b = batch*";
+    str += SztToStr(numTrans);
+    str += " + e/";
+    str += SztToStr(image);
+    str += ";\n\n\t\tif (";
+
+    if (total % workGroupSize) {
+      str += "(e < ";
+      str += SztToStr(total);
+      str += ") && ";
+    }
+
+    str += "(b < batchSize)) {\n\t\t\t";
+
+    if (load) {
+      str += "lds[e] = ";
+      str += global;
+      str += ";\n";
+    } else if (scale != 1.0) {
+      std::string s = FloatToStr(scale) + FloatSuffix<PR>();
+      str += global;
+      str += " = ";
+      str += RegBaseType<PR>(2);
+      str += "(lds[e].x*";
+      str += s;
+      str += ", lds[e].y*";
+      str += s;
+      str += ");\n";
+    } else {
+      str += global;
+      str += " = lds[e];\n";
+    }
+
+    str += "\t\t}\n\t}\n";
+
+    if (load) {
+      str += "\n\ttidx.barrier.wait_with_tile_static_memory_fence();\n";
+    }
+  }
+
+  // Load the real images, or the hermitian ones, of the work-group into LDS
+  // in pairs, the second of a pair past the batch being zero
+  void GeneratePackedLoad(std::string &str) {
+    std::string r2Type = RegBaseType<PR>(2);
+    const size_t n0 = params.fft_N[0];
+    const size_t n1 = params.fft_N[1];
+    const size_t image = n0 * n1;
+    const size_t total = numTrans * image;
+    const size_t *pStride = params.fft_inStride;
+    str += "\n\tfor (unsigned int i = 0; i < ";
+    str += SztToStr(DivRoundingUp<size_t>(total, workGroupSize));
+    str += "; i++) {\n\t\tunsigned int e = me + i*";
+    str += SztToStr(workGroupSize);
+    str += ";\n\t\tunsigned int row = (e/";
+    str += SztToStr(n0);
+    str += ")%";
+    str += SztToStr(n1);
+    str += ";\n\t\tunsigned int col = e%";
+    str += SztToStr(n0);
+    str += ";\n\t\tunsigned int b = batch*";
+    str += SztToStr(params.fft_R);
+    str += " + 2*(e/";
+    str += SztToStr(image);
+    str += ");\n\n\t\tif (";
+
+    if (total % workGroupSize) {
+      str += "(e < ";
+      str += SztToStr(total);
+      str += ") && ";
+    }
+
+    str += "(b < batchSize)) {\n";
+
+    if (r2c) {
+      str += "\t\t\t";
+      str += RegBaseType<PR>(1);
+      str += " im = (b + 1 < batchSize) ? gbIn[";
+      str += Offset(pStride, "(b + 1)", "row", "col");
+      str += "] : 0;\n\t\t\tlds[e] = ";
+      str += r2Type;
+      str += "(gbIn[";
+      str += Offset(pStride, "b", "row", "col");
+      str += "], im);\n";
+    } else {
+      // Columns past the half are the conjugates of the mirrored ones
+      str += "\t\t\tbool mirror = col > ";
+      str += SztToStr(n0 / 2);
+      str += ";\n\t\t\tunsigned int hr = mirror ? (";
+      str += SztToStr(n1);
+      str += " - row)%";
+      str += SztToStr(n1);
+      str += " : row;\n\t\t\tunsigned int hc = mirror ? ";
+      str += SztToStr(n0);
+      str += " - col : col;\n\t\t\t";
+      str += r2Type;
+      str += " x = gbIn[";
+      str += Offset(pStride, "b", "hr", "hc");
+      str += "];\n\t\t\t";
+      str += r2Type;
+      str += " y = (b + 1 < batchSize) ? gbIn[";
+      str += Offset(pStride, "(b + 1)", "hr", "hc");
+      str += "] : ";
+      str += r2Type;
+      str += "(0, 0);\n\n\t\t\tif (mirror) {\n";
+      str += "\t\t\t\tx.y = -x.y;\n\t\t\t\ty.y = -y.y;\n\t\t\t}\n\n";
+      str += "\t\t\tlds[e] = ";
+      str += r2Type;
+      str += "(x.x - y.y, x.y + y.x);\n";
+    }
+
+    str += "\t\t}\n\t}\n";
+    str += "\n\ttidx.barrier.wait_with_tile_static_memory_fence();\n";
+  }
+
+  // Store the pairs of images of the work-group from LDS, split into the
+  // hermitian halves of their spectra or into their real parts
+  void GeneratePackedStore(std::string &str, double scale) {
+    std::string r2Type = RegBaseType<PR>(2);
+    const size_t n0 = params.fft_N[0];
+    const size_t n1 = params.fft_N[1];
+    const size_t image = n0 * n1;
+    const size_t width = r2c ? n0 / 2 + 1 : n0;
+    const size_t total = numTrans * width * n1;
+    const size_t *pStride = params.fft_outStride;
+    std::string s;
+
+    // The halves of the split are folded into the scale
+    if (r2c || scale != 1.0) {
+      s = "*";
+      s += FloatToStr(r2c ? scale / 2 : scale);
+      s += FloatSuffix<PR>();
+    }
+
+    str += "\n\tfor (unsigned int i = 0; i < ";
+    str += SztToStr(DivRoundingUp<size_t>(total, workGroupSize));
+    str += "; i++) {\n\t\tunsigned int e = me + i*";
+    str += SztToStr(workGroupSize);
+    str += ";\n\t\tunsigned int c = e/";
+    str += SztToStr(width * n1);
+    str += ";\n\t\tunsigned int row = (e/";
+    str += SztToStr(width);
+    str += ")%";
+    str += SztToStr(n1);
+    str += ";\n\t\tunsigned int col = e%";
+    str += SztToStr(width);
+    str += ";\n\t\tunsigned int b = batch*";
+    str += SztToStr(params.fft_R);
+    str += " + 2*c;\n\n\t\tif (";
+
+    if (total % workGroupSize) {
+      str += "(e < ";
+      str += SztToStr(total);
+      str += ") && ";
+    }
+
+    str += "(b < batchSize)) {\n\t\t\t";
+    str += r2Type;
+    str += " z = lds[c*";
+    str += SztToStr(image);
+    str += " + row*";
+    str += SztToStr(n0);
+    str += " + col];\n";
+
+    if (r2c) {
+      str += "\t\t\t";
+      str += r2Type;
+      str += " w = lds[c*";
+      str += SztToStr(image);
+      str += " + ((";
+      str += SztToStr(n1);
+      str += " - row)%";
+      str += SztToStr(n1);
+      str += ")*";
+      str += SztToStr(n0);
+      str += " + (";
+      str += SztToStr(n0);
+      str += " - col)%";
+      str += SztToStr(n0);
+      str += "];\n\t\t\tgbOut[";
+      str += Offset(pStride, "b", "row", "col");
+      str += "] = ";
+      str += r2Type;
+      str += "((z.x + w.x)" + s + ", (z.y - w.y)" + s + ");\n\n";
+      str += "\t\t\tif (b + 1 < batchSize) {\n\t\t\t\tgbOut[";
+      str += Offset(pStride, "(b + 1)", "row", "col");
+      str += "] = ";
+      str += r2Type;
+      str += "((z.y + w.y)" + s + ", (w.x - z.x)" + s + ");\n\t\t\t}\n";
+    } else {
+      str += "\t\t\tgbOut[";
+      str += Offset(pStride, "b", "row", "col");
+      str += "] = z.x" + s + ";\n\n";
+      str += "\t\t\tif (b + 1 < batchSize) {\n\t\t\t\tgbOut[";
+      str += Offset(pStride, "(b + 1)", "row", "col");
+      str += "] = z.y" + s + ";\n\t\t\t}\n";
+    }
+
+    str += "\t\t}\n\t}\n";
+  }
+
+ public:
+  explicit Lds2DKernel(const FFTKernelGenKeyParams &paramsVal)
+      : params(paramsVal),
+        r2c(paramsVal.fft_inputLayout == HCFFT_REAL),
+        c2r(paramsVal.fft_outputLayout == HCFFT_REAL),
+        numTrans((r2c || c2r) ? paramsVal.fft_R / 2 : paramsVal.fft_R),
+        workGroupSize(paramsVal.fft_SIMD) {
+    assert(params.fft_DataDim == 3);
+
+    if (r2c) {
+      assert(params.fft_outputLayout == HCFFT_HERMITIAN_INTERLEAVED);
+      assert(params.fft_R % 2 == 0);
+    } else if (c2r) {
+      assert(params.fft_inputLayout == HCFFT_HERMITIAN_INTERLEAVED);
+      assert(params.fft_R % 2 == 0);
+    } else {
+      assert(params.fft_inputLayout == HCFFT_COMPLEX_INTERLEAVED);
+      assert(params.fft_outputLayout == HCFFT_COMPLEX_INTERLEAVED);
+    }
+  }
+
+  void GenerateKernel(void **twiddles, void **twiddleslarge,
+                      hc::accelerator acc, std::string &str,
+                      std::vector<size_t> lWorkSize, size_t count) {
+    std::string r2Type = RegBaseType<PR>(2);
+    std::string inType = r2c ? RegBaseType<PR>(1) : r2Type;
+    std::string outType = c2r ? RegBaseType<PR>(1) : r2Type;
+    std::vector<size_t> radices[2];
+    Lds2DRadices(params.fft_N[0], radices[0]);
+    Lds2DRadices(params.fft_N[1], radices[1]);
+    Lds2DTwiddles<PR>(params, twiddles, twiddleslarge, acc);
+
+    // Real transforms only run in the direction of their layouts
+    for (size_t d = 0; d < ((r2c || c2r) ? 1 : 2); d++) {
+      bool fwd = (r2c || c2r) ? r2c : (d ? false : true);
+      size_t arg = 0;
+      str += "extern \"C\" {";
+      str += "\nvoid ";
+      str += fwd ? "fft_fwd" : "fft_back";
+      str += SztToStr(count);
+      str +=
+          "( const hcfftKernelArgs *args, uint batchSize, accelerator_view "
+          "&acc_view, accelerator &acc )\n\t{\n\t";
+      str += inType;
+      str += " *gbIn = static_cast<";
+      str += inType;
+      str += " *> (args->buffers[";
+      str += SztToStr(arg++);
+      str += "]);\n\t";
+
+      // In place, the output is the input buffer, of its own element type
+      str += outType;
+      str += " *gbOut = static_cast<";
+      str += outType;
+      str += " *> (args->buffers[";
+      str += (params.fft_placeness == HCFFT_INPLACE) ? "0" : SztToStr(arg++);
+      str += "]);\n\t";
+
+      str += r2Type;
+      str += " *twRow = static_cast<";
+      str += r2Type;
+      str += " *> (args->buffers[";
+      str += SztToStr(arg++);
+      str += "]);\n\t";
+      str += r2Type;
+      str += " *twCol = static_cast<";
+      str += r2Type;
+      str += " *> (args->buffers[";
+      str += SztToStr(arg++);
+      str += "]);\n";
+      str += GridExtent(params);
+      str += "\thc::tiled_extent<2> t_ext = grdExt.tile(";
+      str += SztToStr(lWorkSize[0]);
+      str += ",1);\n";
+      str +=
+          "\thc::parallel_for_each(acc_view, t_ext, [=] (hc::tiled_index<2> "
+          "tidx) [[hc]]\n\t { ";
+      str += "\t";
+      str += "unsigned int me = tidx.local[0];\n\t";
+      str += "unsigned int batch = tidx.tile[0];";
+      str += "\n\n\t";
+      str += "tile_static ";
+      str += r2Type;
+      str += " lds[";
+      str += SztToStr(numTrans * params.fft_N[0] * params.fft_N[1]);
+      str += "];\n";
+
+      if (r2c || c2r) {
+        GeneratePackedLoad(str);
+      } else {
+        GenerateCopy(str, true, 1.0);
+      }
+
+      for (size_t axis = 0; axis < 2; axis++) {
+        size_t ls = 1;
+
+        for (size_t p = 0; p < radices[axis].size(); p++) {
+          GeneratePass(str, axis, radices[axis][p], ls, fwd);
+          ls *= radices[axis][p];
+        }
+      }
+
+      if (r2c || c2r) {
+        GeneratePackedStore(str,
+                            fwd ? params.fft_fwdScale : params.fft_backScale);
+      } else {
+        GenerateCopy(str, false,
+                     fwd ? params.fft_fwdScale : params.fft_backScale);
+      }
+
+      str += " });\n";
+      str += "}}\n\n";
+    }
+  }
+};
 }  // namespace StockhamGenerator
 
 // using namespace StockhamGenerator;
 
+//  Work-group size and images per work-group of the single kernel of a small
+//  2D plan, or false when the plan does not qualify for one. Its images must
+//  be complex interleaved, or real with interleaved hermitian spectra,
+//  without callbacks, with lengths that factor into the radices of
+//  Lds2DRadices, and fit in LDS with at most 16 complex numbers per
+//  work-item. Real images go in pairs, two to a complex image of LDS.
+bool FFTPlan::Lds2DSizes(size_t *wgs, size_t *numTrans) const {
+  std::vector<size_t> radices;
+
+  if ((this->dimension != HCFFT_2D) || (this->length.size() != 2) ||
+      (this->gen != Stockham) || (this->large1D != 0) || this->realSpecial ||
+      this->RCsimple || this->blockCompute ||
+      (this->transposeType != HCFFT_NOTRANSPOSE)) {
+    return false;
+  }
+
+  bool c2c = (this->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+             (this->opLayout == HCFFT_COMPLEX_INTERLEAVED);
+  bool r2c = (this->ipLayout == HCFFT_REAL) &&
+             (this->opLayout == HCFFT_HERMITIAN_INTERLEAVED);
+  bool c2r = (this->ipLayout == HCFFT_HERMITIAN_INTERLEAVED) &&
+             (this->opLayout == HCFFT_REAL);
+
+  if (!(c2c || r2c || c2r) || !this->loadCallback.empty() ||
+      !this->storeCallback.empty()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    if ((this->length[i] < 2) ||
+        !StockhamGenerator::Lds2DRadices(this->length[i], radices)) {
+      return false;
+    }
+  }
+
+  const size_t perWorkItem = 16;
+  size_t image = this->length[0] * this->length[1];
+  size_t maxWGS = std::min<size_t>(this->envelope.limit_WorkGroupSize, 256);
+  size_t fit = std::min<size_t>(
+      this->envelope.limit_LocalMemSize / (image * this->ElementSize()),
+      maxWGS * perWorkItem / image);
+
+  if (fit == 0) {
+    return false;
+  }
+
+  //  A few complex numbers per work-item, in whole wavefronts
+  size_t pack = c2c ? 1 : 2;
+  size_t trans = std::min<size_t>(
+      fit, DivRoundingUp<size_t>(std::max<size_t>(1, this->batchSize), pack));
+  size_t items = DivRoundingUp<size_t>(trans * image, 4);
+  items = DivRoundingUp<size_t>(items, 64) * 64;
+
+  if (wgs) {
+    *wgs = std::min(items, maxWGS);
+  }
+
+  if (numTrans) {
+    *numTrans = trans * pack;
+  }
+
+  return true;
+}
+
+//  Variants of the kernel of a leaf the autotuner times: every number of
+//  complex values per work-item that divides the length, holds each of its
+//  prime factors, so that DetermineRadices finds a radix for every pass, and
+//  fits the registers of GetMax1DLength. Each is taken with the powers of 2
+//  of transforms per work-group that make work-groups of at least a
+//  wavefront, and with the real and imaginary parts staged through LDS in
+//  turn or, when they fit, together. Kernels on real data, callbacks, blocks
+//  of columns and LDS 2D images keep the sizes of DetermineSizes.
+void FFTPlan::GetTuningCandidates(
+    std::vector<hcfftKernelTuning> &candidates) const {
+  candidates.clear();
+
+  if ((this->gen != Stockham) || this->lds2D || this->blockCompute ||
+      this->realSpecial || this->RCsimple || (this->length[0] < 2) ||
+      (this->ipLayout != HCFFT_COMPLEX_INTERLEAVED) ||
+      (this->opLayout != HCFFT_COMPLEX_INTERLEAVED) ||
+      !this->loadCallback.empty() || !this->storeCallback.empty()) {
+    return;
+  }
+
+  size_t length = this->length[0];
+  size_t maxWGS = this->envelope.limit_WorkGroupSize;
+  size_t maxLDS = static_cast<size_t>(this->envelope.limit_LocalMemSize);
+  size_t perWorkItem = (this->precision == HCFFT_SINGLE) ? 32 : 16;
+  size_t radical = 1;
+
+  for (size_t l = length, p = 2; l > 1; p++) {
+    if (l % p == 0) {
+      radical *= p;
+    }
+
+    while (l % p == 0) {
+      l /= p;
+    }
+  }
+
+  for (size_t cnPerWI = radical; cnPerWI <= std::min(length, perWorkItem);
+       cnPerWI += radical) {
+    size_t itemsPerTrans = length / cnPerWI;
+
+    if ((length % cnPerWI) || (itemsPerTrans > maxWGS)) {
+      continue;
+    }
+
+    for (size_t nt = 1; nt * itemsPerTrans <= maxWGS; nt *= 2) {
+      if ((nt * itemsPerTrans < 64) && (2 * nt * itemsPerTrans <= maxWGS)) {
+        continue;
+      }
+
+      for (size_t ldsComplex = 0; ldsComplex < 2; ldsComplex++) {
+        size_t ldsBytes = nt * length * this->ElementSize();
+
+        if ((ldsComplex ? ldsBytes : ldsBytes / 2) > maxLDS) {
+          continue;
+        }
+
+        hcfftKernelTuning tuning;
+        tuning.workGroupSize = nt * itemsPerTrans;
+        tuning.numTrans = nt;
+        tuning.ldsComplex = (ldsComplex != 0);
+        candidates.push_back(tuning);
+      }
+    }
+  }
+}
+
 template <>
 hcfftStatus FFTPlan::GetMax1DLengthPvt<Stockham>(size_t *longest) const {
   // TODO(Neelakandan)  The caller has already acquired the lock on *this
@@ -4559,6 +5627,10 @@ hcfftStatus FFTPlan::GetMax1DLengthPvt<Stockham>(size_t *longest) const {
   ARG_CHECK(NULL != longest)
   size_t LdsperElement = this->ElementSize();
   size_t result = pEnvelope->limit_LocalMemSize / (1 * LdsperElement);
+  //  A work-item holds at most the largest butterfly the pass planner picks
+  //  in registers, see DetermineRadices
+  size_t perWorkItem = (this->precision == HCFFT_SINGLE) ? 32 : 16;
+  result = std::min(result, pEnvelope->limit_WorkGroupSize * perWorkItem);
   result = FloorPo2(result);
   *longest = result;
   return HCFFT_SUCCEEDS;
@@ -4579,6 +5651,7 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Stockham>(
   params.fft_placeness = this->location;
   params.fft_inputLayout = this->ipLayout;
   params.fft_MaxWorkGroupSize = this->envelope.limit_WorkGroupSize;
+  params.fft_LDSsize = this->envelope.limit_LocalMemSize;
   ARG_CHECK(this->inStride.size() == this->outStride.size())
   bool real_transform =
       ((this->ipLayout == HCFFT_REAL) || (this->opLayout == HCFFT_REAL));
@@ -4615,6 +5688,8 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Stockham>(
   params.blockCompute = this->blockCompute;
   params.blockComputeType = this->blockComputeType;
   params.fft_twiddleFront = this->twiddleFront;
+  params.fft_singleTwiddles =
+      this->singleTwiddles && (this->precision == HCFFT_DOUBLE);
   size_t wgs, nt;
   size_t t_wgs, t_nt;
   StockhamGenerator::Precision pr = (params.fft_precision == HCFFT_SINGLE) ? StockhamGenerator::P_SINGLE : StockhamGenerator::P_DOUBLE;
@@ -4645,8 +5720,11 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Stockham>(
     } break;
   }
 
-  if ((t_wgs != 0) && (t_nt != 0) &&
-      (this->envelope.limit_WorkGroupSize >= 256)) {
+  if ((this->tuneWorkGroupSize != 0) && (this->tuneNumTrans != 0)) {
+    wgs = this->tuneWorkGroupSize;
+    nt = this->tuneNumTrans;
+  } else if ((t_wgs != 0) && (t_nt != 0) &&
+             (this->envelope.limit_WorkGroupSize >= 256)) {
     wgs = t_wgs;
     nt = t_nt;
   } else {
@@ -4654,15 +5732,24 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Stockham>(
                    pr);
   }
 
+  params.fft_LdsComplex = this->bLdsComplex;
+  params.fft_ldsPadding = this->ldsPadding;
+
   assert((nt * params.fft_N[0]) >= wgs);
   assert((nt * params.fft_N[0]) % wgs == 0);
   params.fft_R = (nt * params.fft_N[0]) / wgs;
   params.fft_SIMD = wgs;
 
+  if (this->lds2D) {
+    params.fft_lds2D = this->Lds2DSizes(&params.fft_SIMD, &params.fft_R);
+    params.fft_singleTwiddles = false;
+  }
+
   if (this->large1D != 0) {
     ARG_CHECK(params.fft_N[0] != 0)
     ARG_CHECK((this->large1D % params.fft_N[0]) == 0)
     params.fft_3StepTwiddle = true;
+    params.fft_computeTwiddles = this->computeTwiddles;
 
     if (!(this->realSpecial)) {
       ARG_CHECK(this->large1D == (params.fft_N[1] * params.fft_N[0]));
@@ -4671,6 +5758,23 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Stockham>(
 
   params.fft_fwdScale = this->forwardScale;
   params.fft_backScale = this->backwardScale;
+
+  if (!this->loadCallback.empty()) {
+    params.fft_loadCallback = this->loadCallback.funcName.c_str();
+  }
+
+  if (!this->storeCallback.empty()) {
+    params.fft_storeCallback = this->storeCallback.funcName.c_str();
+  }
+
+  //  Blocked and LDS 2D kernels compute their offsets apart, and the 5-step
+  //  real kernel steps its output by the dense row length, so these keep
+  //  their strides compiled in. HCFFT_STATIC_SHAPES=1 compiles in the
+  //  strides of every kernel.
+  static const bool staticShapes = (getenv("HCFFT_STATIC_SHAPES") != NULL) &&
+                                   (atoi(getenv("HCFFT_STATIC_SHAPES")) > 0);
+  params.fft_runtimeShape = !staticShapes && !params.fft_lds2D &&
+                            !params.blockCompute && !params.fft_realSpecial;
   return HCFFT_SUCCEEDS;
 }
 
@@ -4678,6 +5782,7 @@ template <>
 hcfftStatus FFTPlan::GetWorkSizesPvt<Stockham>(
     std::vector<size_t> &globalWS, std::vector<size_t> &localWS) const {
   //    How many complex numbers in the input mutl-dimensional array?
+  //    The kernels compute the same grid at launch, see GridExtent.
   //
   unsigned long long count = 1;
 
@@ -4691,6 +5796,13 @@ hcfftStatus FFTPlan::GetWorkSizesPvt<Stockham>(
   //    hcPrograms
   this->GetKernelGenKeyPvt<Stockham>(fftParams);
 
+  if (fftParams.fft_lds2D) {
+    count = DivRoundingUp<unsigned long long>(this->batchSize, fftParams.fft_R);
+    globalWS.push_back(static_cast<size_t>(count * fftParams.fft_SIMD));
+    localWS.push_back(fftParams.fft_SIMD);
+    return HCFFT_SUCCEEDS;
+  }
+
   if (fftParams.blockCompute) {
     count =
         DivRoundingUp<unsigned long long>(count, fftParams.blockLDS);
@@ -4734,33 +5846,64 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Stockham>(const hcfftPlanHandle plHandle,
     this->GetWorkSizesPvt<Stockham>(gWorkSize, lWorkSize);
     std::string programCode;
     programCode = hcHeader();
+
+    // User callbacks come first so that the passes can call them
+    if (!this->loadCallback.empty()) {
+      programCode += this->loadCallback.funcString;
+      programCode += "\n";
+    }
+
+    if (!this->storeCallback.empty()) {
+      programCode += this->storeCallback.funcString;
+      programCode += "\n";
+    }
+
     StockhamGenerator::Precision pr = (params.fft_precision == HCFFT_SINGLE) ? StockhamGenerator::P_SINGLE : StockhamGenerator::P_DOUBLE;
 
-    switch (pr) {
-      case StockhamGenerator::P_SINGLE: {
-        StockhamGenerator::Kernel<StockhamGenerator::P_SINGLE> kernel(params);
+    if (params.fft_lds2D) {
+      if (pr == StockhamGenerator::P_SINGLE) {
+        StockhamGenerator::Lds2DKernel<StockhamGenerator::P_SINGLE> kernel(
+            params);
         kernel.GenerateKernel((void **)&twiddles, (void **)&twiddleslarge, acc,
-                              plHandle, programCode, gWorkSize, lWorkSize,
-                              count);
-      } break;
-
-      case StockhamGenerator::P_DOUBLE: {
-        StockhamGenerator::Kernel<StockhamGenerator::P_DOUBLE> kernel(params);
+                              programCode, lWorkSize, count);
+      } else {
+        StockhamGenerator::Lds2DKernel<StockhamGenerator::P_DOUBLE> kernel(
+            params);
         kernel.GenerateKernel((void **)&twiddles, (void **)&twiddleslarge, acc,
-                              plHandle, programCode, gWorkSize, lWorkSize,
-                              count);
-      } break;
+                              programCode, lWorkSize, count);
+      }
+    } else {
+      switch (pr) {
+        case StockhamGenerator::P_SINGLE: {
+          StockhamGenerator::Kernel<StockhamGenerator::P_SINGLE> kernel(params);
+          kernel.GenerateKernel((void **)&twiddles, (void **)&twiddleslarge,
+                                acc, plHandle, programCode, gWorkSize,
+                                lWorkSize, count);
+        } break;
+
+        case StockhamGenerator::P_DOUBLE: {
+          StockhamGenerator::Kernel<StockhamGenerator::P_DOUBLE> kernel(params);
+          kernel.GenerateKernel((void **)&twiddles, (void **)&twiddleslarge,
+                                acc, plHandle, programCode, gWorkSize,
+                                lWorkSize, count);
+        } break;
+      }
     }
 
-    fftRepo.setProgramCode(Stockham, plHandle, params, programCode);
-    fftRepo.setProgramEntryPoints(Stockham, plHandle, params, "fft_fwd",
+    fftRepo.setProgramCode(Stockham, count, params, programCode);
+    fftRepo.setProgramEntryPoints(Stockham, count, params, "fft_fwd",
                                   "fft_back");
+  } else if (params.fft_lds2D) {
+    if (params.fft_precision == HCFFT_SINGLE) {
+      StockhamGenerator::Lds2DTwiddles<StockhamGenerator::P_SINGLE>(
+          params, (void **)&twiddles, (void **)&twiddleslarge, acc);
+    } else {
+      StockhamGenerator::Lds2DTwiddles<StockhamGenerator::P_DOUBLE>(
+          params, (void **)&twiddles, (void **)&twiddleslarge, acc);
+    }
   } else {
     size_t large1D = 0;
     size_t length = params.fft_N[0];
-    size_t R = length;
-    const size_t *pRadices = NULL;
-    size_t nPasses;
 
     if (params.fft_realSpecial) {
       large1D = params.fft_N[0] * params.fft_realSpecial_Nr;
@@ -4768,52 +5911,17 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Stockham>(const hcfftPlanHandle plHandle,
       large1D = params.fft_N[0] * params.fft_N[1];
     }
 
+    // The radices of the kernel, which its twiddle table is laid out by
     std::vector<size_t> radices;
-    StockhamGenerator::KernelCoreSpecs<StockhamGenerator::P_SINGLE> kcs;
-    kcs.GetRadices(length, nPasses, pRadices);
-
-    if ((params.fft_MaxWorkGroupSize >= 256) && (pRadices != NULL)) {
-      for (size_t i = 0; i < nPasses; i++) {
-        size_t rad = pRadices[i];
-        R /= rad;
-        radices.push_back(rad);
-      }
+    size_t numTrans = (params.fft_SIMD * params.fft_R) / length;
+    size_t cnPerWI = (numTrans * length) / params.fft_SIMD;
 
-      assert(R == 1);  // this has to be true for correct radix composition of
-                       // the length
+    if (params.fft_precision == HCFFT_SINGLE) {
+      StockhamGenerator::DetermineRadices<StockhamGenerator::P_SINGLE>(
+          params.fft_MaxWorkGroupSize, length, cnPerWI, radices);
     } else {
-      size_t numTrans = (params.fft_SIMD * params.fft_R) / length;
-      size_t cnPerWI = (numTrans * length) / params.fft_SIMD;
-      // Possible radices
-      size_t cRad[] = {13, 11, 10, 8, 7, 6,
-                       5,  4,  3,  2, 1};  // Must be in descending order
-      size_t cRadSize = (sizeof(cRad) / sizeof(cRad[0]));
-
-      while (true) {
-        size_t rad;
-        assert(cRadSize >= 1);
-
-        for (size_t r = 0; r < cRadSize; r++) {
-          rad = cRad[r];
-
-          if ((rad > cnPerWI) || (cnPerWI % rad)) {
-            continue;
-          }
-
-          if (!(R % rad)) {
-            break;
-          }
-        }
-
-        assert((cnPerWI % rad) == 0);
-        R /= rad;
-        radices.push_back(rad);
-        assert(R >= 1);
-
-        if (R == 1) {
-          break;
-        }
-      }
+      StockhamGenerator::DetermineRadices<StockhamGenerator::P_DOUBLE>(
+          params.fft_MaxWorkGroupSize, length, cnPerWI, radices);
     }
 
     if (params.fft_precision == HCFFT_SINGLE) {
@@ -4825,12 +5933,15 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Stockham>(const hcfftPlanHandle plHandle,
 
       // twiddle factors for 1d-large 3-step algorithm
       if (params.fft_3StepTwiddle && !twiddleslarge) {
-        StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2, StockhamGenerator::P_SINGLE> twLarge(large1D);
+        StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2, StockhamGenerator::P_SINGLE> twLarge(large1D, params.fft_computeTwiddles);
         twLarge.TwiddleLargeAV((void **)&twiddleslarge, acc);
       }
     } else {
       // Twiddle table
-      if (length > 1) {
+      if (length > 1 && params.fft_singleTwiddles) {
+        StockhamGenerator::TwiddleTable<hc::short_vector::float_2> twTable(length);
+        twTable.GenerateTwiddleTable((void **)&twiddles, acc, radices);
+      } else if (length > 1) {
         StockhamGenerator::TwiddleTable<hc::short_vector::double_2> twTable(length);
         twTable.GenerateTwiddleTable((void **)&twiddles, acc, radices);
       }
@@ -4838,7 +5949,7 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Stockham>(const hcfftPlanHandle plHandle,
       // twiddle factors for 1d-large 3-step algorithm
       if (params.fft_3StepTwiddle && !twiddleslarge) {
         StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2, StockhamGenerator::P_DOUBLE> twLarge(
-            large1D);
+            large1D, params.fft_computeTwiddles);
         twLarge.TwiddleLargeAV((void **)&twiddleslarge, acc);
       }
     }
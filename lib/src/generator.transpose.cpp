@@ -221,7 +221,7 @@ hcfftStatus genTransposePrototype(
   // Declare and define the function
   StockhamGenerator::hcKernWrite(transKernel, 0) << "extern \"C\"\n { void" << std::endl;
   StockhamGenerator::hcKernWrite(transKernel, 0)
-      << funcName << "(  std::map<int, void*> vectArr, uint batchSize, "
+      << funcName << "(  const hcfftKernelArgs *args, uint batchSize, "
                      "accelerator_view &acc_view, accelerator &acc) \n {";
 
   switch (params.fft_inputLayout) {
@@ -230,17 +230,17 @@ hcfftStatus genTransposePrototype(
       dtOutput = dtComplex;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       break;
     case HCFFT_COMPLEX_PLANAR:
       dtInput = dtPlanar;
       dtOutput = dtPlanar;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA_R"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA_I"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       break;
     case HCFFT_HERMITIAN_INTERLEAVED:
     case HCFFT_HERMITIAN_PLANAR:
@@ -250,7 +250,7 @@ hcfftStatus genTransposePrototype(
       dtOutput = dtPlanar;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       break;
     default:
       return HCFFT_INVALID;
@@ -263,17 +263,17 @@ hcfftStatus genTransposePrototype(
         dtOutput = dtComplex;
         StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " * outputA"
                                     << " = static_cast< " << dtOutput
-                                    << "*> (vectArr[" << arg++ << "]);";
+                                    << "*> (args->buffers[" << arg++ << "]);";
         break;
       case HCFFT_COMPLEX_PLANAR:
         dtInput = dtPlanar;
         dtOutput = dtPlanar;
         StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " * outputA_R"
                                     << " = static_cast< " << dtOutput
-                                    << "*> (vectArr[" << arg++ << "]);";
+                                    << "*> (args->buffers[" << arg++ << "]);";
         StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " * outputA_I"
                                     << " = static_cast< " << dtOutput
-                                    << "*> (vectArr[" << arg++ << "]);";
+                                    << "*> (args->buffers[" << arg++ << "]);";
         break;
       case HCFFT_HERMITIAN_INTERLEAVED:
       case HCFFT_HERMITIAN_PLANAR:
@@ -283,7 +283,7 @@ hcfftStatus genTransposePrototype(
         dtOutput = dtPlanar;
         StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " * outputA"
                                     << " = static_cast< " << dtOutput
-                                    << "*> (vectArr[" << arg++ << "]);";
+                                    << "*> (args->buffers[" << arg++ << "]);";
         break;
       default:
         return HCFFT_INVALID;
@@ -293,7 +293,7 @@ hcfftStatus genTransposePrototype(
   if (twiddleTransposeKernel) {
     StockhamGenerator::hcKernWrite(transKernel, 0) << dtComplex << " *" << StockhamGenerator::TwTableLargeName()
                                 << " = static_cast< " << dtComplex
-                                << "*> (vectArr[" << arg++ << "]);";
+                                << "*> (args->buffers[" << arg++ << "]);";
   }
   return HCFFT_SUCCEEDS;
 }
@@ -308,7 +308,7 @@ hcfftStatus genTransposePrototypeLeadingDimensionBatched(
   // Declare and define the function
   StockhamGenerator::hcKernWrite(transKernel, 0) << "extern \"C\"\n { void" << std::endl;
   StockhamGenerator::hcKernWrite(transKernel, 0)
-      << funcName << "(  std::map<int, void*> vectArr, uint batchSize, "
+      << funcName << "(  const hcfftKernelArgs *args, uint batchSize, "
                      "accelerator_view &acc_view, accelerator &acc) \n {";
 
   switch (params.fft_inputLayout) {
@@ -317,17 +317,17 @@ hcfftStatus genTransposePrototypeLeadingDimensionBatched(
       dtOutput = dtComplex;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       break;
     case HCFFT_COMPLEX_PLANAR:
       dtInput = dtPlanar;
       dtOutput = dtPlanar;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA_R"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA_I"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       break;
     case HCFFT_HERMITIAN_INTERLEAVED:
     case HCFFT_HERMITIAN_PLANAR:
@@ -337,7 +337,7 @@ hcfftStatus genTransposePrototypeLeadingDimensionBatched(
       dtOutput = dtPlanar;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * inputA"
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       break;
     default:
       return HCFFT_INVALID;
@@ -346,7 +346,7 @@ hcfftStatus genTransposePrototypeLeadingDimensionBatched(
   if (genTwiddle) {
     StockhamGenerator::hcKernWrite(transKernel, 0) << dtComplex << " *" << StockhamGenerator::TwTableLargeName()
                                 << " = static_cast< " << dtComplex
-                                << "*> (vectArr[" << arg++ << "]);";
+                                << "*> (args->buffers[" << arg++ << "]);";
   }
 
   return HCFFT_SUCCEEDS;
@@ -840,7 +840,7 @@ hcfftStatus genSwapKernel(const FFTKernelGenKeyParams& params,
 
     StockhamGenerator::hcKernWrite(transKernel, 3) << "}" << std::endl;
 
-    StockhamGenerator::hcKernWrite(transKernel, 0) << "}).wait();\n}}\n" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 0) << "});\n}}\n" << std::endl;
     strKernel = transKernel.str();
   }
   return HCFFT_SUCCEEDS;
@@ -995,13 +995,15 @@ hcfftStatus genSwapKernelGeneral(
     if (params.fft_precision == HCFFT_SINGLE) {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                            StockhamGenerator::P_SINGLE>
-          twLarge(smaller_dim * smaller_dim * dim_ratio);
+          twLarge(smaller_dim * smaller_dim * dim_ratio,
+              params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
     } else {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                            StockhamGenerator::P_DOUBLE>
-          twLarge(smaller_dim * smaller_dim * dim_ratio);
+          twLarge(smaller_dim * smaller_dim * dim_ratio,
+              params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
     }
@@ -2107,7 +2109,7 @@ hcfftStatus genSwapKernelGeneral(
       StockhamGenerator::hcKernWrite(transKernel, 3) << "}while(next!=swap_table[group_id/"
                                   << WG_per_line << "][0]);"
                                   << std::endl;  // end of do-while
-    StockhamGenerator::hcKernWrite(transKernel, 0) << "}).wait();\n}}\n"
+    StockhamGenerator::hcKernWrite(transKernel, 0) << "});\n}}\n"
                                 << std::endl;  // end of kernel
 
     if (!twiddleSwapKernel)
@@ -2175,13 +2177,15 @@ hcfftStatus genTransposeKernelBatched(
     if (params.fft_precision == HCFFT_SINGLE) {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                            StockhamGenerator::P_SINGLE>
-          twLarge(params.fft_N[0] * params.fft_N[1]);
+          twLarge(params.fft_N[0] * params.fft_N[1],
+              params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
     } else {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                            StockhamGenerator::P_DOUBLE>
-          twLarge(params.fft_N[0] * params.fft_N[1]);
+          twLarge(params.fft_N[0] * params.fft_N[1],
+              params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
     }
@@ -2737,7 +2741,7 @@ hcfftStatus genTransposeKernelBatched(
       StockhamGenerator::hcKernWrite(transKernel, 6) << "}" << std::endl;  // end for
       StockhamGenerator::hcKernWrite(transKernel, 3) << "}" << std::endl;  // end else
     }
-    StockhamGenerator::hcKernWrite(transKernel, 0) << "}).wait();\n}}\n" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 0) << "});\n}}\n" << std::endl;
 
     strKernel = transKernel.str();
 
@@ -2792,13 +2796,15 @@ hcfftStatus genTransposeKernelLeadingDimensionBatched(
     if (params.fft_precision == HCFFT_SINGLE) {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                            StockhamGenerator::P_SINGLE>
-          twLarge(params.fft_N[0] * params.fft_N[1]);
+          twLarge(params.fft_N[0] * params.fft_N[1],
+              params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
     } else {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                            StockhamGenerator::P_DOUBLE>
-          twLarge(params.fft_N[0] * params.fft_N[1]);
+          twLarge(params.fft_N[0] * params.fft_N[1],
+              params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
     }
@@ -3402,7 +3408,7 @@ hcfftStatus genTransposeKernelLeadingDimensionBatched(
       StockhamGenerator::hcKernWrite(transKernel, 6) << "}" << std::endl;  // end for
       StockhamGenerator::hcKernWrite(transKernel, 3) << "}" << std::endl;  // end else
     }
-    StockhamGenerator::hcKernWrite(transKernel, 0) << "}).wait();\n}}\n" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 0) << "});\n}}\n" << std::endl;
 
     strKernel = transKernel.str();
 
@@ -3410,4 +3416,337 @@ hcfftStatus genTransposeKernelLeadingDimensionBatched(
   }
   return HCFFT_SUCCEEDS;
 }
+
+// Bytes of an element of the matrix, as the shuffle transpose holds it in LDS
+static size_t shuffleElementSize(const FFTKernelGenKeyParams& params) {
+  size_t bytes = (params.fft_precision == HCFFT_DOUBLE) ? 8 : 4;
+
+  if (params.fft_inputLayout != HCFFT_REAL) {
+    bytes *= 2;
+  }
+
+  return bytes;
+}
+
+size_t shuffleColumnBlock(const FFTKernelGenKeyParams& params) {
+  size_t elements = params.limit_LocalMemSize / shuffleElementSize(params);
+  size_t block = elements / params.fft_N[1];
+
+  if (block > 16) {
+    block = 16;
+  }
+
+  return (block == 0) ? 1 : block;
+}
+
+// Emits lds[ldsIndex] = A[index], index in elements of the matrix at iOffset
+static void shuffleLoad(std::stringstream& transKernel, size_t indent,
+                        const FFTKernelGenKeyParams& params,
+                        const std::string& ldsIndex,
+                        const std::string& index) {
+  std::string address = "iOffset + (" + index + ") * " +
+                        SztToStr(params.fft_inStride[0]);
+
+  if (params.fft_inputLayout == HCFFT_COMPLEX_PLANAR) {
+    StockhamGenerator::hcKernWrite(transKernel, indent)
+        << "lds[" << ldsIndex << "].x = inputA_R[" << address << "];"
+        << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, indent)
+        << "lds[" << ldsIndex << "].y = inputA_I[" << address << "];"
+        << std::endl;
+  } else {
+    StockhamGenerator::hcKernWrite(transKernel, indent)
+        << "lds[" << ldsIndex << "] = inputA[" << address << "];"
+        << std::endl;
+  }
+}
+
+// Emits A[index] = value
+static void shuffleStore(std::stringstream& transKernel, size_t indent,
+                         const FFTKernelGenKeyParams& params,
+                         const std::string& index, const std::string& value) {
+  std::string address = "iOffset + (" + index + ") * " +
+                        SztToStr(params.fft_inStride[0]);
+
+  if (params.fft_inputLayout == HCFFT_COMPLEX_PLANAR) {
+    StockhamGenerator::hcKernWrite(transKernel, indent)
+        << "inputA_R[" << address << "] = " << value << ".x;" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, indent)
+        << "inputA_I[" << address << "] = " << value << ".y;" << std::endl;
+  } else {
+    StockhamGenerator::hcKernWrite(transKernel, indent)
+        << "inputA[" << address << "] = " << value << ";" << std::endl;
+  }
+}
+
+/* The in-place transpose of a row major m x n matrix, m = fft_N[1] rows of
+n = fft_N[0] elements, for any m and n, with c = gcd(m, n) and b = n / c:
+-> column rotate (only when c > 1): A[r][j] = A[(r + j / b) % m][j]
+-> row shuffle: A[r][(j * m + (r + j / b) % m) % n] = A[r][j]
+-> column shuffle: with k = r * n + j,
+   A[r][j] = A[(k % m + m - (k / m / b) % m) % m][j]
+after which the memory holds the n x m transpose. A work-group of the row
+shuffle moves one row and one of the column steps moves shuffleColumnBlock
+adjacent columns, each through LDS, so no step needs a temporary buffer.
+The column shuffle, the last step, also takes the twiddles of a large 1D
+transform, as each of its stores knows the element it moves.*/
+hcfftStatus genShuffleTransposeKernel(void** twiddleslarge, hc::accelerator acc,
+                                      const hcfftPlanHandle plHandle,
+                                      const FFTKernelGenKeyParams& params,
+                                      std::string& strKernel,
+                                      std::string& KernelFuncName,
+                                      std::vector<size_t> gWorkSize,
+                                      std::vector<size_t> lWorkSize,
+                                      size_t count) {
+  strKernel.reserve(4096);
+  std::stringstream transKernel(std::stringstream::out);
+
+  std::string dtInput;    // The type read as input into kernel
+  std::string dtOutput;   // The type written as output from kernel
+  std::string dtPlanar;   // Fundamental type for planar arrays
+  std::string dtComplex;  // Fundamental type for complex arrays
+
+  switch (params.fft_precision) {
+    case HCFFT_SINGLE:
+      dtPlanar = "float";
+      dtComplex = "float_2";
+      break;
+    case HCFFT_DOUBLE:
+      dtPlanar = "double";
+      dtComplex = "double2";
+      break;
+    default:
+      return HCFFT_INVALID;
+  }
+
+  if (params.fft_placeness == HCFFT_OUTOFPLACE) {
+    return HCFFT_INVALID;
+  }
+
+  const size_t m = params.fft_N[1];
+  const size_t n = params.fft_N[0];
+
+  // The transpose reads the same memory as n rows of m elements
+  if (params.fft_inStride[1] != n * params.fft_inStride[0]) {
+    return HCFFT_INVALID;
+  }
+
+  size_t c = m, r = n;
+
+  while (r != 0) {
+    size_t t = c % r;
+    c = r;
+    r = t;
+  }
+
+  const size_t b = n / c;
+  const size_t lw = lWorkSize[0];
+  const bool twiddle = params.fft_3StepTwiddle;
+  std::string dtLds =
+      (params.fft_inputLayout == HCFFT_REAL) ? dtPlanar : dtComplex;
+
+  if (twiddle &&
+      (params.nonSquareKernelType != NON_SQUARE_TRANS_COLUMN_SHUFFLE ||
+       params.fft_inputLayout == HCFFT_REAL)) {
+    return HCFFT_INVALID;
+  }
+
+  std::string funcName;
+  size_t linesPerMatrix;
+  size_t ldsSize;
+  size_t block = 0;
+
+  switch (params.nonSquareKernelType) {
+    case NON_SQUARE_TRANS_COLUMN_ROTATE:
+      funcName = "rotate_nonsquare";
+      block = shuffleColumnBlock(params);
+      linesPerMatrix = DivRoundingUp<size_t>(n, block);
+      ldsSize = m * block;
+      break;
+    case NON_SQUARE_TRANS_ROW_SHUFFLE:
+      funcName = "shuffle_rows_nonsquare";
+      linesPerMatrix = m;
+      ldsSize = n;
+      break;
+    case NON_SQUARE_TRANS_COLUMN_SHUFFLE:
+      funcName = "shuffle_columns_nonsquare";
+      block = shuffleColumnBlock(params);
+      linesPerMatrix = DivRoundingUp<size_t>(n, block);
+      ldsSize = m * block;
+      break;
+    default:
+      return HCFFT_INVALID;
+  }
+
+  funcName += SztToStr(count);
+  KernelFuncName = funcName;
+
+  StockhamGenerator::hcKernWrite(transKernel, 0) << std::endl;
+
+  if (twiddle) {
+    std::string str;
+
+    if (params.fft_precision == HCFFT_SINGLE) {
+      StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
+                                           StockhamGenerator::P_SINGLE>
+          twLarge(m * n, params.fft_computeTwiddles);
+      twLarge.GenerateTwiddleTable(str, plHandle);
+      twLarge.TwiddleLargeAV(twiddleslarge, acc);
+    } else {
+      StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
+                                           StockhamGenerator::P_DOUBLE>
+          twLarge(m * n, params.fft_computeTwiddles);
+      twLarge.GenerateTwiddleTable(str, plHandle);
+      twLarge.TwiddleLargeAV(twiddleslarge, acc);
+    }
+
+    StockhamGenerator::hcKernWrite(transKernel, 0) << str << std::endl;
+  }
+
+  for (size_t bothDir = 0; bothDir < 2; bothDir++) {
+    bool fwd = bothDir ? false : true;
+    std::string funcNameTW = funcName;
+
+    if (twiddle) {
+      funcNameTW += fwd ? "_tw_fwd" : "_tw_back";
+    }
+
+    if (genTransposePrototypeLeadingDimensionBatched(
+            params, lw, dtPlanar, dtComplex, funcNameTW, transKernel, dtInput,
+            dtOutput, twiddle) != HCFFT_SUCCEEDS) {
+      return HCFFT_INVALID;
+    }
+
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << "\thc::extent<2> grdExt( ";
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << SztToStr(gWorkSize[0]) << ", 1); \n"
+        << "\thc::tiled_extent<2> t_ext = grdExt.tile(";
+    StockhamGenerator::hcKernWrite(transKernel, 3) << SztToStr(lw) << ", 1);\n";
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << "\thc::parallel_for_each(acc_view, t_ext, "
+           "[=] (hc::tiled_index<2> tidx) [[hc]]\n\t { ";
+
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << "tile_static " << dtLds << " lds[" << ldsSize << "];" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << "size_t line = tidx.tile[0] % " << linesPerMatrix << ";"
+        << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << "size_t t = tidx.tile[0] / " << linesPerMatrix << ";" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 3) << "size_t iOffset = 0;"
+                                                   << std::endl;
+
+    // The matrices of the higher dimensions, then of the batch
+    for (size_t i = 2; i < params.fft_DataDim - 1; i++) {
+      StockhamGenerator::hcKernWrite(transKernel, 3)
+          << "iOffset += (t % " << params.fft_N[i] << ") * "
+          << params.fft_inStride[i] << ";" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 3)
+          << "t /= " << params.fft_N[i] << ";" << std::endl;
+    }
+
+    StockhamGenerator::hcKernWrite(transKernel, 3)
+        << "iOffset += t * " << params.fft_inStride[params.fft_DataDim - 1]
+        << ";" << std::endl;
+
+    // Whole work-groups past the batch leave, so the barrier stays uniform
+    StockhamGenerator::hcKernWrite(transKernel, 3) << "if (t < batchSize) {"
+                                                   << std::endl;
+
+    if (params.nonSquareKernelType == NON_SQUARE_TRANS_ROW_SHUFFLE) {
+      StockhamGenerator::hcKernWrite(transKernel, 6)
+          << "iOffset += line * " << params.fft_inStride[1] << ";"
+          << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6)
+          << "for (size_t j = tidx.local[0]; j < " << n << "; j += " << lw
+          << ") {" << std::endl;
+      shuffleLoad(transKernel, 9, params, "j", "j");
+      StockhamGenerator::hcKernWrite(transKernel, 6) << "}" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6) << "tidx.barrier.wait();"
+                                                     << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6)
+          << "for (size_t j = tidx.local[0]; j < " << n << "; j += " << lw
+          << ") {" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 9)
+          << "size_t i = (line + j / " << b << ") % " << m << ";" << std::endl;
+      shuffleStore(transKernel, 9, params,
+                   "(j * " + SztToStr(m) + " + i) % " + SztToStr(n), "lds[j]");
+      StockhamGenerator::hcKernWrite(transKernel, 6) << "}" << std::endl;
+    } else {
+      // Columns are read a row of the block at a time, to coalesce
+      StockhamGenerator::hcKernWrite(transKernel, 6)
+          << "size_t col0 = line * " << block << ";" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6)
+          << "for (size_t k = tidx.local[0]; k < " << ldsSize << "; k += " << lw
+          << ") {" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 9)
+          << "size_t col = col0 + k % " << block << ";" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 9) << "if (col < " << n
+                                                     << ") {" << std::endl;
+      shuffleLoad(transKernel, 12, params, "k",
+                  "(k / " + SztToStr(block) + ") * " + SztToStr(n) + " + col");
+      StockhamGenerator::hcKernWrite(transKernel, 9) << "}" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6) << "}" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6) << "tidx.barrier.wait();"
+                                                     << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6)
+          << "for (size_t k = tidx.local[0]; k < " << ldsSize << "; k += " << lw
+          << ") {" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 9)
+          << "size_t r = k / " << block << ";" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 9)
+          << "size_t col = col0 + k % " << block << ";" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 9) << "if (col < " << n
+                                                     << ") {" << std::endl;
+
+      if (params.nonSquareKernelType == NON_SQUARE_TRANS_COLUMN_ROTATE) {
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << "size_t src = (r + col / " << b << ") % " << m << ";"
+            << std::endl;
+      } else {
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << "size_t e = r * " << n << " + col;" << std::endl;
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << "size_t src = (e % " << m << " + " << m << " - (e / " << m
+            << " / " << b << ") % " << m << ") % " << m << ";" << std::endl;
+      }
+
+      std::string value =
+          "lds[src * " + SztToStr(block) + " + k % " + SztToStr(block) + "]";
+
+      if (twiddle) {
+        // The element of row i, column j of the matrix takes W^(i * j)
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << dtComplex << " v = " << value << ";" << std::endl;
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << dtComplex << " w = " << StockhamGenerator::TwTableLargeFunc()
+            << plHandle << "((e % " << m << ") * (e / " << m << "), "
+            << StockhamGenerator::TwTableLargeName() << ");" << std::endl;
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << dtPlanar << " x = v.x * w.x " << (fwd ? "-" : "+")
+            << " v.y * w.y;" << std::endl;
+        StockhamGenerator::hcKernWrite(transKernel, 12)
+            << "v.y = " << (fwd ? "v.x * w.y + v.y * w.x;"
+                                : "v.y * w.x - v.x * w.y;") << std::endl;
+        StockhamGenerator::hcKernWrite(transKernel, 12) << "v.x = x;"
+                                                        << std::endl;
+        value = "v";
+      }
+
+      shuffleStore(transKernel, 12, params, "r * " + SztToStr(n) + " + col",
+                   value);
+      StockhamGenerator::hcKernWrite(transKernel, 9) << "}" << std::endl;
+      StockhamGenerator::hcKernWrite(transKernel, 6) << "}" << std::endl;
+    }
+
+    StockhamGenerator::hcKernWrite(transKernel, 3) << "}" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 0) << "});\n}}\n" << std::endl;
+
+    // without twiddles both directions take the same kernel
+    if (!twiddle) break;
+  }
+  strKernel = transKernel.str();
+  return HCFFT_SUCCEEDS;
+}
 }  // end of namespace hcfft_transpose_generator
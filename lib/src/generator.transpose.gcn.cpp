@@ -143,7 +143,7 @@ static hcfftStatus genTransposePrototype(
   // Declare and define the function
   StockhamGenerator::hcKernWrite(transKernel, 0) << "extern \"C\"\n { void" << std::endl;
   StockhamGenerator::hcKernWrite(transKernel, 0)
-      << funcName << "(  std::map<int, void*> vectArr, uint batchSize, "
+      << funcName << "(  const hcfftKernelArgs *args, uint batchSize, "
                      "accelerator_view &acc_view, accelerator &acc) \n {";
 
   switch (params.fft_inputLayout) {
@@ -151,7 +151,7 @@ static hcfftStatus genTransposePrototype(
       dtInput = dtComplex;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " *" << pmComplexIn
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
 
       switch (params.fft_placeness) {
         case HCFFT_INPLACE:
@@ -164,17 +164,17 @@ static hcfftStatus genTransposePrototype(
               dtOutput = dtComplex;
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " *" << pmComplexOut
                                           << " = static_cast< " << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               break;
 
             case HCFFT_COMPLEX_PLANAR:
               dtOutput = dtPlanar;
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " * " << pmRealOut
                                           << " = static_cast< " << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << "* " << pmImagOut
                                           << " = static_cast< " << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               break;
 
             case HCFFT_HERMITIAN_INTERLEAVED:
@@ -196,10 +196,10 @@ static hcfftStatus genTransposePrototype(
       dtInput = dtPlanar;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * " << pmRealIn
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " * " << pmImagIn
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
 
       switch (params.fft_placeness) {
         case HCFFT_INPLACE:
@@ -212,17 +212,17 @@ static hcfftStatus genTransposePrototype(
               dtOutput = dtComplex;
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " *" << pmComplexOut
                                           << " = static_cast< " << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               break;
 
             case HCFFT_COMPLEX_PLANAR:
               dtOutput = dtPlanar;
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " *" << pmRealOut
                                           << " = static_cast< " << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " *" << pmImagOut
                                           << " = static_cast< " << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               break;
 
             case HCFFT_HERMITIAN_INTERLEAVED:
@@ -248,7 +248,7 @@ static hcfftStatus genTransposePrototype(
       dtInput = dtPlanar;
       StockhamGenerator::hcKernWrite(transKernel, 0) << dtInput << " *" << pmRealIn
                                   << " = static_cast< " << dtInput
-                                  << "*> (vectArr[" << arg++ << "]);";
+                                  << "*> (args->buffers[" << arg++ << "]);";
 
       switch (params.fft_placeness) {
         case HCFFT_INPLACE:
@@ -267,7 +267,7 @@ static hcfftStatus genTransposePrototype(
               dtOutput = dtPlanar;
               StockhamGenerator::hcKernWrite(transKernel, 0) << dtOutput << " *" << pmRealOut
                                           << " = static_cast<" << dtOutput
-                                          << "*> (vectArr[" << arg++ << "]);";
+                                          << "*> (args->buffers[" << arg++ << "]);";
               break;
 
             default:
@@ -289,7 +289,13 @@ static hcfftStatus genTransposePrototype(
   if (genTwiddle) {
     StockhamGenerator::hcKernWrite(transKernel, 0) << dtComplex << " *" << StockhamGenerator::TwTableLargeName()
                                 << " = static_cast<" << dtComplex
-                                << "*> (vectArr[" << arg++ << "]);";
+                                << "*> (args->buffers[" << arg++ << "]);";
+  }
+
+  // Data of the user store callback follows the twiddle table
+  if (params.fft_storeCallback) {
+    StockhamGenerator::hcKernWrite(transKernel, 0)
+        << "void *storeData = args->buffers[" << arg++ << "];";
   }
 
   return HCFFT_SUCCEEDS;
@@ -337,13 +343,15 @@ static hcfftStatus genTransposeKernel(
     if (params.fft_precision == HCFFT_SINGLE) {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                            StockhamGenerator::P_SINGLE>
-          twLarge(params.fft_N[0] * params.fft_N[1]);
+          twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV(twiddleslarge, acc);
     } else {
       StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                            StockhamGenerator::P_DOUBLE>
-          twLarge(params.fft_N[0] * params.fft_N[1]);
+          twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
       twLarge.GenerateTwiddleTable(str, plHandle);
       twLarge.TwiddleLargeAV(twiddleslarge, acc);
     }
@@ -863,8 +871,16 @@ static hcfftStatus genTransposeKernel(
 
       switch (params.fft_outputLayout) {
         case HCFFT_COMPLEX_INTERLEAVED:
-          StockhamGenerator::hcKernWrite(transKernel, 9)
-              << "pmComplexOut[ gInd + outOffset] = tmp;" << std::endl;
+          if (params.fft_storeCallback) {
+            StockhamGenerator::hcKernWrite(transKernel, 9)
+                << params.fft_storeCallback
+                << "(pmComplexOut, gInd + outOffset, tmp, storeData);"
+                << std::endl;
+          } else {
+            StockhamGenerator::hcKernWrite(transKernel, 9)
+                << "pmComplexOut[ gInd + outOffset] = tmp;" << std::endl;
+          }
+
           break;
 
         case HCFFT_COMPLEX_PLANAR:
@@ -895,7 +911,7 @@ static hcfftStatus genTransposeKernel(
       }
     }
 
-    StockhamGenerator::hcKernWrite(transKernel, 0) << "}).wait();\n}}\n" << std::endl;
+    StockhamGenerator::hcKernWrite(transKernel, 0) << "});\n}}\n" << std::endl;
     strKernel = transKernel.str();
 
     if (!params.fft_3StepTwiddle) {
@@ -950,6 +966,7 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Transpose_GCN>(
     ARG_CHECK(params.fft_N[0] != 0)
     ARG_CHECK((this->large1D % params.fft_N[0]) == 0)
     params.fft_3StepTwiddle = true;
+    params.fft_computeTwiddles = this->computeTwiddles;
     ARG_CHECK(this->large1D == (params.fft_N[1] * params.fft_N[0]));
   }
 
@@ -968,6 +985,13 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Transpose_GCN>(
   params.fft_SIMD =
       pEnvelope->limit_WorkGroupSize;  // Use devices maximum workgroup size
   params.limit_LocalMemSize = this->envelope.limit_LocalMemSize;
+
+  // Only interleaved output goes through a store callback
+  if (!this->storeCallback.empty() &&
+      (params.fft_outputLayout == HCFFT_COMPLEX_INTERLEAVED)) {
+    params.fft_storeCallback = this->storeCallback.funcName.c_str();
+  }
+
   return HCFFT_SUCCEEDS;
 }
 
@@ -1055,19 +1079,25 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_GCN>(
     this->GetWorkSizesPvt<Transpose_GCN>(gWorkSize, lWorkSize);
     std::string programHeader, programCode;
     programHeader = hcHeader();
+
+    if (fftParams.fft_storeCallback) {
+      programHeader += this->storeCallback.funcString;
+      programHeader += "\n";
+    }
+
     genTransposeKernel((void**)&twiddleslarge, acc, plHandle, fftParams,
                        programCode, lwSize, reShapeFactor, loopCount, blockSize,
                        gWorkSize, lWorkSize, count);
     programHeader += programCode;
-    fftRepo.setProgramCode(Transpose_GCN, plHandle, fftParams, programHeader);
+    fftRepo.setProgramCode(Transpose_GCN, count, fftParams, programHeader);
 
     // Note:  See genFunctionPrototype( )
     if (fftParams.fft_3StepTwiddle) {
-      fftRepo.setProgramEntryPoints(Transpose_GCN, plHandle, fftParams,
+      fftRepo.setProgramEntryPoints(Transpose_GCN, count, fftParams,
                                     "transpose_gcn_tw_fwd",
                                     "transpose_gcn_tw_back");
     } else {
-      fftRepo.setProgramEntryPoints(Transpose_GCN, plHandle, fftParams,
+      fftRepo.setProgramEntryPoints(Transpose_GCN, count, fftParams,
                                     "transpose_gcn", "transpose_gcn");
     }
   } else {
@@ -1084,7 +1114,7 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_GCN>(
       if (fftParams.fft_3StepTwiddle && !twiddleslarge) {
         StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                              StockhamGenerator::P_SINGLE>
-            twLarge(large1D);
+            twLarge(large1D, fftParams.fft_computeTwiddles);
         twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
       }
     } else {
@@ -1092,7 +1122,7 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_GCN>(
       if (fftParams.fft_3StepTwiddle && !twiddleslarge) {
         StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                              StockhamGenerator::P_DOUBLE>
-            twLarge(large1D);
+            twLarge(large1D, fftParams.fft_computeTwiddles);
         twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
       }
     }
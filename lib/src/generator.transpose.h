@@ -129,6 +129,21 @@ hcfftStatus genTransposeKernelLeadingDimensionBatched(
     const size_t& lwSize, const size_t reShapeFactor,
     std::vector<size_t> gWorkSize, std::vector<size_t> lWorkSize, size_t count);
 
+// Columns of the matrix a work-group of the column steps of the shuffle
+// transpose holds in LDS
+size_t shuffleColumnBlock(const FFTKernelGenKeyParams& params);
+
+// generate a step of the in-place shuffle transpose of a row major matrix of
+// any shape, see NON_SQUARE_TRANS_ROW_SHUFFLE
+hcfftStatus genShuffleTransposeKernel(void** twiddleslarge, hc::accelerator acc,
+                                      const hcfftPlanHandle plHandle,
+                                      const FFTKernelGenKeyParams& params,
+                                      std::string& strKernel,
+                                      std::string& KernelFuncName,
+                                      std::vector<size_t> gWorkSize,
+                                      std::vector<size_t> lWorkSize,
+                                      size_t count);
+
 }  // end of namespace hcfft_transpose_generator
 
 #endif  // LIB_SRC_GENERATOR_TRANSPOSE_H_
@@ -78,6 +78,7 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Transpose_NONSQUARE>(
     // TODO(Neelakandan) :ENABLE ASSERT
     //     ARG_CHECK((this->large1D % params.fft_N[0]) == 0)
     params.fft_3StepTwiddle = true;
+    params.fft_computeTwiddles = this->computeTwiddles;
     // TODO(Neelakandan) :ENABLE ASSERT
     // ARG_CHECK(this->large1D == (params.fft_N[1] * params.fft_N[0]));
   }
@@ -123,8 +124,39 @@ hcfftStatus FFTPlan::GetWorkSizesPvt<Transpose_NONSQUARE>(
   size_t dim_ratio = bigger_dim / smaller_dim;
   size_t global_item_size;
 
-  if (fftParams.nonSquareKernelType ==
-      NON_SQUARE_TRANS_TRANSPOSE_BATCHED_LEADING) {
+  if (fftParams.nonSquareKernelType == NON_SQUARE_TRANS_COLUMN_ROTATE ||
+      fftParams.nonSquareKernelType == NON_SQUARE_TRANS_ROW_SHUFFLE ||
+      fftParams.nonSquareKernelType == NON_SQUARE_TRANS_COLUMN_SHUFFLE) {
+    // A work-group per row, or per block of columns, of each matrix
+    size_t lines, lineSize;
+
+    if (fftParams.nonSquareKernelType == NON_SQUARE_TRANS_ROW_SHUFFLE) {
+      lines = fftParams.fft_N[1];
+      lineSize = fftParams.fft_N[0];
+    } else {
+      size_t block = hcfft_transpose_generator::shuffleColumnBlock(fftParams);
+      lines = DivRoundingUp<size_t>(fftParams.fft_N[0], block);
+      lineSize = fftParams.fft_N[1] * block;
+    }
+
+    size_t local_work_size = DivRoundingUp<size_t>(lineSize, 64) * 64;
+
+    if (local_work_size > lwSize) {
+      local_work_size = lwSize;
+    }
+
+    global_item_size = lines * local_work_size * this->batchSize;
+
+    for (int i = 2; i < fftParams.fft_DataDim - 1; i++) {
+      global_item_size *= fftParams.fft_N[i];
+    }
+
+    globalWS.clear();
+    globalWS.push_back(global_item_size);
+    localWS.clear();
+    localWS.push_back(local_work_size);
+  } else if (fftParams.nonSquareKernelType ==
+             NON_SQUARE_TRANS_TRANSPOSE_BATCHED_LEADING) {
     if (smaller_dim % (16 * reShapeFactor) == 0) {
       wg_slice = smaller_dim / 16 / reShapeFactor;
     } else {
@@ -331,6 +363,15 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_NONSQUARE>(
       hcfft_transpose_generator::genTransposeKernelBatched(
           (void**)&twiddleslarge, acc, plHandle, params, programCode, lwSize,
           reShapeFactor, gWorkSize, lWorkSize, count);
+    } else if (params.nonSquareKernelType == NON_SQUARE_TRANS_COLUMN_ROTATE ||
+               params.nonSquareKernelType == NON_SQUARE_TRANS_ROW_SHUFFLE ||
+               params.nonSquareKernelType ==
+                   NON_SQUARE_TRANS_COLUMN_SHUFFLE) {
+      if (hcfft_transpose_generator::genShuffleTransposeKernel(
+              (void**)&twiddleslarge, acc, plHandle, params, programCode,
+              kernelFuncName, gWorkSize, lWorkSize, count) != HCFFT_SUCCEEDS) {
+        return HCFFT_INVALID;
+      }
     } else {
       // general swap kernel takes care of all ratio
       hcfft_transpose_generator::genSwapKernelGeneral(
@@ -338,34 +379,35 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_NONSQUARE>(
           kernelFuncName, lwSize, reShapeFactor, gWorkSize, lWorkSize, count);
     }
 
-    fftRepo.setProgramCode(Transpose_NONSQUARE, plHandle, params, programCode);
+    programCode = hcHeader() + programCode;
+    fftRepo.setProgramCode(Transpose_NONSQUARE, count, params, programCode);
 
     if (params.nonSquareKernelType ==
         NON_SQUARE_TRANS_TRANSPOSE_BATCHED_LEADING) {
       // Note:  See genFunctionPrototype( )
       if (params.fft_3StepTwiddle) {
-        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, plHandle, params,
+        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, count, params,
                                       "transpose_nonsquare_tw_fwd",
                                       "transpose_nonsquare_tw_back");
       } else {
-        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, plHandle, params,
+        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, count, params,
                                       "transpose_nonsquare",
                                       "transpose_nonsquare");
       }
     } else if (params.nonSquareKernelType ==
                NON_SQUARE_TRANS_TRANSPOSE_BATCHED) {
-      fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, plHandle, params,
+      fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, count, params,
                                     "transpose_square", "transpose_square");
     } else {
       if (params.fft_3StepTwiddle) {  // if miniBatchSize > 1 twiddling is done
                                       // in swap kernel
         std::string kernelFwdFuncName = kernelFuncName + "_tw_fwd";
         std::string kernelBwdFuncName = kernelFuncName + "_tw_back";
-        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, plHandle, params,
+        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, count, params,
                                       kernelFwdFuncName.c_str(),
                                       kernelBwdFuncName.c_str());
       } else {
-        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, plHandle, params,
+        fftRepo.setProgramEntryPoints(Transpose_NONSQUARE, count, params,
                                       kernelFuncName.c_str(),
                                       kernelFuncName.c_str());
       }
@@ -379,12 +421,14 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_NONSQUARE>(
         if (params.fft_precision == HCFFT_SINGLE) {
           StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                                StockhamGenerator::P_SINGLE>
-              twLarge(params.fft_N[0] * params.fft_N[1]);
+              twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
           twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
         } else {
           StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                                StockhamGenerator::P_DOUBLE>
-              twLarge(params.fft_N[0] * params.fft_N[1]);
+              twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
           twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
         }
       }
@@ -405,12 +449,34 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_NONSQUARE>(
         if (params.fft_precision == HCFFT_SINGLE) {
           StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                                StockhamGenerator::P_SINGLE>
-              twLarge(params.fft_N[0] * params.fft_N[1]);
+              twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
+          twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
+        } else {
+          StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
+                                               StockhamGenerator::P_DOUBLE>
+              twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
+          twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
+        }
+      }
+    } else if (params.nonSquareKernelType == NON_SQUARE_TRANS_COLUMN_ROTATE ||
+               params.nonSquareKernelType == NON_SQUARE_TRANS_ROW_SHUFFLE ||
+               params.nonSquareKernelType ==
+                   NON_SQUARE_TRANS_COLUMN_SHUFFLE) {
+      // the column shuffle, the last step, may twiddle
+      if (params.fft_3StepTwiddle) {
+        if (params.fft_precision == HCFFT_SINGLE) {
+          StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
+                                               StockhamGenerator::P_SINGLE>
+              twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
           twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
         } else {
           StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                                StockhamGenerator::P_DOUBLE>
-              twLarge(params.fft_N[0] * params.fft_N[1]);
+              twLarge(params.fft_N[0] * params.fft_N[1],
+                  params.fft_computeTwiddles);
           twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
         }
       }
@@ -438,12 +504,14 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_NONSQUARE>(
         if (params.fft_precision == HCFFT_SINGLE) {
           StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                                StockhamGenerator::P_SINGLE>
-              twLarge(smaller_dim * smaller_dim * dim_ratio);
+              twLarge(smaller_dim * smaller_dim * dim_ratio,
+                  params.fft_computeTwiddles);
           twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
         } else {
           StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                                StockhamGenerator::P_DOUBLE>
-              twLarge(smaller_dim * smaller_dim * dim_ratio);
+              twLarge(smaller_dim * smaller_dim * dim_ratio,
+                  params.fft_computeTwiddles);
           twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
         }
       }
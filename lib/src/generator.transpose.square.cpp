@@ -67,6 +67,7 @@ hcfftStatus FFTPlan::GetKernelGenKeyPvt<Transpose_SQUARE>(
     ARG_CHECK(params.fft_N[0] != 0)
     ARG_CHECK((this->large1D % params.fft_N[0]) == 0)
     params.fft_3StepTwiddle = true;
+    params.fft_computeTwiddles = this->computeTwiddles;
     ARG_CHECK(this->large1D == (params.fft_N[1] * params.fft_N[0]));
   }
 
@@ -137,15 +138,16 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_SQUARE>(
     hcfft_transpose_generator::genTransposeKernelBatched(
         (void**)&twiddleslarge, acc, plHandle, params, programCode, lwSize,
         reShapeFactor, gWorkSize, lWorkSize, count);
-    fftRepo.setProgramCode(Transpose_SQUARE, plHandle, params, programCode);
+    programCode = hcHeader() + programCode;
+    fftRepo.setProgramCode(Transpose_SQUARE, count, params, programCode);
 
     // Note:  See genFunctionPrototype( )
     if (params.fft_3StepTwiddle) {
-      fftRepo.setProgramEntryPoints(Transpose_SQUARE, plHandle, params,
+      fftRepo.setProgramEntryPoints(Transpose_SQUARE, count, params,
                                     "transpose_square_tw_fwd",
                                     "transpose_square_tw_back");
     } else {
-      fftRepo.setProgramEntryPoints(Transpose_SQUARE, plHandle, params,
+      fftRepo.setProgramEntryPoints(Transpose_SQUARE, count, params,
                                     "transpose_square", "transpose_square");
     }
   } else {
@@ -163,12 +165,14 @@ hcfftStatus FFTPlan::GenerateKernelPvt<Transpose_SQUARE>(
       if (params.fft_precision == HCFFT_SINGLE) {
         StockhamGenerator::TwiddleTableLarge<hc::short_vector::float_2,
                                              StockhamGenerator::P_SINGLE>
-            twLarge(params.fft_N[0] * params.fft_N[1]);
+            twLarge(params.fft_N[0] * params.fft_N[1],
+                params.fft_computeTwiddles);
         twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
       } else {
         StockhamGenerator::TwiddleTableLarge<hc::short_vector::double_2,
                                              StockhamGenerator::P_DOUBLE>
-            twLarge(params.fft_N[0] * params.fft_N[1]);
+            twLarge(params.fft_N[0] * params.fft_N[1],
+                params.fft_computeTwiddles);
         twLarge.TwiddleLargeAV((void**)&twiddleslarge, acc);
       }
     }
@@ -22,7 +22,21 @@ THE SOFTWARE.
 
 #include "include/hipfft.h"
 #include "include/hcfft.h"
+#include <hip/hip_hcc.h>
 #include <iostream>
+#include <vector>
+
+// hcfft takes the dimensions from the fastest varying one, hipfft/cufft from
+// the slowest, so the arrays of sizes are reversed
+static std::vector<int> hipReverseDims(const int *dims, int rank) {
+  std::vector<int> reversed(rank > 0 ? rank : 0);
+
+  for (int i = 0; dims != NULL && i < rank; i++) {
+    reversed[i] = dims[rank - 1 - i];
+  }
+
+  return reversed;
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -101,8 +115,18 @@ hipfftResult hipfftDestroy(hipfftHandle plan) {
   return hipHCFFTResultToHIPFFTResult(hcfftDestroy(plan));
 }
 
+// The transforms of the plan and of its sub-plans are queued on the
+// accelerator_view of stream, and run asynchronously to the host
 hipfftResult hipfftSetStream(hipfftHandle plan, hipStream_t stream) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  hc::accelerator_view* acc_view = NULL;
+
+  if (hipHccGetAcceleratorView(stream, &acc_view) != hipSuccess ||
+      acc_view == NULL) {
+    return HIPFFT_INVALID_VALUE;
+  }
+
+  hcfftHandle* handle = &plan;
+  return hipHCFFTResultToHIPFFTResult(hcfftSetStream(handle, *acc_view));
 }
 
 /*hipFFT Basic Plans*/
@@ -110,7 +134,8 @@ hipfftResult hipfftSetStream(hipfftHandle plan, hipStream_t stream) {
 hipfftResult hipfftPlan1d(hipfftHandle *plan, int nx, hipfftType type,
                           int batch) {
   return hipHCFFTResultToHIPFFTResult(
-      hcfftPlan1d(plan, nx, hipHIPFFTTypeToHCFFTType(type)));
+      hcfftPlanMany(plan, 1, &nx, NULL, 1, 0, NULL, 1, 0,
+                    hipHIPFFTTypeToHCFFTType(type), batch));
 }
 // hcfftPlan2d accept the dimensions in the inverse order of that of how
 // hipfft/cufft accepts it
@@ -130,7 +155,17 @@ hipfftResult hipfftPlan3d(hipfftHandle *plan, int nx, int ny, int nz,
 hipfftResult hipfftPlanMany(hipfftHandle *plan, int rank, int *n, int *inembed,
                             int istride, int idist, int *onembed, int ostride,
                             int odist, hipfftType type, int batch) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  if (n == NULL) {
+    return HIPFFT_INVALID_VALUE;
+  }
+
+  std::vector<int> length = hipReverseDims(n, rank);
+  std::vector<int> iembed = hipReverseDims(inembed, rank);
+  std::vector<int> oembed = hipReverseDims(onembed, rank);
+  return hipHCFFTResultToHIPFFTResult(hcfftPlanMany(
+      plan, rank, length.data(), inembed ? iembed.data() : NULL, istride,
+      idist, onembed ? oembed.data() : NULL, ostride, odist,
+      hipHIPFFTTypeToHCFFTType(type), batch));
 }
 
 /*hipFFT Extensible Plans*/
@@ -170,23 +205,38 @@ hipfftResult hipfftMakePlanMany64(
 
 hipfftResult hipfftEstimate1d(int nx, hipfftType type, int batch,
                               size_t *workSize) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  return hipHCFFTResultToHIPFFTResult(
+      hcfftEstimate1d(nx, hipHIPFFTTypeToHCFFTType(type), batch, workSize));
 }
 
+// hcfftEstimate2d and hcfftEstimate3d take the dimensions in the inverse
+// order, as hcfftPlan2d and hcfftPlan3d do
 hipfftResult hipfftEstimate2d(int nx, int ny, hipfftType type,
                               size_t *workSize) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  return hipHCFFTResultToHIPFFTResult(
+      hcfftEstimate2d(ny, nx, hipHIPFFTTypeToHCFFTType(type), workSize));
 }
 
 hipfftResult hipfftEstimate3d(int nx, int ny, int nz, hipfftType type,
                               size_t *workSize) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  return hipHCFFTResultToHIPFFTResult(
+      hcfftEstimate3d(nz, ny, nx, hipHIPFFTTypeToHCFFTType(type), workSize));
 }
 
 hipfftResult hipfftEstimateMany(int rank, int *n, int *inembed, int istride,
                                 int idist, int *onembed, int ostride, int odist,
                                 hipfftType type, int batch, size_t *workSize) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  if (n == NULL) {
+    return HIPFFT_INVALID_VALUE;
+  }
+
+  std::vector<int> length = hipReverseDims(n, rank);
+  std::vector<int> iembed = hipReverseDims(inembed, rank);
+  std::vector<int> oembed = hipReverseDims(onembed, rank);
+  return hipHCFFTResultToHIPFFTResult(hcfftEstimateMany(
+      rank, length.data(), inembed ? iembed.data() : NULL, istride, idist,
+      onembed ? oembed.data() : NULL, ostride, odist,
+      hipHIPFFTTypeToHCFFTType(type), batch, workSize));
 }
 
 /*hipFFT Refined Estimated Size of Work Area*/
@@ -223,17 +273,18 @@ hipfftResult hipfftGetSizeMany64(
 }
 
 hipfftResult hipfftGetSize(hipfftHandle plan, size_t *workSize) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  return hipHCFFTResultToHIPFFTResult(hcfftGetSize(plan, workSize));
 }
 
 /*hipFFT Caller Allocated Work Area Support*/
 
 hipfftResult hipfftSetAutoAllocation(hipfftHandle plan, int autoAllocate) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  return hipHCFFTResultToHIPFFTResult(
+      hcfftSetAutoAllocation(plan, autoAllocate));
 }
 
 hipfftResult hipfftSetWorkArea(hipfftHandle plan, void *workArea) {
-  return HIPFFT_RESULT_NOT_SUPPORTED;
+  return hipHCFFTResultToHIPFFTResult(hcfftSetWorkArea(plan, workArea));
 }
 
 /*hipFFT Execution*/
@@ -276,6 +327,23 @@ hipfftResult hipfftExecZ2D(hipfftHandle plan, hipfftDoubleComplex *idata,
       hcfftExecZ2D(plan, (hcfftDoubleComplex *)idata, odata));
 }
 
+hipfftResult hipfftExecPlanarC2C(hipfftHandle plan, hipfftReal *idataRe,
+                                 hipfftReal *idataIm, hipfftReal *odataRe,
+                                 hipfftReal *odataIm, int direction) {
+  return hipHCFFTResultToHIPFFTResult(hcfftXtExecPlanarC2C(
+      plan, idataRe, idataIm, odataRe, odataIm,
+      hipHIPFFTDirectionToHCFFTDirection(direction)));
+}
+
+hipfftResult hipfftExecPlanarZ2Z(hipfftHandle plan, hipfftDoubleReal *idataRe,
+                                 hipfftDoubleReal *idataIm,
+                                 hipfftDoubleReal *odataRe,
+                                 hipfftDoubleReal *odataIm, int direction) {
+  return hipHCFFTResultToHIPFFTResult(hcfftXtExecPlanarZ2Z(
+      plan, idataRe, idataIm, odataRe, odataIm,
+      hipHIPFFTDirectionToHCFFTDirection(direction)));
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,43 +22,433 @@ THE SOFTWARE.
 
 #include "include/hcfft.h"
 #include "include/hcfftlib.h"
+#include <climits>
 
-#if __has_feature(cxx_thread_local)
-// Global Static plan object
-thread_local FFTPlan planObject;
-#else
+// Global Static plan object. It only dispatches to the plans of FFTRepo,
+// which every thread shares, so one object serves all of them.
 FFTPlan planObject;
-#endif
-/* Function hcfftXtSetGPUs()
-Returns GPUs are to be used with the plan
+
+/* Function hcfftDefaultGPU()
+Returns the first GPU, which new plans are created on
 */
-hcfftResult hcfftXtSetGPUs(hc::accelerator& acc) {
+static hcfftResult hcfftDefaultGPU(hc::accelerator& acc) {
   std::vector<hc::accelerator> accs = hc::accelerator::get_all();
 
-  if (accs.size() == 0) {
-    std::wcout << "There is no acclerator!\n";
-    // Since this case is to test on GPU device, skip if there is CPU only
-    return HCFFT_SETUP_FAILED;
+  for (size_t i = 0; i < accs.size(); i++) {
+    if (!accs[i].get_is_emulated()) {
+      acc = accs[i];
+      return HCFFT_SUCCESS;
+    }
   }
 
-  assert(accs.size() && "Number of Accelerators == 0!");
-  acc = accs[1];
-  return HCFFT_SUCCESS;
+  std::wcout << "There is no acclerator!\n";
+  // Since this case is to test on GPU device, skip if there is CPU only
+  return HCFFT_SETUP_FAILED;
 }
 
 /* Function hcfftSetStream()
 Associate FFT Plan with an accelerator_view
 */
 hcfftResult hcfftSetStream(hcfftHandle*& plan, hc::accelerator_view& acc_view) {
+  if (plan == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
   hcfftStatus status = planObject.hcfftSetAcclView(*plan, acc_view);
 
   if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtGetStreamPlan()
+Returns the copy of a plan that transforms on an accelerator_view
+*/
+hcfftResult hcfftXtGetStreamPlan(hcfftHandle plan,
+                                 hc::accelerator_view& acc_view,
+                                 hcfftHandle* streamPlan) {
+  if (streamPlan == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPlanHandle handle = 0;
+
+  if (planObject.hcfftGetQueuePlan(plan, acc_view, &handle) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  *streamPlan = handle;
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetBatch()
+Changes the number of transforms of a plan, keeping the kernels of a leaf
+*/
+hcfftResult hcfftXtSetBatch(hcfftHandle plan, int batch) {
+  if (batch < 1) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before the batch changes
+  planObject.hcfftWaitBakePlan(plan);
+
+  if (planObject.hcfftSetPlanBatchSize(plan, batch) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtClonePlan()
+Creates a copy of a plan for another batch, baked from its kernels
+*/
+hcfftResult hcfftXtClonePlan(hcfftHandle plan, int batch, hcfftHandle* clone) {
+  if (clone == NULL || batch < 1) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftPlanHandle handle = 0;
+  hcfftStatus status = planObject.hcfftClonePlan(plan, batch, &handle);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  *clone = handle;
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftSynchronize()
+Waits for the transforms queued on the accelerator_view of a plan
+*/
+hcfftResult hcfftSynchronize(hcfftHandle plan) {
+  hc::accelerator_view acc_view = hc::accelerator().get_default_view();
+  hcfftStatus status = planObject.hcfftGetAcclView(plan, &acc_view);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  acc_view.wait();
+  planObject.hcfftWaitPlanGPUs(plan);
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftGetSize()
+Bakes the plan and returns the size of the work area its transforms need
+*/
+hcfftResult hcfftGetSize(hcfftHandle plan, size_t* workSize) {
+  if (workSize == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (planObject.hcfftGetWorkSize(plan, workSize) != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
   }
 
   return HCFFT_SUCCESS;
 }
 
+/* Function hcfftSetAutoAllocation()
+Selects whether transforms allocate the work area of the plan themselves
+*/
+hcfftResult hcfftSetAutoAllocation(hcfftHandle plan, int autoAllocate) {
+  if (planObject.hcfftSetAutoAllocation(plan, autoAllocate != 0) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftSetWorkArea()
+Gives the plan caller memory to carve its intermediate buffers from
+*/
+hcfftResult hcfftSetWorkArea(hcfftHandle plan, void* workArea) {
+  if (planObject.hcfftSetWorkArea(plan, workArea) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetBatchStreams()
+Splits the batch of a plan across accelerator_views
+*/
+hcfftResult hcfftXtSetBatchStreams(hcfftHandle plan, int count,
+                                   hc::accelerator_view* streams) {
+  if (count < 0 || (count > 0 && streams == NULL)) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hc::accelerator_view acc_view = hc::accelerator().get_default_view();
+
+  if (planObject.hcfftGetAcclView(plan, &acc_view) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  std::vector<hc::accelerator_view> views(streams, streams + count);
+
+  if (planObject.hcfftSetPlanSplitViews(plan, views) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetGPUs()
+Splits the batch of a plan across accelerators
+*/
+hcfftResult hcfftXtSetGPUs(hcfftHandle plan, int count, hc::accelerator* accs) {
+  if (count < 0 || (count > 0 && accs == NULL)) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hc::accelerator_view acc_view = hc::accelerator().get_default_view();
+
+  if (planObject.hcfftGetAcclView(plan, &acc_view) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  std::vector<hc::accelerator> gpus(accs, accs + count);
+
+  if (planObject.hcfftSetPlanGPUs(plan, gpus) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtGetGPUBatches()
+Returns the chunk of the batch of a plan each of its accelerators takes
+*/
+hcfftResult hcfftXtGetGPUBatches(hcfftHandle plan, int* batches) {
+  if (batches == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  std::vector<size_t> chunks;
+
+  if (planObject.hcfftGetPlanGPUBatches(plan, chunks) != HCFFT_SUCCEEDS ||
+      chunks.empty()) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  for (size_t i = 0; i < chunks.size(); i++) {
+    batches[i] = static_cast<int>(chunks[i]);
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetLowMemory()
+Transposes large transforms in place instead of through intermediate buffers
+*/
+hcfftResult hcfftXtSetLowMemory(hcfftHandle plan, int lowMemory) {
+  if (planObject.hcfftSetLowMemory(plan, lowMemory != 0) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetHalfStorage()
+Stores the data of a single-precision plan in half precision
+*/
+hcfftResult hcfftXtSetHalfStorage(hcfftHandle plan, int halfStorage) {
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_SINGLE) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (planObject.hcfftSetHalfStorage(plan, halfStorage != 0) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetSingleTwiddles()
+Reads the pass twiddles of double-precision kernels from a float table
+*/
+hcfftResult hcfftXtSetSingleTwiddles(hcfftHandle plan, int singleTwiddles) {
+  if (planObject.hcfftSetSingleTwiddles(plan, singleTwiddles != 0) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetComputedTwiddles()
+Evaluates the twiddles of the 3-step algorithm in the kernels
+*/
+hcfftResult hcfftXtSetComputedTwiddles(hcfftHandle plan, int computedTwiddles) {
+  if (planObject.hcfftSetComputeTwiddles(plan, computedTwiddles != 0) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetHostThreshold()
+Transforms small complex batches in host memory on the host
+*/
+hcfftResult hcfftXtSetHostThreshold(hcfftHandle plan, size_t elements) {
+  if (planObject.hcfftSetHostThreshold(plan, elements) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetHybrid()
+Splits batches in pinned host memory between the GPU and the host
+*/
+hcfftResult hcfftXtSetHybrid(hcfftHandle plan, int hybrid) {
+  if (planObject.hcfftSetHybrid(plan, hybrid != 0) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetAutotune()
+Times the kernel variants of a plan at bake and keeps the fastest
+*/
+hcfftResult hcfftXtSetAutotune(hcfftHandle plan, int autotune) {
+  if (planObject.hcfftSetAutotune(plan, autotune != 0) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftExportWisdom()
+Writes the kernel choices of the autotuner to a file
+*/
+hcfftResult hcfftExportWisdom(const char* path) {
+  if (path == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  switch (FFTRepo::getInstance().exportTunings(path)) {
+    case HCFFT_SUCCEEDS:
+      return HCFFT_SUCCESS;
+
+    case HCFFT_INVALID:
+      return HCFFT_INVALID_VALUE;
+
+    default:
+      return HCFFT_INTERNAL_ERROR;
+  }
+}
+
+/* Function hcfftImportWisdom()
+Merges the kernel choices of a wisdom file into those of the process
+*/
+hcfftResult hcfftImportWisdom(const char* path) {
+  if (path == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  switch (FFTRepo::getInstance().importTunings(path)) {
+    case HCFFT_SUCCEEDS:
+      return HCFFT_SUCCESS;
+
+    case HCFFT_INVALID:
+      return HCFFT_INVALID_VALUE;
+
+    default:
+      return HCFFT_PARSE_ERROR;
+  }
+}
+
+/* Function hcfftSavePlan()
+Writes a baked plan, its kernels and twiddles to a plan file
+*/
+hcfftResult hcfftSavePlan(hcfftHandle plan, const char* path) {
+  if (path == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  planObject.hcfftWaitBakePlan(plan);
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (FFTRepo::getInstance().getPlan(plan, fftPlan, planLock) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  switch (planObject.hcfftSavePlan(plan, path)) {
+    case HCFFT_SUCCEEDS:
+      return HCFFT_SUCCESS;
+
+    case HCFFT_INVALID:
+      return HCFFT_INVALID_VALUE;
+
+    default:
+      return HCFFT_INTERNAL_ERROR;
+  }
+}
+
+/* Function hcfftLoadPlan()
+Creates and bakes a plan from a plan file
+*/
+hcfftResult hcfftLoadPlan(const char* path, hcfftHandle* plan) {
+  if (path == NULL || plan == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPlanHandle handle = 0;
+
+  switch (planObject.hcfftLoadPlan(path, &handle)) {
+    case HCFFT_SUCCEEDS:
+      *plan = handle;
+      return HCFFT_SUCCESS;
+
+    case HCFFT_INVALID:
+      return HCFFT_INVALID_VALUE;
+
+    default:
+      return HCFFT_PARSE_ERROR;
+  }
+}
+
+/* Function hcfftXtSetTransposedOutput()
+Leaves the spectrum of 2D complex plans transposed for the backward pass
+*/
+hcfftResult hcfftXtSetTransposedOutput(hcfftHandle plan, int transposed) {
+  hcfftResTransposed type = transposed ? HCFFT_TRANSPOSED : HCFFT_NOTRANSPOSE;
+
+  if (planObject.hcfftSetPlanTransposeResult(plan, type) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
 /* Function hcfftCreate()
 Creates only an opaque handle, and allocates small data structures on the host.
 */
@@ -167,7 +557,7 @@ hcfftResult hcfftPlan1d(hcfftHandle* plan, int nx, hcfftType type) {
   }
 
   hc::accelerator acc;
-  res = hcfftXtSetGPUs(acc);
+  res = hcfftDefaultGPU(acc);
 
   if (res != HCFFT_SUCCESS) {
     return HCFFT_SETUP_FAILED;
@@ -363,7 +753,7 @@ hcfftResult hcfftPlan2d(hcfftHandle* plan, int nx, int ny, hcfftType type) {
   }
 
   hc::accelerator acc;
-  res = hcfftXtSetGPUs(acc);
+  res = hcfftDefaultGPU(acc);
 
   if (res != HCFFT_SUCCESS) {
     return HCFFT_SETUP_FAILED;
@@ -569,7 +959,7 @@ hcfftResult hcfftPlan3d(hcfftHandle* plan, int nx, int ny, int nz,
   }
 
   hc::accelerator acc;
-  res = hcfftXtSetGPUs(acc);
+  res = hcfftDefaultGPU(acc);
 
   if (res != HCFFT_SUCCESS) {
     return HCFFT_SETUP_FAILED;
@@ -682,21 +1072,772 @@ hcfftResult hcfftPlan3d(hcfftHandle* plan, int nx, int ny, int nz,
   return HCFFT_SUCCESS;
 }
 
-/* Function hcfftDestroy()
-   Description:
-      Frees all GPU resources associated with a hcFFT plan and destroys the
-   internal plan data structure. This function should be called once a plan
-   is no longer needed, to avoid wasting GPU memory.
+/* Function hcfftPlanNd()
+Creates a plan of rank 1 to 6, the lengths from the fastest varying dimension
+*/
+hcfftResult hcfftPlanNd(hcfftHandle* plan, int rank, const int* n,
+                        hcfftType type) {
+  if (n == NULL || rank < HCFFT_1D || rank > HCFFT_6D) {
+    return HCFFT_INVALID_VALUE;
+  }
 
-   Input:
-   -----------------------------------------------------------------------------------------------------
-   plan         The hcfftHandle object of the plan to be destroyed.
+  switch (rank) {
+    case HCFFT_1D:
+      return hcfftPlan1d(plan, n[0], type);
 
-   Return Values:
-   -----------------------------------------------------------------------------------------------------
-   HCFFT_SUCCESS        hcFFT successfully destroyed the FFT plan.
-   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
-*/
+    case HCFFT_2D:
+      return hcfftPlan2d(plan, n[0], n[1], type);
+
+    case HCFFT_3D:
+      return hcfftPlan3d(plan, n[0], n[1], n[2], type);
+  }
+
+  hcfftDim dimension = (hcfftDim)rank;
+  // Check the input type and set appropriate direction and precision
+  hcfftDirection direction;
+  hcfftPrecision precision;
+
+  switch (type) {
+    case HCFFT_R2C:
+      precision = HCFFT_SINGLE;
+      direction = HCFFT_FORWARD;
+      break;
+
+    case HCFFT_C2R:
+      precision = HCFFT_SINGLE;
+      direction = HCFFT_BACKWARD;
+      break;
+
+    case HCFFT_C2C:
+      precision = HCFFT_SINGLE;
+      direction = HCFFT_BOTH;
+      break;
+
+    case HCFFT_D2Z:
+      precision = HCFFT_DOUBLE;
+      direction = HCFFT_FORWARD;
+      break;
+
+    case HCFFT_Z2D:
+      precision = HCFFT_DOUBLE;
+      direction = HCFFT_BACKWARD;
+      break;
+
+    case HCFFT_Z2Z:
+      precision = HCFFT_DOUBLE;
+      direction = HCFFT_BOTH;
+      break;
+
+    default:
+      // Invalid type
+      return HCFFT_INVALID_VALUE;
+  }
+
+  for (int i = 0; i < rank; i++) {
+    if (n[i] < 0) {
+      // invalid size
+      return HCFFT_INVALID_SIZE;
+    }
+  }
+
+  hcfftLibType libType =
+      ((type == HCFFT_R2C || type == HCFFT_D2Z)
+           ? HCFFT_R2CD2Z
+           : (type == HCFFT_C2R || type == HCFFT_Z2D) ? HCFFT_C2RZ2D
+                                                      : HCFFT_C2CZ2Z);
+
+  // The strides of the real data are those of the lengths, and of the
+  // complex data of a real plan those of the first length halved
+  std::vector<size_t> length(n, n + rank);
+  std::vector<size_t> realStrides(rank), complexStrides(rank);
+  size_t realDistance = 1, complexDistance = 1;
+
+  for (int i = 0; i < rank; i++) {
+    realStrides[i] = realDistance;
+    complexStrides[i] = complexDistance;
+    realDistance *= length[i];
+    complexDistance *= (i == 0 && libType != HCFFT_C2CZ2Z)
+                           ? 1 + length[0] / 2
+                           : length[i];
+  }
+
+  std::vector<size_t>& ipStrides =
+      (libType == HCFFT_C2RZ2D) ? complexStrides : realStrides;
+  std::vector<size_t>& opStrides =
+      (libType == HCFFT_R2CD2Z) ? complexStrides : realStrides;
+  size_t ipDistance =
+      (libType == HCFFT_C2RZ2D) ? complexDistance : realDistance;
+  size_t opDistance =
+      (libType == HCFFT_R2CD2Z) ? complexDistance : realDistance;
+
+  // Allocate Rawplan
+  hcfftResult res = hcfftCreate(plan);
+
+  if (res != HCFFT_SUCCESS) {
+    return HCFFT_ALLOC_FAILED;
+  }
+
+  hc::accelerator acc;
+  res = hcfftDefaultGPU(acc);
+
+  if (res != HCFFT_SUCCESS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  hcfftStatus status = planObject.hcfftCreateDefaultPlan(
+      plan, dimension, &length[0], direction, precision, libType);
+
+  if (status == HCFFT_ERROR || status == HCFFT_INVALID) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  // Default options
+  // set certain properties of plan with default values
+  status = planObject.hcfftSetPlanPrecision(*plan, precision);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  status = planObject.hcfftSetPlanTransposeResult(*plan, HCFFT_NOTRANSPOSE);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  status = planObject.hcfftSetResultLocation(*plan, HCFFT_OUTOFPLACE);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  status = planObject.hcfftSetPlanInStride(*plan, dimension, &ipStrides[0]);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  status = planObject.hcfftSetPlanOutStride(*plan, dimension, &opStrides[0]);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  status = planObject.hcfftSetPlanDistance(*plan, ipDistance, opDistance);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  if (libType == HCFFT_C2RZ2D) {
+    status = planObject.hcfftSetPlanScale(*plan, direction, 1.0);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return HCFFT_SETUP_FAILED;
+    }
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftManyStrides()
+Strides and distance of one side of the advanced data layout, whose fastest
+dimension is halved on the complex side of a real transform
+*/
+static hcfftResult hcfftManyStrides(int rank, const long long int* n,
+                                    const long long int* embed,
+                                    long long int stride, long long int dist,
+                                    bool halved, size_t* strides,
+                                    size_t* distance) {
+  // Data without embed sizes is packed
+  if (embed == NULL) {
+    stride = 1;
+  }
+
+  if (stride < 1 || (embed != NULL && dist < 1)) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  size_t pitch = stride;
+
+  for (int i = 0; i < rank; i++) {
+    long long int length = (halved && i == 0) ? n[0] / 2 + 1 : n[i];
+    long long int extent = embed ? embed[i] : length;
+
+    if (extent < length && i < rank - 1) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    strides[i] = pitch;
+    pitch *= extent;
+  }
+
+  *distance = embed ? dist : pitch;
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftPlanMany64()
+Creates a plan of the advanced data layout with 64-bit sizes
+*/
+hcfftResult hcfftPlanMany64(hcfftHandle* plan, int rank, long long int* n,
+                            long long int* inembed, long long int istride,
+                            long long int idist, long long int* onembed,
+                            long long int ostride, long long int odist,
+                            hcfftType type, long long int batch) {
+  if (plan == NULL || n == NULL || rank < HCFFT_1D || rank > HCFFT_6D ||
+      batch < 1) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  int length[HCFFT_6D];
+
+  for (int i = 0; i < rank; i++) {
+    if (n[i] < 1 || n[i] > INT_MAX) {
+      return HCFFT_INVALID_SIZE;
+    }
+
+    length[i] = n[i];
+  }
+
+  bool r2c = (type == HCFFT_R2C || type == HCFFT_D2Z);
+  bool c2r = (type == HCFFT_C2R || type == HCFFT_Z2D);
+  size_t ipStrides[HCFFT_6D], opStrides[HCFFT_6D];
+  size_t ipDistance, opDistance;
+  hcfftResult res = hcfftManyStrides(rank, n, inembed, istride, idist, c2r,
+                                     ipStrides, &ipDistance);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  res = hcfftManyStrides(rank, n, onembed, ostride, odist, r2c, opStrides,
+                         &opDistance);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  res = hcfftPlanNd(plan, rank, length, type);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  hcfftDim dimension = (hcfftDim)rank;
+
+  if (planObject.hcfftSetPlanInStride(*plan, dimension, ipStrides) !=
+          HCFFT_SUCCEEDS ||
+      planObject.hcfftSetPlanOutStride(*plan, dimension, opStrides) !=
+          HCFFT_SUCCEEDS ||
+      planObject.hcfftSetPlanDistance(*plan, ipDistance, opDistance) !=
+          HCFFT_SUCCEEDS ||
+      planObject.hcfftSetPlanBatchSize(*plan, batch) != HCFFT_SUCCEEDS) {
+    hcfftDestroy(*plan);
+    return HCFFT_SETUP_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftPlanMany()
+Creates a plan of the advanced data layout
+*/
+hcfftResult hcfftPlanMany(hcfftHandle* plan, int rank, int* n, int* inembed,
+                          int istride, int idist, int* onembed, int ostride,
+                          int odist, hcfftType type, int batch) {
+  if (n == NULL || rank < HCFFT_1D || rank > HCFFT_6D) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  long long int length[HCFFT_6D], iembed[HCFFT_6D], oembed[HCFFT_6D];
+
+  for (int i = 0; i < rank; i++) {
+    length[i] = n[i];
+    iembed[i] = inembed ? inembed[i] : 0;
+    oembed[i] = onembed ? onembed[i] : 0;
+  }
+
+  return hcfftPlanMany64(plan, rank, length, inembed ? iembed : NULL, istride,
+                         idist, onembed ? oembed : NULL, ostride, odist, type,
+                         batch);
+}
+
+/* Function hcfftEstimatePlan()
+Estimates the memory of a plan created for it and destroys the plan
+*/
+static hcfftResult hcfftEstimatePlan(hcfftHandle plan, size_t* workSize) {
+  hcfftResult res = HCFFT_SUCCESS;
+
+  if (planObject.hcfftEstimateWorkSize(plan, workSize) != HCFFT_SUCCEEDS) {
+    res = HCFFT_SETUP_FAILED;
+  }
+
+  hcfftDestroy(plan);
+  return res;
+}
+
+/* Function hcfftEstimate1d()
+Estimates the memory of a 1D plan without building its kernels
+*/
+hcfftResult hcfftEstimate1d(int nx, hcfftType type, int batch,
+                            size_t* workSize) {
+  if (workSize == NULL || batch < 1) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftHandle plan;
+  hcfftResult res = hcfftPlan1d(&plan, nx, type);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  if (planObject.hcfftSetPlanBatchSize(plan, batch) != HCFFT_SUCCEEDS) {
+    hcfftDestroy(plan);
+    return HCFFT_INVALID_VALUE;
+  }
+
+  return hcfftEstimatePlan(plan, workSize);
+}
+
+/* Function hcfftEstimate2d()
+Estimates the memory of a 2D plan without building its kernels
+*/
+hcfftResult hcfftEstimate2d(int nx, int ny, hcfftType type, size_t* workSize) {
+  if (workSize == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftHandle plan;
+  hcfftResult res = hcfftPlan2d(&plan, nx, ny, type);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  return hcfftEstimatePlan(plan, workSize);
+}
+
+/* Function hcfftEstimate3d()
+Estimates the memory of a 3D plan without building its kernels
+*/
+hcfftResult hcfftEstimate3d(int nx, int ny, int nz, hcfftType type,
+                            size_t* workSize) {
+  if (workSize == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftHandle plan;
+  hcfftResult res = hcfftPlan3d(&plan, nx, ny, nz, type);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  return hcfftEstimatePlan(plan, workSize);
+}
+
+/* Function hcfftEstimateMany()
+Estimates the memory of a plan of the advanced data layout
+*/
+hcfftResult hcfftEstimateMany(int rank, int* n, int* inembed, int istride,
+                              int idist, int* onembed, int ostride, int odist,
+                              hcfftType type, int batch, size_t* workSize) {
+  if (workSize == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftHandle plan;
+  hcfftResult res = hcfftPlanMany(&plan, rank, n, inembed, istride, idist,
+                                  onembed, ostride, odist, type, batch);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  return hcfftEstimatePlan(plan, workSize);
+}
+
+/* Function hcfftDestroy()
+   Description:
+      Frees all GPU resources associated with a hcFFT plan and destroys the
+   internal plan data structure. This function should be called once a plan
+   is no longer needed, to avoid wasting GPU memory.
+
+   Input:
+   -----------------------------------------------------------------------------------------------------
+   plan         The hcfftHandle object of the plan to be destroyed.
+
+   Return Values:
+   -----------------------------------------------------------------------------------------------------
+   HCFFT_SUCCESS        hcFFT successfully destroyed the FFT plan.
+   HCFFT_INVALID_PLAN   The plan parameter is not a valid handle.
+*/
+
+/* Function hcfftBakePlanAsync()
+Generates and compiles the kernels of a plan on a background thread
+*/
+hcfftResult hcfftBakePlanAsync(hcfftHandle plan) {
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (FFTRepo::getInstance().getPlan(plan, fftPlan, planLock) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // Bake the layout that the exec functions of this plan type use
+  hcfftIpLayout ipLayout = HCFFT_COMPLEX_INTERLEAVED;
+  hcfftOpLayout opLayout = HCFFT_COMPLEX_INTERLEAVED;
+
+  if (fftPlan->hcfftlibtype == HCFFT_R2CD2Z) {
+    ipLayout = HCFFT_REAL;
+    opLayout = HCFFT_HERMITIAN_INTERLEAVED;
+  } else if (fftPlan->hcfftlibtype == HCFFT_C2RZ2D) {
+    ipLayout = HCFFT_HERMITIAN_INTERLEAVED;
+    opLayout = HCFFT_REAL;
+  }
+
+  hcfftStatus status = planObject.hcfftSetLayout(plan, ipLayout, opLayout);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  status = planObject.hcfftBakePlanAsync(plan);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftBakePlanWait()
+Waits for a bake started by hcfftBakePlanAsync()
+*/
+hcfftResult hcfftBakePlanWait(hcfftHandle plan) {
+  hcfftStatus status = planObject.hcfftWaitBakePlan(plan);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  } else if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftGetPlanTimings()
+Reports the bake time of a plan and its sub-plans
+*/
+hcfftResult hcfftGetPlanTimings(hcfftHandle plan, hcfftPlanTimings* timings,
+                                int* count) {
+  if (count == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  std::vector<std::pair<size_t, FFTPlanTimings> > report;
+
+  if (planObject.hcfftGetPlanTimings(plan, 0, report) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  for (int i = 0; timings != NULL && i < *count && i < (int)report.size();
+       i++) {
+    const FFTPlanTimings& t = report[i].second;
+    timings[i].depth = report[i].first;
+    timings[i].hasKernel = t.hasKernel;
+    timings[i].cacheHit = t.cacheHit;
+    timings[i].generateTime = t.generate;
+    timings[i].writeTime = t.write;
+    timings[i].compileTime = t.compile;
+    timings[i].loadTime = t.load;
+    timings[i].twiddleTime = t.twiddle;
+    timings[i].allocTime = t.alloc;
+    timings[i].tuneTime = t.tune;
+  }
+
+  *count = report.size();
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftGetPlanInfo()
+Describes a plan and the sub-plans the planner decomposed it into
+*/
+hcfftResult hcfftGetPlanInfo(hcfftHandle plan, hcfftPlanInfo* info,
+                             int* count) {
+  if (count == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before the tree is read
+  planObject.hcfftWaitBakePlan(plan);
+  std::vector<FFTPlanInfo> report;
+
+  if (planObject.hcfftGetPlanInfo(plan, 0, "plan", report) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  for (int i = 0; info != NULL && i < *count && i < (int)report.size(); i++) {
+    const FFTPlanInfo& p = report[i];
+    hcfftPlanInfo& out = info[i];
+    size_t rank = std::min<size_t>(p.length.size(), HCFFT_PLAN_INFO_RANK);
+    memset(&out, 0, sizeof(out));
+    out.depth = p.depth;
+    snprintf(out.role, sizeof(out.role), "%s", p.role.c_str());
+    out.baked = p.baked;
+    out.hasKernel = p.hasKernel;
+    snprintf(out.kernel, sizeof(out.kernel), "%s", GeneratorName(p.gen));
+    out.rank = rank;
+
+    for (size_t d = 0; d < rank; d++) {
+      out.lengths[d] = p.length[d];
+      out.inStrides[d] = d < p.inStride.size() ? p.inStride[d] : 0;
+      out.outStrides[d] = d < p.outStride.size() ? p.outStride[d] : 0;
+    }
+
+    out.inDistance = p.iDist;
+    out.outDistance = p.oDist;
+    out.batch = p.batchSize;
+    out.inplace = (p.location == HCFFT_INPLACE);
+    out.inLayout = p.ipLayout;
+    out.outLayout = p.opLayout;
+    out.large1D = p.large1D;
+    out.large1DXfactor = p.large1D_Xfactor;
+    out.transposeOrder = p.nonSquareKernelOrder;
+    out.RCsimple = p.RCsimple;
+    out.realSpecial = p.realSpecial;
+    out.blockCompute = p.blockCompute;
+    out.bluestein = p.bluestein;
+    out.rader = p.rader;
+    out.scratchBytes = p.scratchBytes;
+    snprintf(out.kernelLibrary, sizeof(out.kernelLibrary), "%s",
+             p.kernellib.c_str());
+  }
+
+  *count = report.size();
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftGetStats()
+Reads the counters of the library as a whole
+*/
+hcfftResult hcfftGetStats(hcfftStats* stats) {
+  if (stats == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  stats->plansCreated = hcfftCounters.plansCreated;
+  stats->plansDestroyed = hcfftCounters.plansDestroyed;
+  stats->memoryCacheHits = hcfftCounters.memoryHits;
+  stats->diskCacheHits = hcfftCounters.diskHits;
+  stats->cacheMisses = hcfftCounters.misses;
+  stats->compiles = hcfftCounters.compiles;
+  stats->compileSeconds = hcfftCounters.compileNanoseconds / 1e9;
+  stats->dlopens = hcfftCounters.dlopens;
+  stats->scratchBytes = hcfftCounters.scratchBytes;
+  stats->twiddleBytes = hcfftCounters.twiddleBytes;
+  stats->execs = hcfftCounters.execs;
+  stats->launches = hcfftCounters.launches;
+  stats->launchesPerExec =
+      stats->execs ? double(stats->launches) / stats->execs : 0;
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetProfiling()
+Times each kernel of the transforms of a plan on the device
+*/
+hcfftResult hcfftXtSetProfiling(hcfftHandle plan, int profile) {
+  if (planObject.hcfftSetPlanProfiling(plan, profile != 0) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtGetProfile()
+Reports the kernels of the last profiled transform of a plan
+*/
+hcfftResult hcfftXtGetProfile(hcfftHandle plan, hcfftXtKernelProfile* profile,
+                              int* count) {
+  if (count == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  std::vector<hcfftKernelProfile> report;
+
+  if (planObject.hcfftGetPlanProfile(plan, report) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  for (int i = 0; profile != NULL && i < *count && i < (int)report.size();
+       i++) {
+    const hcfftKernelProfile& k = report[i];
+    double seconds = k.end - k.start;
+    snprintf(profile[i].role, sizeof(profile[i].role), "%s", k.role.c_str());
+    snprintf(profile[i].kernel, sizeof(profile[i].kernel), "%s",
+             GeneratorName(k.gen));
+    profile[i].bytes = k.bytes;
+    profile[i].flops = k.flops;
+    profile[i].startTime = k.start;
+    profile[i].endTime = k.end;
+    profile[i].bandwidth = seconds > 0 ? k.bytes / seconds / 1e9 : 0;
+    profile[i].gflops = seconds > 0 ? k.flops / seconds / 1e9 : 0;
+  }
+
+  *count = report.size();
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetValidation()
+Checks each transform of a plan against Parseval's theorem on the device
+*/
+hcfftResult hcfftXtSetValidation(hcfftHandle plan, int validate) {
+  if (planObject.hcfftSetPlanValidation(plan, validate != 0) !=
+      HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtGetValidation()
+Reports the Parseval errors of the last validated transform of a plan
+*/
+hcfftResult hcfftXtGetValidation(hcfftHandle plan, double* errors, int* count) {
+  if (count == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  std::vector<double> report;
+
+  if (planObject.hcfftGetPlanValidation(plan, report) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  for (int i = 0; errors != NULL && i < *count && i < (int)report.size();
+       i++) {
+    errors[i] = report[i];
+  }
+
+  *count = report.size();
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetCallback()
+Sets a load or store callback compiled into the kernels of a plan
+*/
+hcfftResult hcfftXtSetCallback(hcfftHandle plan, const char* funcName,
+                               const char* funcString, hcfftXtCallbackType type,
+                               void* callerInfo) {
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (funcName == NULL || funcString == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision cbPrecision;
+  hcfftCallbackType cbType;
+
+  switch (type) {
+    case HCFFT_CB_LD_COMPLEX:
+      cbPrecision = HCFFT_SINGLE;
+      cbType = HCFFT_CALLBACK_LOAD;
+      break;
+
+    case HCFFT_CB_LD_COMPLEX_DOUBLE:
+      cbPrecision = HCFFT_DOUBLE;
+      cbType = HCFFT_CALLBACK_LOAD;
+      break;
+
+    case HCFFT_CB_ST_COMPLEX:
+      cbPrecision = HCFFT_SINGLE;
+      cbType = HCFFT_CALLBACK_STORE;
+      break;
+
+    case HCFFT_CB_ST_COMPLEX_DOUBLE:
+      cbPrecision = HCFFT_DOUBLE;
+      cbType = HCFFT_CALLBACK_STORE;
+      break;
+
+    default:
+      return HCFFT_INVALID_VALUE;
+  }
+
+  if (cbPrecision != precision) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  if (planObject.hcfftSetPlanCallback(plan, funcName, funcString, cbType,
+                                      callerInfo) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetWindow()
+Reads the batches of a 1D real plan as windowed frames iDist apart
+*/
+hcfftResult hcfftXtSetWindow(hcfftHandle plan, const hcfftDoubleReal* window) {
+  if (planObject.hcfftSetPlanWindow(plan, window) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtSetExtent()
+Sets the input or the output extent of a pruned plan
+*/
+static hcfftResult hcfftXtSetExtent(hcfftHandle plan, int rank,
+                                    const int* extent, bool input) {
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (rank < HCFFT_1D || rank > HCFFT_6D) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  size_t sizes[HCFFT_6D];
+
+  for (int i = 0; extent != NULL && i < rank; i++) {
+    if (extent[i] < 1) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    sizes[i] = extent[i];
+  }
+
+  const size_t* set = extent ? sizes : NULL;
+  hcfftStatus status =
+      input ? planObject.hcfftSetPlanInputExtent(plan, rank, set)
+            : planObject.hcfftSetPlanOutputExtent(plan, rank, set);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftXtSetInputExtent(hcfftHandle plan, int rank,
+                                  const int* extent) {
+  return hcfftXtSetExtent(plan, rank, extent, true);
+}
+
+hcfftResult hcfftXtSetOutputExtent(hcfftHandle plan, int rank,
+                                   const int* extent) {
+  return hcfftXtSetExtent(plan, rank, extent, false);
+}
 
 hcfftResult hcfftDestroy(hcfftHandle plan) {
   auto planHandle = plan;
@@ -751,34 +1892,159 @@ hcfftResult hcfftExecR2C(hcfftHandle plan, hcfftReal* idata,
     return HCFFT_INVALID_VALUE;
   }
 
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
   // TODO(Neelakandan): Check validity of plan
   hcfftDirection dir = HCFFT_FORWARD;
   hcfftReal* odataR = (hcfftReal*)odata;
   hcfftStatus status;
 
-  if (idata == odataR) {
-    status = planObject.hcfftSetResultLocation(plan, HCFFT_INPLACE);
+  hcfftResLocation location =
+      (idata == odataR) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  status = planObject.hcfftPrepareExec(plan, location, HCFFT_REAL,
+                                       HCFFT_HERMITIAN_INTERLEAVED);
 
-    if (status != HCFFT_SUCCEEDS) {
-      return HCFFT_SETUP_FAILED;
-    }
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
   }
 
   status =
-      planObject.hcfftSetLayout(plan, HCFFT_REAL, HCFFT_HERMITIAN_INTERLEAVED);
+      planObject.hcfftEnqueueTransform<float>(plan, dir, idata, odataR, NULL);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_SETUP_FAILED;
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftExecD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
+                         hcfftDoubleComplex* odata) {
+  // Nullity check
+  if (idata == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
   }
 
-  status = planObject.hcfftBakePlan(plan);
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  // TODO(Neelakandan): Check validity of plan
+  hcfftDirection dir = HCFFT_FORWARD;
+  hcfftDoubleReal* odataR = (hcfftDoubleReal*)odata;
+  hcfftStatus status;
+
+  hcfftResLocation location =
+      (idata == odataR) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  status = planObject.hcfftPrepareExec(plan, location, HCFFT_REAL,
+                                       HCFFT_HERMITIAN_INTERLEAVED);
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
   }
 
   status =
-      planObject.hcfftEnqueueTransform<float>(plan, dir, idata, odataR, NULL);
+      planObject.hcfftEnqueueTransform<double>(plan, dir, idata, odataR, NULL);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Functions hcfftExecConvolveR2C() and hcfftExecConvolveD2Z()
+Convolve with a filter spectrum through a forward and an inverse transform
+*/
+hcfftResult hcfftExecConvolveR2C(hcfftHandle plan, hcfftReal* idata,
+                                 hcfftComplex* filter, hcfftReal* odata) {
+  // Nullity check
+  if (idata == NULL || filter == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_SINGLE) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueConvolution<float>(
+      plan, idata, (hcfftReal*)filter, odata);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftExecConvolveD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
+                                 hcfftDoubleComplex* filter,
+                                 hcfftDoubleReal* odata) {
+  // Nullity check
+  if (idata == NULL || filter == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_DOUBLE) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueConvolution<double>(
+      plan, idata, (hcfftDoubleReal*)filter, odata);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Functions hcfftExecR2R() and hcfftExecD2D()
+Execute a real-to-real transform through the callbacks of a complex transform
+*/
+hcfftResult hcfftExecR2R(hcfftHandle plan, hcfftReal* idata,
+                         hcfftReal* odata, hcfftR2RKind kind) {
+  // Nullity check
+  if (idata == NULL || odata == NULL || kind < HCFFT_DCT_II ||
+      kind > HCFFT_DST_III) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_SINGLE) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueR2R<float>(
+      plan, static_cast<hcfftRealKind>(kind), idata, odata);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  }
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_EXEC_FAILED;
@@ -787,41 +2053,214 @@ hcfftResult hcfftExecR2C(hcfftHandle plan, hcfftReal* idata,
   return HCFFT_SUCCESS;
 }
 
-hcfftResult hcfftExecD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
-                         hcfftDoubleComplex* odata) {
+hcfftResult hcfftExecD2D(hcfftHandle plan, hcfftDoubleReal* idata,
+                         hcfftDoubleReal* odata, hcfftR2RKind kind) {
+  // Nullity check
+  if (idata == NULL || odata == NULL || kind < HCFFT_DCT_II ||
+      kind > HCFFT_DST_III) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_DOUBLE) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueR2R<double>(
+      plan, static_cast<hcfftRealKind>(kind), idata, odata);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Functions hcfftXtExecHostC2C() and hcfftXtExecHostZ2Z()
+Stream a 3D transform of host data through a bounded amount of device memory
+*/
+hcfftResult hcfftXtExecHostC2C(hcfftHandle plan, hcfftComplex* idata,
+                               hcfftComplex* odata, int direction,
+                               size_t deviceBytes) {
   // Nullity check
   if (idata == NULL || odata == NULL) {
     return HCFFT_INVALID_VALUE;
   }
 
-  // TODO(Neelakandan): Check validity of plan
-  hcfftDirection dir = HCFFT_FORWARD;
-  hcfftDoubleReal* odataR = (hcfftDoubleReal*)odata;
-  hcfftStatus status;
+  hcfftPrecision precision;
 
-  if (idata == odataR) {
-    status = planObject.hcfftSetResultLocation(plan, HCFFT_INPLACE);
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_SINGLE) {
+    return HCFFT_INVALID_PLAN;
+  }
 
-    if (status != HCFFT_SUCCEEDS) {
-      return HCFFT_SETUP_FAILED;
-    }
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueHostTransform<float>(
+      plan, (hcfftDirection)direction, (hcfftReal*)idata, (hcfftReal*)odata,
+      deviceBytes);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_VALUE;
   }
 
-  status =
-      planObject.hcfftSetLayout(plan, HCFFT_REAL, HCFFT_HERMITIAN_INTERLEAVED);
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftXtExecHostZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
+                               hcfftDoubleComplex* odata, int direction,
+                               size_t deviceBytes) {
+  // Nullity check
+  if (idata == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != HCFFT_DOUBLE) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueHostTransform<double>(
+      plan, (hcfftDirection)direction, (hcfftDoubleReal*)idata,
+      (hcfftDoubleReal*)odata, deviceBytes);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_VALUE;
+  }
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_SETUP_FAILED;
+    return HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtExecHostBatch()
+Pipeline the chunks of a batch in host memory through the device
+*/
+hcfftResult hcfftXtExecHostBatch(hcfftHandle plan, void* idata, void* odata,
+                                 int direction, size_t deviceBytes) {
+  // Nullity check
+  if (idata == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status =
+      (precision == HCFFT_DOUBLE)
+          ? planObject.hcfftEnqueueHostBatch<double>(
+                plan, (hcfftDirection)direction, (hcfftDoubleReal*)idata,
+                (hcfftDoubleReal*)odata, deviceBytes)
+          : planObject.hcfftEnqueueHostBatch<float>(
+                plan, (hcfftDirection)direction, (hcfftReal*)idata,
+                (hcfftReal*)odata, deviceBytes);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Functions hcfftXtPlanConvolveStreamR2C() and hcfftXtPlanConvolveStreamD2Z()
+Create a plan convolving a stream of real blocks with a filter
+*/
+template <typename T>
+static hcfftResult hcfftXtPlanConvolveStream(hcfftHandle* plan,
+                                             hcfftPrecision precision,
+                                             int blockLength, const T* filter,
+                                             int filterLength) {
+  // Nullity check
+  if (plan == NULL || filter == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  if (blockLength <= 0 || filterLength <= 0) {
+    return HCFFT_INVALID_SIZE;
   }
 
-  status = planObject.hcfftBakePlan(plan);
+  std::vector<double> taps(filter, filter + filterLength);
+  hcfftStatus status = planObject.hcfftCreateConvolveStream(
+      plan, precision, blockLength, taps);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_SIZE;
+  }
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
   }
 
-  status =
-      planObject.hcfftEnqueueTransform<double>(plan, dir, idata, odataR, NULL);
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftXtPlanConvolveStreamR2C(hcfftHandle* plan, int blockLength,
+                                         hcfftReal* filter,
+                                         int filterLength) {
+  return hcfftXtPlanConvolveStream(plan, HCFFT_SINGLE, blockLength, filter,
+                                   filterLength);
+}
+
+hcfftResult hcfftXtPlanConvolveStreamD2Z(hcfftHandle* plan, int blockLength,
+                                         hcfftDoubleReal* filter,
+                                         int filterLength) {
+  return hcfftXtPlanConvolveStream(plan, HCFFT_DOUBLE, blockLength, filter,
+                                   filterLength);
+}
+
+/* Functions hcfftXtExecConvolveStreamR2C() and hcfftXtExecConvolveStreamD2Z()
+Convolve the next blocks of the stream of a plan, in host memory
+*/
+template <typename T>
+static hcfftResult hcfftXtExecConvolveStream(hcfftHandle plan,
+                                             hcfftPrecision precision,
+                                             T* idata, T* odata, int blocks) {
+  // Nullity check
+  if (idata == NULL || odata == NULL || blocks < 0) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision planPrecision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &planPrecision) !=
+          HCFFT_SUCCEEDS ||
+      planPrecision != precision) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  hcfftStatus status =
+      planObject.hcfftEnqueueConvolveStream<T>(plan, idata, odata, blocks);
+
+  if (status == HCFFT_INVALID) {
+    return HCFFT_INVALID_PLAN;
+  }
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_EXEC_FAILED;
@@ -830,6 +2269,28 @@ hcfftResult hcfftExecD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
   return HCFFT_SUCCESS;
 }
 
+hcfftResult hcfftXtExecConvolveStreamR2C(hcfftHandle plan, hcfftReal* idata,
+                                         hcfftReal* odata, int blocks) {
+  return hcfftXtExecConvolveStream(plan, HCFFT_SINGLE, idata, odata, blocks);
+}
+
+hcfftResult hcfftXtExecConvolveStreamD2Z(hcfftHandle plan,
+                                         hcfftDoubleReal* idata,
+                                         hcfftDoubleReal* odata, int blocks) {
+  return hcfftXtExecConvolveStream(plan, HCFFT_DOUBLE, idata, odata, blocks);
+}
+
+/* Function hcfftXtResetConvolveStream()
+Start the stream of a plan over, as if the samples before it were 0
+*/
+hcfftResult hcfftXtResetConvolveStream(hcfftHandle plan) {
+  if (planObject.hcfftResetConvolveStream(plan) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
 /* Functions hcfftExecC2R() and hcfftExecZ2D()
    Description:
      hcfftExecC2R() (hcfftExecZ2D()) executes a single-precision
@@ -872,27 +2333,17 @@ hcfftResult hcfftExecC2R(hcfftHandle plan, hcfftComplex* idata,
     return HCFFT_INVALID_VALUE;
   }
 
-  // TODO(Neelakandan): Check validity of plan
-  hcfftDirection dir = HCFFT_BACKWARD;
-  hcfftReal* idataR = (hcfftReal*)idata;
-  hcfftStatus status;
-
-  if (idataR == odata) {
-    status = planObject.hcfftSetResultLocation(plan, HCFFT_INPLACE);
-
-    if (status != HCFFT_SUCCEEDS) {
-      return HCFFT_SETUP_FAILED;
-    }
-  }
-
-  status =
-      planObject.hcfftSetLayout(plan, HCFFT_HERMITIAN_INTERLEAVED, HCFFT_REAL);
-
-  if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_SETUP_FAILED;
-  }
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  // TODO(Neelakandan): Check validity of plan
+  hcfftDirection dir = HCFFT_BACKWARD;
+  hcfftReal* idataR = (hcfftReal*)idata;
+  hcfftStatus status;
 
-  status = planObject.hcfftBakePlan(plan);
+  hcfftResLocation location =
+      (idataR == odata) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  status = planObject.hcfftPrepareExec(
+      plan, location, HCFFT_HERMITIAN_INTERLEAVED, HCFFT_REAL);
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
@@ -902,7 +2353,8 @@ hcfftResult hcfftExecC2R(hcfftHandle plan, hcfftComplex* idata,
       planObject.hcfftEnqueueTransform<float>(plan, dir, idataR, odata, NULL);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_EXEC_FAILED;
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
   }
 
   return HCFFT_SUCCESS;
@@ -915,27 +2367,17 @@ hcfftResult hcfftExecZ2D(hcfftHandle plan, hcfftDoubleComplex* idata,
     return HCFFT_INVALID_VALUE;
   }
 
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
   // TODO(Neelakandan): Check validity of plan
   hcfftDirection dir = HCFFT_BACKWARD;
   hcfftDoubleReal* idataR = (hcfftDoubleReal*)idata;
   hcfftStatus status;
 
-  if (idataR == odata) {
-    status = planObject.hcfftSetResultLocation(plan, HCFFT_INPLACE);
-
-    if (status != HCFFT_SUCCEEDS) {
-      return HCFFT_SETUP_FAILED;
-    }
-  }
-
-  status =
-      planObject.hcfftSetLayout(plan, HCFFT_HERMITIAN_INTERLEAVED, HCFFT_REAL);
-
-  if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_SETUP_FAILED;
-  }
-
-  status = planObject.hcfftBakePlan(plan);
+  hcfftResLocation location =
+      (idataR == odata) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  status = planObject.hcfftPrepareExec(
+      plan, location, HCFFT_HERMITIAN_INTERLEAVED, HCFFT_REAL);
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
@@ -945,7 +2387,8 @@ hcfftResult hcfftExecZ2D(hcfftHandle plan, hcfftDoubleComplex* idata,
       planObject.hcfftEnqueueTransform<double>(plan, dir, idataR, odata, NULL);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_EXEC_FAILED;
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
   }
 
   return HCFFT_SUCCESS;
@@ -989,70 +2432,652 @@ hcfftResult hcfftExecC2C(hcfftHandle plan, hcfftComplex* idata,
     return HCFFT_INVALID_VALUE;
   }
 
+  // Small batches in host memory skip the bake and the copies to the GPU
+  if (planObject.hcfftRunsOnHost(plan, idata, odata)) {
+    return planObject.hcfftTransformOnHost<float>(
+               plan, (hcfftDirection)direction, (hcfftReal*)idata,
+               (hcfftReal*)odata) == HCFFT_SUCCEEDS
+               ? HCFFT_SUCCESS
+               : HCFFT_EXEC_FAILED;
+  }
+
+  // Large batches in pinned host memory are shared with the host
+  if (planObject.hcfftRunsHybrid(plan, idata, odata)) {
+    return planObject.hcfftEnqueueHybrid<float>(
+               plan, (hcfftDirection)direction, (hcfftReal*)idata,
+               (hcfftReal*)odata) == HCFFT_SUCCEEDS
+               ? HCFFT_SUCCESS
+               : HCFFT_EXEC_FAILED;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
   // TODO(Neelakandan): Check validity of plan
   hcfftReal* idataR = (hcfftReal*)idata;
   hcfftReal* odataR = (hcfftReal*)odata;
   hcfftStatus status;
 
-  if (idataR == odataR) {
-    status = planObject.hcfftSetResultLocation(plan, HCFFT_INPLACE);
+  hcfftResLocation location =
+      (idataR == odataR) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  status = planObject.hcfftPrepareExec(plan, location, HCFFT_COMPLEX_INTERLEAVED,
+                                       HCFFT_COMPLEX_INTERLEAVED);
 
-    if (status != HCFFT_SUCCEEDS) {
-      return HCFFT_SETUP_FAILED;
-    }
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_SETUP_FAILED;
   }
 
-  status = planObject.hcfftSetLayout(plan, HCFFT_COMPLEX_INTERLEAVED,
-                                     HCFFT_COMPLEX_INTERLEAVED);
+  status = planObject.hcfftEnqueueTransform<float>(
+      plan, (hcfftDirection)direction, idataR, odataR, NULL);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_SETUP_FAILED;
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtExecHalfC2C()
+Transforms half-precision data through the callbacks of a plan with half
+storage
+*/
+hcfftResult hcfftXtExecHalfC2C(hcfftHandle plan, hcfftHalfComplex* idata,
+                               hcfftHalfComplex* odata, int direction) {
+  if (!planObject.hcfftHasHalfStorage(plan)) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // The kernels address elements through the callbacks alone, which read
+  // the pointers as half data
+  return hcfftExecC2C(plan, reinterpret_cast<hcfftComplex*>(idata),
+                      reinterpret_cast<hcfftComplex*>(odata), direction);
+}
+
+/* Functions hcfftXtExecPlanarC2C() and hcfftXtExecPlanarZ2Z()
+Transform split real and imaginary planes through the callbacks of the plan
+*/
+template <typename T>
+static hcfftResult hcfftExecPlanar(hcfftHandle plan, hcfftPrecision expected,
+                                   T* idataRe, T* idataIm, T* odataRe,
+                                   T* odataIm, int direction) {
+  // Nullity check
+  if (idataRe == NULL || idataIm == NULL || odataRe == NULL ||
+      odataIm == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  // Both planes are in place or neither is
+  if ((idataRe == odataRe) != (idataIm == odataIm)) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != expected) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+
+  if (planObject.hcfftSetPlanarStorage(plan, true) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // The kernels see interleaved elements, which the callbacks split
+  hcfftResLocation location =
+      (idataRe == odataRe) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  hcfftStatus status = planObject.hcfftPrepareExec(
+      plan, location, HCFFT_COMPLEX_INTERLEAVED, HCFFT_COMPLEX_INTERLEAVED);
+
+  if (status == HCFFT_SUCCEEDS) {
+    status = planObject.hcfftSetPlanCallbackData(plan, HCFFT_CALLBACK_LOAD,
+                                                 idataIm);
   }
 
-  status = planObject.hcfftBakePlan(plan);
+  if (status == HCFFT_SUCCEEDS) {
+    status = planObject.hcfftSetPlanCallbackData(plan, HCFFT_CALLBACK_STORE,
+                                                 odataIm);
+  }
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
   }
 
-  status = planObject.hcfftEnqueueTransform<float>(
-      plan, (hcfftDirection)direction, idataR, odataR, NULL);
+  status = planObject.hcfftEnqueueTransform<T>(
+      plan, (hcfftDirection)direction, idataRe, odataRe, NULL);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_EXEC_FAILED;
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
   }
 
   return HCFFT_SUCCESS;
 }
 
-hcfftResult hcfftExecZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
-                         hcfftDoubleComplex* odata, int direction) {
+hcfftResult hcfftXtExecPlanarC2C(hcfftHandle plan, hcfftReal* idataRe,
+                                 hcfftReal* idataIm, hcfftReal* odataRe,
+                                 hcfftReal* odataIm, int direction) {
+  return hcfftExecPlanar<float>(plan, HCFFT_SINGLE, idataRe, idataIm, odataRe,
+                                odataIm, direction);
+}
+
+hcfftResult hcfftXtExecPlanarZ2Z(hcfftHandle plan, hcfftDoubleReal* idataRe,
+                                 hcfftDoubleReal* idataIm,
+                                 hcfftDoubleReal* odataRe,
+                                 hcfftDoubleReal* odataIm, int direction) {
+  return hcfftExecPlanar<double>(plan, HCFFT_DOUBLE, idataRe, idataIm, odataRe,
+                                 odataIm, direction);
+}
+
+/* Functions hcfftXtExecMultiC2C() to hcfftXtExecMultiZ2D()
+Transform the chunks of the batch of a plan on each of its accelerators
+*/
+template <typename T, typename I, typename O>
+static hcfftResult hcfftExecMulti(hcfftHandle plan, hcfftPrecision expected,
+                                  hcfftIpLayout iLayout, hcfftOpLayout oLayout,
+                                  I** idata, O** odata, int direction) {
   // Nullity check
   if (idata == NULL || odata == NULL) {
     return HCFFT_INVALID_VALUE;
   }
 
-  // TODO(Neelakandan): Check validity of plan
-  hcfftDoubleReal* idataR = (hcfftDoubleReal*)idata;
-  hcfftDoubleReal* odataR = (hcfftDoubleReal*)odata;
-  hcfftStatus status;
+  hcfftPrecision precision;
+  std::vector<size_t> chunks;
 
-  if (idataR == odataR) {
-    status = planObject.hcfftSetResultLocation(plan, HCFFT_INPLACE);
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != expected ||
+      planObject.hcfftGetPlanGPUBatches(plan, chunks) != HCFFT_SUCCEEDS ||
+      chunks.empty()) {
+    return HCFFT_INVALID_PLAN;
+  }
 
-    if (status != HCFFT_SUCCEEDS) {
+  std::vector<T*> inputs(chunks.size());
+  std::vector<T*> outputs(chunks.size());
+
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (idata[i] == NULL || odata[i] == NULL) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    inputs[i] = reinterpret_cast<T*>(idata[i]);
+    outputs[i] = reinterpret_cast<T*>(odata[i]);
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueMultiTransform<T>(
+      plan, (hcfftDirection)direction, iLayout, oLayout, &inputs[0],
+      &outputs[0]);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftXtExecMultiC2C(hcfftHandle plan, hcfftComplex** idata,
+                                hcfftComplex** odata, int direction) {
+  return hcfftExecMulti<float>(plan, HCFFT_SINGLE, HCFFT_COMPLEX_INTERLEAVED,
+                               HCFFT_COMPLEX_INTERLEAVED, idata, odata,
+                               direction);
+}
+
+hcfftResult hcfftXtExecMultiZ2Z(hcfftHandle plan, hcfftDoubleComplex** idata,
+                                hcfftDoubleComplex** odata, int direction) {
+  return hcfftExecMulti<double>(plan, HCFFT_DOUBLE, HCFFT_COMPLEX_INTERLEAVED,
+                                HCFFT_COMPLEX_INTERLEAVED, idata, odata,
+                                direction);
+}
+
+hcfftResult hcfftXtExecMultiR2C(hcfftHandle plan, hcfftReal** idata,
+                                hcfftComplex** odata) {
+  return hcfftExecMulti<float>(plan, HCFFT_SINGLE, HCFFT_REAL,
+                               HCFFT_HERMITIAN_INTERLEAVED, idata, odata,
+                               HCFFT_FORWARD);
+}
+
+hcfftResult hcfftXtExecMultiD2Z(hcfftHandle plan, hcfftDoubleReal** idata,
+                                hcfftDoubleComplex** odata) {
+  return hcfftExecMulti<double>(plan, HCFFT_DOUBLE, HCFFT_REAL,
+                                HCFFT_HERMITIAN_INTERLEAVED, idata, odata,
+                                HCFFT_FORWARD);
+}
+
+hcfftResult hcfftXtExecMultiC2R(hcfftHandle plan, hcfftComplex** idata,
+                                hcfftReal** odata) {
+  return hcfftExecMulti<float>(plan, HCFFT_SINGLE, HCFFT_HERMITIAN_INTERLEAVED,
+                               HCFFT_REAL, idata, odata, HCFFT_BACKWARD);
+}
+
+hcfftResult hcfftXtExecMultiZ2D(hcfftHandle plan, hcfftDoubleComplex** idata,
+                                hcfftDoubleReal** odata) {
+  return hcfftExecMulti<double>(plan, HCFFT_DOUBLE, HCFFT_HERMITIAN_INTERLEAVED,
+                                HCFFT_REAL, idata, odata, HCFFT_BACKWARD);
+}
+
+/* Functions hcfftXtExecStreamC2C() to hcfftXtExecStreamZ2D()
+Transform on an accelerator_view through the copy of a plan for it
+*/
+template <typename Exec>
+static hcfftResult hcfftExecStream(hcfftHandle plan,
+                                   hc::accelerator_view& stream,
+                                   void* workArea, Exec exec) {
+  hcfftPlanHandle streamPlan = 0;
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (planObject.hcfftGetQueuePlan(plan, stream, &streamPlan) !=
+          HCFFT_SUCCEEDS ||
+      FFTRepo::getInstance().getPlan(streamPlan, fftPlan, planLock) !=
+          HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  // An async bake needs the lock held below
+  planObject.hcfftWaitBakePlan(streamPlan);
+
+  // Calls on the same stream do not swap work areas under each other
+  scopedLock sLock(*planLock, _T(" hcfftExecStream"));
+
+  // The work area is that of this call only, and may be freed after it. A
+  // call without one stops using those of earlier calls.
+  hcfftStatus status =
+      (workArea != NULL)
+          ? planObject.hcfftSetCallWorkArea(streamPlan, workArea)
+          : planObject.hcfftClearWorkArea(streamPlan);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  hcfftResult result = exec(streamPlan);
+  planObject.hcfftSetCallWorkArea(streamPlan, NULL);
+  return result;
+}
+
+hcfftResult hcfftXtExecStreamC2C(hcfftHandle plan, hcfftComplex* idata,
+                                 hcfftComplex* odata, int direction,
+                                 hc::accelerator_view& stream,
+                                 void* workArea) {
+  return hcfftExecStream(plan, stream, workArea, [=](hcfftHandle h) {
+    return hcfftExecC2C(h, idata, odata, direction);
+  });
+}
+
+hcfftResult hcfftXtExecStreamZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
+                                 hcfftDoubleComplex* odata, int direction,
+                                 hc::accelerator_view& stream,
+                                 void* workArea) {
+  return hcfftExecStream(plan, stream, workArea, [=](hcfftHandle h) {
+    return hcfftExecZ2Z(h, idata, odata, direction);
+  });
+}
+
+hcfftResult hcfftXtExecStreamR2C(hcfftHandle plan, hcfftReal* idata,
+                                 hcfftComplex* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea) {
+  return hcfftExecStream(plan, stream, workArea, [=](hcfftHandle h) {
+    return hcfftExecR2C(h, idata, odata);
+  });
+}
+
+hcfftResult hcfftXtExecStreamD2Z(hcfftHandle plan, hcfftDoubleReal* idata,
+                                 hcfftDoubleComplex* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea) {
+  return hcfftExecStream(plan, stream, workArea, [=](hcfftHandle h) {
+    return hcfftExecD2Z(h, idata, odata);
+  });
+}
+
+hcfftResult hcfftXtExecStreamC2R(hcfftHandle plan, hcfftComplex* idata,
+                                 hcfftReal* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea) {
+  return hcfftExecStream(plan, stream, workArea, [=](hcfftHandle h) {
+    return hcfftExecC2R(h, idata, odata);
+  });
+}
+
+hcfftResult hcfftXtExecStreamZ2D(hcfftHandle plan, hcfftDoubleComplex* idata,
+                                 hcfftDoubleReal* odata,
+                                 hc::accelerator_view& stream,
+                                 void* workArea) {
+  return hcfftExecStream(plan, stream, workArea, [=](hcfftHandle h) {
+    return hcfftExecZ2D(h, idata, odata);
+  });
+}
+
+/* Function hcfftXtExecGroup()
+Queues the transforms of several plans, a run of one plan in one launch
+*/
+static hcfftResult hcfftExecMember(hcfftHandle plan, hcfftLibType libType,
+                                   bool dbl, void* idata, void* odata,
+                                   int direction) {
+  switch (libType) {
+    case HCFFT_R2CD2Z:
+      return dbl ? hcfftExecD2Z(plan, (hcfftDoubleReal*)idata,
+                                (hcfftDoubleComplex*)odata)
+                 : hcfftExecR2C(plan, (hcfftReal*)idata, (hcfftComplex*)odata);
+
+    case HCFFT_C2RZ2D:
+      return dbl ? hcfftExecZ2D(plan, (hcfftDoubleComplex*)idata,
+                                (hcfftDoubleReal*)odata)
+                 : hcfftExecC2R(plan, (hcfftComplex*)idata, (hcfftReal*)odata);
+
+    default:
+      return dbl ? hcfftExecZ2Z(plan, (hcfftDoubleComplex*)idata,
+                                (hcfftDoubleComplex*)odata, direction)
+                 : hcfftExecC2C(plan, (hcfftComplex*)idata,
+                                (hcfftComplex*)odata, direction);
+  }
+}
+
+//  Placeness and layouts the exec function of libType gives a plan
+static hcfftStatus hcfftPrepareMember(hcfftHandle plan, hcfftLibType libType,
+                                      void* idata, void* odata) {
+  hcfftIpLayout ipLayout = HCFFT_COMPLEX_INTERLEAVED;
+  hcfftOpLayout opLayout = HCFFT_COMPLEX_INTERLEAVED;
+
+  if (libType == HCFFT_R2CD2Z) {
+    ipLayout = HCFFT_REAL;
+    opLayout = HCFFT_HERMITIAN_INTERLEAVED;
+  } else if (libType == HCFFT_C2RZ2D) {
+    ipLayout = HCFFT_HERMITIAN_INTERLEAVED;
+    opLayout = HCFFT_REAL;
+  }
+
+  hcfftResLocation location =
+      (idata == odata) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  return planObject.hcfftPrepareExec(plan, location, ipLayout, opLayout);
+}
+
+template <typename T>
+static hcfftResult hcfftExecRun(hcfftHandle plan, void* idata, void* odata,
+                                int direction, size_t count) {
+  hcfftStatus status = planObject.hcfftEnqueueRun<T>(
+      plan, (hcfftDirection)direction, (T*)idata, (T*)odata, count);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftXtExecGroup(int count, const hcfftHandle* plans, void** idata,
+                             void** odata, const int* directions) {
+  // Nullity check
+  if (count <= 0 || plans == NULL || idata == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  int i = 0;
+
+  while (i < count) {
+    FFTPlan* fftPlan = NULL;
+    lockRAII* planLock = NULL;
+    hcfftPrecision precision;
+
+    if (FFTRepo::getInstance().getPlan(plans[i], fftPlan, planLock) !=
+            HCFFT_SUCCEEDS ||
+        planObject.hcfftGetPlanPrecision(plans[i], &precision) !=
+            HCFFT_SUCCEEDS) {
+      return HCFFT_INVALID_PLAN;
+    }
+
+    if (idata[i] == NULL || odata[i] == NULL) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    hcfftLibType libType = fftPlan->hcfftlibtype;
+    bool dbl = (precision == HCFFT_DOUBLE);
+    int direction = (directions != NULL) ? directions[i] : HCFFT_FORWARD;
+    int end = i + 1;
+
+    // Transforms in host memory take the paths of their exec function
+    if (end < count && plans[end] == plans[i] &&
+        !planObject.hcfftRunsOnHost(plans[i], idata[i], odata[i]) &&
+        !planObject.hcfftRunsHybrid(plans[i], idata[i], odata[i])) {
+      planObject.hcfftWaitBakePlan(plans[i]);
+      size_t inBytes = 0;
+      size_t outBytes = 0;
+
+      if (hcfftPrepareMember(plans[i], libType, idata[i], odata[i]) !=
+              HCFFT_SUCCEEDS ||
+          planObject.hcfftGetRunSteps(plans[i], &inBytes, &outBytes) !=
+              HCFFT_SUCCEEDS) {
+        return HCFFT_SETUP_FAILED;
+      }
+
+      while (end < count && plans[end] == plans[i] &&
+             (directions == NULL || libType != HCFFT_C2CZ2Z ||
+              directions[end] == direction) &&
+             idata[end] == (char*)idata[end - 1] + inBytes &&
+             odata[end] == (char*)odata[end - 1] + outBytes) {
+        end++;
+      }
+    }
+
+    hcfftResult result =
+        (end - i == 1)
+            ? hcfftExecMember(plans[i], libType, dbl, idata[i], odata[i],
+                              direction)
+            : (dbl ? hcfftExecRun<double>(plans[i], idata[i], odata[i],
+                                          direction, end - i)
+                   : hcfftExecRun<float>(plans[i], idata[i], odata[i],
+                                         direction, end - i));
+
+    if (result != HCFFT_SUCCESS) {
+      return result;
+    }
+
+    i = end;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftXtExecEvents()
+Queues a transform behind blocking markers of a wait-list, and a marker of
+its completion after it
+*/
+hcfftResult hcfftXtExecEvents(hcfftHandle plan, void* idata, void* odata,
+                              int direction, int waitCount,
+                              hc::completion_future* waitList,
+                              hc::completion_future* done) {
+  // Nullity check
+  if (idata == NULL || odata == NULL || waitCount < 0 ||
+      (waitCount > 0 && waitList == NULL)) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  hcfftPrecision precision;
+  hc::accelerator_view acc_view = hc::accelerator().get_default_view();
+
+  if (FFTRepo::getInstance().getPlan(plan, fftPlan, planLock) !=
+          HCFFT_SUCCEEDS ||
+      planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      planObject.hcfftGetAcclView(plan, &acc_view) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  hcfftLibType libType = fftPlan->hcfftlibtype;
+  bool spread = false;
+  {
+    scopedLock sLock(*planLock, _T(" hcfftXtExecEvents"));
+    spread = !fftPlan->gpus.empty();
+  }
+
+  // The accelerators of a plan work on views of their own, which a marker
+  // of acc_view would not hold back
+  if (spread) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  bool hybrid = planObject.hcfftRunsHybrid(plan, idata, odata);
+  bool host = planObject.hcfftRunsOnHost(plan, idata, odata);
+
+  // The bake queues and waits for kernels of its own, which must not be
+  // held back behind the markers
+  if (!host && !hybrid) {
+    planObject.hcfftWaitBakePlan(plan);
+
+    if (hcfftPrepareMember(plan, libType, idata, odata) != HCFFT_SUCCEEDS ||
+        planObject.hcfftBakePlan(plan) != HCFFT_SUCCEEDS) {
       return HCFFT_SETUP_FAILED;
     }
   }
 
-  status = planObject.hcfftSetLayout(plan, HCFFT_COMPLEX_INTERLEAVED,
-                                     HCFFT_COMPLEX_INTERLEAVED);
+  // A transform on the host, or shared with it, starts once the futures are
+  // ready
+  for (int i = 0; i < waitCount; i++) {
+    if (host || hybrid) {
+      waitList[i].wait();
+    } else {
+      acc_view.create_blocking_marker(waitList[i]);
+    }
+  }
+
+  hcfftResult result = hcfftExecMember(plan, libType,
+                                       precision == HCFFT_DOUBLE, idata,
+                                       odata, direction);
+
+  if (result == HCFFT_SUCCESS && done != NULL) {
+    *done = acc_view.create_marker();
+  }
+
+  return result;
+}
+
+/* Function hcfftXtGetGPUVolumeSplit()
+Returns the planes and rows of a volume each accelerator of a plan holds
+*/
+hcfftResult hcfftXtGetGPUVolumeSplit(hcfftHandle plan, int* depths,
+                                     int* rows) {
+  if (depths == NULL || rows == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  std::vector<size_t> planes, pencilRows;
+
+  if (planObject.hcfftGetPlanGPUVolumeSplit(plan, planes, pencilRows) !=
+          HCFFT_SUCCEEDS ||
+      planes.empty()) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  for (size_t i = 0; i < planes.size(); i++) {
+    depths[i] = static_cast<int>(planes[i]);
+    rows[i] = static_cast<int>(pencilRows[i]);
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+/* Functions hcfftXtExecMultiVolumeC2C() and hcfftXtExecMultiVolumeZ2Z()
+Transform a volume split into slabs and pencils across accelerators
+*/
+template <typename T, typename C>
+static hcfftResult hcfftExecMultiVolume(hcfftHandle plan,
+                                        hcfftPrecision expected, C** slabs,
+                                        C** pencils, int direction) {
+  // Nullity check
+  if (slabs == NULL || pencils == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  hcfftPrecision precision;
+  std::vector<size_t> chunks;
+
+  if (planObject.hcfftGetPlanPrecision(plan, &precision) != HCFFT_SUCCEEDS ||
+      precision != expected ||
+      planObject.hcfftGetPlanGPUBatches(plan, chunks) != HCFFT_SUCCEEDS ||
+      chunks.empty()) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  std::vector<T*> slabsR(chunks.size());
+  std::vector<T*> pencilsR(chunks.size());
+
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (slabs[i] == NULL || pencils[i] == NULL || slabs[i] == pencils[i]) {
+      return HCFFT_INVALID_VALUE;
+    }
+
+    slabsR[i] = reinterpret_cast<T*>(slabs[i]);
+    pencilsR[i] = reinterpret_cast<T*>(pencils[i]);
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  hcfftStatus status = planObject.hcfftEnqueueMultiVolume<T>(
+      plan, (hcfftDirection)direction, &slabsR[0], &pencilsR[0]);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_SETUP_FAILED;
+    return HCFFT_EXEC_FAILED;
+  }
+
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftXtExecMultiVolumeC2C(hcfftHandle plan, hcfftComplex** slabs,
+                                      hcfftComplex** pencils, int direction) {
+  return hcfftExecMultiVolume<float>(plan, HCFFT_SINGLE, slabs, pencils,
+                                     direction);
+}
+
+hcfftResult hcfftXtExecMultiVolumeZ2Z(hcfftHandle plan,
+                                      hcfftDoubleComplex** slabs,
+                                      hcfftDoubleComplex** pencils,
+                                      int direction) {
+  return hcfftExecMultiVolume<double>(plan, HCFFT_DOUBLE, slabs, pencils,
+                                      direction);
+}
+
+hcfftResult hcfftExecZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
+                         hcfftDoubleComplex* odata, int direction) {
+  // Nullity check
+  if (idata == NULL || odata == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  // Small batches in host memory skip the bake and the copies to the GPU
+  if (planObject.hcfftRunsOnHost(plan, idata, odata)) {
+    return planObject.hcfftTransformOnHost<double>(
+               plan, (hcfftDirection)direction, (hcfftDoubleReal*)idata,
+               (hcfftDoubleReal*)odata) == HCFFT_SUCCEEDS
+               ? HCFFT_SUCCESS
+               : HCFFT_EXEC_FAILED;
   }
 
-  status = planObject.hcfftBakePlan(plan);
+  // Large batches in pinned host memory are shared with the host
+  if (planObject.hcfftRunsHybrid(plan, idata, odata)) {
+    return planObject.hcfftEnqueueHybrid<double>(
+               plan, (hcfftDirection)direction, (hcfftDoubleReal*)idata,
+               (hcfftDoubleReal*)odata) == HCFFT_SUCCEEDS
+               ? HCFFT_SUCCESS
+               : HCFFT_EXEC_FAILED;
+  }
+
+  // A bake started by hcfftBakePlanAsync finishes before this one starts
+  planObject.hcfftWaitBakePlan(plan);
+  // TODO(Neelakandan): Check validity of plan
+  hcfftDoubleReal* idataR = (hcfftDoubleReal*)idata;
+  hcfftDoubleReal* odataR = (hcfftDoubleReal*)odata;
+  hcfftStatus status;
+
+  hcfftResLocation location =
+      (idataR == odataR) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  status = planObject.hcfftPrepareExec(plan, location, HCFFT_COMPLEX_INTERLEAVED,
+                                       HCFFT_COMPLEX_INTERLEAVED);
 
   if (status != HCFFT_SUCCEEDS) {
     return HCFFT_SETUP_FAILED;
@@ -1062,7 +3087,8 @@ hcfftResult hcfftExecZ2Z(hcfftHandle plan, hcfftDoubleComplex* idata,
       plan, (hcfftDirection)direction, idataR, odataR, NULL);
 
   if (status != HCFFT_SUCCEEDS) {
-    return HCFFT_EXEC_FAILED;
+    return planObject.hcfftNeedsWorkArea(plan) ? HCFFT_NO_WORKSPACE
+                                               : HCFFT_EXEC_FAILED;
   }
 
   return HCFFT_SUCCESS;
@@ -0,0 +1,436 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Distributed 3D transforms on a p1 x p2 grid of ranks, see hcfft_mpi.h.
+//
+// Each exchange moves the rank's pencil from a layout [a][b][c], where c is
+// the axis just transformed and a an axis the exchange leaves alone, to the
+// next pencil, where c is split and b gathered across the ranks of a row or
+// a column of the grid. The pencil is cut into chunks along a: the local
+// transform of chunk i + 1 runs on the GPU while chunk i is packed and its
+// all-to-all is in flight, and a chunk is unpacked two chunks later, when
+// its staging buffers are needed again.
+
+#include "include/hcfft_mpi.h"
+#include "include/hcfftlib.h"
+#include <hc.hpp>
+#include <hc_am.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+struct hcfftMpiPlan_t {
+  hcfftType type;
+  // Column communicator of the first exchange, across the ranks with the
+  // same z block, and row communicator of the second one, across the ranks
+  // with the same x block
+  MPI_Comm colComm;
+  MPI_Comm rowComm;
+  MPI_Datatype element;
+  int p1, p2, r1, r2;
+  size_t n[3];
+  size_t chunks;
+  // Batched 1D plans of the local stages, by length and batch
+  std::map<std::pair<size_t, size_t>, hcfftHandle> plans;
+  hc::accelerator acc;
+  // The y pencil on the GPU, and the next pencil unpacked on the host
+  void* work;
+  std::vector<char> host;
+  std::vector<char> staged;
+  std::vector<char> send[2];
+  std::vector<char> recv[2];
+};
+
+//  Start and length of block k of the n elements split p ways
+static size_t blockStart(size_t n, size_t p, size_t k) {
+  return k * (n / p) + std::min(k, n % p);
+}
+
+static size_t blockSize(size_t n, size_t p, size_t k) {
+  return n / p + (k < n % p ? 1 : 0);
+}
+
+//  An exchange of pencils [na][nb][nc] across the P ranks of comm, after the
+//  transform of c. The output pencil has this rank's block of nc and all of
+//  nbGlobal, laid out [c][a][b] or, with acb, [a][c][b].
+struct hcfftMpiStage {
+  MPI_Comm comm;
+  size_t P, me;
+  size_t na, nb, nbGlobal, nc;
+  bool acb;
+};
+
+static hcfftResult execLocal(hcfftHandle plan, hcfftComplex* data,
+                             int direction) {
+  return hcfftExecC2C(plan, data, data, direction);
+}
+
+static hcfftResult execLocal(hcfftHandle plan, hcfftDoubleComplex* data,
+                             int direction) {
+  return hcfftExecZ2Z(plan, data, data, direction);
+}
+
+static hcfftResult localPlan(hcfftMpiHandle plan, size_t length, size_t batch,
+                             hcfftHandle* local) {
+  std::pair<size_t, size_t> key(length, batch);
+  std::map<std::pair<size_t, size_t>, hcfftHandle>::iterator it =
+      plan->plans.find(key);
+
+  if (it != plan->plans.end()) {
+    *local = it->second;
+    return HCFFT_SUCCESS;
+  }
+
+  int n = static_cast<int>(length);
+  hcfftResult res = hcfftPlanMany(local, 1, &n, NULL, 1, n, NULL, 1, n,
+                                  plan->type, static_cast<int>(batch));
+
+  if (res == HCFFT_SUCCESS) {
+    plan->plans[key] = *local;
+  }
+
+  return res;
+}
+
+//  Unpacks the chunk of rows a0 to a0 + ac received from every rank into the
+//  output pencil
+template <typename C>
+static void unpackChunk(const hcfftMpiStage& stage, const C* recv,
+                        const std::vector<int>& displs, size_t a0, size_t ac,
+                        C* dest) {
+  size_t ncLocal = blockSize(stage.nc, stage.P, stage.me);
+
+  for (size_t q = 0; q < stage.P; q++) {
+    size_t b0 = blockStart(stage.nbGlobal, stage.P, q);
+    size_t bq = blockSize(stage.nbGlobal, stage.P, q);
+    const C* src = recv + displs[q];
+
+    for (size_t a = a0; a < a0 + ac; a++) {
+      for (size_t b = b0; b < b0 + bq; b++) {
+        for (size_t c = 0; c < ncLocal; c++, src++) {
+          size_t row = stage.acb ? a * ncLocal + c : c * stage.na + a;
+          dest[row * stage.nbGlobal + b] = *src;
+        }
+      }
+    }
+  }
+}
+
+//  Transforms the pencil data along c in chunks of a and exchanges each
+//  chunk, leaving the output pencil in dest on the host
+template <typename C>
+static hcfftResult runStage(hcfftMpiHandle plan, const hcfftMpiStage& stage,
+                            C* data, int direction, C* dest) {
+  size_t k = std::min(plan->chunks, stage.na);
+
+  while (stage.na % k) {
+    k--;
+  }
+
+  size_t ac = stage.na / k;
+  size_t chunk = ac * stage.nb * stage.nc;
+  size_t ncLocal = blockSize(stage.nc, stage.P, stage.me);
+  std::vector<int> sendCounts(stage.P), sendDispls(stage.P);
+  std::vector<int> recvCounts(stage.P), recvDispls(stage.P);
+  size_t sent = 0, received = 0;
+
+  for (size_t q = 0; q < stage.P; q++) {
+    sendCounts[q] = ac * stage.nb * blockSize(stage.nc, stage.P, q);
+    recvCounts[q] = ac * blockSize(stage.nbGlobal, stage.P, q) * ncLocal;
+    sendDispls[q] = sent;
+    recvDispls[q] = received;
+    sent += sendCounts[q];
+    received += recvCounts[q];
+  }
+
+  plan->staged.resize(chunk * sizeof(C));
+
+  for (int i = 0; i < 2; i++) {
+    plan->send[i].resize(sent * sizeof(C));
+    plan->recv[i].resize(received * sizeof(C));
+  }
+
+  hcfftHandle local;
+  hcfftResult res = localPlan(plan, stage.nc, ac * stage.nb, &local);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  hc::accelerator_view view = plan->acc.get_default_view();
+  C* staged = reinterpret_cast<C*>(&plan->staged[0]);
+  MPI_Request requests[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+  bool failed = execLocal(local, data, direction) != HCFFT_SUCCESS;
+
+  for (size_t i = 0; i < k; i++) {
+    hcfftSynchronize(local);
+    view.copy(data + i * chunk, staged, chunk * sizeof(C));
+
+    if (i + 1 < k) {
+      failed |= execLocal(local, data + (i + 1) * chunk, direction) !=
+                HCFFT_SUCCESS;
+    }
+
+    C* send = reinterpret_cast<C*>(&plan->send[i % 2][0]);
+    C* recv = reinterpret_cast<C*>(&plan->recv[i % 2][0]);
+
+    if (i >= 2) {
+      MPI_Wait(&requests[i % 2], MPI_STATUS_IGNORE);
+      unpackChunk(stage, recv, recvDispls, (i - 2) * ac, ac, dest);
+    }
+
+    for (size_t q = 0; q < stage.P; q++) {
+      size_t c0 = blockStart(stage.nc, stage.P, q);
+      size_t cq = blockSize(stage.nc, stage.P, q);
+      C* out = send + sendDispls[q];
+
+      for (size_t row = 0; row < ac * stage.nb; row++, out += cq) {
+        memcpy(out, staged + row * stage.nc + c0, cq * sizeof(C));
+      }
+    }
+
+    if (MPI_Ialltoallv(send, &sendCounts[0], &sendDispls[0], plan->element,
+                       recv, &recvCounts[0], &recvDispls[0], plan->element,
+                       stage.comm, &requests[i % 2]) != MPI_SUCCESS) {
+      MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+      return HCFFT_INTERNAL_ERROR;
+    }
+  }
+
+  for (size_t i = k < 2 ? 0 : k - 2; i < k; i++) {
+    MPI_Wait(&requests[i % 2], MPI_STATUS_IGNORE);
+    unpackChunk(stage, reinterpret_cast<C*>(&plan->recv[i % 2][0]),
+                recvDispls, i * ac, ac, dest);
+  }
+
+  return failed ? HCFFT_EXEC_FAILED : HCFFT_SUCCESS;
+}
+
+/* Function hcfftMpiPlan3d()
+Creates a distributed 3D plan on a grid of ranks
+*/
+hcfftResult hcfftMpiPlan3d(hcfftMpiHandle* plan, MPI_Comm comm, int p1, int p2,
+                           int nx, int ny, int nz, hcfftType type) {
+  int size = 0, rank = 0;
+
+  if (plan == NULL || (type != HCFFT_C2C && type != HCFFT_Z2Z) || p1 < 1 ||
+      p2 < 1 || MPI_Comm_size(comm, &size) != MPI_SUCCESS ||
+      size != p1 * p2) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  if (p1 > std::min(nx, ny) || p2 > std::min(ny, nz) || nz < 1) {
+    return HCFFT_INVALID_SIZE;
+  }
+
+  MPI_Comm_rank(comm, &rank);
+  hcfftMpiHandle p = new hcfftMpiPlan_t;
+  p->type = type;
+  p->p1 = p1;
+  p->p2 = p2;
+  p->r1 = rank / p2;
+  p->r2 = rank % p2;
+  p->n[0] = nx;
+  p->n[1] = ny;
+  p->n[2] = nz;
+  p->chunks = 2;
+  MPI_Comm_split(comm, p->r2, p->r1, &p->colComm);
+  MPI_Comm_split(comm, p->r1, p->r2, &p->rowComm);
+  size_t bytes = type == HCFFT_C2C ? sizeof(hcfftComplex)
+                                   : sizeof(hcfftDoubleComplex);
+  MPI_Type_contiguous(bytes, MPI_BYTE, &p->element);
+  MPI_Type_commit(&p->element);
+  size_t xA = nx, yA = blockSize(ny, p1, p->r1), zA = blockSize(nz, p2, p->r2);
+  size_t xB = blockSize(nx, p1, p->r1), yB = blockSize(ny, p2, p->r2);
+  size_t pencil = std::max(xA * yA * zA, xB * yB * nz);
+  size_t yPencil = xB * ny * zA;
+  p->host.resize(std::max(pencil, yPencil) * bytes);
+  p->work = hc::am_alloc(yPencil * bytes, p->acc, 0);
+
+  if (p->work == NULL) {
+    hcfftMpiDestroy(p);
+    return HCFFT_ALLOC_FAILED;
+  }
+
+  *plan = p;
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftMpiSetChunks()
+Sets the number of chunks of each exchange
+*/
+hcfftResult hcfftMpiSetChunks(hcfftMpiHandle plan, int chunks) {
+  if (plan == NULL) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (chunks < 1) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  plan->chunks = chunks;
+  return HCFFT_SUCCESS;
+}
+
+/* Function hcfftMpiGetLocalSize()
+Returns the x and z pencils of the calling rank
+*/
+hcfftResult hcfftMpiGetLocalSize(hcfftMpiHandle plan, int xStart[3],
+                                 int xSize[3], int zStart[3], int zSize[3]) {
+  if (plan == NULL) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (xStart == NULL || xSize == NULL || zStart == NULL || zSize == NULL) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  xStart[0] = 0;
+  xSize[0] = plan->n[0];
+  xStart[1] = blockStart(plan->n[1], plan->p1, plan->r1);
+  xSize[1] = blockSize(plan->n[1], plan->p1, plan->r1);
+  xStart[2] = blockStart(plan->n[2], plan->p2, plan->r2);
+  xSize[2] = blockSize(plan->n[2], plan->p2, plan->r2);
+  zStart[0] = blockStart(plan->n[0], plan->p1, plan->r1);
+  zSize[0] = blockSize(plan->n[0], plan->p1, plan->r1);
+  zStart[1] = blockStart(plan->n[1], plan->p2, plan->r2);
+  zSize[1] = blockSize(plan->n[1], plan->p2, plan->r2);
+  zStart[2] = 0;
+  zSize[2] = plan->n[2];
+  return HCFFT_SUCCESS;
+}
+
+/* Functions hcfftMpiExecC2C() and hcfftMpiExecZ2Z()
+Transform x pencils into z pencils, or back
+*/
+template <typename C>
+static hcfftResult hcfftMpiExec(hcfftMpiHandle plan, hcfftType expected,
+                                C* idata, C* odata, int direction) {
+  if (plan == NULL || plan->type != expected) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  if (idata == NULL || odata == NULL || idata == odata) {
+    return HCFFT_INVALID_VALUE;
+  }
+
+  size_t nx = plan->n[0], ny = plan->n[1], nz = plan->n[2];
+  size_t yA = blockSize(ny, plan->p1, plan->r1);
+  size_t zA = blockSize(nz, plan->p2, plan->r2);
+  size_t xB = blockSize(nx, plan->p1, plan->r1);
+  size_t yB = blockSize(ny, plan->p2, plan->r2);
+  hcfftMpiStage first, second;
+  C* work = static_cast<C*>(plan->work);
+  C* host = reinterpret_cast<C*>(&plan->host[0]);
+  hc::accelerator_view view = plan->acc.get_default_view();
+  size_t length, batch, bytes;
+
+  if (direction == HCFFT_FORWARD) {
+    // x pencil [z][y][x] to y pencil [x][z][y] across the column
+    hcfftMpiStage a = {plan->colComm, (size_t)plan->p1, (size_t)plan->r1,
+                       zA, yA, ny, nx, false};
+    // y pencil [x][z][y] to z pencil [x][y][z] across the row
+    hcfftMpiStage b = {plan->rowComm, (size_t)plan->p2, (size_t)plan->r2,
+                       xB, zA, nz, ny, true};
+    first = a;
+    second = b;
+    length = nz;
+    batch = xB * yB;
+  } else {
+    // z pencil [x][y][z] to y pencil [z][x][y] across the row
+    hcfftMpiStage b = {plan->rowComm, (size_t)plan->p2, (size_t)plan->r2,
+                       xB, yB, ny, nz, false};
+    // y pencil [z][x][y] to x pencil [z][y][x] across the column
+    hcfftMpiStage a = {plan->colComm, (size_t)plan->p1, (size_t)plan->r1,
+                       zA, xB, nx, ny, true};
+    first = b;
+    second = a;
+    length = nx;
+    batch = yA * zA;
+  }
+
+  hcfftResult res = runStage(plan, first, idata, direction, host);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  bytes = xB * ny * zA * sizeof(C);
+  view.copy(host, work, bytes);
+  res = runStage(plan, second, work, direction, host);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  bytes = length * batch * sizeof(C);
+  view.copy(host, odata, bytes);
+  hcfftHandle local;
+  res = localPlan(plan, length, batch, &local);
+
+  if (res != HCFFT_SUCCESS) {
+    return res;
+  }
+
+  if (execLocal(local, odata, direction) != HCFFT_SUCCESS) {
+    return HCFFT_EXEC_FAILED;
+  }
+
+  hcfftSynchronize(local);
+  return HCFFT_SUCCESS;
+}
+
+hcfftResult hcfftMpiExecC2C(hcfftMpiHandle plan, hcfftComplex* idata,
+                            hcfftComplex* odata, int direction) {
+  return hcfftMpiExec(plan, HCFFT_C2C, idata, odata, direction);
+}
+
+hcfftResult hcfftMpiExecZ2Z(hcfftMpiHandle plan, hcfftDoubleComplex* idata,
+                            hcfftDoubleComplex* odata, int direction) {
+  return hcfftMpiExec(plan, HCFFT_Z2Z, idata, odata, direction);
+}
+
+/* Function hcfftMpiDestroy()
+Frees a distributed plan
+*/
+hcfftResult hcfftMpiDestroy(hcfftMpiHandle plan) {
+  if (plan == NULL) {
+    return HCFFT_INVALID_PLAN;
+  }
+
+  std::map<std::pair<size_t, size_t>, hcfftHandle>::iterator it;
+
+  for (it = plan->plans.begin(); it != plan->plans.end(); ++it) {
+    hcfftDestroy(it->second);
+  }
+
+  if (plan->work) {
+    hc::am_free(plan->work);
+  }
+
+  MPI_Type_free(&plan->element);
+  MPI_Comm_free(&plan->colComm);
+  MPI_Comm_free(&plan->rowComm);
+  delete plan;
+  return HCFFT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Check of the distributed transforms of hcfft_mpi, on any number of ranks.
+//
+//   mpiexec -n <ranks> hcfft_mpi_check
+//
+// The ranks form the grid closest to square. Each fills its x pencil of an
+// 8 x 6 x 10 volume, whose lengths split unevenly over most grids, and
+// compares the z pencil of the forward transform with a direct DFT of the
+// whole volume, and the x pencil of the backward transform with the input
+// times the volume. The exit code is 1 when any rank fails.
+
+#include "include/hcfft_mpi.h"
+#include "include/hcfftlib.h"
+#include <hc_am.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <vector>
+
+static const int N[3] = {8, 6, 10};
+
+static std::complex<double> sample(int x, int y, int z) {
+  return std::complex<double>((x + 2 * y + 3 * z) % 7, (x * y + z) % 5);
+}
+
+//  Element (x, y, z) of the forward transform of the volume
+static std::complex<double> spectrum(int x, int y, int z) {
+  const double pi = 3.14159265358979323846;
+  std::complex<double> sum = 0;
+
+  for (int k = 0; k < N[2]; k++) {
+    for (int j = 0; j < N[1]; j++) {
+      for (int i = 0; i < N[0]; i++) {
+        double phase = -2 * pi *
+                       (double(x) * i / N[0] + double(y) * j / N[1] +
+                        double(z) * k / N[2]);
+        sum += sample(i, j, k) *
+               std::complex<double>(std::cos(phase), std::sin(phase));
+      }
+    }
+  }
+
+  return sum;
+}
+
+//  Single precision keeps about 6 digits of sums of a few thousand
+static bool matches(const hcfftComplex& actual,
+                    std::complex<double> expected) {
+  double tolerance = 1e-2 + 1e-5 * std::abs(expected);
+  return std::fabs(actual.x - expected.real()) < tolerance &&
+         std::fabs(actual.y - expected.imag()) < tolerance;
+}
+
+int main(int argc, char* argv[]) {
+  MPI_Init(&argc, &argv);
+  int size = 1, rank = 0;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  int p2 = 1;
+
+  for (int d = 1; d * d <= size; d++) {
+    if (size % d == 0) {
+      p2 = d;
+    }
+  }
+
+  int p1 = size / p2;
+  hcfftMpiHandle plan = NULL;
+  hcfftResult status = hcfftMpiPlan3d(&plan, MPI_COMM_WORLD, p1, p2, N[0],
+                                      N[1], N[2], HCFFT_C2C);
+
+  if (status != HCFFT_SUCCESS) {
+    if (rank == 0) {
+      std::cerr << "hcfft_mpi_check: no plan for a " << p1 << " x " << p2
+                << " grid" << std::endl;
+    }
+
+    MPI_Finalize();
+    return 1;
+  }
+
+  int xStart[3], xSize[3], zStart[3], zSize[3];
+  hcfftMpiGetLocalSize(plan, xStart, xSize, zStart, zSize);
+  size_t xCount = size_t(xSize[0]) * xSize[1] * xSize[2];
+  size_t zCount = size_t(zSize[0]) * zSize[1] * zSize[2];
+  std::vector<hcfftComplex> input(xCount), output(zCount), back(xCount);
+
+  // The x pencil is laid out [z][y][x]
+  for (int k = 0; k < xSize[2]; k++) {
+    for (int j = 0; j < xSize[1]; j++) {
+      for (int i = 0; i < xSize[0]; i++) {
+        std::complex<double> v =
+            sample(xStart[0] + i, xStart[1] + j, xStart[2] + k);
+        size_t at = (size_t(k) * xSize[1] + j) * xSize[0] + i;
+        input[at].x = v.real();
+        input[at].y = v.imag();
+      }
+    }
+  }
+
+  hc::accelerator acc;
+  hc::accelerator_view accl_view = acc.get_default_view();
+  size_t bytes = std::max(xCount, zCount) * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, acc, 0);
+  hcfftComplex* odata = hc::am_alloc(bytes, acc, 0);
+  accl_view.copy(&input[0], idata, xCount * sizeof(hcfftComplex));
+  bool failed = hcfftMpiExecC2C(plan, idata, odata, HCFFT_FORWARD) !=
+                HCFFT_SUCCESS;
+  accl_view.copy(odata, &output[0], zCount * sizeof(hcfftComplex));
+  failed = hcfftMpiExecC2C(plan, odata, idata, HCFFT_BACKWARD) !=
+               HCFFT_SUCCESS ||
+           failed;
+  accl_view.copy(idata, &back[0], xCount * sizeof(hcfftComplex));
+
+  // The z pencil is laid out [x][y][z]
+  for (int i = 0; i < zSize[0]; i++) {
+    for (int j = 0; j < zSize[1]; j++) {
+      for (int k = 0; k < zSize[2]; k++) {
+        size_t at = (size_t(i) * zSize[1] + j) * zSize[2] + k;
+        failed = !matches(output[at], spectrum(zStart[0] + i, zStart[1] + j,
+                                               zStart[2] + k)) ||
+                 failed;
+      }
+    }
+  }
+
+  double volume = double(N[0]) * N[1] * N[2];
+
+  for (size_t at = 0; at < xCount; at++) {
+    std::complex<double> expected(input[at].x * volume, input[at].y * volume);
+    failed = !matches(back[at], expected) || failed;
+  }
+
+  int anyFailed = 0, localFailed = failed ? 1 : 0;
+  MPI_Allreduce(&localFailed, &anyFailed, 1, MPI_INT, MPI_MAX,
+                MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    std::cout << "hcfft_mpi_check: " << p1 << " x " << p2 << " grid "
+              << (anyFailed ? "FAILED" : "passed") << std::endl;
+  }
+
+  hcfftMpiDestroy(plan);
+  hc::am_free(idata);
+  hc::am_free(odata);
+  MPI_Finalize();
+  return anyFailed;
+}
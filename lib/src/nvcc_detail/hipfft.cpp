@@ -288,6 +288,19 @@ hipfftResult hipfftExecZ2D(hipfftHandle plan, hipfftDoubleComplex *idata,
   return hipCUFFTResultToHIPFFTResult(cufftExecZ2D(plan, idata, odata));
 }
 
+hipfftResult hipfftExecPlanarC2C(hipfftHandle plan, hipfftReal *idataRe,
+                                 hipfftReal *idataIm, hipfftReal *odataRe,
+                                 hipfftReal *odataIm, int direction) {
+  return HIPFFT_RESULT_NOT_SUPPORTED;
+}
+
+hipfftResult hipfftExecPlanarZ2Z(hipfftHandle plan, hipfftDoubleReal *idataRe,
+                                 hipfftDoubleReal *idataIm,
+                                 hipfftDoubleReal *odataRe,
+                                 hipfftDoubleReal *odataIm, int direction) {
+  return HIPFFT_RESULT_NOT_SUPPORTED;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,346 +22,1139 @@ THE SOFTWARE.
 
 #include "include/hcfftlib.h"
 #include <dlfcn.h>
+#include <spawn.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <utime.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+extern char** environ;
 
 //  Static initialization of the repo lock variable
 lockRAII FFTRepo::lockRepo(_T( "FFTRepo"));
 
 //  Static initialization of the plan count variable
-size_t FFTRepo::planCount = 1;
-static size_t beforeCompile = 99999999;
-static size_t countKernel, bakedPlanCount;
-static std::string sfilename, skernellib;
-static void* kernelHandle = NULL;
+std::atomic<size_t> FFTRepo::planCount(1);
+
+//  A kernel source written during the current bake and the library it is to
+//  be built into. A kernel another bake of the process is building has no
+//  source, and the bake waits for build instead of owning it.
+struct pendingKernel {
+  std::string key;
+  std::string source;
+  std::string kernellib;
+  FFTPlan* plan;
+  std::shared_ptr<hcfftKernelBuild> build;
+  bool owner;
+
+  pendingKernel() : plan(NULL), owner(true) {}
+};
+
+//  State of the bake of one plan tree. hcfftBakePlan installs one for its
+//  thread with bakeScope, and the bakes of the sub-plans down the tree add to
+//  it, so that bakes of different plans on different threads share nothing
+//  but the locks of FFTRepo and of the kernel cache.
+struct hcfftBakeContext {
+  std::vector<pendingKernel> pendingKernels;
+  //  Library every kernel of the bake is loaded from, by signature. Leaves
+  //  with the same signature are generated and compiled only once.
+  std::map<size_t, std::string> bakedKernels;
+  std::vector<FFTPlan*> bakedPlans;
+  // Sub-plan bakes do not propagate their status, so the first kernel write
+  // failure in a plan tree is recorded here and reported by hcfftBakePlan
+  hcfftStatus kernelStatus;
+  // Names the kernel sources of the bake apart from those that other bakes
+  // of the process write at the same time
+  std::string tag;
+
+  hcfftBakeContext() : kernelStatus(HCFFT_SUCCEEDS) {
+    static std::atomic<size_t> bakes(0);
+    tag = SztToStr(getpid()) + "_" + SztToStr(bakes++);
+  }
 
-bool has_suffix(const std::string& s, const std::string& suffix) {
-  return (s.size() >= suffix.size()) &&
-         equal(suffix.rbegin(), suffix.rend(), s.rbegin());
-}
+  //  Builds claimed by a bake that stopped before building them fail, so
+  //  that the bakes waiting on them do not wait forever
+  ~hcfftBakeContext() {
+    for (size_t i = 0; i < pendingKernels.size(); i++) {
+      if (pendingKernels[i].owner && pendingKernels[i].build) {
+        FFTRepo::getInstance().settleKernelBuild(
+            pendingKernels[i].key, pendingKernels[i].build, HCFFT_ERROR);
+      }
+    }
+  }
+};
 
-bool checkIfsoExist(hcfftDirection direction, hcfftPrecision precision,
-                    std::vector<size_t> originalLength,
-                    hcfftLibType hcfftlibtype) {
-  DIR* d;
-  struct dirent* dir;
-  std::string pwd = getHomeDir();
-  bool soExist = false;
-  pwd += "/kernCache/";
-  d = opendir(pwd.c_str());
+//  The bake in progress on this thread, if any
+static thread_local hcfftBakeContext* sbake = NULL;
 
-  if (d) {
-    while ((dir = readdir(d)) != NULL) {
-      if (has_suffix(dir->d_name, ".so")) {
-        std::string libFile(dir->d_name);
+//  Make a bake the one of this thread until the end of the scope. A bake
+//  started inside another, e.g. of a plan the tree owns, gets its own.
+class bakeScope {
+ public:
+  explicit bakeScope(hcfftBakeContext& bake) : outer(sbake) { sbake = &bake; }
 
-        if (libFile.substr(0, 9) != "libkernel") {
-          continue;
-        }
+  ~bakeScope() { sbake = outer; }
 
-        int i = 0;
-        size_t length = libFile.length();
-        size_t n = std::count(libFile.begin(), libFile.end(), '_');
+ private:
+  hcfftBakeContext* outer;
+};
 
-        if ((n - 1) != originalLength.size()) {
-          continue;
-        }
+thread_local double hcfftTwiddleSeconds = 0;
+hcfftRuntimeCounters hcfftCounters;
 
-        size_t firstocc = libFile.find_first_of("_");
-        std::string type = libFile.substr(9, 4);
-        std::string datatype = libFile.substr(13, 1);
-        std::string libtype = libFile.substr(14, 1);
+//  Device buffers counted in a byte gauge of hcfftCounters
+static void* gaugedAlloc(size_t bytes, hc::accelerator& acc,
+                         std::atomic<size_t>& gauge) {
+  void* ptr = hc::am_alloc(bytes, acc, 0);
 
-        if (!((direction == HCFFT_FORWARD && type == "Frwd") ||
-              (direction == HCFFT_BACKWARD && type == "Back") ||
-              (direction == HCFFT_BOTH))) {
-          continue;
-        }
+  if (ptr != NULL) {
+    gauge += bytes;
+  }
 
-        if (!((datatype == "F" && precision == HCFFT_SINGLE) ||
-              (datatype == "D" && precision == HCFFT_DOUBLE))) {
-          continue;
-        }
+  return ptr;
+}
 
-        if (!((libtype == "1" && hcfftlibtype == HCFFT_R2CD2Z) ||
-              (libtype == "2" && hcfftlibtype == HCFFT_C2RZ2D) ||
-              (libtype == "3" && hcfftlibtype == HCFFT_C2CZ2Z))) {
-          continue;
-        }
+static size_t deviceBytes(const void* ptr) {
+  hc::accelerator acc;
+  hc::AmPointerInfo info(NULL, NULL, 0, acc, false, false);
+  return (hc::am_memtracker_getinfo(&info, ptr) == AM_SUCCESS)
+             ? info._sizeBytes
+             : 0;
+}
 
-        if (firstocc != std::string::npos) {
-          ++firstocc;
-          size_t iter = (libFile.substr(firstocc, length - firstocc)).find("_");
+static am_status_t gaugedFree(void* ptr, std::atomic<size_t>& gauge) {
+  size_t bytes = deviceBytes(ptr);
+  am_status_t status = hc::am_free(ptr);
 
-          while (iter != std::string::npos) {
-            size_t N = (size_t)stoi(libFile.substr(firstocc, iter));
+  if (status == AM_SUCCESS) {
+    gauge -= bytes;
+  }
 
-            if (N != originalLength[i]) {
-              break;
-            }
+  return status;
+}
 
-            i++;
-            firstocc += iter + 1;
-            iter = (libFile.substr(firstocc, length - firstocc)).find("_");
+//  Radices of the passes of a twiddle table, captured by value in its kernel
+struct twiddleRadices {
+  unsigned count;
+  unsigned radix[64];
+};
+
+//  Entry i of a table of radices holds, within the pass of span L in which
+//  it falls, the factor j of the butterfly of k: W_L^(k * j). Phases are
+//  reduced modulo L as integers, so that only angles in [0, 2 pi) are taken
+//  the sine and cosine of.
+template <typename R>
+static void fillTwiddles(hc::accelerator& acc, R* table,
+                         const twiddleRadices radices, size_t entries) {
+  hc::parallel_for_each(
+      acc.get_default_view(), hc::extent<1>(entries),
+      [=](hc::index<1> idx) [[hc]] {
+        uint64_t i = idx[0];
+        uint64_t L = 1;
+
+        for (unsigned p = 0; p < radices.count; p++) {
+          uint64_t r = radices.radix[p];
+          uint64_t span = L;
+          L *= r;
+
+          if (i < span * (r - 1)) {
+            uint64_t phase = ((i / (r - 1)) * (1 + i % (r - 1))) % L;
+            double theta = -6.283185307179586476925286766559 *
+                           static_cast<double>(phase) / static_cast<double>(L);
+            table[2 * idx[0]] = hc::precise_math::cos(theta);
+            table[2 * idx[0] + 1] = hc::precise_math::sin(theta);
+            return;
           }
-        }
 
-        if (i == originalLength.size()) {
-          soExist = true;
-          break;
+          i -= span * (r - 1);
         }
-      }
-    }
+      })
+      .wait();
+}
 
-    if (closedir(d) < 0) {
-      std::cout << " Directory failed to close " << std::endl;
-      return false;
+//  Entry (row, column) of a large table is W_N^(2^(row * TWIDDLE_DEE) *
+//  column), its phase reduced modulo N
+template <typename R>
+static void fillTwiddlesLarge(hc::accelerator& acc, R* table, size_t length,
+                              size_t rows, size_t columns) {
+  uint64_t N = length;
+  uint64_t X = columns;
+  hc::parallel_for_each(
+      acc.get_default_view(), hc::extent<1>(rows * columns),
+      [=](hc::index<1> idx) [[hc]] {
+        uint64_t iY = idx[0] / X;
+        uint64_t iX = idx[0] % X;
+        uint64_t step = (uint64_t(1) << (iY * ARBITRARY::TWIDDLE_DEE)) % N;
+        uint64_t phase = (step * iX) % N;
+        double theta = -6.283185307179586476925286766559 *
+                       static_cast<double>(phase) / static_cast<double>(N);
+        table[2 * idx[0]] = hc::precise_math::cos(theta);
+        table[2 * idx[0] + 1] = hc::precise_math::sin(theta);
+      })
+      .wait();
+}
+
+void hcfftDeviceTwiddles(hc::accelerator& acc, void* table, bool dbl,
+                         const std::vector<size_t>& radices) {
+  twiddleRadices passes;
+  size_t entries = 0;
+  size_t L = 1;
+  assert(radices.size() <= sizeof(passes.radix) / sizeof(passes.radix[0]));
+  passes.count = radices.size();
+
+  for (size_t p = 0; p < radices.size(); p++) {
+    passes.radix[p] = radices[p];
+    entries += L * (radices[p] - 1);
+    L *= radices[p];
+  }
+
+  // A single radix 1 pass has no twiddles to fill
+  if (entries == 0) {
+    return;
+  }
+
+  if (dbl) {
+    fillTwiddles(acc, static_cast<double*>(table), passes, entries);
+  } else {
+    fillTwiddles(acc, static_cast<float*>(table), passes, entries);
+  }
+}
+
+void hcfftDeviceTwiddlesLarge(hc::accelerator& acc, void* table, bool dbl,
+                              size_t length, size_t rows, size_t columns) {
+  if (dbl) {
+    fillTwiddlesLarge(acc, static_cast<double*>(table), length, rows, columns);
+  } else {
+    fillTwiddlesLarge(acc, static_cast<float*>(table), length, rows, columns);
+  }
+}
+
+//  Only the addresses are used: they tag the buffers of a recorded launch
+//  that are the input and output of the transform
+static const char launchInput = 0;
+static const char launchOutput = 0;
+
+static void* launchBuffer(void* recorded, void* input, void* output) {
+  if (recorded == &launchInput) {
+    return input;
+  }
+
+  if (recorded == &launchOutput) {
+    return output;
+  }
+
+  return recorded;
+}
+
+// FNV-1a over the raw bytes of a value. The result only has to be stable
+// across runs of the same library build, not across architectures.
+static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+template <typename T>
+static void hashValue(uint64_t& hash, const T& value) {
+  hashBytes(hash, &value, sizeof(T));
+}
+
+static void hashVector(uint64_t& hash, const std::vector<size_t>& values) {
+  hashValue(hash, values.size());
+
+  for (size_t i = 0; i < values.size(); i++) {
+    hashValue(hash, values[i]);
+  }
+}
+
+//  ISA the kernels are built for. HCC_AMDGPU_TARGET selects the code object
+//  target at compile time, so it takes precedence over the device name.
+std::string getTargetISA(hc::accelerator& acc) {
+  char* target = getenv("HCC_AMDGPU_TARGET");
+
+  if (target != NULL) {
+    return std::string(target);
+  }
+
+  std::wstring desc = acc.get_description();
+  return std::string(desc.begin(), desc.end());
+}
+
+//  Signature of the kernel a leaf plan generates. Everything the generators
+//  read from the plan is hashed: its FFTKernelGenKeyParams, the sizes that
+//  set the launch grid, the generator version and the target ISA. Leaves of
+//  different plans with the same signature generate the same code, so they
+//  share one compiled kernel; the signature also names its entry points.
+//  Stockham kernels compute their grid from the batch at launch, and those
+//  of runtime shape read the strides above the first from their arguments,
+//  so neither is part of their signature.
+size_t getKernelSignature(FFTPlan* fftPlan) {
+  FFTKernelGenKeyParams params;
+  fftPlan->GetKernelGenKey(params);
+  uint64_t hash = 14695981039346656037ULL;
+  hashValue(hash, HCFFT_KERNEL_GEN_VERSION);
+  std::string isa = getTargetISA(fftPlan->acc);
+  hashBytes(hash, isa.c_str(), isa.size());
+  hashValue(hash, fftPlan->gen);
+  hashValue(hash, params.fft_DataDim);
+
+  for (int i = 0; i < 16; i++) {
+    hashValue(hash, params.fft_N[i]);
+
+    if (params.fft_runtimeShape && (i > 0)) {
+      hashValue(hash, params.fft_inStride[i] % 2);
+      hashValue(hash, params.fft_outStride[i] % 2);
+    } else {
+      hashValue(hash, params.fft_inStride[i]);
+      hashValue(hash, params.fft_outStride[i]);
     }
   }
 
-  return soExist;
+  hashValue(hash, params.fft_runtimeShape);
+
+  hashValue(hash, params.fft_placeness);
+  hashValue(hash, params.fft_inputLayout);
+  hashValue(hash, params.fft_outputLayout);
+  hashValue(hash, params.fft_precision);
+  hashValue(hash, params.fft_fwdScale);
+  hashValue(hash, params.fft_backScale);
+  hashValue(hash, params.fft_SIMD);
+  hashValue(hash, params.fft_LDSsize);
+  hashValue(hash, params.fft_R);
+  hashValue(hash, params.fft_MaxRadix);
+  hashValue(hash, params.fft_MaxWorkGroupSize);
+  hashValue(hash, params.fft_LdsComplex);
+  hashValue(hash, params.fft_ldsPadding);
+  hashValue(hash, params.fft_3StepTwiddle);
+  hashValue(hash, params.fft_twiddleFront);
+  hashValue(hash, params.fft_singleTwiddles);
+  hashValue(hash, params.fft_computeTwiddles);
+  hashValue(hash, params.fft_lds2D);
+  hashValue(hash, params.fft_realSpecial);
+  hashValue(hash, params.fft_realSpecial_Nr);
+  hashValue(hash, params.transOutHorizontal);
+  hashValue(hash, params.blockCompute);
+  hashValue(hash, params.blockComputeType);
+  hashValue(hash, params.blockSIMD);
+  hashValue(hash, params.blockLDS);
+  hashValue(hash, params.nonSquareKernelType);
+  hashValue(hash, params.transposeMiniBatchSize);
+  hashValue(hash, params.transposeBatchSize);
+  hashValue(hash, params.nonSquareKernelOrder);
+  hashValue(hash, params.fft_RCsimple);
+  hashValue(hash, params.fft_RCsplit);
+  hashValue(hash, params.limit_LocalMemSize);
+  hashVector(hash, fftPlan->length);
+
+  if (!params.fft_runtimeShape) {
+    hashVector(hash, fftPlan->inStride);
+    hashVector(hash, fftPlan->outStride);
+    hashValue(hash, fftPlan->iDist);
+    hashValue(hash, fftPlan->oDist);
+  }
+
+  if (fftPlan->gen != Stockham) {
+    hashValue(hash, fftPlan->batchSize);
+  }
+
+  hashValue(hash, fftPlan->large1D);
+  hashValue(hash, fftPlan->hcfftlibtype);
+  hashVector(hash, fftPlan->originalLength);
+  hashBytes(hash, fftPlan->loadCallback.funcName.c_str(),
+            fftPlan->loadCallback.funcName.size() + 1);
+  hashBytes(hash, fftPlan->loadCallback.funcString.c_str(),
+            fftPlan->loadCallback.funcString.size() + 1);
+  hashBytes(hash, fftPlan->storeCallback.funcName.c_str(),
+            fftPlan->storeCallback.funcName.size() + 1);
+  hashBytes(hash, fftPlan->storeCallback.funcString.c_str(),
+            fftPlan->storeCallback.funcString.size() + 1);
+  return static_cast<size_t>(hash);
+}
+
+//  Name of a kernel in the prebuilt directory and the JIT cache
+std::string getKernelCacheKey(size_t signature) {
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", (unsigned long long)signature);
+  return std::string(key);
+}
+
+static std::string getKernelLibPath(const std::string& dir,
+                                    const std::string& key) {
+  return dir + "/libkernel_" + key + ".so";
+}
+
+bool checkIfsoExist(const std::string& kernellib) {
+  return access(kernellib.c_str(), F_OK) != -1;
+}
+
+//  Directory of the kernel libraries prebuilt by the hcfft_kernels target.
+//  HCFFT_KERNEL_DIR overrides the default, which is hcfft_kernels/ next to
+//  the installed libhcfft.so.
+std::string getPrebuiltKernelDir() {
+  char* kernelDir = getenv("HCFFT_KERNEL_DIR");
+
+  if (kernelDir != NULL) {
+    return std::string(kernelDir);
+  }
+
+  Dl_info info;
+
+  if (dladdr(reinterpret_cast<void*>(&getPrebuiltKernelDir), &info) == 0 ||
+      info.dli_fname == NULL) {
+    return std::string();
+  }
+
+  std::string lib(info.dli_fname);
+  size_t slash = lib.rfind('/');
+  std::string dir = (slash == std::string::npos) ? "." : lib.substr(0, slash);
+  return dir + "/hcfft_kernels";
 }
 
 /*--------------------------------FFTPlan-------------------------------------*/
 
-//  Read the kernels that this plan uses from file, and store into the plan
-hcfftStatus WriteKernel(const hcfftPlanHandle plHandle,
-                        const hcfftGenerators gen,
+//  Write the generated source of a kernel to its own file
+hcfftStatus WriteKernel(const size_t kernelId, const hcfftGenerators gen,
                         const FFTKernelGenKeyParams& fftParams,
-                        std::string filename, bool writeFlag) {
+                        std::string filename) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   std::string kernel;
-  fftRepo.getProgramCode(gen, plHandle, fftParams, kernel);
+  fftRepo.getProgramCode(gen, kernelId, fftParams, kernel);
   FILE* fp;
-  std::string pwd = getHomeDir();
-  pwd += "/kernCache/";
-  struct stat st = {0};
-
-  if (stat(pwd.c_str(), &st) == -1) {
-    mkdir(pwd.c_str(), 0777);
-  }
-
-  if (writeFlag) {
-    fp = fopen(filename.c_str(), "w");
-
-    if (!fp) {
-      std::cout << " File kernel.cpp open failed for writing " << std::endl;
-      return HCFFT_ERROR;
-    }
-  } else {
-    fp = fopen(filename.c_str(), "a+");
+  fp = fopen(filename.c_str(), "w");
 
-    if (!fp) {
-      std::cout << " File kernel.cpp open failed for writing " << std::endl;
-      return HCFFT_ERROR;
-    }
+  if (!fp) {
+    std::cout << " File " << filename << " open failed for writing "
+              << std::endl;
+    return HCFFT_ERROR;
   }
 
   size_t written = fwrite(kernel.c_str(), kernel.size(), 1, fp);
+  fflush(fp);
+  fclose(fp);
 
   if (!written) {
     std::cout << "Kernel Write Failed " << std::endl;
-    exit(1);
+    return HCFFT_ERROR;
   }
 
-  fflush(fp);
-  fclose(fp);
   return HCFFT_SUCCEEDS;
 }
 
-//  Compile the kernels that this plan uses, and store into the plan
-hcfftStatus CompileKernels(const hcfftPlanHandle plHandle,
-                           const hcfftGenerators gen, FFTPlan* fftPlan,
-                           hcfftPlanHandle plHandleOrigin, bool exist,
-                           std::vector<size_t> originalLength,
-                           hcfftLibType hcfftlibtype) {
+static void makeDirs(const std::string& path);
+
+//  Generate the kernel of a leaf plan, timing the twiddle uploads apart from
+//  the source generation
+static void GenerateKernelTimed(const hcfftPlanHandle plHandle,
+                                FFTPlan* fftPlan, size_t signature) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
+  double twiddleStart = hcfftTwiddleSeconds;
+  double generate = 0;
+  {
+    scopedTimer timer(generate);
+    fftPlan->GenerateKernel(plHandle, fftRepo, signature, fftPlan->exist);
+  }
+  double twiddle = hcfftTwiddleSeconds - twiddleStart;
+  fftPlan->timings.twiddle += twiddle;
+  fftPlan->timings.generate += generate - twiddle;
+  fftPlan->timings.hasKernel = true;
+  fftPlan->timings.cacheHit = fftPlan->exist;
+  fftPlan->SetKernelArgs();
+}
+
+//  Bytes of the twiddle tables the generator of a leaf plan uploads: the
+//  Stockham table of the first length, that of the columns of an LDS 2D
+//  kernel and the table of the 3-step algorithm
+static size_t EstimateTwiddleBytes(FFTPlan* fftPlan) {
   FFTKernelGenKeyParams fftParams;
   fftPlan->GetKernelGenKey(fftParams);
-  // For real transforms we comppile either forward or backward kernel
-  bool r2c_transform = (fftParams.fft_inputLayout == HCFFT_REAL);
-  bool c2r_transform = (fftParams.fft_outputLayout == HCFFT_REAL);
-  bool real_transform = (r2c_transform || c2r_transform);
-  bool h2c = ((fftParams.fft_inputLayout == HCFFT_HERMITIAN_PLANAR) ||
-              (fftParams.fft_inputLayout == HCFFT_HERMITIAN_INTERLEAVED));
-  bool c2h = ((fftParams.fft_outputLayout == HCFFT_HERMITIAN_PLANAR) ||
-              (fftParams.fft_outputLayout == HCFFT_HERMITIAN_INTERLEAVED));
-  bool buildFwdKernel = (gen == Stockham || gen == Transpose_GCN ||
-                         gen == Transpose_SQUARE || gen == Transpose_NONSQUARE)
-                            ? ((!real_transform) || r2c_transform)
-                            : (r2c_transform || c2h) || (!(h2c || c2h));
-  bool buildBwdKernel = (gen == Stockham || gen == Transpose_GCN ||
-                         gen == Transpose_SQUARE || gen == Transpose_NONSQUARE)
-                            ? ((!real_transform) || c2r_transform)
-                            : (c2r_transform || h2c) || (!(h2c || c2h));
-  bool writeFlag = false;
-  std::string type;
-
-  if (buildFwdKernel) {
-    type = "Frwd";
-  }
-
-  if (buildBwdKernel) {
-    type = "Back";
-  }
-
-  if (fftParams.fft_precision == HCFFT_SINGLE) {
-    type += "F";
-  } else {
-    type += "D";
+  size_t elementSize = (fftPlan->precision == HCFFT_DOUBLE)
+                           ? sizeof(hc::short_vector::double_2)
+                           : sizeof(hc::short_vector::float_2);
+  size_t bytes = 0;
+
+  if (fftPlan->gen == Stockham && fftParams.fft_N[0] > 1) {
+    bytes += fftParams.fft_N[0] * (fftParams.fft_singleTwiddles
+                                       ? sizeof(hc::short_vector::float_2)
+                                       : elementSize);
   }
 
-  if (hcfftlibtype == HCFFT_R2CD2Z) {
-    type += "1_";
-  } else if (hcfftlibtype == HCFFT_C2RZ2D) {
-    type += "2_";
-  } else {
-    type += "3_";
-  }
-
-  if (beforeCompile != plHandleOrigin) {
-    fftPlan->filename = getHomeDir();
-    fftPlan->kernellib = fftPlan->filename;
-    fftPlan->filename += "/kernCache/kernel";
-    fftPlan->kernellib += "/kernCache/libkernel";
-    fftPlan->filename += type;
-    fftPlan->kernellib += type;
-
-    for (int i = 0; i < originalLength.size(); i++) {
-      fftPlan->filename += SztToStr(originalLength[i]);
-      fftPlan->kernellib += SztToStr(originalLength[i]);
-      fftPlan->filename += "_";
-      fftPlan->kernellib += "_";
-    }
-
-    fftPlan->filename += ".cpp";
-    fftPlan->kernellib += ".so";
-    sfilename = fftPlan->filename;
-    skernellib = fftPlan->kernellib;
-    beforeCompile = plHandleOrigin;
-    writeFlag = true;
+  if (fftParams.fft_lds2D) {
+    bytes += fftParams.fft_N[1] * elementSize;
+  }
+
+  if (fftParams.fft_3StepTwiddle && !fftParams.fft_computeTwiddles) {
+    size_t large1D = fftParams.fft_realSpecial
+                         ? fftParams.fft_N[0] * fftParams.fft_realSpecial_Nr
+                         : fftParams.fft_N[0] * fftParams.fft_N[1];
+    size_t X = size_t(1) << ARBITRARY::TWIDDLE_DEE;
+    size_t Y = DivRoundingUp<size_t>(CeilPo2(large1D), ARBITRARY::TWIDDLE_DEE);
+    bytes += X * Y * elementSize;
+  }
+
+  return bytes;
+}
+
+//  Sizes DetermineSizes gives the Stockham kernel of a leaf without a tuning
+static hcfftKernelTuning HeuristicTuning(const FFTPlan* fftPlan) {
+  FFTKernelGenKeyParams params;
+  fftPlan->GetKernelGenKey(params);
+  hcfftKernelTuning heuristic;
+  heuristic.workGroupSize = params.fft_SIMD;
+  heuristic.numTrans = (params.fft_SIMD * params.fft_R) / params.fft_N[0];
+  return heuristic;
+}
+
+//  Whether the kernel of a leaf can be generated with tuning: the heuristic
+//  sizes or one of its variants. Tunings of a wisdom file are checked, as
+//  their signature may collide with that of another kernel.
+static bool IsLeafTuning(const FFTPlan* fftPlan,
+                         const hcfftKernelTuning& tuning) {
+  hcfftKernelTuning heuristic = HeuristicTuning(fftPlan);
+
+  if ((tuning.workGroupSize == heuristic.workGroupSize) &&
+      (tuning.numTrans == heuristic.numTrans) && !tuning.ldsComplex) {
+    return true;
+  }
+
+  std::vector<hcfftKernelTuning> candidates;
+  fftPlan->GetTuningCandidates(candidates);
+
+  for (size_t c = 0; c < candidates.size(); c++) {
+    if ((tuning.workGroupSize == candidates[c].workGroupSize) &&
+        (tuning.numTrans == candidates[c].numTrans) &&
+        (tuning.ldsComplex == candidates[c].ldsComplex)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//  Generate the kernel of a leaf plan and queue it for compilation, unless
+//  the same kernel is already loaded for another plan, queued by another leaf
+//  of this tree, prebuilt or cached. hcfftBakePlan builds the queued kernels
+//  once the whole tree has been generated and then loads every leaf's entry
+//  points.
+hcfftStatus BakeKernel(const hcfftPlanHandle plHandle, FFTPlan* fftPlan) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+
+  // Drop the kernel of a previous bake of this plan
+  if (fftPlan->kernelPtr || fftPlan->kernelPtrBack) {
+    fftRepo.releaseKernel(fftPlan->gen, fftPlan->kernelIndex);
+    fftPlan->kernelPtr = NULL;
+    fftPlan->kernelPtrBack = NULL;
+  }
+
+  // A leaf without sizes of its own takes those the autotuner picked for the
+  // kernel the heuristics give it
+  hcfftKernelTuning tuning;
+
+  if ((fftPlan->gen == Stockham) && (fftPlan->tuneWorkGroupSize == 0) &&
+      fftRepo.getTuning(getKernelSignature(fftPlan), tuning) &&
+      IsLeafTuning(fftPlan, tuning)) {
+    fftPlan->tuneWorkGroupSize = tuning.workGroupSize;
+    fftPlan->tuneNumTrans = tuning.numTrans;
+    fftPlan->bLdsComplex = tuning.ldsComplex;
+  }
+
+  // An estimate only needs the size of the twiddle tables
+  if (fftPlan->estimateOnly) {
+    fftPlan->twiddleBytes = EstimateTwiddleBytes(fftPlan);
+    return HCFFT_SUCCEEDS;
+  }
+
+  size_t signature = getKernelSignature(fftPlan);
+  std::string key = getKernelCacheKey(signature);
+  fftPlan->kernelIndex = signature;
+
+  if (fftRepo.acquireKernel(fftPlan->gen, signature, fftPlan->kernellib,
+                            fftPlan->kernelPtr,
+                            fftPlan->kernelPtrBack) == HCFFT_SUCCEEDS) {
+    // Only the twiddles of this plan are left to generate
+    fftPlan->exist = true;
+    hcfftCounters.memoryHits++;
+    GenerateKernelTimed(plHandle, fftPlan, signature);
+    return HCFFT_SUCCEEDS;
+  }
+
+  std::map<size_t, std::string>::iterator queued =
+      sbake->bakedKernels.find(signature);
+
+  if (queued != sbake->bakedKernels.end()) {
+    fftPlan->kernellib = queued->second;
+    fftPlan->exist = true;
+    hcfftCounters.memoryHits++;
   } else {
-    fftPlan->filename = sfilename;
-    fftPlan->kernellib = skernellib;
+    // Prebuilt kernels take precedence over the JIT cache
+    fftPlan->kernellib = getKernelLibPath(getPrebuiltKernelDir(), key);
+    fftPlan->exist = checkIfsoExist(fftPlan->kernellib);
+
+    if (!fftPlan->exist) {
+      fftPlan->kernellib = getKernelLibPath(getKernelCacheDir(), key);
+      fftPlan->exist = checkIfsoExist(fftPlan->kernellib);
+
+      if (fftPlan->exist) {
+        utime(fftPlan->kernellib.c_str(), NULL);
+      }
+    }
+
+    if (fftPlan->exist) {
+      hcfftCounters.diskHits++;
+    } else {
+      hcfftCounters.misses++;
+    }
+
+    sbake->bakedKernels[signature] = fftPlan->kernellib;
+  }
+
+  GenerateKernelTimed(plHandle, fftPlan, signature);
+  sbake->bakedPlans.push_back(fftPlan);
+
+  if (!fftPlan->exist) {
+    pendingKernel kernel;
+    kernel.key = key;
+    kernel.kernellib = fftPlan->kernellib;
+    kernel.plan = fftPlan;
+    kernel.owner = fftRepo.claimKernelBuild(key, kernel.build);
+
+    // Another bake of the process writes and compiles the kernel
+    if (!kernel.owner) {
+      sbake->pendingKernels.push_back(kernel);
+      return HCFFT_SUCCEEDS;
+    }
+
+    // Sources are private to this bake until the library is published
+    kernel.source = getKernelCacheDir();
+    makeDirs(kernel.source);
+    kernel.source += "/kernel_";
+    kernel.source += key;
+    kernel.source += ".";
+    kernel.source += sbake->tag;
+    kernel.source += ".cpp";
+    fftPlan->filename = kernel.source;
+    FFTKernelGenKeyParams fftParams;
+    fftPlan->GetKernelGenKey(fftParams);
+    hcfftStatus status;
+    {
+      scopedTimer timer(fftPlan->timings.write);
+      status = WriteKernel(signature, fftPlan->gen, fftParams, kernel.source);
+    }
+
+    if (status != HCFFT_SUCCEEDS) {
+      fftRepo.settleKernelBuild(key, kernel.build, status);
+      sbake->kernelStatus = status;
+      return status;
+    }
+
+    sbake->pendingKernels.push_back(kernel);
   }
 
-  if (!exist) {
-    WriteKernel(plHandle, gen, fftParams, fftPlan->filename, writeFlag);
-    // Check if the default compiler path exists
-    std::string execCmd;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Run a program without going through a shell and wait for it. If output is
+//  not NULL the child's stdout is captured into it.
+static int runProcess(const std::vector<std::string>& args,
+                      std::string* output) {
+  std::vector<char*> argv;
+
+  for (size_t i = 0; i < args.size(); i++) {
+    argv.push_back(const_cast<char*>(args[i].c_str()));
+  }
+
+  argv.push_back(NULL);
+  int fds[2] = {-1, -1};
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+
+  if (output) {
+    if (pipe(fds) != 0) {
+      posix_spawn_file_actions_destroy(&actions);
+      return -1;
+    }
+
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+  }
+
+  pid_t pid;
+  int ret = posix_spawn(&pid, argv[0], &actions, NULL, &argv[0], environ);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if (output) {
+    close(fds[1]);
+
+    if (ret == 0) {
+      char buf[256];
+      ssize_t n;
+
+      while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+        output->append(buf, n);
+      }
+    }
+
+    close(fds[0]);
+  }
+
+  if (ret != 0) {
+    return -1;
+  }
+
+  int wstatus = 0;
+
+  if (waitpid(pid, &wstatus, 0) == -1) {
+    return -1;
+  }
+
+  return (WIFEXITED(wstatus)) ? WEXITSTATUS(wstatus) : -1;
+}
+
+static void splitFlags(const std::string& flags,
+                       std::vector<std::string>& args) {
+  std::stringstream ss(flags);
+  std::string flag;
+
+  while (ss >> flag) {
+    args.push_back(flag);
+  }
+}
+
+//  Locate hcc and query its compile and link flags. The flags are cached so
+//  hcc-config runs only once per process.
+static hcfftStatus getCompilerCommands(std::vector<std::string>& compileCmd,
+                                       std::vector<std::string>& linkCmd) {
+  static std::string hcc, cxxflags, ldflags;
+  static bool queried = false;
+  // Bakes on several threads may query at once
+  static lockRAII queryLock(_T("getCompilerCommands"));
+  scopedLock sLock(queryLock, _T("getCompilerCommands"));
+
+  if (!queried) {
+    std::string Path;
     char fname[256] = "/opt/rocm/hcc/bin/hcc";
 
     if (access(getenv("HCC_HOME"), F_OK) != -1) {
       // TODO(Neelakandan): This path shall be removed. User shall build from
       // default path compiler doesn't exist in default path
       // check if user has specified compiler build path
-      // build_mode = true;
-      char* compilerPath = getenv("HCC_HOME");
-      std::string Path(compilerPath);
+      Path = getenv("HCC_HOME");
       Path.append("/bin/");
-      execCmd = Path + "hcc `" + Path +
-                "hcc-config --install --cxxflags --ldflags --shared` "
-                "-Wno-unused-command-line-argument -lhc_am " +
-                fftPlan->filename + " -o " + fftPlan->kernellib;
+      ldflags = "-lhc_am ";
     } else if (access(fname, F_OK) != -1) {
       // compiler exists
-      // install_mode = true;
-      std::string Path = "/opt/rocm/hcc/bin/";
-      execCmd = Path + "hcc `" + Path +
-                "hcc-config --install --cxxflags --ldflags --shared` "
-                "-Wno-unused-command-line-argument " +
-                fftPlan->filename + " -o " + fftPlan->kernellib;
+      Path = "/opt/rocm/hcc/bin/";
     } else {
       // No compiler found
       std::cout << "HCC compiler not found" << std::endl;
       return HCFFT_INVALID;
     }
 
-    system(execCmd.c_str());
-  }
+    std::vector<std::string> args;
+    args.push_back(Path + "hcc-config");
+    args.push_back("--install");
+    args.push_back("--cxxflags");
 
-  // get a kernel object handle for a kernel with the given name
-  if (buildFwdKernel) {
-    std::string entryPoint;
-    fftRepo.getProgramEntryPoint(gen, plHandle, fftParams, HCFFT_FORWARD,
-                                 entryPoint);
-  }
+    if (runProcess(args, &cxxflags) != 0) {
+      std::cout << "hcc-config failed" << std::endl;
+      return HCFFT_INVALID;
+    }
+
+    args.pop_back();
+    args.push_back("--ldflags");
+    args.push_back("--shared");
+
+    if (runProcess(args, &ldflags) != 0) {
+      std::cout << "hcc-config failed" << std::endl;
+      return HCFFT_INVALID;
+    }
 
-  if (buildBwdKernel) {
-    std::string entryPoint;
-    fftRepo.getProgramEntryPoint(gen, plHandle, fftParams, HCFFT_BACKWARD,
-                                 entryPoint);
+    hcc = Path + "hcc";
+    queried = true;
   }
 
+  compileCmd.push_back(hcc);
+  splitFlags(cxxflags, compileCmd);
+  compileCmd.push_back("-fPIC");
+  compileCmd.push_back("-Wno-unused-command-line-argument");
+  compileCmd.push_back("-c");
+  linkCmd.push_back(hcc);
+  splitFlags(ldflags, linkCmd);
   return HCFFT_SUCCEEDS;
 }
 
-//  This routine will query the OpenCL context for it's devices
-//  and their hardware limitations, which we synthesize into a
-//  hardware "envelope".
-//  We only query the devices the first time we're called after
-//  the object's context is set.  On 2nd and subsequent calls,
-//  we just return the pointer.
-//
-hcfftStatus FFTPlan::SetEnvelope() {
-  // TODO(Neelakandan):  The caller has already acquired the lock on *this
-  //  However, we shouldn't depend on it.
-  envelope.limit_LocalMemSize = 32768;
-  envelope.limit_WorkGroupSize = 256;
-  envelope.limit_Dimensions = 3;
-
-  for (int i = 0; i < envelope.limit_Dimensions; i++) {
-    envelope.limit_Size[i] = 256;
+static void makeDirs(const std::string& path) {
+  for (size_t pos = path.find('/', 1); pos != std::string::npos;
+       pos = path.find('/', pos + 1)) {
+    mkdir(path.substr(0, pos).c_str(), 0755);
   }
 
-  return HCFFT_SUCCEEDS;
+  mkdir(path.c_str(), 0755);
 }
 
-hcfftStatus FFTPlan::GetEnvelope(const FFTEnvelope** ppEnvelope) const {
-  *ppEnvelope = &envelope;
-  return HCFFT_SUCCEEDS;
-}
+//  Take the advisory lock of a cache key. Only one process compiles a given
+//  key; the others block here until the library has been published.
+static int lockCacheKey(const std::string& cacheDir, const std::string& key) {
+  std::string lockfile = cacheDir + "/libkernel_" + key + ".lock";
+  int fd = open(lockfile.c_str(), O_RDWR | O_CREAT, 0644);
 
-hcfftStatus hcfftCreateDefaultPlanInternal(hcfftPlanHandle* plHandle,
-                                           hcfftDim dimension,
-                                           const size_t* length) {
-  if (length == NULL) {
-    return HCFFT_ERROR;
+  if (fd == -1) {
+    return -1;
   }
 
-  size_t lenX = 1, lenY = 1, lenZ = 1;
+  while (flock(fd, LOCK_EX) == -1) {
+    if (errno != EINTR) {
+      close(fd);
+      return -1;
+    }
+  }
 
-  switch (dimension) {
-    case HCFFT_1D: {
-      if (length[0] == 0) {
-        return HCFFT_ERROR;
-      }
+  return fd;
+}
 
-      lenX = length[0];
-    } break;
+static void unlockCacheKey(int fd) {
+  if (fd != -1) {
+    flock(fd, LOCK_UN);
+    close(fd);
+  }
+}
 
-    case HCFFT_2D: {
-      if (length[0] == 0 || length[1] == 0) {
-        return HCFFT_ERROR;
+//  Compile a kernel source and link it into its own library. Holding the
+//  lock of the key makes this single-flight across processes: one that waited
+//  finds the library published and skips the compilation.
+static hcfftStatus BuildKernel(const std::vector<std::string>& compileCmd,
+                               const std::vector<std::string>& linkCmd,
+                               const pendingKernel& kernel, double& compile) {
+  std::string cacheDir =
+      kernel.kernellib.substr(0, kernel.kernellib.rfind('/'));
+  std::string object = kernel.source.substr(0, kernel.source.rfind('.')) + ".o";
+  hcfftStatus status = HCFFT_SUCCEEDS;
+  int lockfd = lockCacheKey(cacheDir, kernel.key);
+
+  if (!checkIfsoExist(kernel.kernellib)) {
+    HCFFT_TRACE_RANGE("hcfft plan " << kernel.plan->plHandleOrigin
+                                    << " compile " << kernel.key);
+    scopedTimer timer(compile);
+    hcfftCounters.compiles++;
+    std::vector<std::string> args(compileCmd);
+    args.push_back(kernel.source);
+    args.push_back("-o");
+    args.push_back(object);
+
+    if (runProcess(args, NULL) != 0) {
+      std::cout << "Kernel compilation failed: " << kernel.source << std::endl;
+      status = HCFFT_ERROR;
+    } else {
+      // Link under a private name and rename into place, so that no process
+      // ever dlopens a partially written library
+      std::string tmplib =
+          kernel.kernellib + "." + SztToStr(getpid()) + ".tmp";
+      args = linkCmd;
+      args.push_back(object);
+      args.push_back("-o");
+      args.push_back(tmplib);
+
+      if (runProcess(args, NULL) != 0 ||
+          rename(tmplib.c_str(), kernel.kernellib.c_str()) != 0) {
+        std::cout << "Kernel link failed: " << kernel.kernellib << std::endl;
+        remove(tmplib.c_str());
+        status = HCFFT_ERROR;
       }
+    }
+  }
 
-      lenX = length[0];
-      lenY = length[1];
-    } break;
+  hcfftCounters.compileNanoseconds += (unsigned long long)(compile * 1e9);
+  unlockCacheKey(lockfd);
+  remove(kernel.source.c_str());
+  remove(object.c_str());
+  return status;
+}
 
-    case HCFFT_3D: {
-      if (length[0] == 0 || length[1] == 0 || length[2] == 0) {
-        return HCFFT_ERROR;
-      }
+//  Build the queued kernels concurrently on a bounded pool of threads.
+//  HCFFT_COMPILE_THREADS caps the pool size, which otherwise follows the
+//  number of hardware threads. The variants the autotuner builds for one
+//  plan share its timings, so compile times are added once the pool is done.
+//  Kernels other bakes of the process are building are waited for only
+//  once the own builds are settled, so that two bakes waiting on each other
+//  always make progress.
+hcfftStatus BuildKernelLibraries(const std::vector<pendingKernel>& kernels) {
+  if (kernels.empty()) {
+    return HCFFT_SUCCEEDS;
+  }
 
-      lenX = length[0];
-      lenY = length[1];
+  std::vector<std::string> compileCmd, linkCmd;
+  hcfftStatus status = getCompilerCommands(compileCmd, linkCmd);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  std::vector<size_t> owned;
+
+  for (size_t i = 0; i < kernels.size(); i++) {
+    if (kernels[i].owner) {
+      owned.push_back(i);
+    }
+  }
+
+  std::vector<hcfftStatus> results(kernels.size(), HCFFT_ERROR);
+  std::vector<double> compile(kernels.size(), 0);
+  size_t numThreads = std::thread::hardware_concurrency();
+  char* threads = getenv("HCFFT_COMPILE_THREADS");
+
+  if (threads != NULL && atoi(threads) > 0) {
+    numThreads = atoi(threads);
+  }
+
+  numThreads = std::max<size_t>(1, std::min(numThreads, owned.size()));
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> pool;
+
+  for (size_t t = 0; t < numThreads; t++) {
+    pool.push_back(std::thread([&]() {
+      size_t n;
+
+      while ((n = next++) < owned.size()) {
+        size_t i = owned[n];
+        results[i] = BuildKernel(compileCmd, linkCmd, kernels[i], compile[i]);
+
+        if (kernels[i].build) {
+          fftRepo.settleKernelBuild(kernels[i].key, kernels[i].build,
+                                    results[i]);
+        }
+      }
+    }));
+  }
+
+  for (size_t t = 0; t < pool.size(); t++) {
+    pool[t].join();
+  }
+
+  for (size_t i = 0; i < kernels.size(); i++) {
+    if (!kernels[i].owner) {
+      results[i] = (kernels[i].build->result.get() == HCFFT_SUCCEEDS &&
+                    checkIfsoExist(kernels[i].kernellib))
+                       ? HCFFT_SUCCEEDS
+                       : HCFFT_ERROR;
+    }
+  }
+
+  for (size_t i = 0; i < kernels.size(); i++) {
+    kernels[i].plan->timings.compile += compile[i];
+
+    if (results[i] != HCFFT_SUCCEEDS) {
+      status = HCFFT_ERROR;
+    }
+  }
+
+  return status;
+}
+
+//  Keep the cache under HCFFT_CACHE_SIZE bytes (1 GiB by default) by removing
+//  the least recently used libraries. Hits refresh the mtime of a library, so
+//  mtime orders entries by last use. Libraries that are already loaded stay
+//  mapped after their file is removed.
+static void evictKernelCache(const std::string& cacheDir) {
+  size_t budget = 1UL << 30;
+  char* size = getenv("HCFFT_CACHE_SIZE");
+
+  if (size != NULL && strtoull(size, NULL, 10) > 0) {
+    budget = strtoull(size, NULL, 10);
+  }
+
+  DIR* d = opendir(cacheDir.c_str());
+
+  if (!d) {
+    return;
+  }
+
+  std::vector<std::pair<time_t, std::pair<std::string, size_t> > > entries;
+  size_t total = 0;
+  struct dirent* dir;
+
+  while ((dir = readdir(d)) != NULL) {
+    std::string name(dir->d_name);
+
+    if (name.compare(0, 10, "libkernel_") != 0 || name.size() < 3 ||
+        name.compare(name.size() - 3, 3, ".so") != 0) {
+      continue;
+    }
+
+    std::string path = cacheDir + "/" + name;
+    struct stat st;
+
+    if (stat(path.c_str(), &st) == 0) {
+      entries.push_back(std::make_pair(
+          st.st_mtime, std::make_pair(path, (size_t)st.st_size)));
+      total += st.st_size;
+    }
+  }
+
+  closedir(d);
+  std::sort(entries.begin(), entries.end());
+
+  for (size_t i = 0; i < entries.size() && total > budget; i++) {
+    if (remove(entries[i].second.first.c_str()) == 0) {
+      total -= entries[i].second.second;
+    }
+  }
+}
+
+//  Load the entry points of a leaf plan from its kernel library. Kernels are
+//  named after the generator and their signature; real transforms only carry
+//  one direction, which leaves the other NULL.
+hcfftStatus ResolveKernels(FFTPlan* fftPlan) {
+  FFTKernelGenKeyParams fftParams;
+  fftPlan->GetKernelGenKey(fftParams);
+  std::string fwdName, backName;
+
+  switch (fftPlan->gen) {
+    case Copy: {
+      bool h2c = ((fftPlan->ipLayout == HCFFT_HERMITIAN_PLANAR) ||
+                  (fftPlan->ipLayout == HCFFT_HERMITIAN_INTERLEAVED));
+      fwdName = h2c ? "copy_h2c" : "copy_c2h";
+      backName = fwdName;
+    } break;
+
+    case Stockham:
+      fwdName = "fft_fwd";
+      backName = "fft_back";
+      break;
+
+    case Transpose_GCN:
+      fwdName = fftParams.fft_3StepTwiddle ? "transpose_gcn_tw_fwd"
+                                           : "transpose_gcn";
+      backName = fwdName;
+      break;
+
+    case Transpose_SQUARE:
+      fwdName = fftParams.fft_3StepTwiddle ? "transpose_square_tw_fwd"
+                                           : "transpose_square";
+      backName = fwdName;
+      break;
+
+    case Transpose_NONSQUARE:
+      fwdName = "transpose_nonsquare";
+
+      if (fftParams.nonSquareKernelType ==
+              NON_SQUARE_TRANS_TRANSPOSE_BATCHED_LEADING &&
+          fftParams.fft_3StepTwiddle) {
+        fwdName = "transpose_nonsquare_tw_fwd";
+      } else if (fftParams.nonSquareKernelType ==
+                 NON_SQUARE_TRANS_TRANSPOSE_BATCHED) {
+        fwdName = "transpose_square";
+      }
+
+      backName = fwdName;
+      break;
+
+    default:
+      return HCFFT_ERROR;
+  }
+
+  fwdName += SztToStr(fftPlan->kernelIndex);
+  backName += SztToStr(fftPlan->kernelIndex);
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  scopedTimer timer(fftPlan->timings.load);
+  return fftRepo.loadKernel(fftPlan->gen, fftPlan->kernelIndex,
+                            fftPlan->kernellib, fwdName, backName,
+                            fftPlan->kernelPtr, fftPlan->kernelPtrBack);
+}
+
+//  This routine will query the OpenCL context for it's devices
+//  and their hardware limitations, which we synthesize into a
+//  hardware "envelope".
+//  We only query the devices the first time we're called after
+//  the object's context is set.  On 2nd and subsequent calls,
+//  we just return the pointer.
+//
+hcfftStatus FFTPlan::SetEnvelope() {
+  // TODO(Neelakandan):  The caller has already acquired the lock on *this
+  //  However, we shouldn't depend on it.
+  //  The tile_static memory is that of the accelerator of the plan. hc has
+  //  no query for the largest tile, and the generators are tuned for 256
+  //  work-items, which every target supports.
+  size_t lds = acc.get_max_tile_static_size();
+  envelope.limit_LocalMemSize = (lds != 0) ? lds : 32768;
+  envelope.limit_WorkGroupSize = 256;
+  envelope.limit_Dimensions = 3;
+
+  for (int i = 0; i < envelope.limit_Dimensions; i++) {
+    envelope.limit_Size[i] = 256;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::GetEnvelope(const FFTEnvelope** ppEnvelope) const {
+  *ppEnvelope = &envelope;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus hcfftCreateDefaultPlanInternal(hcfftPlanHandle* plHandle,
+                                           hcfftDim dimension,
+                                           const size_t* length) {
+  if (length == NULL) {
+    return HCFFT_ERROR;
+  }
+
+  size_t lenX = 1, lenY = 1, lenZ = 1;
+  size_t total = 1;
+
+  switch (dimension) {
+    case HCFFT_1D: {
+      if (length[0] == 0) {
+        return HCFFT_ERROR;
+      }
+
+      lenX = length[0];
+    } break;
+
+    case HCFFT_2D: {
+      if (length[0] == 0 || length[1] == 0) {
+        return HCFFT_ERROR;
+      }
+
+      lenX = length[0];
+      lenY = length[1];
+    } break;
+
+    case HCFFT_3D: {
+      if (length[0] == 0 || length[1] == 0 || length[2] == 0) {
+        return HCFFT_ERROR;
+      }
+
+      lenX = length[0];
+      lenY = length[1];
       lenZ = length[2];
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      for (size_t i = 0; i < dimension; i++) {
+        if (length[i] == 0) {
+          return HCFFT_ERROR;
+        }
+      }
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
   }
 
+  for (size_t i = 0; i < dimension; i++) {
+    total *= length[i];
+  }
+
   FFTPlan* fftPlan = NULL;
   FFTRepo& fftRepo = FFTRepo::getInstance();
   fftRepo.createPlan(plHandle, fftPlan);
@@ -372,7 +1165,7 @@ hcfftStatus hcfftCreateDefaultPlanInternal(hcfftPlanHandle* plHandle,
   fftPlan->opLayout = HCFFT_COMPLEX_INTERLEAVED;
   fftPlan->precision = HCFFT_SINGLE;
   fftPlan->forwardScale = 1.0;
-  fftPlan->backwardScale = 1.0 / static_cast<double>(lenX * lenY * lenZ);
+  fftPlan->backwardScale = 1.0 / static_cast<double>(total);
   fftPlan->batchSize = 1;
   fftPlan->gen = Stockham;  // default setting
   fftPlan->SetEnvelope();
@@ -416,6 +1209,20 @@ hcfftStatus hcfftCreateDefaultPlanInternal(hcfftPlanHandle* plHandle,
       fftPlan->iDist = lenX * lenY * lenZ;
       fftPlan->oDist = lenX * lenY * lenZ;
     } break;
+
+    default: {
+      size_t stride = 1;
+
+      for (size_t i = 0; i < dimension; i++) {
+        fftPlan->length.push_back(length[i]);
+        fftPlan->inStride.push_back(stride);
+        fftPlan->outStride.push_back(stride);
+        stride *= length[i];
+      }
+
+      fftPlan->iDist = stride;
+      fftPlan->oDist = stride;
+    } break;
   }
 
   fftPlan->plHandle = *plHandle;
@@ -444,1347 +1251,6947 @@ hcfftStatus FFTPlan::hcfftCreateDefaultPlan(
 
     fftPlan->userPlan = true;
     fftPlan->hcfftlibtype = libType;
+    hcfftCounters.plansCreated++;
   }
 
   return ret;
 }
 
+//  Kernels are launched without waiting for them, and the in-order queue of
+//  the view is what orders the stages of a transform. Sub-plans are therefore
+//  kept on the view of their user plan.
 hcfftStatus FFTPlan::hcfftSetAcclView(hcfftPlanHandle plHandle,
                                       hc::accelerator_view acc_view) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftSetAcclView"));
-  fftPlan->acc_view = acc_view;
-  fftPlan->acc = acc_view.get_accelerator();
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  // Every sub-plan launching on the view of the plan follows it. The copies
+  // on other accelerators and streams keep their own views.
+  hcfftPlanHandle subPlans[18];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftSetAcclView"));
+
+    // Transforms queued on the previous view may still use the plan buffers
+    if (!(fftPlan->acc_view == acc_view)) {
+      fftPlan->acc_view.wait();
+    }
+
+    fftPlan->acc_view = acc_view;
+    fftPlan->acc = acc_view.get_accelerator();
+    fftPlan->SetEnvelope();
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+    subPlans[8] = fftPlan->planConvFwd;
+    subPlans[9] = fftPlan->planConvBack;
+    subPlans[10] = fftPlan->planStreamXY;
+    subPlans[11] = fftPlan->planStreamZ;
+    subPlans[12] = fftPlan->hybridPlan;
+
+    for (int i = 0; i < 4; i++) {
+      subPlans[13 + i] = fftPlan->planR2R[i];
+    }
+
+    subPlans[17] = fftPlan->planHostBatch;
+  }
+
+  for (int i = 0; i < 18; i++) {
+    if (subPlans[i]) {
+      hcfftSetAcclView(subPlans[i], acc_view);
+    }
+  }
+
   return HCFFT_SUCCEEDS;
 }
 
-hcfftStatus FFTPlan::hcfftGetAcclView(hcfftPlanHandle plHandle,
-                                      hc::accelerator_view* acc_view) {
+//  Intermediate buffers of the plan tree, in the order hcfftWalkWorkArea
+//  places them in a work area. The plan is baked, since its sub-plans and
+//  their buffers are only known then.
+hcfftStatus FFTPlan::hcfftGetWorkSize(hcfftPlanHandle plHandle, size_t* size) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftGetAcclView"));
-  *acc_view = fftPlan->acc_view;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetWorkSize"));
+  hcfftStatus status = hcfftBakePlan(plHandle);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  size_t offset = 0;
+  status = hcfftWalkWorkArea(plHandle, NULL, 0, &offset);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  fftPlan->workAreaSize = offset;
+  *size = offset;
   return HCFFT_SUCCEEDS;
 }
 
-template <typename T>
-hcfftStatus FFTPlan::hcfftEnqueueTransform(hcfftPlanHandle plHandle,
-                                           hcfftDirection dir,
-                                           T* hcInputBuffers,
-                                           T* hcOutputBuffers,
-                                           T* hcTmpBuffers) {
-  hcfftStatus status = HCFFT_INVALID;
+//  Decomposes the plan as hcfftBakePlan does, without generating or
+//  building kernels, and adds up the intermediate buffers and twiddle tables
+//  of the plan tree. The plan has no kernels afterwards, so it is only good
+//  for being destroyed.
+hcfftStatus FFTPlan::hcfftEstimateWorkSize(hcfftPlanHandle plHandle,
+                                           size_t* size) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftEnqueueTransform"));
-  countKernel = 0;
 
-  if (fftPlan->transformed == false) {
-    char* err = (char*)calloc(128, 2);
-    kernelHandle = dlopen(fftPlan->kernellib.c_str(), RTLD_NOW);
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-    if (!kernelHandle) {
-      std::cout << "Failed to load Kernel: " << fftPlan->kernellib.c_str()
-                << std::endl;
-      return HCFFT_ERROR;
-    }
+  scopedLock sLock(*planLock, _T(" hcfftEstimateWorkSize"));
+  fftPlan->estimateOnly = true;
+  fftPlan->baked = false;
+  hcfftStatus status = hcfftBakePlan(plHandle);
+  fftPlan->estimateOnly = false;
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
   }
 
-  status = hcfftEnqueueTransformInternal<T>(plHandle, dir, hcInputBuffers,
-                                            hcOutputBuffers, hcTmpBuffers);
-  remove(fftPlan->filename.c_str());
-  fftPlan->transformed = true;
-  return status;
+  *size = 0;
+  return hcfftAddEstimate(plHandle, size);
 }
 
-// Template Initialization
-template hcfftStatus FFTPlan::hcfftEnqueueTransform(hcfftPlanHandle plHandle,
-                                                    hcfftDirection dir,
-                                                    float* hcInputBuffers,
-                                                    float* hcOutputBuffers,
-                                                    float* hcTmpBuffers);
-template hcfftStatus FFTPlan::hcfftEnqueueTransform(hcfftPlanHandle plHandle,
-                                                    hcfftDirection dir,
-                                                    double* hcInputBuffers,
-                                                    double* hcOutputBuffers,
-                                                    double* hcTmpBuffers);
-
-template <typename T>
-hcfftStatus FFTPlan::hcfftEnqueueTransformInternal(hcfftPlanHandle plHandle,
-                                                   hcfftDirection dir,
-                                                   T* hcInputBuffers,
-                                                   T* hcOutputBuffers,
-                                                   T* hcTmpBuffers) {
-  hcfftStatus status = HCFFT_SUCCEEDS;
-  std::map<int, void*> vectArr;
+hcfftStatus FFTPlan::hcfftAddEstimate(hcfftPlanHandle plHandle,
+                                      size_t* size) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  //  At this point, the user wants to enqueue a plan to execute.  We lock the
-  //  plan down now, such that
-  //  after we finish baking the plan (if the user did not do that explicitely
-  //  before), the plan cannot
-  //  change again through the action of other thread before we enqueue this
-  //  plan for execution.
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T("hcfftEnqueueTransformInternal"));
 
-  if (fftPlan->baked == false) {
-    hcfftBakePlan(plHandle);
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
   }
 
-  if (fftPlan->ipLayout == HCFFT_REAL) {
-    dir = HCFFT_FORWARD;
-  } else if (fftPlan->opLayout == HCFFT_REAL) {
-    dir = HCFFT_BACKWARD;
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftAddEstimate"));
+    *size += fftPlan->tmpBufSize + fftPlan->tmpBufSizeRC +
+             fftPlan->tmpBufSizeC2R + fftPlan->twiddleBytes;
+    fftPlan->twiddleBytes = 0;
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
   }
 
-  if (hcTmpBuffers == NULL && fftPlan->tmpBufSize > 0 &&
-      fftPlan->intBuffer == NULL) {
-    // create the intermediate buffers
-    // The intermediate buffer is always interleave and packed
-    // For outofplace operation, we have the choice not to create intermediate
-    // buffer
-    // input ->(col+Transpose) output ->(col) output
-    fftPlan->intBuffer = hc::am_alloc(fftPlan->tmpBufSize, fftPlan->acc, 0);
-
-    if (fftPlan->intBuffer == NULL) {
-      return HCFFT_INVALID;
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i]) {
+      hcfftAddEstimate(subPlans[i], size);
     }
   }
 
-  if (hcTmpBuffers == NULL && fftPlan->intBuffer != NULL) {
-    hcTmpBuffers = (T*)fftPlan->intBuffer;
-  }
-
-  if (fftPlan->intBufferRC == NULL && fftPlan->tmpBufSizeRC > 0) {
-    fftPlan->intBufferRC = hc::am_alloc(fftPlan->tmpBufSizeRC, fftPlan->acc, 0);
+  return HCFFT_SUCCEEDS;
+}
 
-    if (fftPlan->intBufferRC == NULL) {
-      return HCFFT_INVALID;
-    }
+//  Buffers carved from the previous work area are dropped, and ones of the
+//  new area are carved at the next transform
+hcfftStatus FFTPlan::hcfftSetWorkArea(hcfftPlanHandle plHandle,
+                                      void* workArea) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
   }
 
-  if (fftPlan->intBufferC2R == NULL && fftPlan->tmpBufSizeC2R > 0) {
-    fftPlan->intBufferC2R =
-        hc::am_alloc(fftPlan->tmpBufSizeC2R, fftPlan->acc, 0);
+  scopedLock sLock(*planLock, _T(" hcfftSetWorkArea"));
 
-    if (fftPlan->intBufferC2R == NULL) {
-      return HCFFT_INVALID;
-    }
+  // The work area of the caller replaces the one taken from the pool
+  hcfftDetachScratch(plHandle);
+
+  if (fftPlan->workArea == workArea) {
+    return HCFFT_SUCCEEDS;
   }
 
-  //  The largest vector we can transform in a single pass
-  //  depends on the GPU caps -- especially the amount of LDS
-  //  available
-  //
-  size_t Large1DThreshold = 0;
-  fftPlan->GetMax1DLength(&Large1DThreshold);
-  BUG_CHECK(Large1DThreshold > 1);
+  // Transforms queued with the previous work area may still use it
+  if (fftPlan->workArea != NULL) {
+    fftPlan->acc_view.wait();
+  }
 
-  if (fftPlan->gen != Copy) switch (fftPlan->dimension) {
-      case HCFFT_1D: {
-        if (Is1DPossible(fftPlan->length[0], Large1DThreshold)) {
-          break;
-        }
+  size_t reported = fftPlan->workAreaSize;
+  hcfftDropWorkArea(plHandle);
+  fftPlan->workArea = workArea;
+  fftPlan->workAreaSize = reported;
+  fftPlan->launchesFwd.clear();
+  fftPlan->launchesBack.clear();
+  return HCFFT_SUCCEEDS;
+}
 
-        if ((fftPlan->ipLayout == HCFFT_REAL) && (fftPlan->planTZ != 0)) {
-          // First transpose
-          // Input->tmp
-          hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir, hcInputBuffers,
-                                           hcTmpBuffers, NULL);
+//  The launches are recorded once, with the buffers carved from the work
+//  area of the first call, and each later call moves them into its own work
+//  area as they are queued (CallBuffer). Kernels already queued keep the
+//  buffers they were launched with, so no work area is waited for. A Rader
+//  plan, whose launches are not recorded, carves the area of every call.
+hcfftStatus FFTPlan::hcfftSetCallWorkArea(hcfftPlanHandle plHandle,
+                                          void* workArea) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-          if (fftPlan->location == HCFFT_INPLACE) {
-            // First Row
-            // tmp->output
-            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcTmpBuffers,
-                                             (T*)fftPlan->intBufferRC, NULL);
-            // Second Transpose
-            // output->tmp
-            hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcTmpBuffers, NULL);
-            // Second Row
-            // tmp->tmp, inplace
-            hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir, hcTmpBuffers,
-                                             (T*)fftPlan->intBufferRC, NULL);
-            // Third Transpose
-            // tmp->output
-            hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcInputBuffers, NULL);
-          } else {
-            // First Row
-            // tmp->output
-            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcTmpBuffers,
-                                             (T*)fftPlan->intBufferRC, NULL);
-            // Second Transpose
-            // output->tmp
-            hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcTmpBuffers, NULL);
-            // Second Row
-            // tmp->tmp, inplace
-            hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir, hcTmpBuffers,
-                                             (T*)fftPlan->intBufferRC, NULL);
-            // Third Transpose
-            // tmp->output
-            hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcOutputBuffers, NULL);
-          }
-        } else if (fftPlan->ipLayout == HCFFT_REAL) {
-          // First pass
-          // column with twiddle first, OUTOFPLACE, + transpose
-          hcfftEnqueueTransformInternal<T>(
-              fftPlan->planX, HCFFT_FORWARD, hcInputBuffers,
-              (T*)fftPlan->intBufferRC, hcTmpBuffers);
-          // another column FFT output, INPLACE
-          hcfftEnqueueTransformInternal<T>(
-              fftPlan->planY, HCFFT_FORWARD, (T*)fftPlan->intBufferRC,
-              (T*)fftPlan->intBufferRC, hcTmpBuffers);
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-          if (fftPlan->location == HCFFT_INPLACE) {
-            // copy from full complex to hermitian
-            hcfftEnqueueTransformInternal<T>(fftPlan->planRCcopy, HCFFT_FORWARD,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcInputBuffers, hcTmpBuffers);
-          } else {
-            hcfftEnqueueTransformInternal<T>(fftPlan->planRCcopy, HCFFT_FORWARD,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcOutputBuffers, hcTmpBuffers);
-          }
-        } else if (fftPlan->opLayout == HCFFT_REAL) {
-          if (fftPlan->planRCcopy) {
-            // copy from hermitian to full complex
-            hcfftEnqueueTransformInternal<T>(
-                fftPlan->planRCcopy, HCFFT_BACKWARD, hcInputBuffers,
-                (T*)fftPlan->intBufferRC, hcTmpBuffers);
-            // First pass
-            // column with twiddle first, INPLACE,
-            hcfftEnqueueTransformInternal<T>(
-                fftPlan->planX, HCFFT_BACKWARD, (T*)fftPlan->intBufferRC,
-                (T*)fftPlan->intBufferRC, hcTmpBuffers);
-          } else {
-            // First pass
-            // column with twiddle first, INPLACE,
-            hcfftEnqueueTransformInternal<T>(
-                fftPlan->planX, HCFFT_BACKWARD, hcInputBuffers,
-                (T*)fftPlan->intBufferRC, hcTmpBuffers);
-          }
+  scopedLock sLock(*planLock, _T(" hcfftSetCallWorkArea"));
+  fftPlan->callWorkArea = NULL;
 
-          if (fftPlan->location == HCFFT_INPLACE) {
-            // another column FFT output, OUTOFPLACE + transpose
-            hcfftEnqueueTransformInternal<T>(fftPlan->planY, HCFFT_BACKWARD,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcInputBuffers, hcTmpBuffers);
-          } else {
-            hcfftEnqueueTransformInternal<T>(fftPlan->planY, HCFFT_BACKWARD,
-                                             (T*)fftPlan->intBufferRC,
-                                             hcOutputBuffers, hcTmpBuffers);
-          }
-        } else {
-          if (fftPlan->transflag) {
-            if (fftPlan->allOpsInplace) {
-              // First transpose
-              // Input->tmp
-              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
-                                               hcInputBuffers, NULL, NULL);
-            } else {
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
-            }
+  if (workArea == NULL || workArea == fftPlan->workArea) {
+    return HCFFT_SUCCEEDS;
+  }
 
-            if (fftPlan->location == HCFFT_INPLACE) {
-              // First Row
-              // tmp->output
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                                 hcInputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planX, dir, hcTmpBuffers, hcInputBuffers, NULL);
-              }
+  if (fftPlan->workArea != NULL && fftPlan->scratchPool == NULL &&
+      !fftPlan->rader) {
+    fftPlan->callWorkArea = workArea;
+    return HCFFT_SUCCEEDS;
+  }
 
-              // Second Transpose
-              // output->tmp
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                                 hcInputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTY, dir, hcInputBuffers, hcTmpBuffers, NULL);
-              }
+  // The work area of the caller replaces the one taken from the pool
+  hcfftDetachScratch(plHandle);
+  size_t reported = fftPlan->workAreaSize;
+  hcfftDropWorkArea(plHandle);
+  fftPlan->workArea = workArea;
+  fftPlan->workAreaSize = reported;
+  fftPlan->workAreaOfCall = true;
+  fftPlan->launchesFwd.clear();
+  fftPlan->launchesBack.clear();
+  return HCFFT_SUCCEEDS;
+}
 
-              // Second Row
-              // tmp->tmp, inplace
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcInputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcTmpBuffers, NULL, NULL);
-              }
+//  Transforms already queued keep the buffers they were launched with, so
+//  the work area is not waited for
+hcfftStatus FFTPlan::hcfftClearWorkArea(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-              // Third Transpose
-              // tmp->output
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
-                                                 hcInputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTZ, dir, hcTmpBuffers, hcInputBuffers, NULL);
-              }
-            } else {
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planX, dir, hcTmpBuffers, hcOutputBuffers, NULL);
-              }
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-              // Second Transpose
-              // output->tmp
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTY, dir, hcOutputBuffers, hcTmpBuffers, NULL);
-              }
+  scopedLock sLock(*planLock, _T(" hcfftClearWorkArea"));
 
-              // Second Row
-              // tmp->tmp, inplace
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcTmpBuffers, NULL, NULL);
-              }
+  if (!fftPlan->workAreaOfCall) {
+    return HCFFT_SUCCEEDS;
+  }
 
-              // Third Transpose
-              // tmp->output
-              if (fftPlan->allOpsInplace) {
-                hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-              } else {
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTZ, dir, hcTmpBuffers, hcOutputBuffers, NULL);
-              }
-            }
-          } else {
-            if (fftPlan->large1D == 0) {
-              if (fftPlan->planCopy) {
-                // Transpose OUTOFPLACE
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL),
-                    // FFT INPLACE
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                                     hcTmpBuffers, NULL, NULL);
-                // FFT INPLACE
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcTmpBuffers, NULL, NULL);
+  size_t reported = fftPlan->workAreaSize;
+  hcfftDropWorkArea(plHandle);
+  fftPlan->workAreaSize = reported;
+  fftPlan->launchesFwd.clear();
+  fftPlan->launchesBack.clear();
+  return HCFFT_SUCCEEDS;
+}
 
-                if (fftPlan->location == HCFFT_INPLACE) {
-                  // Copy kernel
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planCopy, dir,
-                                                   hcTmpBuffers, hcInputBuffers,
-                                                   NULL);
-                } else {
-                  // Copy kernel
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planCopy, dir,
-                                                   hcTmpBuffers,
-                                                   hcOutputBuffers, NULL);
-                }
-              } else {
-                // First pass
-                // column with twiddle first, OUTOFPLACE, + transpose
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+//  Whether a transform fails for want of a work area: the plan may not
+//  allocate and has intermediate buffers left without one
+bool FFTPlan::hcfftNeedsWorkArea(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return false;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftNeedsWorkArea"));
+
+  if (fftPlan->autoAllocate || fftPlan->workArea != NULL) {
+    return false;
+  }
+
+  return hcfftMissingBuffers(plHandle);
+}
+
+//  A user plan that allocates its own buffers and has no work area from the
+//  caller takes one from the scratch pool of its view. pool is NULL for
+//  other plans, which leave the pool of a previous view.
+hcfftStatus FFTPlan::hcfftAttachScratch(hcfftPlanHandle plHandle,
+                                        hcfftScratchPool*& pool) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftAttachScratch"));
+  bool pooled = fftPlan->autoAllocate &&
+                (fftPlan->workArea == NULL || fftPlan->scratchPool != NULL);
+
+  if (fftPlan->scratchPool != NULL &&
+      (!pooled ||
+       fftPlan->scratchPool->queue != fftPlan->acc_view.get_hsa_queue())) {
+    hcfftDetachScratch(plHandle);
+  }
+
+  if (pooled && fftPlan->scratchPool == NULL &&
+      fftRepo.acquireScratch(fftPlan->acc_view, fftPlan->scratchPool) !=
+          HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  pool = fftPlan->scratchPool;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Grows the pool to the intermediate buffers of the plan tree, and carves
+//  them again when the pool buffer has changed since they were carved. The
+//  caller holds the lock of the pool.
+hcfftStatus FFTPlan::hcfftSizeScratch(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSizeScratch"));
+  hcfftScratchPool* pool = fftPlan->scratchPool;
+
+  if (fftPlan->scratchGeneration == pool->generation) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  size_t extent = 0;
+  hcfftWalkWorkArea(plHandle, NULL, 0, &extent);
+
+  if (fftRepo.growScratch(pool, extent) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftDropWorkArea(plHandle);
+  fftPlan->workArea = pool->buffer;
+  fftPlan->workAreaSize = pool->size;
+  fftPlan->launchesFwd.clear();
+  fftPlan->launchesBack.clear();
+  fftPlan->scratchGeneration = pool->generation;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftDetachScratch(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftDetachScratch"));
+
+  if (fftPlan->scratchPool == NULL) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  // Transforms queued with the pool buffer may still use it
+  fftPlan->acc_view.wait();
+  hcfftDropWorkArea(plHandle);
+  fftPlan->launchesFwd.clear();
+  fftPlan->launchesBack.clear();
+  fftRepo.releaseScratch(fftPlan->scratchPool);
+  fftPlan->scratchPool = NULL;
+  fftPlan->scratchGeneration = 0;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetAutoAllocation(hcfftPlanHandle plHandle,
+                                            bool autoAllocate) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetAutoAllocation"));
+  fftPlan->autoAllocate = autoAllocate;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetLowMemory(hcfftPlanHandle plHandle,
+                                       bool lowMemory) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetLowMemory"));
+
+  //  The sub-plans and buffers of the plan depend on the mode
+  if (fftPlan->lowMemory != lowMemory) {
+    fftPlan->lowMemory = lowMemory;
+    fftPlan->baked = false;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Half storage takes the load and store callbacks of the plan, so that
+//  only the kernels with callbacks, which read and write the data of the
+//  plan, see half values
+hcfftStatus FFTPlan::hcfftSetHalfStorage(hcfftPlanHandle plHandle,
+                                         bool halfStorage) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetHalfStorage"));
+
+  if (fftPlan->halfStorage == halfStorage) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  if (halfStorage) {
+    if (!fftPlan->loadCallback.empty() || !fftPlan->storeCallback.empty()) {
+      return HCFFT_INVALID;
+    }
+
+    fftPlan->loadCallback.funcName = "hcfftHalfLoad";
+    fftPlan->loadCallback.funcString =
+        "float_2 hcfftHalfLoad(float_2 *buffer, unsigned int offset, "
+        "void *callerInfo) [[hc]]\n{\n"
+        "\t__fp16 *h = (__fp16 *)buffer + 2 * offset;\n"
+        "\treturn float_2(h[0], h[1]);\n}\n";
+    fftPlan->storeCallback.funcName = "hcfftHalfStore";
+    fftPlan->storeCallback.funcString =
+        "void hcfftHalfStore(float_2 *buffer, unsigned int offset, "
+        "float_2 element, void *callerInfo) [[hc]]\n{\n"
+        "\t__fp16 *h = (__fp16 *)buffer + 2 * offset;\n"
+        "\th[0] = element.x;\n"
+        "\th[1] = element.y;\n}\n";
+  } else {
+    fftPlan->loadCallback = hcfftCallback();
+    fftPlan->storeCallback = hcfftCallback();
+  }
+
+  fftPlan->halfStorage = halfStorage;
+  fftPlan->baked = false;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Planar storage takes the load and store callbacks of the plan like half
+//  storage. The callbacks follow the precision of the plan, so setting the
+//  storage again after a change of precision rewrites them.
+hcfftStatus FFTPlan::hcfftSetPlanarStorage(hcfftPlanHandle plHandle,
+                                           bool planarStorage) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanarStorage"));
+
+  if (!planarStorage) {
+    if (fftPlan->planarStorage) {
+      fftPlan->loadCallback = hcfftCallback();
+      fftPlan->storeCallback = hcfftCallback();
+      fftPlan->planarStorage = false;
+      fftPlan->baked = false;
+    }
+
+    return HCFFT_SUCCEEDS;
+  }
+
+  if (!fftPlan->planarStorage &&
+      (!fftPlan->loadCallback.empty() || !fftPlan->storeCallback.empty())) {
+    return HCFFT_INVALID;
+  }
+
+  std::string type =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string real = (fftPlan->precision == HCFFT_SINGLE) ? "float" : "double";
+  std::string load;
+  load += type + " hcfftPlanarLoad(" + type + " *buffer, unsigned int offset, ";
+  load += "void *callerInfo) [[hc]]\n{\n";
+  load += "\treturn " + type + "(((" + real + " *)buffer)[offset], ((" + real +
+          " *)callerInfo)[offset]);\n}\n";
+  std::string store;
+  store += "void hcfftPlanarStore(" + type + " *buffer, unsigned int offset, ";
+  store += type + " element, void *callerInfo) [[hc]]\n{\n";
+  store += "\t((" + real + " *)buffer)[offset] = element.x;\n";
+  store += "\t((" + real + " *)callerInfo)[offset] = element.y;\n}\n";
+
+  if (fftPlan->planarStorage && fftPlan->loadCallback.funcString == load) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  fftPlan->loadCallback.funcName = "hcfftPlanarLoad";
+  fftPlan->loadCallback.funcString = load;
+  fftPlan->storeCallback.funcName = "hcfftPlanarStore";
+  fftPlan->storeCallback.funcString = store;
+  fftPlan->planarStorage = true;
+  fftPlan->baked = false;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetAutotune(hcfftPlanHandle plHandle,
+                                      bool autotune) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetAutotune"));
+
+  //  The leaves of the plan are tuned by its next bake
+  if (fftPlan->autotune != autotune) {
+    fftPlan->autotune = autotune;
+    fftPlan->baked = false;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetPlanProfiling(hcfftPlanHandle plHandle,
+                                           bool profile) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanProfiling"));
+  fftPlan->profile = profile;
+  return HCFFT_SUCCEEDS;
+}
+
+//  A marker completes once the kernels queued before it have, so the end of
+//  each marker is the end of the kernel before it and the start of the one
+//  after it. Kernel times therefore include the gaps between launches.
+hcfftStatus FFTPlan::hcfftGetPlanProfile(
+    hcfftPlanHandle plHandle, std::vector<hcfftKernelProfile>& profile) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetPlanProfile"));
+  std::vector<hc::completion_future>& markers = fftPlan->profileMarkers;
+  profile = fftPlan->profileKernels;
+
+  if (markers.size() != profile.size() + 1) {
+    profile.clear();
+    return HCFFT_SUCCEEDS;
+  }
+
+  for (size_t i = 0; i < markers.size(); i++) {
+    markers[i].wait();
+  }
+
+  double frequency = double(markers[0].get_tick_frequency());
+  uint64_t base = markers[0].get_end_tick();
+
+  for (size_t i = 0; i < profile.size(); i++) {
+    profile[i].start = (markers[i].get_end_tick() - base) / frequency;
+    profile[i].end = (markers[i + 1].get_end_tick() - base) / frequency;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetPlanValidation(hcfftPlanHandle plHandle,
+                                            bool validate) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanValidation"));
+  fftPlan->validate = validate;
+  return HCFFT_SUCCEEDS;
+}
+
+//  The partial sums of each batch element are added on the host, in double
+//  precision. An input of zero energy has an error of 0 if its output is
+//  zero too, and of 1 otherwise.
+hcfftStatus FFTPlan::hcfftGetPlanValidation(hcfftPlanHandle plHandle,
+                                            std::vector<double>& errors) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetPlanValidation"));
+  size_t batch = fftPlan->validBatch;
+  size_t blocks = fftPlan->validBlocks;
+  errors.clear();
+
+  if (batch == 0 || fftPlan->validPartials == NULL) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  std::vector<double> partials(2 * batch * blocks);
+  fftPlan->acc_view.wait();
+  fftPlan->acc_view.copy(fftPlan->validPartials, &partials[0],
+                         partials.size() * sizeof(double));
+
+  for (size_t b = 0; b < batch; b++) {
+    double in = 0;
+    double out = 0;
+
+    for (size_t i = 0; i < blocks; i++) {
+      in += partials[b * blocks + i];
+      out += partials[(batch + b) * blocks + i];
+    }
+
+    double expected = in * fftPlan->validScale;
+
+    if (expected > 0) {
+      errors.push_back(std::fabs(out - expected) / expected);
+    } else {
+      errors.push_back((out > 0) ? 1.0 : 0.0);
+    }
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetComputeTwiddles(hcfftPlanHandle plHandle,
+                                             bool computeTwiddles) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetComputeTwiddles"));
+
+  //  The 3-step kernels drop or take back the large twiddle table
+  if (fftPlan->computeTwiddles != computeTwiddles) {
+    fftPlan->computeTwiddles = computeTwiddles;
+    fftPlan->baked = false;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetHostThreshold(hcfftPlanHandle plHandle,
+                                           size_t hostThreshold) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetHostThreshold"));
+  fftPlan->hostThreshold = hostThreshold;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Memory the runtime does not track, like that of malloc, or tracks outside
+//  of the device
+static bool hostResident(const void* ptr) {
+  hc::accelerator acc;
+  hc::AmPointerInfo info(NULL, NULL, 0, acc, false, false);
+  return hc::am_memtracker_getinfo(&info, ptr) != AM_SUCCESS ||
+         !info._isInDeviceMem;
+}
+
+bool FFTPlan::hcfftRunsOnHost(hcfftPlanHandle plHandle, const void* input,
+                              const void* output) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return false;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftRunsOnHost"));
+  size_t elements = fftPlan->batchSize;
+
+  for (size_t i = 0; i < fftPlan->length.size(); i++) {
+    elements *= fftPlan->length[i];
+  }
+
+  return fftPlan->hcfftlibtype == HCFFT_C2CZ2Z &&
+         elements <= fftPlan->hostThreshold && fftPlan->loadCallback.empty() &&
+         fftPlan->storeCallback.empty() && !fftPlan->halfStorage &&
+         !fftPlan->planarStorage && hostResident(input) &&
+         hostResident(output);
+}
+
+//  DFT of the n complex elements of in, stride apart, into out by the n x n
+//  table of cos and sin w, each input element adding its terms to all the
+//  outputs so that the inner loop vectorizes without reassociating sums
+template <typename T>
+static void hostDft(const T* in, size_t inStride, T* out, size_t outStride,
+                    size_t n, const double* w, double sign, double scale,
+                    double* acc) {
+  double* re = acc;
+  double* im = acc + n;
+  std::fill(acc, acc + 2 * n, 0.0);
+
+  for (size_t j = 0; j < n; j++) {
+    double xr = in[2 * j * inStride];
+    double xi = in[2 * j * inStride + 1];
+    const double* c = w + 2 * j * n;
+    const double* s = c + n;
+
+    for (size_t k = 0; k < n; k++) {
+      re[k] += xr * c[k] - sign * xi * s[k];
+      im[k] += sign * xr * s[k] + xi * c[k];
+    }
+  }
+
+  for (size_t k = 0; k < n; k++) {
+    out[2 * k * outStride] = static_cast<T>(re[k] * scale);
+    out[2 * k * outStride + 1] = static_cast<T>(im[k] * scale);
+  }
+}
+
+//  Transforms the batches first to last of the plan along each of its axes,
+//  the first from the input to the output and the others in place
+template <typename T>
+static void hostBatches(const FFTPlan* fftPlan, double sign, double scale,
+                        const T* input, T* output, size_t first,
+                        size_t last) {
+  size_t dims = fftPlan->length.size();
+  size_t longest = *std::max_element(fftPlan->length.begin(),
+                                     fftPlan->length.end());
+  std::vector<double> acc(2 * longest);
+
+  for (size_t b = first; b < last; b++) {
+    for (size_t d = 0; d < dims; d++) {
+      size_t n = fftPlan->length[d];
+      const T* src = d ? output + 2 * b * fftPlan->oDist
+                       : input + 2 * b * fftPlan->iDist;
+      const std::vector<size_t>& srcStride =
+          d ? fftPlan->outStride : fftPlan->inStride;
+      size_t lines = 1;
+
+      for (size_t e = 0; e < dims; e++) {
+        lines *= e == d ? 1 : fftPlan->length[e];
+      }
+
+      for (size_t line = 0; line < lines; line++) {
+        size_t in = 0, out = 0, rest = line;
+
+        for (size_t e = 0; e < dims; e++) {
+          if (e != d) {
+            size_t index = rest % fftPlan->length[e];
+            rest /= fftPlan->length[e];
+            in += index * srcStride[e];
+            out += index * fftPlan->outStride[e];
+          }
+        }
+
+        // The scale of the transform is taken by its last axis
+        hostDft(src + 2 * in, srcStride[d],
+                output + 2 * (b * fftPlan->oDist + out),
+                fftPlan->outStride[d], n, &fftPlan->hostTwiddles[d][0], sign,
+                d + 1 == dims ? scale : 1.0, &acc[0]);
+      }
+    }
+  }
+}
+
+//  Tables of the cos and sin of the DFT of each length of a plan. Those left
+//  by lengths the plan had before are rebuilt.
+static void hostTables(FFTPlan* fftPlan) {
+  fftPlan->hostTwiddles.resize(fftPlan->length.size());
+
+  for (size_t d = 0; d < fftPlan->length.size(); d++) {
+    size_t n = fftPlan->length[d];
+    std::vector<double>& w = fftPlan->hostTwiddles[d];
+
+    if (w.size() == 2 * n * n) {
+      continue;
+    }
+
+    w.resize(2 * n * n);
+
+    for (size_t j = 0; j < n; j++) {
+      for (size_t k = 0; k < n; k++) {
+        double angle = 2.0 * M_PI * ((j * k) % n) / n;
+        w[2 * j * n + k] = cos(angle);
+        w[2 * j * n + n + k] = sin(angle);
+      }
+    }
+  }
+}
+
+//  Transforms the batches first to last on the host, shared by a worker per
+//  core when there are enough elements to amortize starting them
+template <typename T>
+static void hostRun(const FFTPlan* fftPlan, hcfftDirection dir,
+                    const T* input, T* output, size_t first, size_t last) {
+  double sign = dir == HCFFT_FORWARD ? -1.0 : 1.0;
+  double scale =
+      dir == HCFFT_FORWARD ? fftPlan->forwardScale : fftPlan->backwardScale;
+  size_t batch = last - first;
+  size_t elements = batch;
+
+  for (size_t i = 0; i < fftPlan->length.size(); i++) {
+    elements *= fftPlan->length[i];
+  }
+
+  size_t workers = std::min<size_t>(std::thread::hardware_concurrency(),
+                                    std::min(batch, elements / 4096));
+
+  if (workers < 2) {
+    hostBatches<T>(fftPlan, sign, scale, input, output, first, last);
+    return;
+  }
+
+  std::vector<std::future<void> > done;
+
+  for (size_t i = 0; i < workers; i++) {
+    done.push_back(std::async(std::launch::async, hostBatches<T>, fftPlan,
+                              sign, scale, input, output,
+                              first + i * batch / workers,
+                              first + (i + 1) * batch / workers));
+  }
+
+  for (size_t i = 0; i < workers; i++) {
+    done[i].wait();
+  }
+}
+
+template <typename T>
+hcfftStatus FFTPlan::hcfftTransformOnHost(hcfftPlanHandle plHandle,
+                                          hcfftDirection dir, T* input,
+                                          T* output) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftTransformOnHost"));
+
+  // Earlier transforms of the plan may still write the memory
+  fftPlan->acc_view.wait();
+  hcfftCounters.execs++;
+  hostTables(fftPlan);
+  hostRun<T>(fftPlan, dir, input, output, 0, fftPlan->batchSize);
+  return HCFFT_SUCCEEDS;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftTransformOnHost(hcfftPlanHandle plHandle,
+                                                   hcfftDirection dir,
+                                                   float* input,
+                                                   float* output);
+template hcfftStatus FFTPlan::hcfftTransformOnHost(hcfftPlanHandle plHandle,
+                                                   hcfftDirection dir,
+                                                   double* input,
+                                                   double* output);
+
+hcfftStatus FFTPlan::hcfftSetHybrid(hcfftPlanHandle plHandle, bool hybrid) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetHybrid"));
+  fftPlan->hybrid = hybrid;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Host memory the runtime pinned, which the GPU reads and writes in place
+static bool hostPinned(const void* ptr) {
+  hc::accelerator acc;
+  hc::AmPointerInfo info(NULL, NULL, 0, acc, false, false);
+  return hc::am_memtracker_getinfo(&info, ptr) == AM_SUCCESS &&
+         !info._isInDeviceMem;
+}
+
+//  Address the kernels read and write the memory of ptr at. Host memory
+//  registered with hc::am_memory_host_lock has a device address of its own;
+//  device memory and that of hc::am_alloc, host coherent or not, is seen at
+//  its host address. The transform then runs on the memory where it is,
+//  without copies to and from the device.
+template <typename T>
+static T* deviceAlias(T* ptr) {
+  hc::accelerator acc;
+  hc::AmPointerInfo info(NULL, NULL, 0, acc, false, false);
+
+  if (ptr == NULL || hc::am_memtracker_getinfo(&info, ptr) != AM_SUCCESS ||
+      info._isInDeviceMem || info._hostPointer == NULL ||
+      info._devicePointer == NULL) {
+    return ptr;
+  }
+
+  return reinterpret_cast<T*>(static_cast<char*>(info._devicePointer) +
+                              (reinterpret_cast<char*>(ptr) -
+                               static_cast<char*>(info._hostPointer)));
+}
+
+bool FFTPlan::hcfftRunsHybrid(hcfftPlanHandle plHandle, const void* input,
+                              const void* output) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return false;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftRunsHybrid"));
+  return fftPlan->hybrid && fftPlan->hcfftlibtype == HCFFT_C2CZ2Z &&
+         fftPlan->batchSize > 1 && fftPlan->gpus.empty() &&
+         fftPlan->loadCallback.empty() && fftPlan->storeCallback.empty() &&
+         !fftPlan->halfStorage && !fftPlan->planarStorage &&
+         hostPinned(input) && hostPinned(output);
+}
+
+//  The GPU transforms the leading batches through a sub-plan while the host
+//  transforms the rest. The first transform times both sides and sets the
+//  share of the host to the part it finishes in the time the GPU takes for
+//  the other, which rebuilds the sub-plan once for the new split.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueHybrid(hcfftPlanHandle plHandle,
+                                        hcfftDirection dir, T* input,
+                                        T* output) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueHybrid"));
+  size_t batch = fftPlan->batchSize;
+  size_t hostBatch = size_t(fftPlan->hybridShare * batch + 0.5);
+
+  // Calibration needs a batch on each side
+  if (!fftPlan->hybridCalibrated) {
+    hostBatch = std::min(std::max<size_t>(hostBatch, 1), batch - 1);
+  }
+
+  size_t gpuBatch = batch - hostBatch;
+
+  if (gpuBatch == 0) {
+    fftPlan->acc_view.wait();
+    hostTables(fftPlan);
+    hostRun<T>(fftPlan, dir, input, output, 0, batch);
+    return HCFFT_SUCCEEDS;
+  }
+
+  FFTPlan* gpuPlan = NULL;
+  lockRAII* gpuLock = NULL;
+
+  if (fftPlan->hybridPlan &&
+      fftRepo.getPlan(fftPlan->hybridPlan, gpuPlan, gpuLock) !=
+          HCFFT_SUCCEEDS) {
+    fftPlan->hybridPlan = 0;
+  }
+
+  // A new share re-batches the plan, which keeps its kernels
+  if (fftPlan->hybridPlan && gpuPlan->batchSize != gpuBatch) {
+    hcfftSetPlanBatchSize(fftPlan->hybridPlan, gpuBatch);
+  }
+
+  if (!fftPlan->hybridPlan) {
+    hcfftStatus status = hcfftCreateDefaultPlan(
+        &fftPlan->hybridPlan, fftPlan->dimension, &fftPlan->originalLength[0],
+        fftPlan->direction, fftPlan->precision, fftPlan->hcfftlibtype);
+
+    if (status != HCFFT_SUCCEEDS) {
+      fftPlan->hybridPlan = 0;
+      return status;
+    }
+
+    fftRepo.getPlan(fftPlan->hybridPlan, gpuPlan, gpuLock);
+    {
+      scopedLock sGpuLock(*gpuLock, _T(" hcfftEnqueueHybrid"));
+      gpuPlan->precision = fftPlan->precision;
+      gpuPlan->transposeType = fftPlan->transposeType;
+      gpuPlan->inStride = fftPlan->inStride;
+      gpuPlan->outStride = fftPlan->outStride;
+      gpuPlan->iDist = fftPlan->iDist;
+      gpuPlan->oDist = fftPlan->oDist;
+      gpuPlan->batchSize = gpuBatch;
+      gpuPlan->forwardScale = fftPlan->forwardScale;
+      gpuPlan->backwardScale = fftPlan->backwardScale;
+      gpuPlan->lowMemory = fftPlan->lowMemory;
+      gpuPlan->singleTwiddles = fftPlan->singleTwiddles;
+      gpuPlan->computeTwiddles = fftPlan->computeTwiddles;
+      gpuPlan->autotune = fftPlan->autotune;
+      gpuPlan->ldsPadding = fftPlan->ldsPadding;
+      gpuPlan->tuneWorkGroupSize = fftPlan->tuneWorkGroupSize;
+      gpuPlan->tuneNumTrans = fftPlan->tuneNumTrans;
+    }
+
+    hcfftSetAcclView(fftPlan->hybridPlan, fftPlan->acc_view);
+  }
+
+  hcfftResLocation location =
+      (input == output) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+  hcfftStatus status =
+      hcfftPrepareExec(fftPlan->hybridPlan, location,
+                       HCFFT_COMPLEX_INTERLEAVED, HCFFT_COMPLEX_INTERLEAVED);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  hostTables(fftPlan);
+
+  // The host must not touch the memory before earlier transforms finish
+  fftPlan->acc_view.wait();
+  double gpuSeconds = 0;
+  double hostSeconds = 0;
+  {
+    scopedTimer gpuTimer(gpuSeconds);
+    status = hcfftEnqueueTransform<T>(fftPlan->hybridPlan, dir, input, output,
+                                      NULL);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    {
+      scopedTimer hostTimer(hostSeconds);
+      hostRun<T>(fftPlan, dir, input, output, gpuBatch, batch);
+    }
+
+    if (fftPlan->hybridCalibrated) {
+      return HCFFT_SUCCEEDS;
+    }
+
+    fftPlan->acc_view.wait();
+  }
+
+  double hostRate = hostBatch / std::max(hostSeconds, 1e-9);
+  double gpuRate = gpuBatch / std::max(gpuSeconds, 1e-9);
+  fftPlan->hybridShare = hostRate / (hostRate + gpuRate);
+  fftPlan->hybridCalibrated = true;
+  return HCFFT_SUCCEEDS;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueHybrid(hcfftPlanHandle plHandle,
+                                                 hcfftDirection dir,
+                                                 float* input, float* output);
+template hcfftStatus FFTPlan::hcfftEnqueueHybrid(hcfftPlanHandle plHandle,
+                                                 hcfftDirection dir,
+                                                 double* input,
+                                                 double* output);
+
+hcfftStatus FFTPlan::hcfftSetSingleTwiddles(hcfftPlanHandle plHandle,
+                                            bool singleTwiddles) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetSingleTwiddles"));
+
+  //  The twiddle tables and the kernels reading them change type
+  if (fftPlan->singleTwiddles != singleTwiddles) {
+    fftPlan->singleTwiddles = singleTwiddles;
+    fftPlan->baked = false;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+bool FFTPlan::hcfftHasHalfStorage(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return false;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftHasHalfStorage"));
+  return fftPlan->halfStorage;
+}
+
+//  Points the intermediate buffers of the baked plan tree that are not
+//  allocated yet into the work area. A plan without a work area that may not
+//  allocate fails if it needs an intermediate buffer not allocated yet, as
+//  does a work area smaller than the size reported for it.
+hcfftStatus FFTPlan::hcfftSliceWorkArea(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSliceWorkArea"));
+  size_t extent = 0;
+  hcfftStatus status = hcfftWalkWorkArea(plHandle, NULL, 0, &extent);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  //  Buffers allocated by an earlier transform are still there
+  if (fftPlan->workArea == NULL) {
+    return hcfftMissingBuffers(plHandle) ? HCFFT_INVALID : HCFFT_SUCCEEDS;
+  }
+
+  if (fftPlan->workAreaSize != 0 && extent > fftPlan->workAreaSize) {
+    return HCFFT_INVALID;
+  }
+
+  size_t offset = 0;
+  return hcfftWalkWorkArea(plHandle, static_cast<char*>(fftPlan->workArea),
+                           extent, &offset);
+}
+
+//  Adds the intermediate buffers of the plan and its sub-plans at offset,
+//  each aligned to 256 bytes, and with a base points those not allocated to
+//  their place in it
+hcfftStatus FFTPlan::hcfftWalkWorkArea(hcfftPlanHandle plHandle, char* base,
+                                       size_t extent, size_t* offset) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  const size_t align = 256;
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftWalkWorkArea"));
+    size_t sizes[3] = {fftPlan->tmpBufSize, fftPlan->tmpBufSizeRC,
+                       fftPlan->tmpBufSizeC2R};
+    void** buffers[3] = {&fftPlan->intBuffer, &fftPlan->intBufferRC,
+                         &fftPlan->intBufferC2R};
+
+    if (base != NULL) {
+      fftPlan->workArea = base;
+      fftPlan->workAreaSize = extent;
+    }
+
+    for (int i = 0; i < 3; i++) {
+      if (sizes[i] == 0) {
+        continue;
+      }
+
+      if (base != NULL && *buffers[i] == NULL) {
+        *buffers[i] = base + *offset;
+      }
+
+      *offset += (sizes[i] + align - 1) / align * align;
+    }
+
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i]) {
+      hcfftWalkWorkArea(subPlans[i], base, extent, offset);
+    }
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Whether an intermediate buffer of the plan tree is needed and not
+//  allocated yet, by an earlier transform or by a work area
+bool FFTPlan::hcfftMissingBuffers(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return false;
+  }
+
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftMissingBuffers"));
+    size_t sizes[3] = {fftPlan->tmpBufSize, fftPlan->tmpBufSizeRC,
+                       fftPlan->tmpBufSizeC2R};
+    void* buffers[3] = {fftPlan->intBuffer, fftPlan->intBufferRC,
+                        fftPlan->intBufferC2R};
+
+    for (int i = 0; i < 3; i++) {
+      if (sizes[i] != 0 && buffers[i] == NULL) {
+        return true;
+      }
+    }
+
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i] && hcfftMissingBuffers(subPlans[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+hcfftStatus FFTPlan::hcfftDropWorkArea(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftDropWorkArea"));
+    void** buffers[3] = {&fftPlan->intBuffer, &fftPlan->intBufferRC,
+                         &fftPlan->intBufferC2R};
+
+    for (int i = 0; i < 3; i++) {
+      if (fftPlan->InWorkArea(*buffers[i])) {
+        *buffers[i] = NULL;
+      }
+    }
+
+    fftPlan->workArea = NULL;
+    fftPlan->workAreaSize = 0;
+    fftPlan->workAreaOfCall = false;
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i]) {
+      hcfftDropWorkArea(subPlans[i]);
+    }
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Each transform of the plan queues a chunk of its batch on every view, after
+//  the work already queued on acc_view. Work queued on acc_view later waits
+//  for all the chunks, so the plan keeps the ordering of a single view.
+hcfftStatus FFTPlan::hcfftSetPlanSplitViews(
+    hcfftPlanHandle plHandle, const std::vector<hc::accelerator_view>& views) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanSplitViews"));
+
+  for (size_t i = 0; i < views.size(); i++) {
+    if (!(views[i].get_accelerator() == fftPlan->acc)) {
+      return HCFFT_INVALID;
+    }
+  }
+
+  fftPlan->splitViews = views;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftGetAcclView(hcfftPlanHandle plHandle,
+                                      hc::accelerator_view* acc_view) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetAcclView"));
+  *acc_view = fftPlan->acc_view;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Side of a validated transform, captured by value in its energy kernel.
+//  Strides and dist are in elements of the side. The first dimension of a
+//  hermitian side holds each conjugate pair of the length0 spectrum once,
+//  so all its elements but the first and, for even length0, the last count
+//  twice.
+struct validSide {
+  uint64_t length[3];
+  uint64_t stride[3];
+  uint64_t dist;
+  uint64_t length0;
+  bool complex;
+  bool hermitian;
+};
+
+//  Each tile of the energy kernel sums validPerItem * validTile elements of
+//  one batch element into a partial sum, so that no atomics are needed
+static const unsigned validTile = 256;
+static const unsigned validPerItem = 16;
+
+//  The input or the output of a plan as a side of its energy kernel. Planar
+//  and half precision storage are not validated, nor are the plans whose
+//  callbacks, window, extents or transposed output break Parseval's theorem
+//  between the buffers.
+static bool validSideOf(const FFTPlan* fftPlan, bool input, validSide* side) {
+  hcfftIpLayout layout = input ? fftPlan->ipLayout : fftPlan->opLayout;
+  const std::vector<size_t>& stride =
+      input ? fftPlan->inStride : fftPlan->outStride;
+
+  if (fftPlan->halfStorage || fftPlan->planarStorage ||
+      !fftPlan->loadCallback.empty() || !fftPlan->storeCallback.empty() ||
+      !fftPlan->window.empty() || !fftPlan->inputExtent.empty() ||
+      !fftPlan->outputExtent.empty() ||
+      fftPlan->transposeType == HCFFT_TRANSPOSED ||
+      fftPlan->length.size() > 3 ||
+      (layout != HCFFT_COMPLEX_INTERLEAVED &&
+       layout != HCFFT_HERMITIAN_INTERLEAVED && layout != HCFFT_REAL)) {
+    return false;
+  }
+
+  side->complex = layout != HCFFT_REAL;
+  side->hermitian = layout == HCFFT_HERMITIAN_INTERLEAVED;
+  side->length0 = fftPlan->length[0];
+  side->dist = input ? fftPlan->iDist : fftPlan->oDist;
+
+  for (size_t i = 0; i < 3; i++) {
+    side->length[i] = (i < fftPlan->length.size()) ? fftPlan->length[i] : 1;
+    side->stride[i] = (i < stride.size()) ? stride[i] : 0;
+  }
+
+  if (side->hermitian) {
+    side->length[0] = side->length0 / 2 + 1;
+  }
+
+  return true;
+}
+
+//  Queues the sums of the energy of blocks of each batch element of data on
+//  the view of the plan, blocks of them per batch element
+template <typename T>
+static void validEnergy(FFTPlan* fftPlan, const T* data, const validSide side,
+                        uint64_t blocks, double* partials) {
+  uint64_t elements = side.length[0] * side.length[1] * side.length[2];
+  hc::parallel_for_each(
+      fftPlan->acc_view,
+      hc::extent<1>(fftPlan->batchSize * blocks * validTile).tile(validTile),
+      [=](hc::tiled_index<1> tidx) [[hc]] {
+        tile_static double sums[validTile];
+        uint64_t tile = tidx.tile[0];
+        uint64_t b = tile / blocks;
+        uint64_t first = (tile % blocks) * validTile * validPerItem;
+        unsigned me = tidx.local[0];
+        double sum = 0;
+
+        for (unsigned j = 0; j < validPerItem; j++) {
+          uint64_t e = first + j * validTile + me;
+
+          if (e >= elements) {
+            break;
+          }
+
+          uint64_t i0 = e % side.length[0];
+          uint64_t rest = e / side.length[0];
+          uint64_t offset = b * side.dist + i0 * side.stride[0] +
+                            (rest % side.length[1]) * side.stride[1] +
+                            (rest / side.length[1]) * side.stride[2];
+          double energy;
+
+          if (side.complex) {
+            double re = data[2 * offset];
+            double im = data[2 * offset + 1];
+            energy = re * re + im * im;
+          } else {
+            double v = data[offset];
+            energy = v * v;
+          }
+
+          if (side.hermitian && i0 != 0 && 2 * i0 != side.length0) {
+            energy *= 2;
+          }
+
+          sum += energy;
+        }
+
+        sums[me] = sum;
+        tidx.barrier.wait();
+
+        for (unsigned half = validTile / 2; half > 0; half /= 2) {
+          if (me < half) {
+            sums[me] += sums[me + half];
+          }
+
+          tidx.barrier.wait();
+        }
+
+        if (me == 0) {
+          partials[tile] = sums[0];
+        }
+      });
+}
+
+//  Sizes the partial sums for the transform, and queues those of its input
+//  before its kernels. In place, the output is read where the input was.
+template <typename T>
+static bool validBegin(FFTPlan* fftPlan, hcfftDirection dir, const T* input,
+                       validSide* outSide) {
+  validSide inSide;
+  fftPlan->validBatch = 0;
+
+  if (!validSideOf(fftPlan, true, &inSide) ||
+      !validSideOf(fftPlan, false, outSide)) {
+    return false;
+  }
+
+  uint64_t elements = std::max(
+      inSide.length[0] * inSide.length[1] * inSide.length[2],
+      outSide->length[0] * outSide->length[1] * outSide->length[2]);
+  size_t blocks = (elements + validTile * validPerItem - 1) /
+                  (validTile * validPerItem);
+  size_t bytes = 2 * fftPlan->batchSize * blocks * sizeof(double);
+
+  if (fftPlan->validPartials != NULL &&
+      deviceBytes(fftPlan->validPartials) < bytes) {
+    fftPlan->acc_view.wait();
+    gaugedFree(fftPlan->validPartials, hcfftCounters.scratchBytes);
+    fftPlan->validPartials = NULL;
+  }
+
+  if (fftPlan->validPartials == NULL) {
+    fftPlan->validPartials = static_cast<double*>(
+        gaugedAlloc(bytes, fftPlan->acc, hcfftCounters.scratchBytes));
+
+    if (fftPlan->validPartials == NULL) {
+      return false;
+    }
+  }
+
+  if (fftPlan->ipLayout == HCFFT_REAL) {
+    dir = HCFFT_FORWARD;
+  } else if (fftPlan->opLayout == HCFFT_REAL) {
+    dir = HCFFT_BACKWARD;
+  }
+
+  double scale = (dir == HCFFT_BACKWARD) ? fftPlan->backwardScale
+                                         : fftPlan->forwardScale;
+  double N = 1;
+
+  for (size_t i = 0; i < fftPlan->length.size(); i++) {
+    N *= fftPlan->length[i];
+  }
+
+  fftPlan->validBlocks = blocks;
+  fftPlan->validBatch = fftPlan->batchSize;
+  fftPlan->validScale = scale * scale * N;
+  validEnergy(fftPlan, input, inSide, blocks, fftPlan->validPartials);
+  return true;
+}
+
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueTransform(hcfftPlanHandle plHandle,
+                                           hcfftDirection dir,
+                                           T* hcInputBuffers,
+                                           T* hcOutputBuffers,
+                                           T* hcTmpBuffers) {
+  hcfftStatus status = HCFFT_INVALID;
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueTransform"));
+  hcfftCounters.execs++;
+  hcInputBuffers = deviceAlias(hcInputBuffers);
+  hcOutputBuffers = deviceAlias(hcOutputBuffers);
+
+  if (fftPlan->baked == false) {
+    status = hcfftBakePlan(plHandle);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  hcfftScratchPool* pool = NULL;
+  status = hcfftAttachScratch(plHandle, pool);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  validSide outSide;
+  bool validate =
+      fftPlan->validate && validBegin(fftPlan, dir, hcInputBuffers, &outSide);
+
+  if (pool == NULL) {
+    status = hcfftEnqueueLaunches<T>(plHandle, dir, hcInputBuffers,
+                                     hcOutputBuffers, hcTmpBuffers);
+  } else {
+    //  The pool buffer may not be reallocated before all kernels using it
+    //  are queued
+    scopedLock sPoolLock(pool->lock, _T(" hcfftEnqueueTransform"));
+    status = hcfftSizeScratch(plHandle);
+
+    if (status == HCFFT_SUCCEEDS) {
+      status = hcfftEnqueueLaunches<T>(plHandle, dir, hcInputBuffers,
+                                       hcOutputBuffers, hcTmpBuffers);
+    }
+  }
+
+  if (validate && status == HCFFT_SUCCEEDS) {
+    T* output = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                     : hcOutputBuffers;
+    validEnergy(fftPlan, output, outSide, fftPlan->validBlocks,
+                fftPlan->validPartials +
+                    fftPlan->validBatch * fftPlan->validBlocks);
+  } else if (validate) {
+    fftPlan->validBatch = 0;
+  }
+
+  return status;
+}
+
+//  HCFFT_PROFILE profiles the transforms of every plan
+static bool ProfileFromEnv() {
+  static const bool profile = (getenv("HCFFT_PROFILE") != NULL) &&
+                              (atoi(getenv("HCFFT_PROFILE")) > 0);
+  return profile;
+}
+
+//  Paths of sub-plan members from the root of a tree to each of its plans
+static void PlanRoles(FFTPlan* fftPlan, const std::string& role,
+                      std::map<FFTPlan*, std::string>& roles) {
+  static const char* const names[8] = {"planX",  "planY",  "planZ",
+                                       "planTX", "planTY", "planTZ",
+                                       "planRCcopy", "planCopy"};
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  roles[fftPlan] = role;
+  hcfftPlanHandle subPlans[8] = {
+      fftPlan->planX,  fftPlan->planY,  fftPlan->planZ,
+      fftPlan->planTX, fftPlan->planTY, fftPlan->planTZ,
+      fftPlan->planRCcopy, fftPlan->planCopy};
+
+  for (int i = 0; i < 8; i++) {
+    FFTPlan* subPlan = NULL;
+    lockRAII* subLock = NULL;
+
+    if (subPlans[i] &&
+        fftRepo.getPlan(subPlans[i], subPlan, subLock) == HCFFT_SUCCEEDS) {
+      PlanRoles(subPlan, role == "plan" ? std::string(names[i])
+                                        : role + "/" + names[i],
+                roles);
+    }
+  }
+}
+
+//  Bytes of the elements of a buffer of layout a kernel of fftPlan spans
+//  over batch transforms
+static size_t LaunchBytes(const FFTPlan* fftPlan, hcfftIpLayout layout,
+                          uint batch) {
+  bool hermitian = (layout == HCFFT_HERMITIAN_INTERLEAVED ||
+                    layout == HCFFT_HERMITIAN_PLANAR);
+  size_t elements = std::max<uint>(1, batch);
+
+  for (size_t i = 0; i < fftPlan->length.size(); i++) {
+    elements *= (i == 0 && hermitian) ? fftPlan->length[0] / 2 + 1
+                                      : fftPlan->length[i];
+  }
+
+  size_t real =
+      fftPlan->halfStorage ? 2 : width(fftPlan->precision) * sizeof(float);
+  return elements * (layout == HCFFT_REAL ? real : 2 * real);
+}
+
+//  Nominal flops of a kernel of fftPlan over batch transforms. Stockham
+//  kernels transform dimension 0, the others being rows of the batch.
+static double LaunchFlops(const FFTPlan* fftPlan, uint batch) {
+  if (fftPlan->gen != Stockham || fftPlan->length.empty() ||
+      fftPlan->length[0] < 2) {
+    return 0;
+  }
+
+  double rows = std::max<uint>(1, batch);
+
+  for (size_t i = 1; i < fftPlan->length.size(); i++) {
+    rows *= fftPlan->length[i];
+  }
+
+  double n = fftPlan->length[0];
+  bool real =
+      (fftPlan->ipLayout == HCFFT_REAL || fftPlan->opLayout == HCFFT_REAL);
+  return (real ? 2.5 : 5.0) * rows * n * log2(n);
+}
+
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueLaunches(hcfftPlanHandle plHandle,
+                                          hcfftDirection dir,
+                                          T* hcInputBuffers,
+                                          T* hcOutputBuffers,
+                                          T* hcTmpBuffers) {
+  hcfftStatus status = HCFFT_SUCCEEDS;
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueLaunches"));
+
+  if (fftPlan->ipLayout == HCFFT_REAL) {
+    dir = HCFFT_FORWARD;
+  } else if (fftPlan->opLayout == HCFFT_REAL) {
+    dir = HCFFT_BACKWARD;
+  }
+
+  std::vector<hcfftLaunch>& launches =
+      (dir == HCFFT_BACKWARD) ? fftPlan->launchesBack : fftPlan->launchesFwd;
+
+  //  Recorded launches already use the buffers carved from the work area
+  if ((fftPlan->workArea != NULL || !fftPlan->autoAllocate) &&
+      (launches.empty() || hcTmpBuffers != NULL)) {
+    status = hcfftSliceWorkArea(plHandle);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  //  A temporary buffer of the caller takes the place of the plan buffers
+  //  the launches were recorded with. The launches of a Rader plan take the
+  //  input as callback data too, so they are not recorded.
+  if (hcTmpBuffers != NULL || fftPlan->rader) {
+    status = hcfftEnqueueTransformInternal<T>(plHandle, dir, hcInputBuffers,
+                                              hcOutputBuffers, hcTmpBuffers);
+    fftPlan->transformed = true;
+    return status;
+  }
+
+  if (launches.empty()) {
+    status = hcfftRecordLaunches<T>(plHandle, dir, launches);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  //  Profiled transforms keep the whole batch on the view of the plan, which
+  //  the markers are queued on
+  bool profile = fftPlan->profile || ProfileFromEnv();
+
+  if (!profile && fftPlan->CanSplitBatch(launches)) {
+    fftPlan->EnqueueSplitBatch(launches[0], hcInputBuffers, hcOutputBuffers);
+    fftPlan->transformed = true;
+    return HCFFT_SUCCEEDS;
+  }
+
+  std::map<FFTPlan*, std::string> roles;
+
+  if (profile || hcfftTracing) {
+    PlanRoles(fftPlan, "plan", roles);
+  }
+
+  if (profile) {
+    fftPlan->profileKernels.clear();
+    fftPlan->profileMarkers.clear();
+    fftPlan->profileMarkers.push_back(fftPlan->acc_view.create_marker());
+  }
+
+  for (size_t i = 0; i < launches.size(); i++) {
+    hcfftLaunch& launch = launches[i];
+    FFTPlan* plan = launch.plan;
+    void* input = fftPlan->CallBuffer(
+        launchBuffer(launch.input, hcInputBuffers, hcOutputBuffers));
+    void* output = fftPlan->CallBuffer(
+        launchBuffer(launch.output, hcInputBuffers, hcOutputBuffers));
+
+    for (unsigned int j = 0; j < plan->kernelArgIn; j++) {
+      plan->kernelArgs.buffers[j] = input;
+    }
+
+    for (unsigned int j = 0; j < plan->kernelArgOut; j++) {
+      plan->kernelArgs.buffers[plan->kernelArgIn + j] = output;
+    }
+
+    {
+      HCFFT_TRACE_RANGE("hcfft plan " << plHandle << " "
+                                      << (roles.count(plan) ? roles[plan]
+                                                            : "plan")
+                                      << " " << GeneratorName(plan->gen));
+      launch.call(&plan->kernelArgs, launch.batch, plan->acc_view, plan->acc);
+    }
+
+    hcfftCounters.launches++;
+
+    if (profile) {
+      hcfftKernelProfile kernel;
+      kernel.role = roles.count(plan) ? roles[plan] : std::string("plan");
+      kernel.gen = plan->gen;
+      kernel.bytes = LaunchBytes(plan, plan->ipLayout, launch.batch) +
+                     LaunchBytes(plan, plan->opLayout, launch.batch);
+      kernel.flops = LaunchFlops(plan, launch.batch);
+      fftPlan->profileKernels.push_back(kernel);
+      fftPlan->profileMarkers.push_back(plan->acc_view.create_marker());
+    }
+  }
+
+  fftPlan->transformed = true;
+  return HCFFT_SUCCEEDS;
+}
+
+//  The walk of hcfftEnqueueTransformInternal over the sub-plans only depends
+//  on the baked plan and the direction. It is run once with tags for the
+//  buffers of the transform, every kernel it reaches being appended to
+//  launches, and later transforms replay the list.
+template <typename T>
+hcfftStatus FFTPlan::hcfftRecordLaunches(hcfftPlanHandle plHandle,
+                                         hcfftDirection dir,
+                                         std::vector<hcfftLaunch>& launches) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftRecordLaunches"));
+  launches.clear();
+  hcfftSetLaunchRecord(plHandle, &launches);
+  T* input = reinterpret_cast<T*>(const_cast<char*>(&launchInput));
+  T* output = reinterpret_cast<T*>(const_cast<char*>(&launchOutput));
+  hcfftStatus status =
+      hcfftEnqueueTransformInternal<T>(plHandle, dir, input, output, NULL);
+  hcfftSetLaunchRecord(plHandle, NULL);
+
+  if (status != HCFFT_SUCCEEDS) {
+    launches.clear();
+  }
+
+  return status;
+}
+
+hcfftStatus FFTPlan::hcfftSetLaunchRecord(hcfftPlanHandle plHandle,
+                                          std::vector<hcfftLaunch>* record) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftSetLaunchRecord"));
+    fftPlan->launchRecord = record;
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i]) {
+      hcfftSetLaunchRecord(subPlans[i], record);
+    }
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftGetRunSteps(hcfftPlanHandle plHandle,
+                                      size_t* inBytes, size_t* outBytes) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetRunSteps"));
+  size_t element = fftPlan->ElementSize();
+  *inBytes = fftPlan->batchSize * fftPlan->iDist * element /
+             ((fftPlan->ipLayout == HCFFT_REAL) ? 2 : 1);
+  *outBytes = fftPlan->batchSize * fftPlan->oDist * element /
+              ((fftPlan->opLayout == HCFFT_REAL) ? 2 : 1);
+  return HCFFT_SUCCEEDS;
+}
+
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueRun(hcfftPlanHandle plHandle,
+                                     hcfftDirection dir, T* input, T* output,
+                                     size_t count) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  size_t inBytes = 0;
+  size_t outBytes = 0;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS ||
+      hcfftGetRunSteps(plHandle, &inBytes, &outBytes) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueRun"));
+  char* in = reinterpret_cast<char*>(deviceAlias(input));
+  char* out = reinterpret_cast<char*>(deviceAlias(output));
+  hcfftDirection launchDir = dir;
+
+  if (fftPlan->ipLayout == HCFFT_REAL) {
+    launchDir = HCFFT_FORWARD;
+  } else if (fftPlan->opLayout == HCFFT_REAL) {
+    launchDir = HCFFT_BACKWARD;
+  }
+
+  std::vector<hcfftLaunch>& launches = (launchDir == HCFFT_BACKWARD)
+                                           ? fftPlan->launchesBack
+                                           : fftPlan->launchesFwd;
+
+  //  The first transform of a plan bakes it and records its launches
+  if (!fftPlan->baked || launches.empty()) {
+    hcfftStatus status = hcfftEnqueueTransform<T>(
+        plHandle, dir, reinterpret_cast<T*>(in), reinterpret_cast<T*>(out),
+        NULL);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    in += inBytes;
+    out += outBytes;
+    count--;
+  }
+
+  bool profile = fftPlan->profile || ProfileFromEnv();
+  bool rebatch = !profile && !fftPlan->validate && !fftPlan->rader &&
+                 fftPlan->CanRebatch(launches) &&
+                 launches[0].input == &launchInput &&
+                 launches[0].output == &launchOutput;
+
+  if (!rebatch) {
+    for (size_t i = 0; i < count; i++) {
+      hcfftStatus status = hcfftEnqueueTransform<T>(
+          plHandle, dir, reinterpret_cast<T*>(in + i * inBytes),
+          reinterpret_cast<T*>(out + i * outBytes), NULL);
+
+      if (status != HCFFT_SUCCEEDS) {
+        return status;
+      }
+    }
+
+    return HCFFT_SUCCEEDS;
+  }
+
+  if (count == 0) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  const hcfftLaunch& launch = launches[0];
+
+  for (unsigned int j = 0; j < fftPlan->kernelArgIn; j++) {
+    fftPlan->kernelArgs.buffers[j] = in;
+  }
+
+  for (unsigned int j = 0; j < fftPlan->kernelArgOut; j++) {
+    fftPlan->kernelArgs.buffers[fftPlan->kernelArgIn + j] = out;
+  }
+
+  {
+    HCFFT_TRACE_RANGE("hcfft plan " << plHandle << " run of " << count << " "
+                                    << GeneratorName(fftPlan->gen));
+    launch.call(&fftPlan->kernelArgs, launch.batch * count, fftPlan->acc_view,
+                fftPlan->acc);
+  }
+
+  hcfftCounters.execs += count;
+  hcfftCounters.launches++;
+  fftPlan->transformed = true;
+  return HCFFT_SUCCEEDS;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueTransform(hcfftPlanHandle plHandle,
+                                                    hcfftDirection dir,
+                                                    float* hcInputBuffers,
+                                                    float* hcOutputBuffers,
+                                                    float* hcTmpBuffers);
+template hcfftStatus FFTPlan::hcfftEnqueueTransform(hcfftPlanHandle plHandle,
+                                                    hcfftDirection dir,
+                                                    double* hcInputBuffers,
+                                                    double* hcOutputBuffers,
+                                                    double* hcTmpBuffers);
+template hcfftStatus FFTPlan::hcfftEnqueueRun(hcfftPlanHandle plHandle,
+                                              hcfftDirection dir, float* input,
+                                              float* output, size_t count);
+template hcfftStatus FFTPlan::hcfftEnqueueRun(hcfftPlanHandle plHandle,
+                                              hcfftDirection dir,
+                                              double* input, double* output,
+                                              size_t count);
+
+//  Store callback of the forward convolution transform: the spectrum of the
+//  filter is read at the offset of the coefficient being written
+static const char* convolveStoreName = "hcfftConvolveStore";
+
+static std::string convolveStoreSource(hcfftPrecision precision) {
+  std::string type = (precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string str;
+  str += "void hcfftConvolveStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += "\t" + type + " f = static_cast<" + type;
+  str += " *>(callerInfo)[offset];\n";
+  str += "\tbuffer[offset] = " + type + "(element.x * f.x - element.y * f.y, ";
+  str += "element.x * f.y + element.y * f.x);\n}\n";
+  return str;
+}
+
+//  Creates a user plan with the sizes and layouts of a 2D real to hermitian
+//  plan, transforming in the direction dir. The backward plan reads the
+//  hermitian data that the forward one writes and writes the real layout.
+hcfftStatus FFTPlan::hcfftCreateConvolutionPlan(hcfftPlanHandle plHandle,
+                                                hcfftDirection dir,
+                                                hcfftPlanHandle* convHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftCreateConvolutionPlan"));
+  bool fwd = (dir == HCFFT_FORWARD);
+  size_t lengths[2] = {fftPlan->length[0], fftPlan->length[1]};
+  hcfftStatus status =
+      hcfftCreateDefaultPlan(convHandle, HCFFT_2D, lengths, dir,
+                             fftPlan->precision,
+                             fwd ? HCFFT_R2CD2Z : HCFFT_C2RZ2D);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  FFTPlan* convPlan = NULL;
+  lockRAII* convLock = NULL;
+  fftRepo.getPlan(*convHandle, convPlan, convLock);
+  scopedLock sConvLock(*convLock, _T(" hcfftCreateConvolutionPlan"));
+  convPlan->precision = fftPlan->precision;
+  convPlan->transposeType = HCFFT_NOTRANSPOSE;
+  convPlan->location = HCFFT_OUTOFPLACE;
+  convPlan->batchSize = fftPlan->batchSize;
+  convPlan->acc = fftPlan->acc;
+  convPlan->acc_view = fftPlan->acc_view;
+  convPlan->envelope = fftPlan->envelope;
+
+  if (fwd) {
+    convPlan->ipLayout = HCFFT_REAL;
+    convPlan->opLayout = HCFFT_HERMITIAN_INTERLEAVED;
+    convPlan->inStride = fftPlan->inStride;
+    convPlan->outStride = fftPlan->outStride;
+    convPlan->iDist = fftPlan->iDist;
+    convPlan->oDist = fftPlan->oDist;
+    convPlan->forwardScale = fftPlan->forwardScale;
+    convPlan->storeCallback.funcName = convolveStoreName;
+    convPlan->storeCallback.funcString =
+        convolveStoreSource(fftPlan->precision);
+  } else {
+    convPlan->ipLayout = HCFFT_HERMITIAN_INTERLEAVED;
+    convPlan->opLayout = HCFFT_REAL;
+    convPlan->inStride = fftPlan->outStride;
+    convPlan->outStride = fftPlan->inStride;
+    convPlan->iDist = fftPlan->oDist;
+    convPlan->oDist = fftPlan->iDist;
+    convPlan->backwardScale = fftPlan->backwardScale;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  The multiply by the filter runs in the kernel writing the output of the
+//  forward transform. Real to hermitian plans have no use for intBufferC2R,
+//  so it holds the product until the inverse transform has read it.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueConvolution(hcfftPlanHandle plHandle,
+                                             T* input, T* filter, T* output) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueConvolution"));
+
+  if ((fftPlan->hcfftlibtype != HCFFT_R2CD2Z) ||
+      (fftPlan->dimension != HCFFT_2D) || (fftPlan->length.size() != 2)) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftStatus status = HCFFT_SUCCEEDS;
+
+  if (fftPlan->planConvFwd == 0) {
+    status = hcfftCreateConvolutionPlan(plHandle, HCFFT_FORWARD,
+                                        &fftPlan->planConvFwd);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  if (fftPlan->planConvBack == 0) {
+    status = hcfftCreateConvolutionPlan(plHandle, HCFFT_BACKWARD,
+                                        &fftPlan->planConvBack);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  if (fftPlan->intBufferC2R == NULL) {
+    scopedTimer timer(fftPlan->timings.alloc);
+    fftPlan->tmpBufSizeC2R =
+        fftPlan->oDist * fftPlan->batchSize * fftPlan->ElementSize();
+    fftPlan->intBufferC2R = gaugedAlloc(fftPlan->tmpBufSizeC2R, fftPlan->acc,
+                                        hcfftCounters.scratchBytes);
+
+    if (fftPlan->intBufferC2R == NULL) {
+      return HCFFT_INVALID;
+    }
+  }
+
+  hcfftPlanHandle convPlans[2] = {fftPlan->planConvFwd, fftPlan->planConvBack};
+
+  for (int i = 0; i < 2; i++) {
+    hcfftSetAcclView(convPlans[i], fftPlan->acc_view);
+  }
+
+  status = hcfftSetPlanCallbackData(fftPlan->planConvFwd, HCFFT_CALLBACK_STORE,
+                                    filter);
+
+  for (int i = 0; status == HCFFT_SUCCEEDS && i < 2; i++) {
+    status = hcfftBakePlan(convPlans[i]);
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  T* spectrum = static_cast<T*>(fftPlan->intBufferC2R);
+  status = hcfftEnqueueTransform<T>(fftPlan->planConvFwd, HCFFT_FORWARD, input,
+                                    spectrum, NULL);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  status = hcfftEnqueueTransform<T>(fftPlan->planConvBack, HCFFT_BACKWARD,
+                                    spectrum, output, NULL);
+  fftPlan->transformed = true;
+  return status;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueConvolution(hcfftPlanHandle plHandle,
+                                                      float* input,
+                                                      float* filter,
+                                                      float* output);
+template hcfftStatus FFTPlan::hcfftEnqueueConvolution(hcfftPlanHandle plHandle,
+                                                      double* input,
+                                                      double* filter,
+                                                      double* output);
+
+//  The slab plan transforms depth planes of the volume along x and y. The
+//  pencil plan transforms the z axis of rows rows of every plane, staged one
+//  plane after the other, and scales the result like the 3D plan.
+hcfftStatus FFTPlan::hcfftCreateStreamPlans(hcfftPlanHandle plHandle,
+                                            size_t depth, size_t rows) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftCreateStreamPlans"));
+
+  if (fftPlan->planStreamXY == 0 || fftPlan->streamDepth != depth ||
+      fftPlan->streamRows != rows) {
+    hcfftReleaseStreamPlans(plHandle);
+    size_t lengths[2] = {fftPlan->length[0], fftPlan->length[1]};
+    hcfftStatus status = hcfftCreateDefaultPlan(
+        &fftPlan->planStreamXY, HCFFT_2D, lengths, fftPlan->direction,
+        fftPlan->precision, HCFFT_C2CZ2Z);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    status = hcfftCreateDefaultPlan(&fftPlan->planStreamZ, HCFFT_1D,
+                                    &fftPlan->length[2], fftPlan->direction,
+                                    fftPlan->precision, HCFFT_C2CZ2Z);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    FFTPlan* xyPlan = NULL;
+    lockRAII* xyLock = NULL;
+    fftRepo.getPlan(fftPlan->planStreamXY, xyPlan, xyLock);
+    {
+      scopedLock sXYLock(*xyLock, _T(" hcfftCreateStreamPlans"));
+      xyPlan->precision = fftPlan->precision;
+      xyPlan->batchSize = depth;
+      xyPlan->forwardScale = 1.0;
+      xyPlan->backwardScale = 1.0;
+      xyPlan->envelope = fftPlan->envelope;
+      xyPlan->lowMemory = true;
+    }
+
+    FFTPlan* zPlan = NULL;
+    lockRAII* zLock = NULL;
+    fftRepo.getPlan(fftPlan->planStreamZ, zPlan, zLock);
+    {
+      scopedLock sZLock(*zLock, _T(" hcfftCreateStreamPlans"));
+      zPlan->precision = fftPlan->precision;
+      zPlan->batchSize = rows * fftPlan->length[0];
+      zPlan->inStride[0] = rows * fftPlan->length[0];
+      zPlan->outStride[0] = rows * fftPlan->length[0];
+      zPlan->iDist = 1;
+      zPlan->oDist = 1;
+      zPlan->forwardScale = fftPlan->forwardScale;
+      zPlan->backwardScale = fftPlan->backwardScale;
+      zPlan->envelope = fftPlan->envelope;
+    }
+
+    size_t plane = fftPlan->length[0] * fftPlan->length[1];
+    size_t bytes = std::max(depth * plane, rows * fftPlan->length[0] *
+                                               fftPlan->length[2]) *
+                   fftPlan->ElementSize();
+
+    for (int i = 0; i < 2; i++) {
+      scopedTimer timer(fftPlan->timings.alloc);
+      fftPlan->streamBuffers[i] =
+          gaugedAlloc(bytes, fftPlan->acc, hcfftCounters.scratchBytes);
+
+      if (fftPlan->streamBuffers[i] == NULL) {
+        return HCFFT_ERROR;
+      }
+    }
+
+    fftPlan->streamDepth = depth;
+    fftPlan->streamRows = rows;
+  }
+
+  if (fftPlan->streamCopyView.empty()) {
+    fftPlan->streamCopyView.push_back(fftPlan->acc.create_view());
+  }
+
+  hcfftSetAcclView(fftPlan->planStreamXY, fftPlan->acc_view);
+  hcfftSetAcclView(fftPlan->planStreamZ, fftPlan->acc_view);
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftReleaseStreamPlans(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftReleaseStreamPlans"));
+
+  if (fftPlan->planStreamXY) {
+    hcfftDestroyPlan(&fftPlan->planStreamXY);
+    fftPlan->planStreamXY = 0;
+  }
+
+  if (fftPlan->planStreamZ) {
+    hcfftDestroyPlan(&fftPlan->planStreamZ);
+    fftPlan->planStreamZ = 0;
+  }
+
+  for (int i = 0; i < 2; i++) {
+    if (fftPlan->streamBuffers[i]) {
+      gaugedFree(fftPlan->streamBuffers[i], hcfftCounters.scratchBytes);
+      fftPlan->streamBuffers[i] = NULL;
+    }
+  }
+
+  fftPlan->streamDepth = 0;
+  fftPlan->streamRows = 0;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Transforms of the batch the plan gives the accelerator gpu of count. The
+//  chunks are contiguous, and the first batch % count are one transform
+//  longer.
+static size_t gpuBatch(size_t batch, size_t count, size_t gpu) {
+  return batch / count + (gpu < batch % count ? 1 : 0);
+}
+
+static size_t gpuBatchStart(size_t batch, size_t count, size_t gpu) {
+  return gpu * (batch / count) + std::min(gpu, batch % count);
+}
+
+//  The plans of the accelerators are created at the next transform, so that
+//  they take the settings the plan has then
+hcfftStatus FFTPlan::hcfftSetPlanGPUs(
+    hcfftPlanHandle plHandle, const std::vector<hc::accelerator>& accs) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanGPUs"));
+  size_t limit = fftPlan->batchSize;
+
+  //  A single complex volume is split into slabs of its planes and pencils
+  //  of its rows instead
+  if (fftPlan->batchSize == 1 && fftPlan->dimension == HCFFT_3D &&
+      fftPlan->hcfftlibtype == HCFFT_C2CZ2Z) {
+    limit = std::min(fftPlan->length[1], fftPlan->length[2]);
+  }
+
+  if (accs.size() > limit) {
+    return HCFFT_INVALID;
+  }
+
+  for (size_t i = 0; i < accs.size(); i++) {
+    if (accs[i].get_is_emulated()) {
+      return HCFFT_INVALID;
+    }
+
+    for (size_t j = 0; j < i; j++) {
+      if (accs[j] == accs[i]) {
+        return HCFFT_INVALID;
+      }
+    }
+  }
+
+  hcfftStatus status = hcfftReleaseGPUPlans(plHandle);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  fftPlan->gpus = accs;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftGetPlanGPUBatches(hcfftPlanHandle plHandle,
+                                            std::vector<size_t>& batches) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetPlanGPUBatches"));
+  batches.clear();
+
+  for (size_t i = 0; i < fftPlan->gpus.size(); i++) {
+    batches.push_back(gpuBatch(fftPlan->batchSize, fftPlan->gpus.size(), i));
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Each plan is a user plan of its own on the default view of its
+//  accelerator, so that it bakes its kernels and twiddles for the device and
+//  takes its work area from the scratch pool of the view
+hcfftStatus FFTPlan::hcfftCreateGPUPlans(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftCreateGPUPlans"));
+
+  for (size_t i = fftPlan->gpuPlans.size(); i < fftPlan->gpus.size(); i++) {
+    hcfftPlanHandle gpuHandle = 0;
+    hcfftStatus status = hcfftCreateDefaultPlan(
+        &gpuHandle, fftPlan->dimension, &fftPlan->originalLength[0],
+        fftPlan->direction, fftPlan->precision, fftPlan->hcfftlibtype);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    fftPlan->gpuPlans.push_back(gpuHandle);
+    FFTPlan* gpuPlan = NULL;
+    lockRAII* gpuLock = NULL;
+    fftRepo.getPlan(gpuHandle, gpuPlan, gpuLock);
+    {
+      scopedLock sGpuLock(*gpuLock, _T(" hcfftCreateGPUPlans"));
+      gpuPlan->precision = fftPlan->precision;
+      gpuPlan->transposeType = fftPlan->transposeType;
+      gpuPlan->inStride = fftPlan->inStride;
+      gpuPlan->outStride = fftPlan->outStride;
+      gpuPlan->iDist = fftPlan->iDist;
+      gpuPlan->oDist = fftPlan->oDist;
+      gpuPlan->batchSize =
+          gpuBatch(fftPlan->batchSize, fftPlan->gpus.size(), i);
+      gpuPlan->forwardScale = fftPlan->forwardScale;
+      gpuPlan->backwardScale = fftPlan->backwardScale;
+      gpuPlan->lowMemory = fftPlan->lowMemory;
+      gpuPlan->singleTwiddles = fftPlan->singleTwiddles;
+      gpuPlan->computeTwiddles = fftPlan->computeTwiddles;
+      gpuPlan->autotune = fftPlan->autotune;
+      gpuPlan->ldsPadding = fftPlan->ldsPadding;
+      gpuPlan->tuneWorkGroupSize = fftPlan->tuneWorkGroupSize;
+      gpuPlan->tuneNumTrans = fftPlan->tuneNumTrans;
+    }
+
+    hcfftSetAcclView(gpuHandle, fftPlan->gpus[i].get_default_view());
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftReleaseGPUPlans(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftReleaseGPUPlans"));
+
+  for (size_t i = 0; i < fftPlan->gpuPlans.size(); i++) {
+    hcfftDestroyPlan(&fftPlan->gpuPlans[i]);
+  }
+
+  for (size_t i = 0; i < fftPlan->gpuSlabPlans.size(); i++) {
+    hcfftDestroyPlan(&fftPlan->gpuSlabPlans[i]);
+  }
+
+  for (size_t i = 0; i < fftPlan->gpuPencilPlans.size(); i++) {
+    hcfftDestroyPlan(&fftPlan->gpuPencilPlans[i]);
+  }
+
+  fftPlan->gpuPlans.clear();
+  fftPlan->gpuSlabPlans.clear();
+  fftPlan->gpuPencilPlans.clear();
+  fftPlan->gpuCopyViews.clear();
+
+  if (fftPlan->hybridPlan) {
+    hcfftDestroyPlan(&fftPlan->hybridPlan);
+    fftPlan->hybridPlan = 0;
+  }
+
+  for (std::map<void*, hcfftPlanHandle>::iterator it =
+           fftPlan->queuePlans.begin();
+       it != fftPlan->queuePlans.end(); ++it) {
+    hcfftDestroyPlan(&it->second);
+  }
+
+  fftPlan->queuePlans.clear();
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Settings a copy of a plan takes from it before its first bake, all but
+//  the placeness and layouts of the buffers it is baked for
+static void copyPlanSettings(const FFTPlan* from, FFTPlan* to) {
+  to->precision = from->precision;
+  to->transposeType = from->transposeType;
+  to->inStride = from->inStride;
+  to->outStride = from->outStride;
+  to->iDist = from->iDist;
+  to->oDist = from->oDist;
+  to->batchSize = from->batchSize;
+  to->forwardScale = from->forwardScale;
+  to->backwardScale = from->backwardScale;
+  to->loadCallback = from->loadCallback;
+  to->storeCallback = from->storeCallback;
+  to->window = from->window;
+  to->inputExtent = from->inputExtent;
+  to->outputExtent = from->outputExtent;
+  to->lowMemory = from->lowMemory;
+  to->halfStorage = from->halfStorage;
+  to->planarStorage = from->planarStorage;
+  to->singleTwiddles = from->singleTwiddles;
+  to->computeTwiddles = from->computeTwiddles;
+  to->hostThreshold = from->hostThreshold;
+  to->hybrid = from->hybrid;
+  to->autotune = from->autotune;
+  to->ldsPadding = from->ldsPadding;
+  to->tuneWorkGroupSize = from->tuneWorkGroupSize;
+  to->tuneNumTrans = from->tuneNumTrans;
+  to->profile = from->profile;
+  to->validate = from->validate;
+}
+
+hcfftStatus FFTPlan::hcfftGetQueuePlan(hcfftPlanHandle plHandle,
+                                       hc::accelerator_view& acc_view,
+                                       hcfftPlanHandle* queuePlan) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetQueuePlan"));
+  void* queue = acc_view.get_hsa_queue();
+
+  if (queue == fftPlan->acc_view.get_hsa_queue()) {
+    *queuePlan = plHandle;
+    return HCFFT_SUCCEEDS;
+  }
+
+  std::map<void*, hcfftPlanHandle>::iterator found =
+      fftPlan->queuePlans.find(queue);
+
+  if (found != fftPlan->queuePlans.end()) {
+    *queuePlan = found->second;
+    return HCFFT_SUCCEEDS;
+  }
+
+  // Copies of a plan split across accelerators would share them
+  if (!fftPlan->gpus.empty()) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftPlanHandle copyHandle = 0;
+  hcfftStatus status = hcfftCreateDefaultPlan(
+      &copyHandle, fftPlan->dimension, &fftPlan->originalLength[0],
+      fftPlan->direction, fftPlan->precision, fftPlan->hcfftlibtype);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  FFTPlan* copyPlan = NULL;
+  lockRAII* copyLock = NULL;
+  fftRepo.getPlan(copyHandle, copyPlan, copyLock);
+  {
+    // The copy bakes from the kernel cache the plan has filled
+    scopedLock sCopyLock(*copyLock, _T(" hcfftGetQueuePlan"));
+    copyPlanSettings(fftPlan, copyPlan);
+    copyPlan->location = fftPlan->location;
+    copyPlan->ipLayout = fftPlan->ipLayout;
+    copyPlan->opLayout = fftPlan->opLayout;
+    copyPlan->autoAllocate = fftPlan->autoAllocate;
+  }
+
+  hcfftSetAcclView(copyHandle, acc_view);
+  fftPlan->queuePlans[queue] = copyHandle;
+  *queuePlan = copyHandle;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftClonePlan(hcfftPlanHandle plHandle, size_t batch,
+                                    hcfftPlanHandle* clone) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftClonePlan"));
+
+  if (batch == 0 || !fftPlan->gpus.empty()) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftPlanHandle cloneHandle = 0;
+  hcfftStatus status = hcfftCreateDefaultPlan(
+      &cloneHandle, fftPlan->dimension, &fftPlan->originalLength[0],
+      fftPlan->direction, fftPlan->precision, fftPlan->hcfftlibtype);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  FFTPlan* clonePlan = NULL;
+  lockRAII* cloneLock = NULL;
+  fftRepo.getPlan(cloneHandle, clonePlan, cloneLock);
+  {
+    scopedLock sCloneLock(*cloneLock, _T(" hcfftClonePlan"));
+    copyPlanSettings(fftPlan, clonePlan);
+    clonePlan->batchSize = batch;
+    clonePlan->location = fftPlan->location;
+    clonePlan->ipLayout = fftPlan->ipLayout;
+    clonePlan->opLayout = fftPlan->opLayout;
+    clonePlan->autoAllocate = fftPlan->autoAllocate;
+  }
+
+  hcfftSetAcclView(cloneHandle, fftPlan->acc_view);
+
+  // The kernels and twiddle tables of the plan are in the caches of the
+  // repo, so that the bake only sizes the tree for the batch
+  if (fftPlan->baked) {
+    status = hcfftBakePlan(cloneHandle);
+
+    if (status != HCFFT_SUCCEEDS) {
+      hcfftDestroyPlan(&cloneHandle);
+      return status;
+    }
+  }
+
+  *clone = cloneHandle;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Plan files are written and read by the same library build. Values are
+//  stored in the layout of the host, strings and vectors after their size.
+static const char* const planFileHeader = "hcfft-plan 1";
+
+class planWriter {
+ public:
+  explicit planWriter(FILE* file) : good(true), file(file) {}
+
+  void bytes(const void* data, size_t size) {
+    good = good && (size == 0 || fwrite(data, size, 1, file) == 1);
+  }
+
+  template <typename T>
+  void operator()(const T& value) {
+    bytes(&value, sizeof(T));
+  }
+
+  void operator()(const std::string& value) {
+    (*this)(value.size());
+    bytes(value.data(), value.size());
+  }
+
+  void operator()(const std::vector<size_t>& values) {
+    (*this)(values.size());
+    bytes(values.data(), values.size() * sizeof(size_t));
+  }
+
+  bool good;
+
+ private:
+  FILE* file;
+};
+
+//  Sizes are checked against the bytes left in the file, so that a
+//  truncated or corrupt file fails to parse instead of allocating
+class planReader {
+ public:
+  planReader(FILE* file, size_t size) : good(true), file(file), left(size) {}
+
+  void bytes(void* data, size_t size) {
+    good = good && (size <= left) &&
+           (size == 0 || fread(data, size, 1, file) == 1);
+    left = good ? left - size : 0;
+  }
+
+  template <typename T>
+  void operator()(T& value) {
+    bytes(&value, sizeof(T));
+  }
+
+  void operator()(std::string& value) {
+    size_t size = 0;
+    (*this)(size);
+    good = good && (size <= left);
+    value.resize(good ? size : 0);
+    bytes(&value[0], value.size());
+  }
+
+  void operator()(std::vector<size_t>& values) {
+    size_t size = 0;
+    (*this)(size);
+    good = good && (size <= left / sizeof(size_t));
+    values.resize(good ? size : 0);
+    bytes(values.data(), values.size() * sizeof(size_t));
+  }
+
+  bool done() const { return good && left == 0; }
+
+  bool good;
+
+ private:
+  FILE* file;
+  size_t left;
+};
+
+//  Settings of a plan file: those copyPlanSettings copies, the placeness
+//  and layouts of the baked plan, and what it is created with
+template <typename IO>
+static void planSettingsIO(IO& io, FFTPlan* plan) {
+  io(plan->dimension);
+  io(plan->originalLength);
+  io(plan->direction);
+  io(plan->hcfftlibtype);
+  io(plan->location);
+  io(plan->ipLayout);
+  io(plan->opLayout);
+  io(plan->precision);
+  io(plan->transposeType);
+  io(plan->inStride);
+  io(plan->outStride);
+  io(plan->iDist);
+  io(plan->oDist);
+  io(plan->batchSize);
+  io(plan->forwardScale);
+  io(plan->backwardScale);
+  io(plan->loadCallback.funcName);
+  io(plan->loadCallback.funcString);
+  io(plan->storeCallback.funcName);
+  io(plan->storeCallback.funcString);
+  io(plan->lowMemory);
+  io(plan->halfStorage);
+  io(plan->planarStorage);
+  io(plan->singleTwiddles);
+  io(plan->computeTwiddles);
+  io(plan->hostThreshold);
+  io(plan->hybrid);
+  io(plan->autotune);
+  io(plan->ldsPadding);
+  io(plan->tuneWorkGroupSize);
+  io(plan->tuneNumTrans);
+  io(plan->profile);
+  io(plan->validate);
+  io(plan->autoAllocate);
+}
+
+//  Plans of the tree of a baked plan that call a kernel of their own
+static void collectLeaves(FFTPlan* fftPlan, std::vector<FFTPlan*>& leaves) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+
+  if (fftPlan->kernelPtr || fftPlan->kernelPtrBack) {
+    leaves.push_back(fftPlan);
+  }
+
+  hcfftPlanHandle subPlans[8] = {
+      fftPlan->planX,  fftPlan->planY,  fftPlan->planZ,
+      fftPlan->planTX, fftPlan->planTY, fftPlan->planTZ,
+      fftPlan->planRCcopy, fftPlan->planCopy};
+
+  for (int i = 0; i < 8; i++) {
+    FFTPlan* subPlan = NULL;
+    lockRAII* subLock = NULL;
+
+    if (subPlans[i] &&
+        fftRepo.getPlan(subPlans[i], subPlan, subLock) == HCFFT_SUCCEEDS) {
+      collectLeaves(subPlan, leaves);
+    }
+  }
+}
+
+//  Signature a tuning of the kernel of a leaf is kept under: that of the
+//  kernel of the heuristic sizes, which the leaf had before it was tuned
+static size_t heuristicSignature(FFTPlan* leaf) {
+  size_t workGroupSize = leaf->tuneWorkGroupSize;
+  size_t numTrans = leaf->tuneNumTrans;
+  bool ldsComplex = leaf->bLdsComplex;
+
+  if (workGroupSize != 0) {
+    leaf->tuneWorkGroupSize = 0;
+    leaf->tuneNumTrans = 0;
+    leaf->bLdsComplex = false;
+  }
+
+  size_t signature = getKernelSignature(leaf);
+  leaf->tuneWorkGroupSize = workGroupSize;
+  leaf->tuneNumTrans = numTrans;
+  leaf->bLdsComplex = ldsComplex;
+  return signature;
+}
+
+static bool readFile(const std::string& path, std::string& contents) {
+  FILE* file = fopen(path.c_str(), "rb");
+
+  if (file == NULL) {
+    return false;
+  }
+
+  char chunk[65536];
+  size_t n;
+  contents.clear();
+
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    contents.append(chunk, n);
+  }
+
+  bool read = !ferror(file);
+  fclose(file);
+  return read;
+}
+
+//  The file holds the settings of the plan, the tunings, kernel libraries
+//  and twiddle tables of the leaves of its tree, in that order
+hcfftStatus FFTPlan::hcfftSavePlan(hcfftPlanHandle plHandle,
+                                   const std::string& path) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSavePlan"));
+  hcfftStatus status = hcfftBakePlan(plHandle);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  std::vector<FFTPlan*> leaves;
+  collectLeaves(fftPlan, leaves);
+  std::map<size_t, hcfftKernelTuning> tunings;
+  std::map<std::string, std::string> kernels;
+  std::map<void*, std::vector<size_t> > tables;
+
+  for (size_t i = 0; i < leaves.size(); i++) {
+    hcfftKernelTuning tuning;
+    size_t signature = heuristicSignature(leaves[i]);
+
+    if (fftRepo.getTuning(signature, tuning)) {
+      tunings[signature] = tuning;
+    }
+
+    kernels[getKernelCacheKey(leaves[i]->kernelIndex)] = leaves[i]->kernellib;
+    void* twiddles[2] = {leaves[i]->twiddles, leaves[i]->twiddleslarge};
+
+    for (int t = 0; t < 2; t++) {
+      std::vector<size_t> shape;
+
+      if (twiddles[t] && fftRepo.getTwiddleShape(twiddles[t], shape)) {
+        tables[twiddles[t]] = shape;
+      }
+    }
+  }
+
+  FILE* file = fopen(path.c_str(), "wb");
+
+  if (file == NULL) {
+    return HCFFT_INVALID;
+  }
+
+  planWriter out(file);
+  out(std::string(planFileHeader));
+  out(size_t(HCFFT_KERNEL_GEN_VERSION));
+  planSettingsIO(out, fftPlan);
+  out(tunings.size());
+
+  for (std::map<size_t, hcfftKernelTuning>::iterator iter = tunings.begin();
+       iter != tunings.end(); ++iter) {
+    out(iter->first);
+    out(iter->second.workGroupSize);
+    out(iter->second.numTrans);
+    out(iter->second.ldsComplex);
+    out(iter->second.description);
+  }
+
+  out(kernels.size());
+
+  for (std::map<std::string, std::string>::iterator iter = kernels.begin();
+       iter != kernels.end(); ++iter) {
+    std::string library;
+    out.good = out.good && readFile(iter->second, library);
+    out(iter->first);
+    out(library);
+  }
+
+  out(tables.size());
+
+  for (std::map<void*, std::vector<size_t> >::iterator iter = tables.begin();
+       iter != tables.end(); ++iter) {
+    hc::accelerator acc;
+    hc::AmPointerInfo info(NULL, NULL, 0, acc, false, false);
+    out.good = out.good &&
+               (hc::am_memtracker_getinfo(&info, iter->first) == AM_SUCCESS);
+    std::string table(out.good ? info._sizeBytes : 0, '\0');
+
+    if (!table.empty()) {
+      fftPlan->acc_view.copy(iter->first, &table[0], table.size());
+    }
+
+    out(iter->second);
+    out(table);
+  }
+
+  bool written = (fclose(file) == 0) && out.good;
+
+  if (!written) {
+    remove(path.c_str());
+  }
+
+  return written ? HCFFT_SUCCEEDS : HCFFT_ERROR;
+}
+
+//  The kernel libraries of the file are installed in the JIT cache and its
+//  twiddle tables in the twiddle cache of the repo, where the bake finds
+//  them instead of compiling and computing them. The tables are held until
+//  the bake has taken references of its own.
+hcfftStatus FFTPlan::hcfftLoadPlan(const std::string& path,
+                                   hcfftPlanHandle* plHandle) {
+  FILE* file = fopen(path.c_str(), "rb");
+
+  if (file == NULL) {
+    return HCFFT_INVALID;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  planReader in(file, size > 0 ? size_t(size) : 0);
+  std::string header;
+  size_t version = 0;
+  in(header);
+  in(version);
+  bool parsed = in.good && (header == planFileHeader) &&
+                (version == HCFFT_KERNEL_GEN_VERSION);
+  FFTPlan settings;
+
+  if (parsed) {
+    planSettingsIO(in, &settings);
+  }
+
+  std::map<size_t, hcfftKernelTuning> tunings;
+  size_t count = 0;
+  in(count);
+
+  for (size_t i = 0; in.good && i < count; i++) {
+    size_t signature = 0;
+    in(signature);
+    hcfftKernelTuning& tuning = tunings[signature];
+    in(tuning.workGroupSize);
+    in(tuning.numTrans);
+    in(tuning.ldsComplex);
+    in(tuning.description);
+  }
+
+  std::vector<std::pair<std::string, std::string> > kernels;
+  count = 0;
+  in(count);
+
+  for (size_t i = 0; in.good && i < count; i++) {
+    kernels.push_back(std::pair<std::string, std::string>());
+    in(kernels.back().first);
+    in(kernels.back().second);
+
+    // Keys name files of the cache, and are 16 hex digits
+    in.good = in.good && (kernels.back().first.size() == 16) &&
+              (kernels.back().first.find_first_not_of("0123456789abcdef") ==
+               std::string::npos);
+  }
+
+  std::vector<std::pair<std::vector<size_t>, std::string> > tables;
+  count = 0;
+  in(count);
+
+  for (size_t i = 0; in.good && i < count; i++) {
+    tables.push_back(std::pair<std::vector<size_t>, std::string>());
+    in(tables.back().first);
+    in(tables.back().second);
+  }
+
+  parsed = parsed && in.done() && !settings.originalLength.empty() &&
+           (settings.originalLength.size() == size_t(settings.dimension));
+  fclose(file);
+
+  if (!parsed) {
+    return HCFFT_ERROR;
+  }
+
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+
+  for (std::map<size_t, hcfftKernelTuning>::iterator iter = tunings.begin();
+       iter != tunings.end(); ++iter) {
+    fftRepo.setTuning(iter->first, iter->second);
+  }
+
+  // Libraries are published under a private name, as BuildKernel does
+  std::string cacheDir = getKernelCacheDir();
+
+  for (size_t i = 0; i < kernels.size(); i++) {
+    const std::string& key = kernels[i].first;
+    std::string kernellib = getKernelLibPath(cacheDir, key);
+
+    if (checkIfsoExist(getKernelLibPath(getPrebuiltKernelDir(), key)) ||
+        checkIfsoExist(kernellib)) {
+      continue;
+    }
+
+    makeDirs(cacheDir);
+    std::string tmplib = kernellib + "." + SztToStr(getpid()) + ".tmp";
+    FILE* lib = fopen(tmplib.c_str(), "wb");
+    bool written = (lib != NULL) &&
+                   (fwrite(kernels[i].second.data(), 1,
+                           kernels[i].second.size(),
+                           lib) == kernels[i].second.size());
+    written = (lib != NULL) && (fclose(lib) == 0) && written;
+
+    // A library that is not installed is compiled again by the bake
+    if (!written || rename(tmplib.c_str(), kernellib.c_str()) != 0) {
+      remove(tmplib.c_str());
+    }
+  }
+
+  hcfftStatus status = hcfftCreateDefaultPlan(
+      plHandle, settings.dimension, &settings.originalLength[0],
+      settings.direction, settings.precision, settings.hcfftlibtype);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(*plHandle, fftPlan, planLock);
+  std::vector<void*> seeded;
+  {
+    scopedLock sLock(*planLock, _T(" hcfftLoadPlan"));
+    copyPlanSettings(&settings, fftPlan);
+    fftPlan->location = settings.location;
+    fftPlan->ipLayout = settings.ipLayout;
+    fftPlan->opLayout = settings.opLayout;
+    fftPlan->autoAllocate = settings.autoAllocate;
+    scopedLock sRepoLock(FFTRepo::lockRepo, _T(" hcfftLoadPlan"));
+
+    for (size_t i = 0; i < tables.size(); i++) {
+      const std::string& bytes = tables[i].second;
+      void* table = NULL;
+      fftRepo.acquireTwiddles(fftPlan->acc, tables[i].first, table);
+
+      if (table == NULL && !bytes.empty()) {
+        table = hc::am_alloc(bytes.size(), fftPlan->acc, 0);
+
+        if (table == NULL) {
+          continue;
+        }
+
+        fftPlan->acc_view.copy(bytes.data(), table, bytes.size());
+        fftRepo.addTwiddles(fftPlan->acc, tables[i].first, table);
+      }
+
+      if (table != NULL) {
+        seeded.push_back(table);
+      }
+    }
+  }
+
+  status = hcfftBakePlan(*plHandle);
+
+  for (size_t i = 0; i < seeded.size(); i++) {
+    fftRepo.releaseTwiddles(seeded[i]);
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    hcfftDestroyPlan(plHandle);
+    return HCFFT_ERROR;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftWaitPlanGPUs(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftWaitPlanGPUs"));
+
+  //  Every plan of an accelerator is queued on its default view, and the
+  //  peer-to-peer copies on its copy view
+  for (size_t i = 0; i < fftPlan->gpus.size(); i++) {
+    fftPlan->gpus[i].get_default_view().wait();
+  }
+
+  for (size_t i = 0; i < fftPlan->gpuCopyViews.size(); i++) {
+    fftPlan->gpuCopyViews[i].wait();
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  The chunks are queued one accelerator after the other without waiting,
+//  so they run concurrently. Callbacks and the half and planar storages
+//  address the data through pointers of a single device, and are not split.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueMultiTransform(hcfftPlanHandle plHandle,
+                                                hcfftDirection dir,
+                                                hcfftIpLayout iLayout,
+                                                hcfftOpLayout oLayout,
+                                                T** inputs, T** outputs) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueMultiTransform"));
+
+  if (fftPlan->gpus.empty() || fftPlan->gpus.size() > fftPlan->batchSize ||
+      fftPlan->halfStorage ||
+      fftPlan->planarStorage || !fftPlan->loadCallback.empty() ||
+      !fftPlan->storeCallback.empty()) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftStatus status = hcfftCreateGPUPlans(plHandle);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  for (size_t i = 0; i < fftPlan->gpuPlans.size(); i++) {
+    if (inputs[i] == NULL || outputs[i] == NULL) {
+      return HCFFT_INVALID;
+    }
+
+    hcfftResLocation location =
+        (inputs[i] == outputs[i]) ? HCFFT_INPLACE : HCFFT_OUTOFPLACE;
+    status = hcfftPrepareExec(fftPlan->gpuPlans[i], location, iLayout,
+                              oLayout);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    status = hcfftEnqueueTransform<T>(fftPlan->gpuPlans[i], dir, inputs[i],
+                                      outputs[i], NULL);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  fftPlan->transformed = true;
+  return HCFFT_SUCCEEDS;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueMultiTransform(
+    hcfftPlanHandle plHandle, hcfftDirection dir, hcfftIpLayout iLayout,
+    hcfftOpLayout oLayout, float** inputs, float** outputs);
+template hcfftStatus FFTPlan::hcfftEnqueueMultiTransform(
+    hcfftPlanHandle plHandle, hcfftDirection dir, hcfftIpLayout iLayout,
+    hcfftOpLayout oLayout, double** inputs, double** outputs);
+
+//  Queues the copy of count segments of segBytes from src to dst, srcStride
+//  and dstStride bytes apart
+static void streamCopy(hc::accelerator_view& view, const char* src,
+                       char* dst, size_t count, size_t segBytes,
+                       size_t srcStride, size_t dstStride) {
+  for (size_t i = 0; i < count; i++) {
+    view.copy_async(src + i * srcStride, dst + i * dstStride, segBytes);
+  }
+}
+
+hcfftStatus FFTPlan::hcfftGetPlanGPUVolumeSplit(hcfftPlanHandle plHandle,
+                                                std::vector<size_t>& depths,
+                                                std::vector<size_t>& rows) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftGetPlanGPUVolumeSplit"));
+
+  if (fftPlan->dimension != HCFFT_3D || fftPlan->length.size() != 3) {
+    return HCFFT_INVALID;
+  }
+
+  size_t count = fftPlan->gpus.size();
+  depths.clear();
+  rows.clear();
+
+  for (size_t i = 0; i < count; i++) {
+    depths.push_back(gpuBatch(fftPlan->length[2], count, i));
+    rows.push_back(gpuBatch(fftPlan->length[1], count, i));
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Chunks of the slabs and pencils of hcfftEnqueueMultiVolume, for the copies
+//  of a chunk to overlap the transform of the next
+static const size_t volumeChunks = 4;
+
+//  Length of the chunks of n planes or rows, the largest dividing n into at
+//  most volumeChunks
+static size_t volumeChunk(size_t n) {
+  size_t k = std::min(volumeChunks, n);
+
+  while (n % k) {
+    k--;
+  }
+
+  return n / k;
+}
+
+//  The slab plan of an accelerator transforms a chunk of its planes along x
+//  and y, and its pencil plan the z axis of a chunk of its rows of every
+//  plane, packed one plane after the other, with the scales of the 3D plan.
+//  Each accelerator copies on a view of its own, so that the exchange of a
+//  chunk runs beside the transform of the next.
+hcfftStatus FFTPlan::hcfftCreateGPUVolumePlans(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftCreateGPUVolumePlans"));
+  size_t count = fftPlan->gpus.size();
+
+  for (size_t i = fftPlan->gpuSlabPlans.size(); i < count; i++) {
+    size_t lengths[2] = {fftPlan->length[0], fftPlan->length[1]};
+    hcfftPlanHandle slabHandle = 0;
+    hcfftStatus status = hcfftCreateDefaultPlan(
+        &slabHandle, HCFFT_2D, lengths, fftPlan->direction,
+        fftPlan->precision, HCFFT_C2CZ2Z);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    fftPlan->gpuSlabPlans.push_back(slabHandle);
+    hcfftPlanHandle pencilHandle = 0;
+    status = hcfftCreateDefaultPlan(&pencilHandle, HCFFT_1D,
+                                    &fftPlan->length[2], fftPlan->direction,
+                                    fftPlan->precision, HCFFT_C2CZ2Z);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    fftPlan->gpuPencilPlans.push_back(pencilHandle);
+    size_t rows = gpuBatch(fftPlan->length[1], count, i);
+    FFTPlan* slabPlan = NULL;
+    lockRAII* slabLock = NULL;
+    fftRepo.getPlan(slabHandle, slabPlan, slabLock);
+    {
+      scopedLock sSlabLock(*slabLock, _T(" hcfftCreateGPUVolumePlans"));
+      slabPlan->precision = fftPlan->precision;
+      slabPlan->batchSize =
+          volumeChunk(gpuBatch(fftPlan->length[2], count, i));
+      slabPlan->forwardScale = 1.0;
+      slabPlan->backwardScale = 1.0;
+      slabPlan->lowMemory = fftPlan->lowMemory;
+      slabPlan->singleTwiddles = fftPlan->singleTwiddles;
+      slabPlan->autotune = fftPlan->autotune;
+    }
+
+    FFTPlan* pencilPlan = NULL;
+    lockRAII* pencilLock = NULL;
+    fftRepo.getPlan(pencilHandle, pencilPlan, pencilLock);
+    {
+      scopedLock sPencilLock(*pencilLock, _T(" hcfftCreateGPUVolumePlans"));
+      pencilPlan->precision = fftPlan->precision;
+      pencilPlan->batchSize = volumeChunk(rows) * fftPlan->length[0];
+      pencilPlan->inStride[0] = rows * fftPlan->length[0];
+      pencilPlan->outStride[0] = rows * fftPlan->length[0];
+      pencilPlan->iDist = 1;
+      pencilPlan->oDist = 1;
+      pencilPlan->forwardScale = fftPlan->forwardScale;
+      pencilPlan->backwardScale = fftPlan->backwardScale;
+      pencilPlan->singleTwiddles = fftPlan->singleTwiddles;
+      pencilPlan->autotune = fftPlan->autotune;
+    }
+
+    hc::accelerator_view acc_view = fftPlan->gpus[i].get_default_view();
+    hcfftSetAcclView(slabHandle, acc_view);
+    hcfftSetAcclView(pencilHandle, acc_view);
+  }
+
+  while (fftPlan->gpuCopyViews.size() < count) {
+    size_t i = fftPlan->gpuCopyViews.size();
+    fftPlan->gpuCopyViews.push_back(fftPlan->gpus[i].create_view());
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+//  Queues the transforms of the chunks of the slab (the pencil) of
+//  accelerator i, each followed on its copy view by the peer-to-peer copies
+//  of its planes (rows) to the pencils (slabs) of all accelerators when
+//  exchange is set. Slab i holds block i of the planes of the volume, and
+//  pencil j block j of the rows of every plane.
+template <typename T>
+static hcfftStatus volumePass(FFTPlan* fftPlan, size_t i, bool slab,
+                              hcfftDirection dir, T** slabs, T** pencils,
+                              bool exchange) {
+  size_t count = fftPlan->gpus.size();
+  size_t row = fftPlan->length[0] * fftPlan->ElementSize();
+  size_t plane = fftPlan->length[1] * row;
+  size_t depth = gpuBatch(fftPlan->length[2], count, i);
+  size_t rows = gpuBatch(fftPlan->length[1], count, i);
+  size_t total = slab ? depth : rows;
+  size_t chunk = volumeChunk(total);
+  hcfftPlanHandle plan =
+      slab ? fftPlan->gpuSlabPlans[i] : fftPlan->gpuPencilPlans[i];
+  char* base = reinterpret_cast<char*>(slab ? slabs[i] : pencils[i]);
+  hc::accelerator_view view = fftPlan->gpus[i].get_default_view();
+  hcfftStatus status = fftPlan->hcfftPrepareExec(
+      plan, HCFFT_INPLACE, HCFFT_COMPLEX_INTERLEAVED,
+      HCFFT_COMPLEX_INTERLEAVED);
+
+  for (size_t c = 0; c < total && status == HCFFT_SUCCEEDS; c += chunk) {
+    T* data = reinterpret_cast<T*>(base + c * (slab ? plane : row));
+    status = fftPlan->hcfftEnqueueTransform<T>(plan, dir, data, data, NULL);
+
+    if (status != HCFFT_SUCCEEDS || !exchange) {
+      continue;
+    }
+
+    hc::accelerator_view& copyView = fftPlan->gpuCopyViews[i];
+    hc::completion_future done = view.create_marker();
+    copyView.create_blocking_marker(done);
+
+    for (size_t j = 0; j < count; j++) {
+      if (slab) {
+        // Rows of pencil j in planes c to c + chunk of slab i
+        size_t y = gpuBatchStart(fftPlan->length[1], count, j);
+        size_t yj = gpuBatch(fftPlan->length[1], count, j);
+        size_t z = gpuBatchStart(fftPlan->length[2], count, i) + c;
+        char* pencil = reinterpret_cast<char*>(pencils[j]) + z * yj * row;
+        streamCopy(copyView, base + c * plane + y * row, pencil, chunk,
+                   yj * row, plane, yj * row);
+      } else {
+        // Rows c to c + chunk of pencil i in the planes of slab j
+        size_t y = gpuBatchStart(fftPlan->length[1], count, i) + c;
+        size_t z = gpuBatchStart(fftPlan->length[2], count, j);
+        size_t zj = gpuBatch(fftPlan->length[2], count, j);
+        char* dst = reinterpret_cast<char*>(slabs[j]) + y * row;
+        streamCopy(copyView, base + (z * rows + c) * row, dst, zj,
+                   chunk * row, rows * row, plane);
+      }
+    }
+  }
+
+  return status;
+}
+
+//  The forward transform runs the slab plans on the slabs, moves the rows of
+//  every plane to the accelerators of their pencils and runs the pencil
+//  plans there, so that the output is in pencils and no second exchange
+//  runs. The backward transform takes pencils to slabs. Each chunk is copied
+//  peer to peer as soon as it is transformed, and the second pass starts
+//  when all copies are done. The buffers of each accelerator are mapped to
+//  the others for the exchange, and the input is overwritten.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueMultiVolume(hcfftPlanHandle plHandle,
+                                             hcfftDirection dir, T** slabs,
+                                             T** pencils) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueMultiVolume"));
+  size_t count = fftPlan->gpus.size();
+
+  if (count == 0 || fftPlan->hcfftlibtype != HCFFT_C2CZ2Z ||
+      fftPlan->dimension != HCFFT_3D || fftPlan->length.size() != 3 ||
+      fftPlan->batchSize != 1 || fftPlan->halfStorage ||
+      fftPlan->planarStorage || !fftPlan->loadCallback.empty() ||
+      !fftPlan->storeCallback.empty()) {
+    return HCFFT_INVALID;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    if (slabs[i] == NULL || pencils[i] == NULL || slabs[i] == pencils[i]) {
+      return HCFFT_INVALID;
+    }
+  }
+
+  hcfftStatus status = hcfftCreateGPUVolumePlans(plHandle);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    std::vector<hc::accelerator> peers;
+
+    for (size_t j = 0; j < count; j++) {
+      if (j != i) {
+        peers.push_back(fftPlan->gpus[j]);
+      }
+    }
+
+    if (!peers.empty() &&
+        (hc::am_map_to_peers(slabs[i], peers.size(), &peers[0]) !=
+             AM_SUCCESS ||
+         hc::am_map_to_peers(pencils[i], peers.size(), &peers[0]) !=
+             AM_SUCCESS)) {
+      return HCFFT_ERROR;
+    }
+  }
+
+  bool forward = dir == HCFFT_FORWARD;
+
+  for (size_t i = 0; i < count && status == HCFFT_SUCCEEDS; i++) {
+    status = volumePass<T>(fftPlan, i, forward, dir, slabs, pencils, true);
+  }
+
+  //  Every pencil (slab) of the second pass takes rows from all accelerators
+  hcfftWaitPlanGPUs(plHandle);
+
+  for (size_t i = 0; i < count && status == HCFFT_SUCCEEDS; i++) {
+    status = volumePass<T>(fftPlan, i, !forward, dir, slabs, pencils, false);
+  }
+
+  fftPlan->transformed = true;
+  return status;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueMultiVolume(hcfftPlanHandle plHandle,
+                                                      hcfftDirection dir,
+                                                      float** slabs,
+                                                      float** pencils);
+template hcfftStatus FFTPlan::hcfftEnqueueMultiVolume(hcfftPlanHandle plHandle,
+                                                      hcfftDirection dir,
+                                                      double** slabs,
+                                                      double** pencils);
+
+//  Runs subPlan in place on chunks of a volume in host memory, chunkStride
+//  bytes apart, each made of count segments of segBytes that are segStride
+//  bytes apart on the host and packed on the device. The copy view is in
+//  order, so the upload of chunk k + 1 waits for the download of chunk k - 1
+//  from the same buffer, then runs while chunk k is transformed.
+template <typename T>
+static hcfftStatus hcfftStreamPass(FFTPlan* fftPlan, hcfftPlanHandle subPlan,
+                                   hcfftDirection dir, const char* input,
+                                   char* output, size_t chunks,
+                                   size_t chunkStride, size_t count,
+                                   size_t segBytes, size_t segStride) {
+  hc::accelerator_view& copyView = fftPlan->streamCopyView[0];
+  char* buffers[2] = {static_cast<char*>(fftPlan->streamBuffers[0]),
+                      static_cast<char*>(fftPlan->streamBuffers[1])};
+  hc::completion_future uploaded[2];
+  streamCopy(copyView, input, buffers[0], count, segBytes, segStride,
+             segBytes);
+  uploaded[0] = copyView.create_marker();
+
+  for (size_t k = 0; k < chunks; k++) {
+    if (k + 1 < chunks) {
+      streamCopy(copyView, input + (k + 1) * chunkStride, buffers[(k + 1) % 2],
+                 count, segBytes, segStride, segBytes);
+      uploaded[(k + 1) % 2] = copyView.create_marker();
+    }
+
+    uploaded[k % 2].wait();
+    T* data = reinterpret_cast<T*>(buffers[k % 2]);
+    hcfftStatus status =
+        fftPlan->hcfftEnqueueTransform<T>(subPlan, dir, data, data, NULL);
+
+    if (status != HCFFT_SUCCEEDS) {
+      copyView.wait();
+      return status;
+    }
+
+    fftPlan->acc_view.wait();
+    streamCopy(copyView, buffers[k % 2], output + k * chunkStride, count,
+               segBytes, segBytes, segStride);
+  }
+
+  copyView.wait();
+  return HCFFT_SUCCEEDS;
+}
+
+//  Transforms packed 3D volumes in host memory through at most deviceBytes of
+//  device memory for their data. The first pass transforms slabs of whole
+//  planes along x and y, the second pass blocks of rows of every plane along
+//  z. Chunks are the largest dividing the volume that fit twice in
+//  deviceBytes, and the host memory should be pinned for the copies to
+//  overlap with the transforms.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueHostTransform(hcfftPlanHandle plHandle,
+                                               hcfftDirection dir, T* input,
+                                               T* output, size_t deviceBytes) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueHostTransform"));
+
+  if ((fftPlan->hcfftlibtype != HCFFT_C2CZ2Z) ||
+      (fftPlan->dimension != HCFFT_3D) || (fftPlan->length.size() != 3)) {
+    return HCFFT_INVALID;
+  }
+
+  size_t* length = &fftPlan->length[0];
+  size_t plane = length[0] * length[1];
+  size_t volume = plane * length[2];
+
+  if ((fftPlan->inStride[0] != 1) || (fftPlan->inStride[1] != length[0]) ||
+      (fftPlan->inStride[2] != plane) ||
+      (fftPlan->outStride != fftPlan->inStride) ||
+      (fftPlan->batchSize > 1 &&
+       (fftPlan->iDist != volume || fftPlan->oDist != volume))) {
+    return HCFFT_INVALID;
+  }
+
+  size_t elem = fftPlan->ElementSize();
+  size_t depth = length[2];
+  size_t rows = length[1];
+
+  while (depth > 0 && (length[2] % depth || 2 * depth * plane * elem >
+                                                deviceBytes)) {
+    depth--;
+  }
+
+  while (rows > 0 && (length[1] % rows || 2 * rows * length[0] * length[2] *
+                                               elem > deviceBytes)) {
+    rows--;
+  }
+
+  if (depth == 0 || rows == 0) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftStatus status = hcfftCreateStreamPlans(plHandle, depth, rows);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  size_t slabBytes = depth * plane * elem;
+  size_t rowBytes = rows * length[0] * elem;
+
+  for (size_t b = 0; b < fftPlan->batchSize; b++) {
+    const char* in = reinterpret_cast<const char*>(input) + b * volume * elem;
+    char* out = reinterpret_cast<char*>(output) + b * volume * elem;
+    status = hcfftStreamPass<T>(fftPlan, fftPlan->planStreamXY, dir, in, out,
+                                length[2] / depth, slabBytes, 1, slabBytes,
+                                0);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    status = hcfftStreamPass<T>(fftPlan, fftPlan->planStreamZ, dir, out, out,
+                                length[1] / rows, rowBytes, length[2],
+                                rowBytes, plane * elem);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  fftPlan->transformed = true;
+  return HCFFT_SUCCEEDS;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueHostTransform(
+    hcfftPlanHandle plHandle, hcfftDirection dir, float* input, float* output,
+    size_t deviceBytes);
+template hcfftStatus FFTPlan::hcfftEnqueueHostTransform(
+    hcfftPlanHandle plHandle, hcfftDirection dir, double* input,
+    double* output, size_t deviceBytes);
+
+//  The chunk plan is a clone of the plan for chunk transforms, baked for the
+//  buffers of each call. Each slot holds the input and then the output of a
+//  chunk, one over the other in place. Staged calls also take a pinned host
+//  buffer per slot.
+hcfftStatus FFTPlan::hcfftCreateHostBatch(hcfftPlanHandle plHandle,
+                                          size_t chunk, size_t slotBytes,
+                                          bool staged) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftCreateHostBatch"));
+
+  if (!fftPlan->hostCopyViews.empty() &&
+      !(fftPlan->hostCopyViews[0].get_accelerator() == fftPlan->acc)) {
+    hcfftReleaseHostBatch(plHandle);
+  }
+
+  if (fftPlan->planHostBatch == 0 || fftPlan->hostChunk != chunk ||
+      fftPlan->hostSlotBytes != slotBytes) {
+    hcfftReleaseHostBatch(plHandle);
+    hcfftStatus status =
+        hcfftClonePlan(plHandle, chunk, &fftPlan->planHostBatch);
+
+    if (status != HCFFT_SUCCEEDS) {
+      fftPlan->planHostBatch = 0;
+      return status;
+    }
+
+    for (size_t i = 0; i < hostSlots; i++) {
+      scopedTimer timer(fftPlan->timings.alloc);
+      fftPlan->hostBuffers[i] =
+          gaugedAlloc(slotBytes, fftPlan->acc, hcfftCounters.scratchBytes);
+
+      if (fftPlan->hostBuffers[i] == NULL) {
+        return HCFFT_ERROR;
+      }
+    }
+
+    fftPlan->hostChunk = chunk;
+    fftPlan->hostSlotBytes = slotBytes;
+  }
+
+  for (size_t i = 0; staged && i < hostSlots; i++) {
+    if (fftPlan->hostStaging[i] == NULL) {
+      fftPlan->hostStaging[i] =
+          hc::am_alloc(slotBytes, fftPlan->acc, amHostPinned);
+
+      if (fftPlan->hostStaging[i] == NULL) {
+        return HCFFT_ERROR;
+      }
+    }
+  }
+
+  while (fftPlan->hostCopyViews.size() < 2) {
+    fftPlan->hostCopyViews.push_back(fftPlan->acc.create_view());
+  }
+
+  hcfftSetAcclView(fftPlan->planHostBatch, fftPlan->acc_view);
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftReleaseHostBatch(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftReleaseHostBatch"));
+
+  if (fftPlan->planHostBatch) {
+    hcfftDestroyPlan(&fftPlan->planHostBatch);
+    fftPlan->planHostBatch = 0;
+  }
+
+  for (size_t i = 0; i < hostSlots; i++) {
+    if (fftPlan->hostBuffers[i]) {
+      gaugedFree(fftPlan->hostBuffers[i], hcfftCounters.scratchBytes);
+      fftPlan->hostBuffers[i] = NULL;
+    }
+
+    if (fftPlan->hostStaging[i]) {
+      hc::am_free(fftPlan->hostStaging[i]);
+      fftPlan->hostStaging[i] = NULL;
+    }
+  }
+
+  fftPlan->hostCopyViews.clear();
+  fftPlan->hostChunk = 0;
+  fftPlan->hostSlotBytes = 0;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Chunk k of the batch is uploaded on the first copy view into slot
+//  k % hostSlots, transformed on acc_view once uploaded, and downloaded on
+//  the second copy view once transformed, so that the upload of a chunk, the
+//  transform of the one before and the download of the one before that run
+//  together. The upload of a chunk waits for the download of the chunk that
+//  held its slot. Pageable data pass through the pinned buffers of the
+//  slots, copied on the host while the views work on the other slots.
+//  Chunks are the largest dividing the batch of which hostSlots fit in
+//  deviceBytes, and the buffers hold batchSize times the distance of their
+//  side.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueHostBatch(hcfftPlanHandle plHandle,
+                                           hcfftDirection dir, T* input,
+                                           T* output, size_t deviceBytes) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueHostBatch"));
+
+  if (!fftPlan->gpus.empty() || fftPlan->planarStorage ||
+      fftPlan->halfStorage || !hostResident(input) || !hostResident(output)) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftIpLayout iLayout = HCFFT_COMPLEX_INTERLEAVED;
+  hcfftOpLayout oLayout = HCFFT_COMPLEX_INTERLEAVED;
+
+  if (fftPlan->hcfftlibtype == HCFFT_R2CD2Z) {
+    iLayout = HCFFT_REAL;
+    oLayout = HCFFT_HERMITIAN_INTERLEAVED;
+  } else if (fftPlan->hcfftlibtype == HCFFT_C2RZ2D) {
+    iLayout = HCFFT_HERMITIAN_INTERLEAVED;
+    oLayout = HCFFT_REAL;
+  }
+
+  bool inPlace = input == output;
+  size_t elem = fftPlan->ElementSize();
+  size_t inBytes = fftPlan->iDist * elem / ((iLayout == HCFFT_REAL) ? 2 : 1);
+  size_t outBytes = fftPlan->oDist * elem / ((oLayout == HCFFT_REAL) ? 2 : 1);
+  const size_t align = 256;
+  size_t chunk = fftPlan->batchSize;
+  size_t outOffset = 0;
+  size_t slotBytes = 0;
+
+  for (; chunk > 0; chunk--) {
+    if (fftPlan->batchSize % chunk) {
+      continue;
+    }
+
+    outOffset = inPlace ? 0 : (chunk * inBytes + align - 1) / align * align;
+    slotBytes = inPlace ? chunk * std::max(inBytes, outBytes)
+                        : outOffset + chunk * outBytes;
+
+    if (hostSlots * slotBytes <= deviceBytes) {
+      break;
+    }
+  }
+
+  if (chunk == 0) {
+    return HCFFT_INVALID;
+  }
+
+  bool staged = !hostPinned(input) || !hostPinned(output);
+  hcfftStatus status =
+      hcfftCreateHostBatch(plHandle, chunk, slotBytes, staged);
+
+  if (status == HCFFT_SUCCEEDS) {
+    status = hcfftPrepareExec(fftPlan->planHostBatch,
+                              inPlace ? HCFFT_INPLACE : HCFFT_OUTOFPLACE,
+                              iLayout, oLayout);
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  hc::accelerator_view& upView = fftPlan->hostCopyViews[0];
+  hc::accelerator_view& downView = fftPlan->hostCopyViews[1];
+  const char* in = reinterpret_cast<const char*>(input);
+  char* out = reinterpret_cast<char*>(output);
+  size_t chunks = fftPlan->batchSize / chunk;
+  size_t inChunk = chunk * inBytes;
+  size_t outChunk = chunk * outBytes;
+  hc::completion_future downloaded[hostSlots];
+
+  for (size_t k = 0; k < chunks; k++) {
+    size_t slot = k % hostSlots;
+    char* device = static_cast<char*>(fftPlan->hostBuffers[slot]);
+    char* staging = static_cast<char*>(fftPlan->hostStaging[slot]);
+
+    //  The chunk before in the slot leaves it
+    if (k >= hostSlots && staged) {
+      downloaded[slot].wait();
+      memcpy(out + (k - hostSlots) * outChunk, staging + outOffset,
+             outChunk);
+    } else if (k >= hostSlots) {
+      upView.create_blocking_marker(downloaded[slot]);
+    }
+
+    const char* src = in + k * inChunk;
+
+    if (staged) {
+      memcpy(staging, src, inChunk);
+      src = staging;
+    }
+
+    upView.copy_async(src, device, inChunk);
+    hc::completion_future uploaded = upView.create_marker();
+    fftPlan->acc_view.create_blocking_marker(uploaded);
+    status = hcfftEnqueueTransform<T>(
+        fftPlan->planHostBatch, dir, reinterpret_cast<T*>(device),
+        reinterpret_cast<T*>(device + outOffset), NULL);
+
+    if (status != HCFFT_SUCCEEDS) {
+      upView.wait();
+      fftPlan->acc_view.wait();
+      downView.wait();
+      return status;
+    }
+
+    hc::completion_future transformed = fftPlan->acc_view.create_marker();
+    downView.create_blocking_marker(transformed);
+    char* dst = staged ? staging + outOffset : out + k * outChunk;
+    downView.copy_async(device + outOffset, dst, outChunk);
+    downloaded[slot] = downView.create_marker();
+  }
+
+  for (size_t k = (chunks > hostSlots) ? chunks - hostSlots : 0; k < chunks;
+       k++) {
+    size_t slot = k % hostSlots;
+    downloaded[slot].wait();
+
+    if (staged) {
+      memcpy(out + k * outChunk,
+             static_cast<char*>(fftPlan->hostStaging[slot]) + outOffset,
+             outChunk);
+    }
+  }
+
+  fftPlan->transformed = true;
+  return HCFFT_SUCCEEDS;
+}
+
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueHostBatch(hcfftPlanHandle plHandle,
+                                                    hcfftDirection dir,
+                                                    float* input,
+                                                    float* output,
+                                                    size_t deviceBytes);
+template hcfftStatus FFTPlan::hcfftEnqueueHostBatch(hcfftPlanHandle plHandle,
+                                                    hcfftDirection dir,
+                                                    double* input,
+                                                    double* output,
+                                                    size_t deviceBytes);
+
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueTransformInternal(hcfftPlanHandle plHandle,
+                                                   hcfftDirection dir,
+                                                   T* hcInputBuffers,
+                                                   T* hcOutputBuffers,
+                                                   T* hcTmpBuffers) {
+  hcfftStatus status = HCFFT_SUCCEEDS;
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  //  At this point, the user wants to enqueue a plan to execute.  We lock the
+  //  plan down now, such that
+  //  after we finish baking the plan (if the user did not do that explicitely
+  //  before), the plan cannot
+  //  change again through the action of other thread before we enqueue this
+  //  plan for execution.
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T("hcfftEnqueueTransformInternal"));
+
+  if (fftPlan->baked == false) {
+    hcfftBakePlan(plHandle);
+  }
+
+  if (fftPlan->ipLayout == HCFFT_REAL) {
+    dir = HCFFT_FORWARD;
+  } else if (fftPlan->opLayout == HCFFT_REAL) {
+    dir = HCFFT_BACKWARD;
+  }
+
+  if (hcTmpBuffers == NULL && fftPlan->tmpBufSize > 0 &&
+      fftPlan->intBuffer == NULL) {
+    // create the intermediate buffers
+    // The intermediate buffer is always interleave and packed
+    // For outofplace operation, we have the choice not to create intermediate
+    // buffer
+    // input ->(col+Transpose) output ->(col) output
+    scopedTimer timer(fftPlan->timings.alloc);
+    fftPlan->intBuffer = gaugedAlloc(fftPlan->tmpBufSize, fftPlan->acc,
+                                     hcfftCounters.scratchBytes);
+
+    if (fftPlan->intBuffer == NULL) {
+      return HCFFT_INVALID;
+    }
+  }
+
+  if (hcTmpBuffers == NULL && fftPlan->intBuffer != NULL) {
+    hcTmpBuffers = (T*)fftPlan->intBuffer;
+  }
+
+  if (fftPlan->intBufferRC == NULL && fftPlan->tmpBufSizeRC > 0) {
+    scopedTimer timer(fftPlan->timings.alloc);
+    fftPlan->intBufferRC = gaugedAlloc(fftPlan->tmpBufSizeRC, fftPlan->acc,
+                                       hcfftCounters.scratchBytes);
+
+    if (fftPlan->intBufferRC == NULL) {
+      return HCFFT_INVALID;
+    }
+  }
+
+  if (fftPlan->intBufferC2R == NULL && fftPlan->tmpBufSizeC2R > 0) {
+    scopedTimer timer(fftPlan->timings.alloc);
+    fftPlan->intBufferC2R = gaugedAlloc(fftPlan->tmpBufSizeC2R, fftPlan->acc,
+                                        hcfftCounters.scratchBytes);
+
+    if (fftPlan->intBufferC2R == NULL) {
+      return HCFFT_INVALID;
+    }
+  }
+
+  //  The largest vector we can transform in a single pass
+  //  depends on the GPU caps -- especially the amount of LDS
+  //  available
+  //
+  //  The padded forward transform of the chirped input writes tmp, and the
+  //  inverse transform of its product with the filter writes the output
+  if (fftPlan->bluestein) {
+    bool back = (dir == HCFFT_BACKWARD);
+    T* output = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                      : hcOutputBuffers;
+    hcfftEnqueueTransformInternal<T>(back ? fftPlan->planTX : fftPlan->planX,
+                                     HCFFT_FORWARD, hcInputBuffers,
+                                     hcTmpBuffers, NULL);
+    hcfftEnqueueTransformInternal<T>(back ? fftPlan->planTY : fftPlan->planY,
+                                     HCFFT_BACKWARD, hcTmpBuffers, output,
+                                     NULL);
+    return HCFFT_SUCCEEDS;
+  }
+
+  //  The windowed frames are transformed straight from the input
+  if (fftPlan->stft) {
+    hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_FORWARD,
+                                     hcInputBuffers, hcOutputBuffers, NULL);
+    return HCFFT_SUCCEEDS;
+  }
+
+  //  The rows of a pruned plan within the extent of its input are
+  //  transformed to the output, and then the columns within the extent of
+  //  its output in place
+  if (fftPlan->pruned) {
+    T* output = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                      : hcOutputBuffers;
+    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcInputBuffers,
+                                     output, NULL);
+
+    if (fftPlan->length.size() == HCFFT_2D) {
+      hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir, output, output,
+                                       NULL);
+    }
+
+    return HCFFT_SUCCEEDS;
+  }
+
+  //  The transform of the permuted input writes its coefficients and x[0] to
+  //  the output, which the inverse transform of their product with the
+  //  filter permutes in place
+  if (fftPlan->rader) {
+    bool back = (dir == HCFFT_BACKWARD);
+    T* output = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                      : hcOutputBuffers;
+    hcfftPlanHandle sum = back ? fftPlan->planTX : fftPlan->planX;
+    hcfftStatus status =
+        hcfftSetPlanCallbackData(sum, HCFFT_CALLBACK_STORE, hcInputBuffers);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+
+    hcfftEnqueueTransformInternal<T>(sum, HCFFT_FORWARD, hcInputBuffers,
+                                     output, NULL);
+    hcfftEnqueueTransformInternal<T>(back ? fftPlan->planTY : fftPlan->planY,
+                                     HCFFT_BACKWARD, output, output, NULL);
+    return HCFFT_SUCCEEDS;
+  }
+
+  //  The 1D transforms along the dimensions after the 3rd run in place on
+  //  the output of the 3D transform, or before it on the input of a
+  //  hermitian to real plan
+  if (fftPlan->dimension > HCFFT_3D) {
+    bool c2r = (fftPlan->opLayout == HCFFT_REAL);
+    T* output = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                      : hcOutputBuffers;
+    T* data = c2r ? hcInputBuffers : output;
+    hcfftPlanHandle axes[3] = {fftPlan->planY, fftPlan->planZ,
+                               fftPlan->planTX};
+
+    if (!c2r) {
+      hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcInputBuffers,
+                                       output, NULL);
+    }
+
+    for (size_t d = HCFFT_3D; d < fftPlan->dimension; d++) {
+      hcfftEnqueueTransformInternal<T>(axes[d - HCFFT_3D], dir, data, data,
+                                       NULL);
+    }
+
+    if (c2r) {
+      hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcInputBuffers,
+                                       output, NULL);
+    }
+
+    return HCFFT_SUCCEEDS;
+  }
+
+  size_t Large1DThreshold = 0;
+  fftPlan->GetMax1DLength(&Large1DThreshold);
+  BUG_CHECK(Large1DThreshold > 1);
+
+  if (fftPlan->gen != Copy) switch (fftPlan->dimension) {
+      case HCFFT_1D: {
+        if (Is1DPossible(fftPlan->length[0], Large1DThreshold)) {
+          break;
+        }
+
+        //  Complex transform of half the length over the real values, with
+        //  the split into the hermitian output after it in forward and the
+        //  packing of the hermitian input before it in backward
+        if (fftPlan->RCsplit) {
+          T* output = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                            : hcOutputBuffers;
+
+          if (fftPlan->ipLayout == HCFFT_REAL) {
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planX, HCFFT_FORWARD, hcInputBuffers,
+                (T*)fftPlan->intBufferRC, hcTmpBuffers);
+            hcfftEnqueueTransformInternal<T>(fftPlan->planRCcopy, HCFFT_FORWARD,
+                                             (T*)fftPlan->intBufferRC, output,
+                                             hcTmpBuffers);
+          } else {
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planRCcopy, HCFFT_BACKWARD, hcInputBuffers,
+                (T*)fftPlan->intBufferRC, hcTmpBuffers);
+            hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_BACKWARD,
+                                             (T*)fftPlan->intBufferRC, output,
+                                             hcTmpBuffers);
+          }
+
+          return HCFFT_SUCCEEDS;
+        }
+
+        if ((fftPlan->ipLayout == HCFFT_REAL) && (fftPlan->planTZ != 0)) {
+          // First transpose
+          // Input->tmp
+          hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir, hcInputBuffers,
+                                           hcTmpBuffers, NULL);
+
+          if (fftPlan->location == HCFFT_INPLACE) {
+            // First Row
+            // tmp->output
+            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcTmpBuffers,
+                                             (T*)fftPlan->intBufferRC, NULL);
+            // Second Transpose
+            // output->tmp
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcTmpBuffers, NULL);
+            // Second Row
+            // tmp->tmp, inplace
+            hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir, hcTmpBuffers,
+                                             (T*)fftPlan->intBufferRC, NULL);
+            // Third Transpose
+            // tmp->output
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcInputBuffers, NULL);
+          } else {
+            // First Row
+            // tmp->output
+            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcTmpBuffers,
+                                             (T*)fftPlan->intBufferRC, NULL);
+            // Second Transpose
+            // output->tmp
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcTmpBuffers, NULL);
+            // Second Row
+            // tmp->tmp, inplace
+            hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir, hcTmpBuffers,
+                                             (T*)fftPlan->intBufferRC, NULL);
+            // Third Transpose
+            // tmp->output
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcOutputBuffers, NULL);
+          }
+        } else if (fftPlan->ipLayout == HCFFT_REAL) {
+          // First pass
+          // column with twiddle first, OUTOFPLACE, + transpose
+          hcfftEnqueueTransformInternal<T>(
+              fftPlan->planX, HCFFT_FORWARD, hcInputBuffers,
+              (T*)fftPlan->intBufferRC, hcTmpBuffers);
+          // another column FFT output, INPLACE
+          hcfftEnqueueTransformInternal<T>(
+              fftPlan->planY, HCFFT_FORWARD, (T*)fftPlan->intBufferRC,
+              (T*)fftPlan->intBufferRC, hcTmpBuffers);
+
+          if (fftPlan->location == HCFFT_INPLACE) {
+            // copy from full complex to hermitian
+            hcfftEnqueueTransformInternal<T>(fftPlan->planRCcopy, HCFFT_FORWARD,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcInputBuffers, hcTmpBuffers);
+          } else {
+            hcfftEnqueueTransformInternal<T>(fftPlan->planRCcopy, HCFFT_FORWARD,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcOutputBuffers, hcTmpBuffers);
+          }
+        } else if (fftPlan->opLayout == HCFFT_REAL) {
+          if (fftPlan->planRCcopy) {
+            // copy from hermitian to full complex
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planRCcopy, HCFFT_BACKWARD, hcInputBuffers,
+                (T*)fftPlan->intBufferRC, hcTmpBuffers);
+            // First pass
+            // column with twiddle first, INPLACE,
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planX, HCFFT_BACKWARD, (T*)fftPlan->intBufferRC,
+                (T*)fftPlan->intBufferRC, hcTmpBuffers);
+          } else {
+            // First pass
+            // column with twiddle first, INPLACE,
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planX, HCFFT_BACKWARD, hcInputBuffers,
+                (T*)fftPlan->intBufferRC, hcTmpBuffers);
+          }
+
+          if (fftPlan->location == HCFFT_INPLACE) {
+            // another column FFT output, OUTOFPLACE + transpose
+            hcfftEnqueueTransformInternal<T>(fftPlan->planY, HCFFT_BACKWARD,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcInputBuffers, hcTmpBuffers);
+          } else {
+            hcfftEnqueueTransformInternal<T>(fftPlan->planY, HCFFT_BACKWARD,
+                                             (T*)fftPlan->intBufferRC,
+                                             hcOutputBuffers, hcTmpBuffers);
+          }
+        } else {
+          if (fftPlan->transflag) {
+            if (fftPlan->allOpsInplace) {
+              // First transpose
+              // Input->tmp
+              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
+                                               hcInputBuffers, NULL, NULL);
+            } else {
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+            }
+
+            if (fftPlan->location == HCFFT_INPLACE) {
+              // First Row
+              // tmp->output
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                                 hcInputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planX, dir, hcTmpBuffers, hcInputBuffers, NULL);
+              }
+
+              // Second Transpose
+              // output->tmp
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                                 hcInputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTY, dir, hcInputBuffers, hcTmpBuffers, NULL);
+              }
+
+              // Second Row
+              // tmp->tmp, inplace
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcInputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcTmpBuffers, NULL, NULL);
+              }
+
+              // Third Transpose
+              // tmp->output
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                                 hcInputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTZ, dir, hcTmpBuffers, hcInputBuffers, NULL);
+              }
+            } else {
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planX, dir, hcTmpBuffers, hcOutputBuffers, NULL);
+              }
+
+              // Second Transpose
+              // output->tmp
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTY, dir, hcOutputBuffers, hcTmpBuffers, NULL);
+              }
+
+              // Second Row
+              // tmp->tmp, inplace
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcTmpBuffers, NULL, NULL);
+              }
+
+              // Third Transpose
+              // tmp->output
+              if (fftPlan->allOpsInplace) {
+                hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+              } else {
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTZ, dir, hcTmpBuffers, hcOutputBuffers, NULL);
+              }
+            }
+          } else {
+            if (fftPlan->large1D == 0) {
+              if (fftPlan->planCopy) {
+                // Transpose OUTOFPLACE
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL),
+                    // FFT INPLACE
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                                     hcTmpBuffers, NULL, NULL);
+                // FFT INPLACE
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcTmpBuffers, NULL, NULL);
+
+                if (fftPlan->location == HCFFT_INPLACE) {
+                  // Copy kernel
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planCopy, dir,
+                                                   hcTmpBuffers, hcInputBuffers,
+                                                   NULL);
+                } else {
+                  // Copy kernel
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planCopy, dir,
+                                                   hcTmpBuffers,
+                                                   hcOutputBuffers, NULL);
+                }
+              } else {
+                // First pass
+                // column with twiddle first, OUTOFPLACE, + transpose
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planX, dir, hcInputBuffers, hcTmpBuffers, NULL);
 
                 if (fftPlan->planTZ) {
                   hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
                                                    hcTmpBuffers, NULL, NULL);
 
-                  if (fftPlan->location == HCFFT_INPLACE) {
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
-                                                     hcTmpBuffers,
-                                                     hcInputBuffers, NULL);
-                  } else {
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
-                                                     hcTmpBuffers,
-                                                     hcOutputBuffers, NULL);
-                  }
-                } else {
-                  // another column FFT output, OUTOFPLACE
-                  if (fftPlan->location == HCFFT_INPLACE) {
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                     hcTmpBuffers,
-                                                     hcInputBuffers, NULL);
-                  } else {
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                     hcTmpBuffers,
-                                                     hcOutputBuffers, NULL);
-                  }
-                }
-              }
-            } else {
-              // second pass for huge 1D
-              // column with twiddle first, OUTOFPLACE, + transpose
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                               hcTmpBuffers, hcOutputBuffers,
-                                               hcTmpBuffers);
-              hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                               hcOutputBuffers, hcOutputBuffers,
-                                               hcTmpBuffers);
-            }
-          }
-        }
+                  if (fftPlan->location == HCFFT_INPLACE) {
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                                     hcTmpBuffers,
+                                                     hcInputBuffers, NULL);
+                  } else {
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                                     hcTmpBuffers,
+                                                     hcOutputBuffers, NULL);
+                  }
+                } else {
+                  // another column FFT output, OUTOFPLACE
+                  if (fftPlan->location == HCFFT_INPLACE) {
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                     hcTmpBuffers,
+                                                     hcInputBuffers, NULL);
+                  } else {
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                     hcTmpBuffers,
+                                                     hcOutputBuffers, NULL);
+                  }
+                }
+              }
+            } else {
+              // second pass for huge 1D
+              // column with twiddle first, OUTOFPLACE, + transpose
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                               hcTmpBuffers, hcOutputBuffers,
+                                               hcTmpBuffers);
+              hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                               hcOutputBuffers, hcOutputBuffers,
+                                               hcTmpBuffers);
+            }
+          }
+        }
+
+        return HCFFT_SUCCEEDS;
+      }
+
+      case HCFFT_2D: {
+        // if transpose kernel, we will fall below
+        if (fftPlan->transflag && !(fftPlan->planTX)) {
+          break;
+        }
+
+        // as does the single kernel of a plan held in LDS
+        if (fftPlan->lds2D) {
+          break;
+        }
+
+        if ((fftPlan->gen == Transpose_NONSQUARE) &&
+            (fftPlan->nonSquareKernelType == NON_SQUARE_TRANS_PARENT)) {
+          hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir, hcInputBuffers,
+                                           NULL, NULL);
+          hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir, hcInputBuffers,
+                                           NULL, NULL);
+
+          // the last step of a shuffle transpose
+          if (fftPlan->planTZ) {
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTZ, dir,
+                                             hcInputBuffers, NULL, NULL);
+          }
+
+          return HCFFT_SUCCEEDS;
+        }
+
+        if (fftPlan->transflag && fftPlan->transposeType == HCFFT_TRANSPOSED &&
+            dir == HCFFT_BACKWARD) {
+          // The input is transposed: columns, the second transpose back to
+          // natural order, then the rows in place on the result
+          T* result = (fftPlan->location == HCFFT_INPLACE) ? hcInputBuffers
+                                                           : hcOutputBuffers;
+
+          //  The rows read the result with the input distance
+          if (fftPlan->location == HCFFT_OUTOFPLACE &&
+              fftPlan->iDist != fftPlan->oDist) {
+            return HCFFT_INVALID;
+          }
+
+          if (!fftPlan->transpose_in_2d_inplace) {
+            hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
+                                             hcInputBuffers, hcTmpBuffers,
+                                             NULL);
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                             hcTmpBuffers, result, NULL);
+          } else {
+            if (fftPlan->planZ) {
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
+                                               hcInputBuffers, result, NULL);
+            } else {
+              hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir, result,
+                                               NULL, NULL);
+            }
+
+            hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir, result,
+                                             NULL, NULL);
+          }
+
+          hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, result,
+                                           result, NULL);
+          return HCFFT_SUCCEEDS;
+        }
+
+        if (fftPlan->transflag) {
+          // first time set up transpose kernel for 2D
+          // First row
+          hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcInputBuffers,
+                                           hcOutputBuffers, NULL);
+
+          if (fftPlan->location == HCFFT_INPLACE) {
+            if (!fftPlan->transpose_in_2d_inplace) {
+              // First transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+
+              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcTmpBuffers, NULL, NULL);
+                // Second transpose
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTY, dir, hcTmpBuffers, hcInputBuffers, NULL);
+              } else {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planY, dir, hcTmpBuffers, hcInputBuffers, NULL);
+              }
+            } else {
+              // First Transpose
+              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
+                                               hcInputBuffers, NULL, NULL);
+
+              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcInputBuffers, NULL, NULL);
+                // Second transpose
+                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                                 hcInputBuffers, NULL, NULL);
+              } else {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcInputBuffers, NULL, NULL);
+              }
+            }
+          } else {
+            if (!fftPlan->transpose_in_2d_inplace) {
+              // First transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTX, dir, hcOutputBuffers, hcTmpBuffers, NULL);
+
+              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcTmpBuffers, NULL, NULL);
+                // Second transpose
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planTY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
+              } else {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
+              }
+            } else {
+              // First Transpose
+              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
+                                               hcOutputBuffers, NULL, NULL);
+
+              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+                // Second transpose
+                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+              } else {
+                // Second Row transform
+                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                 hcOutputBuffers, NULL, NULL);
+              }
+            }
+          }
+        } else {
+          if ((fftPlan->large2D || fftPlan->blockColumn ||
+               fftPlan->length.size() > 2) &&
+              (fftPlan->ipLayout != HCFFT_REAL) &&
+              (fftPlan->opLayout != HCFFT_REAL)) {
+            if (fftPlan->location == HCFFT_INPLACE) {
+              // deal with row first
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planX, dir, hcInputBuffers, NULL, hcTmpBuffers);
+              // deal with column
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planY, dir, hcInputBuffers, NULL, hcTmpBuffers);
+            } else {
+              // deal with row first
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                               hcInputBuffers, hcOutputBuffers,
+                                               hcTmpBuffers);
+              // deal with column
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planY, dir, hcOutputBuffers, NULL, hcTmpBuffers);
+            }
+          } else {
+            if (fftPlan->ipLayout == HCFFT_REAL) {
+              if (fftPlan->planTX) {
+                // First row
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planX, dir, hcInputBuffers, hcOutputBuffers, NULL);
+
+                if (fftPlan->location == HCFFT_INPLACE) {
+                  // First transpose
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+                  // Second Row transform
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                   hcTmpBuffers, NULL, NULL);
+                  // Second transpose
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planTY, dir, hcTmpBuffers, hcInputBuffers, NULL);
+                } else {
+                  // First transpose
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
+                                                   hcOutputBuffers,
+                                                   hcTmpBuffers, NULL);
+                  // Second Row transform
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                   hcTmpBuffers, NULL, NULL);
+                  // Second transpose
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
+                                                   hcTmpBuffers,
+                                                   hcOutputBuffers, NULL);
+                }
+              } else {
+                if (fftPlan->location == HCFFT_INPLACE) {
+                  // deal with row
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planX, HCFFT_FORWARD, hcInputBuffers, NULL,
+                      hcTmpBuffers);
+                  // deal with column
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planY, HCFFT_FORWARD, hcInputBuffers, NULL,
+                      hcTmpBuffers);
+                } else {
+                  // deal with row
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planX, HCFFT_FORWARD, hcInputBuffers,
+                      hcOutputBuffers, hcTmpBuffers);
+                  // deal with column
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planY, HCFFT_FORWARD, hcOutputBuffers, NULL,
+                      hcTmpBuffers);
+                }
+              }
+            } else if (fftPlan->opLayout == HCFFT_REAL) {
+              // NOTE : 2D C2R CALL COMES HERE
+              if (fftPlan->planTY) {
+                if ((fftPlan->location == HCFFT_INPLACE) ||
+                    ((fftPlan->location == HCFFT_OUTOFPLACE) &&
+                     (fftPlan->length.size() > 2))) {
+                  // First transpose
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planTY, dir, hcInputBuffers, hcTmpBuffers, NULL);
+                  // First row
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                   hcTmpBuffers, NULL, NULL);
+                  // Second transpose
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planTX, dir, hcTmpBuffers, hcInputBuffers, NULL);
+
+                  // Second Row transform
+                  if (fftPlan->location == HCFFT_INPLACE) {
+                    hcfftEnqueueTransformInternal<T>(
+                        fftPlan->planX, dir, hcInputBuffers, NULL, NULL);
+                  } else {
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                                     hcInputBuffers,
+                                                     hcOutputBuffers, NULL);
+                  }
+                } else {
+                  // First transpose
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planTY, dir, hcInputBuffers, hcTmpBuffers, NULL);
+                  // First row
+                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
+                                                   hcTmpBuffers, NULL, NULL);
+                  // Second transpose
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planTX, dir, hcTmpBuffers,
+                      (T*)fftPlan->intBufferC2R, NULL);
+
+                  // Second Row transform
+                  if (fftPlan->location == HCFFT_INPLACE) {
+                    hcfftEnqueueTransformInternal<T>(
+                        fftPlan->planX, dir, hcInputBuffers, NULL, NULL);
+                  } else {
+                    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                                     (T*)fftPlan->intBufferC2R,
+                                                     hcOutputBuffers, NULL);
+                  }
+                }
+              } else {
+                if (fftPlan->location == HCFFT_INPLACE) {
+                  // deal with column
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planY, HCFFT_BACKWARD, hcInputBuffers, NULL,
+                      hcTmpBuffers);
+                  // deal with row
+                  hcfftEnqueueTransformInternal<T>(
+                      fftPlan->planX, HCFFT_BACKWARD, hcInputBuffers, NULL,
+                      hcTmpBuffers);
+                } else {
+                  if (fftPlan->length.size() > 2) {
+                    // deal with column
+                    hcfftEnqueueTransformInternal<T>(
+                        fftPlan->planY, HCFFT_BACKWARD, hcInputBuffers, NULL,
+                        hcTmpBuffers);
+                    // deal with row
+                    hcfftEnqueueTransformInternal<T>(
+                        fftPlan->planX, HCFFT_BACKWARD, hcInputBuffers,
+                        hcOutputBuffers, hcTmpBuffers);
+                  } else {
+                    // deal with column
+                    hcfftEnqueueTransformInternal<T>(
+                        fftPlan->planY, HCFFT_BACKWARD, hcInputBuffers,
+                        (T*)fftPlan->intBufferC2R, hcTmpBuffers);
+                    // deal with row
+                    hcfftEnqueueTransformInternal<T>(
+                        fftPlan->planX, HCFFT_BACKWARD,
+                        (T*)fftPlan->intBufferC2R, hcOutputBuffers,
+                        hcTmpBuffers);
+                  }
+                }
+              }
+            } else {
+              // deal with row first
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+
+              if (fftPlan->location == HCFFT_INPLACE) {
+                // deal with column
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planY, dir, hcTmpBuffers, hcInputBuffers, NULL);
+              } else {
+                // deal with column
+                hcfftEnqueueTransformInternal<T>(
+                    fftPlan->planY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
+              }
+            }
+          }
+        }
+
+        return HCFFT_SUCCEEDS;
+      }
+
+      case HCFFT_3D: {
+        if (fftPlan->ipLayout == HCFFT_REAL) {
+          if (fftPlan->planTX && !fftPlan->blockSlab) {
+            // First row
+            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                             hcInputBuffers, hcOutputBuffers,
+                                             hcTmpBuffers);
+
+            if (fftPlan->location == HCFFT_INPLACE) {
+              // First transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+              // Second Row transform
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
+                                               hcTmpBuffers, NULL, NULL);
+              // Second transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTY, dir, hcTmpBuffers, hcInputBuffers, NULL);
+            } else {
+              // First transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTX, dir, hcOutputBuffers, hcTmpBuffers, NULL);
+              // Second Row transform
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
+                                               hcTmpBuffers, NULL, NULL);
+              // Second transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
+            }
+          } else {
+            if (fftPlan->location == HCFFT_INPLACE) {
+              // deal with 2D row first
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_FORWARD,
+                                               hcInputBuffers, NULL,
+                                               hcTmpBuffers);
+              // deal with 1D Z column
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, HCFFT_FORWARD,
+                                               hcInputBuffers, NULL,
+                                               hcTmpBuffers);
+            } else {
+              // deal with 2D row first
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_FORWARD,
+                                               hcInputBuffers, hcOutputBuffers,
+                                               hcTmpBuffers);
+              // deal with 1D Z column
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, HCFFT_FORWARD,
+                                               hcOutputBuffers, NULL,
+                                               hcTmpBuffers);
+            }
+          }
+        } else if (fftPlan->opLayout == HCFFT_REAL) {
+          if (fftPlan->planTZ) {
+            if (fftPlan->location == HCFFT_INPLACE) {
+              // First transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTZ, dir, hcInputBuffers, hcTmpBuffers, NULL);
+              // First row
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
+                                               hcTmpBuffers, NULL, NULL);
+              // Second transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTX, dir, hcTmpBuffers, hcInputBuffers, NULL);
+              // Second Row transform
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                               hcInputBuffers, NULL, NULL);
+            } else {
+              // First transpose
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planTZ, dir, hcInputBuffers, hcTmpBuffers, NULL);
+              // First row
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
+                                               hcTmpBuffers, NULL, NULL);
+              // Second transpose
+              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
+                                               hcTmpBuffers,
+                                               (T*)fftPlan->intBufferC2R, NULL);
+              // Second Row transform
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                               (T*)fftPlan->intBufferC2R,
+                                               hcOutputBuffers, NULL);
+            }
+          } else {
+            if (fftPlan->location == HCFFT_INPLACE) {
+              // deal with 1D Z column first
+              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, HCFFT_BACKWARD,
+                                               hcInputBuffers, NULL,
+                                               hcTmpBuffers);
+              // deal with 2D row
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_BACKWARD,
+                                               hcInputBuffers, NULL,
+                                               hcTmpBuffers);
+            } else {
+              // deal with 1D Z column first
+              hcfftEnqueueTransformInternal<T>(
+                  fftPlan->planZ, HCFFT_BACKWARD, hcInputBuffers,
+                  (T*)fftPlan->intBufferC2R, hcTmpBuffers);
+              // deal with 2D row
+              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_BACKWARD,
+                                               (T*)fftPlan->intBufferC2R,
+                                               hcOutputBuffers, hcTmpBuffers);
+            }
+          }
+        } else {
+          if (fftPlan->location == HCFFT_INPLACE) {
+            // deal with 2D row first
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planX, dir, hcInputBuffers, NULL, hcTmpBuffers);
+            // deal with 1D Z column
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planZ, dir, hcInputBuffers, NULL, hcTmpBuffers);
+          } else {
+            // deal with 2D row first
+            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
+                                             hcInputBuffers, hcOutputBuffers,
+                                             hcTmpBuffers);
+            // deal with 1D Z column
+            hcfftEnqueueTransformInternal<T>(
+                fftPlan->planZ, dir, hcOutputBuffers, NULL, hcTmpBuffers);
+          }
+        }
+
+        return HCFFT_SUCCEEDS;
+      }
+
+      //  Plans of more dimensions are transformed as rank N plans above
+      case HCFFT_4D:
+      case HCFFT_5D:
+      case HCFFT_6D:
+        return HCFFT_INVALID;
+    }
+
+  uint batch = std::max<uint>(1, uint(fftPlan->batchSize));
+
+  //  Only the buffer slots of the argument block change between calls
+  if (fftPlan->kernelArgIn == 0) {
+    return HCFFT_ERROR;
+  }
+
+  //  Entry points are resolved when the plan is baked
+  FUNC_FFTFwd* FFTcall =
+      (dir == HCFFT_BACKWARD) ? fftPlan->kernelPtrBack : fftPlan->kernelPtr;
+
+  if (FFTcall == NULL) {
+    std::cout << "No kernel for this direction in " << fftPlan->kernellib
+              << std::endl;
+    return HCFFT_ERROR;
+  }
+
+  std::vector<size_t> gWorkSize;
+  std::vector<size_t> lWorkSize;
+  hcfftStatus result = fftPlan->GetWorkSizes(gWorkSize, lWorkSize);
+
+  if (HCFFT_ERROR == result) {
+    std::cout << "Work size too large for EnqueueTransform" << std::endl;
+  }
+
+  BUG_CHECK(gWorkSize.size() == lWorkSize.size());
+
+  if (fftPlan->launchRecord) {
+    hcfftLaunch launch = {fftPlan, FFTcall, hcInputBuffers, hcOutputBuffers,
+                          batch};
+    fftPlan->launchRecord->push_back(launch);
+    return status;
+  }
+
+  hcfftKernelArgs& args = fftPlan->kernelArgs;
+
+  for (unsigned int i = 0; i < fftPlan->kernelArgIn; i++) {
+    args.buffers[i] = hcInputBuffers;
+  }
+
+  for (unsigned int i = 0; i < fftPlan->kernelArgOut; i++) {
+    args.buffers[fftPlan->kernelArgIn + i] = hcOutputBuffers;
+  }
+
+  HCFFT_TRACE_RANGE("hcfft plan " << plHandle << " "
+                                  << GeneratorName(fftPlan->gen));
+  FFTcall(&args, batch, fftPlan->acc_view, fftPlan->acc);
+  hcfftCounters.launches++;
+  return status;
+}
+// Template Initialization supporting just float and double types
+template hcfftStatus FFTPlan::hcfftEnqueueTransformInternal<float>(
+    hcfftPlanHandle plHandle, hcfftDirection dir, float* hcInputBuffers,
+    float* hcOutputBuffers, float* hcTmpBuffers);
+template hcfftStatus FFTPlan::hcfftEnqueueTransformInternal<double>(
+    hcfftPlanHandle plHandle, hcfftDirection dir, double* hcInputBuffers,
+    double* hcOutputBuffers, double* hcTmpBuffers);
+
+hcfftStatus FFTPlan::hcfftBakePlan(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T("hcfftBakePlan"));
+
+  if (fftPlan->baked == true) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  HCFFT_TRACE_RANGE("hcfft plan " << plHandle << " bake");
+
+  hcfftBakeContext bake;
+  hcfftStatus status;
+  {
+    bakeScope scope(bake);
+    status = hcfftBakePlanInternal(plHandle);
+  }
+
+  if (status == HCFFT_SUCCEEDS) {
+    status = bake.kernelStatus;
+  }
+
+  // Sub-plans created by the bake start out on the default view
+  hcfftSetAcclView(plHandle, fftPlan->acc_view);
+
+  if (status == HCFFT_SUCCEEDS) {
+    status = BuildKernelLibraries(bake.pendingKernels);
+  }
+
+  for (size_t i = 0; i < bake.pendingKernels.size(); i++) {
+    remove(bake.pendingKernels[i].source.c_str());
+  }
+
+  for (size_t i = 0; status == HCFFT_SUCCEEDS && i < bake.bakedPlans.size();
+       i++) {
+    status = ResolveKernels(bake.bakedPlans[i]);
+  }
+
+  // Evict only once the kernels of this plan are loaded
+  if (!bake.pendingKernels.empty()) {
+    evictKernelCache(getKernelCacheDir());
+  }
+
+  // HCFFT_AUTOTUNE tunes the plans of programs that do not ask for it
+  char* autotune = getenv("HCFFT_AUTOTUNE");
+
+  if (status == HCFFT_SUCCEEDS && !fftPlan->estimateOnly &&
+      (fftPlan->autotune || (autotune != NULL && atoi(autotune) > 0))) {
+    status = hcfftTunePlan(plHandle);
+  }
+
+  if (status != HCFFT_SUCCEEDS) {
+    fftPlan->baked = false;
+  }
+
+  return status;
+}
+
+//  Elements of a buffer of a leaf plan spanning its lengths, strides and
+//  batch
+static size_t LeafExtent(const std::vector<size_t>& length,
+                         const std::vector<size_t>& stride, size_t dist,
+                         size_t batchSize) {
+  size_t extent = (std::max<size_t>(1, batchSize) - 1) * dist + 1;
+
+  for (size_t i = 0; i < length.size() && i < stride.size(); i++) {
+    extent += (std::max<size_t>(1, length[i]) - 1) * stride[i];
+  }
+
+  return extent;
+}
+
+//  Call the kernel of a leaf plan on in and out, as the end of
+//  hcfftEnqueueTransformInternal does
+static void LaunchLeaf(FFTPlan* fftPlan, hcfftDirection dir, void* in,
+                       void* out) {
+  hcfftKernelArgs& args = fftPlan->kernelArgs;
+
+  for (unsigned int i = 0; i < fftPlan->kernelArgIn; i++) {
+    args.buffers[i] = in;
+  }
+
+  for (unsigned int i = 0; i < fftPlan->kernelArgOut; i++) {
+    args.buffers[fftPlan->kernelArgIn + i] = out;
+  }
+
+  uint batch = std::max<uint>(1, uint(fftPlan->batchSize));
+  FFTPlan::FUNC_FFTFwd* FFTcall =
+      (dir == HCFFT_BACKWARD) ? fftPlan->kernelPtrBack : fftPlan->kernelPtr;
+  FFTcall(&args, batch, fftPlan->acc_view, fftPlan->acc);
+}
+
+//  Seconds per call of the kernel of a leaf plan, the best of three rounds of
+//  ten calls. The calls alternate directions, so that the scale of the
+//  backward kernel keeps the data of in-place kernels bounded.
+static double TimeLeaf(FFTPlan* fftPlan, void* in, void* out) {
+  double best = 0;
+
+  for (int round = 0; round < 3; round++) {
+    double seconds = 0;
+    {
+      scopedTimer timer(seconds);
+
+      for (int i = 0; i < 10; i++) {
+        LaunchLeaf(fftPlan, (i % 2) ? HCFFT_BACKWARD : HCFFT_FORWARD, in, out);
+      }
+
+      fftPlan->acc_view.wait();
+    }
+
+    if (round == 0 || seconds < best) {
+      best = seconds;
+    }
+  }
+
+  return best / 10;
+}
+
+//  Forward transform of input by the kernel of a leaf plan, read back from
+//  out into output
+template <typename T>
+static void RunLeaf(FFTPlan* fftPlan, const std::vector<T>& input, T* in,
+                    T* out, std::vector<T>& output) {
+  fftPlan->acc_view.copy(input.data(), in, input.size() * sizeof(T));
+  LaunchLeaf(fftPlan, HCFFT_FORWARD, in, out);
+  fftPlan->acc_view.wait();
+  fftPlan->acc_view.copy(out, output.data(), output.size() * sizeof(T));
+}
+
+//  Bake the kernel of a leaf plan with tuning, queueing its source for
+//  BuildKernelLibraries when it is not built yet. With load, a kernel that is
+//  not built is built right away, and the entry points are resolved.
+static hcfftStatus BakeTunedKernel(hcfftPlanHandle plHandle, FFTPlan* fftPlan,
+                                   const hcfftKernelTuning& tuning,
+                                   bool load) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  fftPlan->tuneWorkGroupSize = tuning.workGroupSize;
+  fftPlan->tuneNumTrans = tuning.numTrans;
+  fftPlan->bLdsComplex = tuning.ldsComplex;
+
+  // The generator takes a new reference on the tables, and the pass
+  // twiddles are laid out by the radices of the variant
+  if (fftPlan->twiddles != NULL) {
+    fftRepo.releaseTwiddles(fftPlan->twiddles);
+    fftPlan->twiddles = NULL;
+  }
+
+  if (fftPlan->twiddleslarge != NULL) {
+    fftRepo.releaseTwiddles(fftPlan->twiddleslarge);
+    fftPlan->twiddleslarge = NULL;
+  }
+
+  hcfftStatus status = BakeKernel(plHandle, fftPlan);
+
+  std::vector<pendingKernel>& pending = sbake->pendingKernels;
+
+  if (status == HCFFT_SUCCEEDS && load && !pending.empty()) {
+    status = BuildKernelLibraries(pending);
+
+    for (size_t i = 0; i < pending.size(); i++) {
+      remove(pending[i].source.c_str());
+    }
+
+    pending.clear();
+  }
+
+  if (status == HCFFT_SUCCEEDS && load && !fftPlan->kernelPtr &&
+      !fftPlan->kernelPtrBack) {
+    status = ResolveKernels(fftPlan);
+  }
+
+  if (status == HCFFT_SUCCEEDS && load &&
+      (!fftPlan->kernelPtr || !fftPlan->kernelPtrBack ||
+       !fftPlan->kernelArgIn)) {
+    status = HCFFT_ERROR;
+  }
+
+  return status;
+}
+
+//  Autotune the kernel of a leaf plan. Every variant of GetTuningCandidates
+//  is generated and the ones missing from the cache are built together; each
+//  then transforms the same input as the kernel of DetermineSizes, and the
+//  fastest whose output matches it is recorded in FFTRepo under the
+//  signature of that kernel, where the leaves of later bakes find it.
+//  Variants that fail to build or differ are dropped.
+template <typename T>
+static hcfftStatus TuneLeafPlan(hcfftPlanHandle plHandle, FFTPlan* fftPlan) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  std::vector<hcfftKernelTuning> candidates;
+  fftPlan->GetTuningCandidates(candidates);
+
+  // Leaves already baked with a tuning were tuned by an earlier bake
+  if (candidates.empty() || (fftPlan->tuneWorkGroupSize != 0) ||
+      !fftPlan->kernelPtr || !fftPlan->kernelPtrBack ||
+      !fftPlan->kernelArgIn) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  scopedTimer timer(fftPlan->timings.tune);
+  size_t signature = getKernelSignature(fftPlan);
+  hcfftKernelTuning heuristic = HeuristicTuning(fftPlan);
+
+  bool inplace = (fftPlan->location == HCFFT_INPLACE);
+  size_t inCount = LeafExtent(fftPlan->length, fftPlan->inStride,
+                              fftPlan->iDist, fftPlan->batchSize);
+  size_t outCount = LeafExtent(fftPlan->length, fftPlan->outStride,
+                               fftPlan->oDist, fftPlan->batchSize);
+
+  if (inplace) {
+    inCount = outCount = std::max(inCount, outCount);
+  }
+
+  std::vector<T> input(2 * inCount), reference(2 * outCount),
+      output(2 * outCount);
+  unsigned int seed = 1;
+
+  for (size_t i = 0; i < input.size(); i++) {
+    seed = seed * 1103515245u + 12345u;
+    input[i] = T((seed >> 16) % 2048) / T(1024) - T(1);
+  }
+
+  T* in = (T*)hc::am_alloc(input.size() * sizeof(T), fftPlan->acc, 0);
+  T* out = inplace ? in
+                   : (T*)hc::am_alloc(output.size() * sizeof(T), fftPlan->acc,
+                                      0);
+
+  // Without room for the buffers the plan keeps the heuristic kernel
+  if (in == NULL || out == NULL) {
+    if (in != NULL) {
+      hc::am_free(in);
+    }
+
+    if (!inplace && out != NULL) {
+      hc::am_free(out);
+    }
+
+    return HCFFT_SUCCEEDS;
+  }
+
+  RunLeaf(fftPlan, input, in, out, reference);
+  double best = TimeLeaf(fftPlan, in, out);
+  double peak = 0;
+
+  for (size_t i = 0; i < reference.size(); i++) {
+    peak = std::max<double>(peak, std::abs(reference[i]));
+  }
+
+  // Variants round differently, by about the twiddle precision
+  double tolerance =
+      ((sizeof(T) == sizeof(float)) || fftPlan->singleTwiddles) ? 1e-4 : 1e-10;
+  hcfftKernelTuning choice = heuristic;
+  // The variants are baked apart from the bake of the tree
+  hcfftBakeContext bake;
+  bakeScope scope(bake);
+
+  for (size_t c = 0; c < candidates.size(); c++) {
+    BakeTunedKernel(plHandle, fftPlan, candidates[c], false);
+  }
+
+  BuildKernelLibraries(bake.pendingKernels);
+
+  for (size_t i = 0; i < bake.pendingKernels.size(); i++) {
+    remove(bake.pendingKernels[i].source.c_str());
+  }
+
+  bool built = !bake.pendingKernels.empty();
+  bake.pendingKernels.clear();
+
+  for (size_t c = 0; c < candidates.size(); c++) {
+    const hcfftKernelTuning& tuning = candidates[c];
+
+    if ((tuning.workGroupSize == heuristic.workGroupSize) &&
+        (tuning.numTrans == heuristic.numTrans) && !tuning.ldsComplex) {
+      continue;
+    }
+
+    if (BakeTunedKernel(plHandle, fftPlan, tuning, true) != HCFFT_SUCCEEDS) {
+      continue;
+    }
+
+    RunLeaf(fftPlan, input, in, out, output);
+    double error = 0;
+
+    for (size_t i = 0; i < output.size(); i++) {
+      error = std::max<double>(error, std::abs(output[i] - reference[i]));
+    }
+
+    if (!(error <= tolerance * peak)) {
+      continue;
+    }
+
+    double seconds = TimeLeaf(fftPlan, in, out);
+
+    if (seconds < best) {
+      best = seconds;
+      choice = tuning;
+    }
+  }
+
+  choice.description = getTargetISA(fftPlan->acc) +
+                       ((fftPlan->precision == HCFFT_DOUBLE) ? " double"
+                                                             : " single");
+
+  for (size_t i = 0; i < fftPlan->length.size(); i++) {
+    choice.description += (i ? "x" : " length ") + SztToStr(fftPlan->length[i]);
+  }
+
+  choice.description +=
+      " batch " + SztToStr(fftPlan->batchSize) +
+      (inplace ? " in-place" : " out-of-place");
+  fftRepo.setTuning(signature, choice);
+  hcfftStatus status = BakeTunedKernel(plHandle, fftPlan, choice, true);
+  hc::am_free(in);
+
+  if (!inplace) {
+    hc::am_free(out);
+  }
+
+  if (built) {
+    evictKernelCache(getKernelCacheDir());
+  }
+
+  return status;
+}
+
+hcfftStatus FFTPlan::hcfftTunePlan(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T("hcfftTunePlan"));
+  hcfftStatus status = HCFFT_SUCCEEDS;
+
+  if (fftPlan->kernelPtr || fftPlan->kernelPtrBack) {
+    status = (fftPlan->precision == HCFFT_DOUBLE)
+                 ? TuneLeafPlan<double>(plHandle, fftPlan)
+                 : TuneLeafPlan<float>(plHandle, fftPlan);
+  }
+
+  hcfftPlanHandle subPlans[8] = {
+      fftPlan->planX,  fftPlan->planY,  fftPlan->planZ,
+      fftPlan->planTX, fftPlan->planTY, fftPlan->planTZ,
+      fftPlan->planRCcopy, fftPlan->planCopy};
+
+  for (int i = 0; status == HCFFT_SUCCEEDS && i < 8; i++) {
+    if (subPlans[i]) {
+      status = hcfftTunePlan(subPlans[i]);
+    }
+  }
+
+  return status;
+}
+
+//  Bake the plan on a background thread. The bake takes the plan lock, so
+//  setters and transforms issued meanwhile are serialised behind it; a second
+//  request while one is still in flight is a no-op.
+hcfftStatus FFTPlan::hcfftBakePlanAsync(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(fftPlan->bakeLock, _T("hcfftBakePlanAsync"));
+
+  if (fftPlan->bakeFuture.valid() &&
+      fftPlan->bakeFuture.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  fftPlan->bakeFuture = std::async(std::launch::async, [plHandle]() {
+                          FFTPlan plan;
+                          return plan.hcfftBakePlan(plHandle);
+                        }).share();
+  return HCFFT_SUCCEEDS;
+}
+
+//  Wait for a bake started by hcfftBakePlanAsync and return its status
+hcfftStatus FFTPlan::hcfftWaitBakePlan(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  std::shared_future<hcfftStatus> bake;
+  {
+    scopedLock sLock(fftPlan->bakeLock, _T("hcfftWaitBakePlan"));
+    bake = fftPlan->bakeFuture;
+  }
+
+  if (!bake.valid()) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  return bake.get();
+}
+
+//  Whether the in-place square and non-square transpose kernels take a
+//  smallerDim x biggerDim matrix
+static bool IsTransposableInplace(size_t smallerDim, size_t biggerDim) {
+  if (smallerDim == 0 || biggerDim % smallerDim != 0) {
+    return false;
+  }
+
+  size_t dim_ratio = biggerDim / smallerDim;
+
+  if (dim_ratio > 1 && dim_ratio % 2 != 0 && dim_ratio % 3 != 0 &&
+      dim_ratio % 5 != 0) {
+    return false;
+  }
+
+  // The swap kernel splits lines longer than 1024 by factors of 2, 3 and 5
+  size_t LDS_per_WG = smallerDim;
+
+  while (LDS_per_WG > 1024) {
+    if (LDS_per_WG % 2 == 0) {
+      LDS_per_WG /= 2;
+    } else if (LDS_per_WG % 3 == 0) {
+      LDS_per_WG /= 3;
+    } else if (LDS_per_WG % 5 == 0) {
+      LDS_per_WG /= 5;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//  Whether the shuffle transpose takes the rows x cols matrix of fftPlan in
+//  place. It takes any shape, but holds a row or a column in LDS, and reads
+//  the transpose from the same packed memory.
+static bool IsShuffleTransposable(const FFTPlan* fftPlan, size_t cols,
+                                  size_t rows, size_t stride,
+                                  size_t rowStride) {
+  if (rowStride != cols * stride ||
+      fftPlan->ipLayout == HCFFT_HERMITIAN_INTERLEAVED ||
+      fftPlan->ipLayout == HCFFT_HERMITIAN_PLANAR) {
+    return false;
+  }
+
+  size_t elementSize = fftPlan->ElementSize();
+
+  if (fftPlan->ipLayout == HCFFT_REAL) {
+    elementSize /= 2;
+  }
+
+  return std::max(rows, cols) * elementSize <=
+         static_cast<size_t>(fftPlan->envelope.limit_LocalMemSize);
+}
+
+//  Creates and bakes one step of the in-place shuffle transpose of fftPlan,
+//  a non-square parent. Only the last step takes the large1D twiddles.
+static void BakeShuffleTransposeStep(FFTPlan* fftPlan,
+                                     hcfftPlanHandle* stepHandle,
+                                     NonSquareTransposeKernelType type) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  size_t hcLengths[] = {fftPlan->length[0], fftPlan->length[1]};
+  hcfftCreateDefaultPlanInternal(stepHandle, HCFFT_2D, hcLengths);
+  FFTPlan* stepPlan = NULL;
+  lockRAII* stepLock = NULL;
+  fftRepo.getPlan(*stepHandle, stepPlan, stepLock);
+  stepPlan->location = HCFFT_INPLACE;
+  stepPlan->precision = fftPlan->precision;
+  stepPlan->tmpBufSize = 0;
+  stepPlan->batchSize = fftPlan->batchSize;
+  stepPlan->envelope = fftPlan->envelope;
+  stepPlan->ipLayout = fftPlan->ipLayout;
+  stepPlan->opLayout = fftPlan->opLayout;
+  stepPlan->inStride[0] = fftPlan->inStride[0];
+  stepPlan->outStride[0] = fftPlan->outStride[0];
+  stepPlan->inStride[1] = fftPlan->inStride[1];
+  stepPlan->outStride[1] = fftPlan->outStride[1];
+  stepPlan->iDist = fftPlan->iDist;
+  stepPlan->oDist = fftPlan->oDist;
+  stepPlan->gen = Transpose_NONSQUARE;
+  stepPlan->nonSquareKernelType = type;
+  stepPlan->transflag = true;
+  stepPlan->large1D =
+      (type == NON_SQUARE_TRANS_COLUMN_SHUFFLE) ? fftPlan->large1D : 0;
+  stepPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+  stepPlan->originalLength = fftPlan->originalLength;
+  stepPlan->acc = fftPlan->acc;
+  stepPlan->exist = fftPlan->exist;
+  stepPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+
+  for (size_t index = 2; index < fftPlan->length.size(); index++) {
+    stepPlan->length.push_back(fftPlan->length[index]);
+    stepPlan->inStride.push_back(fftPlan->inStride[index]);
+    stepPlan->outStride.push_back(fftPlan->outStride[index]);
+  }
+
+  fftPlan->hcfftBakePlanInternal(*stepHandle);
+}
+
+//  Whether length factors into the radices of the Stockham kernels
+static bool IsRadixLength(size_t length) {
+  const size_t radices[] = {2, 3, 5, 7, 11, 13};
+
+  for (size_t i = 0; i < sizeof(radices) / sizeof(radices[0]); i++) {
+    while (length % radices[i] == 0) {
+      length /= radices[i];
+    }
+  }
+
+  return length == 1;
+}
+
+static bool IsPrime(size_t n) {
+  if (n < 2) {
+    return false;
+  }
+
+  for (size_t d = 2; d * d <= n; d++) {
+    if (n % d == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//  Operations of a single-kernel transform of length, taken as the length
+//  times the sum of its radices
+static size_t KernelCost(size_t length) {
+  size_t cost = 0;
+
+  for (size_t n = length, d = 2; n > 1; d++) {
+    while (n % d == 0) {
+      n /= d;
+      cost += d;
+    }
+  }
+
+  return length * cost;
+}
+
+//  Forward transform on the host, for the filter spectra of Bluestein and
+//  Rader plans. Lengths are split by their smallest factor, and the
+//  remaining primes are transformed directly.
+static void HostFFT(std::vector<std::complex<double> >& data) {
+  size_t n = data.size();
+  size_t r = 2;
+
+  while (r < n && n % r != 0) {
+    r++;
+  }
+
+  if (n < 2) {
+    return;
+  }
+
+  if (r == n) {
+    std::vector<std::complex<double> > out(n);
+
+    for (size_t k = 0; k < n; k++) {
+      for (size_t j = 0; j < n; j++) {
+        out[k] += data[j] * std::polar(1.0, -2.0 * M_PI * ((j * k) % n) / n);
+      }
+    }
+
+    data = out;
+    return;
+  }
+
+  size_t m = n / r;
+  std::vector<std::vector<std::complex<double> > > sub(
+      r, std::vector<std::complex<double> >(m));
+
+  for (size_t s = 0; s < r; s++) {
+    for (size_t j = 0; j < m; j++) {
+      sub[s][j] = data[j * r + s];
+    }
+
+    HostFFT(sub[s]);
+  }
+
+  for (size_t k = 0; k < n; k++) {
+    std::complex<double> sum = 0;
+
+    for (size_t s = 0; s < r; s++) {
+      sum += sub[s][k % m] * std::polar(1.0, -2.0 * M_PI * ((s * k) % n) / n);
+    }
+
+    data[k] = sum;
+  }
+}
+
+//  Appends values to host in the element type of precision
+static void AppendComplex(std::vector<char>& host,
+                          const std::vector<std::complex<double> >& values,
+                          hcfftPrecision precision) {
+  for (size_t i = 0; i < values.size(); i++) {
+    if (precision == HCFFT_SINGLE) {
+      float v[2] = {static_cast<float>(values[i].real()),
+                    static_cast<float>(values[i].imag())};
+      host.insert(host.end(), reinterpret_cast<char*>(v),
+                  reinterpret_cast<char*>(v + 2));
+    } else {
+      double v[2] = {values[i].real(), values[i].imag()};
+      host.insert(host.end(), reinterpret_cast<char*>(v),
+                  reinterpret_cast<char*>(v + 2));
+    }
+  }
+}
+
+//  Whether the layout of fftPlan lets the loads and stores of the transforms
+//  of a Bluestein or Rader plan go through callbacks
+static bool IsConvolutionPlan(const FFTPlan* fftPlan) {
+  return (fftPlan->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+         (fftPlan->opLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+         fftPlan->loadCallback.empty() && fftPlan->storeCallback.empty() &&
+         (fftPlan->gen == Stockham) &&
+         (fftPlan->transposeType == HCFFT_NOTRANSPOSE) &&
+         (fftPlan->large1D == 0);
+}
+
+//  Uploads the tables of a Bluestein or Rader plan to chirps, or only
+//  accounts for them when the plan is estimated
+static hcfftStatus UploadChirps(FFTPlan* fftPlan,
+                                const std::vector<char>& host) {
+  fftPlan->twiddleBytes += host.size();
+
+  if (fftPlan->estimateOnly) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  fftPlan->chirps =
+      gaugedAlloc(host.size(), fftPlan->acc, hcfftCounters.twiddleBytes);
+
+  if (fftPlan->chirps == NULL) {
+    return HCFFT_ERROR;
+  }
+
+  fftPlan->acc_view.copy(&host[0], fftPlan->chirps, host.size());
+  return HCFFT_SUCCEEDS;
+}
+
+//  Creates an out-of-place complex sub-plan of a Bluestein or Rader plan,
+//  transforming rows of length in a packed layout that its callbacks map to
+//  the data of the plan
+static FFTPlan* CreateConvolutionSubPlan(FFTPlan* fftPlan,
+                                         hcfftPlanHandle* handle,
+                                         size_t length, size_t rows) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  hcfftCreateDefaultPlanInternal(handle, HCFFT_1D, &length);
+  FFTPlan* subPlan = NULL;
+  lockRAII* subLock = NULL;
+  fftRepo.getPlan(*handle, subPlan, subLock);
+  subPlan->location = HCFFT_OUTOFPLACE;
+  subPlan->ipLayout = HCFFT_COMPLEX_INTERLEAVED;
+  subPlan->opLayout = HCFFT_COMPLEX_INTERLEAVED;
+  subPlan->precision = fftPlan->precision;
+  subPlan->forwardScale = 1.0f;
+  subPlan->backwardScale = 1.0f;
+  subPlan->tmpBufSize = 0;
+  subPlan->gen = Stockham;
+  subPlan->envelope = fftPlan->envelope;
+  subPlan->batchSize = rows;
+  subPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+  subPlan->originalLength = fftPlan->originalLength;
+  subPlan->acc = fftPlan->acc;
+  subPlan->exist = fftPlan->exist;
+  subPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+  return subPlan;
+}
+
+//  Offset of row r of a Bluestein or Rader plan in the layout of the plan,
+//  the rows running over the lengths after the first and then over the batch
+static std::string ConvolutionRowOffset(const std::vector<size_t>& length,
+                                        const std::vector<size_t>& stride,
+                                        size_t dist) {
+  std::string str;
+  std::string row = "r";
+
+  for (size_t i = 1; i < length.size(); i++) {
+    str += "(" + row + " % " + SztToStr(length[i]) + ") * " +
+           SztToStr(stride[i]) + " + ";
+    row = "(" + row + " / " + SztToStr(length[i]) + ")";
+  }
+
+  str += row + " * " + SztToStr(dist);
+  return str;
+}
+
+//  Declares the row r and the index i in the row of offset into rows of
+//  length
+static std::string ConvolutionRowIndex(size_t length, const std::string& i) {
+  std::string str;
+  str += "\tunsigned int r = offset / " + SztToStr(length) + ";\n";
+  str += "\tunsigned int " + i + " = offset % " + SztToStr(length) + ";\n";
+  return str;
+}
+
+//  Product of the complex values a and b, of type
+static std::string ComplexProduct(const std::string& type,
+                                  const std::string& a, const std::string& b) {
+  return type + "(" + a + ".x * " + b + ".x - " + a + ".y * " + b + ".y, " +
+         a + ".x * " + b + ".y + " + a + ".y * " + b + ".x)";
+}
+
+//  Load callback of the padded forward transform of a Bluestein plan:
+//  element n of row r is element n of the input row times the chirp, or 0
+//  past the input length
+static std::string BluesteinLoadSource(const std::string& type, size_t N,
+                                       size_t M, const std::string& row,
+                                       size_t stride) {
+  std::string str;
+  str += type + " hcfftChirpLoad(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(M, "n");
+  str += "\tif (n >= " + SztToStr(N) + ") return " + type + "(0, 0);\n";
+  str += "\t" + type + " x = buffer[" + row + " + n * " + SztToStr(stride);
+  str += "];\n";
+  str += "\t" + type + " w = static_cast<" + type + " *>(callerInfo)[n];\n";
+  str += "\treturn " + ComplexProduct(type, "x", "w") + ";\n}\n";
+  return str;
+}
+
+//  Store callback of the padded forward transform of a Bluestein plan,
+//  multiplying by the filter spectrum
+static std::string BluesteinFilterSource(const std::string& type, size_t M) {
+  std::string str;
+  str += "void hcfftChirpFilter(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += "\t" + type + " f = static_cast<" + type + " *>(callerInfo)[offset % ";
+  str += SztToStr(M) + "];\n";
+  str += "\tbuffer[offset] = " + ComplexProduct(type, "element", "f");
+  str += ";\n}\n";
+  return str;
+}
+
+//  Store callback of the padded inverse transform of a Bluestein plan:
+//  element k of row r, times the chirp, is element k of the output row, and
+//  the padding is dropped
+static std::string BluesteinStoreSource(const std::string& type, size_t N,
+                                        size_t M, const std::string& row,
+                                        size_t stride) {
+  std::string str;
+  str += "void hcfftChirpStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(M, "k");
+  str += "\tif (k >= " + SztToStr(N) + ") return;\n";
+  str += "\t" + type + " w = static_cast<" + type + " *>(callerInfo)[k];\n";
+  str += "\tbuffer[" + row + " + k * " + SztToStr(stride) + "] = ";
+  str += ComplexProduct(type, "element", "w") + ";\n}\n";
+  return str;
+}
+
+//  Bluestein's algorithm writes a transform of length N as the convolution of
+//  x[n] w[n], with the chirp w[n] = exp(-i pi n^2 / N), and conj(w), followed
+//  by a multiply by w. The convolution runs as a forward and an inverse
+//  transform of a power of 2 length M >= 2N - 1. The chirp multiplies, the
+//  padding and the multiply by the filter spectrum are callbacks on the
+//  loads and stores of the two kernels, and the scale of the plan is folded
+//  into the spectrum.
+hcfftStatus FFTPlan::hcfftBakeBluestein(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftBakeBluestein"));
+  size_t N = fftPlan->length[0];
+  size_t M = (size_t)1 << CeilPo2(2 * N - 1);
+  size_t Large1DThreshold = 0;
+  fftPlan->GetMax1DLength(&Large1DThreshold);
+
+  if (!IsConvolutionPlan(fftPlan) || (M > Large1DThreshold)) {
+    return HCFFT_INVALID;
+  }
+
+  size_t rows = fftPlan->batchSize;
+
+  for (size_t i = 1; i < fftPlan->length.size(); i++) {
+    rows *= fftPlan->length[i];
+  }
+
+  size_t elem = fftPlan->ElementSize();
+  fftPlan->tmpBufSize = rows * M * elem;
+
+  // Chirp and filter spectrum of the forward, then the backward direction
+  std::vector<char> host;
+
+  for (int d = 0; d < 2; d++) {
+    double sign = d ? 1.0 : -1.0;
+    double scale =
+        (d ? fftPlan->backwardScale : fftPlan->forwardScale) / M;
+    std::vector<std::complex<double> > chirp(N);
+    std::vector<std::complex<double> > filter(M);
+
+    for (size_t n = 0; n < N; n++) {
+      double theta = sign * M_PI * ((n * n) % (2 * N)) / N;
+      chirp[n] = std::polar(1.0, theta);
+      filter[n] = std::conj(chirp[n]);
+
+      if (n > 0) {
+        filter[M - n] = std::conj(chirp[n]);
+      }
+    }
+
+    HostFFT(filter);
+
+    for (size_t k = 0; k < M; k++) {
+      filter[k] *= scale;
+    }
+
+    AppendComplex(host, chirp, fftPlan->precision);
+    AppendComplex(host, filter, fftPlan->precision);
+  }
+
+  hcfftStatus status = UploadChirps(fftPlan, host);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  std::string type =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string inRow = ConvolutionRowOffset(fftPlan->length, fftPlan->inStride,
+                                           fftPlan->iDist);
+  std::string outRow = ConvolutionRowOffset(
+      fftPlan->length, fftPlan->outStride, fftPlan->oDist);
+  hcfftPlanHandle* inner[4] = {&fftPlan->planX, &fftPlan->planY,
+                               &fftPlan->planTX, &fftPlan->planTY};
+
+  for (int i = 0; i < 4; i++) {
+    char* chirp = static_cast<char*>(fftPlan->chirps);
+
+    if (chirp != NULL) {
+      chirp += (i / 2) * (N + M) * elem;
+    }
+
+    FFTPlan* innerPlan = CreateConvolutionSubPlan(fftPlan, inner[i], M, rows);
+
+    if (i % 2 == 0) {
+      innerPlan->loadCallback.funcName = "hcfftChirpLoad";
+      innerPlan->loadCallback.funcString =
+          BluesteinLoadSource(type, N, M, inRow, fftPlan->inStride[0]);
+      innerPlan->loadCallback.userdata = chirp;
+      innerPlan->storeCallback.funcName = "hcfftChirpFilter";
+      innerPlan->storeCallback.funcString = BluesteinFilterSource(type, M);
+      innerPlan->storeCallback.userdata = chirp ? chirp + N * elem : NULL;
+    } else {
+      innerPlan->storeCallback.funcName = "hcfftChirpStore";
+      innerPlan->storeCallback.funcString =
+          BluesteinStoreSource(type, N, M, outRow, fftPlan->outStride[0]);
+      innerPlan->storeCallback.userdata = chirp;
+    }
+
+    status = hcfftBakePlanInternal(*inner[i]);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  fftPlan->bluestein = true;
+  fftPlan->baked = true;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Load callback of the forward transform of a Rader plan: element m of row
+//  r is input element g^m, less input element 0
+static std::string RaderLoadSource(const std::string& type, size_t L,
+                                   const std::string& row, size_t stride) {
+  std::string str;
+  str += type + " hcfftRaderLoad(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(L, "m");
+  str += "\tunsigned int n = static_cast<unsigned int *>(callerInfo)[m];\n";
+  str += "\t" + type + " x = buffer[" + row + " + n * " + SztToStr(stride);
+  str += "];\n";
+  str += "\t" + type + " x0 = buffer[" + row + "];\n";
+  str += "\treturn " + type + "(x.x - x0.x, x.y - x0.y);\n}\n";
+  return str;
+}
+
+//  Store callback of the forward transform of a Rader plan, whose data are
+//  the input rows: coefficient k goes to output element k + 1, and the first
+//  one, with p times input element 0, is output element 0
+static std::string RaderSumSource(const std::string& type, size_t p,
+                                  double scale, const std::string& inRow,
+                                  const std::string& outRow, size_t stride) {
+  std::stringstream ss;
+  ss.precision(17);
+  ss << std::scientific << scale;
+  std::string s = ss.str();
+  std::string str;
+  str += "void hcfftRaderSum(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(p - 1, "k");
+  str += "\tbuffer[" + outRow + " + (k + 1) * " + SztToStr(stride);
+  str += "] = element;\n";
+  str += "\tif (k != 0) return;\n";
+  str += "\t" + type + " x0 = static_cast<" + type + " *>(callerInfo)[";
+  str += inRow + "];\n";
+  str += "\tbuffer[" + outRow + "] = " + type + "((element.x + " +
+         SztToStr(p) + " * x0.x) * " + s + ", (element.y + " + SztToStr(p) +
+         " * x0.y) * " + s + ");\n}\n";
+  return str;
+}
+
+//  Load callback of the inverse transform of a Rader plan, multiplying
+//  coefficient k, from output element k + 1, by the filter spectrum
+static std::string RaderFilterSource(const std::string& type, size_t L,
+                                     const std::string& row, size_t stride) {
+  std::string str;
+  str += type + " hcfftRaderFilter(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(L, "k");
+  str += "\t" + type + " c = buffer[" + row + " + (k + 1) * " +
+         SztToStr(stride) + "];\n";
+  str += "\t" + type + " f = static_cast<" + type + " *>(callerInfo)[k];\n";
+  str += "\treturn " + ComplexProduct(type, "c", "f") + ";\n}\n";
+  return str;
+}
+
+//  Store callback of the inverse transform of a Rader plan: element q of row
+//  r is output element g^-q
+static std::string RaderStoreSource(const std::string& type, size_t L,
+                                    const std::string& row, size_t stride) {
+  std::string str;
+  str += "void hcfftRaderStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(L, "q");
+  str += "\tunsigned int n = static_cast<unsigned int *>(callerInfo)[q];\n";
+  str += "\tbuffer[" + row + " + n * " + SztToStr(stride) + "] = element;\n}\n";
+  return str;
+}
+
+//  The smallest generator of the multiplicative group modulo the prime p
+static size_t PrimitiveRoot(size_t p) {
+  std::vector<size_t> factors;
+
+  for (size_t n = p - 1, d = 2; n > 1; d++) {
+    if (n % d == 0) {
+      factors.push_back(d);
+
+      while (n % d == 0) {
+        n /= d;
+      }
+    }
+  }
+
+  for (size_t g = 2; g < p; g++) {
+    bool root = true;
+
+    for (size_t i = 0; root && i < factors.size(); i++) {
+      size_t e = (p - 1) / factors[i];
+      size_t power = 1;
+
+      for (size_t j = 0; j < e; j++) {
+        power = (power * g) % p;
+      }
+
+      root = (power != 1);
+    }
+
+    if (root) {
+      return g;
+    }
+  }
+
+  return 1;
+}
+
+//  Rader's algorithm writes a transform of prime length p, for outputs
+//  X[g^-q] with g a generator modulo p, as x[0] plus the cyclic convolution
+//  of length L = p - 1 of x[g^m] with w^(g^-m), w being the root of unity.
+//  The convolution runs as a forward and an inverse transform of length L:
+//  the first reads the inputs permuted, less x[0], which adds x[0] to every
+//  term of the convolution, and writes the coefficients to the output, with
+//  X[0] = A[0] + p x[0] from the first one. The second multiplies by the
+//  filter spectrum on its loads, in place on the output, and its stores undo
+//  the permutation. The input is passed to the first store when the plan
+//  is enqueued.
+hcfftStatus FFTPlan::hcfftBakeRader(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftBakeRader"));
+  size_t p = fftPlan->length[0];
+  size_t L = p - 1;
+
+  if (!IsConvolutionPlan(fftPlan)) {
+    return HCFFT_INVALID;
+  }
+
+  size_t rows = fftPlan->batchSize;
+
+  for (size_t i = 1; i < fftPlan->length.size(); i++) {
+    rows *= fftPlan->length[i];
+  }
+
+  size_t g = PrimitiveRoot(p);
+  std::vector<unsigned int> perm(L);
+  std::vector<unsigned int> permInv(L);
+
+  for (size_t m = 0, power = 1; m < L; m++) {
+    perm[m] = power;
+    permInv[(L - m) % L] = power;
+    power = (power * g) % p;
+  }
+
+  // Filter spectra of the forward and the backward direction, then the
+  // permutations of the loads and the stores
+  std::vector<char> host;
+
+  for (int d = 0; d < 2; d++) {
+    double sign = d ? 1.0 : -1.0;
+    double scale = (d ? fftPlan->backwardScale : fftPlan->forwardScale) / L;
+    std::vector<std::complex<double> > filter(L);
+
+    for (size_t m = 0; m < L; m++) {
+      filter[m] = std::polar(1.0, sign * 2.0 * M_PI * permInv[m] / p);
+    }
+
+    HostFFT(filter);
+
+    for (size_t k = 0; k < L; k++) {
+      filter[k] *= scale;
+    }
+
+    AppendComplex(host, filter, fftPlan->precision);
+  }
+
+  host.insert(host.end(), reinterpret_cast<char*>(&perm[0]),
+              reinterpret_cast<char*>(&perm[0] + L));
+  host.insert(host.end(), reinterpret_cast<char*>(&permInv[0]),
+              reinterpret_cast<char*>(&permInv[0] + L));
+  hcfftStatus status = UploadChirps(fftPlan, host);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  size_t elem = fftPlan->ElementSize();
+  char* tables = static_cast<char*>(fftPlan->chirps);
+  std::string type =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string inRow = ConvolutionRowOffset(fftPlan->length, fftPlan->inStride,
+                                           fftPlan->iDist);
+  std::string outRow = ConvolutionRowOffset(
+      fftPlan->length, fftPlan->outStride, fftPlan->oDist);
+  hcfftPlanHandle* inner[4] = {&fftPlan->planX, &fftPlan->planY,
+                               &fftPlan->planTX, &fftPlan->planTY};
+
+  for (int i = 0; i < 4; i++) {
+    bool back = (i >= 2);
+    FFTPlan* innerPlan = CreateConvolutionSubPlan(fftPlan, inner[i], L, rows);
+
+    if (i % 2 == 0) {
+      innerPlan->loadCallback.funcName = "hcfftRaderLoad";
+      innerPlan->loadCallback.funcString =
+          RaderLoadSource(type, L, inRow, fftPlan->inStride[0]);
+      innerPlan->loadCallback.userdata =
+          tables ? tables + 2 * L * elem : NULL;
+      innerPlan->storeCallback.funcName = "hcfftRaderSum";
+      innerPlan->storeCallback.funcString = RaderSumSource(
+          type, p, back ? fftPlan->backwardScale : fftPlan->forwardScale,
+          inRow, outRow, fftPlan->outStride[0]);
+    } else {
+      innerPlan->location = HCFFT_INPLACE;
+      innerPlan->loadCallback.funcName = "hcfftRaderFilter";
+      innerPlan->loadCallback.funcString =
+          RaderFilterSource(type, L, outRow, fftPlan->outStride[0]);
+      innerPlan->loadCallback.userdata =
+          tables ? tables + (back ? L : 0) * elem : NULL;
+      innerPlan->storeCallback.funcName = "hcfftRaderStore";
+      innerPlan->storeCallback.funcString =
+          RaderStoreSource(type, L, outRow, fftPlan->outStride[0]);
+      innerPlan->storeCallback.userdata =
+          tables ? tables + 2 * L * elem + L * sizeof(unsigned int) : NULL;
+    }
+
+    status = hcfftBakePlanInternal(*inner[i]);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
+
+  fftPlan->rader = true;
+  fftPlan->baked = true;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Load callback of the transform of a short-time plan: element n of row r
+//  is sample n of frame r of the real input times the window, with an
+//  imaginary part of 0
+static std::string StftLoadSource(const std::string& type,
+                                  const std::string& real, size_t N,
+                                  const std::string& row, size_t stride) {
+  std::string str;
+  str += type + " hcfftWindowLoad(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "n");
+  str += "\t" + real + " *x = reinterpret_cast<" + real + " *>(buffer);\n";
+  str += "\t" + real + " w = static_cast<" + real + " *>(callerInfo)[n];\n";
+  str += "\treturn " + type + "(x[" + row + " + n * " + SztToStr(stride);
+  str += "] * w, 0);\n}\n";
+  return str;
+}
+
+//  Store callback of the transform of a short-time plan, keeping the
+//  nonredundant coefficients of row r in the hermitian output
+static std::string StftStoreSource(const std::string& type, size_t N,
+                                   const std::string& row, size_t stride) {
+  std::string str;
+  str += "void hcfftWindowStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "k");
+  str += "\tif (k > " + SztToStr(N / 2) + ") return;\n";
+  str += "\tbuffer[" + row + " + k * " + SztToStr(stride) + "] = element;\n";
+  str += "}\n";
+  return str;
+}
 
-        return HCFFT_SUCCEEDS;
-      }
+//  A short-time plan reads its frames straight from the signal, so that
+//  frames iDist < length[0] apart are neither copied out nor windowed by a
+//  pass of their own. Each real frame is the real part of a complex
+//  transform in planX, whose load callback applies the window and whose
+//  store callback keeps the length[0] / 2 + 1 coefficients of the frame.
+hcfftStatus FFTPlan::hcfftBakeStft(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftBakeStft"));
+  size_t N = fftPlan->length[0];
+  size_t Large1DThreshold = 0;
+  fftPlan->GetMax1DLength(&Large1DThreshold);
 
-      case HCFFT_2D: {
-        // if transpose kernel, we will fall below
-        if (fftPlan->transflag && !(fftPlan->planTX)) {
-          break;
-        }
+  if ((fftPlan->dimension != HCFFT_1D) || (fftPlan->length.size() != 1) ||
+      (fftPlan->ipLayout != HCFFT_REAL) ||
+      (fftPlan->opLayout != HCFFT_HERMITIAN_INTERLEAVED) ||
+      (fftPlan->location != HCFFT_OUTOFPLACE) ||
+      !fftPlan->loadCallback.empty() || !fftPlan->storeCallback.empty() ||
+      (fftPlan->gen != Stockham) ||
+      (fftPlan->transposeType != HCFFT_NOTRANSPOSE) ||
+      (fftPlan->window.size() != N) || !IsRadixLength(N) ||
+      !Is1DPossible(N, Large1DThreshold)) {
+    return HCFFT_INVALID;
+  }
 
-        if ((fftPlan->gen == Transpose_NONSQUARE) &&
-            (fftPlan->nonSquareKernelType == NON_SQUARE_TRANS_PARENT)) {
-          hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir, hcInputBuffers,
-                                           NULL, NULL);
-          hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir, hcInputBuffers,
-                                           NULL, NULL);
-          return HCFFT_SUCCEEDS;
-        }
+  // Window with the scale of the transform, in the precision of the plan
+  size_t real = fftPlan->ElementSize() / 2;
+  std::vector<char> host(N * real);
 
-        if (fftPlan->transflag) {
-          // first time set up transpose kernel for 2D
-          // First row
-          hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir, hcInputBuffers,
-                                           hcOutputBuffers, NULL);
+  for (size_t n = 0; n < N; n++) {
+    double w = fftPlan->window[n] * fftPlan->forwardScale;
 
-          if (fftPlan->location == HCFFT_INPLACE) {
-            if (!fftPlan->transpose_in_2d_inplace) {
-              // First transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+    if (fftPlan->precision == HCFFT_SINGLE) {
+      reinterpret_cast<float*>(&host[0])[n] = static_cast<float>(w);
+    } else {
+      reinterpret_cast<double*>(&host[0])[n] = w;
+    }
+  }
 
-              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcTmpBuffers, NULL, NULL);
-                // Second transpose
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTY, dir, hcTmpBuffers, hcInputBuffers, NULL);
-              } else {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planY, dir, hcTmpBuffers, hcInputBuffers, NULL);
-              }
-            } else {
-              // First Transpose
-              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
-                                               hcInputBuffers, NULL, NULL);
+  fftPlan->tmpBufSize = 0;
+  hcfftStatus status = UploadChirps(fftPlan, host);
 
-              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcInputBuffers, NULL, NULL);
-                // Second transpose
-                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                                 hcInputBuffers, NULL, NULL);
-              } else {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcInputBuffers, NULL, NULL);
-              }
-            }
-          } else {
-            if (!fftPlan->transpose_in_2d_inplace) {
-              // First transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTX, dir, hcOutputBuffers, hcTmpBuffers, NULL);
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
 
-              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcTmpBuffers, NULL, NULL);
-                // Second transpose
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planTY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
-              } else {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
-              }
-            } else {
-              // First Transpose
-              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
-                                               hcOutputBuffers, NULL, NULL);
+  std::string type =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string realType =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float" : "double";
+  std::string inRow = ConvolutionRowOffset(fftPlan->length, fftPlan->inStride,
+                                           fftPlan->iDist);
+  std::string outRow = ConvolutionRowOffset(
+      fftPlan->length, fftPlan->outStride, fftPlan->oDist);
+  FFTPlan* subPlan = CreateConvolutionSubPlan(fftPlan, &fftPlan->planX, N,
+                                              fftPlan->batchSize);
+  subPlan->loadCallback.funcName = "hcfftWindowLoad";
+  subPlan->loadCallback.funcString =
+      StftLoadSource(type, realType, N, inRow, fftPlan->inStride[0]);
+  subPlan->loadCallback.userdata = fftPlan->chirps;
+  subPlan->storeCallback.funcName = "hcfftWindowStore";
+  subPlan->storeCallback.funcString =
+      StftStoreSource(type, N, outRow, fftPlan->outStride[0]);
+  status = hcfftBakePlanInternal(fftPlan->planX);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
 
-              if (fftPlan->transposeType == HCFFT_NOTRANSPOSE) {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-                // Second transpose
-                hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-              } else {
-                // Second Row transform
-                hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                 hcOutputBuffers, NULL, NULL);
-              }
-            }
-          }
-        } else {
-          if ((fftPlan->large2D || fftPlan->length.size() > 2) &&
-              (fftPlan->ipLayout != HCFFT_REAL) &&
-              (fftPlan->opLayout != HCFFT_REAL)) {
-            if (fftPlan->location == HCFFT_INPLACE) {
-              // deal with row first
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planX, dir, hcInputBuffers, NULL, hcTmpBuffers);
-              // deal with column
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planY, dir, hcInputBuffers, NULL, hcTmpBuffers);
-            } else {
-              // deal with row first
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                               hcInputBuffers, hcOutputBuffers,
-                                               hcTmpBuffers);
-              // deal with column
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planY, dir, hcOutputBuffers, NULL, hcTmpBuffers);
-            }
-          } else {
-            if (fftPlan->ipLayout == HCFFT_REAL) {
-              if (fftPlan->planTX) {
-                // First row
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planX, dir, hcInputBuffers, hcOutputBuffers, NULL);
+  fftPlan->stft = true;
+  fftPlan->baked = true;
+  return HCFFT_SUCCEEDS;
+}
 
-                if (fftPlan->location == HCFFT_INPLACE) {
-                  // First transpose
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
-                  // Second Row transform
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                   hcTmpBuffers, NULL, NULL);
-                  // Second transpose
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planTY, dir, hcTmpBuffers, hcInputBuffers, NULL);
-                } else {
-                  // First transpose
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
-                                                   hcOutputBuffers,
-                                                   hcTmpBuffers, NULL);
-                  // Second Row transform
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                   hcTmpBuffers, NULL, NULL);
-                  // Second transpose
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planTY, dir,
-                                                   hcTmpBuffers,
-                                                   hcOutputBuffers, NULL);
-                }
-              } else {
-                if (fftPlan->location == HCFFT_INPLACE) {
-                  // deal with row
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planX, HCFFT_FORWARD, hcInputBuffers, NULL,
-                      hcTmpBuffers);
-                  // deal with column
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planY, HCFFT_FORWARD, hcInputBuffers, NULL,
-                      hcTmpBuffers);
-                } else {
-                  // deal with row
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planX, HCFFT_FORWARD, hcInputBuffers,
-                      hcOutputBuffers, hcTmpBuffers);
-                  // deal with column
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planY, HCFFT_FORWARD, hcOutputBuffers, NULL,
-                      hcTmpBuffers);
-                }
-              }
-            } else if (fftPlan->opLayout == HCFFT_REAL) {
-              // NOTE : 2D C2R CALL COMES HERE
-              if (fftPlan->planTY) {
-                if ((fftPlan->location == HCFFT_INPLACE) ||
-                    ((fftPlan->location == HCFFT_OUTOFPLACE) &&
-                     (fftPlan->length.size() > 2))) {
-                  // First transpose
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planTY, dir, hcInputBuffers, hcTmpBuffers, NULL);
-                  // First row
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                   hcTmpBuffers, NULL, NULL);
-                  // Second transpose
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planTX, dir, hcTmpBuffers, hcInputBuffers, NULL);
+hcfftStatus FFTPlan::hcfftSetPlanWindow(hcfftPlanHandle plHandle,
+                                        const double* window) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-                  // Second Row transform
-                  if (fftPlan->location == HCFFT_INPLACE) {
-                    hcfftEnqueueTransformInternal<T>(
-                        fftPlan->planX, dir, hcInputBuffers, NULL, NULL);
-                  } else {
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                                     hcInputBuffers,
-                                                     hcOutputBuffers, NULL);
-                  }
-                } else {
-                  // First transpose
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planTY, dir, hcInputBuffers, hcTmpBuffers, NULL);
-                  // First row
-                  hcfftEnqueueTransformInternal<T>(fftPlan->planY, dir,
-                                                   hcTmpBuffers, NULL, NULL);
-                  // Second transpose
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planTX, dir, hcTmpBuffers,
-                      (T*)fftPlan->intBufferC2R, NULL);
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanWindow"));
+
+  // Windows apply to the frames of 1D real to hermitian plans only
+  if (window != NULL && (fftPlan->hcfftlibtype != HCFFT_R2CD2Z ||
+                         fftPlan->length.size() != 1)) {
+    return HCFFT_INVALID;
+  }
+
+  fftPlan->window.clear();
+
+  if (window != NULL) {
+    fftPlan->window.assign(window, window + fftPlan->length[0]);
+  }
 
-                  // Second Row transform
-                  if (fftPlan->location == HCFFT_INPLACE) {
-                    hcfftEnqueueTransformInternal<T>(
-                        fftPlan->planX, dir, hcInputBuffers, NULL, NULL);
-                  } else {
-                    hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                                     (T*)fftPlan->intBufferC2R,
-                                                     hcOutputBuffers, NULL);
-                  }
-                }
-              } else {
-                if (fftPlan->location == HCFFT_INPLACE) {
-                  // deal with column
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planY, HCFFT_BACKWARD, hcInputBuffers, NULL,
-                      hcTmpBuffers);
-                  // deal with row
-                  hcfftEnqueueTransformInternal<T>(
-                      fftPlan->planX, HCFFT_BACKWARD, hcInputBuffers, NULL,
-                      hcTmpBuffers);
-                } else {
-                  if (fftPlan->length.size() > 2) {
-                    // deal with column
-                    hcfftEnqueueTransformInternal<T>(
-                        fftPlan->planY, HCFFT_BACKWARD, hcInputBuffers, NULL,
-                        hcTmpBuffers);
-                    // deal with row
-                    hcfftEnqueueTransformInternal<T>(
-                        fftPlan->planX, HCFFT_BACKWARD, hcInputBuffers,
-                        hcOutputBuffers, hcTmpBuffers);
-                  } else {
-                    // deal with column
-                    hcfftEnqueueTransformInternal<T>(
-                        fftPlan->planY, HCFFT_BACKWARD, hcInputBuffers,
-                        (T*)fftPlan->intBufferC2R, hcTmpBuffers);
-                    // deal with row
-                    hcfftEnqueueTransformInternal<T>(
-                        fftPlan->planX, HCFFT_BACKWARD,
-                        (T*)fftPlan->intBufferC2R, hcOutputBuffers,
-                        hcTmpBuffers);
-                  }
-                }
-              }
-            } else {
-              // deal with row first
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planX, dir, hcInputBuffers, hcTmpBuffers, NULL);
+  fftPlan->baked = false;
+  return HCFFT_SUCCEEDS;
+}
 
-              if (fftPlan->location == HCFFT_INPLACE) {
-                // deal with column
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planY, dir, hcTmpBuffers, hcInputBuffers, NULL);
-              } else {
-                // deal with column
-                hcfftEnqueueTransformInternal<T>(
-                    fftPlan->planY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
-              }
-            }
-          }
-        }
+//  Load callback of a stage of a pruned plan: element n of row r is element
+//  n of the row in the data, and 0 past the extent of the input along the
+//  row. Real rows are read into the real parts.
+static std::string PrunedLoadSource(const std::string& type,
+                                    const std::string& real, size_t N,
+                                    size_t extent, const std::string& row,
+                                    size_t stride) {
+  std::string index = row + " + n * " + SztToStr(stride);
+  std::string str;
+  str += type + " hcfftPrunedLoad(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "n");
+  str += "\tif (n >= " + SztToStr(extent) + ") return " + type + "(0, 0);\n";
+
+  if (real.empty()) {
+    str += "\treturn buffer[" + index + "];\n}\n";
+  } else {
+    str += "\treturn " + type + "(reinterpret_cast<" + real + " *>(buffer)[";
+    str += index + "], 0);\n}\n";
+  }
 
-        return HCFFT_SUCCEEDS;
-      }
+  return str;
+}
 
-      case HCFFT_3D: {
-        if (fftPlan->ipLayout == HCFFT_REAL) {
-          if (fftPlan->planTX) {
-            // First row
-            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                             hcInputBuffers, hcOutputBuffers,
-                                             hcTmpBuffers);
+//  Store callback of a stage of a pruned plan, writing the first kept
+//  elements of row r to the row in the data
+static std::string PrunedStoreSource(const std::string& type, size_t N,
+                                     size_t kept, const std::string& row,
+                                     size_t stride) {
+  std::string str;
+  str += "void hcfftPrunedStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "k");
+
+  if (kept < N) {
+    str += "\tif (k >= " + SztToStr(kept) + ") return;\n";
+  }
 
-            if (fftPlan->location == HCFFT_INPLACE) {
-              // First transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTX, dir, hcInputBuffers, hcTmpBuffers, NULL);
-              // Second Row transform
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
-                                               hcTmpBuffers, NULL, NULL);
-              // Second transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTY, dir, hcTmpBuffers, hcInputBuffers, NULL);
-            } else {
-              // First transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTX, dir, hcOutputBuffers, hcTmpBuffers, NULL);
-              // Second Row transform
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
-                                               hcTmpBuffers, NULL, NULL);
-              // Second transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTY, dir, hcTmpBuffers, hcOutputBuffers, NULL);
-            }
-          } else {
-            if (fftPlan->location == HCFFT_INPLACE) {
-              // deal with 2D row first
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_FORWARD,
-                                               hcInputBuffers, NULL,
-                                               hcTmpBuffers);
-              // deal with 1D Z column
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, HCFFT_FORWARD,
-                                               hcInputBuffers, NULL,
-                                               hcTmpBuffers);
-            } else {
-              // deal with 2D row first
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_FORWARD,
-                                               hcInputBuffers, hcOutputBuffers,
-                                               hcTmpBuffers);
-              // deal with 1D Z column
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, HCFFT_FORWARD,
-                                               hcOutputBuffers, NULL,
-                                               hcTmpBuffers);
-            }
-          }
-        } else if (fftPlan->opLayout == HCFFT_REAL) {
-          if (fftPlan->planTZ) {
-            if (fftPlan->location == HCFFT_INPLACE) {
-              // First transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTZ, dir, hcInputBuffers, hcTmpBuffers, NULL);
-              // First row
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
-                                               hcTmpBuffers, NULL, NULL);
-              // Second transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTX, dir, hcTmpBuffers, hcInputBuffers, NULL);
-              // Second Row transform
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                               hcInputBuffers, NULL, NULL);
-            } else {
-              // First transpose
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planTZ, dir, hcInputBuffers, hcTmpBuffers, NULL);
-              // First row
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, dir,
-                                               hcTmpBuffers, NULL, NULL);
-              // Second transpose
-              hcfftEnqueueTransformInternal<T>(fftPlan->planTX, dir,
-                                               hcTmpBuffers,
-                                               (T*)fftPlan->intBufferC2R, NULL);
-              // Second Row transform
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                               (T*)fftPlan->intBufferC2R,
-                                               hcOutputBuffers, NULL);
-            }
-          } else {
-            if (fftPlan->location == HCFFT_INPLACE) {
-              // deal with 1D Z column first
-              hcfftEnqueueTransformInternal<T>(fftPlan->planZ, HCFFT_BACKWARD,
-                                               hcInputBuffers, NULL,
-                                               hcTmpBuffers);
-              // deal with 2D row
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_BACKWARD,
-                                               hcInputBuffers, NULL,
-                                               hcTmpBuffers);
-            } else {
-              // deal with 1D Z column first
-              hcfftEnqueueTransformInternal<T>(
-                  fftPlan->planZ, HCFFT_BACKWARD, hcInputBuffers,
-                  (T*)fftPlan->intBufferC2R, hcTmpBuffers);
-              // deal with 2D row
-              hcfftEnqueueTransformInternal<T>(fftPlan->planX, HCFFT_BACKWARD,
-                                               (T*)fftPlan->intBufferC2R,
-                                               hcOutputBuffers, hcTmpBuffers);
-            }
-          }
-        } else {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            // deal with 2D row first
-            hcfftEnqueueTransformInternal<T>(
-                fftPlan->planX, dir, hcInputBuffers, NULL, hcTmpBuffers);
-            // deal with 1D Z column
-            hcfftEnqueueTransformInternal<T>(
-                fftPlan->planZ, dir, hcInputBuffers, NULL, hcTmpBuffers);
-          } else {
-            // deal with 2D row first
-            hcfftEnqueueTransformInternal<T>(fftPlan->planX, dir,
-                                             hcInputBuffers, hcOutputBuffers,
-                                             hcTmpBuffers);
-            // deal with 1D Z column
-            hcfftEnqueueTransformInternal<T>(
-                fftPlan->planZ, dir, hcOutputBuffers, NULL, hcTmpBuffers);
-          }
-        }
+  str += "\tbuffer[" + row + " + k * " + SztToStr(stride) + "] = element;\n";
+  str += "}\n";
+  return str;
+}
 
-        return HCFFT_SUCCEEDS;
-      }
+//  A pruned plan knows that its input is 0 past inputExtent, as a filter
+//  padded to the size of the transform, or needs only its outputs within
+//  outputExtent, as a band of bins. planX transforms the rows within the
+//  input extent, reading none of the zeros and writing only the columns
+//  within the output extent, and planY those columns, reading only the rows
+//  that planX wrote and taking the others as 0, and writing only the rows
+//  within the output extent. Rows of zeros and columns of unwanted bins are
+//  therefore never transformed. Real rows are the real parts of complex
+//  transforms, which keep the nonredundant coefficients. The stages are
+//  single kernels with callbacks, which need 1D or 2D plans of single-kernel
+//  lengths.
+hcfftStatus FFTPlan::hcfftBakePruned(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftBakePruned"));
+  size_t Large1DThreshold = 0;
+  fftPlan->GetMax1DLength(&Large1DThreshold);
+  bool c2c = (fftPlan->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+             (fftPlan->opLayout == HCFFT_COMPLEX_INTERLEAVED);
+  bool r2c = (fftPlan->ipLayout == HCFFT_REAL) &&
+             (fftPlan->opLayout == HCFFT_HERMITIAN_INTERLEAVED);
+  size_t dim = fftPlan->length.size();
+  std::vector<size_t> inExtent = fftPlan->inputExtent;
+  std::vector<size_t> outExtent = fftPlan->outputExtent;
+
+  if (inExtent.empty()) {
+    inExtent = fftPlan->length;
+  }
+
+  if (outExtent.empty()) {
+    outExtent = fftPlan->length;
+
+    if (r2c) {
+      outExtent[0] = fftPlan->length[0] / 2 + 1;
     }
+  }
 
-  FFTKernelGenKeyParams fftParams;
-  //  Translate the user plan into the structure that we use to map plans to
-  //  hcPrograms
-  fftPlan->GetKernelGenKey(fftParams);
-  std::string kernel;
-  fftRepo.getProgramCode(fftPlan->gen, plHandle, fftParams, kernel);
-  unsigned int uarg = 0;
-  uint batch = std::max<uint>(1, uint(fftPlan->batchSize));
+  if (!(c2c || r2c) || (dim != fftPlan->dimension) || (dim > HCFFT_2D) ||
+      (inExtent.size() != dim) || (outExtent.size() != dim) ||
+      (r2c && (outExtent[0] > fftPlan->length[0] / 2 + 1)) ||
+      !fftPlan->window.empty() || !fftPlan->loadCallback.empty() ||
+      !fftPlan->storeCallback.empty() || (fftPlan->gen != Stockham) ||
+      (fftPlan->transposeType != HCFFT_NOTRANSPOSE)) {
+    return HCFFT_INVALID;
+  }
 
-  //  Decode the relevant properties from the plan paramter to figure out how
-  //  many input/output buffers we have
-  switch (fftPlan->ipLayout) {
-    case HCFFT_COMPLEX_INTERLEAVED: {
-      switch (fftPlan->opLayout) {
-        case HCFFT_COMPLEX_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  for (size_t i = 0; i < dim; i++) {
+    if (!IsRadixLength(fftPlan->length[i]) ||
+        !Is1DPossible(fftPlan->length[i], Large1DThreshold)) {
+      return HCFFT_INVALID;
+    }
+  }
 
-          break;
-        }
+  fftPlan->tmpBufSize = 0;
+  std::string type =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string real;
 
-        case HCFFT_COMPLEX_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            //  Invalid to be an inplace transform, and go from 1 to 2 buffers
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  if (r2c) {
+    real = (fftPlan->precision == HCFFT_SINGLE) ? "float" : "double";
+  }
 
-          break;
-        }
+  size_t N0 = fftPlan->length[0];
+  size_t columns = outExtent[0];
 
-        case HCFFT_HERMITIAN_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  // Rows of planX, the rows of the input within the extent
+  size_t rows = fftPlan->batchSize;
+  std::vector<size_t> rowLength(1, N0);
 
-          break;
-        }
+  if (dim == HCFFT_2D) {
+    rowLength.push_back(inExtent[1]);
+    rows *= inExtent[1];
+  }
 
-        case HCFFT_HERMITIAN_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  std::string inRow =
+      ConvolutionRowOffset(rowLength, fftPlan->inStride, fftPlan->iDist);
+  std::string outRow =
+      ConvolutionRowOffset(rowLength, fftPlan->outStride, fftPlan->oDist);
+  FFTPlan* rowPlan = CreateConvolutionSubPlan(fftPlan, &fftPlan->planX, N0,
+                                              rows);
+  rowPlan->loadCallback.funcName = "hcfftPrunedLoad";
+  rowPlan->loadCallback.funcString = PrunedLoadSource(
+      type, real, N0, inExtent[0], inRow, fftPlan->inStride[0]);
+  rowPlan->storeCallback.funcName = "hcfftPrunedStore";
+  rowPlan->storeCallback.funcString =
+      PrunedStoreSource(type, N0, columns, outRow, fftPlan->outStride[0]);
+
+  if (dim == HCFFT_1D) {
+    rowPlan->forwardScale = fftPlan->forwardScale;
+    rowPlan->backwardScale = fftPlan->backwardScale;
+  }
 
-          break;
-        }
+  hcfftStatus status = hcfftBakePlanInternal(fftPlan->planX);
 
-        case HCFFT_REAL: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
 
-          break;
-        }
+  // Columns of planY within the output extent, in place in the output, the
+  // columns running first
+  if (dim == HCFFT_2D) {
+    size_t N1 = fftPlan->length[1];
+    std::vector<size_t> colLength(1, N1);
+    colLength.push_back(columns);
+    std::vector<size_t> colStride(1, fftPlan->outStride[1]);
+    colStride.push_back(fftPlan->outStride[0]);
+    std::string col =
+        ConvolutionRowOffset(colLength, colStride, fftPlan->oDist);
+    FFTPlan* colPlan = CreateConvolutionSubPlan(
+        fftPlan, &fftPlan->planY, N1, columns * fftPlan->batchSize);
+    colPlan->loadCallback.funcName = "hcfftPrunedLoad";
+    colPlan->loadCallback.funcString = PrunedLoadSource(
+        type, "", N1, inExtent[1], col, fftPlan->outStride[1]);
+    colPlan->storeCallback.funcName = "hcfftPrunedStore";
+    colPlan->storeCallback.funcString = PrunedStoreSource(
+        type, N1, outExtent[1], col, fftPlan->outStride[1]);
+    colPlan->forwardScale = fftPlan->forwardScale;
+    colPlan->backwardScale = fftPlan->backwardScale;
+    status = hcfftBakePlanInternal(fftPlan->planY);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
 
-        default: {
-          //  Don't recognize output layout
-          return HCFFT_ERROR;
-        }
-      }
+  fftPlan->pruned = true;
+  fftPlan->baked = true;
+  return HCFFT_SUCCEEDS;
+}
 
-      break;
+//  Sets the input or output extent of a pruned plan, each extent from 1 to
+//  the length of its dimension
+static hcfftStatus SetPlanExtent(FFTPlan* fftPlan, std::vector<size_t>& to,
+                                 size_t rank, const size_t* extent) {
+  if (extent != NULL) {
+    if (rank != fftPlan->length.size()) {
+      return HCFFT_INVALID;
     }
 
-    case HCFFT_COMPLEX_PLANAR: {
-      switch (fftPlan->opLayout) {
-        case HCFFT_COMPLEX_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+    for (size_t i = 0; i < rank; i++) {
+      if (extent[i] == 0 || extent[i] > fftPlan->length[i]) {
+        return HCFFT_INVALID;
+      }
+    }
+  }
 
-          break;
-        }
+  to.clear();
 
-        case HCFFT_COMPLEX_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  if (extent != NULL) {
+    to.assign(extent, extent + rank);
+  }
 
-          break;
-        }
+  fftPlan->baked = false;
+  return HCFFT_SUCCEEDS;
+}
 
-        case HCFFT_HERMITIAN_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+hcfftStatus FFTPlan::hcfftSetPlanInputExtent(hcfftPlanHandle plHandle,
+                                             size_t rank,
+                                             const size_t* extent) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-          break;
-        }
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-        case HCFFT_HERMITIAN_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanInputExtent"));
+  return SetPlanExtent(fftPlan, fftPlan->inputExtent, rank, extent);
+}
 
-          break;
-        }
+hcfftStatus FFTPlan::hcfftSetPlanOutputExtent(hcfftPlanHandle plHandle,
+                                              size_t rank,
+                                              const size_t* extent) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-        case HCFFT_REAL: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-          break;
-        }
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanOutputExtent"));
+  return SetPlanExtent(fftPlan, fftPlan->outputExtent, rank, extent);
+}
 
-        default: {
-          //  Don't recognize output layout
-          return HCFFT_ERROR;
-        }
-      }
+//  Load callback of the forward transform of a convolution stream: the real
+//  and imaginary parts of row r are the segments 2r and 2r + 1 of the input
+//  of a block, hop samples apart, and are 0 past its length
+static std::string StreamLoadSource(const std::string& type,
+                                    const std::string& real, size_t N,
+                                    size_t hop, size_t length) {
+  std::string str;
+  str += type + " hcfftStreamLoad(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "n");
+  str += "\t" + real + " *x = reinterpret_cast<" + real + " *>(buffer);\n";
+  str += "\tunsigned int i = 2 * r * " + SztToStr(hop) + " + n;\n";
+  str += "\t" + real + " a = (i < " + SztToStr(length) + ") ? x[i] : 0;\n";
+  str += "\t" + real + " b = (i + " + SztToStr(hop) + " < " +
+         SztToStr(length) + ") ? x[i + " + SztToStr(hop) + "] : 0;\n";
+  str += "\treturn " + type + "(a, b);\n}\n";
+  return str;
+}
 
-      break;
-    }
+//  Store callback of the inverse transform of a convolution stream: the
+//  last hop samples of the two segments of row r are those of the output of
+//  the block, the others being wrapped around by the circular convolution
+static std::string StreamStoreSource(const std::string& type,
+                                     const std::string& real, size_t N,
+                                     size_t taps, size_t hop, size_t block) {
+  std::string str;
+  str += "void hcfftStreamStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "n");
+
+  if (taps > 1) {
+    str += "\tif (n < " + SztToStr(taps - 1) + ") return;\n";
+  }
 
-    case HCFFT_HERMITIAN_INTERLEAVED: {
-      switch (fftPlan->opLayout) {
-        case HCFFT_COMPLEX_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  str += "\t" + real + " *y = reinterpret_cast<" + real + " *>(buffer);\n";
+  str += "\tunsigned int i = 2 * r * " + SztToStr(hop) + " + n - " +
+         SztToStr(taps - 1) + ";\n";
+  str += "\tif (i < " + SztToStr(block) + ") y[i] = element.x;\n";
+  str += "\tif (i + " + SztToStr(hop) + " < " + SztToStr(block) +
+         ") y[i + " + SztToStr(hop) + "] = element.y;\n}\n";
+  return str;
+}
 
-          break;
-        }
+//  Pairs of segments of a block of a convolution stream, and the buffers of
+//  the stream after the filter spectrum: the spectra of the pairs, then the
+//  two inputs and the two outputs of the blocks
+static size_t ConvolveStreamBuffers(const FFTPlan* fftPlan, char** work,
+                                    char** inputs, char** outputs) {
+  size_t N = fftPlan->length[0];
+  size_t hop = N - fftPlan->convTaps + 1;
+  size_t pairs =
+      DivRoundingUp<size_t>(DivRoundingUp<size_t>(fftPlan->convBlock, hop), 2);
+  size_t elem = fftPlan->ElementSize();
+  size_t input = (fftPlan->convBlock + fftPlan->convTaps - 1) * elem / 2;
+  size_t output = fftPlan->convBlock * elem / 2;
+  char* base = static_cast<char*>(fftPlan->convStream);
+
+  if (base != NULL && work != NULL) {
+    *work = base + N * elem;
+    inputs[0] = *work + pairs * N * elem;
+    inputs[1] = inputs[0] + input;
+    outputs[0] = inputs[1] + input;
+    outputs[1] = outputs[0] + output;
+  }
 
-        case HCFFT_COMPLEX_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  return pairs;
+}
 
-          break;
-        }
+//  Zeroes the samples before the next block of a convolution stream, the
+//  end of its first input
+static void ClearConvolveStream(FFTPlan* fftPlan) {
+  char* work = NULL;
+  char* inputs[2] = {NULL, NULL};
+  char* outputs[2] = {NULL, NULL};
+  ConvolveStreamBuffers(fftPlan, &work, inputs, outputs);
+  size_t real = fftPlan->ElementSize() / 2;
+  std::vector<char> zeros((fftPlan->convTaps - 1) * real, 0);
+
+  if (!zeros.empty()) {
+    fftPlan->acc_view.copy(&zeros[0], inputs[0] + fftPlan->convBlock * real,
+                           zeros.size());
+  }
 
-        case HCFFT_HERMITIAN_INTERLEAVED: {
-          return HCFFT_ERROR;
-        }
+  fftPlan->convCurrent = 0;
+}
 
-        case HCFFT_HERMITIAN_PLANAR: {
-          return HCFFT_ERROR;
-        }
+//  A stream convolves blocks of its samples with the filter by overlap-save.
+//  Segments of a power of 2 length N, hop = N - taps + 1 samples apart, run
+//  over the taps - 1 samples before a block and the block, and their
+//  circular convolutions with the filter keep their last hop samples. Two
+//  real segments are the real and imaginary parts of a complex one, whose
+//  product with the spectrum of the real filter transforms back to their two
+//  convolutions, so that a block takes a forward transform with the filter
+//  multiply and an inverse transform, batched over its pairs of segments.
+//  N is at least 4 taps, unless a single segment holds the block, and at
+//  most the largest single-kernel length, which the callbacks need.
+hcfftStatus FFTPlan::hcfftCreateConvolveStream(
+    hcfftPlanHandle* plHandle, hcfftPrecision precision, size_t block,
+    const std::vector<double>& taps) {
+  if (block == 0 || taps.empty()) {
+    return HCFFT_INVALID;
+  }
 
-        case HCFFT_REAL: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  size_t M = taps.size();
+  size_t N = (size_t)1 << CeilPo2(
+                 std::min(block + M - 1, std::max<size_t>(4 * M, 256)));
+  hcfftStatus status = hcfftCreateDefaultPlan(plHandle, HCFFT_1D, &N,
+                                              HCFFT_FORWARD, precision,
+                                              HCFFT_R2CD2Z);
 
-          break;
-        }
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
 
-        default: {
-          //  Don't recognize output layout
-          return HCFFT_ERROR;
-        }
-      }
+  status = hcfftSetPlanPrecision(*plHandle, precision);
 
-      break;
-    }
+  if (status == HCFFT_SUCCEEDS) {
+    status = hcfftBakeConvolveStream(*plHandle, block, taps);
+  }
 
-    case HCFFT_HERMITIAN_PLANAR: {
-      switch (fftPlan->opLayout) {
-        case HCFFT_COMPLEX_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  if (status != HCFFT_SUCCEEDS) {
+    hcfftDestroyPlan(plHandle);
+  }
 
-          break;
-        }
+  return status;
+}
 
-        case HCFFT_COMPLEX_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+hcfftStatus FFTPlan::hcfftBakeConvolveStream(hcfftPlanHandle plHandle,
+                                             size_t block,
+                                             const std::vector<double>& taps) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftBakeConvolveStream"));
+  size_t M = taps.size();
+  size_t Large1DThreshold = 0;
+  fftPlan->GetMax1DLength(&Large1DThreshold);
 
-          break;
-        }
+  if (fftPlan->length[0] > Large1DThreshold) {
+    fftPlan->length[0] = Large1DThreshold;
+    fftPlan->originalLength[0] = Large1DThreshold;
+    fftPlan->iDist = Large1DThreshold;
+    fftPlan->oDist = Large1DThreshold;
+  }
 
-        case HCFFT_HERMITIAN_INTERLEAVED: {
-          return HCFFT_ERROR;
-        }
+  size_t N = fftPlan->length[0];
 
-        case HCFFT_HERMITIAN_PLANAR: {
-          return HCFFT_ERROR;
-        }
+  if (N < M) {
+    return HCFFT_INVALID;
+  }
 
-        case HCFFT_REAL: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  fftPlan->convBlock = block;
+  fftPlan->convTaps = M;
+  size_t hop = N - M + 1;
+  size_t pairs = ConvolveStreamBuffers(fftPlan, NULL, NULL, NULL);
+  size_t elem = fftPlan->ElementSize();
+  size_t bytes = (1 + pairs) * N * elem + (2 * (block + M - 1) + 2 * block) *
+                                              elem / 2;
+  {
+    scopedTimer timer(fftPlan->timings.alloc);
+    fftPlan->convStream =
+        gaugedAlloc(bytes, fftPlan->acc, hcfftCounters.scratchBytes);
+  }
 
-          break;
-        }
+  if (fftPlan->convStream == NULL) {
+    return HCFFT_ERROR;
+  }
 
-        default: {
-          //  Don't recognize output layout
-          return HCFFT_ERROR;
-        }
-      }
+  // Spectrum of the filter, with the scale of the inverse transform
+  std::vector<std::complex<double> > spectrum(N);
 
-      break;
+  for (size_t m = 0; m < M; m++) {
+    spectrum[m] = taps[m] / N;
+  }
+
+  HostFFT(spectrum);
+  std::vector<char> host;
+  AppendComplex(host, spectrum, fftPlan->precision);
+  fftPlan->acc_view.copy(&host[0], fftPlan->convStream, host.size());
+  ClearConvolveStream(fftPlan);
+  std::string type =
+      (fftPlan->precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string real = (fftPlan->precision == HCFFT_SINGLE) ? "float" : "double";
+  hcfftPlanHandle* sub[2] = {&fftPlan->planConvFwd, &fftPlan->planConvBack};
+
+  for (int i = 0; i < 2; i++) {
+    FFTPlan* subPlan = CreateConvolutionSubPlan(fftPlan, sub[i], N, pairs);
+
+    if (i == 0) {
+      subPlan->loadCallback.funcName = "hcfftStreamLoad";
+      subPlan->loadCallback.funcString =
+          StreamLoadSource(type, real, N, hop, block + M - 1);
+      subPlan->storeCallback.funcName = "hcfftChirpFilter";
+      subPlan->storeCallback.funcString = BluesteinFilterSource(type, N);
+      subPlan->storeCallback.userdata = fftPlan->convStream;
+    } else {
+      subPlan->storeCallback.funcName = "hcfftStreamStore";
+      subPlan->storeCallback.funcString =
+          StreamStoreSource(type, real, N, M, hop, block);
     }
 
-    case HCFFT_REAL: {
-      switch (fftPlan->opLayout) {
-        case HCFFT_COMPLEX_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+    subPlan->acc_view = fftPlan->acc_view;
+    hcfftStatus status = hcfftBakePlanInternal(*sub[i]);
 
-          break;
-        }
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
 
-        case HCFFT_COMPLEX_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  return HCFFT_SUCCEEDS;
+}
 
-          break;
-        }
+//  Queues the input of a block of a convolution stream: the end of the input
+//  prev of the block before, then the block, to the other input
+static void uploadBlock(hc::accelerator_view& view, char** inputs,
+                        size_t prev, const char* block, size_t blockBytes,
+                        size_t keepBytes) {
+  char* dst = inputs[1 - prev];
 
-        case HCFFT_HERMITIAN_INTERLEAVED: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+  if (keepBytes > 0) {
+    view.copy_async(inputs[prev] + blockBytes, dst, keepBytes);
+  }
 
-          break;
-        }
+  view.copy_async(block, dst + keepBytes, blockBytes);
+}
 
-        case HCFFT_HERMITIAN_PLANAR: {
-          if (fftPlan->location == HCFFT_INPLACE) {
-            return HCFFT_ERROR;
-          } else {
-            vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-          }
+//  Convolves blocks consecutive blocks of the stream, from input to output
+//  in host memory. The blocks alternate between the two inputs and the two
+//  outputs of the stream, and the copy view is in order, so the upload of
+//  block k + 1 follows the download of block k - 1 and runs while block k is
+//  convolved.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueConvolveStream(hcfftPlanHandle plHandle,
+                                                const T* input, T* output,
+                                                size_t blocks) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-          break;
-        }
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-        default: {
-          if (fftPlan->transflag) {
-            if (fftPlan->location == HCFFT_INPLACE) {
-              return HCFFT_ERROR;
-            } else {
-              vectArr.insert(std::make_pair(uarg++, hcInputBuffers));
-              vectArr.insert(std::make_pair(uarg++, hcOutputBuffers));
-            }
-          } else {
-            //  Don't recognize output layout
-            return HCFFT_ERROR;
-          }
-        }
-      }
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueConvolveStream"));
 
-      break;
-    }
+  if (fftPlan->convStream == NULL) {
+    return HCFFT_INVALID;
+  }
 
-    default: {
-      //  Don't recognize output layout
-      return HCFFT_ERROR;
-    }
+  if (blocks == 0) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  if (fftPlan->streamCopyView.empty()) {
+    fftPlan->streamCopyView.push_back(fftPlan->acc.create_view());
   }
 
-  if (fftPlan->gen == Stockham || fftPlan->gen == Transpose_GCN ||
-      fftPlan->gen == Transpose_SQUARE || fftPlan->gen == Transpose_NONSQUARE) {
-    if (fftPlan->twiddles != NULL) {
-      vectArr.insert(std::make_pair(uarg++, fftPlan->twiddles));
+  hc::accelerator_view& copyView = fftPlan->streamCopyView[0];
+  char* work = NULL;
+  char* inputs[2] = {NULL, NULL};
+  char* outputs[2] = {NULL, NULL};
+  ConvolveStreamBuffers(fftPlan, &work, inputs, outputs);
+  size_t blockBytes = fftPlan->convBlock * sizeof(T);
+  size_t keepBytes = (fftPlan->convTaps - 1) * sizeof(T);
+  const char* in = reinterpret_cast<const char*>(input);
+  char* out = reinterpret_cast<char*>(output);
+  size_t prev = fftPlan->convCurrent;
+  hc::completion_future uploaded[2];
+  uploadBlock(copyView, inputs, prev, in, blockBytes, keepBytes);
+  uploaded[0] = copyView.create_marker();
+
+  for (size_t k = 0; k < blocks; k++) {
+    size_t current = 1 - prev;
+
+    if (k + 1 < blocks) {
+      uploadBlock(copyView, inputs, current, in + (k + 1) * blockBytes,
+                  blockBytes, keepBytes);
+      uploaded[(k + 1) % 2] = copyView.create_marker();
     }
 
-    if (fftPlan->twiddleslarge != NULL) {
-      vectArr.insert(std::make_pair(uarg++, fftPlan->twiddleslarge));
+    uploaded[k % 2].wait();
+    T* spectra = reinterpret_cast<T*>(work);
+    hcfftStatus status = hcfftEnqueueTransform<T>(
+        fftPlan->planConvFwd, HCFFT_FORWARD,
+        reinterpret_cast<T*>(inputs[current]), spectra, NULL);
+
+    if (status == HCFFT_SUCCEEDS) {
+      status = hcfftEnqueueTransform<T>(
+          fftPlan->planConvBack, HCFFT_BACKWARD, spectra,
+          reinterpret_cast<T*>(outputs[k % 2]), NULL);
+    }
+
+    if (status != HCFFT_SUCCEEDS) {
+      copyView.wait();
+      return status;
     }
+
+    fftPlan->acc_view.wait();
+    copyView.copy_async(outputs[k % 2], out + k * blockBytes, blockBytes);
+    fftPlan->convCurrent = current;
+    prev = current;
   }
 
-  if (fftPlan->transformed == false) {
-    typedef void(FUNC_FFTFwd)(std::map<int, void*> * vectArr, uint batchSize,
-                              hc::accelerator_view & acc_view,
-                              hc::accelerator & acc);
-    FUNC_FFTFwd* FFTcall = NULL;
+  copyView.wait();
+  fftPlan->transformed = true;
+  return HCFFT_SUCCEEDS;
+}
 
-    if (fftPlan->gen == Copy) {
-      bool h2c = ((fftPlan->ipLayout == HCFFT_HERMITIAN_PLANAR) ||
-                  (fftPlan->ipLayout == HCFFT_HERMITIAN_INTERLEAVED))
-                     ? true
-                     : false;
-      std::string funcName = "copy_";
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueConvolveStream(
+    hcfftPlanHandle plHandle, const float* input, float* output,
+    size_t blocks);
+template hcfftStatus FFTPlan::hcfftEnqueueConvolveStream(
+    hcfftPlanHandle plHandle, const double* input, double* output,
+    size_t blocks);
+
+hcfftStatus FFTPlan::hcfftResetConvolveStream(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftResetConvolveStream"));
+
+  if (fftPlan->convStream == NULL) {
+    return HCFFT_INVALID;
+  }
+
+  ClearConvolveStream(fftPlan);
+  return HCFFT_SUCCEEDS;
+}
+
+//  A plan of more than 3 dimensions runs as the 3D transform of the first
+//  three, batched over the others as lengths after its own, then as the 1D
+//  transforms along each further dimension, in place on the complex data and
+//  batched over all the other dimensions. planX is the 3D plan, and planY,
+//  planZ and planTX transform the 4th to the 6th dimension. The 1D
+//  transforms of a hermitian to real plan run first, on its input, and the
+//  scale of the plan goes to the last transform.
+hcfftStatus FFTPlan::hcfftBakeRankN(hcfftPlanHandle plHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftBakeRankN"));
+  bool c2c = (fftPlan->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+             (fftPlan->opLayout == HCFFT_COMPLEX_INTERLEAVED);
+  bool r2c = (fftPlan->ipLayout == HCFFT_REAL) &&
+             (fftPlan->opLayout == HCFFT_HERMITIAN_INTERLEAVED);
+  bool c2r = (fftPlan->ipLayout == HCFFT_HERMITIAN_INTERLEAVED) &&
+             (fftPlan->opLayout == HCFFT_REAL);
+  size_t Large1DThreshold = 0;
+  fftPlan->GetMax1DLength(&Large1DThreshold);
+
+  if (!(c2c || r2c || c2r) || (fftPlan->gen != Stockham) ||
+      (fftPlan->length.size() != fftPlan->dimension)) {
+    return HCFFT_INVALID;
+  }
 
-      if (h2c) {
-        funcName += "h2c";
-      } else {
-        funcName += "c2h";
-      }
+  for (size_t i = HCFFT_3D; i < fftPlan->dimension; i++) {
+    if (!Is1DPossible(fftPlan->length[i], Large1DThreshold)) {
+      return HCFFT_INVALID;
+    }
+  }
 
-      funcName += std::to_string(countKernel);
-      FFTcall = (FUNC_FFTFwd*)dlsym(kernelHandle, funcName.c_str());
+  hcfftCreateDefaultPlanInternal(&fftPlan->planX, HCFFT_3D,
+                                 &fftPlan->length[0]);
+  FFTPlan* volPlan = NULL;
+  lockRAII* volLock = NULL;
+  fftRepo.getPlan(fftPlan->planX, volPlan, volLock);
+  volPlan->location = fftPlan->location;
+  volPlan->ipLayout = fftPlan->ipLayout;
+  volPlan->opLayout = fftPlan->opLayout;
+  volPlan->precision = fftPlan->precision;
+  volPlan->forwardScale = c2r ? fftPlan->forwardScale : 1.0f;
+  volPlan->backwardScale = c2r ? fftPlan->backwardScale : 1.0f;
+  volPlan->tmpBufSize = 0;
+  volPlan->gen = fftPlan->gen;
+  volPlan->envelope = fftPlan->envelope;
+  volPlan->batchSize = fftPlan->batchSize;
+  volPlan->length = fftPlan->length;
+  volPlan->inStride = fftPlan->inStride;
+  volPlan->outStride = fftPlan->outStride;
+  volPlan->iDist = fftPlan->iDist;
+  volPlan->oDist = fftPlan->oDist;
+  volPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+  volPlan->originalLength = fftPlan->originalLength;
+  volPlan->acc = fftPlan->acc;
+  volPlan->exist = fftPlan->exist;
+  volPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+  hcfftStatus status = hcfftBakePlanInternal(fftPlan->planX);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
 
-      if (!FFTcall) {
-        std::cout << "Loading copy() fails " << std::endl;
-      }
+  // The complex data is the output, or the input of a hermitian to real plan
+  const std::vector<size_t>& stride =
+      c2r ? fftPlan->inStride : fftPlan->outStride;
+  size_t dist = c2r ? fftPlan->iDist : fftPlan->oDist;
+  std::vector<size_t> length = fftPlan->length;
 
-      char* err = dlerror();
+  if (!c2c) {
+    length[0] = length[0] / 2 + 1;
+  }
 
-      if (err) {
-        std::cout << "failed to locate copy(): " << err;
-        exit(1);
+  hcfftPlanHandle* axes[3] = {&fftPlan->planY, &fftPlan->planZ,
+                              &fftPlan->planTX};
+
+  for (size_t d = HCFFT_3D; d < fftPlan->dimension; d++) {
+    bool last = !c2r && (d + 1 == fftPlan->dimension);
+    hcfftPlanHandle* axis = axes[d - HCFFT_3D];
+    hcfftCreateDefaultPlanInternal(axis, HCFFT_1D, &length[d]);
+    FFTPlan* axisPlan = NULL;
+    lockRAII* axisLock = NULL;
+    fftRepo.getPlan(*axis, axisPlan, axisLock);
+    axisPlan->location = HCFFT_INPLACE;
+    axisPlan->ipLayout = HCFFT_COMPLEX_INTERLEAVED;
+    axisPlan->opLayout = HCFFT_COMPLEX_INTERLEAVED;
+    axisPlan->precision = fftPlan->precision;
+    axisPlan->forwardScale = last ? fftPlan->forwardScale : 1.0f;
+    axisPlan->backwardScale = last ? fftPlan->backwardScale : 1.0f;
+    axisPlan->tmpBufSize = 0;
+    axisPlan->gen = Stockham;
+    axisPlan->envelope = fftPlan->envelope;
+    axisPlan->batchSize = fftPlan->batchSize;
+    axisPlan->inStride[0] = stride[d];
+    axisPlan->outStride[0] = stride[d];
+
+    for (size_t i = 0; i < fftPlan->dimension; i++) {
+      if (i != d) {
+        axisPlan->length.push_back(length[i]);
+        axisPlan->inStride.push_back(stride[i]);
+        axisPlan->outStride.push_back(stride[i]);
       }
+    }
 
-      free(err);
-    } else if (fftPlan->gen == Stockham) {
-      if (dir == HCFFT_FORWARD) {
-        std::string funcName = "fft_fwd";
-        funcName += std::to_string(countKernel);
-        FFTcall = (FUNC_FFTFwd*)dlsym(kernelHandle, funcName.c_str());
-
-        if (!FFTcall) {
-          std::cout << "Loading fft_fwd fails " << std::endl;
-        }
+    axisPlan->iDist = dist;
+    axisPlan->oDist = dist;
+    axisPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+    axisPlan->originalLength = fftPlan->originalLength;
+    axisPlan->acc = fftPlan->acc;
+    axisPlan->exist = fftPlan->exist;
+    axisPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+    status = hcfftBakePlanInternal(*axis);
+
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
 
-        char* err = dlerror();
+  fftPlan->baked = true;
+  return HCFFT_SUCCEEDS;
+}
 
-        if (err) {
-          std::cout << "failed to locate fft_fwd(): " << err;
-          exit(1);
-        }
+//  Index in a row of length N of element m of the sequence that the
+//  real-to-real transforms take the transform of, x[0], x[2], ..., x[3], x[1]
+static std::string R2RPermutation(size_t N, const std::string& m) {
+  std::string n = SztToStr(N);
+  return "(2 * " + m + " < " + n + ") ? 2 * " + m + " : 2 * " + n + " - 2 * " +
+         m + " - 1";
+}
 
-        free(err);
-      } else if (dir == HCFFT_BACKWARD) {
-        std::string funcName = "fft_back";
-        funcName += std::to_string(countKernel);
-        FFTcall = (FUNC_FFTFwd*)dlsym(kernelHandle, funcName.c_str());
+//  Load callback of the complex transform of a real-to-real plan, reading
+//  the real rows, at dist apart with elements at stride, through the
+//  complex pointer of the kernel. The DCT-II and DST-II transform the
+//  permuted input, the sign of the odd elements flipped for the DST. The
+//  DCT-III and DST-III transform exp(i pi k / 2N) (x[k] - i x[N - k]), the
+//  input reversed for the DST.
+static std::string R2RLoadSource(hcfftRealKind kind, hcfftPrecision precision,
+                                 size_t N, size_t stride, size_t dist) {
+  std::string type = (precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string real = (precision == HCFFT_SINGLE) ? "float" : "double";
+  std::string s = SztToStr(stride);
+  std::string str;
+  str += type + " hcfftR2RLoad(" + type + " *buffer, unsigned int offset, ";
+  str += "void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "k");
+  str += "\t" + real + " *x = (" + real + " *)buffer + r * " + SztToStr(dist);
+  str += ";\n";
+
+  if ((kind == HCFFT_REDFT10) || (kind == HCFFT_RODFT10)) {
+    str += "\tunsigned int n = " + R2RPermutation(N, "k") + ";\n";
+    str += "\t" + real + " a = x[n * " + s + "];\n";
+
+    if (kind == HCFFT_RODFT10) {
+      str += "\tif (n & 1) a = -a;\n";
+    }
 
-        if (!FFTcall) {
-          std::cout << "Loading fft_back fails " << std::endl;
-        }
+    str += "\treturn " + type + "(a, 0);\n}\n";
+    return str;
+  }
 
-        char* err = dlerror();
+  if (kind == HCFFT_REDFT01) {
+    str += "\t" + real + " a = x[k * " + s + "];\n";
+    str += "\t" + real + " b = (k != 0) ? x[(" + SztToStr(N) + " - k) * " + s +
+           "] : 0;\n";
+  } else {
+    str += "\t" + real + " a = x[(" + SztToStr(N - 1) + " - k) * " + s +
+           "];\n";
+    str += "\t" + real + " b = (k != 0) ? x[(k - 1) * " + s + "] : 0;\n";
+  }
 
-        if (err) {
-          std::cout << "failed to locate fft_back(): " << err;
-          exit(1);
-        }
+  str += "\t" + type + " w = static_cast<" + type + " *>(callerInfo)[k];\n";
+  str += "\treturn " + type + "(a * w.x - b * w.y, -a * w.y - b * w.x);\n}\n";
+  return str;
+}
 
-        free(err);
-      }
-    } else if (fftPlan->gen == Transpose_GCN) {
-      std::string funcName;
+//  Store callback of the complex transform of a real-to-real plan. The
+//  DCT-II and DST-II write 2 Re(exp(-i pi k / 2N) X[k]), in reverse for the
+//  DST. The DCT-III and DST-III write the real parts back in the order of
+//  the permutation, the sign of the odd elements flipped for the DST.
+static std::string R2RStoreSource(hcfftRealKind kind, hcfftPrecision precision,
+                                  size_t N, size_t stride, size_t dist) {
+  std::string type = (precision == HCFFT_SINGLE) ? "float_2" : "double_2";
+  std::string real = (precision == HCFFT_SINGLE) ? "float" : "double";
+  std::string s = SztToStr(stride);
+  std::string str;
+  str += "void hcfftR2RStore(" + type + " *buffer, unsigned int offset, ";
+  str += type + " element, void *callerInfo) [[hc]]\n{\n";
+  str += ConvolutionRowIndex(N, "k");
+  str += "\t" + real + " *y = (" + real + " *)buffer + r * " + SztToStr(dist);
+  str += ";\n";
+
+  if ((kind == HCFFT_REDFT10) || (kind == HCFFT_RODFT10)) {
+    std::string i = (kind == HCFFT_REDFT10) ? "k" : SztToStr(N - 1) + " - k";
+    str += "\t" + type + " w = static_cast<" + type + " *>(callerInfo)[k];\n";
+    str += "\ty[(" + i + ") * " + s + "] = 2 * (w.x * element.x - w.y * ";
+    str += "element.y);\n}\n";
+    return str;
+  }
 
-      if (fftParams.fft_3StepTwiddle) {
-        funcName = "transpose_gcn_tw_fwd";
-      } else {
-        funcName = "transpose_gcn";
-      }
+  str += "\tunsigned int n = " + R2RPermutation(N, "k") + ";\n";
+  str += "\t" + real + " a = element.x;\n";
 
-      funcName += std::to_string(countKernel);
-      FFTcall = (FUNC_FFTFwd*)dlsym(kernelHandle, funcName.c_str());
+  if (kind == HCFFT_RODFT01) {
+    str += "\tif (n & 1) a = -a;\n";
+  }
 
-      if (!FFTcall) {
-        std::cout << "Loading transpose_gcn fails " << std::endl;
-      }
+  str += "\ty[n * " + s + "] = a;\n}\n";
+  return str;
+}
 
-      char* err = dlerror();
+//  Creates a complex user plan of the length and batch of the plan, whose
+//  callbacks make it a real-to-real transform of kind on the real layout of
+//  the plan input. The transforms are not scaled.
+hcfftStatus FFTPlan::hcfftCreateR2RPlan(hcfftPlanHandle plHandle,
+                                        hcfftRealKind kind,
+                                        hcfftPlanHandle* r2rHandle) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftCreateR2RPlan"));
+  bool fwd = (kind == HCFFT_REDFT10) || (kind == HCFFT_RODFT10);
+  size_t N = fftPlan->length[0];
+  hcfftStatus status =
+      hcfftCreateDefaultPlan(r2rHandle, HCFFT_1D, &N,
+                             fwd ? HCFFT_FORWARD : HCFFT_BACKWARD,
+                             fftPlan->precision, HCFFT_C2CZ2Z);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
 
-      if (err) {
-        std::cout << "failed to locate transpose_gcn(): " << err;
-        exit(1);
-      }
+  FFTPlan* r2rPlan = NULL;
+  lockRAII* r2rLock = NULL;
+  fftRepo.getPlan(*r2rHandle, r2rPlan, r2rLock);
+  scopedLock sR2RLock(*r2rLock, _T(" hcfftCreateR2RPlan"));
+  r2rPlan->precision = fftPlan->precision;
+  r2rPlan->transposeType = HCFFT_NOTRANSPOSE;
+  r2rPlan->location = HCFFT_OUTOFPLACE;
+  r2rPlan->ipLayout = HCFFT_COMPLEX_INTERLEAVED;
+  r2rPlan->opLayout = HCFFT_COMPLEX_INTERLEAVED;
+  r2rPlan->batchSize = fftPlan->batchSize;
+  r2rPlan->forwardScale = 1.0;
+  r2rPlan->backwardScale = 1.0;
+  r2rPlan->acc = fftPlan->acc;
+  r2rPlan->acc_view = fftPlan->acc_view;
+  r2rPlan->envelope = fftPlan->envelope;
+  r2rPlan->loadCallback.funcName = "hcfftR2RLoad";
+  r2rPlan->loadCallback.funcString =
+      R2RLoadSource(kind, fftPlan->precision, N, fftPlan->inStride[0],
+                    fftPlan->iDist);
+  r2rPlan->storeCallback.funcName = "hcfftR2RStore";
+  r2rPlan->storeCallback.funcString =
+      R2RStoreSource(kind, fftPlan->precision, N, fftPlan->inStride[0],
+                     fftPlan->iDist);
+  return HCFFT_SUCCEEDS;
+}
 
-      free(err);
-    } else if (fftPlan->gen == Transpose_SQUARE) {
-      std::string funcName;
+//  The permutation and twiddle steps of the real-to-real transforms run in
+//  the loads and stores of a single complex transform of the full length, so
+//  the input is read and the output written once.
+template <typename T>
+hcfftStatus FFTPlan::hcfftEnqueueR2R(hcfftPlanHandle plHandle,
+                                     hcfftRealKind kind, T* input,
+                                     T* output) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-      if (fftParams.fft_3StepTwiddle) {
-        funcName = "transpose_square_tw_fwd";
-      } else {
-        funcName = "transpose_square";
-      }
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
 
-      funcName += std::to_string(countKernel);
-      FFTcall = (FUNC_FFTFwd*)dlsym(kernelHandle, funcName.c_str());
+  scopedLock sLock(*planLock, _T(" hcfftEnqueueR2R"));
 
-      if (!FFTcall) {
-        std::cout << "Loading transpose_square fails " << std::endl;
-      }
+  if ((fftPlan->hcfftlibtype != HCFFT_R2CD2Z) ||
+      (fftPlan->dimension != HCFFT_1D) || (fftPlan->length.size() != 1)) {
+    return HCFFT_INVALID;
+  }
 
-      char* err = dlerror();
+  hcfftStatus status = HCFFT_SUCCEEDS;
+  hcfftPlanHandle& r2rHandle = fftPlan->planR2R[kind];
 
-      if (err) {
-        std::cout << "failed to locate transpose_square(): " << err;
-        exit(1);
-      }
+  if (r2rHandle == 0) {
+    status = hcfftCreateR2RPlan(plHandle, kind, &r2rHandle);
 
-      free(err);
-    } else if (fftPlan->gen == Transpose_NONSQUARE) {
-      std::string funcName = "transpose_nonsquare";
+    if (status != HCFFT_SUCCEEDS) {
+      return status;
+    }
+  }
 
-      if (fftParams.nonSquareKernelType ==
-          NON_SQUARE_TRANS_TRANSPOSE_BATCHED_LEADING) {
-        if (fftParams.fft_3StepTwiddle) {
-          funcName = "transpose_nonsquare_tw_fwd";
-        } else {
-          funcName = "transpose_nonsquare";
-        }
-      } else if (fftParams.nonSquareKernelType ==
-                 NON_SQUARE_TRANS_TRANSPOSE_BATCHED) {
-        funcName = "transpose_square";
-      }
+  if (fftPlan->r2rTwiddles == NULL) {
+    size_t N = fftPlan->length[0];
+    std::vector<std::complex<double> > table(N);
 
-      funcName += std::to_string(countKernel);
-      FFTcall = (FUNC_FFTFwd*)dlsym(kernelHandle, funcName.c_str());
+    for (size_t k = 0; k < N; k++) {
+      table[k] = std::polar(1.0, -M_PI * k / (2.0 * N));
+    }
 
-      if (!FFTcall) {
-        std::cout << "Loading transpose_nonsquare fails " << std::endl;
-      }
+    std::vector<char> host;
+    AppendComplex(host, table, fftPlan->precision);
+    scopedTimer timer(fftPlan->timings.alloc);
+    fftPlan->r2rTwiddles =
+        gaugedAlloc(host.size(), fftPlan->acc, hcfftCounters.twiddleBytes);
 
-      char* err = dlerror();
+    if (fftPlan->r2rTwiddles == NULL) {
+      return HCFFT_ERROR;
+    }
 
-      if (err) {
-        std::cout << "failed to locate transpose_nonsquare(): " << err;
-        exit(1);
-      }
+    fftPlan->acc_view.copy(&host[0], fftPlan->r2rTwiddles, host.size());
+  }
 
-      free(err);
-    }
+  hcfftSetAcclView(r2rHandle, fftPlan->acc_view);
+  status = hcfftSetPlanCallbackData(r2rHandle, HCFFT_CALLBACK_LOAD,
+                                    fftPlan->r2rTwiddles);
 
-    fftPlan->kernelPtr = FFTcall;
-    fftPlan->transformed = true;
+  if (status == HCFFT_SUCCEEDS) {
+    status = hcfftSetPlanCallbackData(r2rHandle, HCFFT_CALLBACK_STORE,
+                                      fftPlan->r2rTwiddles);
   }
 
-  std::vector<size_t> gWorkSize;
-  std::vector<size_t> lWorkSize;
-  hcfftStatus result = fftPlan->GetWorkSizes(gWorkSize, lWorkSize);
+  if (status == HCFFT_SUCCEEDS) {
+    status = hcfftBakePlan(r2rHandle);
+  }
 
-  if (HCFFT_ERROR == result) {
-    std::cout << "Work size too large for EnqueueTransform" << std::endl;
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
   }
 
-  BUG_CHECK(gWorkSize.size() == lWorkSize.size());
-  fftPlan->kernelPtr(&vectArr, batch, fftPlan->acc_view, fftPlan->acc);
-  countKernel++;
+  bool fwd = (kind == HCFFT_REDFT10) || (kind == HCFFT_RODFT10);
+  status = hcfftEnqueueTransform<T>(r2rHandle,
+                                    fwd ? HCFFT_FORWARD : HCFFT_BACKWARD,
+                                    input, output, NULL);
+  fftPlan->transformed = true;
   return status;
 }
-// Template Initialization supporting just float and double types
-template hcfftStatus FFTPlan::hcfftEnqueueTransformInternal<float>(
-    hcfftPlanHandle plHandle, hcfftDirection dir, float* hcInputBuffers,
-    float* hcOutputBuffers, float* hcTmpBuffers);
-template hcfftStatus FFTPlan::hcfftEnqueueTransformInternal<double>(
-    hcfftPlanHandle plHandle, hcfftDirection dir, double* hcInputBuffers,
-    double* hcOutputBuffers, double* hcTmpBuffers);
 
-hcfftStatus FFTPlan::hcfftBakePlan(hcfftPlanHandle plHandle) {
-  bakedPlanCount = 0;
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T("hcfftBakePlan"));
+// Template Initialization
+template hcfftStatus FFTPlan::hcfftEnqueueR2R(hcfftPlanHandle plHandle,
+                                              hcfftRealKind kind,
+                                              float* input, float* output);
+template hcfftStatus FFTPlan::hcfftEnqueueR2R(hcfftPlanHandle plHandle,
+                                              hcfftRealKind kind,
+                                              double* input, double* output);
+
+//  Whether the Z FFT of a 3D plan can run in place on the packed planes of
+//  its output, of rows elements per row, as blocks of adjacent columns that
+//  the blocked kernels load along rows into LDS. That takes neither the two
+//  transposes around the Z FFT nor the strided loads of a plain column FFT.
+static bool IsBlockSlab(const FFTPlan* fftPlan, size_t rows) {
+  size_t length2 = fftPlan->length[2];
+  size_t plane = rows * fftPlan->length[1];
+  return (fftPlan->length.size() == 3) && IsPo2(length2) && (length2 >= 32) &&
+         (length2 <= 512) && (plane % 32 == 0) &&
+         (fftPlan->outStride[0] == 1) && (fftPlan->outStride[1] == rows) &&
+         (fftPlan->outStride[2] == plane) &&
+         (fftPlan->transposeType == HCFFT_NOTRANSPOSE) &&
+         fftPlan->loadCallback.empty() && fftPlan->storeCallback.empty();
+}
 
-  if (fftPlan->baked == true) {
-    return HCFFT_SUCCEEDS;
+//  Lay the Z FFT of a 3D plan out as the columns of planes of plane
+//  elements, a block of adjacent columns at a time
+static void SetBlockSlab(FFTPlan* colPlan, size_t plane) {
+  colPlan->length.resize(1);
+  colPlan->length.push_back(plane);
+  colPlan->inStride.assign(1, plane);
+  colPlan->inStride.push_back(1);
+  colPlan->outStride = colPlan->inStride;
+  colPlan->blockCompute = true;
+  colPlan->blockComputeType = BCT_C2C;
+}
+
+//  Even length real plan whose real values, two at a time, are the packed
+//  complex ones of a transform of half the length, see FFTPlan::RCsplit
+static bool IsRCsplit(const FFTPlan* fftPlan) {
+  bool forward = (fftPlan->ipLayout == HCFFT_REAL);
+  const std::vector<size_t>& stride =
+      forward ? fftPlan->inStride : fftPlan->outStride;
+  size_t dist = forward ? fftPlan->iDist : fftPlan->oDist;
+  bool interleaved = forward
+                         ? (fftPlan->opLayout == HCFFT_HERMITIAN_INTERLEAVED)
+                         : (fftPlan->ipLayout == HCFFT_HERMITIAN_INTERLEAVED);
+
+  if (!interleaved || (fftPlan->length[0] % 2 != 0) || (stride[0] != 1) ||
+      (dist % 2 != 0)) {
+    return false;
   }
 
-  fftPlan->exist =
-      checkIfsoExist(fftPlan->direction, fftPlan->precision,
-                     fftPlan->originalLength, fftPlan->hcfftlibtype);
-  hcfftStatus status = hcfftBakePlanInternal(plHandle);
-  fftPlan->filename = sfilename;
-  fftPlan->kernellib = skernellib;
-  return status;
+  for (size_t index = 1; index < stride.size(); index++) {
+    if (stride[index] % 2 != 0) {
+      return false;
+    }
+  }
+
+  return fftPlan->loadCallback.empty() && fftPlan->storeCallback.empty();
 }
 
 hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
@@ -1800,10 +8207,19 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
     return HCFFT_SUCCEEDS;
   }
 
+  fftPlan->timings = FFTPlanTimings();
+
   // find product of lengths
   size_t maxLengthInAnyDim = 1;
 
   switch (fftPlan->dimension) {
+    case HCFFT_6D:
+    case HCFFT_5D:
+    case HCFFT_4D:
+      for (size_t d = HCFFT_3D; d < fftPlan->dimension; d++) {
+        maxLengthInAnyDim = std::max(maxLengthInAnyDim, fftPlan->length[d]);
+      }
+
     case HCFFT_3D:
       maxLengthInAnyDim = maxLengthInAnyDim > fftPlan->length[2]
                               ? maxLengthInAnyDim
@@ -1836,9 +8252,21 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
     return HCFFT_INVALID;
   }
 
+  // Transforms of the previous bake may still be queued
+  if (fftPlan->twiddles || fftPlan->twiddleslarge || fftPlan->intBuffer ||
+      fftPlan->intBufferRC || fftPlan->intBufferC2R || fftPlan->chirps) {
+    fftPlan->acc_view.wait();
+  }
+
+  // The launches use the buffers and kernels of the previous bake, whose
+  // size the pool may not have
+  fftPlan->launchesFwd.clear();
+  fftPlan->launchesBack.clear();
+  fftPlan->scratchGeneration = 0;
+
   // release buffers, as these will be created only in EnqueueTransform
   if (NULL != fftPlan->twiddles) {
-    if (hc::am_free(fftPlan->twiddles) != AM_SUCCESS) {
+    if (fftRepo.releaseTwiddles(fftPlan->twiddles) != HCFFT_SUCCEEDS) {
       return HCFFT_INVALID;
     }
 
@@ -1846,7 +8274,7 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
   }
 
   if (NULL != fftPlan->twiddleslarge) {
-    if (hc::am_free(fftPlan->twiddleslarge) != AM_SUCCESS) {
+    if (fftRepo.releaseTwiddles(fftPlan->twiddleslarge) != HCFFT_SUCCEEDS) {
       return HCFFT_INVALID;
     }
 
@@ -1854,7 +8282,9 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
   }
 
   if (NULL != fftPlan->intBuffer) {
-    if (hc::am_free(fftPlan->intBuffer) != AM_SUCCESS) {
+    if (!fftPlan->InWorkArea(fftPlan->intBuffer) &&
+        gaugedFree(fftPlan->intBuffer, hcfftCounters.scratchBytes) !=
+            AM_SUCCESS) {
       return HCFFT_INVALID;
     }
 
@@ -1862,7 +8292,9 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
   }
 
   if (NULL != fftPlan->intBufferRC) {
-    if (hc::am_free(fftPlan->intBufferRC) != AM_SUCCESS) {
+    if (!fftPlan->InWorkArea(fftPlan->intBufferRC) &&
+        gaugedFree(fftPlan->intBufferRC, hcfftCounters.scratchBytes) !=
+            AM_SUCCESS) {
       return HCFFT_INVALID;
     }
 
@@ -1870,13 +8302,29 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
   }
 
   if (NULL != fftPlan->intBufferC2R) {
-    if (hc::am_free(fftPlan->intBufferC2R) != AM_SUCCESS) {
+    if (!fftPlan->InWorkArea(fftPlan->intBufferC2R) &&
+        gaugedFree(fftPlan->intBufferC2R, hcfftCounters.scratchBytes) !=
+            AM_SUCCESS) {
       return HCFFT_INVALID;
     }
 
     fftPlan->intBufferC2R = NULL;
   }
 
+  if (NULL != fftPlan->chirps) {
+    if (gaugedFree(fftPlan->chirps, hcfftCounters.twiddleBytes) !=
+        AM_SUCCESS) {
+      return HCFFT_INVALID;
+    }
+
+    fftPlan->chirps = NULL;
+  }
+
+  fftPlan->bluestein = false;
+  fftPlan->rader = false;
+  fftPlan->stft = false;
+  fftPlan->pruned = false;
+
   if (fftPlan->userPlan) {  // confirm it is top-level plan (user plan)
     if (fftPlan->location == HCFFT_INPLACE) {
       if ((fftPlan->ipLayout == HCFFT_HERMITIAN_PLANAR) ||
@@ -1903,12 +8351,32 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
     }
   }
 
+  // Sub-plans follow the memory and twiddle modes of the user plan, and are
+  // estimated along with it
+  if (fftPlan->plHandleOrigin != plHandle) {
+    FFTPlan* originPlan = NULL;
+    lockRAII* originLock = NULL;
+
+    if (fftRepo.getPlan(fftPlan->plHandleOrigin, originPlan, originLock) ==
+        HCFFT_SUCCEEDS) {
+      fftPlan->lowMemory = originPlan->lowMemory;
+      fftPlan->singleTwiddles = originPlan->singleTwiddles;
+      fftPlan->computeTwiddles = originPlan->computeTwiddles;
+      fftPlan->estimateOnly = originPlan->estimateOnly;
+    }
+  }
+
+  fftPlan->twiddleBytes = 0;
+
+  // Leaves look the tuning of their kernel up again, see BakeKernel
+  fftPlan->tuneWorkGroupSize = 0;
+  fftPlan->tuneNumTrans = 0;
+  fftPlan->bLdsComplex = false;
+
+  fftPlan->allOpsInplace = false;
+
   if (fftPlan->gen == Copy) {
-    fftPlan->GenerateKernel(plHandle, fftRepo, bakedPlanCount, fftPlan->exist);
-    bakedPlanCount++;
-    CompileKernels(plHandle, fftPlan->gen, fftPlan, fftPlan->plHandleOrigin,
-                   fftPlan->exist, fftPlan->originalLength,
-                   fftPlan->hcfftlibtype);
+    BakeKernel(plHandle, fftPlan);
     fftPlan->baked = true;
     return HCFFT_SUCCEEDS;
   }
@@ -1921,6 +8389,12 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
 
     // switch case flows with no 'break' statements
     switch (fftPlan->dimension) {
+      //  Rank N plans keep their unit lengths
+      case HCFFT_4D:
+      case HCFFT_5D:
+      case HCFFT_6D:
+        break;
+
       case HCFFT_3D:
         if (fftPlan->length[2] == 1) {
           dmnsn -= 1;
@@ -1977,9 +8451,76 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
   fftPlan->GetMax1DLength(&Large1DThreshold);
   BUG_CHECK(Large1DThreshold > 1);
 
+  //  The callbacks of half storage convert from and to single precision
+  if (fftPlan->halfStorage && (fftPlan->precision != HCFFT_SINGLE)) {
+    return HCFFT_INVALID;
+  }
+
+  //  Callbacks are inlined into Stockham kernels on complex interleaved data,
+  //  so the plan has to be a single 1D kernel or the row and column kernels
+  //  of a 2D plan. The kernel writing the output of a 2D real to hermitian
+  //  plan also takes a store callback.
+  if (!fftPlan->loadCallback.empty() || !fftPlan->storeCallback.empty()) {
+    bool c2c = !rc && (fftPlan->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+               (fftPlan->opLayout == HCFFT_COMPLEX_INTERLEAVED);
+    bool r2c = (fftPlan->dimension == HCFFT_2D) &&
+               (fftPlan->ipLayout == HCFFT_REAL) &&
+               (fftPlan->opLayout == HCFFT_HERMITIAN_INTERLEAVED) &&
+               fftPlan->loadCallback.empty();
+
+    if (!(c2c || r2c) || (fftPlan->gen != Stockham) ||
+        (fftPlan->transposeType != HCFFT_NOTRANSPOSE) ||
+        (fftPlan->dimension >= HCFFT_3D) ||
+        (fftPlan->length.size() != fftPlan->dimension)) {
+      return HCFFT_INVALID;
+    }
+
+    for (size_t i = 0; c2c && i < fftPlan->length.size(); i++) {
+      if (!Is1DPossible(fftPlan->length[i], Large1DThreshold)) {
+        return HCFFT_INVALID;
+      }
+    }
+  }
+
+  if (fftPlan->dimension > HCFFT_3D) {
+    return hcfftBakeRankN(plHandle);
+  }
+
+  if (!fftPlan->window.empty()) {
+    return hcfftBakeStft(plHandle);
+  }
+
+  if (!fftPlan->inputExtent.empty() || !fftPlan->outputExtent.empty()) {
+    return hcfftBakePruned(plHandle);
+  }
+
+  //  Lengths with a prime factor no kernel has a radix for are transformed
+  //  with Bluestein's algorithm in 1D, or with Rader's when the length is a
+  //  prime p and the transforms of p - 1 cost less than those of Bluestein
+  for (size_t i = 0; fftPlan->gen == Stockham && i < fftPlan->dimension; i++) {
+    if (!IsRadixLength(fftPlan->length[i])) {
+      if (fftPlan->dimension != HCFFT_1D) {
+        return HCFFT_INVALID;
+      }
+
+      size_t N = fftPlan->length[0];
+      size_t M = (size_t)1 << CeilPo2(2 * N - 1);
+
+      if (IsPrime(N) && IsRadixLength(N - 1) &&
+          Is1DPossible(N - 1, Large1DThreshold) &&
+          (KernelCost(N - 1) < KernelCost(M))) {
+        return hcfftBakeRader(plHandle);
+      }
+
+      return hcfftBakeBluestein(plHandle);
+    }
+  }
+
   //  Verify that the data passed to us is packed
   switch (fftPlan->dimension) {
     case HCFFT_1D: {
+      fftPlan->RCsplit = false;
+
       if (!Is1DPossible(fftPlan->length[0], Large1DThreshold)) {
         size_t hcLengths[] = {1, 1, 0};
         size_t in_1d, in_x, count;
@@ -2248,6 +8789,20 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
             }
           }
 
+          // In the low-memory mode packed in-place data is transposed in
+          // place, so that no step needs the tmp buffer
+          if (fftPlan->lowMemory && fftPlan->location == HCFFT_INPLACE &&
+              fftPlan->ipLayout == fftPlan->opLayout &&
+              inStrideEqualsOutStride && isDataPacked &&
+              (IsTransposableInplace(smallerDim, biggerDim) ||
+               IsShuffleTransposable(fftPlan, smallerDim, biggerDim, 1,
+                                     smallerDim))) {
+            padding = 0;
+            fftPlan->allOpsInplace = true;
+            transGen = (smallerDim == biggerDim) ? Transpose_SQUARE
+                                                 : Transpose_NONSQUARE;
+          }
+
           if ((fftPlan->tmpBufSize == 0) && !fftPlan->allOpsInplace) {
             fftPlan->tmpBufSize = (smallerDim + padding) * biggerDim *
                                   fftPlan->batchSize * fftPlan->ElementSize();
@@ -2755,6 +9310,87 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
           fftPlan->transflag = true;
           fftPlan->baked = true;
           return HCFFT_SUCCEEDS;
+        } else if (IsRCsplit(fftPlan)) {
+          // The real values of the batch, two at a time, are the complex
+          // ones of an FFT of half the length; the tmp buffer holds its
+          // packed interleaved output in forward and input in backward
+          bool forward = (fftPlan->ipLayout == HCFFT_REAL);
+          size_t half = fftPlan->length[0] / 2;
+          std::vector<size_t> realStride(1, 1);
+          std::vector<size_t> packedStride(1, 1);
+          size_t realDist = (forward ? fftPlan->iDist : fftPlan->oDist) / 2;
+          size_t packedDist = half;
+          fftPlan->RCsplit = true;
+          hcfftCreateDefaultPlanInternal(&fftPlan->planX, HCFFT_1D, &half);
+          FFTPlan* halfPlan = NULL;
+          lockRAII* halfLock = NULL;
+          fftRepo.getPlan(fftPlan->planX, halfPlan, halfLock);
+
+          for (size_t index = 1; index < fftPlan->length.size(); index++) {
+            halfPlan->length.push_back(fftPlan->length[index]);
+            realStride.push_back((forward ? fftPlan->inStride[index]
+                                          : fftPlan->outStride[index]) /
+                                 2);
+            packedStride.push_back(packedDist);
+            packedDist *= fftPlan->length[index];
+          }
+
+          if (fftPlan->tmpBufSizeRC == 0) {
+            fftPlan->tmpBufSizeRC =
+                packedDist * fftPlan->batchSize * fftPlan->ElementSize();
+          }
+
+          halfPlan->location = HCFFT_OUTOFPLACE;
+          halfPlan->ipLayout = HCFFT_COMPLEX_INTERLEAVED;
+          halfPlan->opLayout = HCFFT_COMPLEX_INTERLEAVED;
+          halfPlan->precision = fftPlan->precision;
+          halfPlan->forwardScale = fftPlan->forwardScale;
+          halfPlan->backwardScale = fftPlan->backwardScale;
+          halfPlan->tmpBufSize = 0;
+          halfPlan->batchSize = fftPlan->batchSize;
+          halfPlan->gen = fftPlan->gen;
+          halfPlan->envelope = fftPlan->envelope;
+          halfPlan->inStride = forward ? realStride : packedStride;
+          halfPlan->outStride = forward ? packedStride : realStride;
+          halfPlan->iDist = forward ? realDist : packedDist;
+          halfPlan->oDist = forward ? packedDist : realDist;
+          halfPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+          halfPlan->originalLength = fftPlan->originalLength;
+          halfPlan->acc = fftPlan->acc;
+          halfPlan->exist = fftPlan->exist;
+          halfPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+          hcfftBakePlanInternal(fftPlan->planX);
+          // split of the packed output into the hermitian values, or packing
+          // of the hermitian input
+          hcfftCreateDefaultPlanInternal(&fftPlan->planRCcopy, HCFFT_1D,
+                                         &fftPlan->length[0]);
+          FFTPlan* copyPlan = NULL;
+          lockRAII* copyLock = NULL;
+          fftRepo.getPlan(fftPlan->planRCcopy, copyPlan, copyLock);
+          copyPlan->location = HCFFT_OUTOFPLACE;
+          copyPlan->ipLayout =
+              forward ? HCFFT_COMPLEX_INTERLEAVED : fftPlan->ipLayout;
+          copyPlan->opLayout =
+              forward ? fftPlan->opLayout : HCFFT_COMPLEX_INTERLEAVED;
+          copyPlan->precision = fftPlan->precision;
+          copyPlan->forwardScale = 1.0f;
+          copyPlan->backwardScale = 1.0f;
+          copyPlan->tmpBufSize = 0;
+          copyPlan->batchSize = fftPlan->batchSize;
+          copyPlan->gen = Copy;
+          copyPlan->RCsplit = true;
+          copyPlan->envelope = fftPlan->envelope;
+          copyPlan->length = fftPlan->length;
+          copyPlan->inStride = forward ? packedStride : fftPlan->inStride;
+          copyPlan->outStride = forward ? fftPlan->outStride : packedStride;
+          copyPlan->iDist = forward ? packedDist : fftPlan->iDist;
+          copyPlan->oDist = forward ? fftPlan->oDist : packedDist;
+          copyPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+          copyPlan->originalLength = fftPlan->originalLength;
+          copyPlan->acc = fftPlan->acc;
+          copyPlan->exist = fftPlan->exist;
+          copyPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+          hcfftBakePlanInternal(fftPlan->planRCcopy);
         } else if (fftPlan->ipLayout == HCFFT_REAL) {
           if (fftPlan->tmpBufSizeRC == 0) {
             fftPlan->tmpBufSizeRC =
@@ -3433,28 +10069,46 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
     case HCFFT_2D: {
       if (fftPlan->transflag) {  // Transpose for 2D
         if (fftPlan->gen == Transpose_GCN) {
-          fftPlan->GenerateKernel(plHandle, fftRepo, bakedPlanCount,
-                                  fftPlan->exist);
-          CompileKernels(plHandle, fftPlan->gen, fftPlan,
-                         fftPlan->plHandleOrigin, fftPlan->exist,
-                         fftPlan->originalLength, fftPlan->hcfftlibtype);
+          BakeKernel(plHandle, fftPlan);
         } else if (fftPlan->gen == Transpose_SQUARE) {
-          fftPlan->GenerateKernel(plHandle, fftRepo, bakedPlanCount,
-                                  fftPlan->exist);
-          CompileKernels(plHandle, fftPlan->gen, fftPlan,
-                         fftPlan->plHandleOrigin, fftPlan->exist,
-                         fftPlan->originalLength, fftPlan->hcfftlibtype);
+          BakeKernel(plHandle, fftPlan);
         } else if (fftPlan->gen == Transpose_NONSQUARE) {
           if (fftPlan->nonSquareKernelType != NON_SQUARE_TRANS_PARENT) {
-            fftPlan->GenerateKernel(plHandle, fftRepo, bakedPlanCount,
-                                    fftPlan->exist);
-            CompileKernels(plHandle, fftPlan->gen, fftPlan,
-                           fftPlan->plHandleOrigin, fftPlan->exist,
-                           fftPlan->originalLength, fftPlan->hcfftlibtype);
+            BakeKernel(plHandle, fftPlan);
           } else {
             size_t hcLengths[] = {1, 1, 0};
             hcLengths[0] = fftPlan->length[0];
             hcLengths[1] = fftPlan->length[1];
+            size_t smallerDim = std::min(hcLengths[0], hcLengths[1]);
+            size_t biggerDim = std::max(hcLengths[0], hcLengths[1]);
+
+            // Ratios the swap kernels do not take are shuffled through LDS
+            // instead, a rotation of the columns when the lengths share a
+            // factor, then a shuffle of the rows and one of the columns
+            if (!IsTransposableInplace(smallerDim, biggerDim)) {
+              hcfftPlanHandle* step = &fftPlan->planTX;
+              size_t c = smallerDim, r = biggerDim % smallerDim;
+
+              while (r != 0) {
+                size_t t = c % r;
+                c = r;
+                r = t;
+              }
+
+              if (c > 1) {
+                BakeShuffleTransposeStep(fftPlan, step,
+                                         NON_SQUARE_TRANS_COLUMN_ROTATE);
+                step = &fftPlan->planTY;
+              }
+
+              BakeShuffleTransposeStep(fftPlan, step,
+                                       NON_SQUARE_TRANS_ROW_SHUFFLE);
+              BakeShuffleTransposeStep(
+                  fftPlan, (c > 1) ? &fftPlan->planTZ : &fftPlan->planTY,
+                  NON_SQUARE_TRANS_COLUMN_SHUFFLE);
+              fftPlan->baked = true;
+              return HCFFT_SUCCEEDS;
+            }
 
             // NON_SQUARE_KERNEL_ORDER currKernelOrder;
             // controling the transpose and swap kernel order
@@ -3619,15 +10273,20 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
             hcfftBakePlanInternal(fftPlan->planTY);
           }
         } else {
-          fftPlan->GenerateKernel(plHandle, fftRepo, bakedPlanCount,
-                                  fftPlan->exist);
-          CompileKernels(plHandle, fftPlan->gen, fftPlan,
-                         fftPlan->plHandleOrigin, fftPlan->exist,
-                         fftPlan->originalLength, fftPlan->hcfftlibtype);
+          BakeKernel(plHandle, fftPlan);
         }
 
         fftPlan->baked = true;
-        bakedPlanCount++;
+        return HCFFT_SUCCEEDS;
+      }
+
+      // Images that fit in LDS take a single kernel for both axes, which
+      // reads and writes the data once, instead of a kernel per axis
+      fftPlan->lds2D = fftPlan->Lds2DSizes(NULL, NULL);
+
+      if (fftPlan->lds2D) {
+        BakeKernel(plHandle, fftPlan);
+        fftPlan->baked = true;
         return HCFFT_SUCCEEDS;
       }
 
@@ -3639,22 +10298,30 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         fftPlan->large2D = true;
       }
 
+      fftPlan->blockColumn = false;
+
       while (1 && (fftPlan->ipLayout != HCFFT_REAL) &&
-             (fftPlan->opLayout != HCFFT_REAL)) {
+             (fftPlan->opLayout != HCFFT_REAL) &&
+             fftPlan->loadCallback.empty() && fftPlan->storeCallback.empty()) {
         // break;
         if (fftPlan->length.size() != 2) {
           break;
         }
 
-        if (!(IsPo2(fftPlan->length[0])) || !(IsPo2(fftPlan->length[1]))) {
+        // A transposed result is what the transposes leave, so plans asking
+        // for one take them at any length
+        bool transposed = (fftPlan->transposeType == HCFFT_TRANSPOSED);
+
+        if (!transposed &&
+            (!(IsPo2(fftPlan->length[0])) || !(IsPo2(fftPlan->length[1])))) {
           break;
         }
 
-        if (fftPlan->length[1] < 32) {
+        if (!transposed && fftPlan->length[1] < 32) {
           break;
         }
 
-        if (fftPlan->length[0] < 64) {
+        if (!transposed && fftPlan->length[0] < 64) {
           break;
         }
 
@@ -3673,7 +10340,20 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         //  break;
         // if (fftPlan->batchSize != 1) break;
         // if (fftPlan->precision != HCFFT_SINGLE) break;
-        fftPlan->transflag = true;
+        // Columns that fit in LDS are transformed in place, a block of
+        // adjacent columns at a time, so that every access is along rows.
+        // That takes two passes over the data instead of four, with no tmp
+        // buffer.
+        fftPlan->blockColumn =
+            (fftPlan->length[1] <= 256) &&
+            (fftPlan->transposeType == HCFFT_NOTRANSPOSE) &&
+            (fftPlan->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+            (fftPlan->opLayout == HCFFT_COMPLEX_INTERLEAVED);
+
+        if (!fftPlan->blockColumn) {
+          fftPlan->transflag = true;
+        }
+
         // create row plan,
         // x=y & x!=y, In->In for inplace, In->out for outofplace
         hcfftCreateDefaultPlanInternal(&fftPlan->planX, HCFFT_1D,
@@ -3704,6 +10384,43 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         rowPlan->exist = fftPlan->exist;
         rowPlan->plHandleOrigin = fftPlan->plHandleOrigin;
         hcfftBakePlanInternal(fftPlan->planX);
+
+        if (fftPlan->blockColumn) {
+          // column FFT in place on the output of the row FFT
+          hcfftCreateDefaultPlanInternal(&fftPlan->planY, HCFFT_1D,
+                                         &fftPlan->length[1]);
+          FFTPlan* colPlan = NULL;
+          lockRAII* colLock = NULL;
+          fftRepo.getPlan(fftPlan->planY, colPlan, colLock);
+          colPlan->ipLayout = fftPlan->opLayout;
+          colPlan->opLayout = fftPlan->opLayout;
+          colPlan->location = HCFFT_INPLACE;
+          colPlan->inStride[0] = fftPlan->outStride[1];
+          colPlan->inStride.push_back(fftPlan->outStride[0]);
+          colPlan->iDist = fftPlan->oDist;
+          colPlan->outStride[0] = fftPlan->outStride[1];
+          colPlan->outStride.push_back(fftPlan->outStride[0]);
+          colPlan->oDist = fftPlan->oDist;
+          colPlan->precision = fftPlan->precision;
+          colPlan->forwardScale = fftPlan->forwardScale;
+          colPlan->backwardScale = fftPlan->backwardScale;
+          colPlan->tmpBufSize = 0;
+          colPlan->gen = fftPlan->gen;
+          colPlan->envelope = fftPlan->envelope;
+          colPlan->batchSize = fftPlan->batchSize;
+          colPlan->length.push_back(fftPlan->length[0]);
+          colPlan->blockCompute = true;
+          colPlan->blockComputeType = BCT_C2C;
+          colPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+          colPlan->originalLength = fftPlan->originalLength;
+          colPlan->acc = fftPlan->acc;
+          colPlan->exist = fftPlan->exist;
+          colPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+          hcfftBakePlanInternal(fftPlan->planY);
+          fftPlan->baked = true;
+          return HCFFT_SUCCEEDS;
+        }
+
         // Create transpose plan for first transpose
         // x=y: inplace. x!=y inplace: in->tmp, outofplace out->tmp
         size_t hcLengths[] = {1, 1, 0};
@@ -3716,6 +10433,20 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         size_t padding = 0;
         fftPlan->transpose_in_2d_inplace =
             (hcLengths[0] == hcLengths[1]) ? true : false;
+        // In the low-memory mode the rows of a rectangle are transposed in
+        // place too, by the non-square transpose, and the column transforms
+        // run on the packed transposed data
+        bool nonSquareInplace =
+            !fftPlan->transpose_in_2d_inplace && fftPlan->lowMemory &&
+            (IsTransposableInplace(smallerDim, biggerDim) ||
+             IsShuffleTransposable(fftPlan, hcLengths[0], hcLengths[1],
+                                   fftPlan->outStride[0],
+                                   fftPlan->outStride[1]));
+
+        if (nonSquareInplace) {
+          fftPlan->transpose_in_2d_inplace = true;
+          fftPlan->allOpsInplace = true;
+        }
 
         if ((!fftPlan->transpose_in_2d_inplace) && fftPlan->tmpBufSize == 0 &&
             fftPlan->length.size() <= 2) {
@@ -3752,6 +10483,13 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
           transPlanX->outStride[0] = 1;
           transPlanX->outStride[1] = hcLengths[1] + padding;
           transPlanX->oDist = hcLengths[0] * transPlanX->outStride[1];
+        } else if (nonSquareInplace) {
+          transPlanX->gen = Transpose_NONSQUARE;
+          transPlanX->opLayout = fftPlan->opLayout;
+          transPlanX->location = HCFFT_INPLACE;
+          transPlanX->outStride[0] = fftPlan->outStride[0];
+          transPlanX->outStride[1] = hcLengths[1] * fftPlan->outStride[0];
+          transPlanX->oDist = fftPlan->oDist;
         } else {
           transPlanX->gen = Transpose_SQUARE;
           transPlanX->opLayout = fftPlan->opLayout;
@@ -3796,13 +10534,17 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
             colPlan->location = HCFFT_OUTOFPLACE;
           }
         } else {
+          // The transposed rows of a rectangle are length[1] long
+          size_t colStride = nonSquareInplace
+                                 ? hcLengths[1] * fftPlan->outStride[0]
+                                 : fftPlan->outStride[1];
           colPlan->ipLayout = fftPlan->opLayout;
           colPlan->opLayout = fftPlan->opLayout;
           colPlan->outStride[0] = fftPlan->outStride[0];
-          colPlan->outStride.push_back(fftPlan->outStride[1]);
+          colPlan->outStride.push_back(colStride);
           colPlan->oDist = fftPlan->oDist;
           colPlan->inStride[0] = fftPlan->outStride[0];
-          colPlan->inStride.push_back(fftPlan->outStride[1]);
+          colPlan->inStride.push_back(colStride);
           colPlan->iDist = fftPlan->oDist;
           colPlan->location = HCFFT_INPLACE;
         }
@@ -3822,9 +10564,53 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         colPlan->plHandleOrigin = fftPlan->plHandleOrigin;
         hcfftBakePlanInternal(fftPlan->planY);
 
-        if (fftPlan->transposeType == HCFFT_TRANSPOSED) {
-          fftPlan->baked = true;
-          return HCFFT_SUCCEEDS;
+        // Forward, a transposed plan stops after the columns. Backward it
+        // takes transposed input, and runs the columns, the second transpose
+        // back to natural order, then the rows. The columns read the input
+        // in place when the whole plan does; otherwise they write where the
+        // second transpose reads, through planZ.
+        if (fftPlan->transposeType == HCFFT_TRANSPOSED &&
+            (!fftPlan->transpose_in_2d_inplace ||
+             fftPlan->location == HCFFT_OUTOFPLACE)) {
+          hcfftCreateDefaultPlanInternal(&fftPlan->planZ, HCFFT_1D,
+                                         &fftPlan->length[1]);
+          FFTPlan* backColPlan = NULL;
+          lockRAII* backColLock = NULL;
+          fftRepo.getPlan(fftPlan->planZ, backColPlan, backColLock);
+          backColPlan->ipLayout = fftPlan->ipLayout;
+          backColPlan->inStride[0] = fftPlan->inStride[0];
+          backColPlan->inStride.push_back(hcLengths[1] *
+                                          fftPlan->inStride[0]);
+          backColPlan->iDist = fftPlan->iDist;
+
+          if (!fftPlan->transpose_in_2d_inplace) {
+            backColPlan->opLayout = HCFFT_COMPLEX_INTERLEAVED;
+            backColPlan->outStride[0] = 1;
+            backColPlan->outStride.push_back(hcLengths[1] + padding);
+            backColPlan->oDist = hcLengths[0] * backColPlan->outStride[1];
+          } else {
+            backColPlan->opLayout = fftPlan->opLayout;
+            backColPlan->outStride[0] = fftPlan->outStride[0];
+            backColPlan->outStride.push_back(hcLengths[1] *
+                                             fftPlan->outStride[0]);
+            backColPlan->oDist = fftPlan->oDist;
+          }
+
+          backColPlan->location = HCFFT_OUTOFPLACE;
+          backColPlan->precision = fftPlan->precision;
+          backColPlan->forwardScale = fftPlan->forwardScale;
+          backColPlan->backwardScale = fftPlan->backwardScale;
+          backColPlan->tmpBufSize = 0;
+          backColPlan->gen = fftPlan->gen;
+          backColPlan->envelope = fftPlan->envelope;
+          backColPlan->batchSize = fftPlan->batchSize;
+          backColPlan->length.push_back(fftPlan->length[0]);
+          backColPlan->hcfftlibtype = fftPlan->hcfftlibtype;
+          backColPlan->originalLength = fftPlan->originalLength;
+          backColPlan->acc = fftPlan->acc;
+          backColPlan->exist = fftPlan->exist;
+          backColPlan->plHandleOrigin = fftPlan->plHandleOrigin;
+          hcfftBakePlanInternal(fftPlan->planZ);
         }
 
         // Create transpose plan for second transpose
@@ -3844,11 +10630,14 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
           transPlanY->iDist = hcLengths[0] * transPlanY->inStride[1];
           transPlanY->transOutHorizontal = true;
         } else {
-          transPlanY->gen = Transpose_SQUARE;
+          transPlanY->gen =
+              nonSquareInplace ? Transpose_NONSQUARE : Transpose_SQUARE;
           transPlanY->ipLayout = fftPlan->opLayout;
           transPlanY->location = HCFFT_INPLACE;
           transPlanY->inStride[0] = fftPlan->outStride[0];
-          transPlanY->inStride[1] = fftPlan->outStride[1];
+          transPlanY->inStride[1] = nonSquareInplace
+                                        ? hcLengths[1] * fftPlan->outStride[0]
+                                        : fftPlan->outStride[1];
           transPlanY->iDist = fftPlan->oDist;
         }
 
@@ -4094,8 +10883,15 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
           trans2Plan->hcfftlibtype = fftPlan->hcfftlibtype;
           trans2Plan->originalLength = fftPlan->originalLength;
           trans2Plan->exist = fftPlan->exist;
+          trans2Plan->storeCallback = fftPlan->storeCallback;
           hcfftBakePlanInternal(fftPlan->planTY);
         } else {
+          //  The column kernel writes the output, unless it is split up
+          if (!fftPlan->storeCallback.empty() &&
+              !Is1DPossible(fftPlan->length[1], Large1DThreshold)) {
+            return HCFFT_INVALID;
+          }
+
           // create col plan
           // complex to complex
           hcfftCreateDefaultPlanInternal(&fftPlan->planY, HCFFT_1D,
@@ -4147,6 +10943,7 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
           colPlan->originalLength = fftPlan->originalLength;
           colPlan->acc = fftPlan->acc;
           colPlan->exist = fftPlan->exist;
+          colPlan->storeCallback = fftPlan->storeCallback;
           hcfftBakePlanInternal(fftPlan->planY);
         }
       } else if (fftPlan->opLayout == HCFFT_REAL) {
@@ -4543,6 +11340,7 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         rowPlan->originalLength = fftPlan->originalLength;
         rowPlan->acc = fftPlan->acc;
         rowPlan->exist = fftPlan->exist;
+        rowPlan->loadCallback = fftPlan->loadCallback;
         hcfftBakePlanInternal(fftPlan->planX);
         // create col plan
         hcfftCreateDefaultPlanInternal(&fftPlan->planY, HCFFT_1D,
@@ -4596,6 +11394,7 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         colPlan->originalLength = fftPlan->originalLength;
         colPlan->acc = fftPlan->acc;
         colPlan->exist = fftPlan->exist;
+        colPlan->storeCallback = fftPlan->storeCallback;
         hcfftBakePlanInternal(fftPlan->planY);
       }
 
@@ -4604,11 +11403,16 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
     }
 
     case HCFFT_3D: {
+      fftPlan->blockSlab = false;
+
       if (fftPlan->ipLayout == HCFFT_REAL) {
         size_t length0 = fftPlan->length[0];
         size_t length1 = fftPlan->length[1];
         size_t length2 = fftPlan->length[2];
         size_t Nt = (1 + length0 / 2);
+        fftPlan->blockSlab =
+            (fftPlan->opLayout == HCFFT_HERMITIAN_INTERLEAVED) &&
+            IsBlockSlab(fftPlan, Nt);
         // create 2D xy plan
         size_t hcLengths[] = {length0, length1, 0};
         hcfftCreateDefaultPlanInternal(&fftPlan->planX, HCFFT_2D, hcLengths);
@@ -4654,7 +11458,8 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         xyPlan->exist = fftPlan->exist;
         hcfftBakePlanInternal(fftPlan->planX);
 
-        if ((xyPlan->inStride[0] == 1) && (xyPlan->outStride[0] == 1) &&
+        if (!fftPlan->blockSlab && (xyPlan->inStride[0] == 1) &&
+            (xyPlan->outStride[0] == 1) &&
             (xyPlan->outStride[2] == Nt * length1) &&
             (((xyPlan->inStride[2] == Nt * 2 * length1) &&
               (xyPlan->location == HCFFT_INPLACE)) ||
@@ -4884,6 +11689,10 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
             colPlan->outStride.push_back(fftPlan->outStride[index]);
           }
 
+          if (fftPlan->blockSlab) {
+            SetBlockSlab(colPlan, Nt * length1);
+          }
+
           colPlan->hcfftlibtype = fftPlan->hcfftlibtype;
           colPlan->originalLength = fftPlan->originalLength;
           colPlan->acc = fftPlan->acc;
@@ -5229,7 +12038,9 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
           hcfftBakePlanInternal(fftPlan->planX);
         }
       } else {
-        if (fftPlan->tmpBufSize == 0 &&
+        // In the low-memory mode the sub-plans size their own tmp buffers,
+        // which only those that can not transpose in place need
+        if (fftPlan->tmpBufSize == 0 && !fftPlan->lowMemory &&
             (fftPlan->length[0] > Large1DThreshold ||
              fftPlan->length[1] > Large1DThreshold ||
              fftPlan->length[2] > Large1DThreshold)) {
@@ -5309,6 +12120,15 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
         colPlan->outStride.push_back(fftPlan->outStride[1]);
         colPlan->iDist = fftPlan->oDist;
         colPlan->oDist = fftPlan->oDist;
+        fftPlan->blockSlab =
+            (fftPlan->ipLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+            (fftPlan->opLayout == HCFFT_COMPLEX_INTERLEAVED) &&
+            IsBlockSlab(fftPlan, fftPlan->length[0]);
+
+        if (fftPlan->blockSlab) {
+          SetBlockSlab(colPlan, fftPlan->length[0] * fftPlan->length[1]);
+        }
+
         colPlan->hcfftlibtype = fftPlan->hcfftlibtype;
         colPlan->originalLength = fftPlan->originalLength;
         colPlan->acc = fftPlan->acc;
@@ -5319,6 +12139,12 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
       fftPlan->baked = true;
       return HCFFT_SUCCEEDS;
     }
+
+    //  Plans of more dimensions are baked as rank N plans above
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D:
+      return HCFFT_INVALID;
   }
 
   switch (fftPlan->gen) {
@@ -5327,12 +12153,7 @@ hcfftStatus FFTPlan::hcfftBakePlanInternal(hcfftPlanHandle plHandle) {
     case Copy: {
       //  For the radices that we have factored, we need to load/compile and
       //  build the appropriate HCC kernels
-      fftPlan->GenerateKernel(plHandle, fftRepo, bakedPlanCount,
-                              fftPlan->exist);
-      CompileKernels(plHandle, fftPlan->gen, fftPlan, fftPlan->plHandleOrigin,
-                     fftPlan->exist, fftPlan->originalLength,
-                     fftPlan->hcfftlibtype);
-      bakedPlanCount++;
+      BakeKernel(plHandle, fftPlan);
       fftPlan->baked = true;
     } break;
 
@@ -5348,7 +12169,11 @@ hcfftStatus FFTPlan::hcfftGetPlanPrecision(const hcfftPlanHandle plHandle,
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
   scopedLock sLock(*planLock, _T(" hcfftGetPlanPrecision"));
   *precision = fftPlan->precision;
   return HCFFT_SUCCEEDS;
@@ -5416,13 +12241,64 @@ hcfftStatus FFTPlan::hcfftGetPlanBatchSize(const hcfftPlanHandle plHandle,
   return HCFFT_SUCCEEDS;
 }
 
+//  Whether a baked plan is a single kernel whose sizes and buffers do not
+//  depend on its batch: a Stockham kernel, which computes its grid at
+//  launch, without sub-plans or intermediate buffers, and not the 2D kernel
+//  of Lds2DSizes, which packs as many images in a work-group as the batch
+//  has. Transpose and copy kernels compile their grid in.
+static bool IsRebatchableLeaf(const FFTPlan* fftPlan) {
+  if (fftPlan->gen != Stockham) {
+    return false;
+  }
+
+  if (fftPlan->planX || fftPlan->planY || fftPlan->planZ || fftPlan->planTX ||
+      fftPlan->planTY || fftPlan->planTZ || fftPlan->planRCcopy ||
+      fftPlan->planCopy || fftPlan->planConvFwd || fftPlan->planConvBack ||
+      fftPlan->planStreamXY || fftPlan->planStreamZ) {
+    return false;
+  }
+
+  for (size_t i = 0; i < 4; i++) {
+    if (fftPlan->planR2R[i]) {
+      return false;
+    }
+  }
+
+  if (fftPlan->intBuffer != NULL || fftPlan->intBufferRC != NULL ||
+      fftPlan->intBufferC2R != NULL || !fftPlan->gpus.empty()) {
+    return false;
+  }
+
+  return fftPlan->kernelPtr != NULL && !fftPlan->Lds2DSizes(NULL, NULL);
+}
+
 hcfftStatus FFTPlan::hcfftSetPlanBatchSize(hcfftPlanHandle plHandle,
                                            size_t batchsize) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
   scopedLock sLock(*planLock, _T(" hcfftSetPlanBatchSize"));
+
+  if (batchsize == fftPlan->batchSize) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  //  The launcher of a baked leaf sizes its grid from the batch it is passed
+  //  (GridExtent), and the batch is not part of its kernel signature, so the
+  //  leaf keeps its kernel and twiddles. Only the recorded launches carry
+  //  the old batch.
+  if (fftPlan->baked && IsRebatchableLeaf(fftPlan)) {
+    fftPlan->batchSize = batchsize;
+    fftPlan->launchesFwd.clear();
+    fftPlan->launchesBack.clear();
+    return HCFFT_SUCCEEDS;
+  }
+
   //  If we modify the state of the plan, we assume that we can't trust any
   //  pre-calculated contents anymore
   fftPlan->baked = false;
@@ -5452,6 +12328,12 @@ hcfftStatus FFTPlan::hcfftGetPlanDim(const hcfftPlanHandle plHandle,
       *size = 3;
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      *size = fftPlan->dimension;
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5489,6 +12371,14 @@ hcfftStatus FFTPlan::hcfftSetPlanDim(hcfftPlanHandle plHandle,
       fftPlan->outStride.resize(3);
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      fftPlan->length.resize(dim);
+      fftPlan->inStride.resize(dim);
+      fftPlan->outStride.resize(dim);
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5541,6 +12431,18 @@ hcfftStatus FFTPlan::hcfftGetPlanLength(const hcfftPlanHandle plHandle,
       hcLengths[2] = fftPlan->length[2];
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      if (fftPlan->length.size() < dim) {
+        return HCFFT_ERROR;
+      }
+
+      for (size_t i = 0; i < dim; i++) {
+        hcLengths[i] = fftPlan->length[i];
+      }
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5597,6 +12499,21 @@ hcfftStatus FFTPlan::hcfftSetPlanLength(hcfftPlanHandle plHandle,
       fftPlan->length.push_back(hcLengths[2]);
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      //  Minimum length size is 1
+      for (size_t i = 0; i < dim; i++) {
+        if (hcLengths[i] == 0) {
+          return HCFFT_ERROR;
+        }
+      }
+
+      for (size_t i = 0; i < dim; i++) {
+        fftPlan->length.push_back(hcLengths[i]);
+      }
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5650,6 +12567,18 @@ hcfftStatus FFTPlan::hcfftGetPlanInStride(const hcfftPlanHandle plHandle,
       }
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      if (fftPlan->inStride.size() < dim) {
+        return HCFFT_ERROR;
+      }
+
+      for (size_t i = 0; i < dim; i++) {
+        hcStrides[i] = fftPlan->inStride[i];
+      }
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5691,6 +12620,14 @@ hcfftStatus FFTPlan::hcfftSetPlanInStride(hcfftPlanHandle plHandle,
       fftPlan->inStride.push_back(hcStrides[2]);
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      for (size_t i = 0; i < dim; i++) {
+        fftPlan->inStride.push_back(hcStrides[i]);
+      }
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5743,6 +12680,18 @@ hcfftStatus FFTPlan::hcfftGetPlanOutStride(const hcfftPlanHandle plHandle,
       }
     } break;
 
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      if (fftPlan->outStride.size() < dim) {
+        return HCFFT_ERROR;
+      }
+
+      for (size_t i = 0; i < dim; i++) {
+        hcStrides[i] = fftPlan->outStride[i];
+      }
+    } break;
+
     default:
       return HCFFT_ERROR;
       break;
@@ -5764,241 +12713,780 @@ hcfftStatus FFTPlan::hcfftSetPlanOutStride(hcfftPlanHandle plHandle,
     return HCFFT_ERROR;
   }
 
-  switch (dim) {
-    case HCFFT_1D: {
-      fftPlan->outStride[0] = hcStrides[0];
-    } break;
+  switch (dim) {
+    case HCFFT_1D: {
+      fftPlan->outStride[0] = hcStrides[0];
+    } break;
+
+    case HCFFT_2D: {
+      fftPlan->outStride[0] = hcStrides[0];
+      fftPlan->outStride[1] = hcStrides[1];
+    } break;
+
+    case HCFFT_3D: {
+      fftPlan->outStride[0] = hcStrides[0];
+      fftPlan->outStride[1] = hcStrides[1];
+      fftPlan->outStride[2] = hcStrides[2];
+    } break;
+
+    case HCFFT_4D:
+    case HCFFT_5D:
+    case HCFFT_6D: {
+      if (fftPlan->outStride.size() < dim) {
+        return HCFFT_ERROR;
+      }
+
+      for (size_t i = 0; i < dim; i++) {
+        fftPlan->outStride[i] = hcStrides[i];
+      }
+    } break;
+
+    default:
+      return HCFFT_ERROR;
+      break;
+  }
+
+  //  If we modify the state of the plan, we assume that we can't trust any
+  //  pre-calculated contents anymore
+  fftPlan->baked = false;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftGetPlanDistance(const hcfftPlanHandle plHandle,
+                                          size_t* iDist, size_t* oDist) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftGetPlanDistance"));
+  *iDist = fftPlan->iDist;
+  *oDist = fftPlan->oDist;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetPlanDistance(hcfftPlanHandle plHandle,
+                                          size_t iDist, size_t oDist) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanDistance"));
+  //  If we modify the state of the plan, we assume that we can't trust any
+  //  pre-calculated contents anymore
+  fftPlan->baked = false;
+  fftPlan->iDist = iDist;
+  fftPlan->oDist = oDist;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftGetLayout(const hcfftPlanHandle plHandle,
+                                    hcfftIpLayout* iLayout,
+                                    hcfftOpLayout* oLayout) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftGetLayout"));
+  *iLayout = fftPlan->ipLayout;
+  *oLayout = fftPlan->opLayout;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetLayout(hcfftPlanHandle plHandle,
+                                    hcfftIpLayout iLayout,
+                                    hcfftOpLayout oLayout) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftSetLayout"));
+
+  //  We currently only support a subset of formats
+  switch (iLayout) {
+    case HCFFT_COMPLEX_INTERLEAVED: {
+      if ((oLayout == HCFFT_HERMITIAN_INTERLEAVED) ||
+          (oLayout == HCFFT_HERMITIAN_PLANAR) || (oLayout == HCFFT_REAL)) {
+        return HCFFT_ERROR;
+      }
+    } break;
+
+    case HCFFT_COMPLEX_PLANAR: {
+      if ((oLayout == HCFFT_HERMITIAN_INTERLEAVED) ||
+          (oLayout == HCFFT_HERMITIAN_PLANAR) || (oLayout == HCFFT_REAL)) {
+        return HCFFT_ERROR;
+      }
+    } break;
+
+    case HCFFT_HERMITIAN_INTERLEAVED: {
+      if (oLayout != HCFFT_REAL) {
+        return HCFFT_ERROR;
+      }
+    } break;
+
+    case HCFFT_HERMITIAN_PLANAR: {
+      if (oLayout != HCFFT_REAL) {
+        return HCFFT_ERROR;
+      }
+    } break;
+
+    case HCFFT_REAL: {
+      if ((oLayout == HCFFT_REAL) || (oLayout == HCFFT_COMPLEX_INTERLEAVED) ||
+          (oLayout == HCFFT_COMPLEX_PLANAR)) {
+        return HCFFT_ERROR;
+      }
+    } break;
+
+    default:
+      return HCFFT_ERROR;
+      break;
+  }
+
+  //  We currently only support a subset of formats
+  switch (oLayout) {
+    case HCFFT_COMPLEX_PLANAR:
+    case HCFFT_COMPLEX_INTERLEAVED:
+    case HCFFT_HERMITIAN_INTERLEAVED:
+    case HCFFT_HERMITIAN_PLANAR:
+    case HCFFT_REAL:
+      break;
+
+    default:
+      return HCFFT_ERROR;
+      break;
+  }
+
+  if (fftPlan->ipLayout != iLayout || fftPlan->opLayout != oLayout) {
+    fftPlan->baked = false;
+    fftPlan->ipLayout = iLayout;
+    fftPlan->opLayout = oLayout;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftGetResultLocation(const hcfftPlanHandle plHandle,
+                                            hcfftResLocation* placeness) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftGetResultLocation"));
+  *placeness = fftPlan->location;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetResultLocation(hcfftPlanHandle plHandle,
+                                            hcfftResLocation placeness) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  fftRepo.getPlan(plHandle, fftPlan, planLock);
+  scopedLock sLock(*planLock, _T(" hcfftSetResultLocation"));
+
+  //  If we modify the state of the plan, we assume that we can't trust any
+  //  pre-calculated contents anymore
+  if (fftPlan->location != placeness) {
+    fftPlan->baked = false;
+    fftPlan->location = placeness;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftPrepareExec(hcfftPlanHandle plHandle,
+                                      hcfftResLocation placeness,
+                                      hcfftIpLayout iLayout,
+                                      hcfftOpLayout oLayout) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftPrepareExec"));
+
+  //  Repeated calls on the same buffers find the plan ready
+  if (fftPlan->baked && fftPlan->location == placeness &&
+      fftPlan->ipLayout == iLayout && fftPlan->opLayout == oLayout) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  hcfftStatus status = hcfftSetResultLocation(plHandle, placeness);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  status = hcfftSetLayout(plHandle, iLayout, oLayout);
+
+  if (status != HCFFT_SUCCEEDS) {
+    return status;
+  }
+
+  return hcfftBakePlan(plHandle);
+}
+
+hcfftStatus FFTPlan::hcfftSetPlanCallback(hcfftPlanHandle plHandle,
+                                          const char* funcName,
+                                          const char* funcString,
+                                          hcfftCallbackType type,
+                                          void* userdata) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanCallback"));
+
+  //  The callbacks of a plan with half or planar storage address its data
+  if (funcName == NULL || *funcName == '\0' || funcString == NULL ||
+      fftPlan->halfStorage || fftPlan->planarStorage) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftCallback* callback = NULL;
+
+  switch (type) {
+    case HCFFT_CALLBACK_LOAD:
+      callback = &fftPlan->loadCallback;
+      break;
+
+    case HCFFT_CALLBACK_STORE:
+      callback = &fftPlan->storeCallback;
+      break;
+
+    default:
+      return HCFFT_INVALID;
+  }
+
+  //  A new data pointer for the same callback only changes kernel arguments
+  if (callback->funcName == funcName && callback->funcString == funcString) {
+    return hcfftSetPlanCallbackData(plHandle, type, userdata);
+  }
+
+  //  The callback is compiled into the kernels, which have to be generated
+  //  again
+  callback->funcName = funcName;
+  callback->funcString = funcString;
+  callback->userdata = userdata;
+  fftPlan->baked = false;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTPlan::hcfftSetPlanCallbackData(hcfftPlanHandle plHandle,
+                                              hcfftCallbackType type,
+                                              void* userdata) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T(" hcfftSetPlanCallbackData"));
+    hcfftCallback& callback = (type == HCFFT_CALLBACK_LOAD)
+                                  ? fftPlan->loadCallback
+                                  : fftPlan->storeCallback;
 
-    case HCFFT_2D: {
-      fftPlan->outStride[0] = hcStrides[0];
-      fftPlan->outStride[1] = hcStrides[1];
-    } break;
+    if (!callback.empty()) {
+      callback.userdata = userdata;
 
-    case HCFFT_3D: {
-      fftPlan->outStride[0] = hcStrides[0];
-      fftPlan->outStride[1] = hcStrides[1];
-      fftPlan->outStride[2] = hcStrides[2];
-    } break;
+      if (fftPlan->kernelPtr && fftPlan->SetKernelArgs() != HCFFT_SUCCEEDS) {
+        return HCFFT_ERROR;
+      }
+    }
 
-    default:
+    // The callbacks of the sub-plans of a Bluestein, Rader, short-time or
+    // pruned plan are its own
+    if (fftPlan->bluestein || fftPlan->rader || fftPlan->stft ||
+        fftPlan->pruned) {
+      return HCFFT_SUCCEEDS;
+    }
+
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+  }
+
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i] &&
+        hcfftSetPlanCallbackData(subPlans[i], type, userdata) !=
+            HCFFT_SUCCEEDS) {
       return HCFFT_ERROR;
-      break;
+    }
   }
 
-  //  If we modify the state of the plan, we assume that we can't trust any
-  //  pre-calculated contents anymore
-  fftPlan->baked = false;
   return HCFFT_SUCCEEDS;
 }
 
-hcfftStatus FFTPlan::hcfftGetPlanDistance(const hcfftPlanHandle plHandle,
-                                          size_t* iDist, size_t* oDist) {
+hcfftStatus FFTPlan::hcfftGetPlanTransposeResult(
+    const hcfftPlanHandle plHandle, hcfftResTransposed* transposed) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
   fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftGetPlanDistance"));
-  *iDist = fftPlan->iDist;
-  *oDist = fftPlan->oDist;
+  scopedLock sLock(*planLock, _T(" hcfftGetPlanTransposeResult"));
+  *transposed = fftPlan->transposeType;
   return HCFFT_SUCCEEDS;
 }
 
-hcfftStatus FFTPlan::hcfftSetPlanDistance(hcfftPlanHandle plHandle,
-                                          size_t iDist, size_t oDist) {
+hcfftStatus FFTPlan::hcfftSetPlanTransposeResult(
+    hcfftPlanHandle plHandle, hcfftResTransposed transposed) {
   FFTRepo& fftRepo = FFTRepo::getInstance();
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftSetPlanDistance"));
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  scopedLock sLock(*planLock, _T(" hcfftSetPlanTransposeResult"));
   //  If we modify the state of the plan, we assume that we can't trust any
   //  pre-calculated contents anymore
   fftPlan->baked = false;
-  fftPlan->iDist = iDist;
-  fftPlan->oDist = oDist;
+  fftPlan->transposeType = transposed;
   return HCFFT_SUCCEEDS;
 }
 
-hcfftStatus FFTPlan::hcfftGetLayout(const hcfftPlanHandle plHandle,
-                                    hcfftIpLayout* iLayout,
-                                    hcfftOpLayout* oLayout) {
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftGetLayout"));
-  *iLayout = fftPlan->ipLayout;
-  *oLayout = fftPlan->opLayout;
-  return HCFFT_SUCCEEDS;
+hcfftStatus FFTPlan::GetMax1DLength(size_t* longest) const {
+  switch (gen) {
+    case Stockham:
+      return GetMax1DLengthPvt<Stockham>(longest);
+
+    case Copy: {
+      *longest = 4096;
+      return HCFFT_SUCCEEDS;
+    }
+
+    case Transpose_GCN: {
+      *longest = 4096;
+      return HCFFT_SUCCEEDS;
+    }
+
+    case Transpose_NONSQUARE: {
+      *longest = 4096;
+      return HCFFT_SUCCEEDS;
+    }
+
+    case Transpose_SQUARE: {
+      *longest = 4096;
+      return HCFFT_SUCCEEDS;
+    }
+
+    default:
+      return HCFFT_ERROR;
+  }
 }
 
-hcfftStatus FFTPlan::hcfftSetLayout(hcfftPlanHandle plHandle,
-                                    hcfftIpLayout iLayout,
-                                    hcfftOpLayout oLayout) {
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftSetLayout"));
+hcfftStatus FFTPlan::GetKernelGenKey(FFTKernelGenKeyParams& params) const {
+  switch (gen) {
+    case Stockham:
+      return GetKernelGenKeyPvt<Stockham>(params);
 
-  //  We currently only support a subset of formats
-  switch (iLayout) {
+    case Copy:
+      return GetKernelGenKeyPvt<Copy>(params);
+
+    case Transpose_GCN:
+      return GetKernelGenKeyPvt<Transpose_GCN>(params);
+
+    case Transpose_NONSQUARE:
+      return GetKernelGenKeyPvt<Transpose_NONSQUARE>(params);
+
+    case Transpose_SQUARE:
+      return GetKernelGenKeyPvt<Transpose_SQUARE>(params);
+
+    default:
+      return HCFFT_ERROR;
+  }
+}
+
+//  Lay out the argument block of a leaf plan once its twiddles are generated.
+//  Decode the relevant properties from the plan to figure out how many
+//  input/output buffers the kernel reads; the twiddle tables follow them.
+hcfftStatus FFTPlan::SetKernelArgs() {
+  unsigned int inSlots = 0;
+  unsigned int outSlots = 0;
+  kernelArgIn = 0;
+  kernelArgOut = 0;
+  memset(&kernelArgs, 0, sizeof(kernelArgs));
+
+  //  Strides and distances of kernels of runtime shape, laid out as in
+  //  their FFTKernelGenKeyParams
+  size_t dims = std::min<size_t>(length.size(), 15);
+
+  for (size_t i = 0; i < dims && i < inStride.size(); i++) {
+    kernelArgs.inStride[i] = static_cast<unsigned int>(inStride[i]);
+    kernelArgs.outStride[i] = static_cast<unsigned int>(outStride[i]);
+  }
+
+  kernelArgs.inStride[dims] = static_cast<unsigned int>(iDist);
+  kernelArgs.outStride[dims] = static_cast<unsigned int>(oDist);
+
+  switch (ipLayout) {
     case HCFFT_COMPLEX_INTERLEAVED: {
-      if ((oLayout == HCFFT_HERMITIAN_INTERLEAVED) ||
-          (oLayout == HCFFT_HERMITIAN_PLANAR) || (oLayout == HCFFT_REAL)) {
-        return HCFFT_ERROR;
+      switch (opLayout) {
+        case HCFFT_COMPLEX_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            inSlots++;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_COMPLEX_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            //  Invalid to be an inplace transform, and go from 1 to 2 buffers
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_HERMITIAN_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_HERMITIAN_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_REAL: {
+          if (location == HCFFT_INPLACE) {
+            inSlots++;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        default: {
+          //  Don't recognize output layout
+          return HCFFT_ERROR;
+        }
       }
-    } break;
+
+      break;
+    }
 
     case HCFFT_COMPLEX_PLANAR: {
-      if ((oLayout == HCFFT_HERMITIAN_INTERLEAVED) ||
-          (oLayout == HCFFT_HERMITIAN_PLANAR) || (oLayout == HCFFT_REAL)) {
-        return HCFFT_ERROR;
+      switch (opLayout) {
+        case HCFFT_COMPLEX_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_COMPLEX_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            inSlots++;
+            inSlots++;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_HERMITIAN_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_HERMITIAN_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_REAL: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        default: {
+          //  Don't recognize output layout
+          return HCFFT_ERROR;
+        }
       }
-    } break;
 
-    case HCFFT_HERMITIAN_INTERLEAVED: {
-      if (oLayout != HCFFT_REAL) {
-        return HCFFT_ERROR;
+      break;
+    }
+
+    case HCFFT_HERMITIAN_INTERLEAVED: {
+      switch (opLayout) {
+        case HCFFT_COMPLEX_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_COMPLEX_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        case HCFFT_HERMITIAN_INTERLEAVED: {
+          return HCFFT_ERROR;
+        }
+
+        case HCFFT_HERMITIAN_PLANAR: {
+          return HCFFT_ERROR;
+        }
+
+        case HCFFT_REAL: {
+          if (location == HCFFT_INPLACE) {
+            inSlots++;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        default: {
+          //  Don't recognize output layout
+          return HCFFT_ERROR;
+        }
       }
-    } break;
+
+      break;
+    }
 
     case HCFFT_HERMITIAN_PLANAR: {
-      if (oLayout != HCFFT_REAL) {
-        return HCFFT_ERROR;
-      }
-    } break;
+      switch (opLayout) {
+        case HCFFT_COMPLEX_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+          }
 
-    case HCFFT_REAL: {
-      if ((oLayout == HCFFT_REAL) || (oLayout == HCFFT_COMPLEX_INTERLEAVED) ||
-          (oLayout == HCFFT_COMPLEX_PLANAR)) {
-        return HCFFT_ERROR;
-      }
-    } break;
+          break;
+        }
 
-    default:
-      return HCFFT_ERROR;
-      break;
-  }
+        case HCFFT_COMPLEX_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
 
-  //  We currently only support a subset of formats
-  switch (oLayout) {
-    case HCFFT_COMPLEX_PLANAR:
-    case HCFFT_COMPLEX_INTERLEAVED:
-    case HCFFT_HERMITIAN_INTERLEAVED:
-    case HCFFT_HERMITIAN_PLANAR:
-    case HCFFT_REAL:
-      break;
+          break;
+        }
+
+        case HCFFT_HERMITIAN_INTERLEAVED: {
+          return HCFFT_ERROR;
+        }
+
+        case HCFFT_HERMITIAN_PLANAR: {
+          return HCFFT_ERROR;
+        }
+
+        case HCFFT_REAL: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            inSlots++;
+            outSlots++;
+          }
+
+          break;
+        }
+
+        default: {
+          //  Don't recognize output layout
+          return HCFFT_ERROR;
+        }
+      }
 
-    default:
-      return HCFFT_ERROR;
       break;
-  }
+    }
 
-  fftPlan->ipLayout = iLayout;
-  fftPlan->opLayout = oLayout;
-  return HCFFT_SUCCEEDS;
-}
+    case HCFFT_REAL: {
+      switch (opLayout) {
+        case HCFFT_COMPLEX_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            inSlots++;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
 
-hcfftStatus FFTPlan::hcfftGetResultLocation(const hcfftPlanHandle plHandle,
-                                            hcfftResLocation* placeness) {
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftGetResultLocation"));
-  *placeness = fftPlan->location;
-  return HCFFT_SUCCEEDS;
-}
+          break;
+        }
 
-hcfftStatus FFTPlan::hcfftSetResultLocation(hcfftPlanHandle plHandle,
-                                            hcfftResLocation placeness) {
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftSetResultLocation"));
-  //  If we modify the state of the plan, we assume that we can't trust any
-  //  pre-calculated contents anymore
-  fftPlan->baked = false;
-  fftPlan->location = placeness;
-  return HCFFT_SUCCEEDS;
-}
+        case HCFFT_COMPLEX_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
 
-hcfftStatus FFTPlan::hcfftGetPlanTransposeResult(
-    const hcfftPlanHandle plHandle, hcfftResTransposed* transposed) {
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftGetPlanTransposeResult"));
-  *transposed = fftPlan->transposeType;
-  return HCFFT_SUCCEEDS;
-}
+          break;
+        }
 
-hcfftStatus FFTPlan::hcfftSetPlanTransposeResult(
-    hcfftPlanHandle plHandle, hcfftResTransposed transposed) {
-  FFTRepo& fftRepo = FFTRepo::getInstance();
-  FFTPlan* fftPlan = NULL;
-  lockRAII* planLock = NULL;
-  fftRepo.getPlan(plHandle, fftPlan, planLock);
-  scopedLock sLock(*planLock, _T(" hcfftSetPlanTransposeResult"));
-  //  If we modify the state of the plan, we assume that we can't trust any
-  //  pre-calculated contents anymore
-  fftPlan->baked = false;
-  fftPlan->transposeType = transposed;
-  return HCFFT_SUCCEEDS;
-}
+        case HCFFT_HERMITIAN_INTERLEAVED: {
+          if (location == HCFFT_INPLACE) {
+            inSlots++;
+          } else {
+            inSlots++;
+            outSlots++;
+          }
 
-hcfftStatus FFTPlan::GetMax1DLength(size_t* longest) const {
-  switch (gen) {
-    case Stockham:
-      return GetMax1DLengthPvt<Stockham>(longest);
+          break;
+        }
 
-    case Copy: {
-      *longest = 4096;
-      return HCFFT_SUCCEEDS;
-    }
+        case HCFFT_HERMITIAN_PLANAR: {
+          if (location == HCFFT_INPLACE) {
+            return HCFFT_ERROR;
+          } else {
+            inSlots++;
+            outSlots++;
+            outSlots++;
+          }
 
-    case Transpose_GCN: {
-      *longest = 4096;
-      return HCFFT_SUCCEEDS;
-    }
+          break;
+        }
 
-    case Transpose_NONSQUARE: {
-      *longest = 4096;
-      return HCFFT_SUCCEEDS;
-    }
+        default: {
+          if (transflag) {
+            if (location == HCFFT_INPLACE) {
+              return HCFFT_ERROR;
+            } else {
+              inSlots++;
+              outSlots++;
+            }
+          } else {
+            //  Don't recognize output layout
+            return HCFFT_ERROR;
+          }
+        }
+      }
 
-    case Transpose_SQUARE: {
-      *longest = 4096;
-      return HCFFT_SUCCEEDS;
+      break;
     }
 
-    default:
+    default: {
+      //  Don't recognize output layout
       return HCFFT_ERROR;
+    }
   }
-}
 
-hcfftStatus FFTPlan::GetKernelGenKey(FFTKernelGenKeyParams& params) const {
-  switch (gen) {
-    case Stockham:
-      return GetKernelGenKeyPvt<Stockham>(params);
+  kernelArgIn = inSlots;
+  kernelArgOut = outSlots;
+  unsigned int uarg = inSlots + outSlots;
 
-    case Copy:
-      return GetKernelGenKeyPvt<Copy>(params);
-
-    case Transpose_GCN:
-      return GetKernelGenKeyPvt<Transpose_GCN>(params);
+  if (gen == Stockham || gen == Transpose_GCN || gen == Transpose_SQUARE ||
+      gen == Transpose_NONSQUARE) {
+    if (twiddles != NULL) {
+      kernelArgs.buffers[uarg++] = twiddles;
+    }
 
-    case Transpose_NONSQUARE:
-      return GetKernelGenKeyPvt<Transpose_NONSQUARE>(params);
+    if (twiddleslarge != NULL) {
+      kernelArgs.buffers[uarg++] = twiddleslarge;
+    }
+  }
 
-    case Transpose_SQUARE:
-      return GetKernelGenKeyPvt<Transpose_SQUARE>(params);
+  if (gen == Stockham && !loadCallback.empty()) {
+    kernelArgs.buffers[uarg++] = loadCallback.userdata;
+  }
 
-    default:
-      return HCFFT_ERROR;
+  if ((gen == Stockham ||
+       (gen == Transpose_GCN && opLayout == HCFFT_COMPLEX_INTERLEAVED)) &&
+      !storeCallback.empty()) {
+    kernelArgs.buffers[uarg++] = storeCallback.userdata;
   }
+
+  BUG_CHECK(uarg <= sizeof(kernelArgs.buffers) / sizeof(void*));
+  return HCFFT_SUCCEEDS;
 }
 
 hcfftStatus FFTPlan::GetWorkSizes(std::vector<size_t>& globalws,
@@ -6055,11 +13543,57 @@ hcfftStatus FFTPlan::hcfftDestroyPlan(hcfftPlanHandle* plHandle) {
   FFTPlan* fftPlan = NULL;
   lockRAII* planLock = NULL;
   fftRepo.getPlan(*plHandle, fftPlan, planLock);
+  hcfftWaitBakePlan(*plHandle);
 
-  if (fftPlan->kernelPtr) {
-    fftPlan->kernelPtr = NULL;
+  if (fftPlan->userPlan) {
+    hcfftCounters.plansDestroyed++;
+  }
+
+  if (fftPlan->userPlan && getenv("HCFFT_PLAN_TIMINGS") != NULL) {
+    std::vector<std::pair<size_t, FFTPlanTimings> > timings;
+    hcfftGetPlanTimings(*plHandle, 0, timings);
+    std::cout << "hcfft plan " << *plHandle
+              << " timings (s): generate write compile load twiddle alloc tune"
+              << std::endl;
+
+    for (size_t i = 0; i < timings.size(); i++) {
+      const FFTPlanTimings& t = timings[i].second;
+      std::cout << std::string(2 * timings[i].first + 2, ' ') << t.generate
+                << " " << t.write << " " << t.compile << " " << t.load << " "
+                << t.twiddle << " " << t.alloc << " " << t.tune;
+
+      if (t.hasKernel) {
+        std::cout << (t.cacheHit ? " hit" : " miss");
+      }
+
+      std::cout << std::endl;
+    }
+  }
+
+  if (fftPlan->userPlan && !fftPlan->profileKernels.empty()) {
+    std::vector<hcfftKernelProfile> profile;
+    hcfftGetPlanProfile(*plHandle, profile);
+    std::cout << "hcfft plan " << *plHandle
+              << " profile: role kernel bytes us GB/s GFLOPS" << std::endl;
+
+    for (size_t i = 0; i < profile.size(); i++) {
+      double seconds = profile[i].end - profile[i].start;
+      std::cout << "  " << profile[i].role << " "
+                << GeneratorName(profile[i].gen)
+                << " " << profile[i].bytes << " " << seconds * 1e6 << " "
+                << (seconds > 0 ? profile[i].bytes / seconds / 1e9 : 0) << " "
+                << (seconds > 0 ? profile[i].flops / seconds / 1e9 : 0)
+                << std::endl;
+    }
+  }
+
+  if (fftPlan->kernelPtr || fftPlan->kernelPtrBack) {
+    fftRepo.releaseKernel(fftPlan->gen, fftPlan->kernelIndex);
   }
 
+  fftPlan->kernelPtr = NULL;
+  fftPlan->kernelPtrBack = NULL;
+
   //  Recursively destroy subplans, that are used for higher dimensional FFT's
   if (fftPlan->planX) {
     hcfftDestroyPlan(&fftPlan->planX);
@@ -6073,48 +13607,182 @@ hcfftStatus FFTPlan::hcfftDestroyPlan(hcfftPlanHandle* plHandle) {
     hcfftDestroyPlan(&fftPlan->planZ);
   }
 
-  if (fftPlan->planTX) {
-    hcfftDestroyPlan(&fftPlan->planTX);
+  if (fftPlan->planTX) {
+    hcfftDestroyPlan(&fftPlan->planTX);
+  }
+
+  if (fftPlan->planTY) {
+    hcfftDestroyPlan(&fftPlan->planTY);
+  }
+
+  if (fftPlan->planTZ) {
+    hcfftDestroyPlan(&fftPlan->planTZ);
+  }
+
+  if (fftPlan->planRCcopy) {
+    hcfftDestroyPlan(&fftPlan->planRCcopy);
+  }
+
+  if (fftPlan->planCopy) {
+    hcfftDestroyPlan(&fftPlan->planCopy);
+  }
+
+  if (fftPlan->planConvFwd) {
+    hcfftDestroyPlan(&fftPlan->planConvFwd);
+  }
+
+  if (fftPlan->planConvBack) {
+    hcfftDestroyPlan(&fftPlan->planConvBack);
+  }
+
+  for (int i = 0; i < 4; i++) {
+    if (fftPlan->planR2R[i]) {
+      hcfftDestroyPlan(&fftPlan->planR2R[i]);
+    }
+  }
+
+  hcfftReleaseStreamPlans(*plHandle);
+  hcfftReleaseHostBatch(*plHandle);
+  hcfftReleaseGPUPlans(*plHandle);
+
+  fftPlan->ReleaseBuffers();
+
+  if (fftPlan->scratchPool) {
+    fftRepo.releaseScratch(fftPlan->scratchPool);
+    fftPlan->scratchPool = NULL;
+  }
+
+  fftRepo.deletePlan(plHandle);
+  return HCFFT_SUCCEEDS;
+}
+
+//  Every sub-plan of the tree is described, those of convolutions, streamed
+//  and real-to-real transforms and the host share of hybrid plans included
+hcfftStatus FFTPlan::hcfftGetPlanInfo(hcfftPlanHandle plHandle, size_t depth,
+                                      const std::string& role,
+                                      std::vector<FFTPlanInfo>& info) {
+  static const char* const names[18] = {
+      "planX",      "planY",        "planZ",        "planTX",
+      "planTY",     "planTZ",       "planRCcopy",   "planCopy",
+      "planConvFwd", "planConvBack", "planStreamXY", "planStreamZ",
+      "hybridPlan", "planR2R0",     "planR2R1",     "planR2R2",
+      "planR2R3",   "planHostBatch"};
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
+  }
+
+  hcfftPlanHandle subPlans[18];
+  {
+    scopedLock sLock(*planLock, _T("hcfftGetPlanInfo"));
+    FFTPlanInfo plan;
+    plan.depth = depth;
+    plan.role = role;
+    plan.baked = fftPlan->baked;
+    plan.hasKernel = fftPlan->kernelPtr || fftPlan->kernelPtrBack;
+    plan.gen = fftPlan->gen;
+    plan.length = fftPlan->length;
+    plan.inStride = fftPlan->inStride;
+    plan.outStride = fftPlan->outStride;
+    plan.iDist = fftPlan->iDist;
+    plan.oDist = fftPlan->oDist;
+    plan.batchSize = fftPlan->batchSize;
+    plan.ipLayout = fftPlan->ipLayout;
+    plan.opLayout = fftPlan->opLayout;
+    plan.location = fftPlan->location;
+    plan.large1D = fftPlan->large1D;
+    plan.large1D_Xfactor = fftPlan->large1D_Xfactor;
+    plan.nonSquareKernelOrder = fftPlan->nonSquareKernelOrder;
+    plan.RCsimple = fftPlan->RCsimple;
+    plan.realSpecial = fftPlan->realSpecial;
+    plan.blockCompute = fftPlan->blockCompute;
+    plan.bluestein = fftPlan->bluestein;
+    plan.rader = fftPlan->rader;
+    plan.scratchBytes = fftPlan->tmpBufSize + fftPlan->tmpBufSizeRC +
+                        fftPlan->tmpBufSizeC2R;
+    plan.kernellib = plan.hasKernel ? fftPlan->kernellib : std::string();
+    info.push_back(plan);
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+    subPlans[8] = fftPlan->planConvFwd;
+    subPlans[9] = fftPlan->planConvBack;
+    subPlans[10] = fftPlan->planStreamXY;
+    subPlans[11] = fftPlan->planStreamZ;
+    subPlans[12] = fftPlan->hybridPlan;
+
+    for (int i = 0; i < 4; i++) {
+      subPlans[13 + i] = fftPlan->planR2R[i];
+    }
+
+    subPlans[17] = fftPlan->planHostBatch;
   }
 
-  if (fftPlan->planTY) {
-    hcfftDestroyPlan(&fftPlan->planTY);
+  for (int i = 0; i < 18; i++) {
+    if (subPlans[i]) {
+      hcfftGetPlanInfo(subPlans[i], depth + 1, names[i], info);
+    }
   }
 
-  if (fftPlan->planTZ) {
-    hcfftDestroyPlan(&fftPlan->planTZ);
-  }
+  return HCFFT_SUCCEEDS;
+}
 
-  if (fftPlan->planRCcopy) {
-    hcfftDestroyPlan(&fftPlan->planRCcopy);
-  }
+hcfftStatus FFTPlan::hcfftGetPlanTimings(
+    hcfftPlanHandle plHandle, size_t depth,
+    std::vector<std::pair<size_t, FFTPlanTimings> >& timings) {
+  FFTRepo& fftRepo = FFTRepo::getInstance();
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
 
-  if (fftPlan->planCopy) {
-    hcfftDestroyPlan(&fftPlan->planCopy);
+  if (fftRepo.getPlan(plHandle, fftPlan, planLock) != HCFFT_SUCCEEDS) {
+    return HCFFT_INVALID;
   }
 
-  fftPlan->ReleaseBuffers();
+  hcfftPlanHandle subPlans[8];
+  {
+    scopedLock sLock(*planLock, _T("hcfftGetPlanTimings"));
+    timings.push_back(std::make_pair(depth, fftPlan->timings));
+    subPlans[0] = fftPlan->planX;
+    subPlans[1] = fftPlan->planY;
+    subPlans[2] = fftPlan->planZ;
+    subPlans[3] = fftPlan->planTX;
+    subPlans[4] = fftPlan->planTY;
+    subPlans[5] = fftPlan->planTZ;
+    subPlans[6] = fftPlan->planRCcopy;
+    subPlans[7] = fftPlan->planCopy;
+  }
 
-  if (kernelHandle) {
-    if (dlclose(kernelHandle)) {
-      char* err = dlerror();
-      std::cout << " Failed to close KernHandle " << err;
-      free(err);
-      exit(1);
+  for (int i = 0; i < 8; i++) {
+    if (subPlans[i]) {
+      hcfftGetPlanTimings(subPlans[i], depth + 1, timings);
     }
-
-    kernelHandle = NULL;
   }
 
-  fftRepo.deletePlan(plHandle);
   return HCFFT_SUCCEEDS;
 }
 
 hcfftStatus FFTPlan::ReleaseBuffers() {
   hcfftStatus result = HCFFT_SUCCEEDS;
+  launchesFwd.clear();
+  launchesBack.clear();
+
+  // Transforms may still be queued
+  if (intBuffer || intBufferRC || intBufferC2R || twiddles || twiddleslarge ||
+      chirps || r2rTwiddles || convStream) {
+    acc_view.wait();
+  }
 
   if (NULL != intBuffer) {
-    if (hc::am_free(intBuffer) != AM_SUCCESS) {
+    if (!InWorkArea(intBuffer) &&
+        gaugedFree(intBuffer, hcfftCounters.scratchBytes) != AM_SUCCESS) {
       return HCFFT_INVALID;
     }
 
@@ -6122,7 +13790,8 @@ hcfftStatus FFTPlan::ReleaseBuffers() {
   }
 
   if (NULL != intBufferRC) {
-    if (hc::am_free(intBufferRC) != AM_SUCCESS) {
+    if (!InWorkArea(intBufferRC) &&
+        gaugedFree(intBufferRC, hcfftCounters.scratchBytes) != AM_SUCCESS) {
       return HCFFT_INVALID;
     }
 
@@ -6130,15 +13799,27 @@ hcfftStatus FFTPlan::ReleaseBuffers() {
   }
 
   if (NULL != intBufferC2R) {
-    if (hc::am_free(intBufferC2R) != AM_SUCCESS) {
+    if (!InWorkArea(intBufferC2R) &&
+        gaugedFree(intBufferC2R, hcfftCounters.scratchBytes) != AM_SUCCESS) {
       return HCFFT_INVALID;
     }
 
     intBufferC2R = NULL;
   }
 
+  if (NULL != validPartials) {
+    acc_view.wait();
+
+    if (gaugedFree(validPartials, hcfftCounters.scratchBytes) != AM_SUCCESS) {
+      return HCFFT_INVALID;
+    }
+
+    validPartials = NULL;
+    validBatch = 0;
+  }
+
   if (NULL != twiddles) {
-    if (hc::am_free(twiddles) != AM_SUCCESS) {
+    if (FFTRepo::getInstance().releaseTwiddles(twiddles) != HCFFT_SUCCEEDS) {
       return HCFFT_INVALID;
     }
 
@@ -6146,16 +13827,137 @@ hcfftStatus FFTPlan::ReleaseBuffers() {
   }
 
   if (NULL != twiddleslarge) {
-    if (hc::am_free(twiddleslarge) != AM_SUCCESS) {
+    if (FFTRepo::getInstance().releaseTwiddles(twiddleslarge) !=
+        HCFFT_SUCCEEDS) {
       return HCFFT_INVALID;
     }
 
     twiddleslarge = NULL;
   }
 
+  if (NULL != chirps) {
+    if (gaugedFree(chirps, hcfftCounters.twiddleBytes) != AM_SUCCESS) {
+      return HCFFT_INVALID;
+    }
+
+    chirps = NULL;
+  }
+
+  if (NULL != r2rTwiddles) {
+    if (gaugedFree(r2rTwiddles, hcfftCounters.twiddleBytes) != AM_SUCCESS) {
+      return HCFFT_INVALID;
+    }
+
+    r2rTwiddles = NULL;
+  }
+
+  if (NULL != convStream) {
+    if (gaugedFree(convStream, hcfftCounters.scratchBytes) != AM_SUCCESS) {
+      return HCFFT_INVALID;
+    }
+
+    convStream = NULL;
+  }
+
   return result;
 }
 
+bool FFTPlan::InWorkArea(const void* buffer) const {
+  const char* area = static_cast<const char*>(workArea);
+  const char* p = static_cast<const char*>(buffer);
+  return (area != NULL) && (p >= area) && (p < area + workAreaSize);
+}
+
+//  The buffer at the same offset in the work area of the current call, for
+//  buffers of a launch recorded in workArea
+void* FFTPlan::CallBuffer(void* buffer) const {
+  if (callWorkArea == NULL || !InWorkArea(buffer)) {
+    return buffer;
+  }
+
+  return static_cast<char*>(callWorkArea) +
+         (static_cast<char*>(buffer) - static_cast<char*>(workArea));
+}
+
+//  Chunks of the batch start at a multiple of the distance of the plan, which
+//  holds for a single kernel over a 1D batch in a layout with one buffer.
+//  Only Stockham kernels size their grid from the batch they are launched
+//  with (GridExtent), so a chunk runs no transform past its end; the grid of
+//  the other generators is compiled in. Callbacks get offsets from the start
+//  of the buffer, so their plans are not split.
+bool FFTPlan::CanSplitBatch(const std::vector<hcfftLaunch>& launches) const {
+  if (splitViews.size() < 2 || !CanRebatch(launches) ||
+      launches[0].batch < 2) {
+    return false;
+  }
+
+  for (size_t i = 0; i < splitViews.size(); i++) {
+    if (!(splitViews[i].get_accelerator() == acc)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool FFTPlan::CanRebatch(const std::vector<hcfftLaunch>& launches) const {
+  if (launches.size() != 1 || launches[0].plan != this) {
+    return false;
+  }
+
+  if (dimension != HCFFT_1D || length.size() != 1 || gen != Stockham) {
+    return false;
+  }
+
+  if (!loadCallback.empty() || !storeCallback.empty()) {
+    return false;
+  }
+
+  bool ipSingle = (ipLayout == HCFFT_COMPLEX_INTERLEAVED) ||
+                  (ipLayout == HCFFT_HERMITIAN_INTERLEAVED) ||
+                  (ipLayout == HCFFT_REAL);
+  bool opSingle = (opLayout == HCFFT_COMPLEX_INTERLEAVED) ||
+                  (opLayout == HCFFT_HERMITIAN_INTERLEAVED) ||
+                  (opLayout == HCFFT_REAL);
+
+  return ipSingle && opSingle;
+}
+
+void FFTPlan::EnqueueSplitBatch(const hcfftLaunch& launch, void* input,
+                                void* output) {
+  size_t count = std::min<size_t>(splitViews.size(), launch.batch);
+  size_t inBytes = iDist * ElementSize() / ((ipLayout == HCFFT_REAL) ? 2 : 1);
+  size_t outBytes =
+      oDist * ElementSize() / ((opLayout == HCFFT_REAL) ? 2 : 1);
+  hc::completion_future queued = acc_view.create_marker();
+  size_t first = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    uint chunk = launch.batch / count + ((i < launch.batch % count) ? 1 : 0);
+
+    for (unsigned int j = 0; j < kernelArgIn; j++) {
+      kernelArgs.buffers[j] = static_cast<char*>(input) + first * inBytes;
+    }
+
+    for (unsigned int j = 0; j < kernelArgOut; j++) {
+      kernelArgs.buffers[kernelArgIn + j] =
+          static_cast<char*>(output) + first * outBytes;
+    }
+
+    splitViews[i].create_blocking_marker(queued);
+    {
+      HCFFT_TRACE_RANGE("hcfft plan " << plHandleOrigin << " plan "
+                                      << GeneratorName(gen) << " view " << i);
+      launch.call(&kernelArgs, chunk, splitViews[i], acc);
+    }
+
+    hcfftCounters.launches++;
+    hc::completion_future done = splitViews[i].create_marker();
+    acc_view.create_blocking_marker(done);
+    first += chunk;
+  }
+}
+
 size_t FFTPlan::ElementSize() const {
   return ((precision == HCFFT_DOUBLE) ? sizeof(std::complex<double>)
                                       : sizeof(std::complex<float>));
@@ -6165,7 +13967,6 @@ size_t FFTPlan::ElementSize() const {
 
 /*---------------------------FFTRepo-----------------------------------*/
 hcfftStatus FFTRepo::createPlan(hcfftPlanHandle* plHandle, FFTPlan*& fftPlan) {
-  scopedLock sLock(lockRepo, _T("insertPlan"));
   //  We keep track of this memory in our own collection class, to make sure
   //  it's freed in releaseResources
   //  The lifetime of a plan is tracked by the client and is freed when the
@@ -6175,22 +13976,28 @@ hcfftStatus FFTRepo::createPlan(hcfftPlanHandle* plHandle, FFTPlan*& fftPlan) {
   //  ::hcfftDestroyPlan();
   //  The lifetime of the lock is the same as the lifetime of the plan
   lockRAII* lockPlan = new lockRAII;
-  //  Add and remember the fftPlan in our map
-  repoPlans[planCount] = std::make_pair(fftPlan, lockPlan);
   //  Assign the user handle the plan count (unique identifier), and bump the
   //  count for the next plan
-  *plHandle = planCount++;
+  hcfftPlanHandle handle = planCount++;
+  //  Add and remember the fftPlan in the map of its shard
+  {
+    repoPlansShard& shard = planShard(handle);
+    scopedWriteLock sLock(shard.lock);
+    shard.plans[handle] = std::make_pair(fftPlan, lockPlan);
+  }
+  *plHandle = handle;
   return HCFFT_SUCCEEDS;
 }
 
 hcfftStatus FFTRepo::getPlan(hcfftPlanHandle plHandle, FFTPlan*& fftPlan,
                              lockRAII*& planLock) {
-  scopedLock sLock(lockRepo, _T("getPlan"));
+  repoPlansShard& shard = planShard(plHandle);
+  scopedReadLock sLock(shard.lock);
   //  First, check if we have already created a plan with this exact same
   //  FFTPlan
-  repoPlansType::iterator iter = repoPlans.find(plHandle);
+  repoPlansType::iterator iter = shard.plans.find(plHandle);
 
-  if (iter == repoPlans.end()) {
+  if (iter == shard.plans.end()) {
     return HCFFT_ERROR;
   }
 
@@ -6201,36 +14008,41 @@ hcfftStatus FFTRepo::getPlan(hcfftPlanHandle plHandle, FFTPlan*& fftPlan,
 }
 
 hcfftStatus FFTRepo::deletePlan(hcfftPlanHandle* plHandle) {
-  scopedLock sLock(lockRepo, _T("deletePlan"));
-  //  First, check if we have already created a plan with this exact same
-  //  FFTPlan
-  repoPlansType::iterator iter = repoPlans.find(*plHandle);
+  repoPlansValue value;
+  //  Remove the entry from the map of its shard first, so that the shard is
+  //  not held while the plan lock is waited for
+  {
+    repoPlansShard& shard = planShard(*plHandle);
+    scopedWriteLock sLock(shard.lock);
+    repoPlansType::iterator iter = shard.plans.find(*plHandle);
 
-  if (iter == repoPlans.end()) {
-    return HCFFT_ERROR;
+    if (iter == shard.plans.end()) {
+      return HCFFT_ERROR;
+    }
+
+    value = iter->second;
+    shard.plans.erase(iter);
   }
 
   //  We lock the plan object while we are in the process of deleting it
   {
-    scopedLock sLock(*iter->second.second, _T("hcfftDestroyPlan"));
+    scopedLock sLock(*value.second, _T("hcfftDestroyPlan"));
     //  Delete the FFTPlan
-    delete iter->second.first;
+    delete value.first;
   }
   //  Delete the lockRAII
-  delete iter->second.second;
-  //  Remove entry from our map object
-  repoPlans.erase(iter);
+  delete value.second;
   //  Clear the client's handle to signify that the plan is gone
   *plHandle = 0;
   return HCFFT_SUCCEEDS;
 }
 
 hcfftStatus FFTRepo::setProgramEntryPoints(
-    const hcfftGenerators gen, const hcfftPlanHandle& handle,
+    const hcfftGenerators gen, const size_t kernelId,
     const FFTKernelGenKeyParams& fftParam, const char* kernel_fwd,
     const char* kernel_back) {
   scopedLock sLock(lockRepo, _T("setProgramEntryPoints"));
-  fftRepoKey key = std::make_pair(gen, handle);
+  fftRepoKey key = std::make_pair(gen, kernelId);
   fftRepoValue& fft = mapFFTs[key];
   fft.EntryPoint_fwd = kernel_fwd;
   fft.EntryPoint_back = kernel_back;
@@ -6238,12 +14050,12 @@ hcfftStatus FFTRepo::setProgramEntryPoints(
 }
 
 hcfftStatus FFTRepo::getProgramEntryPoint(const hcfftGenerators gen,
-                                          const hcfftPlanHandle& handle,
+                                          const size_t kernelId,
                                           const FFTKernelGenKeyParams& fftParam,
                                           hcfftDirection dir,
                                           std::string& kernel) {
   scopedLock sLock(lockRepo, _T("getProgramEntryPoint"));
-  fftRepoKey key = std::make_pair(gen, handle);
+  fftRepoKey key = std::make_pair(gen, kernelId);
   fftRepo_iterator pos = mapFFTs.find(key);
 
   if (pos == mapFFTs.end()) {
@@ -6272,11 +14084,11 @@ hcfftStatus FFTRepo::getProgramEntryPoint(const hcfftGenerators gen,
 }
 
 hcfftStatus FFTRepo::setProgramCode(const hcfftGenerators gen,
-                                    const hcfftPlanHandle& handle,
+                                    const size_t kernelId,
                                     const FFTKernelGenKeyParams& fftParam,
                                     const std::string& kernel) {
   scopedLock sLock(lockRepo, _T("setProgramCode"));
-  fftRepoKey key = std::make_pair(gen, handle);
+  fftRepoKey key = std::make_pair(gen, kernelId);
   // Prefix copyright statement at the top of generated kernels
   std::stringstream ss;
   ss << "/* "
@@ -6295,11 +14107,11 @@ hcfftStatus FFTRepo::setProgramCode(const hcfftGenerators gen,
 }
 
 hcfftStatus FFTRepo::getProgramCode(const hcfftGenerators gen,
-                                    const hcfftPlanHandle& handle,
+                                    const size_t kernelId,
                                     const FFTKernelGenKeyParams& fftParam,
                                     std::string& kernel) {
   scopedLock sLock(lockRepo, _T("getProgramCode"));
-  fftRepoKey key = std::make_pair(gen, handle);
+  fftRepoKey key = std::make_pair(gen, kernelId);
   fftRepo_iterator pos = mapFFTs.find(key);
 
   if (pos == mapFFTs.end()) {
@@ -6310,24 +14122,424 @@ hcfftStatus FFTRepo::getProgramCode(const hcfftGenerators gen,
   return HCFFT_SUCCEEDS;
 }
 
+hcfftStatus FFTRepo::acquireKernelLib(const std::string& kernellib,
+                                      void*& handle) {
+  scopedLock sLock(lockRepo, _T("acquireKernelLib"));
+  kernelLibsType::iterator iter = kernelLibs.find(kernellib);
+
+  if (iter != kernelLibs.end()) {
+    iter->second.second++;
+    handle = iter->second.first;
+    return HCFFT_SUCCEEDS;
+  }
+
+  handle = dlopen(kernellib.c_str(), RTLD_NOW);
+
+  if (!handle) {
+    std::cout << "Failed to load Kernel: " << kernellib << " " << dlerror()
+              << std::endl;
+    return HCFFT_ERROR;
+  }
+
+  kernelLibs[kernellib] = std::make_pair(handle, (size_t)1);
+  hcfftCounters.dlopens++;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::releaseKernelLib(void* handle) {
+  scopedLock sLock(lockRepo, _T("releaseKernelLib"));
+
+  for (kernelLibsType::iterator iter = kernelLibs.begin();
+       iter != kernelLibs.end(); ++iter) {
+    if (iter->second.first != handle) {
+      continue;
+    }
+
+    if (--iter->second.second == 0) {
+      if (dlclose(handle)) {
+        std::cout << " Failed to close KernHandle " << dlerror() << std::endl;
+      }
+
+      kernelLibs.erase(iter);
+    }
+
+    return HCFFT_SUCCEEDS;
+  }
+
+  return HCFFT_ERROR;
+}
+
+hcfftStatus FFTRepo::acquireKernel(const hcfftGenerators gen,
+                                   const size_t kernelId,
+                                   std::string& kernellib,
+                                   FFTPlan::FUNC_FFTFwd*& kernelPtr,
+                                   FFTPlan::FUNC_FFTFwd*& kernelPtrBack) {
+  scopedLock sLock(lockRepo, _T("acquireKernel"));
+  fftRepoKey key = std::make_pair(gen, kernelId);
+  fftRepo_iterator pos = mapFFTs.find(key);
+
+  if (pos == mapFFTs.end() || pos->second.kernelHandle == NULL) {
+    return HCFFT_ERROR;
+  }
+
+  pos->second.refCount++;
+  kernellib = pos->second.kernellib;
+  kernelPtr = pos->second.kernelPtr;
+  kernelPtrBack = pos->second.kernelPtrBack;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::loadKernel(const hcfftGenerators gen,
+                                const size_t kernelId,
+                                const std::string& kernellib,
+                                const std::string& fwdName,
+                                const std::string& backName,
+                                FFTPlan::FUNC_FFTFwd*& kernelPtr,
+                                FFTPlan::FUNC_FFTFwd*& kernelPtrBack) {
+  scopedLock sLock(lockRepo, _T("loadKernel"));
+  std::string lib;
+
+  //  Another leaf of the same bake may have loaded it already
+  if (acquireKernel(gen, kernelId, lib, kernelPtr, kernelPtrBack) ==
+      HCFFT_SUCCEEDS) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  void* handle = NULL;
+
+  if (acquireKernelLib(kernellib, handle) != HCFFT_SUCCEEDS) {
+    return HCFFT_ERROR;
+  }
+
+  kernelPtr = (FFTPlan::FUNC_FFTFwd*)dlsym(handle, fwdName.c_str());
+  kernelPtrBack = (FFTPlan::FUNC_FFTFwd*)dlsym(handle, backName.c_str());
+
+  if (kernelPtr == NULL && kernelPtrBack == NULL) {
+    std::cout << "failed to locate " << fwdName << "(): " << dlerror()
+              << std::endl;
+    releaseKernelLib(handle);
+    return HCFFT_ERROR;
+  }
+
+  fftRepoValue& fft = mapFFTs[std::make_pair(gen, kernelId)];
+  fft.kernellib = kernellib;
+  fft.kernelHandle = handle;
+  fft.kernelPtr = kernelPtr;
+  fft.kernelPtrBack = kernelPtrBack;
+  fft.refCount = 1;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::releaseKernel(const hcfftGenerators gen,
+                                   const size_t kernelId) {
+  scopedLock sLock(lockRepo, _T("releaseKernel"));
+  fftRepo_iterator pos = mapFFTs.find(std::make_pair(gen, kernelId));
+
+  if (pos == mapFFTs.end() || pos->second.refCount == 0) {
+    return HCFFT_ERROR;
+  }
+
+  if (--pos->second.refCount == 0) {
+    releaseKernelLib(pos->second.kernelHandle);
+    mapFFTs.erase(pos);
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::acquireScratch(hc::accelerator_view& acc_view,
+                                    hcfftScratchPool*& pool) {
+  scopedLock sLock(lockRepo, _T("acquireScratch"));
+  void* queue = acc_view.get_hsa_queue();
+  scratchPoolsType::iterator iter = scratchPools.find(queue);
+
+  if (iter == scratchPools.end()) {
+    pool = new hcfftScratchPool(acc_view);
+    pool->queue = queue;
+    scratchPools[queue] = pool;
+  } else {
+    pool = iter->second;
+  }
+
+  pool->users++;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::growScratch(hcfftScratchPool* pool, size_t size) {
+  if (size <= pool->size) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  // Transforms queued with the old buffer may still use it
+  if (pool->buffer != NULL) {
+    pool->acc_view.wait();
+
+    if (gaugedFree(pool->buffer, hcfftCounters.scratchBytes) != AM_SUCCESS) {
+      return HCFFT_ERROR;
+    }
+  }
+
+  hc::accelerator acc = pool->acc_view.get_accelerator();
+  pool->buffer = gaugedAlloc(size, acc, hcfftCounters.scratchBytes);
+  pool->size = (pool->buffer != NULL) ? size : 0;
+  pool->generation++;
+  return (pool->buffer != NULL) ? HCFFT_SUCCEEDS : HCFFT_ERROR;
+}
+
+hcfftStatus FFTRepo::releaseScratch(hcfftScratchPool* pool) {
+  scopedLock sLock(lockRepo, _T("releaseScratch"));
+
+  if (pool->users == 0 || --pool->users > 0) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  if (pool->buffer != NULL) {
+    pool->acc_view.wait();
+    gaugedFree(pool->buffer, hcfftCounters.scratchBytes);
+  }
+
+  scratchPools.erase(pool->queue);
+  delete pool;
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::acquireTwiddles(const hc::accelerator& acc,
+                                     const std::vector<size_t>& shape,
+                                     void*& table) {
+  scopedLock sLock(lockRepo, _T("acquireTwiddles"));
+  twiddlesType::iterator iter =
+      twiddleTables.find(twiddleKey(acc.get_device_path(), shape));
+  table = NULL;
+
+  if (iter != twiddleTables.end()) {
+    table = iter->second.first;
+    iter->second.second++;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::addTwiddles(const hc::accelerator& acc,
+                                 const std::vector<size_t>& shape,
+                                 void* table) {
+  scopedLock sLock(lockRepo, _T("addTwiddles"));
+  twiddleKey key(acc.get_device_path(), shape);
+
+  if (twiddleTables.find(key) != twiddleTables.end()) {
+    return HCFFT_INVALID;
+  }
+
+  twiddleTables[key] = std::make_pair(table, static_cast<size_t>(1));
+  twiddleKeys[table] = key;
+  hcfftCounters.twiddleBytes += deviceBytes(table);
+  return HCFFT_SUCCEEDS;
+}
+
+hcfftStatus FFTRepo::releaseTwiddles(void* table) {
+  scopedLock sLock(lockRepo, _T("releaseTwiddles"));
+  std::map<void*, twiddleKey>::iterator key = twiddleKeys.find(table);
+
+  // Not a cached table
+  if (key == twiddleKeys.end()) {
+    return (hc::am_free(table) == AM_SUCCESS) ? HCFFT_SUCCEEDS : HCFFT_INVALID;
+  }
+
+  twiddlesType::iterator iter = twiddleTables.find(key->second);
+
+  if (--iter->second.second > 0) {
+    return HCFFT_SUCCEEDS;
+  }
+
+  twiddleTables.erase(iter);
+  twiddleKeys.erase(key);
+  return (gaugedFree(table, hcfftCounters.twiddleBytes) == AM_SUCCESS)
+             ? HCFFT_SUCCEEDS
+             : HCFFT_INVALID;
+}
+
+bool FFTRepo::getTwiddleShape(void* table, std::vector<size_t>& shape) {
+  scopedLock sLock(lockRepo, _T("getTwiddleShape"));
+  std::map<void*, twiddleKey>::iterator key = twiddleKeys.find(table);
+
+  if (key == twiddleKeys.end()) {
+    return false;
+  }
+
+  shape = key->second.second;
+  return true;
+}
+
+bool FFTRepo::getTuning(size_t signature, hcfftKernelTuning& tuning) {
+  scopedLock sLock(lockRepo, _T("getTuning"));
+  std::map<size_t, hcfftKernelTuning>::iterator iter = tunings.find(signature);
+
+  if (iter == tunings.end()) {
+    return false;
+  }
+
+  tuning = iter->second;
+  return true;
+}
+
+hcfftStatus FFTRepo::setTuning(size_t signature,
+                               const hcfftKernelTuning& tuning) {
+  scopedLock sLock(lockRepo, _T("setTuning"));
+  tunings[signature] = tuning;
+  return HCFFT_SUCCEEDS;
+}
+
+//  Wisdom files start with a header line of the format version; each tuning
+//  is then a line of the signature in hex, the work-group size, transforms
+//  per work-group and LDS layout, with the description as a comment
+static const char* const wisdomHeader = "hcfft-wisdom 1";
+
+hcfftStatus FFTRepo::exportTunings(const std::string& path) {
+  scopedLock sLock(lockRepo, _T("exportTunings"));
+  FILE* file = fopen(path.c_str(), "w");
+
+  if (file == NULL) {
+    return HCFFT_INVALID;
+  }
+
+  bool written = fprintf(file, "%s\n", wisdomHeader) > 0;
+
+  for (std::map<size_t, hcfftKernelTuning>::iterator iter = tunings.begin();
+       written && iter != tunings.end(); ++iter) {
+    const hcfftKernelTuning& tuning = iter->second;
+    written = fprintf(file, "%016llx %zu %zu %d # %s\n",
+                      (unsigned long long)iter->first, tuning.workGroupSize,
+                      tuning.numTrans, tuning.ldsComplex ? 1 : 0,
+                      tuning.description.c_str()) > 0;
+  }
+
+  written = (fclose(file) == 0) && written;
+  return written ? HCFFT_SUCCEEDS : HCFFT_ERROR;
+}
+
+hcfftStatus FFTRepo::importTunings(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "r");
+
+  if (file == NULL) {
+    return HCFFT_INVALID;
+  }
+
+  std::map<size_t, hcfftKernelTuning> wisdom;
+  std::string line;
+  char chunk[256];
+  bool header = false, parsed = true;
+
+  while (parsed && fgets(chunk, sizeof(chunk), file) != NULL) {
+    line += chunk;
+
+    if (line[line.size() - 1] != '\n' && !feof(file)) {
+      continue;
+    }
+
+    while (!line.empty() &&
+           (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r')) {
+      line.erase(line.size() - 1);
+    }
+
+    if (!header) {
+      header = parsed = (line == wisdomHeader);
+    } else if (!line.empty() && line[0] != '#') {
+      unsigned long long signature;
+      size_t workGroupSize, numTrans;
+      int ldsComplex, used = 0;
+      parsed = (sscanf(line.c_str(), "%llx %zu %zu %d %n", &signature,
+                       &workGroupSize, &numTrans, &ldsComplex, &used) == 4) &&
+               (ldsComplex == 0 || ldsComplex == 1) &&
+               (line[used] == '\0' || line[used] == '#');
+
+      if (parsed) {
+        hcfftKernelTuning& tuning = wisdom[(size_t)signature];
+        tuning.workGroupSize = workGroupSize;
+        tuning.numTrans = numTrans;
+        tuning.ldsComplex = (ldsComplex == 1);
+        size_t start = line.find_first_not_of("# ", used);
+        tuning.description =
+            (start == std::string::npos) ? "" : line.substr(start);
+      }
+    }
+
+    line.clear();
+  }
+
+  parsed = parsed && header && !ferror(file);
+  fclose(file);
+
+  if (!parsed) {
+    return HCFFT_ERROR;
+  }
+
+  scopedLock sLock(lockRepo, _T("importTunings"));
+
+  for (std::map<size_t, hcfftKernelTuning>::iterator iter = wisdom.begin();
+       iter != wisdom.end(); ++iter) {
+    tunings[iter->first] = iter->second;
+  }
+
+  return HCFFT_SUCCEEDS;
+}
+
+bool FFTRepo::claimKernelBuild(const std::string& key,
+                               std::shared_ptr<hcfftKernelBuild>& build) {
+  scopedLock sLock(lockRepo, _T("claimKernelBuild"));
+  kernelBuildsType::iterator pos = kernelBuilds.find(key);
+
+  if (pos != kernelBuilds.end()) {
+    build = pos->second;
+    return false;
+  }
+
+  build = std::make_shared<hcfftKernelBuild>();
+  kernelBuilds[key] = build;
+  return true;
+}
+
+void FFTRepo::settleKernelBuild(const std::string& key,
+                                const std::shared_ptr<hcfftKernelBuild>& build,
+                                hcfftStatus status) {
+  scopedLock sLock(lockRepo, _T("settleKernelBuild"));
+
+  if (build->settled) {
+    return;
+  }
+
+  build->settled = true;
+  build->promise.set_value(status);
+  kernelBuildsType::iterator pos = kernelBuilds.find(key);
+
+  // A later claim of the key is left in place
+  if (pos != kernelBuilds.end() && pos->second == build) {
+    kernelBuilds.erase(pos);
+  }
+}
+
 hcfftStatus FFTRepo::releaseResources() {
   scopedLock sLock(lockRepo, _T("releaseResources"));
 
   //  Free all memory allocated in the repoPlans; represents cached plans that
   //  were not destroyed by the client
   //
-  for (repoPlansType::iterator iter = repoPlans.begin();
-       iter != repoPlans.end(); ++iter) {
-    FFTPlan* plan = iter->second.first;
-    lockRAII* lock = iter->second.second;
+  for (size_t i = 0; i < planShards; i++) {
+    scopedWriteLock sShardLock(repoPlans[i].lock);
 
-    if (plan != NULL) {
-      delete plan;
-    }
+    for (repoPlansType::iterator iter = repoPlans[i].plans.begin();
+         iter != repoPlans[i].plans.end(); ++iter) {
+      FFTPlan* plan = iter->second.first;
+      lockRAII* lock = iter->second.second;
 
-    if (lock != NULL) {
-      delete lock;
+      if (plan != NULL) {
+        delete plan;
+      }
+
+      if (lock != NULL) {
+        delete lock;
+      }
     }
+
+    repoPlans[i].plans.clear();
   }
 
   //  Reset the plan count to zero because we are guaranteed to have destroyed
@@ -6335,6 +14547,8 @@ hcfftStatus FFTRepo::releaseResources() {
   planCount = 1;
   //  Release all strings
   mapFFTs.clear();
+  twiddleTables.clear();
+  twiddleKeys.clear();
   return HCFFT_SUCCEEDS;
 }
 /*-----------------------FFTRepo------------------------------*/
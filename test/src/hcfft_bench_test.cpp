@@ -0,0 +1,980 @@
+/*
+Copyright (c) 2015-2016 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+//  Sweeps the transforms of the C API over dimension, length, batch,
+//  precision, type and placeness, timing each exec between two markers of
+//  the accelerator_view of the plan. Usage:
+//
+//    hcfft_bench [-s | -r [-p GB/s,GFLOPS]] [-i iterations] [-m max_elements]
+//                [-d dims] [-c csv] [-j json]
+//
+//  dims is a list of the dimensions to sweep, such as 12 for 1D and 2D, and
+//  max_elements caps the elements of a batch. Flops are counted as
+//  5 N log2 N per complex transform of N elements, half that for real ones,
+//  and bytes as one read of the input and one write of the output.
+//
+//  -s measures startup instead: the wall time from hcfftPlan*d to the end
+//  of the first exec with an empty kernel cache, with the kernels on disk
+//  only, and with them loaded by another plan of the process, and then how
+//  many plans threads create and bake per second from a warm disk cache.
+//
+//  -r profiles the kernels of the single-precision transforms instead, and
+//  places each on the roofline of the GPU: its fraction of the bandwidth of
+//  a device copy, and for Stockham kernels of the lesser of the peak FLOPs
+//  and what that bandwidth feeds at their flops per byte. Kernels under
+//  30% of their roofline are flagged, and the time lost to the roofline is
+//  summed by generator. -p sets the peaks instead of measuring them.
+
+#include "include/hcfft.h"
+#include "include/hcfftlib.h"
+#include <hc.hpp>
+#include <hc_am.hpp>
+#include <hsa/hsa.h>
+#include <hsa/hsa_ext_amd.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum benchKind { BENCH_C2C, BENCH_R2C, BENCH_C2R };
+
+struct benchCase {
+  int rank;
+  int n[3];
+  int batch;
+  bool dbl;
+  benchKind kind;
+  bool inplace;
+};
+
+struct benchResult {
+  benchCase c;
+  double median;
+  double p99;
+  double gflops;
+  double gbps;
+};
+
+//  A kernel of a profiled transform, at its median time. roof is its
+//  fraction of the roofline.
+struct kernelResult {
+  benchCase c;
+  std::string role;
+  std::string kernel;
+  double seconds;
+  double gbps;
+  double gflops;
+  double roof;
+};
+
+static const char* kindName(const benchCase& c) {
+  static const char* const names[2][3] = {{"C2C", "R2C", "C2R"},
+                                          {"Z2Z", "D2Z", "Z2D"}};
+  return names[c.dbl][c.kind];
+}
+
+static std::string lengthName(const benchCase& c) {
+  std::string name;
+
+  for (int i = 0; i < c.rank; i++) {
+    char length[16];
+    snprintf(length, sizeof(length), "%s%d", i ? "x" : "", c.n[i]);
+    name += length;
+  }
+
+  return name;
+}
+
+static size_t elements(const benchCase& c) {
+  size_t count = 1;
+
+  for (int i = 0; i < c.rank; i++) {
+    count *= c.n[i];
+  }
+
+  return count;
+}
+
+//  Complex elements of the Hermitian side of a real transform
+static size_t halfElements(const benchCase& c) {
+  return elements(c) / c.n[0] * (c.n[0] / 2 + 1);
+}
+
+static hcfftType planType(const benchCase& c) {
+  static const hcfftType types[2][3] = {{HCFFT_C2C, HCFFT_R2C, HCFFT_C2R},
+                                        {HCFFT_Z2Z, HCFFT_D2Z, HCFFT_Z2D}};
+  return types[c.dbl][c.kind];
+}
+
+//  Plans of packed data; the real side of in-place real transforms is padded
+//  to the Hermitian one
+static hcfftResult createPlan(const benchCase& c, hcfftHandle* plan) {
+  int n[3], real[3], half[3];
+
+  for (int i = 0; i < c.rank; i++) {
+    n[i] = c.n[i];
+    real[i] = n[i];
+    half[i] = n[i];
+  }
+
+  half[0] = c.n[0] / 2 + 1;
+  real[0] = c.inplace ? 2 * half[0] : c.n[0];
+  int realDist = elements(c) / c.n[0] * real[0];
+  int halfDist = halfElements(c);
+
+  switch (c.kind) {
+    case BENCH_R2C:
+      return hcfftPlanMany(plan, c.rank, n, real, 1, realDist, half, 1,
+                           halfDist, planType(c), c.batch);
+
+    case BENCH_C2R:
+      return hcfftPlanMany(plan, c.rank, n, half, 1, halfDist, real, 1,
+                           realDist, planType(c), c.batch);
+
+    default:
+      return hcfftPlanMany(plan, c.rank, n, NULL, 1, 0, NULL, 1, 0,
+                           planType(c), c.batch);
+  }
+}
+
+static hcfftResult exec(const benchCase& c, hcfftHandle plan, void* in,
+                        void* out) {
+  if (!c.dbl) {
+    switch (c.kind) {
+      case BENCH_R2C:
+        return hcfftExecR2C(plan, (hcfftReal*)in, (hcfftComplex*)out);
+
+      case BENCH_C2R:
+        return hcfftExecC2R(plan, (hcfftComplex*)in, (hcfftReal*)out);
+
+      default:
+        return hcfftExecC2C(plan, (hcfftComplex*)in, (hcfftComplex*)out,
+                            HCFFT_FORWARD);
+    }
+  }
+
+  switch (c.kind) {
+    case BENCH_R2C:
+      return hcfftExecD2Z(plan, (hcfftDoubleReal*)in,
+                          (hcfftDoubleComplex*)out);
+
+    case BENCH_C2R:
+      return hcfftExecZ2D(plan, (hcfftDoubleComplex*)in,
+                          (hcfftDoubleReal*)out);
+
+    default:
+      return hcfftExecZ2Z(plan, (hcfftDoubleComplex*)in,
+                          (hcfftDoubleComplex*)out, HCFFT_FORWARD);
+  }
+}
+
+//  Bytes of the input and the output of a batch, as the plan lays them out
+static void bufferBytes(const benchCase& c, size_t* in, size_t* out) {
+  size_t real = c.dbl ? sizeof(double) : sizeof(float);
+  size_t complexBytes = 2 * real * (c.kind == BENCH_C2C ? elements(c)
+                                                        : halfElements(c));
+  size_t realBytes = real * (c.inplace ? 2 * halfElements(c) : elements(c));
+  *in = c.batch * (c.kind == BENCH_R2C ? realBytes : complexBytes);
+  *out = c.batch * (c.kind == BENCH_C2R ? realBytes : complexBytes);
+}
+
+//  Device buffers of a case, the input filled; in and out are NULL when they
+//  could not be allocated
+static void allocBuffers(const benchCase& c, hc::accelerator& acc,
+                         hc::accelerator_view& view, void** in, void** out) {
+  size_t inBytes, outBytes;
+  bufferBytes(c, &inBytes, &outBytes);
+  size_t bytes = c.inplace ? std::max(inBytes, outBytes) : inBytes;
+  std::vector<char> host(bytes, 0);
+
+  // Small values keep repeated in-place transforms finite
+  for (size_t i = 0; i + sizeof(float) <= bytes; i += sizeof(float)) {
+    float value = (i / sizeof(float)) % 7 * 1e-3f;
+    memcpy(&host[i], &value, sizeof(float));
+  }
+
+  *in = hc::am_alloc(bytes, acc, 0);
+  *out = c.inplace ? *in : hc::am_alloc(outBytes, acc, 0);
+
+  if (*in != NULL) {
+    view.copy(&host[0], *in, bytes);
+  }
+}
+
+static void freeBuffers(void* in, void* out) {
+  if (out != NULL && out != in) {
+    hc::am_free(out);
+  }
+
+  if (in != NULL) {
+    hc::am_free(in);
+  }
+}
+
+static bool run(const benchCase& c, hc::accelerator& acc, int iterations,
+                benchResult& result) {
+  hcfftHandle plan;
+
+  if (createPlan(c, &plan) != HCFFT_SUCCESS) {
+    return false;
+  }
+
+  hc::accelerator_view view = acc.get_default_view();
+  hcfftHandle* handle = &plan;
+  hcfftSetStream(handle, view);
+  size_t inBytes, outBytes;
+  bufferBytes(c, &inBytes, &outBytes);
+  void* in;
+  void* out;
+  allocBuffers(c, acc, view, &in, &out);
+  bool done = (in != NULL && out != NULL);
+  std::vector<double> times;
+
+  if (done) {
+    // The first exec bakes the plan
+    done = (exec(c, plan, in, out) == HCFFT_SUCCESS);
+    view.wait();
+  }
+
+  for (int i = 0; done && i < iterations; i++) {
+    hc::completion_future start = view.create_marker();
+    done = (exec(c, plan, in, out) == HCFFT_SUCCESS);
+    hc::completion_future end = view.create_marker();
+    end.wait();
+    times.push_back(double(end.get_end_tick() - start.get_end_tick()) /
+                    end.get_tick_frequency());
+  }
+
+  hcfftDestroy(plan);
+  freeBuffers(in, out);
+
+  if (!done || times.empty()) {
+    return false;
+  }
+
+  std::sort(times.begin(), times.end());
+  size_t N = elements(c);
+  double flops = (c.kind == BENCH_C2C ? 5.0 : 2.5) * N * log2(double(N)) *
+                 c.batch;
+  result.c = c;
+  result.median = times[times.size() / 2];
+  result.p99 = times[std::min(times.size() - 1,
+                              size_t(ceil(0.99 * times.size())) - 1)];
+  result.gflops = flops / result.median / 1e9;
+  result.gbps = (inBytes + outBytes) / result.median / 1e9;
+  return true;
+}
+
+//  Powers of 2, 3 and 5 from 16 to max
+static std::vector<int> lengths(int max) {
+  std::vector<int> sizes;
+  int radices[3] = {2, 3, 5};
+
+  for (int r = 0; r < 3; r++) {
+    for (long long n = radices[r]; n <= max; n *= radices[r]) {
+      if (n >= 16) {
+        sizes.push_back(n);
+      }
+    }
+  }
+
+  std::sort(sizes.begin(), sizes.end());
+  return sizes;
+}
+
+static std::vector<benchCase> sweep(const std::string& dims,
+                                    size_t maxElements) {
+  static const int maxLength[3] = {1 << 20, 4096, 256};
+  static const int batches[3] = {1, 16, 256};
+  std::vector<benchCase> cases;
+
+  for (int rank = 1; rank <= 3; rank++) {
+    if (dims.find(char('0' + rank)) == std::string::npos) {
+      continue;
+    }
+
+    std::vector<int> sizes = lengths(maxLength[rank - 1]);
+
+    for (size_t s = 0; s < sizes.size(); s++) {
+      for (int b = 0; b < 3; b++) {
+        benchCase c;
+        c.rank = rank;
+        c.n[0] = c.n[1] = c.n[2] = sizes[s];
+        c.batch = batches[b];
+
+        if (elements(c) * c.batch > maxElements) {
+          continue;
+        }
+
+        for (int dbl = 0; dbl < 2; dbl++) {
+          for (int kind = BENCH_C2C; kind <= BENCH_C2R; kind++) {
+            for (int inplace = 0; inplace < 2; inplace++) {
+              c.dbl = dbl;
+              c.kind = benchKind(kind);
+              c.inplace = inplace;
+              cases.push_back(c);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return cases;
+}
+
+//  One transform of each path of the planner, single-kernel and split 1D,
+//  Bluestein, 2D, real 2D and 3D
+static std::vector<benchCase> startupCases() {
+  static const int sizes[6][4] = {{1, 1024, 1, 1},   {1, 65536, 1, 1},
+                                  {1, 1009, 1, 1},   {2, 1024, 1024, 1},
+                                  {2, 512, 512, 1},  {3, 128, 128, 128}};
+  std::vector<benchCase> cases;
+
+  for (int i = 0; i < 6; i++) {
+    benchCase c;
+    c.rank = sizes[i][0];
+    c.n[0] = sizes[i][1];
+    c.n[1] = sizes[i][2];
+    c.n[2] = sizes[i][3];
+    c.batch = 1;
+    c.dbl = false;
+    c.kind = (i == 4) ? BENCH_R2C : BENCH_C2C;
+    c.inplace = false;
+    cases.push_back(c);
+  }
+
+  return cases;
+}
+
+static hcfftResult createPlanNd(const benchCase& c, hcfftHandle* plan) {
+  switch (c.rank) {
+    case 1:
+      return hcfftPlan1d(plan, c.n[0], planType(c));
+
+    case 2:
+      return hcfftPlan2d(plan, c.n[0], c.n[1], planType(c));
+
+    default:
+      return hcfftPlan3d(plan, c.n[0], c.n[1], c.n[2], planType(c));
+  }
+}
+
+//  Seconds from the creation of a plan to the end of its first exec, or -1
+//  when either fails. The plan is kept in *keep, or destroyed.
+static double firstExec(const benchCase& c, void* in, void* out,
+                        hcfftHandle* keep) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  hcfftHandle plan;
+
+  if (createPlanNd(c, &plan) != HCFFT_SUCCESS) {
+    return -1;
+  }
+
+  bool done = (exec(c, plan, in, out) == HCFFT_SUCCESS) &&
+              (hcfftSynchronize(plan) == HCFFT_SUCCESS);
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+
+  if (keep != NULL && done) {
+    *keep = plan;
+  } else {
+    hcfftDestroy(plan);
+  }
+
+  return done ? seconds : -1;
+}
+
+//  Kernel cache of its own, so that no kernel of the case is on disk. The
+//  prebuilt kernels are looked for in a directory that does not exist.
+static std::string useEmptyCache() {
+  char dir[] = "/tmp/hcfft_bench_XXXXXX";
+
+  if (mkdtemp(dir) == NULL) {
+    return std::string();
+  }
+
+  setenv("HCFFT_CACHE_DIR", dir, 1);
+  setenv("HCFFT_KERNEL_DIR", (std::string(dir) + "/prebuilt").c_str(), 1);
+  return dir;
+}
+
+static void removeCache(const std::string& dir) {
+  DIR* d = opendir(dir.c_str());
+
+  if (d == NULL) {
+    return;
+  }
+
+  for (struct dirent* entry = readdir(d); entry != NULL; entry = readdir(d)) {
+    if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+      unlink((dir + "/" + entry->d_name).c_str());
+    }
+  }
+
+  closedir(d);
+  rmdir(dir.c_str());
+}
+
+//  Plans created and baked per second by threads, each cycling through the
+//  cases from its own start
+static double planRate(const std::vector<benchCase>& cases, int threads,
+                       int plansPerThread) {
+  std::atomic<int> failed(0);
+  std::vector<std::thread> workers;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+
+  for (int t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&cases, &failed, t, plansPerThread]() {
+      for (int i = 0; i < plansPerThread; i++) {
+        const benchCase& c = cases[(t + i) % cases.size()];
+        hcfftHandle plan;
+
+        if (createPlanNd(c, &plan) != HCFFT_SUCCESS) {
+          failed++;
+          continue;
+        }
+
+        if (hcfftBakePlanAsync(plan) != HCFFT_SUCCESS ||
+            hcfftBakePlanWait(plan) != HCFFT_SUCCESS) {
+          failed++;
+        }
+
+        hcfftDestroy(plan);
+      }
+    }));
+  }
+
+  for (int t = 0; t < threads; t++) {
+    workers[t].join();
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start).count();
+  return failed ? -1 : threads * plansPerThread / seconds;
+}
+
+static int runStartup(hc::accelerator& acc, const std::string& device,
+                      const char* csvPath, const char* jsonPath) {
+  std::vector<benchCase> cases = startupCases();
+  const char* cacheDir = getenv("HCFFT_CACHE_DIR");
+  const char* kernelDir = getenv("HCFFT_KERNEL_DIR");
+  std::string savedCache = cacheDir ? cacheDir : "";
+  std::string savedKernels = kernelDir ? kernelDir : "";
+  std::vector<double> times[3];
+  bool failed = false;
+  std::cout << "device: " << device << std::endl;
+  std::cout << "type\tlengths\tcold_ms\tdisk_ms\tprocess_ms" << std::endl;
+
+  for (size_t i = 0; i < cases.size(); i++) {
+    const benchCase& c = cases[i];
+    size_t inBytes, outBytes;
+    bufferBytes(c, &inBytes, &outBytes);
+    void* in = hc::am_alloc(inBytes, acc, 0);
+    void* out = hc::am_alloc(outBytes, acc, 0);
+    std::string dir = useEmptyCache();
+    hcfftHandle keep = 0;
+    double cold = -1, disk = -1, process = -1;
+
+    // Destroying the only plan of a kernel unloads it, and the second plan
+    // loads it from the cache. The third finds it loaded by the second.
+    if (in != NULL && out != NULL && !dir.empty()) {
+      cold = firstExec(c, in, out, NULL);
+      disk = firstExec(c, in, out, &keep);
+      process = firstExec(c, in, out, NULL);
+    }
+
+    if (keep != 0) {
+      hcfftDestroy(keep);
+    }
+
+    removeCache(dir);
+    hc::am_free(in);
+    hc::am_free(out);
+    failed = failed || cold < 0 || disk < 0 || process < 0;
+    times[0].push_back(cold);
+    times[1].push_back(disk);
+    times[2].push_back(process);
+    std::cout << kindName(c) << "\t" << lengthName(c) << "\t" << cold * 1e3
+              << "\t" << disk * 1e3 << "\t" << process * 1e3 << std::endl;
+  }
+
+  // Throughput from a cache the cases were baked into once
+  static const int threadCounts[4] = {1, 2, 4, 8};
+  double rates[4];
+  std::string dir = useEmptyCache();
+  planRate(cases, 1, cases.size());
+  std::cout << "threads\tplans/s" << std::endl;
+
+  for (int i = 0; i < 4; i++) {
+    rates[i] = planRate(cases, threadCounts[i], 4 * cases.size());
+    failed = failed || rates[i] < 0;
+    std::cout << threadCounts[i] << "\t" << rates[i] << std::endl;
+  }
+
+  removeCache(dir);
+  setenv("HCFFT_CACHE_DIR", savedCache.c_str(), 1);
+  setenv("HCFFT_KERNEL_DIR", savedKernels.c_str(), 1);
+
+  if (cacheDir == NULL) {
+    unsetenv("HCFFT_CACHE_DIR");
+  }
+
+  if (kernelDir == NULL) {
+    unsetenv("HCFFT_KERNEL_DIR");
+  }
+
+  FILE* csv = csvPath ? fopen(csvPath, "w") : NULL;
+
+  if (csv != NULL) {
+    fprintf(csv, "device,type,rank,lengths,cold_ms,disk_ms,process_ms\n");
+
+    for (size_t i = 0; i < cases.size(); i++) {
+      fprintf(csv, "\"%s\",%s,%d,%s,%.3f,%.3f,%.3f\n", device.c_str(),
+              kindName(cases[i]), cases[i].rank, lengthName(cases[i]).c_str(),
+              times[0][i] * 1e3, times[1][i] * 1e3, times[2][i] * 1e3);
+    }
+
+    for (int i = 0; i < 4; i++) {
+      fprintf(csv, "\"%s\",plans_per_second,%d,,%.3f,,\n", device.c_str(),
+              threadCounts[i], rates[i]);
+    }
+
+    fclose(csv);
+  }
+
+  FILE* json = jsonPath ? fopen(jsonPath, "w") : NULL;
+
+  if (json != NULL) {
+    fprintf(json, "{\n  \"device\": \"%s\",\n  \"startup\": [",
+            device.c_str());
+
+    for (size_t i = 0; i < cases.size(); i++) {
+      fprintf(json,
+              "%s\n    {\"type\": \"%s\", \"rank\": %d, "
+              "\"lengths\": \"%s\", \"cold_ms\": %.3f, "
+              "\"disk_ms\": %.3f, \"process_ms\": %.3f}",
+              i ? "," : "", kindName(cases[i]), cases[i].rank,
+              lengthName(cases[i]).c_str(), times[0][i] * 1e3,
+              times[1][i] * 1e3, times[2][i] * 1e3);
+    }
+
+    fprintf(json, "\n  ],\n  \"plans_per_second\": [");
+
+    for (int i = 0; i < 4; i++) {
+      fprintf(json, "%s\n    {\"threads\": %d, \"rate\": %.3f}",
+              i ? "," : "", threadCounts[i], rates[i]);
+    }
+
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+  }
+
+  return failed ? 1 : 0;
+}
+
+//  Bandwidth of the best of a few device to device copies, reading and
+//  writing a quarter of the memory up to 256 MB, in GB/s
+static double copyBandwidth(hc::accelerator& acc) {
+  size_t bytes = std::min<size_t>(256 << 20, acc.get_dedicated_memory() / 4);
+  void* src = hc::am_alloc(bytes, acc, 0);
+  void* dst = hc::am_alloc(bytes, acc, 0);
+  hc::accelerator_view view = acc.get_default_view();
+  double best = 0;
+
+  for (int i = 0; src != NULL && dst != NULL && i < 5; i++) {
+    hc::completion_future start = view.create_marker();
+    view.copy_async(src, dst, bytes);
+    hc::completion_future end = view.create_marker();
+    end.wait();
+    double seconds = double(end.get_end_tick() - start.get_end_tick()) /
+                     end.get_tick_frequency();
+
+    if (seconds > 0) {
+      best = std::max(best, 2.0 * bytes / seconds / 1e9);
+    }
+  }
+
+  if (src != NULL) {
+    hc::am_free(src);
+  }
+
+  if (dst != NULL) {
+    hc::am_free(dst);
+  }
+
+  return best;
+}
+
+//  Single-precision peak of the GPU in GFLOPS: 64 lanes per compute unit,
+//  each retiring a fused multiply-add per clock
+static double peakGflops(hc::accelerator& acc) {
+  hsa_agent_t* agent = static_cast<hsa_agent_t*>(acc.get_hsa_agent());
+  uint32_t mhz = 0;
+
+  if (agent == NULL ||
+      hsa_agent_get_info(*agent, static_cast<hsa_agent_info_t>(
+                                     HSA_AMD_AGENT_INFO_MAX_CLOCK_FREQUENCY),
+                         &mhz) != HSA_STATUS_SUCCESS) {
+    return 0;
+  }
+
+  return acc.get_cu_count() * 64.0 * 2 * mhz / 1e3;
+}
+
+//  Median time, bandwidth and FLOPs of each kernel of a case over the
+//  iterations, each transform profiled
+static bool profileCase(const benchCase& c, hc::accelerator& acc,
+                        int iterations, std::vector<kernelResult>& kernels) {
+  hcfftHandle plan;
+
+  if (createPlan(c, &plan) != HCFFT_SUCCESS) {
+    return false;
+  }
+
+  hc::accelerator_view view = acc.get_default_view();
+  hcfftHandle* handle = &plan;
+  hcfftSetStream(handle, view);
+  void* in;
+  void* out;
+  allocBuffers(c, acc, view, &in, &out);
+  bool done = (in != NULL && out != NULL) &&
+              hcfftXtSetProfiling(plan, 1) == HCFFT_SUCCESS &&
+              exec(c, plan, in, out) == HCFFT_SUCCESS;
+  std::vector<hcfftXtKernelProfile> profile;
+  std::vector<std::vector<double> > times;
+
+  for (int i = 0; done && i < iterations; i++) {
+    int count = 0;
+    done = exec(c, plan, in, out) == HCFFT_SUCCESS &&
+           hcfftXtGetProfile(plan, NULL, &count) == HCFFT_SUCCESS &&
+           count > 0;
+
+    if (done) {
+      profile.resize(count);
+      times.resize(count);
+      done = hcfftXtGetProfile(plan, &profile[0], &count) == HCFFT_SUCCESS;
+    }
+
+    for (int k = 0; done && k < count; k++) {
+      times[k].push_back(profile[k].endTime - profile[k].startTime);
+    }
+  }
+
+  hcfftDestroy(plan);
+  freeBuffers(in, out);
+
+  if (!done || profile.empty()) {
+    return false;
+  }
+
+  for (size_t k = 0; k < profile.size(); k++) {
+    std::sort(times[k].begin(), times[k].end());
+    kernelResult r;
+    r.c = c;
+    r.role = profile[k].role;
+    r.kernel = profile[k].kernel;
+    r.seconds = times[k][times[k].size() / 2];
+    r.gbps = r.seconds > 0 ? profile[k].bytes / r.seconds / 1e9 : 0;
+    r.gflops = r.seconds > 0 ? profile[k].flops / r.seconds / 1e9 : 0;
+    r.roof = 0;
+    kernels.push_back(r);
+  }
+
+  return true;
+}
+
+static int runRoofline(hc::accelerator& acc, const std::string& device,
+                       const std::vector<benchCase>& sweepCases,
+                       int iterations, double peakGbps, double peakFlops,
+                       const char* csvPath, const char* jsonPath) {
+  static const double flagBelow = 0.3;
+  std::vector<kernelResult> kernels;
+  bool failed = false;
+  peakGbps = peakGbps > 0 ? peakGbps : copyBandwidth(acc);
+  peakFlops = peakFlops > 0 ? peakFlops : peakGflops(acc);
+  std::cout << "device: " << device << std::endl;
+  std::cout << "peak: " << peakGbps << " GB/s " << peakFlops << " GFLOPS"
+            << std::endl;
+
+  if (peakGbps <= 0) {
+    std::cerr << "The bandwidth of the GPU is unknown, set it with -p"
+              << std::endl;
+    return 1;
+  }
+
+  std::cout << "type\tlengths\tbatch\tplace\trole\tkernel\tus\tGB/s"
+            << "\tGFLOPS\troof%" << std::endl;
+
+  for (size_t i = 0; i < sweepCases.size(); i++) {
+    const benchCase& c = sweepCases[i];
+    size_t first = kernels.size();
+
+    if (c.dbl) {
+      continue;
+    }
+
+    if (!profileCase(c, acc, iterations, kernels)) {
+      std::cerr << kindName(c) << " " << lengthName(c) << " batch "
+                << c.batch << " failed" << std::endl;
+      failed = true;
+      continue;
+    }
+
+    // Kernels without flops are bound by bandwidth alone
+    for (size_t k = first; k < kernels.size(); k++) {
+      kernelResult& r = kernels[k];
+      double roofGbps = peakGbps;
+
+      if (r.gflops > 0 && peakFlops > 0) {
+        double flopsPerByte = r.gflops / r.gbps;
+        double roofFlops = std::min(peakFlops, flopsPerByte * peakGbps);
+        r.roof = r.gflops / roofFlops;
+      } else {
+        r.roof = r.gbps / roofGbps;
+      }
+
+      std::cout << kindName(c) << "\t" << lengthName(c) << "\t" << c.batch
+                << "\t" << (c.inplace ? "in" : "out") << "\t" << r.role
+                << "\t" << r.kernel << "\t" << r.seconds * 1e6 << "\t"
+                << r.gbps << "\t" << r.gflops << "\t" << r.roof * 100
+                << (r.roof < flagBelow ? "\tslow" : "") << std::endl;
+    }
+  }
+
+  // Time each generator would save at its roofline
+  std::map<std::string, double> total, lost;
+
+  for (size_t k = 0; k < kernels.size(); k++) {
+    const kernelResult& r = kernels[k];
+    total[r.kernel] += r.seconds;
+    lost[r.kernel] += r.seconds * (1 - std::min(1.0, r.roof));
+  }
+
+  std::cout << "kernel\ttotal_us\tlost_us" << std::endl;
+
+  for (std::map<std::string, double>::iterator it = total.begin();
+       it != total.end(); ++it) {
+    std::cout << it->first << "\t" << it->second * 1e6 << "\t"
+              << lost[it->first] * 1e6 << std::endl;
+  }
+
+  FILE* csv = csvPath ? fopen(csvPath, "w") : NULL;
+
+  if (csv != NULL) {
+    fprintf(csv, "device,peak_gbps,peak_gflops,type,rank,lengths,batch,"
+                 "placeness,role,kernel,us,gbps,gflops,roof,slow\n");
+
+    for (size_t k = 0; k < kernels.size(); k++) {
+      const kernelResult& r = kernels[k];
+      fprintf(csv, "\"%s\",%.3f,%.3f,%s,%d,%s,%d,%s,%s,%s,%.3f,%.3f,%.3f,"
+                   "%.3f,%d\n",
+              device.c_str(), peakGbps, peakFlops, kindName(r.c), r.c.rank,
+              lengthName(r.c).c_str(), r.c.batch,
+              r.c.inplace ? "inplace" : "outofplace", r.role.c_str(),
+              r.kernel.c_str(), r.seconds * 1e6, r.gbps, r.gflops, r.roof,
+              r.roof < flagBelow);
+    }
+
+    fclose(csv);
+  }
+
+  FILE* json = jsonPath ? fopen(jsonPath, "w") : NULL;
+
+  if (json != NULL) {
+    fprintf(json, "{\n  \"device\": \"%s\",\n  \"peak_gbps\": %.3f,\n"
+                  "  \"peak_gflops\": %.3f,\n  \"kernels\": [",
+            device.c_str(), peakGbps, peakFlops);
+
+    for (size_t k = 0; k < kernels.size(); k++) {
+      const kernelResult& r = kernels[k];
+      fprintf(json,
+              "%s\n    {\"type\": \"%s\", \"rank\": %d, \"lengths\": "
+              "\"%s\", \"batch\": %d, \"placeness\": \"%s\", "
+              "\"role\": \"%s\", \"kernel\": \"%s\", \"us\": %.3f, "
+              "\"gbps\": %.3f, \"gflops\": %.3f, \"roof\": %.3f, "
+              "\"slow\": %s}",
+              k ? "," : "", kindName(r.c), r.c.rank, lengthName(r.c).c_str(),
+              r.c.batch, r.c.inplace ? "inplace" : "outofplace",
+              r.role.c_str(), r.kernel.c_str(), r.seconds * 1e6, r.gbps,
+              r.gflops, r.roof, r.roof < flagBelow ? "true" : "false");
+    }
+
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+  }
+
+  return failed ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+  int iterations = 100;
+  size_t maxElements = 1 << 24;
+  std::string dims = "123";
+  const char* csvPath = NULL;
+  const char* jsonPath = NULL;
+  bool startup = false;
+  bool roofline = false;
+  double peakGbps = 0, peakFlops = 0;
+  bool usage = false;
+
+  for (int i = 1; i < argc; i += 2) {
+    if (!strcmp(argv[i], "-s")) {
+      startup = true;
+      i--;
+    } else if (!strcmp(argv[i], "-r")) {
+      roofline = true;
+      i--;
+    } else if (i + 1 == argc) {
+      usage = true;
+      break;
+    } else if (!strcmp(argv[i], "-i")) {
+      iterations = std::max(1, atoi(argv[i + 1]));
+    } else if (!strcmp(argv[i], "-m")) {
+      maxElements = std::max(1LL, atoll(argv[i + 1]));
+    } else if (!strcmp(argv[i], "-d")) {
+      dims = argv[i + 1];
+    } else if (!strcmp(argv[i], "-c")) {
+      csvPath = argv[i + 1];
+    } else if (!strcmp(argv[i], "-j")) {
+      jsonPath = argv[i + 1];
+    } else if (!strcmp(argv[i], "-p")) {
+      usage = sscanf(argv[i + 1], "%lf,%lf", &peakGbps, &peakFlops) != 2;
+    } else {
+      usage = true;
+      break;
+    }
+  }
+
+  if (usage) {
+    std::cerr << "usage: " << argv[0] << " [-s | -r [-p GB/s,GFLOPS]]"
+              << " [-i iterations] [-m max_elements] [-d dims] [-c csv]"
+              << " [-j json]" << std::endl;
+    return 1;
+  }
+
+  // Plans of the C API are created on the first GPU
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  hc::accelerator acc;
+  bool found = false;
+
+  for (size_t i = 0; i < accs.size() && !found; i++) {
+    if (!accs[i].get_is_emulated()) {
+      acc = accs[i];
+      found = true;
+    }
+  }
+
+  if (!found) {
+    std::cerr << "There is no GPU" << std::endl;
+    return 1;
+  }
+
+  std::wstring description = acc.get_description();
+  std::string device(description.begin(), description.end());
+
+  if (startup) {
+    return runStartup(acc, device, csvPath, jsonPath);
+  }
+
+  std::vector<benchCase> cases = sweep(dims, maxElements);
+
+  if (roofline) {
+    return runRoofline(acc, device, cases, iterations, peakGbps, peakFlops,
+                       csvPath, jsonPath);
+  }
+
+  std::vector<benchResult> results;
+  std::cout << "device: " << device << std::endl;
+  std::cout << "type\tlengths\tbatch\tplace\tmedian_us\tp99_us\tGFLOPS\tGB/s"
+            << std::endl;
+
+  for (size_t i = 0; i < cases.size(); i++) {
+    benchResult r;
+
+    if (!run(cases[i], acc, iterations, r)) {
+      std::cerr << kindName(cases[i]) << " " << lengthName(cases[i])
+                << " batch " << cases[i].batch << " failed" << std::endl;
+      continue;
+    }
+
+    results.push_back(r);
+    std::cout << kindName(r.c) << "\t" << lengthName(r.c) << "\t" << r.c.batch
+              << "\t" << (r.c.inplace ? "in" : "out") << "\t"
+              << r.median * 1e6 << "\t" << r.p99 * 1e6 << "\t" << r.gflops
+              << "\t" << r.gbps << std::endl;
+  }
+
+  FILE* csv = csvPath ? fopen(csvPath, "w") : NULL;
+
+  if (csv != NULL) {
+    fprintf(csv, "device,type,rank,lengths,batch,placeness,median_us,p99_us,"
+                 "gflops,gbps\n");
+
+    for (size_t i = 0; i < results.size(); i++) {
+      const benchResult& r = results[i];
+      fprintf(csv, "\"%s\",%s,%d,%s,%d,%s,%.3f,%.3f,%.3f,%.3f\n",
+              device.c_str(), kindName(r.c), r.c.rank,
+              lengthName(r.c).c_str(), r.c.batch,
+              r.c.inplace ? "inplace" : "outofplace", r.median * 1e6,
+              r.p99 * 1e6, r.gflops, r.gbps);
+    }
+
+    fclose(csv);
+  }
+
+  FILE* json = jsonPath ? fopen(jsonPath, "w") : NULL;
+
+  if (json != NULL) {
+    fprintf(json, "{\n  \"device\": \"%s\",\n  \"iterations\": %d,\n"
+                  "  \"results\": [",
+            device.c_str(), iterations);
+
+    for (size_t i = 0; i < results.size(); i++) {
+      const benchResult& r = results[i];
+      fprintf(json,
+              "%s\n    {\"type\": \"%s\", \"rank\": %d, \"lengths\": \"%s\", "
+              "\"batch\": %d, \"placeness\": \"%s\", \"median_us\": %.3f, "
+              "\"p99_us\": %.3f, \"gflops\": %.3f, \"gbps\": %.3f}",
+              i ? "," : "", kindName(r.c), r.c.rank, lengthName(r.c).c_str(),
+              r.c.batch, r.c.inplace ? "inplace" : "outofplace",
+              r.median * 1e6, r.p99 * 1e6, r.gflops, r.gbps);
+    }
+
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+  }
+
+  return results.size() == cases.size() ? 0 : 1;
+}
@@ -100,3 +100,63 @@ TEST(hcfft_Create_Destroy_Plan, create_destroy_3D_plan_C2C) {
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
 }
+
+TEST(hcfft_Create_Destroy_Plan, bake_async_wait_2D_plan_C2C) {
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, VECTOR_SIZE, VECTOR_SIZE, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanAsync(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // A second request while baking is a no-op
+  status = hcfftBakePlanAsync(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanWait(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+}
+
+TEST(hcfft_Create_Destroy_Plan, bake_async_destroy_1D_plan_R2C) {
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, VECTOR_SIZE, HCFFT_R2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanAsync(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // Destroy waits for the bake in flight
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+}
+
+TEST(hcfft_Create_Destroy_Plan, plan_timings_2D_plan_C2C) {
+  hcfftHandle plan1, plan2;
+  hcfftResult status = hcfftPlan2d(&plan1, VECTOR_SIZE, VECTOR_SIZE, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan2d(&plan2, VECTOR_SIZE, VECTOR_SIZE, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  hcfftBakePlanAsync(plan1);
+  EXPECT_EQ(hcfftBakePlanWait(plan1), HCFFT_SUCCESS);
+  hcfftBakePlanAsync(plan2);
+  EXPECT_EQ(hcfftBakePlanWait(plan2), HCFFT_SUCCESS);
+  int count = 0;
+  status = hcfftGetPlanTimings(plan2, NULL, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GE(count, 1);
+  hcfftPlanTimings* timings = new hcfftPlanTimings[count];
+  status = hcfftGetPlanTimings(plan2, timings, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(timings[0].depth, 0);
+
+  // The kernels of plan2 are the ones plan1 loaded
+  for (int i = 0; i < count; i++) {
+    if (timings[i].hasKernel) {
+      EXPECT_EQ(timings[i].cacheHit, 1);
+      EXPECT_EQ(timings[i].compileTime, 0.0);
+    }
+  }
+
+  delete[] timings;
+  status = hcfftGetPlanTimings(plan2, NULL, NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  EXPECT_EQ(hcfftDestroy(plan1), HCFFT_SUCCESS);
+  EXPECT_EQ(hcfftDestroy(plan2), HCFFT_SUCCESS);
+}
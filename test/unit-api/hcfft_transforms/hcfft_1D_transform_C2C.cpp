@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <hc_am.hpp>
 #include "include/hcfftlib.h"
 #include "./helper_functions.h"
+#include <thread>
 
 TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C) {
   size_t N1;
@@ -52,6 +53,8 @@ TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C) {
   accl_view.copy(output, odata, sizeof(hcfftComplex) * hSize);
   status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -93,3 +96,2225 @@ TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C) {
   hc::am_free(idata);
   hc::am_free(odata);
 }
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_inplace_then_outofplace) {
+  size_t N1;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* inplace = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  // The same plan runs in place and then out of place
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, idata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(idata, inplace, sizeof(hcfftComplex) * hSize);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // Both runs compute the same transform
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(inplace[i].x, output[i].x, 0.1);
+    EXPECT_NEAR(inplace[i].y, output[i].y, 0.1);
+  }
+
+  // Free up resources
+  free(input);
+  free(inplace);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_load_callback) {
+  size_t N1;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* plain = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, plain, sizeof(hcfftComplex) * hSize);
+  // The callback doubles every input element as the kernel loads it
+  const char* scaleName = "scaleLoad";
+  const char* scaleSource =
+      "float_2 scaleLoad(float_2* buffer, unsigned int offset, "
+      "void* callerInfo) [[hc]] {\n"
+      "  float_2 v = buffer[offset];\n"
+      "  return float_2(2.0f * v.x, 2.0f * v.y);\n"
+      "}\n";
+  status = hcfftXtSetCallback(plan, scaleName, scaleSource,
+                              HCFFT_CB_LD_COMPLEX_DOUBLE, NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  status = hcfftXtSetCallback(plan, scaleName, scaleSource,
+                              HCFFT_CB_LD_COMPLEX, NULL);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // The transform is linear, so its output doubles too
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(2 * plain[i].x, output[i].x, 0.1);
+    EXPECT_NEAR(2 * plain[i].y, output[i].y, 0.1);
+  }
+
+  // Free up resources
+  free(input);
+  free(plain);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_bluestein) {
+  // 1019 is prime, and 1018 has the prime factor 509, so the plan goes
+  // through Bluestein's algorithm
+  size_t N1 = 1019;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_rader) {
+  // 1009 is prime, and 1008 factors into the radices of the kernels, so the
+  // plan goes through Rader's algorithm
+  size_t N1 = 1009;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_radix16) {
+  // 4096 is transformed in three radix 16 passes
+  size_t N1 = 4096;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_half_storage) {
+  size_t N1 = 256;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetHalfStorage(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  __fp16* input = (__fp16*)calloc(2 * hSize, sizeof(__fp16));
+  __fp16* output = (__fp16*)calloc(2 * hSize, sizeof(__fp16));
+
+  // Populate the input, exact in half precision
+  for (int i = 0; i < hSize; i++) {
+    input[2 * i] = i % 8;
+    input[2 * i + 1] = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftHalfComplex* idata =
+      hc::am_alloc(hSize * sizeof(hcfftHalfComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftHalfComplex) * hSize);
+  hcfftHalfComplex* odata =
+      hc::am_alloc(hSize * sizeof(hcfftHalfComplex), accs[1], 0);
+  status = hcfftXtExecHalfC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftHalfComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[2 * i];
+    fftw_in[i][1] = input[2 * i + 1];
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Half precision keeps 11 significant bits of the coefficients
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[2 * i], 2.0);
+    EXPECT_NEAR(fftw_out[i][1], output[2 * i + 1], 2.0);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_planar) {
+  size_t N1 = 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftReal* inRe = (hcfftReal*)calloc(hSize, sizeof(hcfftReal));
+  hcfftReal* inIm = (hcfftReal*)calloc(hSize, sizeof(hcfftReal));
+  hcfftReal* outRe = (hcfftReal*)calloc(hSize, sizeof(hcfftReal));
+  hcfftReal* outIm = (hcfftReal*)calloc(hSize, sizeof(hcfftReal));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    inRe[i] = i % 8;
+    inIm[i] = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idataRe = hc::am_alloc(hSize * sizeof(hcfftReal), accs[1], 0);
+  hcfftReal* idataIm = hc::am_alloc(hSize * sizeof(hcfftReal), accs[1], 0);
+  hcfftReal* odataRe = hc::am_alloc(hSize * sizeof(hcfftReal), accs[1], 0);
+  hcfftReal* odataIm = hc::am_alloc(hSize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(inRe, idataRe, sizeof(hcfftReal) * hSize);
+  accl_view.copy(inIm, idataIm, sizeof(hcfftReal) * hSize);
+  status = hcfftXtExecPlanarC2C(plan, idataRe, idataIm, odataRe, odataIm,
+                                HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odataRe, outRe, sizeof(hcfftReal) * hSize);
+  accl_view.copy(odataIm, outIm, sizeof(hcfftReal) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = inRe[i];
+    fftw_in[i][1] = inIm[i];
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], outRe[i], 0.1);
+    EXPECT_NEAR(fftw_out[i][1], outIm[i], 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(inRe);
+  free(inIm);
+  free(outRe);
+  free(outIm);
+  hc::am_free(idataRe);
+  hc::am_free(idataIm);
+  hc::am_free(odataRe);
+  hc::am_free(odataIm);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_plan_many) {
+  // The columns of a row major 64 x 16 matrix, transformed in place
+  int n = 64, cols = 16;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, &n, cols, 1, &n, cols, 1,
+                                     HCFFT_C2C, cols);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = n * cols;
+  hcfftComplex* input = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* data = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, data, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, data, data, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(data, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, cols, fftw_in, &n, cols, 1,
+                                     fftw_out, &n, cols, 1, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(data);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_batch_streams) {
+  // 10 transforms split across 3 views do not divide evenly, so the chunks
+  // differ in size
+  int n = 256;
+  int batch = 10;
+  int hSize = n * batch;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  std::vector<hc::accelerator_view> streams;
+
+  for (int s = 0; s < 3; s++) {
+    streams.push_back(accs[1].create_view());
+  }
+
+  hcfftHandle plan, splitPlan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, NULL, 1, n, NULL, 1, n,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlanMany(&splitPlan, 1, &n, NULL, 1, n, NULL, 1, n, HCFFT_C2C,
+                         batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetBatchStreams(splitPlan, streams.size(), &streams[0]);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(hSize);
+  std::vector<hcfftComplex> output(hSize);
+  std::vector<hcfftComplex> split(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(splitPlan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(splitPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &split[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(splitPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // Each chunk runs the kernel of the unsplit plan on its own transforms
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(output[i].x, split[i].x, 0.01);
+    EXPECT_NEAR(output[i].y, split[i].y, 0.01);
+  }
+
+  // Free up resources
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_low_memory) {
+  // 24576 splits into 96 x 256, a ratio the swap kernels do not take, so the
+  // in-place transposes shuffle rows and columns instead
+  size_t N1 = 24576;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetLowMemory(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 1;
+  status = hcfftGetSize(plan, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(workSize, 0u);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, idata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(idata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_autotune) {
+  size_t N1 = 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetAutotune(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+
+  // The bake timed the variants of the kernel
+  hcfftPlanTimings timings;
+  int count = 1;
+  status = hcfftGetPlanTimings(plan, &timings, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GT(timings.tuneTime, 0.0);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // A plan of the same size takes the tuned kernel without tuning again
+  status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetAutotune(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanAsync(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanWait(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  count = 1;
+  status = hcfftGetPlanTimings(plan, &timings, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(timings.tuneTime, 0.0);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_wisdom) {
+  size_t N1 = 512;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetAutotune(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanAsync(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftBakePlanWait(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // The exported choices read back
+  const char* path = "hcfft_wisdom_test.txt";
+  status = hcfftExportWisdom(path);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftImportWisdom(path);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExportWisdom(NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  status = hcfftImportWisdom(NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+
+  // A file of another format is refused
+  FILE* file = fopen(path, "w");
+  ASSERT_TRUE(file != NULL);
+  fprintf(file, "hcfft-wisdom 1\nnot a tuning\n");
+  fclose(file);
+  status = hcfftImportWisdom(path);
+  EXPECT_EQ(status, HCFFT_PARSE_ERROR);
+  remove(path);
+  status = hcfftImportWisdom(path);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_computed_twiddles) {
+  // 65536 runs as the 3-step algorithm, whose twiddles are then computed
+  size_t N1 = 65536;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetComputedTwiddles(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_complex *fftw_in, *fftw_out;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_multi_gpu) {
+  // A batch of 10 transforms split across every GPU of the host
+  int n = 64, batch = 10;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, NULL, 1, n, NULL, 1, n,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> all = hc::accelerator::get_all();
+  std::vector<hc::accelerator> accs;
+
+  for (size_t i = 0; i < all.size(); i++) {
+    if (!all[i].get_is_emulated()) {
+      accs.push_back(all[i]);
+    }
+  }
+
+  assert(accs.size() && "Number of Accelerators == 0!");
+  int count = std::min<int>(accs.size(), batch);
+  status = hcfftXtSetGPUs(plan, count, &accs[0]);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<int> chunks(count);
+  status = hcfftXtGetGPUBatches(plan, &chunks[0]);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = n * batch;
+  hcfftComplex* input = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hcfftComplex*> data(count);
+
+  for (int i = 0, offset = 0; i < count; offset += chunks[i] * n, i++) {
+    size_t bytes = chunks[i] * n * sizeof(hcfftComplex);
+    data[i] = hc::am_alloc(bytes, accs[i], 0);
+    accs[i].get_default_view().copy(input + offset, data[i], bytes);
+  }
+
+  status = hcfftXtExecMultiC2C(plan, &data[0], &data[0], HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0, offset = 0; i < count; offset += chunks[i] * n, i++) {
+    size_t bytes = chunks[i] * n * sizeof(hcfftComplex);
+    accs[i].get_default_view().copy(data[i], output + offset, bytes);
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in, NULL, 1, n,
+                                     fftw_out, NULL, 1, n, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+
+  for (int i = 0; i < count; i++) {
+    hc::am_free(data[i]);
+  }
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_host_threshold) {
+  int n = 16;
+  int batch = 8;
+  int hSize = n * batch;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, NULL, 1, n, NULL, 1, n,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetHostThreshold(plan, hSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  hcfftComplex* input = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  // Host memory under the threshold is transformed without the GPU
+  status = hcfftExecC2C(plan, input, output, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in, NULL, 1, n,
+                                     fftw_out, NULL, 1, n, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.01);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.01);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_hybrid) {
+  int n = 256;
+  int batch = 64;
+  int hSize = n * batch;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, NULL, 1, n, NULL, 1, n,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetHybrid(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftComplex* input = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                     amHostPinned);
+  hcfftComplex* output = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                      amHostPinned);
+
+  // The first transform measures the split and the second uses it
+  for (int pass = 0; pass < 2; pass++) {
+    for (int i = 0; i < hSize; i++) {
+      input[i].x = i % 8;
+      input[i].y = i % 16;
+    }
+
+    status = hcfftExecC2C(plan, input, output, HCFFT_FORWARD);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftSynchronize(plan);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in, NULL, 1, n,
+                                     fftw_out, NULL, 1, n, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(input);
+  hc::am_free(output);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_stream_plans) {
+  int n = 1024;
+  const int threads = 4;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, n, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  std::vector<hcfftComplex> input(n);
+
+  // Populate the input
+  for (int i = 0; i < n; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  // The plan is created here and run from workers, each on a stream of its
+  // own through the copy of the plan for it
+  std::vector<std::vector<hcfftComplex> > outputs(
+      threads, std::vector<hcfftComplex>(n));
+  std::vector<hcfftResult> results(threads, HCFFT_EXEC_FAILED);
+  std::vector<std::thread> pool;
+
+  for (int t = 0; t < threads; t++) {
+    pool.push_back(std::thread([&, t]() {
+      hc::accelerator_view stream = accs[1].create_view();
+      hcfftHandle streamPlan;
+      results[t] = hcfftXtGetStreamPlan(plan, stream, &streamPlan);
+
+      if (results[t] != HCFFT_SUCCESS) {
+        return;
+      }
+
+      size_t bytes = n * sizeof(hcfftComplex);
+      hcfftComplex* data = hc::am_alloc(bytes, accs[1], 0);
+      stream.copy(&input[0], data, bytes);
+      results[t] = hcfftExecC2C(streamPlan, data, data, HCFFT_FORWARD);
+      hcfftSynchronize(streamPlan);
+      stream.copy(data, &outputs[t][0], bytes);
+      hc::am_free(data);
+    }));
+  }
+
+  for (int t = 0; t < threads; t++) {
+    pool[t].join();
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+
+  for (int i = 0; i < n; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(n, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int t = 0; t < threads; t++) {
+    EXPECT_EQ(results[t], HCFFT_SUCCESS);
+
+    for (int i = 0; i < n; i++) {
+      EXPECT_NEAR(fftw_out[i][0], outputs[t][i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], outputs[t][i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_exec_stream) {
+  int n = 1 << 20;
+  const int streams = 2;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, n, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 0;
+  status = hcfftGetSize(plan, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  std::vector<hcfftComplex> input(n);
+
+  // Populate the input
+  for (int i = 0; i < n; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  // Both streams run the one plan at once, each with its own work area
+  size_t bytes = n * sizeof(hcfftComplex);
+  std::vector<hc::accelerator_view> views;
+  std::vector<hcfftComplex*> data(streams);
+  std::vector<char*> work(streams);
+
+  for (int s = 0; s < streams; s++) {
+    views.push_back(accs[1].create_view());
+    data[s] = hc::am_alloc(bytes, accs[1], 0);
+    work[s] = workSize ? hc::am_alloc(workSize, accs[1], 0) : NULL;
+    views[s].copy(&input[0], data[s], bytes);
+  }
+
+  for (int s = 0; s < streams; s++) {
+    status = hcfftXtExecStreamC2C(plan, data[s], data[s], HCFFT_FORWARD,
+                                  views[s], work[s]);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+  }
+
+  std::vector<std::vector<hcfftComplex> > outputs(
+      streams, std::vector<hcfftComplex>(n));
+
+  for (int s = 0; s < streams; s++) {
+    views[s].wait();
+    views[s].copy(data[s], &outputs[s][0], bytes);
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+
+  for (int i = 0; i < n; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(n, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int s = 0; s < streams; s++) {
+    EXPECT_FALSE((JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+        fftw_out, &outputs[s][0], n)));
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+
+  for (int s = 0; s < streams; s++) {
+    hc::am_free(data[s]);
+
+    if (work[s] != NULL) {
+      hc::am_free(work[s]);
+    }
+  }
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_rebatch) {
+  // A plan baked for one transform is re-batched for more, and cloned
+  int n = 256, batch = 8, cloneBatch = 3;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, n, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  int hSize = n * batch;
+  std::vector<hcfftComplex> input(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  size_t bytes = hSize * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(bytes, accs[1], 0);
+  accs[1].get_default_view().copy(&input[0], idata, bytes);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetBatch(plan, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> output(hSize);
+  accs[1].get_default_view().copy(odata, &output[0], bytes);
+
+  hcfftHandle clone;
+  status = hcfftXtClonePlan(plan, cloneBatch, &clone);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> cloned(hSize);
+  accs[1].get_default_view().copy(&cloned[0], odata, bytes);
+  status = hcfftExecC2C(clone, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(clone);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accs[1].get_default_view().copy(odata, &cloned[0], bytes);
+  status = hcfftDestroy(clone);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in, NULL, 1, n,
+                                     fftw_out, NULL, 1, n, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // The clone transforms its own batch and leaves the rest untouched
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(i < n * cloneBatch ? fftw_out[i][0] : 0, cloned[i].x, 0.1);
+    EXPECT_NEAR(i < n * cloneBatch ? fftw_out[i][1] : 0, cloned[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_runtime_shape) {
+  // Plans of one length with other batches and distances run one kernel
+  int n = 128;
+  const int shapes = 3;
+  int batches[shapes] = {1, 5, 3};
+  int dists[shapes] = {128, 160, 200};
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+  fftwf_plan p = fftwf_plan_dft_1d(n, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+
+  for (int s = 0; s < shapes; s++) {
+    int batch = batches[s], dist = dists[s];
+    hcfftHandle plan;
+    hcfftResult status = hcfftPlanMany(&plan, 1, &n, &dist, 1, dist, &dist, 1,
+                                       dist, HCFFT_C2C, batch);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    int hSize = dist * batch;
+    std::vector<hcfftComplex> input(hSize);
+    std::vector<hcfftComplex> output(hSize);
+
+    // Populate the input
+    for (int i = 0; i < hSize; i++) {
+      input[i].x = (i + s) % 8;
+      input[i].y = (i + s) % 16;
+    }
+
+    size_t bytes = hSize * sizeof(hcfftComplex);
+    hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+    hcfftComplex* odata = hc::am_alloc(bytes, accs[1], 0);
+    accs[1].get_default_view().copy(&input[0], idata, bytes);
+    status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftSynchronize(plan);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    accs[1].get_default_view().copy(odata, &output[0], bytes);
+    status = hcfftDestroy(plan);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+
+    for (int b = 0; b < batch; b++) {
+      for (int i = 0; i < n; i++) {
+        fftw_in[i][0] = input[b * dist + i].x;
+        fftw_in[i][1] = input[b * dist + i].y;
+      }
+
+      fftwf_execute(p);
+
+      for (int i = 0; i < n; i++) {
+        EXPECT_NEAR(fftw_out[i][0], output[b * dist + i].x, 0.1);
+        EXPECT_NEAR(fftw_out[i][1], output[b * dist + i].y, 0.1);
+      }
+    }
+
+    hc::am_free(idata);
+    hc::am_free(odata);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_saved_plan) {
+  int N1 = 4096;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  const char* path = "hcfft_plan_test.bin";
+  status = hcfftSavePlan(plan, path);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // The loaded plan transforms as the saved one
+  status = hcfftLoadPlan(path, &plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(N1);
+  std::vector<hcfftComplex> output(N1);
+
+  // Populate the input
+  for (int i = 0; i < N1; i++) {
+    input[i].x = rand() % 8;
+    input[i].y = rand() % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  size_t bytes = N1 * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(bytes, accs[1], 0);
+  accs[1].get_default_view().copy(&input[0], idata, bytes);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accs[1].get_default_view().copy(odata, &output[0], bytes);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * N1);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * N1);
+  fftwf_plan p = fftwf_plan_dft_1d(N1, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+
+  for (int i = 0; i < N1; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_execute(p);
+
+  for (int i = 0; i < N1; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // A truncated file is refused
+  FILE* file = fopen(path, "wb");
+  ASSERT_TRUE(file != NULL);
+  fprintf(file, "hcfft-plan");
+  fclose(file);
+  status = hcfftLoadPlan(path, &plan);
+  EXPECT_EQ(status, HCFFT_PARSE_ERROR);
+  remove(path);
+  status = hcfftLoadPlan(path, &plan);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_exec_group) {
+  // A run of four transforms of one plan and a transform of another length
+  const int lengths[2] = {128, 64};
+  const int runs = 4, count = runs + 1;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftHandle plans[2];
+
+  for (int p = 0; p < 2; p++) {
+    hcfftResult status = hcfftPlan1d(&plans[p], lengths[p], HCFFT_C2C);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+  }
+
+  int hSize = lengths[0] * runs + lengths[1];
+  std::vector<hcfftComplex> input(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  size_t bytes = hSize * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(bytes, accs[1], 0);
+  accs[1].get_default_view().copy(&input[0], idata, bytes);
+  hcfftHandle members[count];
+  void* inputs[count];
+  void* outputs[count];
+  int directions[count];
+  int offsets[count];
+
+  for (int m = 0; m < count; m++) {
+    members[m] = plans[m < runs ? 0 : 1];
+    offsets[m] = lengths[0] * m;
+    inputs[m] = idata + offsets[m];
+    outputs[m] = odata + offsets[m];
+    directions[m] = (m < runs) ? HCFFT_FORWARD : HCFFT_BACKWARD;
+  }
+
+  // The run is queued twice, the first time recording its launches
+  for (int i = 0; i < 2; i++) {
+    hcfftResult status =
+        hcfftXtExecGroup(count, members, inputs, outputs, directions);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+  }
+
+  for (int p = 0; p < 2; p++) {
+    hcfftResult status = hcfftSynchronize(plans[p]);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+  }
+
+  std::vector<hcfftComplex> output(hSize);
+  accs[1].get_default_view().copy(odata, &output[0], bytes);
+
+  for (int p = 0; p < 2; p++) {
+    hcfftResult status = hcfftDestroy(plans[p]);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+  }
+
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * lengths[0]);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * lengths[0]);
+
+  for (int m = 0; m < count; m++) {
+    int n = lengths[m < runs ? 0 : 1];
+    fftwf_plan p = fftwf_plan_dft_1d(
+        n, fftw_in, fftw_out, m < runs ? FFTW_FORWARD : FFTW_BACKWARD,
+        FFTW_ESTIMATE);
+
+    for (int i = 0; i < n; i++) {
+      fftw_in[i][0] = input[offsets[m] + i].x;
+      fftw_in[i][1] = input[offsets[m] + i].y;
+    }
+
+    fftwf_execute(p);
+    // Backward transforms are normalized
+    float scale = (m < runs) ? 1.0f : 1.0f / n;
+
+    for (int i = 0; i < n; i++) {
+      EXPECT_NEAR(fftw_out[i][0] * scale, output[offsets[m] + i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1] * scale, output[offsets[m] + i].y, 0.1);
+    }
+
+    fftwf_destroy_plan(p);
+  }
+
+  // Free up resources
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_zero_copy) {
+  int hSize = 16384;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  // Host coherent input, and output in registered host memory, which the
+  // kernels read and write without copies
+  hcfftComplex* input = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                     amHostCoherent);
+  std::vector<hcfftComplex> output(hSize);
+  am_status_t locked =
+      hc::am_memory_host_lock(accs[1], &output[0],
+                              hSize * sizeof(hcfftComplex), &accs[1], 1);
+  EXPECT_EQ(locked, AM_SUCCESS);
+
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  status = hcfftExecC2C(plan, input, &output[0], HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+          fftw_out, &output[0], hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_memory_host_unlock(accs[1], &output[0]);
+  hc::am_free(input);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_exec_events) {
+  int hSize = 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(hSize);
+  std::vector<hcfftComplex> output(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hc::accelerator_view copy_view = accs[1].create_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  // The forward transform follows the upload on another view, and the
+  // backward one the forward, with the host waiting on the last marker only
+  hc::completion_future uploaded =
+      copy_view.copy_async(&input[0], idata, sizeof(hcfftComplex) * hSize);
+  hc::completion_future forward, backward;
+  status = hcfftXtExecEvents(plan, idata, odata, HCFFT_FORWARD, 1, &uploaded,
+                             &forward);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtExecEvents(plan, odata, idata, HCFFT_BACKWARD, 1, &forward,
+                             &backward);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  backward.wait();
+  accl_view.copy(idata, &output[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // The unnormalized transforms bring back hSize times the input
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(input[i].x, output[i].x / hSize, 0.01);
+    EXPECT_NEAR(input[i].y, output[i].y / hSize, 0.01);
+  }
+
+  // Free up resources
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_exec_events_hybrid) {
+  int n = 256;
+  int batch = 64;
+  int hSize = n * batch;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, NULL, 1, n, NULL, 1, n,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetHybrid(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> source(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    source[i].x = i % 8;
+    source[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view copy_view = accs[1].create_view();
+  hcfftComplex* staged = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* input = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                     amHostPinned);
+  hcfftComplex* output = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                      amHostPinned);
+  copy_view.copy(&source[0], staged, sizeof(hcfftComplex) * hSize);
+  // The host share of the transform reads the input only once the download
+  // into it is done
+  hc::completion_future downloaded =
+      copy_view.copy_async(staged, input, sizeof(hcfftComplex) * hSize);
+  hc::completion_future done;
+  status = hcfftXtExecEvents(plan, input, output, HCFFT_FORWARD, 1,
+                             &downloaded, &done);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  done.wait();
+  // The transform was split, the GPU taking part of the batch only
+  int count = 0;
+  status = hcfftGetPlanInfo(plan, NULL, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftPlanInfo> info(count);
+  status = hcfftGetPlanInfo(plan, &info[0], &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  bool split = false;
+
+  for (int i = 0; i < count; i++) {
+    if (std::string(info[i].role) == "hybridPlan") {
+      split = info[i].batch < size_t(batch);
+    }
+  }
+
+  EXPECT_TRUE(split);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = source[i].x;
+    fftw_in[i][1] = source[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in, NULL, 1, n,
+                                     fftw_out, NULL, 1, n, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(staged);
+  hc::am_free(input);
+  hc::am_free(output);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_float4_loads) {
+  // Unit stride input takes the float_4 loads of the first pass, input one
+  // complex value off 16-byte alignment the loads of one value, and input
+  // of stride 2 the strided loads
+  int n = 256;
+  int batch = 8;
+  int oSize = n * batch;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+
+  for (int variant = 0; variant < 3; variant++) {
+    int istride = (variant == 2) ? 2 : 1;
+    int ioffset = (variant == 1) ? 1 : 0;
+    int iSize = n * batch * istride + ioffset;
+    hcfftHandle plan;
+    hcfftResult status =
+        hcfftPlanMany(&plan, 1, &n, &n, istride, n * istride, &n, 1, n,
+                      HCFFT_C2C, batch);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    std::vector<hcfftComplex> input(iSize);
+    std::vector<hcfftComplex> output(oSize);
+
+    // Populate the input
+    for (int i = 0; i < iSize; i++) {
+      input[i].x = i % 8;
+      input[i].y = i % 16;
+    }
+
+    hcfftComplex* idata =
+        hc::am_alloc(iSize * sizeof(hcfftComplex), accs[1], 0);
+    hcfftComplex* odata =
+        hc::am_alloc(oSize * sizeof(hcfftComplex), accs[1], 0);
+    accl_view.copy(&input[0], idata, sizeof(hcfftComplex) * iSize);
+    status = hcfftExecC2C(plan, idata + ioffset, odata, HCFFT_FORWARD);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftSynchronize(plan);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * oSize);
+    status = hcfftDestroy(plan);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    // FFTW work flow
+    fftwf_complex* fftw_in =
+        (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * iSize);
+    fftwf_complex* fftw_out =
+        (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * oSize);
+
+    for (int i = 0; i < iSize; i++) {
+      fftw_in[i][0] = input[i].x;
+      fftw_in[i][1] = input[i].y;
+    }
+
+    fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in + ioffset, &n,
+                                       istride, n * istride, fftw_out, &n, 1,
+                                       n, FFTW_FORWARD, FFTW_ESTIMATE);
+    fftwf_execute(p);
+
+    for (int i = 0; i < oSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+
+    // Free up resources
+    fftwf_destroy_plan(p);
+    fftwf_free(fftw_in);
+    fftwf_free(fftw_out);
+    hc::am_free(idata);
+    hc::am_free(odata);
+  }
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_lds_swizzle) {
+  // The passes of 4096 have several butterflies per work-item, so each of
+  // their LDS exchanges is swizzled, in both directions
+  int n = 4096;
+  int batch = 2;
+  int hSize = n * batch;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &n, NULL, 1, n, NULL, 1, n,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(hSize);
+  std::vector<hcfftComplex> output(hSize);
+  std::vector<hcfftComplex> back(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, odata, idata, HCFFT_BACKWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(idata, &back[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft(1, &n, batch, fftw_in, NULL, 1, n,
+                                     fftw_out, NULL, 1, n, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+          fftw_out, &output[0], hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // The unnormalized transforms bring back n times the input
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(input[i].x, back[i].x / n, 0.01);
+    EXPECT_NEAR(input[i].y, back[i].y / n, 0.01);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_shared_twiddles) {
+  // Two plans of one length share the twiddle table of their kernel, which
+  // must outlive the plan that made it for as long as the other holds it
+  int hSize = 1024;
+  hcfftHandle first, second;
+  hcfftResult status = hcfftPlan1d(&first, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan1d(&second, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(hSize);
+  std::vector<hcfftComplex> output(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftComplex) * hSize);
+  // Both plans are baked by their first transform, the second one taking
+  // the table of the first
+  status = hcfftExecC2C(first, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(second, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(first);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // Clear the output, so that it only holds the last transform
+  accl_view.copy(&output[0], odata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(second, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+          fftw_out, &output[0], hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+//  The plan object behind a handle, whose scratch pool the tests below look
+//  at
+static FFTPlan* scratchPlan(hcfftHandle plan) {
+  FFTPlan* fftPlan = NULL;
+  lockRAII* planLock = NULL;
+  FFTRepo::getInstance().getPlan(plan, fftPlan, planLock);
+  return fftPlan;
+}
+
+//  Forward transform of the input by FFTW, against which output is checked
+static void expectForward(const std::vector<hcfftComplex>& input,
+                          std::vector<hcfftComplex>& output) {
+  int hSize = input.size();
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+          fftw_out, &output[0], hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_scratch_shared) {
+  // Two plans on one view carve their intermediate buffers from one pool
+  int hSize = 65536;
+  hcfftHandle first, second;
+  hcfftResult status = hcfftPlan1d(&first, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan1d(&second, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 0;
+  status = hcfftGetSize(first, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GT(workSize, 0u);
+  std::vector<hcfftComplex> input(hSize);
+  std::vector<hcfftComplex> output(hSize), outputSecond(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  size_t bytes = hSize * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odataSecond = hc::am_alloc(bytes, accs[1], 0);
+  accl_view.copy(&input[0], idata, bytes);
+  status = hcfftExecC2C(first, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(second, idata, odataSecond, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], bytes);
+  accl_view.copy(odataSecond, &outputSecond[0], bytes);
+
+  FFTPlan* firstPlan = scratchPlan(first);
+  FFTPlan* secondPlan = scratchPlan(second);
+  hcfftScratchPool* pool = firstPlan->scratchPool;
+  ASSERT_TRUE(pool != NULL);
+  EXPECT_EQ(pool, secondPlan->scratchPool);
+  EXPECT_GE(pool->users, 2u);
+  EXPECT_GE(pool->size, workSize);
+  EXPECT_EQ(firstPlan->workArea, pool->buffer);
+  EXPECT_EQ(secondPlan->workArea, pool->buffer);
+
+  status = hcfftDestroy(first);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  expectForward(input, output);
+  expectForward(input, outputSecond);
+  hc::am_free(idata);
+  hc::am_free(odata);
+  hc::am_free(odataSecond);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_scratch_grow) {
+  // A larger plan grows the pool, and the plan already attached carves its
+  // buffers again from the new pool buffer at its next transform
+  int hSize = 65536, hSizeLarge = 1 << 20;
+  hcfftHandle small, large;
+  hcfftResult status = hcfftPlan1d(&small, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan1d(&large, hSizeLarge, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 0, workSizeLarge = 0;
+  status = hcfftGetSize(small, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftGetSize(large, &workSizeLarge);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GT(workSizeLarge, workSize);
+  std::vector<hcfftComplex> input(hSizeLarge);
+  std::vector<hcfftComplex> output(hSize), outputLarge(hSizeLarge);
+
+  // Populate the input
+  for (int i = 0; i < hSizeLarge; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  size_t bytes = hSize * sizeof(hcfftComplex);
+  size_t bytesLarge = hSizeLarge * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytesLarge, accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(bytesLarge, accs[1], 0);
+  accl_view.copy(&input[0], idata, bytesLarge);
+  status = hcfftExecC2C(small, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(small);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  FFTPlan* smallPlan = scratchPlan(small);
+  hcfftScratchPool* pool = smallPlan->scratchPool;
+  ASSERT_TRUE(pool != NULL);
+  size_t generation = pool->generation;
+  EXPECT_EQ(smallPlan->scratchGeneration, generation);
+  ASSERT_LT(pool->size, workSizeLarge);
+
+  status = hcfftExecC2C(large, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(large);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &outputLarge[0], bytesLarge);
+  FFTPlan* largePlan = scratchPlan(large);
+  EXPECT_EQ(largePlan->scratchPool, pool);
+  EXPECT_GT(pool->generation, generation);
+  EXPECT_GE(pool->size, workSizeLarge);
+  EXPECT_EQ(largePlan->workArea, pool->buffer);
+  // The small plan still holds buffers of the freed pool buffer
+  EXPECT_LT(smallPlan->scratchGeneration, pool->generation);
+
+  // Clear the output, so that it only holds the last transform
+  accl_view.copy(&output[0], odata, bytes);
+  status = hcfftExecC2C(small, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(small);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], bytes);
+  EXPECT_EQ(smallPlan->scratchGeneration, pool->generation);
+  EXPECT_EQ(smallPlan->workArea, pool->buffer);
+
+  status = hcfftDestroy(small);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(large);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  expectForward(std::vector<hcfftComplex>(input.begin(), input.begin() + hSize),
+                output);
+  expectForward(input, outputLarge);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_scratch_detach) {
+  // A plan given a work area of its own leaves the pool, which the other
+  // plan keeps transforming with
+  int hSize = 65536;
+  hcfftHandle first, second;
+  hcfftResult status = hcfftPlan1d(&first, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan1d(&second, hSize, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 0;
+  status = hcfftGetSize(first, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(hSize);
+  std::vector<hcfftComplex> output(hSize), outputSecond(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  size_t bytes = hSize * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(bytes, accs[1], 0);
+  hcfftComplex* odataSecond = hc::am_alloc(bytes, accs[1], 0);
+  void* workArea = hc::am_alloc(workSize, accs[1], 0);
+  accl_view.copy(&input[0], idata, bytes);
+  status = hcfftExecC2C(first, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(second, idata, odataSecond, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  FFTPlan* firstPlan = scratchPlan(first);
+  FFTPlan* secondPlan = scratchPlan(second);
+  hcfftScratchPool* pool = secondPlan->scratchPool;
+  ASSERT_TRUE(pool != NULL);
+  EXPECT_EQ(firstPlan->scratchPool, pool);
+  size_t users = pool->users;
+  status = hcfftSetWorkArea(first, workArea);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_TRUE(firstPlan->scratchPool == NULL);
+  EXPECT_EQ(secondPlan->scratchPool, pool);
+  EXPECT_EQ(pool->users, users - 1);
+  EXPECT_TRUE(pool->buffer != NULL);
+  EXPECT_EQ(secondPlan->workArea, pool->buffer);
+
+  // Clear the outputs, so that they only hold the transforms below
+  accl_view.copy(&output[0], odata, bytes);
+  accl_view.copy(&output[0], odataSecond, bytes);
+  status = hcfftExecC2C(first, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(firstPlan->workArea, workArea);
+  status = hcfftDestroy(first);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(second, idata, odataSecond, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], bytes);
+  accl_view.copy(odataSecond, &outputSecond[0], bytes);
+  status = hcfftDestroy(second);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  expectForward(input, output);
+  expectForward(input, outputSecond);
+  hc::am_free(idata);
+  hc::am_free(odata);
+  hc::am_free(odataSecond);
+  hc::am_free(workArea);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2C_exec_stream_work_areas) {
+  // Calls on one stream alternate between two work areas, which replays the
+  // launches recorded by the first call into the area of each call
+  int n = 65536;
+  const int calls = 3;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, n, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 0;
+  status = hcfftGetSize(plan, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GT(workSize, 0u);
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view stream = accs[1].create_view();
+  hcfftHandle streamPlan;
+  status = hcfftXtGetStreamPlan(plan, stream, &streamPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftComplex> input(n);
+
+  // Populate the input
+  for (int i = 0; i < n; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  size_t bytes = n * sizeof(hcfftComplex);
+  hcfftComplex* idata = hc::am_alloc(bytes, accs[1], 0);
+  stream.copy(&input[0], idata, bytes);
+  char* work[2] = {hc::am_alloc(workSize, accs[1], 0),
+                   hc::am_alloc(workSize, accs[1], 0)};
+  std::vector<hcfftComplex*> odata(calls + 1);
+  FFTPlan* fftPlan = scratchPlan(streamPlan);
+
+  for (int c = 0; c < calls; c++) {
+    odata[c] = hc::am_alloc(bytes, accs[1], 0);
+    status = hcfftXtExecStreamC2C(plan, idata, odata[c], HCFFT_FORWARD,
+                                  stream, work[c % 2]);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    EXPECT_FALSE(fftPlan->launchesFwd.empty());
+    EXPECT_EQ(fftPlan->workArea, work[0]);
+    EXPECT_TRUE(fftPlan->callWorkArea == NULL);
+  }
+
+  // Without a work area the copy leaves those of the calls
+  odata[calls] = hc::am_alloc(bytes, accs[1], 0);
+  status = hcfftXtExecStreamC2C(plan, idata, odata[calls], HCFFT_FORWARD,
+                                stream, NULL);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_TRUE(fftPlan->workArea != work[0]);
+  EXPECT_TRUE(fftPlan->workArea != work[1]);
+  stream.wait();
+  std::vector<std::vector<hcfftComplex> > outputs(
+      calls + 1, std::vector<hcfftComplex>(n));
+
+  for (int c = 0; c <= calls; c++) {
+    stream.copy(odata[c], &outputs[c][0], bytes);
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int c = 0; c <= calls; c++) {
+    expectForward(input, outputs[c]);
+    hc::am_free(odata[c]);
+  }
+
+  hc::am_free(idata);
+  hc::am_free(work[0]);
+  hc::am_free(work[1]);
+}
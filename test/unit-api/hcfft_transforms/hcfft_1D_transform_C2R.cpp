@@ -53,6 +53,8 @@ TEST(hcfft_1D_transform_test, func_correct_1D_transform_C2R) {
   accl_view.copy(output, odata, sizeof(hcfftReal) * Rsize);
   status = hcfftExecC2R(plan, idata, odata);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftReal) * Rsize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -53,6 +53,8 @@ TEST(hcfft_1D_transform_test, func_correct_1D_transform_R2C) {
   accl_view.copy(output, odata, sizeof(hcfftComplex) * Csize);
   status = hcfftExecR2C(plan, idata, odata);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -98,3 +100,315 @@ TEST(hcfft_1D_transform_test, func_correct_1D_transform_R2C) {
   hc::am_free(odata);
 }
 
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_R2R_DCT_II) {
+  size_t N1 = 256;
+  // HCFFT work flow
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_R2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int Rsize = N1;
+  hcfftReal* input = (hcfftReal*)calloc(Rsize, sizeof(hcfftReal));
+  hcfftReal* output = (hcfftReal*)calloc(Rsize, sizeof(hcfftReal));
+
+  // Populate the input
+  for (int i = 0; i < Rsize; i++) {
+    input[i] = i % 8;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftReal) * Rsize);
+  hcfftReal* odata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  status = hcfftExecR2R(plan, idata, odata, HCFFT_DCT_II);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftReal) * Rsize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // FFTW work flow
+  float* in = (float*)fftwf_malloc(sizeof(float) * Rsize);
+  float* out = (float*)fftwf_malloc(sizeof(float) * Rsize);
+
+  // Populate inputs
+  for (int i = 0; i < Rsize; i++) {
+    in[i] = input[i];
+  }
+
+  fftwf_plan p = fftwf_plan_r2r_1d(Rsize, in, out, FFTW_REDFT10, FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < Rsize; i++) {
+    EXPECT_NEAR(out[i], output[i], 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_convolve_stream_R2C) {
+  int block = 1000, taps = 33, blocks = 6;
+  std::vector<hcfftReal> filter(taps);
+
+  for (int m = 0; m < taps; m++) {
+    filter[m] = 1.0f / (m + 1);
+  }
+
+  hcfftHandle plan;
+  hcfftResult status =
+      hcfftXtPlanConvolveStreamR2C(&plan, block, &filter[0], taps);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int size = block * blocks;
+  std::vector<hcfftReal> input(size), output(size);
+
+  // Populate the input
+  for (int i = 0; i < size; i++) {
+    input[i] = (i % 17) - 8;
+  }
+
+  // The samples of a call continue the stream of the call before
+  status = hcfftXtExecConvolveStreamR2C(plan, &input[0], &output[0], 2);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtExecConvolveStreamR2C(plan, &input[2 * block],
+                                        &output[2 * block], blocks - 2);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < size; i++) {
+    double y = 0;
+
+    for (int m = 0; m < taps && m <= i; m++) {
+      y += filter[m] * input[i - m];
+    }
+
+    EXPECT_NEAR(y, output[i], 0.01);
+  }
+
+  // After a reset, the first block is convolved again as the start
+  status = hcfftXtResetConvolveStream(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftReal> restart(block);
+  status = hcfftXtExecConvolveStreamR2C(plan, &input[0], &restart[0], 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < block; i++) {
+    EXPECT_NEAR(output[i], restart[i], 0.01);
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_R2C_stft) {
+  int N1 = 256, hop = 64, frames = 20;
+  int Rsize = (frames - 1) * hop + N1;
+  int Csize = (N1 / 2) + 1;
+  // Overlapping frames of the signal, hop samples apart
+  int n[1] = {N1};
+  int inembed[1] = {N1};
+  int onembed[1] = {Csize};
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, n, inembed, 1, hop, onembed,
+                                     1, Csize, HCFFT_R2C, frames);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<double> window(N1);
+
+  for (int i = 0; i < N1; i++) {
+    window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / N1);
+  }
+
+  status = hcfftXtSetWindow(plan, &window[0]);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftReal> input(Rsize);
+  std::vector<hcfftComplex> output(Csize * frames);
+
+  // Populate the input
+  for (int i = 0; i < Rsize; i++) {
+    input[i] = i % 8;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftReal) * Rsize);
+  hcfftComplex* odata =
+      hc::am_alloc(Csize * frames * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecR2C(plan, idata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * Csize * frames);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // FFTW work flow on the windowed frames
+  float* in = (float*)fftwf_malloc(sizeof(float) * N1 * frames);
+  fftwf_complex* out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * Csize * frames);
+
+  for (int f = 0; f < frames; f++) {
+    for (int i = 0; i < N1; i++) {
+      in[f * N1 + i] = input[f * hop + i] * window[i];
+    }
+  }
+
+  int lengths[1] = {N1};
+  fftwf_plan p = fftwf_plan_many_dft_r2c(1, lengths, frames, in, NULL, 1, N1,
+                                         out, NULL, 1, Csize, FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < Csize * frames; i++) {
+    EXPECT_NEAR(out[i][0], output[i].x, 0.01);
+    EXPECT_NEAR(out[i][1], output[i].y, 0.01);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+// Even lengths past the single kernel limit run a complex FFT of half the
+// length and split its output into the hermitian values
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_R2C_packed_half) {
+  int N1 = 3 * 8192;
+  int Csize = (N1 / 2) + 1;
+  hcfftHandle plan, planBack;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_R2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan1d(&planBack, N1, HCFFT_C2R);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hcfftReal> input(N1);
+  std::vector<hcfftReal> back(N1);
+  std::vector<hcfftComplex> output(Csize);
+
+  // Populate the input
+  for (int i = 0; i < N1; i++) {
+    input[i] = (i % 8) + 0.25f * (i % 3);
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(N1 * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftReal) * N1);
+  hcfftComplex* odata = hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftReal* bdata = hc::am_alloc(N1 * sizeof(hcfftReal), accs[1], 0);
+  status = hcfftExecR2C(plan, idata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * Csize);
+  status = hcfftExecC2R(planBack, odata, bdata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(planBack);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(bdata, &back[0], sizeof(hcfftReal) * N1);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(planBack);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // FFTW work flow
+  float* in = (float*)fftwf_malloc(sizeof(float) * N1);
+  fftwf_complex* out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * Csize);
+
+  for (int i = 0; i < N1; i++) {
+    in[i] = input[i];
+  }
+
+  fftwf_plan p = fftwf_plan_dft_r2c_1d(N1, in, out, FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(out, &output[0],
+                                                            Csize)) {
+    for (int i = 0; i < Csize; i++) {
+      EXPECT_NEAR(out[i][0], output[i].x, 0.01 * sqrt(N1));
+      EXPECT_NEAR(out[i][1], output[i].y, 0.01 * sqrt(N1));
+    }
+  }
+
+  // The unnormalized C2R brings back N1 times the input
+  for (int i = 0; i < N1; i++) {
+    EXPECT_NEAR(input[i], back[i] / N1, 0.01);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+  hc::am_free(bdata);
+}
+
+TEST(hcfft_1D_transform_test, func_correct_1D_transform_R2C_host_batch) {
+  int N = 1024, batch = 64;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 1, &N, NULL, 1, N, NULL, 1,
+                                     N / 2 + 1, HCFFT_R2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int Csize = (N / 2 + 1) * batch;
+
+  // Pageable vectors, staged through the pinned buffers of the plan
+  std::vector<hcfftReal> input(N * batch);
+  std::vector<hcfftComplex> output(Csize);
+
+  // Populate the input
+  for (int i = 0; i < N * batch; i++) {
+    input[i] = i % 8;
+  }
+
+  // Room for three chunks of 8 transforms, in and out
+  size_t deviceBytes =
+      3 * 8 * (N * sizeof(hcfftReal) + (N / 2 + 1) * sizeof(hcfftComplex)) +
+      3 * 256;
+  status = hcfftXtExecHostBatch(plan, &input[0], &output[0], HCFFT_FORWARD,
+                                deviceBytes);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtExecHostBatch(plan, &input[0], &output[0], HCFFT_FORWARD,
+                                0);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // FFTW work flow
+  float* in = (float*)fftwf_malloc(sizeof(float) * N * batch);
+  fftwf_complex* out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * Csize);
+
+  for (int i = 0; i < N * batch; i++) {
+    in[i] = input[i];
+  }
+
+  fftwf_plan p = fftwf_plan_many_dft_r2c(1, &N, batch, in, NULL, 1, N, out,
+                                         NULL, 1, N / 2 + 1, FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(out, &output[0],
+                                                            Csize)) {
+    for (int i = 0; i < Csize; i++) {
+      EXPECT_NEAR(out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+}
@@ -56,6 +56,8 @@ TEST(hcfft_1D_transform_double_test, func_correct_1D_transform_Z2Z) {
   accl_view.copy(output, odata, sizeof(hcfftDoubleComplex) * hSize);
   status = hcfftExecZ2Z(plan, idata, odata, HCFFT_FORWARD);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftDoubleComplex) * hSize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -98,3 +100,126 @@ TEST(hcfft_1D_transform_double_test, func_correct_1D_transform_Z2Z) {
   hc::am_free(idata);
   hc::am_free(odata);
 }
+
+TEST(hcfft_1D_transform_double_test, func_correct_1D_transform_Z2Z_single_twiddles) {
+  size_t N1 = 1024;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_Z2Z);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetSingleTwiddles(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  hcfftDoubleComplex* input =
+      (hcfftDoubleComplex*)calloc(hSize, sizeof(hcfftDoubleComplex));
+  hcfftDoubleComplex* output =
+      (hcfftDoubleComplex*)calloc(hSize, sizeof(hcfftDoubleComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftDoubleComplex* idata =
+      hc::am_alloc(hSize * sizeof(hcfftDoubleComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftDoubleComplex) * hSize);
+  hcfftDoubleComplex* odata =
+      hc::am_alloc(hSize * sizeof(hcfftDoubleComplex), accs[1], 0);
+  status = hcfftExecZ2Z(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftDoubleComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftw_complex *fftw_in, *fftw_out;
+  fftw_in = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * hSize);
+  fftw_out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftw_plan p =
+      fftw_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD, FFTW_ESTIMATE);
+  fftw_execute(p);
+
+  // Single-precision twiddles bound the error by about 1e-7 * log2(N) of
+  // the largest coefficient, here about 0.01
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftw_destroy_plan(p);
+  fftw_free(fftw_in);
+  fftw_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_1D_transform_double_test, func_correct_1D_transform_Z2Z_large_twiddles) {
+  // 2^20 takes the 3-step path, whose twiddle multiplications read the large
+  // table filled on the device. Periods prime to the length give the
+  // spectrum energy at every frequency, so that every factor is checked.
+  size_t N1 = size_t(1) << 20;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan1d(&plan, N1, HCFFT_Z2Z);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1;
+  std::vector<hcfftDoubleComplex> input(hSize);
+  std::vector<hcfftDoubleComplex> output(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = (i % 97) / 97.0;
+    input[i].y = (i % 89) / 89.0;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftDoubleComplex* idata =
+      hc::am_alloc(hSize * sizeof(hcfftDoubleComplex), accs[1], 0);
+  hcfftDoubleComplex* odata =
+      hc::am_alloc(hSize * sizeof(hcfftDoubleComplex), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftDoubleComplex) * hSize);
+  status = hcfftExecZ2Z(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftDoubleComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftw_complex* fftw_in =
+      (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * hSize);
+  fftw_complex* fftw_out =
+      (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftw_plan p = fftw_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                 FFTW_ESTIMATE);
+  fftw_execute(p);
+  EXPECT_FALSE((JudgeRMSEAccuracyComplex<fftw_complex, hcfftDoubleComplex>(
+      fftw_out, &output[0], hSize)));
+
+  // Free up resources
+  fftw_destroy_plan(p);
+  fftw_free(fftw_in);
+  fftw_free(fftw_out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
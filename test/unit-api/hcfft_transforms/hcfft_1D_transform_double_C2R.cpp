@@ -57,6 +57,8 @@ TEST(hcfft_1D_transform_double_test, func_correct_1D_transform_Z2D) {
   accl_view.copy(output, odata, sizeof(hcfftDoubleReal) * Rsize);
   status = hcfftExecZ2D(plan, idata, odata);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftDoubleReal) * Rsize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
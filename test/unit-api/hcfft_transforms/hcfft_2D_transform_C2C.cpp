@@ -53,6 +53,80 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C) {
   accl_view.copy(output, odata, sizeof(hcfftComplex) * hSize);
   status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  // input output arrays
+  fftwf_complex *fftw_in, *fftw_out;
+  fftwf_plan p;
+  fftw_in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftw_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  // Populate inputs
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+  // 2D forward plan
+  p = fftwf_plan_dft_2d(N2, N1, fftw_in, fftw_out, FFTW_FORWARD, FFTW_ESTIMATE);
+  // Execute C2R
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    // Check Real Outputs
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    }
+    // Check Imaginary Outputs
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_block_columns) {
+  // Short power of 2 columns are transformed in place in blocks
+  size_t N1, N2;
+  N1 = 256;
+  N2 = 64;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 8;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(output, odata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -95,3 +169,499 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C) {
   hc::am_free(idata);
   hc::am_free(odata);
 }
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_lds_batch) {
+  // Small images are transformed by a single kernel, several at a time
+  int n[2] = {25, 12};
+  int batch = 9;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanMany(&plan, 2, n, NULL, 1, 0, NULL, 1, 0,
+                                     HCFFT_C2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int dist = n[0] * n[1];
+  int hSize = dist * batch;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(output, odata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  // FFTW takes the slowest dimension first
+  int fftw_n[2] = {n[1], n[0]};
+  fftwf_plan p = fftwf_plan_many_dft(2, fftw_n, batch, fftw_in, NULL, 1, dist,
+                                     fftw_out, NULL, 1, dist, FFTW_FORWARD,
+                                     FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    // Check Real Outputs
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    }
+    // Check Imaginary Outputs
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_work_area) {
+  size_t N1, N2;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 8;
+  N2 = my_argc > 2 ? atoi(my_argv[2]) : 8;
+  hcfftHandle refPlan, plan;
+  hcfftResult status = hcfftPlan2d(&refPlan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* plain = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(refPlan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(refPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, plain, sizeof(hcfftComplex) * hSize);
+
+  // The plan only uses the work area it is given
+  size_t workSize = 0;
+  status = hcfftGetSize(plan, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSetAutoAllocation(plan, 0);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  if (workSize > 0) {
+    status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+    EXPECT_EQ(status, HCFFT_NO_WORKSPACE);
+  }
+
+  char* workArea = hc::am_alloc(workSize + 1, accs[1], 0);
+  status = hcfftSetWorkArea(plan, workArea);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(refPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(plain[i].x, output[i].x, 0.1);
+    EXPECT_NEAR(plain[i].y, output[i].y, 0.1);
+  }
+
+  // Free up resources
+  free(input);
+  free(plain);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+  hc::am_free(workArea);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_low_memory) {
+  size_t N1, N2;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 512;
+  N2 = my_argc > 2 ? atoi(my_argv[2]) : 1024;
+  hcfftHandle refPlan, plan;
+  hcfftResult status = hcfftPlan2d(&refPlan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* plain = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(refPlan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(refPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, plain, sizeof(hcfftComplex) * hSize);
+
+  // The rectangle is transposed in place, without intermediate buffers
+  status = hcfftXtSetLowMemory(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 1;
+  status = hcfftGetSize(plan, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(workSize, 0u);
+  status = hcfftExecC2C(plan, idata, idata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(idata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(refPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // Sums over the whole frame carry a rounding error that grows with it
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(plain[i].x, output[i].x, 1e-5 * hSize);
+    EXPECT_NEAR(plain[i].y, output[i].y, 1e-5 * hSize);
+  }
+
+  // Free up resources
+  free(input);
+  free(plain);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_estimate) {
+  size_t N1, N2;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 512;
+  N2 = my_argc > 2 ? atoi(my_argv[2]) : 1024;
+  size_t estimate = 0;
+  hcfftResult status = hcfftEstimate2d(N1, N2, HCFFT_C2C, &estimate);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftEstimate2d(N1, N2, HCFFT_C2C, NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+
+  // The estimate covers the work area of the same plan and its twiddles
+  hcfftHandle plan;
+  status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  size_t workSize = 0;
+  status = hcfftGetSize(plan, &workSize);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GT(estimate, workSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_transposed) {
+  size_t N1, N2;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 64;
+  N2 = my_argc > 2 ? atoi(my_argv[2]) : 128;
+  hcfftHandle refPlan, plan;
+  hcfftResult status = hcfftPlan2d(&refPlan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetTransposedOutput(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2;
+  hcfftComplex* input = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* plain = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)calloc(hSize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  status = hcfftExecC2C(refPlan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(refPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, plain, sizeof(hcfftComplex) * hSize);
+
+  // The spectrum comes out as N1 rows of N2 coefficients
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+
+  for (int y = 0; y < N2; y++) {
+    for (int x = 0; x < N1; x++) {
+      EXPECT_NEAR(plain[y * N1 + x].x, output[x * N2 + y].x, 1e-5 * hSize);
+      EXPECT_NEAR(plain[y * N1 + x].y, output[x * N2 + y].y, 1e-5 * hSize);
+    }
+  }
+
+  // The backward transform, scaled by 1 / N, reads it back to the input
+  status = hcfftExecC2C(plan, odata, idata, HCFFT_BACKWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(idata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(refPlan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(input[i].x, output[i].x, 1e-3);
+    EXPECT_NEAR(input[i].y, output[i].y, 1e-3);
+  }
+
+  // Free up resources
+  free(input);
+  free(plain);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_profile) {
+  size_t N1 = 1024, N2 = 512;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtSetProfiling(plan, 1);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int count = 0;
+  status = hcfftXtGetProfile(plan, NULL, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(count, 0);
+  int hSize = N1 * N2;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // Every kernel of the transform is reported, in order
+  status = hcfftXtGetProfile(plan, NULL, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  ASSERT_GT(count, 0);
+  std::vector<hcfftXtKernelProfile> profile(count);
+  status = hcfftXtGetProfile(plan, &profile[0], &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < count; i++) {
+    EXPECT_GT(strlen(profile[i].role), 0u);
+    EXPECT_GT(strlen(profile[i].kernel), 0u);
+    EXPECT_GT(profile[i].bytes, 0u);
+    EXPECT_GE(profile[i].endTime, profile[i].startTime);
+
+    // Only the Stockham kernels count flops
+    if (!strcmp(profile[i].kernel, "Stockham")) {
+      EXPECT_GT(profile[i].flops, 0.0);
+    } else {
+      EXPECT_EQ(profile[i].flops, 0.0);
+    }
+
+    if (i > 0) {
+      EXPECT_GE(profile[i].startTime, profile[i - 1].endTime);
+    }
+  }
+
+  status = hcfftXtGetProfile(plan, NULL, NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_plan_info) {
+  size_t N1 = 1024, N2 = 512;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int count = 0;
+  status = hcfftGetPlanInfo(plan, NULL, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(count, 1);
+  int hSize = N1 * N2;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // The baked plan is described with its sub-plans, each after its parent
+  status = hcfftGetPlanInfo(plan, NULL, &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  ASSERT_GT(count, 1);
+  std::vector<hcfftPlanInfo> info(count);
+  status = hcfftGetPlanInfo(plan, &info[0], &count);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_EQ(info[0].depth, 0);
+  EXPECT_STREQ(info[0].role, "plan");
+  EXPECT_EQ(info[0].baked, 1);
+  EXPECT_EQ(info[0].rank, 2);
+  EXPECT_EQ(info[0].lengths[0], N1);
+  EXPECT_EQ(info[0].lengths[1], N2);
+  int kernels = 0;
+
+  for (int i = 1; i < count; i++) {
+    EXPECT_GE(info[i].depth, 1);
+    EXPECT_LE(info[i].depth, info[i - 1].depth + 1);
+
+    if (info[i].hasKernel) {
+      EXPECT_GT(strlen(info[i].kernelLibrary), 0u);
+      kernels++;
+    }
+  }
+
+  EXPECT_GT(kernels, 0);
+  status = hcfftGetPlanInfo(plan, NULL, NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_stats) {
+  size_t N1 = 1024, N2 = 512;
+  hcfftStats before, after;
+  hcfftResult status = hcfftGetStats(&before);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  hcfftHandle plan;
+  status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftGetStats(&after);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // Each kernel of the bake is found in memory, on disk or compiled
+  EXPECT_GE(after.plansCreated, before.plansCreated + 1);
+  EXPECT_GT(after.memoryCacheHits + after.diskCacheHits + after.cacheMisses,
+            before.memoryCacheHits + before.diskCacheHits + before.cacheMisses);
+  EXPECT_GE(after.execs, before.execs + 2);
+  EXPECT_GE(after.launches, before.launches + 2);
+  EXPECT_GE(after.launchesPerExec, 1.0);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftGetStats(&after);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  EXPECT_GE(after.plansDestroyed, before.plansDestroyed + 1);
+  status = hcfftGetStats(NULL);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2C_output_pruned) {
+  size_t N1 = 64, N2 = 32;
+  int extent[2] = {10, 7};
+  int hSize = N1 * N2;
+  std::vector<hcfftComplex> input(hSize), dense(hSize), cropped(hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 5;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, N1, N2, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &dense[0], sizeof(hcfftComplex) * hSize);
+
+  // Only the bins within the extent are computed
+  status = hcfftXtSetOutputExtent(plan, 2, extent);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &cropped[0], sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int y = 0; y < extent[1]; y++) {
+    for (int x = 0; x < extent[0]; x++) {
+      EXPECT_NEAR(dense[y * N1 + x].x, cropped[y * N1 + x].x, 0.01);
+      EXPECT_NEAR(dense[y * N1 + x].y, cropped[y * N1 + x].y, 0.01);
+    }
+  }
+
+  // Free up resources
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
@@ -53,6 +53,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2R_RTT) {
   accl_view.copy(outputR2C, devOpR2C, sizeof(hcfftComplex) * Csize);
   status = hcfftExecR2C(plan, devIpR2C, devOpR2C);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(devOpR2C, outputR2C, sizeof(hcfftComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -76,6 +78,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_C2R_RTT) {
   accl_view.copy(outputC2R, devOpC2R, sizeof(hcfftReal) * Rsize);
   status = hcfftExecC2R(plan, devIpC2R, devOpC2R);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(devOpC2R, outputC2R, sizeof(hcfftReal) * Rsize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include <fftw3.h>
 #include <hc_am.hpp>
 #include "include/hcfftlib.h"
+#include "include/hcfft.hpp"
 #include "./helper_functions.h"
 
 TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C) {
@@ -53,6 +54,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C) {
   accl_view.copy(output, odata, sizeof(hcfftComplex) * Csize);
   status = hcfftExecR2C(plan, idata, odata);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -96,3 +99,305 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C) {
   hc::am_free(odata);
 }
 
+
+TEST(hcfft_2D_transform_test, func_correct_2D_convolve_R2C) {
+  size_t N1, N2;
+  N1 = my_argc > 1 ? atoi(my_argv[1]) : 8;
+  N2 = my_argc > 2 ? atoi(my_argv[2]) : 8;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, N1, N2, HCFFT_R2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int Rsize = N1 * N2;
+  int Csize = N2 * (1 + N1 / 2);
+  hcfftReal* input = (hcfftReal*)calloc(Rsize, sizeof(hcfftReal));
+  hcfftReal* output = (hcfftReal*)calloc(Rsize, sizeof(hcfftReal));
+  hcfftComplex* filter = (hcfftComplex*)calloc(Csize, sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < Rsize; i++) {
+    input[i] = i % 8;
+  }
+
+  // Spectrum of a unit impulse: the convolution returns the input
+  for (int i = 0; i < Csize; i++) {
+    filter[i].x = 1.0f;
+    filter[i].y = 0.0f;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftReal) * Rsize);
+  hcfftComplex* fdata = hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(filter, fdata, sizeof(hcfftComplex) * Csize);
+  hcfftReal* odata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(output, odata, sizeof(hcfftReal) * Rsize);
+  status = hcfftExecConvolveR2C(plan, idata, fdata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftReal) * Rsize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < Rsize; i++) {
+    EXPECT_NEAR(input[i], output[i], 0.1);
+  }
+
+  // Free up resources
+  free(input);
+  free(output);
+  free(filter);
+  hc::am_free(idata);
+  hc::am_free(fdata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C_typed_plan) {
+  size_t N1 = 64, N2 = 32;
+  size_t lengths[2] = {N1, N2};
+  hcfft::plan<hcfft::r2c, float, 2> forward(lengths);
+  EXPECT_EQ(forward.status(), HCFFT_SUCCESS);
+
+  // Plans are moved with their handle
+  hcfft::plan<hcfft::r2c, float, 2> plan(std::move(forward));
+  EXPECT_EQ(plan.status(), HCFFT_SUCCESS);
+  EXPECT_EQ(forward.status(), HCFFT_INVALID_PLAN);
+  int Rsize = N1 * N2;
+  int Csize = N2 * (1 + N1 / 2);
+  std::vector<hcfftReal> input(Rsize);
+  std::vector<hcfftComplex> output(Csize);
+
+  // Populate the input
+  for (int i = 0; i < Rsize; i++) {
+    input[i] = i % 8;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftReal) * Rsize);
+  hcfftComplex* odata = hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+  EXPECT_EQ(plan.forward(idata, odata), HCFFT_SUCCESS);
+  EXPECT_EQ(hcfftSynchronize(plan.handle()), HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * Csize);
+
+  // Out-of-place plans refuse a single buffer
+  EXPECT_EQ(plan.forward(idata, (hcfftComplex*)idata), HCFFT_INVALID_VALUE);
+  float* in = (float*)fftwf_malloc(sizeof(float) * Rsize);
+  fftwf_complex* out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * Csize);
+
+  for (int i = 0; i < Rsize; i++) {
+    in[i] = input[i];
+  }
+
+  fftwf_plan p = fftwf_plan_dft_r2c_2d(N2, N1, in, out, FFTW_ESTIMATE);
+  fftwf_execute(p);
+  EXPECT_FALSE((JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+      out, &output[0], Csize)));
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C_lds_batch) {
+  // Small real images are packed in pairs into a single kernel; an odd batch
+  // leaves the last one without a partner
+  int n[2] = {25, 25};
+  int batch = 33;
+  hcfftHandle plan, planBack;
+  hcfftResult status = hcfftPlanMany(&plan, 2, n, NULL, 1, 0, NULL, 1, 0,
+                                     HCFFT_R2C, batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftPlanMany(&planBack, 2, n, NULL, 1, 0, NULL, 1, 0, HCFFT_C2R,
+                         batch);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int rDist = n[0] * n[1];
+  int cDist = n[1] * (1 + n[0] / 2);
+  int Rsize = rDist * batch;
+  int Csize = cDist * batch;
+  std::vector<hcfftReal> input(Rsize), result(Rsize);
+  std::vector<hcfftComplex> output(Csize);
+
+  // Populate the input
+  for (int i = 0; i < Rsize; i++) {
+    input[i] = i % 8;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftReal) * Rsize);
+  hcfftComplex* odata = hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecR2C(plan, idata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * Csize);
+
+  // And back, unnormalized
+  status = hcfftExecC2R(planBack, odata, idata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(planBack);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(idata, &result[0], sizeof(hcfftReal) * Rsize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftDestroy(planBack);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // FFTW work flow
+  float* in = (float*)fftwf_malloc(sizeof(float) * Rsize);
+  fftwf_complex* out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * Csize);
+
+  for (int i = 0; i < Rsize; i++) {
+    in[i] = input[i];
+  }
+
+  // FFTW takes the slowest dimension first
+  int fftw_n[2] = {n[1], n[0]};
+  fftwf_plan p = fftwf_plan_many_dft_r2c(2, fftw_n, batch, in, NULL, 1, rDist,
+                                         out, NULL, 1, cDist, FFTW_ESTIMATE);
+  fftwf_execute(p);
+  EXPECT_FALSE((JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(
+      out, &output[0], Csize)));
+
+  for (int i = 0; i < Rsize; i++) {
+    EXPECT_NEAR(input[i] * rDist, result[i], 0.1 * rDist);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C_pruned) {
+  size_t N1 = 128, N2 = 128;
+  int extent[2] = {3, 3};
+  int Rsize = N1 * N2;
+  int Csize = N2 * (1 + N1 / 2);
+  std::vector<hcfftReal> input(Rsize, 0);
+  std::vector<hcfftComplex> dense(Csize), pruned(Csize);
+
+  // A 3x3 filter zero-padded to the size of the transform
+  for (int y = 0; y < extent[1]; y++) {
+    for (int x = 0; x < extent[0]; x++) {
+      input[y * N1 + x] = 1 + x + 3 * y;
+    }
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftReal) * Rsize);
+  hcfftComplex* odata = hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan2d(&plan, N1, N2, HCFFT_R2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecR2C(plan, idata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &dense[0], sizeof(hcfftComplex) * Csize);
+
+  // The same plan pruned to the extent of the filter
+  status = hcfftXtSetInputExtent(plan, 2, extent);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftExecR2C(plan, idata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &pruned[0], sizeof(hcfftComplex) * Csize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  for (int i = 0; i < Csize; i++) {
+    EXPECT_NEAR(dense[i].x, pruned[i].x, 0.01);
+    EXPECT_NEAR(dense[i].y, pruned[i].y, 0.01);
+  }
+
+  // Free up resources
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
+
+TEST(hcfft_2D_transform_test, func_correct_2D_transform_R2C_validation) {
+  // The hermitian side counts the conjugate pairs it leaves out, for even
+  // and odd lengths of the first dimension
+  int lengths[2] = {64, 45};
+
+  for (int l = 0; l < 2; l++) {
+    int n[2] = {lengths[l], 48};
+    int batch = 3;
+    hcfftHandle plan, planBack;
+    hcfftResult status = hcfftPlanMany(&plan, 2, n, NULL, 1, 0, NULL, 1, 0,
+                                       HCFFT_R2C, batch);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftPlanMany(&planBack, 2, n, NULL, 1, 0, NULL, 1, 0, HCFFT_C2R,
+                           batch);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftXtSetValidation(plan, 1);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftXtSetValidation(planBack, 1);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    int count = 0;
+    status = hcfftXtGetValidation(plan, NULL, &count);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    EXPECT_EQ(count, 0);
+    int Rsize = n[0] * n[1] * batch;
+    int Csize = n[1] * (1 + n[0] / 2) * batch;
+    std::vector<hcfftReal> input(Rsize);
+
+    // Populate the input
+    for (int i = 0; i < Rsize; i++) {
+      input[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+
+    std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+    assert(accs.size() && "Number of Accelerators == 0!");
+    hc::accelerator_view accl_view = accs[1].get_default_view();
+    hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+    accl_view.copy(&input[0], idata, sizeof(hcfftReal) * Rsize);
+    hcfftComplex* odata =
+        hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+    status = hcfftExecR2C(plan, idata, odata);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftExecC2R(planBack, odata, idata);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+
+    // Both directions report an error per batch element
+    hcfftHandle plans[2] = {plan, planBack};
+
+    for (int p = 0; p < 2; p++) {
+      std::vector<double> errors(batch, 1.0);
+      count = batch;
+      status = hcfftXtGetValidation(plans[p], &errors[0], &count);
+      EXPECT_EQ(status, HCFFT_SUCCESS);
+      EXPECT_EQ(count, batch);
+
+      for (int b = 0; b < batch; b++) {
+        EXPECT_LT(errors[b], 1e-4);
+      }
+    }
+
+    status = hcfftDestroy(plan);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    status = hcfftDestroy(planBack);
+    EXPECT_EQ(status, HCFFT_SUCCESS);
+    hc::am_free(idata);
+    hc::am_free(odata);
+  }
+}
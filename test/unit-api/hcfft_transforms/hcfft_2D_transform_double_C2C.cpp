@@ -57,6 +57,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_Z2Z) {
   accl_view.copy(output, odata, sizeof(hcfftDoubleComplex) * hSize);
   status = hcfftExecZ2Z(plan, idata, odata, HCFFT_FORWARD);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftDoubleComplex) * hSize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -57,6 +57,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_Z2D_RTT) {
   accl_view.copy(outputD2Z, devOpD2Z, sizeof(hcfftDoubleComplex) * Csize);
   status = hcfftExecD2Z(plan, devIpD2Z, devOpD2Z);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(devOpD2Z, outputD2Z, sizeof(hcfftDoubleComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -84,6 +86,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_Z2D_RTT) {
   accl_view.copy(outputZ2D, devOpZ2D, sizeof(hcfftDoubleReal) * Rsize);
   status = hcfftExecZ2D(plan, devIpZ2D, devOpZ2D);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(devOpZ2D, outputZ2D, sizeof(hcfftDoubleReal) * Rsize);
   status = hcfftDestroy(plan);
   // Check Real Inputs and Outputs
@@ -57,6 +57,8 @@ TEST(hcfft_2D_transform_test, func_correct_2D_transform_D2Z) {
   accl_view.copy(output, odata, sizeof(hcfftDoubleComplex) * Csize);
   status = hcfftExecD2Z(plan, idata, odata);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftDoubleComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -54,6 +54,8 @@ TEST(hcfft_3D_transform_test, func_correct_3D_transform_C2C) {
   accl_view.copy(output, odata, sizeof(hcfftComplex) * hSize);
   status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -94,3 +96,209 @@ TEST(hcfft_3D_transform_test, func_correct_3D_transform_C2C) {
   hc::am_free(idata);
   hc::am_free(odata);
 }
+
+TEST(hcfft_3D_transform_test, func_correct_3D_transform_C2C_host_stream) {
+  size_t N1 = 64, N2 = 64, N3 = 64;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan3d(&plan, N1, N2, N3, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2 * N3;
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hcfftComplex* data = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1],
+                                    amHostPinned);
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    data[i].x = fftw_in[i][0] = i % 8;
+    data[i].y = fftw_in[i][1] = i % 16;
+  }
+
+  // Room for two slabs of 8 planes, streamed in place
+  size_t deviceBytes = 2 * 8 * N1 * N2 * sizeof(hcfftComplex);
+  status = hcfftXtExecHostC2C(plan, data, data, HCFFT_FORWARD, deviceBytes);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftXtExecHostC2C(plan, data, data, HCFFT_FORWARD, 0);
+  EXPECT_EQ(status, HCFFT_INVALID_VALUE);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_plan p = fftwf_plan_dft_3d(N3, N2, N1, fftw_in, fftw_out,
+                                   FFTW_FORWARD, FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, data,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], data[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], data[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  hc::am_free(data);
+}
+
+TEST(hcfft_3D_transform_test, func_correct_3D_transform_C2C_multi_gpu) {
+  // One volume in slabs of planes across every GPU of the host, transformed
+  // into pencils of rows
+  int N1 = 32, N2 = 16, N3 = 16;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan3d(&plan, N1, N2, N3, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<hc::accelerator> all = hc::accelerator::get_all();
+  std::vector<hc::accelerator> accs;
+
+  for (size_t i = 0; i < all.size(); i++) {
+    if (!all[i].get_is_emulated()) {
+      accs.push_back(all[i]);
+    }
+  }
+
+  assert(accs.size() && "Number of Accelerators == 0!");
+  int count = std::min<int>(accs.size(), N2);
+  status = hcfftXtSetGPUs(plan, count, &accs[0]);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  std::vector<int> depths(count), rows(count);
+  status = hcfftXtGetGPUVolumeSplit(plan, &depths[0], &rows[0]);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = N1 * N2 * N3;
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  hcfftComplex* input = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = fftw_in[i][0] = i % 8;
+    input[i].y = fftw_in[i][1] = i % 16;
+  }
+
+  std::vector<hcfftComplex*> slabs(count), pencils(count);
+
+  for (int i = 0, z = 0; i < count; z += depths[i], i++) {
+    size_t slabBytes = depths[i] * N1 * N2 * sizeof(hcfftComplex);
+    slabs[i] = hc::am_alloc(slabBytes, accs[i], 0);
+    pencils[i] =
+        hc::am_alloc(rows[i] * N1 * N3 * sizeof(hcfftComplex), accs[i], 0);
+    accs[i].get_default_view().copy(input + z * N1 * N2, slabs[i], slabBytes);
+  }
+
+  status = hcfftXtExecMultiVolumeC2C(plan, &slabs[0], &pencils[0],
+                                     HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // Gather the rows of every pencil back into the volume
+  for (int j = 0, y = 0; j < count; y += rows[j], j++) {
+    std::vector<hcfftComplex> pencil(rows[j] * N1 * N3);
+    accs[j].get_default_view().copy(pencils[j], &pencil[0],
+                                    pencil.size() * sizeof(hcfftComplex));
+
+    for (int z = 0; z < N3; z++) {
+      memcpy(output + (z * N2 + y) * N1, &pencil[z * rows[j] * N1],
+             rows[j] * N1 * sizeof(hcfftComplex));
+    }
+  }
+
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  fftwf_plan p = fftwf_plan_dft_3d(N3, N2, N1, fftw_in, fftw_out,
+                                   FFTW_FORWARD, FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+
+  for (int i = 0; i < count; i++) {
+    hc::am_free(slabs[i]);
+    hc::am_free(pencils[i]);
+  }
+}
+
+TEST(hcfft_3D_transform_test, func_correct_4D_transform_C2C) {
+  int n[4] = {8, 4, 4, 16};
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlanNd(&plan, 4, n, HCFFT_C2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int hSize = n[0] * n[1] * n[2] * n[3];
+  hcfftComplex* input = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+  hcfftComplex* output = (hcfftComplex*)malloc(hSize * sizeof(hcfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftComplex* idata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  accl_view.copy(input, idata, sizeof(hcfftComplex) * hSize);
+  hcfftComplex* odata = hc::am_alloc(hSize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecC2C(plan, idata, odata, HCFFT_FORWARD);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, output, sizeof(hcfftComplex) * hSize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  // FFTW takes the lengths from the slowest varying dimension
+  int fftwN[4] = {n[3], n[2], n[1], n[0]};
+  fftwf_plan p = fftwf_plan_dft(4, fftwN, fftw_in, fftw_out, FFTW_FORWARD,
+                                FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(fftw_out, output,
+                                                            hSize)) {
+    for (int i = 0; i < hSize; i++) {
+      EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
@@ -54,6 +54,8 @@ TEST(hcfft_3D_transform_test, func_correct_3D_transform_R2C) {
   accl_view.copy(output, odata, sizeof(hcfftComplex) * Csize);
   status = hcfftExecR2C(plan, idata, odata);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(odata, output, sizeof(hcfftComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -98,3 +100,63 @@ TEST(hcfft_3D_transform_test, func_correct_3D_transform_R2C) {
   hc::am_free(odata);
 }
 
+
+TEST(hcfft_3D_transform_test, func_correct_3D_transform_R2C_block_slab) {
+  // The Z FFT of 512 runs on the XY output in blocks of columns
+  size_t N1 = 32, N2 = 32, N3 = 512;
+  hcfftHandle plan;
+  hcfftResult status = hcfftPlan3d(&plan, N1, N2, N3, HCFFT_R2C);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  int Rsize = N3 * N2 * N1;
+  int Csize = N3 * N2 * (1 + N1 / 2);
+  std::vector<hcfftReal> input(Rsize);
+  std::vector<hcfftComplex> output(Csize);
+
+  // Populate the input
+  for (int i = 0; i < Rsize; i++) {
+    input[i] = (i % 7) - (i / 4096) % 3;
+  }
+
+  std::vector<hc::accelerator> accs = hc::accelerator::get_all();
+  assert(accs.size() && "Number of Accelerators == 0!");
+  hc::accelerator_view accl_view = accs[1].get_default_view();
+  hcfftReal* idata = hc::am_alloc(Rsize * sizeof(hcfftReal), accs[1], 0);
+  accl_view.copy(&input[0], idata, sizeof(hcfftReal) * Rsize);
+  hcfftComplex* odata = hc::am_alloc(Csize * sizeof(hcfftComplex), accs[1], 0);
+  status = hcfftExecR2C(plan, idata, odata);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+  accl_view.copy(odata, &output[0], sizeof(hcfftComplex) * Csize);
+  status = hcfftDestroy(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
+
+  // FFTW work flow
+  float* in = (float*)fftwf_malloc(sizeof(float) * Rsize);
+  fftwf_complex* out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * Csize);
+
+  for (int i = 0; i < Rsize; i++) {
+    in[i] = input[i];
+  }
+
+  fftwf_plan p =
+      fftwf_plan_dft_r2c_3d(N3, N2, N1, in, out, FFTW_ESTIMATE | FFTW_R2HC);
+  fftwf_execute(p);
+
+  // Check RMSE: If fails go for pointwise comparison
+  if (JudgeRMSEAccuracyComplex<fftwf_complex, hcfftComplex>(out, &output[0],
+                                                            Csize)) {
+    for (int i = 0; i < Csize; i++) {
+      EXPECT_NEAR(out[i][0], output[i].x, 0.1);
+      EXPECT_NEAR(out[i][1], output[i].y, 0.1);
+    }
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(in);
+  fftwf_free(out);
+  hc::am_free(idata);
+  hc::am_free(odata);
+}
@@ -57,6 +57,8 @@ TEST(hcfft_3D_transform_test, func_correct_3D_transform_Z2D_RTT) {
   accl_view.copy(outputR2C, devOpR2C, sizeof(hcfftDoubleComplex) * Csize);
   status = hcfftExecD2Z(plan, devIpR2C, devOpR2C);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(devOpR2C, outputR2C, sizeof(hcfftDoubleComplex) * Csize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
@@ -82,6 +84,8 @@ TEST(hcfft_3D_transform_test, func_correct_3D_transform_Z2D_RTT) {
   accl_view.copy(outputC2R, devOpC2R, sizeof(hcfftDoubleReal) * Rsize);
   status = hcfftExecZ2D(plan, devIpC2R, devOpC2R);
   EXPECT_EQ(status, HCFFT_SUCCESS);
+  status = hcfftSynchronize(plan);
+  EXPECT_EQ(status, HCFFT_SUCCESS);
   accl_view.copy(devOpC2R, outputC2R, sizeof(hcfftDoubleReal) * Rsize);
   status = hcfftDestroy(plan);
   EXPECT_EQ(status, HCFFT_SUCCESS);
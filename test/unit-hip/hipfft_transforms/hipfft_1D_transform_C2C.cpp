@@ -99,3 +99,65 @@ TEST(hipfft_1D_transform_test, func_correct_1D_transform_C2C) {
   hipFree(idata);
   hipFree(odata);
 }
+
+TEST(hipfft_1D_transform_test, func_correct_1D_transform_C2C_stream) {
+  int hSize = 1024;
+  hipfftHandle plan;
+  hipfftResult status = hipfftPlan1d(&plan, hSize, HIPFFT_C2C, 1);
+  EXPECT_EQ(status, HIPFFT_SUCCESS);
+  hipStream_t stream;
+  hipStreamCreate(&stream);
+  status = hipfftSetStream(plan, stream);
+  EXPECT_EQ(status, HIPFFT_SUCCESS);
+  hipfftComplex* input = (hipfftComplex*)calloc(hSize, sizeof(hipfftComplex));
+  hipfftComplex* output = (hipfftComplex*)calloc(hSize, sizeof(hipfftComplex));
+
+  // Populate the input
+  for (int i = 0; i < hSize; i++) {
+    input[i].x = i % 8;
+    input[i].y = i % 16;
+  }
+
+  hipfftComplex* data;
+  hipMalloc((void**)&data, hSize * sizeof(hipfftComplex));
+  hipMemcpyAsync(data, input, sizeof(hipfftComplex) * hSize,
+                 hipMemcpyHostToDevice, stream);
+  // The transform is ordered after the copy and before the copy back on the
+  // stream
+  status = hipfftExecC2C(plan, data, data, HIPFFT_FORWARD);
+  EXPECT_EQ(status, HIPFFT_SUCCESS);
+  hipMemcpyAsync(output, data, sizeof(hipfftComplex) * hSize,
+                 hipMemcpyDeviceToHost, stream);
+  hipStreamSynchronize(stream);
+  status = hipfftDestroy(plan);
+  EXPECT_EQ(status, HIPFFT_SUCCESS);
+
+  // FFTW work flow
+  fftwf_complex* fftw_in =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+  fftwf_complex* fftw_out =
+      (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * hSize);
+
+  for (int i = 0; i < hSize; i++) {
+    fftw_in[i][0] = input[i].x;
+    fftw_in[i][1] = input[i].y;
+  }
+
+  fftwf_plan p = fftwf_plan_dft_1d(hSize, fftw_in, fftw_out, FFTW_FORWARD,
+                                   FFTW_ESTIMATE);
+  fftwf_execute(p);
+
+  for (int i = 0; i < hSize; i++) {
+    EXPECT_NEAR(fftw_out[i][0], output[i].x, 0.1);
+    EXPECT_NEAR(fftw_out[i][1], output[i].y, 0.1);
+  }
+
+  // Free up resources
+  fftwf_destroy_plan(p);
+  fftwf_free(fftw_in);
+  fftwf_free(fftw_out);
+  free(input);
+  free(output);
+  hipFree(data);
+  hipStreamDestroy(stream);
+}